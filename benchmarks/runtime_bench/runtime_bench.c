@@ -0,0 +1,571 @@
+// Microbenchmarks of runtime hot paths
+//
+// Times the primitives used on every scan and by every plugin in isolation,
+// without a PLC program: journal writes and their application, filling the
+// image tables, the debug protocol, hex conversion, logging and the S7 buffer
+// conversion. Results are written as JSON; scripts/compare-benchmarks.py
+// compares two runs.
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "debug_handler.h"
+#include "image_tables.h"
+#include "journal_buffer.h"
+#include "s7comm_buffers.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+
+// log.c stops its socket thread through this flag
+volatile sig_atomic_t keep_running = 1;
+
+#define DEFAULT_REPETITIONS 5
+#define MAX_REPETITIONS 100
+#define DEBUG_FRAME_SIZE 4096
+#define DEBUG_VAR_COUNT 1024
+#define HEX_BUFFER_SIZE 4096
+
+/**
+ * @brief One benchmark: runs the operation the given number of times
+ *
+ * @return Nanoseconds spent in the timed part; setup between operations is
+ *         excluded where the benchmark needs it
+ */
+typedef uint64_t (*benchmark_fn)(int param, unsigned long iterations);
+
+typedef struct
+{
+    const char *name;
+    benchmark_fn run;
+    int param;
+    unsigned long iterations;
+} benchmark_t;
+
+static pthread_mutex_t image_mutex = PTHREAD_MUTEX_INITIALIZER;
+static plugin_runtime_args_t runtime_args;
+
+// Results are stored here so the compiler cannot drop the benchmarked calls
+static volatile uint64_t sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Journal
+
+typedef struct
+{
+    char area; // X, W, D or L
+    unsigned long writes;
+    pthread_barrier_t *start;
+} journal_writer_t;
+
+static void *journal_writer_thread(void *arg)
+{
+    journal_writer_t *writer = arg;
+
+    pthread_barrier_wait(writer->start);
+    for (unsigned long i = 0; i < writer->writes; i++)
+    {
+        uint16_t index = (uint16_t)(i % BUFFER_SIZE);
+        switch (writer->area)
+        {
+        case 'X':
+            journal_write_bool(JOURNAL_BOOL_OUTPUT, index, (uint8_t)(i & 7), i & 1);
+            break;
+        case 'W':
+            journal_write_int(JOURNAL_INT_OUTPUT, index, (uint16_t)i);
+            break;
+        case 'D':
+            journal_write_dint(JOURNAL_DINT_OUTPUT, index, (uint32_t)i);
+            break;
+        default:
+            journal_write_lint(JOURNAL_LINT_OUTPUT, index, (uint64_t)i);
+            break;
+        }
+    }
+    pthread_barrier_wait(writer->start);
+    return NULL;
+}
+
+/**
+ * @brief Write from several threads at once, as plugins do
+ *
+ * The journal fills up and is flushed under the image mutex on the way, as
+ * it is when the scan cycle falls behind. The time per operation is the wall
+ * time per write over all threads.
+ */
+static uint64_t run_journal_writers(char area, int threads, unsigned long iterations)
+{
+    pthread_t thread_ids[threads];
+    journal_writer_t writer;
+    pthread_barrier_t start;
+
+    journal_apply_and_clear();
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+    writer.area   = area;
+    writer.writes = iterations / (unsigned long)threads;
+    writer.start  = &start;
+
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_create(&thread_ids[t], NULL, journal_writer_thread, &writer);
+    }
+
+    pthread_barrier_wait(&start);
+    uint64_t begin = now_ns();
+    pthread_barrier_wait(&start);
+    uint64_t elapsed = now_ns() - begin;
+
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(thread_ids[t], NULL);
+    }
+    pthread_barrier_destroy(&start);
+    journal_apply_and_clear();
+    return elapsed;
+}
+
+static uint64_t bench_journal_write_bool(int threads, unsigned long iterations)
+{
+    return run_journal_writers('X', threads, iterations);
+}
+
+static uint64_t bench_journal_write_int(int threads, unsigned long iterations)
+{
+    return run_journal_writers('W', threads, iterations);
+}
+
+static uint64_t bench_journal_write_dint(int threads, unsigned long iterations)
+{
+    return run_journal_writers('D', threads, iterations);
+}
+
+static uint64_t bench_journal_write_lint(int threads, unsigned long iterations)
+{
+    return run_journal_writers('L', threads, iterations);
+}
+
+static uint64_t bench_journal_apply_and_clear(int entries, unsigned long iterations)
+{
+    uint64_t elapsed = 0;
+
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        for (int e = 0; e < entries; e++)
+        {
+            journal_write_int(JOURNAL_INT_OUTPUT, (uint16_t)(e % BUFFER_SIZE), (uint16_t)i);
+        }
+
+        uint64_t begin = now_ns();
+        journal_apply_and_clear();
+        elapsed += now_ns() - begin;
+    }
+    return elapsed;
+}
+
+// Image tables
+
+static uint64_t bench_image_tables_fill(int param, unsigned long iterations)
+{
+    uint64_t elapsed = 0;
+
+    (void)param;
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        image_tables_clear_null_pointers();
+
+        uint64_t begin = now_ns();
+        image_tables_fill_null_pointers();
+        elapsed += now_ns() - begin;
+    }
+    return elapsed;
+}
+
+// Debug protocol, against a variable table of mixed sizes
+
+static uint64_t debug_values[DEBUG_VAR_COUNT];
+
+static uint16_t bench_get_var_count(void)
+{
+    return DEBUG_VAR_COUNT;
+}
+
+static size_t bench_get_var_size(size_t idx)
+{
+    static const size_t sizes[] = {1, 2, 4, 8};
+    return sizes[idx % 4];
+}
+
+static void *bench_get_var_addr(size_t idx)
+{
+    return &debug_values[idx];
+}
+
+static void bench_set_trace(size_t idx, bool forced, void *val)
+{
+    (void)idx;
+    (void)forced;
+    (void)val;
+}
+
+static uint64_t run_debug_requests(const uint8_t *request, size_t request_len,
+                                   unsigned long iterations)
+{
+    uint8_t frame[DEBUG_FRAME_SIZE];
+    uint64_t begin = now_ns();
+
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        // The response overwrites the request in place
+        memcpy(frame, request, request_len);
+        sink += process_debug_data(frame, request_len);
+    }
+    return now_ns() - begin;
+}
+
+static uint64_t bench_debug_get(int vars, unsigned long iterations)
+{
+    uint8_t request[5] = {0x43, 0, 0, (uint8_t)((vars - 1) >> 8), (uint8_t)(vars - 1)};
+    return run_debug_requests(request, sizeof(request), iterations);
+}
+
+static uint64_t bench_debug_get_list(int vars, unsigned long iterations)
+{
+    uint8_t request[3 + 2 * 256];
+
+    request[0] = 0x44;
+    request[1] = (uint8_t)(vars >> 8);
+    request[2] = (uint8_t)vars;
+    for (int i = 0; i < vars; i++)
+    {
+        // Scattered indexes, as a watch list of a real program
+        uint16_t index         = (uint16_t)((i * 37) % DEBUG_VAR_COUNT);
+        request[3 + 2 * i]     = (uint8_t)(index >> 8);
+        request[3 + 2 * i + 1] = (uint8_t)index;
+    }
+    return run_debug_requests(request, 3 + 2 * (size_t)vars, iterations);
+}
+
+// Hex conversion of debug frames on the unix socket
+
+static uint64_t bench_parse_hex_string(int bytes, unsigned long iterations)
+{
+    uint8_t data[HEX_BUFFER_SIZE];
+    char hex[HEX_BUFFER_SIZE * 3];
+
+    for (int i = 0; i < bytes; i++)
+    {
+        data[i] = (uint8_t)(i * 7);
+    }
+    bytes_to_hex_string(data, (size_t)bytes, hex, sizeof(hex), NULL);
+
+    uint64_t begin = now_ns();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        sink += parse_hex_string(hex, data);
+    }
+    return now_ns() - begin;
+}
+
+static uint64_t bench_bytes_to_hex_string(int bytes, unsigned long iterations)
+{
+    uint8_t data[HEX_BUFFER_SIZE];
+    char hex[HEX_BUFFER_SIZE * 3];
+
+    for (int i = 0; i < bytes; i++)
+    {
+        data[i] = (uint8_t)(i * 7);
+    }
+
+    uint64_t begin = now_ns();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        bytes_to_hex_string(data, (size_t)bytes, hex, sizeof(hex), "DEBUG:");
+        sink += (uint8_t)hex[6];
+    }
+    return now_ns() - begin;
+}
+
+// Logging without a log socket: messages go to the in-memory buffer
+
+static uint64_t bench_log_buffered(int param, unsigned long iterations)
+{
+    (void)param;
+    log_set_level(LOG_LEVEL_INFO);
+
+    uint64_t begin = now_ns();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        log_info("Benchmark message %lu with value %d", i, param);
+    }
+    uint64_t elapsed = now_ns() - begin;
+
+    log_set_level(LOG_LEVEL_ERROR);
+    return elapsed;
+}
+
+static uint64_t bench_log_filtered(int param, unsigned long iterations)
+{
+    uint64_t begin = now_ns();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        log_debug("Benchmark message %lu with value %d", i, param);
+    }
+    return now_ns() - begin;
+}
+
+// S7 buffer conversion
+
+static int journal_write_bool_adapter(int type, int index, int bit, int value)
+{
+    return journal_write_bool((journal_buffer_type_t)type, (uint16_t)index, (uint8_t)bit,
+                              (bool)value);
+}
+
+static int journal_write_int_adapter(int type, int index, int value)
+{
+    return journal_write_int((journal_buffer_type_t)type, (uint16_t)index, (uint16_t)value);
+}
+
+static int journal_write_dint_adapter(int type, int index, unsigned int value)
+{
+    return journal_write_dint((journal_buffer_type_t)type, (uint16_t)index, (uint32_t)value);
+}
+
+static int journal_write_lint_adapter(int type, int index, unsigned long long value)
+{
+    return journal_write_lint((journal_buffer_type_t)type, (uint16_t)index, (uint64_t)value);
+}
+
+static uint64_t bench_s7_read(int type, unsigned long iterations)
+{
+    uint8_t buffer[HEX_BUFFER_SIZE];
+
+    uint64_t begin = now_ns();
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        s7comm_read_to_buffer(&runtime_args, buffer, 512, (s7comm_buffer_type_t)type, 0);
+        sink += buffer[0];
+    }
+    return now_ns() - begin;
+}
+
+static uint64_t bench_s7_write(int type, unsigned long iterations)
+{
+    uint8_t buffer[HEX_BUFFER_SIZE];
+    uint64_t elapsed = 0;
+
+    memset(buffer, 0x5A, sizeof(buffer));
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        uint64_t begin = now_ns();
+        s7comm_write_from_buffer(&runtime_args, buffer, 512, (s7comm_buffer_type_t)type, 0);
+        elapsed += now_ns() - begin;
+
+        // Empty the journal as the scan cycle would
+        journal_apply_and_clear();
+    }
+    return elapsed;
+}
+
+static const benchmark_t benchmarks[] = {
+    {"journal_write_bool/threads:1", bench_journal_write_bool, 1, 1000000},
+    {"journal_write_bool/threads:4", bench_journal_write_bool, 4, 1000000},
+    {"journal_write_int/threads:1", bench_journal_write_int, 1, 1000000},
+    {"journal_write_int/threads:2", bench_journal_write_int, 2, 1000000},
+    {"journal_write_int/threads:4", bench_journal_write_int, 4, 1000000},
+    {"journal_write_int/threads:8", bench_journal_write_int, 8, 1000000},
+    {"journal_write_dint/threads:4", bench_journal_write_dint, 4, 1000000},
+    {"journal_write_lint/threads:4", bench_journal_write_lint, 4, 1000000},
+    {"journal_apply_and_clear/entries:16", bench_journal_apply_and_clear, 16, 20000},
+    {"journal_apply_and_clear/entries:1024", bench_journal_apply_and_clear, 1024, 1000},
+    {"image_tables_fill_null_pointers", bench_image_tables_fill, 0, 500},
+    {"process_debug_data/GET/vars:16", bench_debug_get, 16, 200000},
+    {"process_debug_data/GET/vars:512", bench_debug_get, 512, 20000},
+    {"process_debug_data/GET_LIST/vars:16", bench_debug_get_list, 16, 200000},
+    {"process_debug_data/GET_LIST/vars:256", bench_debug_get_list, 256, 20000},
+    {"parse_hex_string/bytes:256", bench_parse_hex_string, 256, 5000},
+    {"bytes_to_hex_string/bytes:256", bench_bytes_to_hex_string, 256, 5000},
+    {"log_write/buffered", bench_log_buffered, 0, 100000},
+    {"log_write/filtered", bench_log_filtered, 0, 1000000},
+    {"s7comm_read_to_buffer/bool:512B", bench_s7_read, BUFFER_TYPE_BOOL_OUTPUT, 20000},
+    {"s7comm_read_to_buffer/int:512B", bench_s7_read, BUFFER_TYPE_INT_OUTPUT, 50000},
+    {"s7comm_read_to_buffer/lint:512B", bench_s7_read, BUFFER_TYPE_LINT_OUTPUT, 50000},
+    {"s7comm_write_from_buffer/bool:512B", bench_s7_write, BUFFER_TYPE_BOOL_OUTPUT, 500},
+    {"s7comm_write_from_buffer/int:512B", bench_s7_write, BUFFER_TYPE_INT_OUTPUT, 5000},
+    {"s7comm_write_from_buffer/lint:512B", bench_s7_write, BUFFER_TYPE_LINT_OUTPUT, 10000},
+};
+
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [--filter TEXT] [--repetitions N] [--out FILE] [--list]\n"
+            "\n"
+            "  --filter TEXT     Only run benchmarks whose name contains TEXT\n"
+            "  --repetitions N   Runs per benchmark; the median is reported (default %d)\n"
+            "  --out FILE        Write the JSON results to FILE instead of stdout\n"
+            "  --list            List the benchmarks and exit\n",
+            prog, DEFAULT_REPETITIONS);
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void setup(void)
+{
+    // Only errors: journal and image tables log at info level
+    log_set_level(LOG_LEVEL_ERROR);
+
+    image_tables_fill_null_pointers();
+
+    journal_buffer_ptrs_t journal_ptrs = {
+        .bool_input  = bool_input,
+        .bool_output = bool_output,
+        .bool_memory = bool_memory,
+        .byte_input  = byte_input,
+        .byte_output = byte_output,
+        .int_input   = int_input,
+        .int_output  = int_output,
+        .int_memory  = int_memory,
+        .dint_input  = dint_input,
+        .dint_output = dint_output,
+        .dint_memory = dint_memory,
+        .lint_input  = lint_input,
+        .lint_output = lint_output,
+        .lint_memory = lint_memory,
+        .buffer_size = BUFFER_SIZE,
+        .image_mutex = &image_mutex,
+    };
+    journal_init(&journal_ptrs);
+
+    ext_get_var_count = bench_get_var_count;
+    ext_get_var_size  = bench_get_var_size;
+    ext_get_var_addr  = bench_get_var_addr;
+    ext_set_trace     = bench_set_trace;
+
+    runtime_args.bool_input         = bool_input;
+    runtime_args.bool_output        = bool_output;
+    runtime_args.bool_memory        = bool_memory;
+    runtime_args.int_input          = int_input;
+    runtime_args.int_output         = int_output;
+    runtime_args.int_memory         = int_memory;
+    runtime_args.dint_input         = dint_input;
+    runtime_args.dint_output        = dint_output;
+    runtime_args.dint_memory        = dint_memory;
+    runtime_args.lint_input         = lint_input;
+    runtime_args.lint_output        = lint_output;
+    runtime_args.lint_memory        = lint_memory;
+    runtime_args.buffer_size        = BUFFER_SIZE;
+    runtime_args.journal_write_bool = journal_write_bool_adapter;
+    runtime_args.journal_write_int  = journal_write_int_adapter;
+    runtime_args.journal_write_dint = journal_write_dint_adapter;
+    runtime_args.journal_write_lint = journal_write_lint_adapter;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filter   = NULL;
+    const char *out_path = NULL;
+    int repetitions      = DEFAULT_REPETITIONS;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+        {
+            repetitions = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            out_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--list") == 0)
+        {
+            for (size_t b = 0; b < BENCHMARK_COUNT; b++)
+            {
+                printf("%s\n", benchmarks[b].name);
+            }
+            return 0;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (repetitions < 1 || repetitions > MAX_REPETITIONS)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (out_path && (out = fopen(out_path, "w")) == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", out_path);
+        return 1;
+    }
+
+    setup();
+
+    fprintf(out, "{\n  \"context\": {\"cpus\": %ld, \"repetitions\": %d, \"timestamp\": %ld},\n",
+            sysconf(_SC_NPROCESSORS_ONLN), repetitions, (long)time(NULL));
+    fprintf(out, "  \"benchmarks\": [");
+
+    bool first = true;
+    for (size_t b = 0; b < BENCHMARK_COUNT; b++)
+    {
+        const benchmark_t *bench = &benchmarks[b];
+        double ns_per_op[MAX_REPETITIONS];
+
+        if (filter && strstr(bench->name, filter) == NULL)
+        {
+            continue;
+        }
+
+        // Warm up caches and the journal before the timed runs
+        bench->run(bench->param, bench->iterations / 10 + 1);
+        for (int r = 0; r < repetitions; r++)
+        {
+            uint64_t elapsed = bench->run(bench->param, bench->iterations);
+            ns_per_op[r]     = (double)elapsed / (double)bench->iterations;
+        }
+        qsort(ns_per_op, (size_t)repetitions, sizeof(double), compare_double);
+
+        fprintf(stderr, "%-40s %12.1f ns/op\n", bench->name, ns_per_op[repetitions / 2]);
+        fprintf(out,
+                "%s\n    {\"name\": \"%s\", \"iterations\": %lu, \"ns_per_op\": %.2f, "
+                "\"min_ns_per_op\": %.2f, \"max_ns_per_op\": %.2f}",
+                first ? "" : ",", bench->name, bench->iterations, ns_per_op[repetitions / 2],
+                ns_per_op[0], ns_per_op[repetitions - 1]);
+        first = false;
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    journal_cleanup();
+    return 0;
+}
@@ -0,0 +1,491 @@
+// Synthetic PLC program for benchmarking
+//
+// Exports the same symbols as a program generated by the OpenPLC Editor, so
+// the runtime loads it like any libplc_*.so, but its size and behaviour are
+// set at build time instead of by an IEC program:
+//
+//   SYNTH_LOCATED       Located variables bound in each image table area
+//   SYNTH_DEBUG_VARS    Program variables visible to the debugger
+//   SYNTH_COMPUTE_LOAD  Arithmetic iterations executed per scan
+//   SYNTH_WRITE_PATTERN Outputs written per scan: SYNTH_WRITE_NONE,
+//                       SYNTH_WRITE_SPARSE (a rotating 1/16) or SYNTH_WRITE_ALL
+//   SYNTH_TICKTIME_NS   Task period, overridden at load time by the
+//                       OPENPLC_SYNTHETIC_TICKTIME_NS environment variable
+//   SYNTH_SLOW_TASK_LOAD     Iterations of a second, background task; 0 for
+//                            a single task
+//   SYNTH_SLOW_TASK_DIVISOR  Common ticks between runs of the background task
+//
+// Programs with a background task export a task table like the one
+// scripts/generate-task-table.py adds, for plc_main --multi-task, with an
+// EVENT task as well that runs when a plugin raises it.
+//
+// The results depend only on the scan number and the inputs, so runs with the
+// same inputs are reproducible.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iec_types.h"
+
+#define BUFFER_SIZE 1024
+
+#define SYNTH_WRITE_NONE 0
+#define SYNTH_WRITE_SPARSE 1
+#define SYNTH_WRITE_ALL 2
+
+#define SAME_ENDIANNESS 0
+#define REVERSE_ENDIANNESS 1
+
+#ifndef SYNTH_LOCATED
+#define SYNTH_LOCATED 64
+#endif
+#ifndef SYNTH_DEBUG_VARS
+#define SYNTH_DEBUG_VARS 256
+#endif
+#ifndef SYNTH_COMPUTE_LOAD
+#define SYNTH_COMPUTE_LOAD 1000
+#endif
+#ifndef SYNTH_WRITE_PATTERN
+#define SYNTH_WRITE_PATTERN SYNTH_WRITE_SPARSE
+#endif
+#ifndef SYNTH_TICKTIME_NS
+#define SYNTH_TICKTIME_NS 10000000ULL
+#endif
+#ifndef SYNTH_SLOW_TASK_LOAD
+#define SYNTH_SLOW_TASK_LOAD 0
+#endif
+#ifndef SYNTH_SLOW_TASK_DIVISOR
+#define SYNTH_SLOW_TASK_DIVISOR 10
+#endif
+
+#if SYNTH_LOCATED > BUFFER_SIZE
+#error "SYNTH_LOCATED cannot exceed the image table size"
+#endif
+
+#define STRINGIFY_(x) #x
+#define STRINGIFY(x) STRINGIFY_(x)
+
+// Located bool variables fill whole bytes, 8 per image table entry
+#define BOOL_ENTRIES ((SYNTH_LOCATED + 7) / 8)
+
+// Debugger types, in the order of the generated debug.c
+enum
+{
+    DEBUG_BOOL,
+    DEBUG_INT,
+    DEBUG_DINT,
+    DEBUG_LINT,
+    DEBUG_REAL,
+    DEBUG_TYPE_COUNT
+};
+
+// Program variables carry a force flag like the generated __IEC_*_t types
+#define IEC_FORCE_FLAG 0x02
+#define DEBUG_VAR(type)                                                                            \
+    struct                                                                                         \
+    {                                                                                              \
+        type value;                                                                                \
+        IEC_BYTE flags;                                                                            \
+    }
+
+typedef DEBUG_VAR(IEC_BOOL) debug_bool_t;
+typedef DEBUG_VAR(IEC_INT) debug_int_t;
+typedef DEBUG_VAR(IEC_DINT) debug_dint_t;
+typedef DEBUG_VAR(IEC_LINT) debug_lint_t;
+typedef DEBUG_VAR(IEC_REAL) debug_real_t;
+
+#define DEBUG_PER_TYPE ((SYNTH_DEBUG_VARS + DEBUG_TYPE_COUNT - 1) / DEBUG_TYPE_COUNT)
+
+static debug_bool_t debug_bool[DEBUG_PER_TYPE];
+static debug_int_t debug_int[DEBUG_PER_TYPE];
+static debug_dint_t debug_dint[DEBUG_PER_TYPE];
+static debug_lint_t debug_lint[DEBUG_PER_TYPE];
+static debug_real_t debug_real[DEBUG_PER_TYPE];
+
+// Backing storage of the located variables, bound to the image tables in glueVars()
+static IEC_BOOL located_bool_input[BOOL_ENTRIES][8];
+static IEC_BOOL located_bool_output[BOOL_ENTRIES][8];
+static IEC_BOOL located_bool_memory[BOOL_ENTRIES][8];
+static IEC_BYTE located_byte_input[SYNTH_LOCATED];
+static IEC_BYTE located_byte_output[SYNTH_LOCATED];
+static IEC_UINT located_int_input[SYNTH_LOCATED];
+static IEC_UINT located_int_output[SYNTH_LOCATED];
+static IEC_UDINT located_dint_input[SYNTH_LOCATED];
+static IEC_UDINT located_dint_output[SYNTH_LOCATED];
+static IEC_ULINT located_lint_input[SYNTH_LOCATED];
+static IEC_ULINT located_lint_output[SYNTH_LOCATED];
+static IEC_UINT located_int_memory[SYNTH_LOCATED];
+static IEC_UDINT located_dint_memory[SYNTH_LOCATED];
+static IEC_ULINT located_lint_memory[SYNTH_LOCATED];
+
+// Image tables of the runtime
+static IEC_BOOL *(*bool_input_ptr)[8]  = NULL;
+static IEC_BOOL *(*bool_output_ptr)[8] = NULL;
+static IEC_BOOL *(*bool_memory_ptr)[8] = NULL;
+static IEC_BYTE **byte_input_ptr       = NULL;
+static IEC_BYTE **byte_output_ptr      = NULL;
+static IEC_UINT **int_input_ptr        = NULL;
+static IEC_UINT **int_output_ptr       = NULL;
+static IEC_UDINT **dint_input_ptr      = NULL;
+static IEC_UDINT **dint_output_ptr     = NULL;
+static IEC_ULINT **lint_input_ptr      = NULL;
+static IEC_ULINT **lint_output_ptr     = NULL;
+static IEC_UINT **int_memory_ptr       = NULL;
+static IEC_UDINT **dint_memory_ptr     = NULL;
+static IEC_ULINT **lint_memory_ptr     = NULL;
+
+static IEC_TIMESPEC current_time;
+static uint8_t endianness = SAME_ENDIANNESS;
+
+unsigned long long common_ticktime__ = SYNTH_TICKTIME_NS;
+
+// Identifies the build parameters, like the program hash of a generated program
+#define PROGRAM_ID_BASE                                                                            \
+    "synthetic-L" STRINGIFY(SYNTH_LOCATED) "-D" STRINGIFY(SYNTH_DEBUG_VARS)                        \
+    "-C" STRINGIFY(SYNTH_COMPUTE_LOAD) "-W" STRINGIFY(SYNTH_WRITE_PATTERN)
+#if SYNTH_SLOW_TASK_LOAD > 0
+#define PROGRAM_ID                                                                                 \
+    PROGRAM_ID_BASE "-S" STRINGIFY(SYNTH_SLOW_TASK_LOAD) "x" STRINGIFY(SYNTH_SLOW_TASK_DIVISOR)
+#else
+#define PROGRAM_ID PROGRAM_ID_BASE
+#endif
+
+char plc_program_md5[] = PROGRAM_ID;
+
+void setBufferPointers_v4(IEC_BOOL *input_bool[BUFFER_SIZE][8],
+                          IEC_BOOL *output_bool[BUFFER_SIZE][8],
+                          IEC_BYTE *input_byte[BUFFER_SIZE], IEC_BYTE *output_byte[BUFFER_SIZE],
+                          IEC_UINT *input_int[BUFFER_SIZE], IEC_UINT *output_int[BUFFER_SIZE],
+                          IEC_UDINT *input_dint[BUFFER_SIZE], IEC_UDINT *output_dint[BUFFER_SIZE],
+                          IEC_ULINT *input_lint[BUFFER_SIZE], IEC_ULINT *output_lint[BUFFER_SIZE],
+                          IEC_UINT *int_memory[BUFFER_SIZE], IEC_UDINT *dint_memory[BUFFER_SIZE],
+                          IEC_ULINT *lint_memory[BUFFER_SIZE],
+                          IEC_BOOL *memory_bool[BUFFER_SIZE][8])
+{
+    bool_input_ptr  = input_bool;
+    bool_output_ptr = output_bool;
+    bool_memory_ptr = memory_bool;
+    byte_input_ptr  = input_byte;
+    byte_output_ptr = output_byte;
+    int_input_ptr   = input_int;
+    int_output_ptr  = output_int;
+    dint_input_ptr  = input_dint;
+    dint_output_ptr = output_dint;
+    lint_input_ptr  = input_lint;
+    lint_output_ptr = output_lint;
+    int_memory_ptr  = int_memory;
+    dint_memory_ptr = dint_memory;
+    lint_memory_ptr = lint_memory;
+}
+
+void setBufferPointers(IEC_BOOL *input_bool[BUFFER_SIZE][8], IEC_BOOL *output_bool[BUFFER_SIZE][8],
+                       IEC_BYTE *input_byte[BUFFER_SIZE], IEC_BYTE *output_byte[BUFFER_SIZE],
+                       IEC_UINT *input_int[BUFFER_SIZE], IEC_UINT *output_int[BUFFER_SIZE],
+                       IEC_UDINT *input_dint[BUFFER_SIZE], IEC_UDINT *output_dint[BUFFER_SIZE],
+                       IEC_ULINT *input_lint[BUFFER_SIZE], IEC_ULINT *output_lint[BUFFER_SIZE],
+                       IEC_UINT *int_memory[BUFFER_SIZE], IEC_UDINT *dint_memory[BUFFER_SIZE],
+                       IEC_ULINT *lint_memory[BUFFER_SIZE])
+{
+    setBufferPointers_v4(input_bool, output_bool, input_byte, output_byte, input_int, output_int,
+                         input_dint, output_dint, input_lint, output_lint, int_memory,
+                         dint_memory, lint_memory, NULL);
+}
+
+void config_init__(void)
+{
+    const char *ticktime = getenv("OPENPLC_SYNTHETIC_TICKTIME_NS");
+    if (ticktime != NULL && strtoull(ticktime, NULL, 10) > 0)
+    {
+        common_ticktime__ = strtoull(ticktime, NULL, 10);
+    }
+
+    memset(&current_time, 0, sizeof(current_time));
+    for (int i = 0; i < DEBUG_PER_TYPE; i++)
+    {
+        debug_bool[i].value = 0;
+        debug_int[i].value  = (IEC_INT)i;
+        debug_dint[i].value = (IEC_DINT)i * 1000;
+        debug_lint[i].value = (IEC_LINT)i * 1000000;
+        debug_real[i].value = (IEC_REAL)i * 0.5f;
+    }
+}
+
+void glueVars(void)
+{
+    for (int i = 0; i < SYNTH_LOCATED; i++)
+    {
+        bool_input_ptr[i / 8][i % 8]  = &located_bool_input[i / 8][i % 8];
+        bool_output_ptr[i / 8][i % 8] = &located_bool_output[i / 8][i % 8];
+        if (bool_memory_ptr)
+        {
+            bool_memory_ptr[i / 8][i % 8] = &located_bool_memory[i / 8][i % 8];
+        }
+        byte_input_ptr[i]  = &located_byte_input[i];
+        byte_output_ptr[i] = &located_byte_output[i];
+        int_input_ptr[i]   = &located_int_input[i];
+        int_output_ptr[i]  = &located_int_output[i];
+        dint_input_ptr[i]  = &located_dint_input[i];
+        dint_output_ptr[i] = &located_dint_output[i];
+        lint_input_ptr[i]  = &located_lint_input[i];
+        lint_output_ptr[i] = &located_lint_output[i];
+        int_memory_ptr[i]  = &located_int_memory[i];
+        dint_memory_ptr[i] = &located_dint_memory[i];
+        lint_memory_ptr[i] = &located_lint_memory[i];
+    }
+}
+
+/**
+ * @brief Mixed integer and floating point work, like math function blocks
+ */
+static IEC_REAL compute(unsigned long tick, IEC_UINT input, long iterations)
+{
+    IEC_REAL acc  = (IEC_REAL)input;
+    uint32_t bits = (uint32_t)tick * 2654435761u + input;
+    for (long i = 0; i < iterations; i++)
+    {
+        bits ^= bits << 13;
+        bits ^= bits >> 17;
+        bits ^= bits << 5;
+        acc = acc * 0.999f + (IEC_REAL)(bits & 0xFF) * 0.001f;
+    }
+    return acc;
+}
+
+static bool should_write(unsigned long tick, int index)
+{
+#if SYNTH_WRITE_PATTERN == SYNTH_WRITE_ALL
+    (void)tick;
+    (void)index;
+    return true;
+#elif SYNTH_WRITE_PATTERN == SYNTH_WRITE_SPARSE
+    return (unsigned long)index % 16 == tick % 16;
+#else
+    (void)tick;
+    (void)index;
+    return false;
+#endif
+}
+
+static void main_task(unsigned long tick)
+{
+    IEC_REAL result =
+        compute(tick, SYNTH_LOCATED > 0 ? located_int_input[0] : 0, SYNTH_COMPUTE_LOAD);
+
+    // Keep the result observable so the compute load is never optimized away
+    if (DEBUG_PER_TYPE > 0 && !(debug_real[0].flags & IEC_FORCE_FLAG))
+    {
+        debug_real[0].value = result;
+    }
+
+    // Located outputs follow the inputs, as in an I/O heavy program
+    for (int i = 0; i < SYNTH_LOCATED; i++)
+    {
+        if (!should_write(tick, i))
+        {
+            continue;
+        }
+        located_bool_output[i / 8][i % 8] = located_bool_input[i / 8][i % 8] ^ (tick & 1);
+        located_byte_output[i]            = (IEC_BYTE)(located_byte_input[i] + tick);
+        located_int_output[i]             = (IEC_UINT)(located_int_input[i] + (IEC_UINT)result);
+        located_dint_output[i]            = located_dint_input[i] + (IEC_UDINT)tick;
+        located_lint_output[i]            = located_lint_input[i] + tick;
+        located_int_memory[i]             = (IEC_UINT)tick;
+    }
+
+    // Program variables: counters, timers and set points a debugger would watch
+    for (int i = 0; i < DEBUG_PER_TYPE; i++)
+    {
+        if (!should_write(tick, i))
+        {
+            continue;
+        }
+        if (!(debug_bool[i].flags & IEC_FORCE_FLAG))
+        {
+            debug_bool[i].value = !debug_bool[i].value;
+        }
+        if (!(debug_int[i].flags & IEC_FORCE_FLAG))
+        {
+            debug_int[i].value++;
+        }
+        if (!(debug_dint[i].flags & IEC_FORCE_FLAG))
+        {
+            debug_dint[i].value += (IEC_DINT)tick;
+        }
+        if (!(debug_lint[i].flags & IEC_FORCE_FLAG))
+        {
+            debug_lint[i].value += 1000;
+        }
+        if (!(debug_real[i].flags & IEC_FORCE_FLAG))
+        {
+            debug_real[i].value = result + (IEC_REAL)i;
+        }
+    }
+}
+
+#if SYNTH_SLOW_TASK_LOAD > 0
+// Result of the background task, kept observable like the main task's
+static volatile IEC_REAL slow_result;
+
+static void slow_task(unsigned long tick)
+{
+    slow_result = compute(tick, SYNTH_LOCATED > 0 ? located_int_input[0] : 0,
+                          SYNTH_SLOW_TASK_LOAD);
+}
+
+// Reacts to an input edge or frame, with the compute load of the main task
+static volatile IEC_REAL event_result;
+
+static void event_task(unsigned long tick)
+{
+    event_result = compute(tick, SYNTH_LOCATED > 0 ? located_int_input[0] : 0,
+                           SYNTH_COMPUTE_LOAD);
+}
+
+// Same layout as plc_task_t in core/src/plc_app/multi_task.h
+struct plc_task_entry__
+{
+    const char *name;
+    unsigned long tick_divisor;
+    int priority;
+    void (*run)(unsigned long tick);
+    int (*condition)(unsigned long tick);
+};
+
+const unsigned int plc_task_count__ = 3;
+
+const struct plc_task_entry__ plc_tasks__[] = {
+    {"MAIN", 1, -1, main_task, NULL},
+    {"SLOW", SYNTH_SLOW_TASK_DIVISOR, -1, slow_task, NULL},
+    {"EVENT", 0, -1, event_task, NULL},
+};
+#endif
+
+void config_run__(unsigned long tick)
+{
+    main_task(tick);
+#if SYNTH_SLOW_TASK_LOAD > 0
+    if (tick % SYNTH_SLOW_TASK_DIVISOR == 0)
+    {
+        slow_task(tick);
+    }
+#endif
+}
+
+void updateTime(void)
+{
+    current_time.tv_sec += common_ticktime__ / 1000000000ULL;
+    current_time.tv_nsec += common_ticktime__ % 1000000000ULL;
+    if (current_time.tv_nsec >= 1000000000)
+    {
+        current_time.tv_nsec -= 1000000000;
+        current_time.tv_sec += 1;
+    }
+}
+
+// Present in programs with Python function blocks; the runtime looks it up after loading
+void python_loader_set_loggers(void (*info)(const char *, ...), void (*error)(const char *, ...))
+{
+    (void)info;
+    (void)error;
+}
+
+uint16_t get_var_count(void)
+{
+    return SYNTH_DEBUG_VARS;
+}
+
+/**
+ * @brief Find the storage of a debug variable; variables are interleaved by type
+ */
+static void *debug_var(size_t idx, size_t *size, IEC_BYTE **flags)
+{
+    size_t n = idx / DEBUG_TYPE_COUNT;
+    switch (idx % DEBUG_TYPE_COUNT)
+    {
+    case DEBUG_BOOL:
+        *size  = sizeof(IEC_BOOL);
+        *flags = &debug_bool[n].flags;
+        return &debug_bool[n].value;
+    case DEBUG_INT:
+        *size  = sizeof(IEC_INT);
+        *flags = &debug_int[n].flags;
+        return &debug_int[n].value;
+    case DEBUG_DINT:
+        *size  = sizeof(IEC_DINT);
+        *flags = &debug_dint[n].flags;
+        return &debug_dint[n].value;
+    case DEBUG_LINT:
+        *size  = sizeof(IEC_LINT);
+        *flags = &debug_lint[n].flags;
+        return &debug_lint[n].value;
+    default:
+        *size  = sizeof(IEC_REAL);
+        *flags = &debug_real[n].flags;
+        return &debug_real[n].value;
+    }
+}
+
+size_t get_var_size(size_t idx)
+{
+    size_t size;
+    IEC_BYTE *flags;
+    if (idx >= SYNTH_DEBUG_VARS)
+    {
+        return 0;
+    }
+    debug_var(idx, &size, &flags);
+    return size;
+}
+
+void *get_var_addr(size_t idx)
+{
+    size_t size;
+    IEC_BYTE *flags;
+    if (idx >= SYNTH_DEBUG_VARS)
+    {
+        return NULL;
+    }
+    return debug_var(idx, &size, &flags);
+}
+
+void set_trace(size_t idx, bool forced, void *val)
+{
+    size_t size;
+    IEC_BYTE *flags;
+    if (idx >= SYNTH_DEBUG_VARS)
+    {
+        return;
+    }
+
+    void *ptr = debug_var(idx, &size, &flags);
+    if (!forced)
+    {
+        *flags &= ~IEC_FORCE_FLAG;
+        return;
+    }
+
+    uint8_t value[sizeof(IEC_LINT)];
+    memcpy(value, val, size);
+    if (endianness == REVERSE_ENDIANNESS)
+    {
+        for (size_t i = 0; i < size / 2; i++)
+        {
+            uint8_t tmp         = value[i];
+            value[i]            = value[size - 1 - i];
+            value[size - 1 - i] = tmp;
+        }
+    }
+    memcpy(ptr, value, size);
+    *flags |= IEC_FORCE_FLAG;
+}
+
+void set_endianness(uint8_t value)
+{
+    if (value == SAME_ENDIANNESS || value == REVERSE_ENDIANNESS)
+    {
+        endianness = value;
+    }
+}
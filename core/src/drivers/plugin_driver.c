@@ -13,8 +13,10 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include "../plc_app/free_run.h"
 #include "../plc_app/image_tables.h"
 #include "../plc_app/journal_buffer.h"
+#include "../plc_app/multi_task.h"
 #include "../plc_app/utils/log.h"
 #include "plugin_config.h"
 #include "plugin_driver.h"
@@ -23,6 +25,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 // External buffer declarations from image_tables.c
@@ -44,6 +47,9 @@ static PyThreadState *main_tstate = NULL;
 static PyGILState_STATE gstate;
 static int has_python_plugin = 0;
 
+// Longest native hook since the last reset, only used by the PLC cycle thread
+static plugin_hook_timing_t longest_hook;
+
 // Prototypes
 static void python_plugin_cleanup(plugin_instance_t *plugin);
 
@@ -137,6 +143,33 @@ static int plugin_journal_write_lint(int type, int index, unsigned long long val
     return journal_write_lint((journal_buffer_type_t)type, (uint16_t)index, (uint64_t)value);
 }
 
+#define PLUGIN_JOURNAL_MAX_RANGES 64
+
+static int plugin_journal_write_ranges(const plugin_journal_range_t *ranges, int range_count)
+{
+    journal_range_t converted[PLUGIN_JOURNAL_MAX_RANGES];
+
+    if (ranges == NULL || range_count <= 0 || range_count > PLUGIN_JOURNAL_MAX_RANGES)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < range_count; i++)
+    {
+        if (ranges[i].start_index < 0 || ranges[i].count <= 0 ||
+            ranges[i].start_index + ranges[i].count > UINT16_MAX)
+        {
+            return -1;
+        }
+        converted[i].type        = (journal_buffer_type_t)ranges[i].type;
+        converted[i].start_index = (uint16_t)ranges[i].start_index;
+        converted[i].count       = (uint16_t)ranges[i].count;
+        converted[i].values      = ranges[i].values;
+    }
+
+    return journal_write_ranges(converted, (size_t)range_count);
+}
+
 // Python capsule destructor for runtime args
 // Breakpoint here to debug capsule issues
 static void plugin_runtime_args_capsule_destructor(PyObject *capsule)
@@ -691,11 +724,18 @@ void *generate_structured_args_with_driver(plugin_type_t type, plugin_driver_t *
     args->log_error = log_error;
 
     // Initialize journal write functions for race-condition-free buffer writes
-    args->journal_write_bool = plugin_journal_write_bool;
-    args->journal_write_byte = plugin_journal_write_byte;
-    args->journal_write_int  = plugin_journal_write_int;
-    args->journal_write_dint = plugin_journal_write_dint;
-    args->journal_write_lint = plugin_journal_write_lint;
+    args->journal_write_bool   = plugin_journal_write_bool;
+    args->journal_write_byte   = plugin_journal_write_byte;
+    args->journal_write_int    = plugin_journal_write_int;
+    args->journal_write_dint   = plugin_journal_write_dint;
+    args->journal_write_lint   = plugin_journal_write_lint;
+    args->journal_write_ranges = plugin_journal_write_ranges;
+
+    // Runtime clock
+    args->get_time_ns = free_run_clock_ns;
+
+    // Event tasks
+    args->raise_event = multi_task_raise_event;
 
     // printf("[PLUGIN]: Runtime args initialized:\n");
     // printf("[PLUGIN]:   buffer_size = %d\n", args->buffer_size);
@@ -902,6 +942,25 @@ int python_plugin_get_symbols(plugin_instance_t *plugin)
         py_binds->pFuncCleanup = NULL;
     }
 
+    py_binds->pFuncProgramChanging =
+        PyObject_GetAttrString(py_binds->pModule, "program_changing");
+    if (!py_binds->pFuncProgramChanging || !PyCallable_Check(py_binds->pFuncProgramChanging))
+    {
+        // program_changing is optional
+        PyErr_Clear();
+        Py_XDECREF(py_binds->pFuncProgramChanging);
+        py_binds->pFuncProgramChanging = NULL;
+    }
+
+    py_binds->pFuncProgramChanged = PyObject_GetAttrString(py_binds->pModule, "program_changed");
+    if (!py_binds->pFuncProgramChanged || !PyCallable_Check(py_binds->pFuncProgramChanged))
+    {
+        // program_changed is optional
+        PyErr_Clear();
+        Py_XDECREF(py_binds->pFuncProgramChanged);
+        py_binds->pFuncProgramChanged = NULL;
+    }
+
     // Store the python binds in the plugin instance
     plugin->python_plugin = py_binds;
 
@@ -910,6 +969,8 @@ int python_plugin_get_symbols(plugin_instance_t *plugin)
     log_info("  - start_loop: %s", py_binds->pFuncStart ? "(PASS)" : "(FAIL)");
     log_info("  - stop_loop: %s", py_binds->pFuncStop ? "(PASS)" : "(FAIL)");
     log_info("  - cleanup: %s", py_binds->pFuncCleanup ? "(PASS)" : "(FAIL)");
+    log_info("  - program_changing: %s", py_binds->pFuncProgramChanging ? "(PASS)" : "(FAIL)");
+    log_info("  - program_changed: %s", py_binds->pFuncProgramChanged ? "(PASS)" : "(FAIL)");
 
     return 0;
 }
@@ -984,6 +1045,35 @@ int native_plugin_get_symbols(plugin_instance_t *plugin)
                  plugin->config.path);
     }
 
+    native_bundle->input_latch = (plugin_input_latch_func_t)dlsym(handle, "input_latch");
+    if (!native_bundle->input_latch)
+    {
+        log_warn("'input_latch' function not found in native plugin '%s' (optional)",
+                 plugin->config.path);
+    }
+
+    native_bundle->output_flush = (plugin_output_flush_func_t)dlsym(handle, "output_flush");
+    if (!native_bundle->output_flush)
+    {
+        log_warn("'output_flush' function not found in native plugin '%s' (optional)",
+                 plugin->config.path);
+    }
+
+    native_bundle->outputs_safe = (plugin_outputs_safe_func_t)dlsym(handle, "outputs_safe");
+    if (!native_bundle->outputs_safe)
+    {
+        log_warn("'outputs_safe' function not found in native plugin '%s' (optional)",
+                 plugin->config.path);
+    }
+
+    native_bundle->program_changed =
+        (plugin_program_changed_func_t)dlsym(handle, "program_changed");
+    if (!native_bundle->program_changed)
+    {
+        log_warn("'program_changed' function not found in native plugin '%s' (optional)",
+                 plugin->config.path);
+    }
+
     native_bundle->cleanup = (plugin_cleanup_func_t)dlsym(handle, "cleanup");
     if (!native_bundle->cleanup)
     {
@@ -1000,6 +1090,10 @@ int native_plugin_get_symbols(plugin_instance_t *plugin)
     log_info("  - stop_loop: %s", native_bundle->stop ? "(PASS)" : "(FAIL)");
     log_info("  - cycle_start: %s", native_bundle->cycle_start ? "(PASS)" : "(FAIL)");
     log_info("  - cycle_end: %s", native_bundle->cycle_end ? "(PASS)" : "(FAIL)");
+    log_info("  - input_latch: %s", native_bundle->input_latch ? "(PASS)" : "(FAIL)");
+    log_info("  - output_flush: %s", native_bundle->output_flush ? "(PASS)" : "(FAIL)");
+    log_info("  - outputs_safe: %s", native_bundle->outputs_safe ? "(PASS)" : "(FAIL)");
+    log_info("  - program_changed: %s", native_bundle->program_changed ? "(PASS)" : "(FAIL)");
     log_info("  - cleanup: %s", native_bundle->cleanup ? "(PASS)" : "(FAIL)");
 
     return 0;
@@ -1013,6 +1107,36 @@ void python_plugin_cycle(plugin_instance_t *plugin)
     // and call the cycle function
 }
 
+void plugin_driver_reset_hook_timing(void)
+{
+    longest_hook.plugin      = NULL;
+    longest_hook.hook        = NULL;
+    longest_hook.duration_ns = 0;
+}
+
+const plugin_hook_timing_t *plugin_driver_longest_hook(void)
+{
+    return longest_hook.plugin != NULL ? &longest_hook : NULL;
+}
+
+// Call a native hook and keep track of the longest one for overrun forensics
+static void run_native_hook(plugin_instance_t *plugin, void (*hook)(void), const char *hook_name)
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    hook();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int64_t duration_ns =
+        (int64_t)(end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+    if (duration_ns > longest_hook.duration_ns || longest_hook.plugin == NULL)
+    {
+        longest_hook.plugin      = plugin->config.name;
+        longest_hook.hook        = hook_name;
+        longest_hook.duration_ns = duration_ns;
+    }
+}
+
 // Call cycle_start for all active native plugins that have registered the hook
 // This should be called at the beginning of each PLC scan cycle, before PLC logic execution
 // Plugins opt-in by implementing cycle_start(); opt-out by not implementing it (NULL pointer)
@@ -1037,7 +1161,7 @@ void plugin_driver_cycle_start(plugin_driver_t *driver)
         if (plugin->config.type == PLUGIN_TYPE_NATIVE && plugin->native_plugin &&
             plugin->native_plugin->cycle_start)
         {
-            plugin->native_plugin->cycle_start();
+            run_native_hook(plugin, plugin->native_plugin->cycle_start, "cycle_start");
         }
     }
 }
@@ -1066,11 +1190,169 @@ void plugin_driver_cycle_end(plugin_driver_t *driver)
         if (plugin->config.type == PLUGIN_TYPE_NATIVE && plugin->native_plugin &&
             plugin->native_plugin->cycle_end)
         {
-            plugin->native_plugin->cycle_end();
+            run_native_hook(plugin, plugin->native_plugin->cycle_end, "cycle_end");
         }
     }
 }
 
+// Call input_latch for all active native plugins that have registered the hook
+// This is called right before PLC logic execution: inputs delivered later miss this scan
+// Plugins opt-in by implementing input_latch(); opt-out by not implementing it (NULL pointer)
+void plugin_driver_input_latch(plugin_driver_t *driver)
+{
+    if (!driver || driver->plugin_count == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < driver->plugin_count; i++)
+    {
+        plugin_instance_t *plugin = &driver->plugins[i];
+
+        // Skip non-running plugins
+        if (!plugin->running)
+        {
+            continue;
+        }
+
+        if (plugin->config.type == PLUGIN_TYPE_NATIVE && plugin->native_plugin &&
+            plugin->native_plugin->input_latch)
+        {
+            run_native_hook(plugin, plugin->native_plugin->input_latch, "input_latch");
+        }
+    }
+}
+
+// Call output_flush for all active native plugins that have registered the hook
+// This is called right after PLC logic execution, as soon as the outputs are final
+// Plugins opt-in by implementing output_flush(); opt-out by not implementing it (NULL pointer)
+void plugin_driver_output_flush(plugin_driver_t *driver)
+{
+    if (!driver || driver->plugin_count == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < driver->plugin_count; i++)
+    {
+        plugin_instance_t *plugin = &driver->plugins[i];
+
+        // Skip non-running plugins
+        if (!plugin->running)
+        {
+            continue;
+        }
+
+        if (plugin->config.type == PLUGIN_TYPE_NATIVE && plugin->native_plugin &&
+            plugin->native_plugin->output_flush)
+        {
+            run_native_hook(plugin, plugin->native_plugin->output_flush, "output_flush");
+        }
+    }
+}
+
+// Call outputs_safe for all active native plugins that have registered the hook
+// This is called by the scan watchdog when a scan stalled, without buffer_mutex
+// Plugins opt-in by implementing outputs_safe(); opt-out by not implementing it (NULL pointer)
+void plugin_driver_outputs_safe(plugin_driver_t *driver)
+{
+    if (!driver || driver->plugin_count == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < driver->plugin_count; i++)
+    {
+        plugin_instance_t *plugin = &driver->plugins[i];
+
+        // Skip non-running plugins
+        if (!plugin->running)
+        {
+            continue;
+        }
+
+        if (plugin->config.type == PLUGIN_TYPE_NATIVE && plugin->native_plugin &&
+            plugin->native_plugin->outputs_safe)
+        {
+            plugin->native_plugin->outputs_safe();
+        }
+    }
+}
+
+// Call an online change hook of all running Python plugins that implement it
+static void call_python_program_hooks(plugin_driver_t *driver, bool changing)
+{
+    if (!has_python_plugin || !Py_IsInitialized())
+    {
+        return;
+    }
+
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    for (int i = 0; i < driver->plugin_count; i++)
+    {
+        plugin_instance_t *plugin = &driver->plugins[i];
+        if (!plugin->running || !plugin->python_plugin)
+        {
+            continue;
+        }
+        PyObject *func = changing ? plugin->python_plugin->pFuncProgramChanging
+                                  : plugin->python_plugin->pFuncProgramChanged;
+        if (!func)
+        {
+            continue;
+        }
+
+        PyObject *res = PyObject_CallNoArgs(func);
+        if (!res)
+        {
+            PyErr_Print();
+            log_error("Python %s call failed for plugin: %s",
+                      changing ? "program_changing" : "program_changed", plugin->config.name);
+        }
+        else
+        {
+            Py_DECREF(res);
+        }
+    }
+    PyGILState_Release(gstate);
+}
+
+// Call program_changing for all running Python plugins that implement it
+void plugin_driver_program_changing(plugin_driver_t *driver)
+{
+    if (!driver || driver->plugin_count == 0)
+    {
+        return;
+    }
+
+    call_python_program_hooks(driver, true);
+}
+
+// Call program_changed for all running plugins of the given type that implement it
+void plugin_driver_program_changed(plugin_driver_t *driver, plugin_type_t type)
+{
+    if (!driver || driver->plugin_count == 0)
+    {
+        return;
+    }
+
+    if (type == PLUGIN_TYPE_NATIVE)
+    {
+        for (int i = 0; i < driver->plugin_count; i++)
+        {
+            plugin_instance_t *plugin = &driver->plugins[i];
+            if (plugin->running && plugin->config.type == PLUGIN_TYPE_NATIVE &&
+                plugin->native_plugin && plugin->native_plugin->program_changed)
+            {
+                plugin->native_plugin->program_changed();
+            }
+        }
+        return;
+    }
+
+    call_python_program_hooks(driver, false);
+}
+
 // Cleanup Python plugin
 static void python_plugin_cleanup(plugin_instance_t *plugin)
 {
@@ -1098,6 +1380,8 @@ static void python_plugin_cleanup(plugin_instance_t *plugin)
         Py_XDECREF(plugin->python_plugin->pFuncStart);
         Py_XDECREF(plugin->python_plugin->pFuncStop);
         Py_XDECREF(plugin->python_plugin->pFuncCleanup);
+        Py_XDECREF(plugin->python_plugin->pFuncProgramChanging);
+        Py_XDECREF(plugin->python_plugin->pFuncProgramChanged);
         Py_XDECREF(plugin->python_plugin->pModule);
         Py_XDECREF(plugin->python_plugin->args_capsule);
 
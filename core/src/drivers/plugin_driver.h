@@ -20,6 +20,10 @@ typedef int (*plugin_start_loop_func_t)(void);
 typedef void (*plugin_stop_loop_func_t)(void);
 typedef void (*plugin_cycle_start_func_t)(void);
 typedef void (*plugin_cycle_end_func_t)(void);
+typedef void (*plugin_input_latch_func_t)(void);
+typedef void (*plugin_output_flush_func_t)(void);
+typedef void (*plugin_outputs_safe_func_t)(void);
+typedef void (*plugin_program_changed_func_t)(void);
 typedef void (*plugin_cleanup_func_t)(void);
 
 typedef struct
@@ -30,6 +34,10 @@ typedef struct
     plugin_stop_loop_func_t stop;
     plugin_cycle_start_func_t cycle_start;
     plugin_cycle_end_func_t cycle_end;
+    plugin_input_latch_func_t input_latch;
+    plugin_output_flush_func_t output_flush;
+    plugin_outputs_safe_func_t outputs_safe;
+    plugin_program_changed_func_t program_changed;
     plugin_cleanup_func_t cleanup;
 } plugin_funct_bundle_t;
 
@@ -52,6 +60,14 @@ typedef struct
     pthread_mutex_t buffer_mutex;
 } plugin_driver_t;
 
+// Longest native hook call, see plugin_driver_longest_hook()
+typedef struct
+{
+    const char *plugin; // Name from plugins.conf
+    const char *hook;   // "cycle_start", "input_latch", "output_flush" or "cycle_end"
+    int64_t duration_ns;
+} plugin_hook_timing_t;
+
 // Driver management functions
 plugin_driver_t *plugin_driver_create(void);
 int plugin_driver_load_config(plugin_driver_t *driver, const char *config_file);
@@ -69,6 +85,37 @@ int plugin_mutex_give(pthread_mutex_t *mutex);
 void plugin_driver_cycle_start(plugin_driver_t *driver);
 void plugin_driver_cycle_end(plugin_driver_t *driver);
 
+// I/O phase hooks for fieldbus plugins, called with buffer_mutex held. input_latch runs
+// right before the PLC program, the last point to deliver inputs for this scan;
+// output_flush runs right after it, the first point the scan's outputs are final.
+// Plugins opt-in by implementing input_latch/output_flush; opt-out by not implementing them
+void plugin_driver_input_latch(plugin_driver_t *driver);
+void plugin_driver_output_flush(plugin_driver_t *driver);
+
+// Ask fieldbus plugins to drive their outputs to a safe state because the scan stalled.
+// Called by the scan watchdog thread without buffer_mutex, which the stalled scan may hold,
+// so the hook runs concurrently with the plugin's other hooks.
+// Plugins opt-in by implementing outputs_safe(); opt-out by not implementing it
+void plugin_driver_outputs_safe(plugin_driver_t *driver);
+
+// Timing of the native cycle and I/O hooks for overrun forensics. The PLC cycle thread
+// resets it at the start of every scan; plugin_driver_longest_hook() then returns the
+// longest hook called since, or NULL if no hook was called.
+void plugin_driver_reset_hook_timing(void);
+const plugin_hook_timing_t *plugin_driver_longest_hook(void);
+
+// Notify running Python plugins that an online change is about to switch programs.
+// Called from the requesting thread; plugins stop using cached variable addresses
+// until program_changed(). Plugins opt-in by implementing program_changing().
+void plugin_driver_program_changing(plugin_driver_t *driver);
+
+// Notify running plugins that an online change replaced the PLC program.
+// Native hooks are called by the PLC cycle thread with buffer_mutex held, before the
+// first cycle of the new program; Python hooks afterwards from the requesting thread,
+// also after a failed switch to resume on the unchanged program.
+// Plugins opt-in by implementing program_changed(); without it they keep their state.
+void plugin_driver_program_changed(plugin_driver_t *driver, plugin_type_t type);
+
 // Python plugin functions
 int python_plugin_get_symbols(plugin_instance_t *plugin);
 
@@ -51,6 +51,49 @@ typedef int (*plugin_journal_write_int_func_t)(int type, int index, int value);
 typedef int (*plugin_journal_write_dint_func_t)(int type, int index, unsigned int value);
 typedef int (*plugin_journal_write_lint_func_t)(int type, int index, unsigned long long value);
 
+/**
+ * @brief One contiguous range for journal_write_ranges
+ *
+ * values points to count elements in the native layout of the buffer type:
+ * one byte per index for BOOL buffers (bit n = %X index.n), and uint8_t,
+ * uint16_t, uint32_t or uint64_t arrays for BYTE, INT, DINT and LINT buffers.
+ */
+typedef struct
+{
+    int type;
+    int start_index;
+    int count;
+    const void *values;
+} plugin_journal_range_t;
+
+/**
+ * @brief Write several ranges so they are applied in the same scan cycle
+ *
+ * Returns 0 on success, -1 if a range is invalid or the batch is too large
+ * (in which case nothing is written).
+ */
+typedef int (*plugin_journal_write_ranges_func_t)(const plugin_journal_range_t *ranges,
+                                                  int range_count);
+
+/**
+ * @brief Monotonic runtime time in nanoseconds
+ *
+ * Follows the virtual clock when the runtime runs in free-run mode, so
+ * plugins that time-stamp or rate-limit stay consistent with program time.
+ */
+typedef uint64_t (*plugin_get_time_ns_func_t)(void);
+
+/**
+ * @brief Run the event task with the given name as soon as possible
+ *
+ * For events such as an input edge or a received frame. The task runs on
+ * its own high-priority thread when the runtime runs in multi-task mode;
+ * raises that arrive while it runs are coalesced into one further run.
+ * Never blocks. Returns 0 if the task was scheduled, -1 if the program has
+ * no event task of that name or the runtime is not in multi-task mode.
+ */
+typedef int (*plugin_raise_event_func_t)(const char *name);
+
 /**
  * @brief Runtime buffer access structure for plugins
  *
@@ -112,6 +155,13 @@ typedef struct
     plugin_journal_write_int_func_t journal_write_int;
     plugin_journal_write_dint_func_t journal_write_dint;
     plugin_journal_write_lint_func_t journal_write_lint;
+    plugin_journal_write_ranges_func_t journal_write_ranges;
+
+    /* Runtime clock, virtual in free-run mode */
+    plugin_get_time_ns_func_t get_time_ns;
+
+    /* Event tasks of the PLC program */
+    plugin_raise_event_func_t raise_event;
 } plugin_runtime_args_t;
 
 #endif /* PLUGIN_TYPES_H */
@@ -164,6 +164,50 @@ void cycle_end(void)
     }
 }
 
+/**
+ * @brief Called right before the PLC logic of each scan
+ *
+ * Last point to deliver inputs for this scan, e.g. the inputs a fieldbus
+ * exchange just received. The buffer mutex is held.
+ */
+void input_latch(void)
+{
+    if (!plugin_initialized || !plugin_running)
+    {
+        return; /* Silent if not running */
+    }
+}
+
+/**
+ * @brief Called right after the PLC logic of each scan
+ *
+ * First point the outputs of this scan are final, e.g. to start a fieldbus
+ * exchange with them. The buffer mutex is held.
+ */
+void output_flush(void)
+{
+    if (!plugin_initialized || !plugin_running)
+    {
+        return; /* Silent if not running */
+    }
+}
+
+/**
+ * @brief Called by the scan watchdog when a scan stalled
+ *
+ * Drive the outputs this plugin controls to their safe state. Runs on the
+ * watchdog thread without the buffer mutex, which the stalled scan may hold.
+ */
+void outputs_safe(void)
+{
+    if (!plugin_initialized || !plugin_running)
+    {
+        return; /* Silent if not running */
+    }
+
+    plugin_logger_warn(&g_logger, "Scan stalled, outputs forced safe");
+}
+
 /**
  * @brief Cleanup plugin resources
  *
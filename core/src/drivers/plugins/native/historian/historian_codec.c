@@ -0,0 +1,491 @@
+/**
+ * @file historian_codec.c
+ * @brief Time-series column codecs for the historian plugin
+ *
+ * Bits are written MSB first. Timestamp delta-of-delta prefixes:
+ *
+ *     0                    dod == 0
+ *     10    + 7 bits       dod in [-64, 63]
+ *     110   + 9 bits       dod in [-256, 255]
+ *     1110  + 12 bits      dod in [-2048, 2047]
+ *     11110 + 32 bits      dod fits int32
+ *     11111 + 64 bits      anything else
+ *
+ * Float XOR encoding:
+ *
+ *     0                                    same value as previous
+ *     10 + meaningful bits                 fits the previous leading/trailing window
+ *     11 + 5 bits leading + 6 bits length  new window, followed by the meaningful bits
+ */
+
+#include "historian_codec.h"
+
+#include <string.h>
+
+/*
+ * =============================================================================
+ * Bit I/O
+ * =============================================================================
+ */
+
+static int write_bits(hist_column_encoder_t *enc, uint64_t value, int nbits)
+{
+    if (enc->bitpos + (size_t)nbits > enc->cap * 8)
+    {
+        return -1;
+    }
+
+    while (nbits > 0)
+    {
+        size_t byte   = enc->bitpos >> 3;
+        int free_bits = 8 - (int)(enc->bitpos & 7);
+        int take      = nbits < free_bits ? nbits : free_bits;
+        uint8_t chunk = (uint8_t)((value >> (nbits - take)) & ((1U << take) - 1));
+
+        if (free_bits == 8)
+        {
+            enc->buf[byte] = 0;
+        }
+        enc->buf[byte] |= (uint8_t)(chunk << (free_bits - take));
+        enc->bitpos += (size_t)take;
+        nbits -= take;
+    }
+    return 0;
+}
+
+static int write_varint(hist_column_encoder_t *enc, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        if (write_bits(enc, (value & 0x7F) | 0x80, 8) != 0)
+        {
+            return -1;
+        }
+        value >>= 7;
+    }
+    return write_bits(enc, value, 8);
+}
+
+typedef struct
+{
+    const uint8_t *buf;
+    size_t len_bits;
+    size_t bitpos;
+} bit_reader_t;
+
+static int read_bits(bit_reader_t *r, int nbits, uint64_t *out)
+{
+    if (r->bitpos + (size_t)nbits > r->len_bits)
+    {
+        return -1;
+    }
+
+    uint64_t value = 0;
+    while (nbits > 0)
+    {
+        size_t byte    = r->bitpos >> 3;
+        int avail_bits = 8 - (int)(r->bitpos & 7);
+        int take       = nbits < avail_bits ? nbits : avail_bits;
+        uint8_t chunk  = (uint8_t)((r->buf[byte] >> (avail_bits - take)) & ((1U << take) - 1));
+
+        value = (value << take) | chunk;
+        r->bitpos += (size_t)take;
+        nbits -= take;
+    }
+    *out = value;
+    return 0;
+}
+
+static int read_varint(bit_reader_t *r, uint64_t *out)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        uint64_t byte;
+        if (read_bits(r, 8, &byte) != 0)
+        {
+            return -1;
+        }
+        value |= (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *out = value;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int64_t sign_extend(uint64_t value, int nbits)
+{
+    if (nbits >= 64)
+    {
+        return (int64_t)value;
+    }
+    uint64_t sign = 1ULL << (nbits - 1);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+static uint64_t zigzag_encode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/*
+ * =============================================================================
+ * Encoders
+ * =============================================================================
+ */
+
+uint64_t hist_double_to_raw(double value)
+{
+    uint64_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    return raw;
+}
+
+double hist_raw_to_double(uint64_t raw)
+{
+    double value;
+    memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+size_t hist_column_max_bytes(hist_column_type_t type, uint32_t samples)
+{
+    switch (type)
+    {
+    case HIST_COL_TIMESTAMP:
+        return 16 + ((size_t)samples * (5 + 64) + 7) / 8;
+    case HIST_COL_FLOAT:
+        return 16 + ((size_t)samples * (2 + 5 + 6 + 64) + 7) / 8;
+    case HIST_COL_INT:
+    case HIST_COL_BOOL:
+    default:
+        return 16 + (size_t)samples * 10;
+    }
+}
+
+void hist_column_init(hist_column_encoder_t *enc, hist_column_type_t type, uint8_t *buf,
+                      size_t cap)
+{
+    memset(enc, 0, sizeof(*enc));
+    enc->type          = type;
+    enc->buf           = buf;
+    enc->cap           = cap;
+    enc->prev_leading  = -1;
+    enc->prev_trailing = 0;
+}
+
+static int append_timestamp(hist_column_encoder_t *enc, int64_t ts)
+{
+    if (enc->count == 0)
+    {
+        return write_bits(enc, (uint64_t)ts, 64);
+    }
+
+    int64_t delta = ts - (int64_t)enc->prev;
+    int64_t dod   = delta - enc->prev_delta;
+    enc->prev_delta = delta;
+
+    if (dod == 0)
+    {
+        return write_bits(enc, 0x0, 1);
+    }
+    if (dod >= -64 && dod <= 63)
+    {
+        return write_bits(enc, 0x2, 2) | write_bits(enc, (uint64_t)dod & 0x7F, 7);
+    }
+    if (dod >= -256 && dod <= 255)
+    {
+        return write_bits(enc, 0x6, 3) | write_bits(enc, (uint64_t)dod & 0x1FF, 9);
+    }
+    if (dod >= -2048 && dod <= 2047)
+    {
+        return write_bits(enc, 0xE, 4) | write_bits(enc, (uint64_t)dod & 0xFFF, 12);
+    }
+    if (dod >= INT32_MIN && dod <= INT32_MAX)
+    {
+        return write_bits(enc, 0x1E, 5) | write_bits(enc, (uint64_t)dod & 0xFFFFFFFFULL, 32);
+    }
+    return write_bits(enc, 0x1F, 5) | write_bits(enc, (uint64_t)dod, 64);
+}
+
+static int append_float(hist_column_encoder_t *enc, uint64_t raw)
+{
+    if (enc->count == 0)
+    {
+        return write_bits(enc, raw, 64);
+    }
+
+    uint64_t xor_value = raw ^ enc->prev;
+    if (xor_value == 0)
+    {
+        return write_bits(enc, 0x0, 1);
+    }
+
+    int leading  = __builtin_clzll(xor_value);
+    int trailing = __builtin_ctzll(xor_value);
+    if (leading > 31)
+    {
+        leading = 31;
+    }
+
+    if (enc->prev_leading >= 0 && leading >= enc->prev_leading && trailing >= enc->prev_trailing)
+    {
+        int meaningful = 64 - enc->prev_leading - enc->prev_trailing;
+        return write_bits(enc, 0x2, 2) |
+               write_bits(enc, xor_value >> enc->prev_trailing, meaningful);
+    }
+
+    int meaningful     = 64 - leading - trailing;
+    enc->prev_leading  = leading;
+    enc->prev_trailing = trailing;
+    return write_bits(enc, 0x3, 2) | write_bits(enc, (uint64_t)leading, 5) |
+           write_bits(enc, (uint64_t)(meaningful & 0x3F), 6) |
+           write_bits(enc, xor_value >> trailing, meaningful);
+}
+
+static int append_int(hist_column_encoder_t *enc, uint64_t value)
+{
+    int64_t delta = (int64_t)(value - (enc->count == 0 ? 0 : enc->prev));
+    return write_varint(enc, zigzag_encode(delta));
+}
+
+static int append_bool(hist_column_encoder_t *enc, uint64_t value)
+{
+    value = value ? 1 : 0;
+    if (enc->count == 0)
+    {
+        enc->run_length = 1;
+        return write_bits(enc, value, 1);
+    }
+    if (value == enc->prev)
+    {
+        enc->run_length++;
+        return 0;
+    }
+    int result      = write_varint(enc, enc->run_length);
+    enc->run_length = 1;
+    return result;
+}
+
+int hist_column_append(hist_column_encoder_t *enc, uint64_t value)
+{
+    int result;
+    switch (enc->type)
+    {
+    case HIST_COL_TIMESTAMP:
+        result = append_timestamp(enc, (int64_t)value);
+        break;
+    case HIST_COL_FLOAT:
+        result = append_float(enc, value);
+        break;
+    case HIST_COL_INT:
+        result = append_int(enc, value);
+        break;
+    case HIST_COL_BOOL:
+        value  = value ? 1 : 0;
+        result = append_bool(enc, value);
+        break;
+    default:
+        return -1;
+    }
+
+    if (result != 0)
+    {
+        return -1;
+    }
+    enc->prev = value;
+    enc->count++;
+    return 0;
+}
+
+size_t hist_column_finish(hist_column_encoder_t *enc)
+{
+    if (enc->type == HIST_COL_BOOL && enc->count > 0)
+    {
+        if (write_varint(enc, enc->run_length) != 0)
+        {
+            return 0;
+        }
+        enc->run_length = 0;
+    }
+    return (enc->bitpos + 7) / 8;
+}
+
+/*
+ * =============================================================================
+ * Decoders
+ * =============================================================================
+ */
+
+static int decode_timestamps(bit_reader_t *r, uint32_t count, uint64_t *out)
+{
+    uint64_t first;
+    if (read_bits(r, 64, &first) != 0)
+    {
+        return -1;
+    }
+    out[0] = first;
+
+    int64_t prev  = (int64_t)first;
+    int64_t delta = 0;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        /* Count leading 1 bits of the prefix (at most 5) */
+        int ones = 0;
+        uint64_t bit;
+        while (ones < 5)
+        {
+            if (read_bits(r, 1, &bit) != 0)
+            {
+                return -1;
+            }
+            if (bit == 0)
+            {
+                break;
+            }
+            ones++;
+        }
+
+        static const int payload_bits[] = {0, 7, 9, 12, 32, 64};
+        int64_t dod                     = 0;
+        if (ones > 0)
+        {
+            uint64_t raw;
+            if (read_bits(r, payload_bits[ones], &raw) != 0)
+            {
+                return -1;
+            }
+            dod = sign_extend(raw, payload_bits[ones]);
+        }
+
+        delta += dod;
+        prev += delta;
+        out[i] = (uint64_t)prev;
+    }
+    return 0;
+}
+
+static int decode_floats(bit_reader_t *r, uint32_t count, uint64_t *out)
+{
+    uint64_t prev;
+    if (read_bits(r, 64, &prev) != 0)
+    {
+        return -1;
+    }
+    out[0] = prev;
+
+    int leading = 0, trailing = 0;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        uint64_t bit;
+        if (read_bits(r, 1, &bit) != 0)
+        {
+            return -1;
+        }
+        if (bit == 1)
+        {
+            uint64_t control;
+            if (read_bits(r, 1, &control) != 0)
+            {
+                return -1;
+            }
+            if (control == 1)
+            {
+                uint64_t lead, length;
+                if (read_bits(r, 5, &lead) != 0 || read_bits(r, 6, &length) != 0)
+                {
+                    return -1;
+                }
+                int meaningful = length == 0 ? 64 : (int)length;
+                leading        = (int)lead;
+                trailing       = 64 - leading - meaningful;
+                if (trailing < 0)
+                {
+                    return -1;
+                }
+            }
+
+            uint64_t bits;
+            if (read_bits(r, 64 - leading - trailing, &bits) != 0)
+            {
+                return -1;
+            }
+            prev ^= bits << trailing;
+        }
+        out[i] = prev;
+    }
+    return 0;
+}
+
+static int decode_ints(bit_reader_t *r, uint32_t count, uint64_t *out)
+{
+    uint64_t prev = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t zz;
+        if (read_varint(r, &zz) != 0)
+        {
+            return -1;
+        }
+        prev += (uint64_t)zigzag_decode(zz);
+        out[i] = prev;
+    }
+    return 0;
+}
+
+static int decode_bools(bit_reader_t *r, uint32_t count, uint64_t *out)
+{
+    uint64_t value;
+    if (read_bits(r, 1, &value) != 0)
+    {
+        return -1;
+    }
+
+    uint32_t i = 0;
+    while (i < count)
+    {
+        uint64_t run;
+        if (read_varint(r, &run) != 0 || run == 0 || run > count - i)
+        {
+            return -1;
+        }
+        for (uint64_t j = 0; j < run; j++)
+        {
+            out[i++] = value;
+        }
+        value ^= 1;
+    }
+    return 0;
+}
+
+int hist_column_decode(hist_column_type_t type, const uint8_t *buf, size_t len, uint32_t count,
+                       uint64_t *out)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    bit_reader_t r = {.buf = buf, .len_bits = len * 8, .bitpos = 0};
+    switch (type)
+    {
+    case HIST_COL_TIMESTAMP:
+        return decode_timestamps(&r, count, out);
+    case HIST_COL_FLOAT:
+        return decode_floats(&r, count, out);
+    case HIST_COL_INT:
+        return decode_ints(&r, count, out);
+    case HIST_COL_BOOL:
+        return decode_bools(&r, count, out);
+    default:
+        return -1;
+    }
+}
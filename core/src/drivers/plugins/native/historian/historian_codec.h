@@ -0,0 +1,119 @@
+/**
+ * @file historian_codec.h
+ * @brief Time-series column codecs for the historian plugin
+ *
+ * Each column of a block is encoded independently into a caller-provided
+ * buffer:
+ *
+ * - HIST_COL_TIMESTAMP: int64 microseconds, delta-of-delta with variable
+ *   length prefixes (a steady scan period costs one bit per sample)
+ * - HIST_COL_FLOAT: IEEE-754 doubles, XOR against the previous value with
+ *   leading/trailing zero windows (Gorilla style)
+ * - HIST_COL_INT: int64, zigzag-encoded deltas as varints
+ * - HIST_COL_BOOL: run-length encoded, initial bit followed by varint runs
+ *
+ * Values are passed as raw 64-bit words: doubles by bit pattern, integers as
+ * two's complement and booleans as 0/1.
+ *
+ * The codec has no dependencies on the runtime so it can be reused by the
+ * query tool and unit tests.
+ */
+
+#ifndef HISTORIAN_CODEC_H
+#define HISTORIAN_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    HIST_COL_TIMESTAMP = 0,
+    HIST_COL_BOOL      = 1,
+    HIST_COL_INT       = 2,
+    HIST_COL_FLOAT     = 3
+} hist_column_type_t;
+
+/**
+ * @brief Streaming encoder for one column of one block
+ */
+typedef struct
+{
+    hist_column_type_t type;
+    uint8_t *buf;     /* Output buffer */
+    size_t cap;       /* Buffer capacity in bytes */
+    size_t bitpos;    /* Bits written so far */
+    uint32_t count;   /* Values appended */
+
+    uint64_t prev;       /* Previous value (raw bits) */
+    int64_t prev_delta;  /* Timestamp: previous delta */
+    int prev_leading;    /* Float: leading zeros of the current XOR window */
+    int prev_trailing;   /* Float: trailing zeros of the current XOR window */
+    uint64_t run_length; /* Bool: length of the current run */
+} hist_column_encoder_t;
+
+/**
+ * @brief Worst-case encoded size of a column
+ *
+ * @param type    Column type
+ * @param samples Number of values
+ * @return Buffer size that can hold any @p samples values of @p type
+ */
+size_t hist_column_max_bytes(hist_column_type_t type, uint32_t samples);
+
+/**
+ * @brief Start a new column
+ *
+ * @param enc  Encoder to initialize
+ * @param type Column type
+ * @param buf  Output buffer
+ * @param cap  Output buffer capacity (see hist_column_max_bytes())
+ */
+void hist_column_init(hist_column_encoder_t *enc, hist_column_type_t type, uint8_t *buf,
+                      size_t cap);
+
+/**
+ * @brief Append one value
+ *
+ * @return 0 on success, -1 if the buffer is full
+ */
+int hist_column_append(hist_column_encoder_t *enc, uint64_t value);
+
+/**
+ * @brief Finish the column
+ *
+ * @return Encoded size in bytes, or 0 if the buffer overflowed
+ */
+size_t hist_column_finish(hist_column_encoder_t *enc);
+
+/**
+ * @brief Decode a column
+ *
+ * @param type  Column type
+ * @param buf   Encoded column
+ * @param len   Encoded size in bytes
+ * @param count Number of values to decode
+ * @param out   Receives @p count raw values
+ * @return 0 on success, -1 if the data is truncated or malformed
+ */
+int hist_column_decode(hist_column_type_t type, const uint8_t *buf, size_t len, uint32_t count,
+                       uint64_t *out);
+
+/**
+ * @brief Convert a double to its raw column representation
+ */
+uint64_t hist_double_to_raw(double value);
+
+/**
+ * @brief Convert a raw column value back to a double
+ */
+double hist_raw_to_double(uint64_t raw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORIAN_CODEC_H */
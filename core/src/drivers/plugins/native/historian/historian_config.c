@@ -0,0 +1,339 @@
+/**
+ * @file historian_config.c
+ * @brief Historian Plugin Configuration Parser Implementation
+ *
+ * Parses JSON configuration files using cJSON library.
+ */
+
+#include "historian_config.h"
+#include "cJSON.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Error codes */
+#define HISTORIAN_CONFIG_OK          0
+#define HISTORIAN_CONFIG_ERR_FILE    -1
+#define HISTORIAN_CONFIG_ERR_PARSE   -2
+#define HISTORIAN_CONFIG_ERR_INVALID -4
+
+/* Buffer name mappings */
+static const struct
+{
+    const char *name;
+    historian_buffer_t buffer;
+    historian_value_type_t default_type;
+} buffer_map[] = {
+    {"bool_input", HIST_BUFFER_BOOL_INPUT, HIST_TYPE_BOOL},
+    {"bool_output", HIST_BUFFER_BOOL_OUTPUT, HIST_TYPE_BOOL},
+    {"bool_memory", HIST_BUFFER_BOOL_MEMORY, HIST_TYPE_BOOL},
+    {"byte_input", HIST_BUFFER_BYTE_INPUT, HIST_TYPE_USINT},
+    {"byte_output", HIST_BUFFER_BYTE_OUTPUT, HIST_TYPE_USINT},
+    {"int_input", HIST_BUFFER_INT_INPUT, HIST_TYPE_UINT},
+    {"int_output", HIST_BUFFER_INT_OUTPUT, HIST_TYPE_UINT},
+    {"int_memory", HIST_BUFFER_INT_MEMORY, HIST_TYPE_UINT},
+    {"dint_input", HIST_BUFFER_DINT_INPUT, HIST_TYPE_UDINT},
+    {"dint_output", HIST_BUFFER_DINT_OUTPUT, HIST_TYPE_UDINT},
+    {"dint_memory", HIST_BUFFER_DINT_MEMORY, HIST_TYPE_UDINT},
+    {"lint_input", HIST_BUFFER_LINT_INPUT, HIST_TYPE_ULINT},
+    {"lint_output", HIST_BUFFER_LINT_OUTPUT, HIST_TYPE_ULINT},
+    {"lint_memory", HIST_BUFFER_LINT_MEMORY, HIST_TYPE_ULINT},
+    {NULL, HIST_BUFFER_NONE, HIST_TYPE_NONE}};
+
+/* Value type mappings (IEC names, with the bit-string aliases) */
+static const struct
+{
+    const char *name;
+    historian_value_type_t type;
+    int size;
+} type_map[] = {
+    {"BOOL", HIST_TYPE_BOOL, 1},   {"SINT", HIST_TYPE_SINT, 1},   {"USINT", HIST_TYPE_USINT, 1},
+    {"BYTE", HIST_TYPE_USINT, 1},  {"INT", HIST_TYPE_INT, 2},     {"UINT", HIST_TYPE_UINT, 2},
+    {"WORD", HIST_TYPE_UINT, 2},   {"DINT", HIST_TYPE_DINT, 4},   {"UDINT", HIST_TYPE_UDINT, 4},
+    {"DWORD", HIST_TYPE_UDINT, 4}, {"LINT", HIST_TYPE_LINT, 8},   {"ULINT", HIST_TYPE_ULINT, 8},
+    {"LWORD", HIST_TYPE_ULINT, 8}, {"REAL", HIST_TYPE_REAL, 4},   {"LREAL", HIST_TYPE_LREAL, 8},
+    {NULL, HIST_TYPE_NONE, 0}};
+
+/**
+ * @brief Read entire file into a string
+ */
+static char *read_file(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (size <= 0 || size > 1024 * 1024)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    char *buffer = (char *)malloc(size + 1);
+    if (buffer == NULL)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    size_t read_size = fread(buffer, 1, size, fp);
+    fclose(fp);
+
+    if ((long)read_size != size)
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    buffer[size] = '\0';
+    return buffer;
+}
+
+const char *historian_type_name(historian_value_type_t type)
+{
+    for (int i = 0; type_map[i].name != NULL; i++)
+    {
+        if (type_map[i].type == type)
+        {
+            return type_map[i].name;
+        }
+    }
+    return "NONE";
+}
+
+historian_value_type_t historian_type_from_name(const char *name)
+{
+    if (name == NULL)
+    {
+        return HIST_TYPE_NONE;
+    }
+    for (int i = 0; type_map[i].name != NULL; i++)
+    {
+        if (strcmp(name, type_map[i].name) == 0)
+        {
+            return type_map[i].type;
+        }
+    }
+    return HIST_TYPE_NONE;
+}
+
+int historian_type_size(historian_value_type_t type)
+{
+    for (int i = 0; type_map[i].name != NULL; i++)
+    {
+        if (type_map[i].type == type)
+        {
+            return type_map[i].size;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Element size of an image buffer (0 for BOOL and debug variables)
+ */
+static int buffer_element_size(historian_buffer_t buffer)
+{
+    switch (buffer)
+    {
+    case HIST_BUFFER_BYTE_INPUT:
+    case HIST_BUFFER_BYTE_OUTPUT:
+        return 1;
+    case HIST_BUFFER_INT_INPUT:
+    case HIST_BUFFER_INT_OUTPUT:
+    case HIST_BUFFER_INT_MEMORY:
+        return 2;
+    case HIST_BUFFER_DINT_INPUT:
+    case HIST_BUFFER_DINT_OUTPUT:
+    case HIST_BUFFER_DINT_MEMORY:
+        return 4;
+    case HIST_BUFFER_LINT_INPUT:
+    case HIST_BUFFER_LINT_OUTPUT:
+    case HIST_BUFFER_LINT_MEMORY:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Parse one entry of the "signals" array
+ */
+static int parse_signal(const cJSON *entry, historian_signal_config_t *sig)
+{
+    memset(sig, 0, sizeof(*sig));
+
+    const cJSON *field = cJSON_GetObjectItemCaseSensitive(entry, "name");
+    if (!cJSON_IsString(field) || field->valuestring == NULL || field->valuestring[0] == '\0')
+    {
+        return HISTORIAN_CONFIG_ERR_INVALID;
+    }
+    strncpy(sig->name, field->valuestring, HISTORIAN_MAX_NAME_LEN - 1);
+
+    historian_value_type_t default_type = HIST_TYPE_NONE;
+    field = cJSON_GetObjectItemCaseSensitive(entry, "debug_index");
+    if (cJSON_IsNumber(field))
+    {
+        sig->buffer = HIST_BUFFER_DEBUG_VARIABLE;
+        sig->index  = field->valueint;
+    }
+    else
+    {
+        field = cJSON_GetObjectItemCaseSensitive(entry, "buffer");
+        if (!cJSON_IsString(field) || field->valuestring == NULL)
+        {
+            return HISTORIAN_CONFIG_ERR_INVALID;
+        }
+        for (int i = 0; buffer_map[i].name != NULL; i++)
+        {
+            if (strcmp(field->valuestring, buffer_map[i].name) == 0)
+            {
+                sig->buffer  = buffer_map[i].buffer;
+                default_type = buffer_map[i].default_type;
+                break;
+            }
+        }
+        if (sig->buffer == HIST_BUFFER_NONE)
+        {
+            return HISTORIAN_CONFIG_ERR_INVALID;
+        }
+
+        field      = cJSON_GetObjectItemCaseSensitive(entry, "index");
+        sig->index = cJSON_IsNumber(field) ? field->valueint : 0;
+        field      = cJSON_GetObjectItemCaseSensitive(entry, "bit");
+        sig->bit   = cJSON_IsNumber(field) ? field->valueint : 0;
+    }
+
+    field     = cJSON_GetObjectItemCaseSensitive(entry, "type");
+    sig->type = cJSON_IsString(field) ? historian_type_from_name(field->valuestring) : default_type;
+
+    if (sig->type == HIST_TYPE_NONE || sig->index < 0 || sig->bit < 0 || sig->bit > 7)
+    {
+        return HISTORIAN_CONFIG_ERR_INVALID;
+    }
+
+    /* A typed view of an image buffer must match its element size */
+    int element_size = buffer_element_size(sig->buffer);
+    if (element_size != 0 && element_size != historian_type_size(sig->type))
+    {
+        return HISTORIAN_CONFIG_ERR_INVALID;
+    }
+    if (default_type == HIST_TYPE_BOOL && sig->type != HIST_TYPE_BOOL)
+    {
+        return HISTORIAN_CONFIG_ERR_INVALID;
+    }
+    return HISTORIAN_CONFIG_OK;
+}
+
+void historian_config_init_defaults(historian_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    memset(config, 0, sizeof(historian_config_t));
+    config->enabled           = true;
+    config->sample_every      = HISTORIAN_DEFAULT_SAMPLE_EVERY;
+    config->block_samples     = HISTORIAN_DEFAULT_BLOCK_SAMPLES;
+    config->flush_interval_ms = HISTORIAN_DEFAULT_FLUSH_INTERVAL_MS;
+    config->segment_max_mb    = HISTORIAN_DEFAULT_SEGMENT_MAX_MB;
+    config->max_segments      = HISTORIAN_DEFAULT_MAX_SEGMENTS;
+    config->ring_capacity     = HISTORIAN_DEFAULT_RING_CAPACITY;
+    strncpy(config->output_dir, HISTORIAN_DEFAULT_OUTPUT_DIR, HISTORIAN_MAX_PATH_LEN - 1);
+}
+
+static void read_int(const cJSON *root, const char *key, int *value)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, key);
+    if (cJSON_IsNumber(item))
+    {
+        *value = item->valueint;
+    }
+}
+
+int historian_config_parse(const char *config_path, historian_config_t *config)
+{
+    if (config_path == NULL || config == NULL)
+    {
+        return HISTORIAN_CONFIG_ERR_INVALID;
+    }
+
+    historian_config_init_defaults(config);
+
+    char *json_str = read_file(config_path);
+    if (json_str == NULL)
+    {
+        return HISTORIAN_CONFIG_ERR_FILE;
+    }
+
+    cJSON *root = cJSON_Parse(json_str);
+    free(json_str);
+    if (root == NULL)
+    {
+        return HISTORIAN_CONFIG_ERR_PARSE;
+    }
+
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, "enabled");
+    if (cJSON_IsBool(item))
+    {
+        config->enabled = cJSON_IsTrue(item);
+    }
+
+    item = cJSON_GetObjectItemCaseSensitive(root, "fsync");
+    if (cJSON_IsBool(item))
+    {
+        config->fsync = cJSON_IsTrue(item);
+    }
+
+    item = cJSON_GetObjectItemCaseSensitive(root, "output_dir");
+    if (cJSON_IsString(item) && item->valuestring != NULL)
+    {
+        strncpy(config->output_dir, item->valuestring, HISTORIAN_MAX_PATH_LEN - 1);
+        config->output_dir[HISTORIAN_MAX_PATH_LEN - 1] = '\0';
+    }
+
+    read_int(root, "sample_every_n_cycles", &config->sample_every);
+    read_int(root, "block_samples", &config->block_samples);
+    read_int(root, "flush_interval_ms", &config->flush_interval_ms);
+    read_int(root, "segment_max_mb", &config->segment_max_mb);
+    read_int(root, "max_segments", &config->max_segments);
+    read_int(root, "ring_capacity", &config->ring_capacity);
+
+    int result           = HISTORIAN_CONFIG_OK;
+    const cJSON *signals = cJSON_GetObjectItemCaseSensitive(root, "signals");
+    const cJSON *entry   = NULL;
+    cJSON_ArrayForEach(entry, signals)
+    {
+        if (config->num_signals >= HISTORIAN_MAX_SIGNALS)
+        {
+            break;
+        }
+
+        result = parse_signal(entry, &config->signals[config->num_signals]);
+        if (result != HISTORIAN_CONFIG_OK)
+        {
+            break;
+        }
+        config->num_signals++;
+    }
+
+    cJSON_Delete(root);
+
+    if (result == HISTORIAN_CONFIG_OK &&
+        (config->sample_every < 1 || config->block_samples < 2 || config->block_samples > 65536 ||
+         config->flush_interval_ms < 1 || config->segment_max_mb < 1 ||
+         config->max_segments < 0 || config->ring_capacity < 2 || config->output_dir[0] == '\0'))
+    {
+        result = HISTORIAN_CONFIG_ERR_INVALID;
+    }
+
+    return result;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file historian_config.h
+ * @brief Historian Plugin Configuration Structures and Parser
+ */
+
+#ifndef HISTORIAN_CONFIG_H
+#define HISTORIAN_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Configuration limits */
+#define HISTORIAN_MAX_SIGNALS     512
+#define HISTORIAN_MAX_NAME_LEN    48
+#define HISTORIAN_MAX_PATH_LEN    256
+
+/* Default values */
+#define HISTORIAN_DEFAULT_OUTPUT_DIR        "./historian"
+#define HISTORIAN_DEFAULT_SAMPLE_EVERY      1
+#define HISTORIAN_DEFAULT_BLOCK_SAMPLES     1000
+#define HISTORIAN_DEFAULT_FLUSH_INTERVAL_MS 1000
+#define HISTORIAN_DEFAULT_SEGMENT_MAX_MB    64
+#define HISTORIAN_DEFAULT_MAX_SEGMENTS      16
+#define HISTORIAN_DEFAULT_RING_CAPACITY     8192
+
+/**
+ * @brief Where a signal is sampled from
+ */
+typedef enum
+{
+    HIST_BUFFER_NONE = 0,
+    HIST_BUFFER_BOOL_INPUT,
+    HIST_BUFFER_BOOL_OUTPUT,
+    HIST_BUFFER_BOOL_MEMORY,
+    HIST_BUFFER_BYTE_INPUT,
+    HIST_BUFFER_BYTE_OUTPUT,
+    HIST_BUFFER_INT_INPUT,
+    HIST_BUFFER_INT_OUTPUT,
+    HIST_BUFFER_INT_MEMORY,
+    HIST_BUFFER_DINT_INPUT,
+    HIST_BUFFER_DINT_OUTPUT,
+    HIST_BUFFER_DINT_MEMORY,
+    HIST_BUFFER_LINT_INPUT,
+    HIST_BUFFER_LINT_OUTPUT,
+    HIST_BUFFER_LINT_MEMORY,
+    HIST_BUFFER_DEBUG_VARIABLE /* Any program variable, by debug index */
+} historian_buffer_t;
+
+/**
+ * @brief IEC value types a signal can be interpreted as
+ */
+typedef enum
+{
+    HIST_TYPE_NONE = 0,
+    HIST_TYPE_BOOL,
+    HIST_TYPE_SINT,
+    HIST_TYPE_USINT,
+    HIST_TYPE_INT,
+    HIST_TYPE_UINT,
+    HIST_TYPE_DINT,
+    HIST_TYPE_UDINT,
+    HIST_TYPE_LINT,
+    HIST_TYPE_ULINT,
+    HIST_TYPE_REAL,
+    HIST_TYPE_LREAL
+} historian_value_type_t;
+
+/**
+ * @brief One recorded signal
+ */
+typedef struct
+{
+    char name[HISTORIAN_MAX_NAME_LEN]; /* Signal name used by the query tool */
+    historian_buffer_t buffer;         /* Source buffer */
+    int index;                         /* Buffer index or debug variable index */
+    int bit;                           /* Bit for BOOL buffers (0-7) */
+    historian_value_type_t type;       /* Value interpretation */
+} historian_signal_config_t;
+
+/**
+ * @brief Complete historian configuration
+ */
+typedef struct
+{
+    bool enabled;                              /* Enable/disable recording */
+    char output_dir[HISTORIAN_MAX_PATH_LEN];   /* Directory for segment files */
+    int sample_every;                          /* Sample every N PLC cycles */
+    int block_samples;                         /* Samples per compressed block */
+    int flush_interval_ms;                     /* Max age of an unwritten partial block */
+    int segment_max_mb;                        /* Rotate segments above this size */
+    int max_segments;                          /* Oldest segments are deleted beyond this */
+    int ring_capacity;                         /* Samples buffered between scan and writer */
+    bool fsync;                                /* fdatasync() after every block */
+    int num_signals;
+    historian_signal_config_t signals[HISTORIAN_MAX_SIGNALS];
+} historian_config_t;
+
+/**
+ * @brief Parse configuration from JSON file
+ *
+ * @param config_path Path to the JSON configuration file
+ * @param config Pointer to configuration structure to populate
+ * @return 0 on success, negative error code on failure
+ */
+int historian_config_parse(const char *config_path, historian_config_t *config);
+
+/**
+ * @brief Initialize configuration with default values
+ *
+ * @param config Pointer to configuration structure to initialize
+ */
+void historian_config_init_defaults(historian_config_t *config);
+
+/**
+ * @brief Get the configuration name of a value type
+ *
+ * @param type Value type enumeration value
+ * @return Name as used in the configuration file, e.g. "REAL"
+ */
+const char *historian_type_name(historian_value_type_t type);
+
+/**
+ * @brief Look up a value type by its configuration name
+ *
+ * @return Value type, or HIST_TYPE_NONE if unknown
+ */
+historian_value_type_t historian_type_from_name(const char *name);
+
+/**
+ * @brief Size in bytes of a value type
+ */
+int historian_type_size(historian_value_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORIAN_CONFIG_H */
@@ -0,0 +1,779 @@
+/**
+ * @file historian_plugin.c
+ * @brief High-Rate Historian Plugin Implementation
+ *
+ * Data path:
+ *
+ *     scan thread (cycle_end)          writer thread
+ *     -----------------------          -------------
+ *     read signal values      --->     SPSC ring      --->  block builder
+ *     (raw 64-bit words)               (fixed slots)        (per-column codecs)
+ *                                                                 |
+ *                                                                 v
+ *                                                        append to segment file
+ *
+ * The scan thread never allocates, blocks or touches the file system. If the
+ * writer falls behind and the ring fills up, samples are dropped and counted
+ * instead of delaying the scan.
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "historian_codec.h"
+#include "historian_config.h"
+#include "historian_plugin.h"
+#include "historian_segment.h"
+#include "plugin_logger.h"
+#include "plugin_types.h"
+
+#define WRITER_POLL_NS (10 * 1000 * 1000)
+
+/**
+ * @brief Runtime state of one recorded signal
+ */
+typedef struct
+{
+    historian_value_type_t type;
+    const void *ptr; /* Resolved value address (NULL reads as 0) */
+} historian_signal_runtime_t;
+
+/* Plugin state */
+static plugin_logger_t g_logger;
+static plugin_runtime_args_t g_runtime_args;
+static historian_config_t g_config;
+static bool g_initialized = false;
+static bool g_running     = false;
+
+static historian_signal_runtime_t g_signals[HISTORIAN_MAX_SIGNALS];
+static int g_num_signals         = 0;
+static int g_cycles_since_sample = 0;
+
+/* Sample ring: slot = timestamp followed by one raw value per signal */
+static uint64_t *g_ring     = NULL;
+static uint64_t g_ring_mask = 0;
+static size_t g_ring_stride = 0;
+static uint64_t g_ring_head = 0; /* Written by the scan thread */
+static uint64_t g_ring_tail = 0; /* Written by the writer thread */
+static uint64_t g_dropped   = 0;
+
+/* Writer thread state */
+static pthread_t g_writer;
+static bool g_writer_running = false;
+static hist_block_builder_t g_builder;
+static int64_t g_block_opened_ms   = 0;
+static int g_segment_fd            = -1;
+static size_t g_segment_size       = 0;
+static uint64_t g_samples_written  = 0;
+static uint64_t g_blocks_written   = 0;
+static uint64_t g_bytes_written    = 0;
+static uint64_t g_dropped_reported = 0;
+static bool g_write_error_logged   = false;
+
+/*
+ * =============================================================================
+ * Helpers
+ * =============================================================================
+ */
+
+static int64_t realtime_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static hist_column_type_t column_type(historian_value_type_t type)
+{
+    switch (type)
+    {
+    case HIST_TYPE_BOOL:
+        return HIST_COL_BOOL;
+    case HIST_TYPE_REAL:
+    case HIST_TYPE_LREAL:
+        return HIST_COL_FLOAT;
+    default:
+        return HIST_COL_INT;
+    }
+}
+
+/**
+ * @brief Read a signal as a raw column value
+ */
+static inline uint64_t read_signal(const historian_signal_runtime_t *sig)
+{
+    const void *p = sig->ptr;
+    if (p == NULL)
+    {
+        return 0;
+    }
+
+    switch (sig->type)
+    {
+    case HIST_TYPE_BOOL:
+        return *(const IEC_BOOL *)p ? 1 : 0;
+    case HIST_TYPE_SINT:
+        return (uint64_t)(int64_t)(*(const int8_t *)p);
+    case HIST_TYPE_USINT:
+        return *(const uint8_t *)p;
+    case HIST_TYPE_INT:
+        return (uint64_t)(int64_t)(*(const int16_t *)p);
+    case HIST_TYPE_UINT:
+        return *(const uint16_t *)p;
+    case HIST_TYPE_DINT:
+        return (uint64_t)(int64_t)(*(const int32_t *)p);
+    case HIST_TYPE_UDINT:
+        return *(const uint32_t *)p;
+    case HIST_TYPE_LINT:
+    case HIST_TYPE_ULINT:
+        return *(const uint64_t *)p;
+    case HIST_TYPE_REAL:
+        return hist_double_to_raw((double)*(const float *)p);
+    case HIST_TYPE_LREAL:
+        return hist_double_to_raw(*(const double *)p);
+    default:
+        return 0;
+    }
+}
+
+static IEC_BOOL *(*bool_table(historian_buffer_t buffer))[8]
+{
+    switch (buffer)
+    {
+    case HIST_BUFFER_BOOL_INPUT:
+        return g_runtime_args.bool_input;
+    case HIST_BUFFER_BOOL_OUTPUT:
+        return g_runtime_args.bool_output;
+    case HIST_BUFFER_BOOL_MEMORY:
+        return g_runtime_args.bool_memory;
+    default:
+        return NULL;
+    }
+}
+
+static void *word_table(historian_buffer_t buffer)
+{
+    switch (buffer)
+    {
+    case HIST_BUFFER_BYTE_INPUT:
+        return g_runtime_args.byte_input;
+    case HIST_BUFFER_BYTE_OUTPUT:
+        return g_runtime_args.byte_output;
+    case HIST_BUFFER_INT_INPUT:
+        return g_runtime_args.int_input;
+    case HIST_BUFFER_INT_OUTPUT:
+        return g_runtime_args.int_output;
+    case HIST_BUFFER_INT_MEMORY:
+        return g_runtime_args.int_memory;
+    case HIST_BUFFER_DINT_INPUT:
+        return g_runtime_args.dint_input;
+    case HIST_BUFFER_DINT_OUTPUT:
+        return g_runtime_args.dint_output;
+    case HIST_BUFFER_DINT_MEMORY:
+        return g_runtime_args.dint_memory;
+    case HIST_BUFFER_LINT_INPUT:
+        return g_runtime_args.lint_input;
+    case HIST_BUFFER_LINT_OUTPUT:
+        return g_runtime_args.lint_output;
+    case HIST_BUFFER_LINT_MEMORY:
+        return g_runtime_args.lint_memory;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * @brief Resolve the value address of every configured signal
+ *
+ * Debug variable addresses are only valid once the program has been glued,
+ * which is guaranteed by the time start_loop() runs.
+ */
+static int resolve_signals(void)
+{
+    int buffer_size = g_runtime_args.buffer_size;
+    int count       = 0;
+
+    for (int i = 0; i < g_config.num_signals; i++)
+    {
+        const historian_signal_config_t *cfg = &g_config.signals[i];
+        historian_signal_runtime_t *sig      = &g_signals[count];
+        sig->type                            = cfg->type;
+        sig->ptr                             = NULL;
+
+        if (cfg->buffer == HIST_BUFFER_DEBUG_VARIABLE)
+        {
+            if (g_runtime_args.get_var_count == NULL ||
+                cfg->index >= (int)g_runtime_args.get_var_count())
+            {
+                plugin_logger_error(&g_logger, "Signal '%s': debug index %d out of range",
+                                    cfg->name, cfg->index);
+                return -1;
+            }
+
+            size_t idx = (size_t)cfg->index;
+            if (g_runtime_args.get_var_size(idx) != (size_t)historian_type_size(cfg->type))
+            {
+                plugin_logger_error(&g_logger, "Signal '%s': variable size %zu does not match %s",
+                                    cfg->name, g_runtime_args.get_var_size(idx),
+                                    historian_type_name(cfg->type));
+                return -1;
+            }
+
+            void *addr = NULL;
+            g_runtime_args.get_var_list(1, &idx, &addr);
+            sig->ptr = addr;
+        }
+        else
+        {
+            if (cfg->index >= buffer_size)
+            {
+                plugin_logger_error(&g_logger, "Signal '%s': index %d exceeds buffer size %d",
+                                    cfg->name, cfg->index, buffer_size);
+                return -1;
+            }
+
+            IEC_BOOL *(*bools)[8] = bool_table(cfg->buffer);
+            if (bools != NULL)
+            {
+                sig->ptr = bools[cfg->index][cfg->bit];
+            }
+            else
+            {
+                void **table = (void **)word_table(cfg->buffer);
+                sig->ptr     = table[cfg->index];
+            }
+        }
+
+        if (sig->ptr == NULL)
+        {
+            plugin_logger_warn(&g_logger, "Signal '%s' is not bound to a variable, recording 0",
+                               cfg->name);
+        }
+        count++;
+    }
+    g_num_signals = count;
+    return 0;
+}
+
+/*
+ * =============================================================================
+ * Segment Files
+ * =============================================================================
+ */
+
+static int mkdir_p(const char *path)
+{
+    char tmp[HISTORIAN_MAX_PATH_LEN];
+    snprintf(tmp, sizeof(tmp), "%s", path);
+
+    for (char *p = tmp + 1; *p != '\0'; p++)
+    {
+        if (*p == '/')
+        {
+            *p = '\0';
+            if (mkdir(tmp, 0755) != 0 && errno != EEXIST)
+            {
+                return -1;
+            }
+            *p = '/';
+        }
+    }
+    if (mkdir(tmp, 0755) != 0 && errno != EEXIST)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/**
+ * @brief Delete the oldest segments beyond max_segments
+ *
+ * Segment names embed the creation time with a fixed width, so sorting by
+ * name sorts by age.
+ */
+static void enforce_retention(void)
+{
+    if (g_config.max_segments <= 0)
+    {
+        return;
+    }
+
+    DIR *dir = opendir(g_config.output_dir);
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    char **names   = NULL;
+    size_t count   = 0;
+    size_t cap     = 0;
+    size_t pre_len = strlen(HIST_SEGMENT_PREFIX);
+    size_t suf_len = strlen(HIST_SEGMENT_SUFFIX);
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        size_t len = strlen(entry->d_name);
+        if (len <= pre_len + suf_len ||
+            strncmp(entry->d_name, HIST_SEGMENT_PREFIX, pre_len) != 0 ||
+            strcmp(entry->d_name + len - suf_len, HIST_SEGMENT_SUFFIX) != 0)
+        {
+            continue;
+        }
+        if (count == cap)
+        {
+            cap          = cap ? cap * 2 : 32;
+            char **grown = realloc(names, cap * sizeof(char *));
+            if (grown == NULL)
+            {
+                break;
+            }
+            names = grown;
+        }
+        names[count] = strdup(entry->d_name);
+        if (names[count] != NULL)
+        {
+            count++;
+        }
+    }
+    closedir(dir);
+
+    qsort(names, count, sizeof(char *), compare_names);
+    for (size_t i = 0; i + (size_t)g_config.max_segments < count; i++)
+    {
+        char path[HISTORIAN_MAX_PATH_LEN + 64];
+        snprintf(path, sizeof(path), "%s/%s", g_config.output_dir, names[i]);
+        if (unlink(path) == 0)
+        {
+            plugin_logger_debug(&g_logger, "Removed old segment %s", path);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        free(names[i]);
+    }
+    free(names);
+}
+
+static void close_segment(void)
+{
+    if (g_segment_fd >= 0)
+    {
+        close(g_segment_fd);
+        g_segment_fd = -1;
+    }
+    g_segment_size = 0;
+}
+
+static int open_segment(void)
+{
+    hist_signal_desc_t descs[HISTORIAN_MAX_SIGNALS];
+    memset(descs, 0, sizeof(hist_signal_desc_t) * (size_t)g_num_signals);
+    for (int i = 0; i < g_num_signals; i++)
+    {
+        strncpy(descs[i].name, g_config.signals[i].name, HIST_SIGNAL_NAME_LEN - 1);
+        descs[i].value_type  = (uint32_t)g_signals[i].type;
+        descs[i].column_type = (uint32_t)column_type(g_signals[i].type);
+    }
+
+    int64_t created_us = realtime_us();
+    char path[HISTORIAN_MAX_PATH_LEN + 64];
+    snprintf(path, sizeof(path), "%s/" HIST_SEGMENT_PREFIX "%016" PRId64 HIST_SEGMENT_SUFFIX,
+             g_config.output_dir, created_us);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        plugin_logger_error(&g_logger, "Cannot create segment %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    long header_size = hist_segment_write_header(fd, descs, (uint32_t)g_num_signals, created_us);
+    if (header_size < 0)
+    {
+        plugin_logger_error(&g_logger, "Cannot write segment header to %s: %s", path,
+                            strerror(errno));
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+
+    g_segment_fd   = fd;
+    g_segment_size = (size_t)header_size;
+    plugin_logger_info(&g_logger, "Opened segment %s", path);
+
+    enforce_retention();
+    return 0;
+}
+
+static int write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/*
+ * =============================================================================
+ * Writer Thread
+ * =============================================================================
+ */
+
+static void flush_block(void)
+{
+    uint32_t samples = g_builder.samples;
+    const uint8_t *block;
+    size_t size = hist_block_builder_finish(&g_builder, &block);
+    if (size == 0)
+    {
+        return;
+    }
+
+    size_t max_size = (size_t)g_config.segment_max_mb * 1024 * 1024;
+    if (g_segment_fd >= 0 && g_segment_size + size > max_size)
+    {
+        close_segment();
+    }
+    if (g_segment_fd < 0 && open_segment() != 0)
+    {
+        return;
+    }
+
+    if (write_all(g_segment_fd, block, size) != 0)
+    {
+        if (!g_write_error_logged)
+        {
+            plugin_logger_error(&g_logger, "Segment write failed: %s", strerror(errno));
+            g_write_error_logged = true;
+        }
+        /* Start a fresh segment next time; the torn tail is ignored by readers */
+        close_segment();
+        return;
+    }
+    if (g_config.fsync)
+    {
+        fdatasync(g_segment_fd);
+    }
+
+    g_write_error_logged = false;
+    g_segment_size += size;
+    g_samples_written += samples;
+    g_blocks_written++;
+    g_bytes_written += size;
+
+    uint64_t dropped = __atomic_load_n(&g_dropped, __ATOMIC_RELAXED);
+    if (dropped != g_dropped_reported)
+    {
+        plugin_logger_warn(&g_logger, "%" PRIu64 " samples dropped (ring full)",
+                           dropped - g_dropped_reported);
+        g_dropped_reported = dropped;
+    }
+}
+
+static void drain_ring(void)
+{
+    uint64_t tail = g_ring_tail;
+    uint64_t head = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE);
+
+    while (tail != head)
+    {
+        const uint64_t *slot = g_ring + (tail & g_ring_mask) * g_ring_stride;
+
+        if (g_builder.samples == 0)
+        {
+            g_block_opened_ms = monotonic_ms();
+        }
+        hist_block_builder_append(&g_builder, (int64_t)slot[0], slot + 1);
+        tail++;
+        __atomic_store_n(&g_ring_tail, tail, __ATOMIC_RELEASE);
+
+        if (g_builder.samples >= g_builder.capacity)
+        {
+            flush_block();
+        }
+    }
+}
+
+static void *writer_thread(void *arg)
+{
+    (void)arg;
+    const struct timespec poll = {.tv_sec = 0, .tv_nsec = WRITER_POLL_NS};
+
+    while (__atomic_load_n(&g_writer_running, __ATOMIC_ACQUIRE))
+    {
+        drain_ring();
+        if (g_builder.samples > 0 &&
+            monotonic_ms() - g_block_opened_ms >= g_config.flush_interval_ms)
+        {
+            flush_block();
+        }
+        nanosleep(&poll, NULL);
+    }
+
+    /* Scan thread has stopped sampling; persist everything still buffered */
+    drain_ring();
+    flush_block();
+    return NULL;
+}
+
+static void release_buffers(void)
+{
+    free(g_ring);
+    g_ring = NULL;
+    hist_block_builder_free(&g_builder);
+}
+
+/*
+ * =============================================================================
+ * Plugin Lifecycle Functions
+ * =============================================================================
+ */
+
+int init(void *args)
+{
+    if (!args)
+    {
+        plugin_logger_init(&g_logger, "HISTORIAN", NULL);
+        plugin_logger_error(&g_logger, "init args is NULL");
+        return -1;
+    }
+
+    /* Copy runtime args (pointer is freed after init returns) */
+    memcpy(&g_runtime_args, args, sizeof(plugin_runtime_args_t));
+
+    plugin_logger_init(&g_logger, "HISTORIAN", args);
+    plugin_logger_info(&g_logger, "Initializing historian plugin...");
+
+    g_initialized = true;
+    return 0;
+}
+
+int start_loop(void)
+{
+    if (!g_initialized)
+    {
+        plugin_logger_error(&g_logger, "Cannot start - plugin not initialized");
+        return -1;
+    }
+
+    if (g_running)
+    {
+        plugin_logger_warn(&g_logger, "Historian already running");
+        return 0;
+    }
+
+    const char *config_path = g_runtime_args.plugin_specific_config_file_path;
+    if (config_path == NULL || config_path[0] == '\0')
+    {
+        plugin_logger_warn(&g_logger, "No config file specified, nothing to record");
+        return 0;
+    }
+
+    int result = historian_config_parse(config_path, &g_config);
+    if (result != 0)
+    {
+        plugin_logger_error(&g_logger, "Failed to parse config file %s (error %d)", config_path,
+                            result);
+        return -1;
+    }
+
+    if (!g_config.enabled || g_config.num_signals == 0)
+    {
+        plugin_logger_info(&g_logger, "Historian is disabled or has no signals configured");
+        return 0;
+    }
+
+    if (resolve_signals() != 0)
+    {
+        return -1;
+    }
+
+    if (mkdir_p(g_config.output_dir) != 0)
+    {
+        plugin_logger_error(&g_logger, "Cannot create output directory %s: %s",
+                            g_config.output_dir, strerror(errno));
+        return -1;
+    }
+
+    /* Ring capacity is rounded up to a power of two for cheap index masking */
+    uint64_t capacity = 1;
+    while (capacity < (uint64_t)g_config.ring_capacity)
+    {
+        capacity <<= 1;
+    }
+    g_ring_stride = 1 + (size_t)g_num_signals;
+    g_ring_mask   = capacity - 1;
+    g_ring        = malloc(capacity * g_ring_stride * sizeof(uint64_t));
+
+    hist_column_type_t types[HISTORIAN_MAX_SIGNALS];
+    for (int i = 0; i < g_num_signals; i++)
+    {
+        types[i] = column_type(g_signals[i].type);
+    }
+
+    if (g_ring == NULL || hist_block_builder_init(&g_builder, types, (uint32_t)g_num_signals,
+                                                  (uint32_t)g_config.block_samples) != 0)
+    {
+        plugin_logger_error(&g_logger, "Failed to allocate sample buffers");
+        release_buffers();
+        return -1;
+    }
+
+    /* Touch every ring page now so sampling never page-faults in the scan cycle */
+    memset(g_ring, 0, capacity * g_ring_stride * sizeof(uint64_t));
+
+    g_ring_head           = 0;
+    g_ring_tail           = 0;
+    g_dropped             = 0;
+    g_dropped_reported    = 0;
+    g_samples_written     = 0;
+    g_blocks_written      = 0;
+    g_bytes_written       = 0;
+    g_cycles_since_sample = 0;
+    g_write_error_logged  = false;
+
+    /*
+     * start_loop() runs on the real-time scan thread; without an explicit
+     * policy the writer would inherit SCHED_FIFO and compete with the scan.
+     */
+    pthread_attr_t attr;
+    struct sched_param param = {.sched_priority = 0};
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    g_writer_running  = true;
+    int create_result = pthread_create(&g_writer, &attr, writer_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (create_result != 0)
+    {
+        plugin_logger_error(&g_logger, "Failed to create writer thread");
+        g_writer_running = false;
+        release_buffers();
+        return -1;
+    }
+
+    __atomic_store_n(&g_running, true, __ATOMIC_RELEASE);
+    plugin_logger_info(&g_logger, "Recording %d signals every %d cycle(s) to %s", g_num_signals,
+                       g_config.sample_every, g_config.output_dir);
+    return 0;
+}
+
+void stop_loop(void)
+{
+    if (!g_running)
+    {
+        return;
+    }
+
+    __atomic_store_n(&g_running, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_writer_running, false, __ATOMIC_RELEASE);
+    pthread_join(g_writer, NULL);
+
+    close_segment();
+    release_buffers();
+
+    plugin_logger_info(&g_logger,
+                       "Historian stopped: %" PRIu64 " samples in %" PRIu64 " blocks (%" PRIu64
+                       " bytes), %" PRIu64 " dropped",
+                       g_samples_written, g_blocks_written, g_bytes_written, g_dropped);
+}
+
+void cleanup(void)
+{
+    stop_loop();
+    g_initialized = false;
+    plugin_logger_info(&g_logger, "Historian cleanup complete");
+}
+
+void cycle_start(void)
+{
+    /* Samples are taken at cycle end */
+}
+
+void cycle_end(void)
+{
+    if (!__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    if (++g_cycles_since_sample < g_config.sample_every)
+    {
+        return;
+    }
+    g_cycles_since_sample = 0;
+
+    uint64_t head = g_ring_head;
+    if (head - __atomic_load_n(&g_ring_tail, __ATOMIC_ACQUIRE) > g_ring_mask)
+    {
+        __atomic_store_n(&g_dropped, g_dropped + 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    uint64_t *slot = g_ring + (head & g_ring_mask) * g_ring_stride;
+    slot[0]        = (uint64_t)realtime_us();
+    for (int i = 0; i < g_num_signals; i++)
+    {
+        slot[i + 1] = read_signal(&g_signals[i]);
+    }
+
+    __atomic_store_n(&g_ring_head, head + 1, __ATOMIC_RELEASE);
+}
+
+void program_changed(void)
+{
+    if (!__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    /* Only the addresses change; the sample layout of the open segment stays */
+    if (resolve_signals() != 0)
+    {
+        plugin_logger_error(&g_logger, "Signals do not match the new program, recording 0");
+        for (int i = 0; i < g_num_signals; i++)
+        {
+            g_signals[i].ptr = NULL;
+        }
+        return;
+    }
+    plugin_logger_info(&g_logger, "Signals re-resolved after program change");
+}
@@ -0,0 +1,77 @@
+/**
+ * @file historian_plugin.h
+ * @brief High-Rate Historian Plugin for OpenPLC Runtime v4
+ *
+ * This plugin records configured variables every N scan cycles into
+ * compressed, append-only segment files on local storage. Sampling happens in
+ * the scan cycle and only copies raw values into a lock-free ring; encoding
+ * and file I/O run on a background writer thread.
+ *
+ * Recorded data is read back with the historian_query tool or any program
+ * using historian_segment.h.
+ */
+
+#ifndef HISTORIAN_PLUGIN_H
+#define HISTORIAN_PLUGIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the historian plugin
+ *
+ * @param args Pointer to plugin_runtime_args_t containing runtime buffers,
+ *             mutex functions, and logging function pointers
+ * @return 0 on success, -1 on failure
+ */
+int init(void *args);
+
+/**
+ * @brief Start recording
+ *
+ * Parses the configuration, resolves signal addresses, allocates the sample
+ * ring and starts the writer thread.
+ */
+int start_loop(void);
+
+/**
+ * @brief Stop recording
+ *
+ * Stops the writer thread after it has flushed every buffered sample.
+ */
+void stop_loop(void);
+
+/**
+ * @brief Cleanup plugin resources
+ */
+void cleanup(void);
+
+/**
+ * @brief Called at the start of each PLC scan cycle
+ *
+ * Nothing to do; samples are taken at cycle end.
+ */
+void cycle_start(void);
+
+/**
+ * @brief Called at the end of each PLC scan cycle
+ *
+ * Copies the configured signals into the sample ring every N cycles.
+ * Called with buffer mutex already held.
+ */
+void cycle_end(void);
+
+/**
+ * @brief Called after an online change replaced the PLC program
+ *
+ * Re-resolves the signal addresses against the new program. Called by the
+ * scan thread with buffer mutex already held.
+ */
+void program_changed(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORIAN_PLUGIN_H */
@@ -0,0 +1,496 @@
+/**
+ * @file historian_query.c
+ * @brief Query and export tool for historian segment files
+ *
+ * Usage:
+ *     historian_query [options] <segment file or directory>...
+ *
+ * Without --list, samples are written as CSV with one column per signal.
+ * Segments are mapped read-only, so the tool can run while the plugin is
+ * still appending to the newest segment.
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "historian_codec.h"
+#include "historian_config.h"
+#include "historian_segment.h"
+
+#define MAX_COLUMNS HISTORIAN_MAX_SIGNALS
+
+typedef struct
+{
+    char **items;
+    size_t count;
+    size_t cap;
+} string_list_t;
+
+static void list_add(string_list_t *list, const char *value)
+{
+    if (list->count == list->cap)
+    {
+        list->cap   = list->cap ? list->cap * 2 : 16;
+        list->items = realloc(list->items, list->cap * sizeof(char *));
+        if (list->items == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    list->items[list->count++] = strdup(value);
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/**
+ * @brief Expand a path into segment files (directories are scanned)
+ */
+static void collect_segments(const char *path, string_list_t *out)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+    {
+        fprintf(stderr, "Cannot access %s\n", path);
+        return;
+    }
+    if (!S_ISDIR(st.st_mode))
+    {
+        list_add(out, path);
+        return;
+    }
+
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+    {
+        fprintf(stderr, "Cannot open directory %s\n", path);
+        return;
+    }
+
+    string_list_t names = {0};
+    size_t pre_len      = strlen(HIST_SEGMENT_PREFIX);
+    size_t suf_len      = strlen(HIST_SEGMENT_SUFFIX);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        size_t len = strlen(entry->d_name);
+        if (len > pre_len + suf_len && strncmp(entry->d_name, HIST_SEGMENT_PREFIX, pre_len) == 0 &&
+            strcmp(entry->d_name + len - suf_len, HIST_SEGMENT_SUFFIX) == 0)
+        {
+            list_add(&names, entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    qsort(names.items, names.count, sizeof(char *), compare_names);
+    for (size_t i = 0; i < names.count; i++)
+    {
+        char full[4096];
+        snprintf(full, sizeof(full), "%s/%s", path, names.items[i]);
+        list_add(out, full);
+        free(names.items[i]);
+    }
+    free(names.items);
+}
+
+static void format_time(int64_t ts_us, bool raw, char *buf, size_t len)
+{
+    if (raw)
+    {
+        snprintf(buf, len, "%" PRId64, ts_us);
+        return;
+    }
+
+    time_t secs  = (time_t)(ts_us / 1000000);
+    int64_t frac = ts_us % 1000000;
+    if (frac < 0)
+    {
+        secs -= 1;
+        frac += 1000000;
+    }
+
+    struct tm tm;
+    gmtime_r(&secs, &tm);
+    size_t n = strftime(buf, len, "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(buf + n, len - n, ".%06" PRId64 "Z", frac);
+}
+
+static void print_value(FILE *out, uint32_t value_type, uint64_t raw)
+{
+    switch ((historian_value_type_t)value_type)
+    {
+    case HIST_TYPE_BOOL:
+        fputc(raw ? '1' : '0', out);
+        break;
+    case HIST_TYPE_SINT:
+    case HIST_TYPE_INT:
+    case HIST_TYPE_DINT:
+    case HIST_TYPE_LINT:
+        fprintf(out, "%" PRId64, (int64_t)raw);
+        break;
+    case HIST_TYPE_REAL:
+        fprintf(out, "%.9g", hist_raw_to_double(raw));
+        break;
+    case HIST_TYPE_LREAL:
+        fprintf(out, "%.17g", hist_raw_to_double(raw));
+        break;
+    default:
+        fprintf(out, "%" PRIu64, raw);
+        break;
+    }
+}
+
+/**
+ * @brief Print segment, signal and block summaries
+ */
+static int list_segment(const char *path, bool verbose)
+{
+    hist_segment_t seg;
+    if (hist_segment_open(path, &seg) != 0)
+    {
+        fprintf(stderr, "%s: not a historian segment\n", path);
+        return -1;
+    }
+
+    size_t raw_sample_size = sizeof(int64_t);
+    for (uint32_t i = 0; i < seg.header->signal_count; i++)
+    {
+        int size = historian_type_size((historian_value_type_t)seg.signals[i].value_type);
+        raw_sample_size += size > 0 ? (size_t)size : 8;
+    }
+
+    uint64_t samples = 0, blocks = 0;
+    int64_t first = 0, last = 0;
+    size_t offset = 0;
+    hist_block_view_t block;
+    while (hist_segment_next_block(&seg, &offset, &block))
+    {
+        if (blocks == 0)
+        {
+            first = block.header->first_ts_us;
+        }
+        last = block.header->last_ts_us;
+        samples += block.header->sample_count;
+        blocks++;
+    }
+
+    char from[64], to[64];
+    format_time(first, false, from, sizeof(from));
+    format_time(last, false, to, sizeof(to));
+    double raw_bytes = (double)samples * (double)raw_sample_size;
+    printf("%s\n", path);
+    printf("  signals: %u  blocks: %" PRIu64 "  samples: %" PRIu64 "\n",
+           seg.header->signal_count, blocks, samples);
+    if (blocks > 0)
+    {
+        printf("  range:   %s .. %s\n", from, to);
+    }
+    printf("  size:    %zu bytes (compression %.1f:1 against raw samples)\n",
+           offset ? offset : seg.size, offset ? raw_bytes / (double)offset : 0.0);
+    if (offset != 0 && offset < seg.size)
+    {
+        printf("  warning: %zu trailing bytes are not a valid block\n", seg.size - offset);
+    }
+
+    if (verbose)
+    {
+        for (uint32_t i = 0; i < seg.header->signal_count; i++)
+        {
+            printf("  [%u] %-*s %s\n", i, HIST_SIGNAL_NAME_LEN, seg.signals[i].name,
+                   historian_type_name((historian_value_type_t)seg.signals[i].value_type));
+        }
+    }
+
+    hist_segment_close(&seg);
+    return 0;
+}
+
+typedef struct
+{
+    char **names; /* Exported signal names, in column order */
+    size_t count;
+    int64_t from_us;
+    int64_t to_us;
+    bool raw_time;
+    FILE *out;
+} export_options_t;
+
+/**
+ * @brief Write the samples of one segment that fall into the time range
+ */
+static int export_segment(const char *path, const export_options_t *opts)
+{
+    hist_segment_t seg;
+    if (hist_segment_open(path, &seg) != 0)
+    {
+        fprintf(stderr, "%s: not a historian segment\n", path);
+        return -1;
+    }
+
+    /* Map exported columns onto this segment's signal table (-1 = not recorded) */
+    int map[MAX_COLUMNS];
+    for (size_t c = 0; c < opts->count; c++)
+    {
+        map[c] = -1;
+        for (uint32_t i = 0; i < seg.header->signal_count; i++)
+        {
+            if (strncmp(opts->names[c], seg.signals[i].name, HIST_SIGNAL_NAME_LEN) == 0)
+            {
+                map[c] = (int)i;
+                break;
+            }
+        }
+    }
+
+    uint64_t *timestamps = NULL;
+    uint64_t *values     = NULL;
+    size_t capacity      = 0;
+    size_t offset        = 0;
+    int result           = 0;
+    hist_block_view_t block;
+
+    while (hist_segment_next_block(&seg, &offset, &block))
+    {
+        uint32_t n = block.header->sample_count;
+        if (block.header->last_ts_us < opts->from_us || block.header->first_ts_us > opts->to_us)
+        {
+            continue;
+        }
+
+        if (n > capacity)
+        {
+            capacity   = n;
+            timestamps = realloc(timestamps, capacity * sizeof(uint64_t));
+            values     = realloc(values, capacity * opts->count * sizeof(uint64_t));
+            if (timestamps == NULL || values == NULL)
+            {
+                perror("realloc");
+                exit(1);
+            }
+        }
+
+        if (hist_block_decode_column(&seg, &block, 0, timestamps) != 0)
+        {
+            fprintf(stderr, "%s: corrupt block, skipping\n", path);
+            result = -1;
+            continue;
+        }
+        for (size_t c = 0; c < opts->count; c++)
+        {
+            if (map[c] >= 0 &&
+                hist_block_decode_column(&seg, &block, (uint32_t)map[c] + 1, values + c * n) != 0)
+            {
+                fprintf(stderr, "%s: corrupt column %s, skipping\n", path, opts->names[c]);
+                map[c] = -1;
+                result = -1;
+            }
+        }
+
+        for (uint32_t s = 0; s < n; s++)
+        {
+            int64_t ts = (int64_t)timestamps[s];
+            if (ts < opts->from_us || ts > opts->to_us)
+            {
+                continue;
+            }
+
+            char time_buf[64];
+            format_time(ts, opts->raw_time, time_buf, sizeof(time_buf));
+            fputs(time_buf, opts->out);
+            for (size_t c = 0; c < opts->count; c++)
+            {
+                fputc(',', opts->out);
+                if (map[c] >= 0)
+                {
+                    print_value(opts->out, seg.signals[map[c]].value_type, values[c * n + s]);
+                }
+            }
+            fputc('\n', opts->out);
+        }
+    }
+
+    free(timestamps);
+    free(values);
+    hist_segment_close(&seg);
+    return result;
+}
+
+static int64_t parse_time(const char *text)
+{
+    char *end;
+    double seconds = strtod(text, &end);
+    if (end == text || *end != '\0')
+    {
+        fprintf(stderr, "Invalid time '%s' (expected seconds since the epoch)\n", text);
+        exit(2);
+    }
+    return (int64_t)llround(seconds * 1e6);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <segment file or directory>...\n"
+            "\n"
+            "Options:\n"
+            "  -l, --list             List segments instead of exporting samples\n"
+            "  -v, --verbose          With --list, also list the signals of each segment\n"
+            "  -s, --signals a,b,...  Export only these signals (default: all)\n"
+            "  -f, --from SECONDS     Export samples at or after this Unix time\n"
+            "  -t, --to SECONDS       Export samples at or before this Unix time\n"
+            "  -r, --raw-time         Print timestamps as microseconds since the epoch\n"
+            "  -o, --output FILE      Write CSV to FILE instead of stdout\n"
+            "  -h, --help             Show this help\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        {"list", no_argument, NULL, 'l'},        {"verbose", no_argument, NULL, 'v'},
+        {"signals", required_argument, NULL, 's'}, {"from", required_argument, NULL, 'f'},
+        {"to", required_argument, NULL, 't'},    {"raw-time", no_argument, NULL, 'r'},
+        {"output", required_argument, NULL, 'o'}, {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+
+    bool list               = false;
+    bool verbose            = false;
+    const char *signals_arg = NULL;
+    const char *output_path = NULL;
+    export_options_t opts   = {.from_us = INT64_MIN, .to_us = INT64_MAX, .out = stdout};
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "lvs:f:t:ro:h", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'l':
+            list = true;
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        case 's':
+            signals_arg = optarg;
+            break;
+        case 'f':
+            opts.from_us = parse_time(optarg);
+            break;
+        case 't':
+            opts.to_us = parse_time(optarg);
+            break;
+        case 'r':
+            opts.raw_time = true;
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    string_list_t segments = {0};
+    for (int i = optind; i < argc; i++)
+    {
+        collect_segments(argv[i], &segments);
+    }
+    if (segments.count == 0)
+    {
+        fprintf(stderr, "No segment files found\n");
+        return 1;
+    }
+
+    int result = 0;
+    if (list)
+    {
+        for (size_t i = 0; i < segments.count; i++)
+        {
+            result |= list_segment(segments.items[i], verbose) != 0;
+        }
+        return result;
+    }
+
+    /* Column set: requested signals, or every signal of the first readable segment */
+    string_list_t columns = {0};
+    if (signals_arg != NULL)
+    {
+        char *copy = strdup(signals_arg);
+        for (char *tok = strtok(copy, ","); tok != NULL; tok = strtok(NULL, ","))
+        {
+            list_add(&columns, tok);
+        }
+        free(copy);
+    }
+    else
+    {
+        for (size_t i = 0; i < segments.count && columns.count == 0; i++)
+        {
+            hist_segment_t seg;
+            if (hist_segment_open(segments.items[i], &seg) == 0)
+            {
+                for (uint32_t s = 0; s < seg.header->signal_count; s++)
+                {
+                    list_add(&columns, seg.signals[s].name);
+                }
+                hist_segment_close(&seg);
+            }
+        }
+    }
+    if (columns.count == 0 || columns.count > MAX_COLUMNS)
+    {
+        fprintf(stderr, "No signals to export\n");
+        return 1;
+    }
+    opts.names = columns.items;
+    opts.count = columns.count;
+
+    if (output_path != NULL)
+    {
+        opts.out = fopen(output_path, "w");
+        if (opts.out == NULL)
+        {
+            perror(output_path);
+            return 1;
+        }
+    }
+
+    fputs("timestamp", opts.out);
+    for (size_t c = 0; c < columns.count; c++)
+    {
+        fprintf(opts.out, ",%s", columns.items[c]);
+    }
+    fputc('\n', opts.out);
+
+    for (size_t i = 0; i < segments.count; i++)
+    {
+        result |= export_segment(segments.items[i], &opts) != 0;
+    }
+
+    if (opts.out != stdout)
+    {
+        fclose(opts.out);
+    }
+    return result;
+}
@@ -0,0 +1,326 @@
+/**
+ * @file historian_segment.c
+ * @brief Historian segment file format, block builder and reader
+ */
+
+#include "historian_segment.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BLOCK_ALIGN 8
+
+static size_t align_up(size_t value)
+{
+    return (value + BLOCK_ALIGN - 1) & ~(size_t)(BLOCK_ALIGN - 1);
+}
+
+uint32_t hist_crc32(const void *data, size_t len)
+{
+    static uint32_t table[256];
+    static int table_ready = 0;
+
+    if (!table_ready)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        table_ready = 1;
+    }
+
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc     = 0xFFFFFFFFU;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+/*
+ * =============================================================================
+ * Block builder
+ * =============================================================================
+ */
+
+static void builder_reset(hist_block_builder_t *b)
+{
+    for (uint32_t c = 0; c <= b->signal_count; c++)
+    {
+        hist_column_init(&b->encoders[c], b->encoders[c].type, b->columns[c], b->column_caps[c]);
+    }
+    b->samples     = 0;
+    b->first_ts_us = 0;
+    b->last_ts_us  = 0;
+}
+
+int hist_block_builder_init(hist_block_builder_t *b, const hist_column_type_t *column_types,
+                            uint32_t signal_count, uint32_t capacity)
+{
+    memset(b, 0, sizeof(*b));
+    b->signal_count = signal_count;
+    b->capacity     = capacity;
+    b->encoders     = calloc(signal_count + 1, sizeof(hist_column_encoder_t));
+    b->columns      = calloc(signal_count + 1, sizeof(uint8_t *));
+    b->column_caps  = calloc(signal_count + 1, sizeof(size_t));
+    if (b->encoders == NULL || b->columns == NULL || b->column_caps == NULL)
+    {
+        hist_block_builder_free(b);
+        return -1;
+    }
+
+    b->out_cap = sizeof(hist_block_header_t) + (signal_count + 1) * sizeof(uint32_t) + BLOCK_ALIGN;
+    for (uint32_t c = 0; c <= signal_count; c++)
+    {
+        hist_column_type_t type = c == 0 ? HIST_COL_TIMESTAMP : column_types[c - 1];
+        b->encoders[c].type     = type;
+        b->column_caps[c]       = hist_column_max_bytes(type, capacity);
+        b->columns[c]           = malloc(b->column_caps[c]);
+        if (b->columns[c] == NULL)
+        {
+            hist_block_builder_free(b);
+            return -1;
+        }
+        b->out_cap += b->column_caps[c];
+    }
+
+    b->out = malloc(b->out_cap);
+    if (b->out == NULL)
+    {
+        hist_block_builder_free(b);
+        return -1;
+    }
+
+    builder_reset(b);
+    return 0;
+}
+
+void hist_block_builder_free(hist_block_builder_t *b)
+{
+    if (b->columns != NULL)
+    {
+        for (uint32_t c = 0; c <= b->signal_count; c++)
+        {
+            free(b->columns[c]);
+        }
+    }
+    free(b->columns);
+    free(b->column_caps);
+    free(b->encoders);
+    free(b->out);
+    memset(b, 0, sizeof(*b));
+}
+
+int hist_block_builder_append(hist_block_builder_t *b, int64_t ts_us, const uint64_t *values)
+{
+    if (b->samples >= b->capacity)
+    {
+        return -1;
+    }
+
+    if (hist_column_append(&b->encoders[0], (uint64_t)ts_us) != 0)
+    {
+        return -1;
+    }
+    for (uint32_t i = 0; i < b->signal_count; i++)
+    {
+        if (hist_column_append(&b->encoders[i + 1], values[i]) != 0)
+        {
+            return -1;
+        }
+    }
+
+    if (b->samples == 0)
+    {
+        b->first_ts_us = ts_us;
+    }
+    b->last_ts_us = ts_us;
+    b->samples++;
+    return 0;
+}
+
+size_t hist_block_builder_finish(hist_block_builder_t *b, const uint8_t **data)
+{
+    if (b->samples == 0)
+    {
+        return 0;
+    }
+
+    hist_block_header_t *header = (hist_block_header_t *)b->out;
+    uint32_t *sizes             = (uint32_t *)(b->out + sizeof(hist_block_header_t));
+    uint8_t *dst                = (uint8_t *)(sizes + b->signal_count + 1);
+
+    for (uint32_t c = 0; c <= b->signal_count; c++)
+    {
+        size_t size = hist_column_finish(&b->encoders[c]);
+        memcpy(dst, b->columns[c], size);
+        sizes[c] = (uint32_t)size;
+        dst += size;
+    }
+
+    size_t payload_size  = (size_t)(dst - (uint8_t *)sizes);
+    size_t block_size    = align_up(sizeof(hist_block_header_t) + payload_size);
+    header->magic        = HIST_BLOCK_MAGIC;
+    header->sample_count = b->samples;
+    header->payload_size = (uint32_t)payload_size;
+    header->crc32        = hist_crc32(sizes, payload_size);
+    header->first_ts_us  = b->first_ts_us;
+    header->last_ts_us   = b->last_ts_us;
+    memset(dst, 0, block_size - sizeof(hist_block_header_t) - payload_size);
+
+    builder_reset(b);
+    *data = b->out;
+    return block_size;
+}
+
+long hist_segment_write_header(int fd, const hist_signal_desc_t *signals, uint32_t signal_count,
+                               int64_t created_us)
+{
+    hist_segment_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HIST_SEGMENT_MAGIC, sizeof(header.magic));
+    header.version      = HIST_SEGMENT_VERSION;
+    header.header_size  = (uint32_t)(sizeof(header) + signal_count * sizeof(hist_signal_desc_t));
+    header.signal_count = signal_count;
+    header.created_us   = created_us;
+
+    size_t table_size = signal_count * sizeof(hist_signal_desc_t);
+    if (write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+        write(fd, signals, table_size) != (ssize_t)table_size)
+    {
+        return -1;
+    }
+    return (long)header.header_size;
+}
+
+/*
+ * =============================================================================
+ * Reader
+ * =============================================================================
+ */
+
+int hist_segment_open(const char *path, hist_segment_t *seg)
+{
+    memset(seg, 0, sizeof(*seg));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(hist_segment_header_t))
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    seg->base   = (const uint8_t *)base;
+    seg->size   = (size_t)st.st_size;
+    seg->header = (const hist_segment_header_t *)base;
+
+    const hist_segment_header_t *h = seg->header;
+    if (memcmp(h->magic, HIST_SEGMENT_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != HIST_SEGMENT_VERSION ||
+        h->header_size != sizeof(*h) + h->signal_count * sizeof(hist_signal_desc_t) ||
+        h->header_size > seg->size)
+    {
+        hist_segment_close(seg);
+        errno = EINVAL;
+        return -1;
+    }
+
+    seg->signals = (const hist_signal_desc_t *)(seg->base + sizeof(*h));
+    return 0;
+}
+
+void hist_segment_close(hist_segment_t *seg)
+{
+    if (seg->base != NULL)
+    {
+        munmap((void *)seg->base, seg->size);
+    }
+    memset(seg, 0, sizeof(*seg));
+}
+
+int hist_segment_next_block(const hist_segment_t *seg, size_t *offset, hist_block_view_t *block)
+{
+    if (*offset == 0)
+    {
+        *offset = seg->header->header_size;
+    }
+
+    size_t pos = *offset;
+    if (pos + sizeof(hist_block_header_t) > seg->size)
+    {
+        return 0;
+    }
+
+    const hist_block_header_t *header = (const hist_block_header_t *)(seg->base + pos);
+    size_t table_size = (seg->header->signal_count + 1) * sizeof(uint32_t);
+    if (header->magic != HIST_BLOCK_MAGIC || header->sample_count == 0 ||
+        header->payload_size < table_size ||
+        pos + sizeof(*header) + header->payload_size > seg->size)
+    {
+        return 0;
+    }
+
+    const uint8_t *payload = seg->base + pos + sizeof(*header);
+    if (hist_crc32(payload, header->payload_size) != header->crc32)
+    {
+        return 0;
+    }
+
+    block->header       = header;
+    block->column_sizes = (const uint32_t *)payload;
+    block->column_data  = payload + table_size;
+    *offset             = pos + align_up(sizeof(*header) + header->payload_size);
+    return 1;
+}
+
+int hist_block_decode_column(const hist_segment_t *seg, const hist_block_view_t *block,
+                             uint32_t column, uint64_t *out)
+{
+    uint32_t signal_count = seg->header->signal_count;
+    if (column > signal_count)
+    {
+        return -1;
+    }
+
+    size_t table_size = (signal_count + 1) * sizeof(uint32_t);
+    size_t available  = block->header->payload_size - table_size;
+    size_t start      = 0;
+    for (uint32_t c = 0; c < column; c++)
+    {
+        start += block->column_sizes[c];
+    }
+    size_t size = block->column_sizes[column];
+    if (start + size > available)
+    {
+        return -1;
+    }
+
+    hist_column_type_t type =
+        column == 0 ? HIST_COL_TIMESTAMP : (hist_column_type_t)seg->signals[column - 1].column_type;
+    return hist_column_decode(type, block->column_data + start, size, block->header->sample_count,
+                              out);
+}
@@ -0,0 +1,207 @@
+/**
+ * @file historian_segment.h
+ * @brief Historian segment file format, block builder and reader
+ *
+ * A segment is an append-only file that can be memory-mapped and read in
+ * place:
+ *
+ *     +------------------------------+  offset 0
+ *     | hist_segment_header_t        |
+ *     | hist_signal_desc_t [n]       |
+ *     +------------------------------+  header_size
+ *     | block 0                      |
+ *     | block 1                      |
+ *     | ...                          |
+ *     +------------------------------+
+ *
+ * Each block is self-contained and starts on an 8-byte boundary:
+ *
+ *     hist_block_header_t
+ *     uint32_t column_size[n + 1]   (column 0 = timestamps, column i + 1 = signal i)
+ *     column data
+ *     padding to 8 bytes
+ *
+ * The CRC covers the column size table and the column data, so a block that
+ * was only partially written before a power loss is detected and ignored.
+ * All integers are stored in host byte order.
+ */
+
+#ifndef HISTORIAN_SEGMENT_H
+#define HISTORIAN_SEGMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "historian_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HIST_SEGMENT_MAGIC    "OPLCHIST"
+#define HIST_SEGMENT_VERSION  1
+#define HIST_BLOCK_MAGIC      0x4B4C4248U /* "HBLK" */
+#define HIST_SIGNAL_NAME_LEN  48
+#define HIST_SEGMENT_PREFIX   "hist_"
+#define HIST_SEGMENT_SUFFIX   ".seg"
+
+typedef struct
+{
+    char magic[8];         /* HIST_SEGMENT_MAGIC */
+    uint32_t version;      /* HIST_SEGMENT_VERSION */
+    uint32_t header_size;  /* This header plus the signal table */
+    uint32_t signal_count; /* Entries in the signal table */
+    uint32_t reserved;
+    int64_t created_us;    /* Creation time, microseconds since the epoch */
+} hist_segment_header_t;
+
+typedef struct
+{
+    char name[HIST_SIGNAL_NAME_LEN];
+    uint32_t value_type;  /* historian_value_type_t of the source */
+    uint32_t column_type; /* hist_column_type_t used for encoding */
+} hist_signal_desc_t;
+
+typedef struct
+{
+    uint32_t magic;        /* HIST_BLOCK_MAGIC */
+    uint32_t sample_count; /* Samples in this block */
+    uint32_t payload_size; /* Column size table plus column data, without padding */
+    uint32_t crc32;        /* CRC-32 of the payload */
+    int64_t first_ts_us;   /* Timestamp of the first sample */
+    int64_t last_ts_us;    /* Timestamp of the last sample */
+} hist_block_header_t;
+
+/*
+ * =============================================================================
+ * Block builder (writer side)
+ * =============================================================================
+ */
+
+typedef struct
+{
+    uint32_t signal_count;
+    uint32_t capacity;                 /* Samples per block */
+    hist_column_encoder_t *encoders;   /* signal_count + 1 */
+    uint8_t **columns;                 /* Encoder buffers */
+    size_t *column_caps;
+    uint8_t *out;                      /* Assembled block */
+    size_t out_cap;
+    uint32_t samples;
+    int64_t first_ts_us;
+    int64_t last_ts_us;
+} hist_block_builder_t;
+
+/**
+ * @brief Allocate a block builder
+ *
+ * @param b            Builder to initialize
+ * @param column_types Column type of each signal (timestamps are implicit)
+ * @param signal_count Number of signals
+ * @param capacity     Samples per block
+ * @return 0 on success, -1 on allocation failure
+ */
+int hist_block_builder_init(hist_block_builder_t *b, const hist_column_type_t *column_types,
+                            uint32_t signal_count, uint32_t capacity);
+
+/**
+ * @brief Release a block builder
+ */
+void hist_block_builder_free(hist_block_builder_t *b);
+
+/**
+ * @brief Append one sample
+ *
+ * @param b      Builder
+ * @param ts_us  Sample timestamp in microseconds
+ * @param values Raw value of every signal
+ * @return 0 on success, -1 if the block is full
+ */
+int hist_block_builder_append(hist_block_builder_t *b, int64_t ts_us, const uint64_t *values);
+
+/**
+ * @brief Assemble the block and reset the builder for the next one
+ *
+ * @param b    Builder
+ * @param data Receives a pointer to the block (valid until the next call)
+ * @return Block size in bytes including padding, or 0 if the builder is empty
+ */
+size_t hist_block_builder_finish(hist_block_builder_t *b, const uint8_t **data);
+
+/**
+ * @brief Write a segment header and signal table to a new file
+ *
+ * @param fd           File descriptor of the empty segment file
+ * @param signals      Signal table
+ * @param signal_count Number of signals
+ * @param created_us   Creation time
+ * @return Bytes written, or -1 on error
+ */
+long hist_segment_write_header(int fd, const hist_signal_desc_t *signals, uint32_t signal_count,
+                               int64_t created_us);
+
+/*
+ * =============================================================================
+ * Reader
+ * =============================================================================
+ */
+
+typedef struct
+{
+    const uint8_t *base;
+    size_t size;
+    const hist_segment_header_t *header;
+    const hist_signal_desc_t *signals;
+} hist_segment_t;
+
+typedef struct
+{
+    const hist_block_header_t *header;
+    const uint32_t *column_sizes;
+    const uint8_t *column_data;
+} hist_block_view_t;
+
+/**
+ * @brief Map a segment file read-only
+ *
+ * @return 0 on success, -1 if the file cannot be mapped or is not a segment
+ */
+int hist_segment_open(const char *path, hist_segment_t *seg);
+
+/**
+ * @brief Unmap a segment
+ */
+void hist_segment_close(hist_segment_t *seg);
+
+/**
+ * @brief Iterate over the blocks of a segment
+ *
+ * @param seg    Mapped segment
+ * @param offset Iterator; set to 0 before the first call
+ * @param block  Receives the next block
+ * @return 1 if a block was returned, 0 at the end (or at a torn tail block)
+ */
+int hist_segment_next_block(const hist_segment_t *seg, size_t *offset, hist_block_view_t *block);
+
+/**
+ * @brief Decode one column of a block
+ *
+ * @param seg    Mapped segment
+ * @param block  Block from hist_segment_next_block()
+ * @param column 0 for timestamps, i + 1 for signal i
+ * @param out    Receives block->header->sample_count raw values
+ * @return 0 on success, -1 on malformed data
+ */
+int hist_block_decode_column(const hist_segment_t *seg, const hist_block_view_t *block,
+                             uint32_t column, uint64_t *out);
+
+/**
+ * @brief CRC-32 (IEEE 802.3) of a buffer
+ */
+uint32_t hist_crc32(const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORIAN_SEGMENT_H */
@@ -0,0 +1,390 @@
+/**
+ * @file mqtt_client.c
+ * @brief Minimal blocking MQTT 3.1.1 publishing client
+ */
+
+#define _GNU_SOURCE
+#include "mqtt_client.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CONNECT_BUFFER_SIZE 1024
+#define MAX_TOPIC_LEN       256
+
+static int64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int fail(mqtt_client_t *client, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(client->error, sizeof(client->error), fmt, args);
+    va_end(args);
+
+    if (client->fd >= 0)
+    {
+        close(client->fd);
+        client->fd = -1;
+    }
+    return -1;
+}
+
+/**
+ * @brief Connect a non-blocking socket within the client timeout
+ */
+static int tcp_connect(mqtt_client_t *client, const char *host, uint16_t port)
+{
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *result = NULL;
+    int rc                  = getaddrinfo(host, port_str, &hints, &result);
+    if (rc != 0)
+    {
+        return fail(client, "cannot resolve %s: %s", host, gai_strerror(rc));
+    }
+
+    int err = ECONNREFUSED;
+    for (struct addrinfo *ai = result; ai != NULL; ai = ai->ai_next)
+    {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        ai->ai_protocol);
+        if (fd < 0)
+        {
+            err = errno;
+            continue;
+        }
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+            socklen_t len     = sizeof(err);
+            err               = errno;
+            if (err != EINPROGRESS || poll(&pfd, 1, client->timeout_ms) != 1 ||
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0)
+            {
+                err = err == EINPROGRESS ? ETIMEDOUT : err;
+                close(fd);
+                continue;
+            }
+        }
+
+        /* Back to blocking mode; sends are bounded by SO_SNDTIMEO, receives by poll() */
+        int one           = 1;
+        struct timeval tv = {.tv_sec = client->timeout_ms / 1000,
+                             .tv_usec = (client->timeout_ms % 1000) * 1000};
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        client->fd = fd;
+        freeaddrinfo(result);
+        return 0;
+    }
+
+    freeaddrinfo(result);
+    return fail(client, "cannot connect to %s:%u: %s", host, port, strerror(err));
+}
+
+static int send_all(mqtt_client_t *client, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt > 0)
+    {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = (size_t)iovcnt;
+
+        ssize_t sent = sendmsg(client->fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return fail(client, "send failed: %s", strerror(errno));
+        }
+
+        while (iovcnt > 0 && (size_t)sent >= iov->iov_len)
+        {
+            sent -= (ssize_t)iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (uint8_t *)iov->iov_base + sent;
+            iov->iov_len -= (size_t)sent;
+        }
+    }
+
+    client->last_tx_ms = monotonic_ms();
+    return 0;
+}
+
+static int recv_exact(mqtt_client_t *client, uint8_t *buf, size_t len, int64_t deadline_ms)
+{
+    size_t got = 0;
+    while (got < len)
+    {
+        int remaining = (int)(deadline_ms - monotonic_ms());
+        if (remaining <= 0)
+        {
+            return fail(client, "timed out waiting for the broker");
+        }
+
+        struct pollfd pfd = {.fd = client->fd, .events = POLLIN};
+        int ready         = poll(&pfd, 1, remaining);
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready <= 0)
+        {
+            return fail(client, "timed out waiting for the broker");
+        }
+
+        ssize_t n = recv(client->fd, buf + got, len - got, 0);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return fail(client, "connection closed by broker");
+        }
+        got += (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Read packets until one of the wanted type arrives
+ *
+ * Other packets (e.g. a late PINGRESP) are skipped.
+ *
+ * @param body     Receives up to body_cap bytes of the packet body
+ * @param body_len Receives the body length
+ */
+static int wait_packet(mqtt_client_t *client, uint8_t type, uint8_t *body, size_t body_cap,
+                       size_t *body_len)
+{
+    int64_t deadline = monotonic_ms() + client->timeout_ms;
+
+    for (;;)
+    {
+        uint8_t header[MQTT_MAX_FIXED_HEADER];
+        uint8_t first      = 0;
+        uint32_t remaining = 0;
+        size_t header_len  = 0;
+        size_t have        = 0;
+        int decoded        = 0;
+
+        while (decoded == 0)
+        {
+            if (recv_exact(client, header + have, 1, deadline) != 0)
+            {
+                return -1;
+            }
+            have++;
+            decoded = mqtt_decode_fixed_header(header, have, &first, &remaining, &header_len);
+        }
+        if (decoded < 0)
+        {
+            return fail(client, "malformed packet from broker");
+        }
+
+        uint8_t skip[64];
+        size_t stored = 0;
+        while (remaining > 0)
+        {
+            size_t chunk = remaining;
+            uint8_t *dst = skip;
+            if (stored < body_cap)
+            {
+                chunk = chunk < body_cap - stored ? chunk : body_cap - stored;
+                dst   = body + stored;
+            }
+            else if (chunk > sizeof(skip))
+            {
+                chunk = sizeof(skip);
+            }
+
+            if (recv_exact(client, dst, chunk, deadline) != 0)
+            {
+                return -1;
+            }
+            if (dst != skip)
+            {
+                stored += chunk;
+            }
+            remaining -= (uint32_t)chunk;
+        }
+
+        if ((first >> 4) == type)
+        {
+            *body_len = stored;
+            return 0;
+        }
+    }
+}
+
+void mqtt_client_init(mqtt_client_t *client, int timeout_ms)
+{
+    memset(client, 0, sizeof(*client));
+    client->fd             = -1;
+    client->timeout_ms     = timeout_ms;
+    client->next_packet_id = 1;
+}
+
+int mqtt_client_connect(mqtt_client_t *client, const char *host, uint16_t port,
+                        const mqtt_connect_params_t *params)
+{
+    if (client->fd >= 0)
+    {
+        mqtt_client_disconnect(client);
+    }
+
+    uint8_t packet[CONNECT_BUFFER_SIZE];
+    size_t len = mqtt_encode_connect(packet, sizeof(packet), params);
+    if (len == 0)
+    {
+        return fail(client, "CONNECT parameters too long");
+    }
+
+    if (tcp_connect(client, host, port) != 0)
+    {
+        return -1;
+    }
+
+    struct iovec iov = {.iov_base = packet, .iov_len = len};
+    if (send_all(client, &iov, 1) != 0)
+    {
+        return -1;
+    }
+
+    uint8_t ack[2];
+    size_t ack_len = 0;
+    if (wait_packet(client, MQTT_CONNACK, ack, sizeof(ack), &ack_len) != 0)
+    {
+        return -1;
+    }
+    if (ack_len != 2 || ack[1] != 0)
+    {
+        return fail(client, "broker refused connection (return code %u)",
+                    ack_len == 2 ? ack[1] : 255);
+    }
+
+    client->keepalive_s = params->keepalive_s;
+    return 0;
+}
+
+int mqtt_client_publish(mqtt_client_t *client, const char *topic, const void *payload,
+                        size_t len, uint8_t qos, bool retain)
+{
+    if (client->fd < 0)
+    {
+        return -1;
+    }
+
+    uint16_t packet_id = 0;
+    if (qos > 0)
+    {
+        packet_id = client->next_packet_id++;
+        if (client->next_packet_id == 0)
+        {
+            client->next_packet_id = 1;
+        }
+    }
+
+    uint8_t header[MQTT_MAX_FIXED_HEADER + 2 + MAX_TOPIC_LEN + 2];
+    size_t header_len = mqtt_encode_publish_header(header, sizeof(header), topic, len, qos,
+                                                   retain, false, packet_id);
+    if (header_len == 0)
+    {
+        return fail(client, "invalid topic or message too large");
+    }
+
+    struct iovec iov[2] = {{.iov_base = header, .iov_len = header_len},
+                           {.iov_base = (void *)payload, .iov_len = len}};
+    if (send_all(client, iov, len > 0 ? 2 : 1) != 0)
+    {
+        return -1;
+    }
+
+    if (qos == 0)
+    {
+        return 0;
+    }
+
+    /* One message in flight: wait for its acknowledgement */
+    for (;;)
+    {
+        uint8_t ack[2];
+        size_t ack_len = 0;
+        if (wait_packet(client, MQTT_PUBACK, ack, sizeof(ack), &ack_len) != 0)
+        {
+            return -1;
+        }
+        if (ack_len == 2 && (uint16_t)((ack[0] << 8) | ack[1]) == packet_id)
+        {
+            return 0;
+        }
+    }
+}
+
+int mqtt_client_keepalive(mqtt_client_t *client)
+{
+    if (client->fd < 0 || client->keepalive_s == 0 ||
+        monotonic_ms() - client->last_tx_ms < (int64_t)client->keepalive_s * 500)
+    {
+        return 0;
+    }
+
+    uint8_t packet[2];
+    struct iovec iov = {.iov_base = packet, .iov_len = mqtt_encode_simple(packet, MQTT_PINGREQ)};
+    size_t body_len  = 0;
+    if (send_all(client, &iov, 1) != 0 ||
+        wait_packet(client, MQTT_PINGRESP, NULL, 0, &body_len) != 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+void mqtt_client_disconnect(mqtt_client_t *client)
+{
+    if (client->fd < 0)
+    {
+        return;
+    }
+
+    uint8_t packet[2];
+    struct iovec iov = {.iov_base = packet,
+                        .iov_len  = mqtt_encode_simple(packet, MQTT_DISCONNECT)};
+    if (send_all(client, &iov, 1) == 0)
+    {
+        close(client->fd);
+        client->fd = -1;
+    }
+}
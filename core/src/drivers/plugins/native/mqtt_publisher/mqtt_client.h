@@ -0,0 +1,85 @@
+/**
+ * @file mqtt_client.h
+ * @brief Minimal blocking MQTT 3.1.1 publishing client
+ *
+ * The client is meant to be driven by a single background thread. Every call
+ * is bounded by a timeout so a dead link never blocks the caller forever.
+ */
+
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mqtt_packet.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    int fd;                /* -1 while disconnected */
+    uint16_t keepalive_s;
+    uint16_t next_packet_id;
+    int timeout_ms;        /* Bound for connect, send and acknowledgement waits */
+    int64_t last_tx_ms;    /* Monotonic time of the last packet sent */
+    char error[128];       /* Reason of the last failure */
+} mqtt_client_t;
+
+/**
+ * @brief Initialize a disconnected client
+ */
+void mqtt_client_init(mqtt_client_t *client, int timeout_ms);
+
+/**
+ * @brief Open a TCP connection and complete the MQTT handshake
+ *
+ * @param client Client
+ * @param host   Broker host name or address
+ * @param port   Broker port
+ * @param params CONNECT parameters
+ * @return 0 on success, -1 on failure (see client->error)
+ */
+int mqtt_client_connect(mqtt_client_t *client, const char *host, uint16_t port,
+                        const mqtt_connect_params_t *params);
+
+/**
+ * @brief Publish a message
+ *
+ * With QoS 1 the call returns once the broker has acknowledged the message.
+ *
+ * @return 0 on success, -1 on failure (the connection is closed)
+ */
+int mqtt_client_publish(mqtt_client_t *client, const char *topic, const void *payload,
+                        size_t len, uint8_t qos, bool retain);
+
+/**
+ * @brief Send a PINGREQ if the keepalive interval is half used up
+ *
+ * @return 0 on success or if nothing was due, -1 on failure (the connection is closed)
+ */
+int mqtt_client_keepalive(mqtt_client_t *client);
+
+/**
+ * @brief Send DISCONNECT and close the connection
+ *
+ * A clean disconnect suppresses the last will.
+ */
+void mqtt_client_disconnect(mqtt_client_t *client);
+
+/**
+ * @brief Whether the client is connected
+ */
+static inline bool mqtt_client_connected(const mqtt_client_t *client)
+{
+    return client->fd >= 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_CLIENT_H */
@@ -0,0 +1,178 @@
+/**
+ * @file mqtt_packet.c
+ * @brief MQTT 3.1.1 packet encoding and decoding (publisher subset)
+ */
+
+#include "mqtt_packet.h"
+
+#include <string.h>
+
+#define MQTT_MAX_REMAINING_LEN 268435455U
+
+static size_t encode_remaining_length(uint8_t *buf, uint32_t value)
+{
+    size_t n = 0;
+    do
+    {
+        uint8_t byte = value % 128;
+        value /= 128;
+        if (value > 0)
+        {
+            byte |= 0x80;
+        }
+        buf[n++] = byte;
+    } while (value > 0);
+    return n;
+}
+
+static size_t remaining_length_size(uint32_t value)
+{
+    uint8_t scratch[4];
+    return encode_remaining_length(scratch, value);
+}
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+    return p + 2;
+}
+
+static uint8_t *put_string(uint8_t *p, const char *s, size_t len)
+{
+    p = put_u16(p, (uint16_t)len);
+    memcpy(p, s, len);
+    return p + len;
+}
+
+static size_t opt_len(const char *s)
+{
+    return s != NULL ? strlen(s) : 0;
+}
+
+size_t mqtt_encode_connect(uint8_t *buf, size_t cap, const mqtt_connect_params_t *params)
+{
+    size_t client_len = opt_len(params->client_id);
+    size_t user_len   = opt_len(params->username);
+    size_t pass_len   = opt_len(params->password);
+    size_t will_len   = opt_len(params->will_topic);
+    size_t msg_len    = opt_len(params->will_message);
+    if (client_len > 65535 || user_len > 65535 || pass_len > 65535 || will_len > 65535 ||
+        msg_len > 65535)
+    {
+        return 0;
+    }
+
+    uint8_t flags = 0x02; /* Clean session */
+    size_t body   = 10 + 2 + client_len;
+    if (will_len > 0)
+    {
+        flags |= 0x04 | (uint8_t)((params->will_qos & 0x03) << 3);
+        flags |= params->will_retain ? 0x20 : 0;
+        body += 2 + will_len + 2 + msg_len;
+    }
+    if (user_len > 0)
+    {
+        flags |= 0x80;
+        body += 2 + user_len;
+        if (pass_len > 0)
+        {
+            flags |= 0x40;
+            body += 2 + pass_len;
+        }
+    }
+
+    size_t total = 1 + remaining_length_size((uint32_t)body) + body;
+    if (total > cap)
+    {
+        return 0;
+    }
+
+    uint8_t *p = buf;
+    *p++       = MQTT_CONNECT << 4;
+    p += encode_remaining_length(p, (uint32_t)body);
+    p    = put_string(p, "MQTT", 4);
+    *p++ = 4; /* Protocol level 3.1.1 */
+    *p++ = flags;
+    p    = put_u16(p, params->keepalive_s);
+    p    = put_string(p, params->client_id != NULL ? params->client_id : "", client_len);
+    if (will_len > 0)
+    {
+        p = put_string(p, params->will_topic, will_len);
+        p = put_string(p, params->will_message != NULL ? params->will_message : "", msg_len);
+    }
+    if (user_len > 0)
+    {
+        p = put_string(p, params->username, user_len);
+        if (pass_len > 0)
+        {
+            p = put_string(p, params->password, pass_len);
+        }
+    }
+    return (size_t)(p - buf);
+}
+
+size_t mqtt_encode_publish_header(uint8_t *buf, size_t cap, const char *topic,
+                                  size_t payload_len, uint8_t qos, bool retain, bool dup,
+                                  uint16_t packet_id)
+{
+    size_t topic_len = strlen(topic);
+    size_t body      = 2 + topic_len + (qos > 0 ? 2 : 0);
+    if (topic_len == 0 || topic_len > 65535 || qos > 1 ||
+        body + payload_len > MQTT_MAX_REMAINING_LEN)
+    {
+        return 0;
+    }
+
+    uint32_t remaining = (uint32_t)(body + payload_len);
+    if (1 + remaining_length_size(remaining) + body > cap)
+    {
+        return 0;
+    }
+
+    uint8_t *p = buf;
+    *p++       = (uint8_t)((MQTT_PUBLISH << 4) | (dup ? 0x08 : 0) | (qos << 1) | (retain ? 1 : 0));
+    p += encode_remaining_length(p, remaining);
+    p = put_string(p, topic, topic_len);
+    if (qos > 0)
+    {
+        p = put_u16(p, packet_id);
+    }
+    return (size_t)(p - buf);
+}
+
+size_t mqtt_encode_simple(uint8_t *buf, uint8_t type)
+{
+    buf[0] = (uint8_t)(type << 4);
+    buf[1] = 0;
+    return 2;
+}
+
+int mqtt_decode_fixed_header(const uint8_t *buf, size_t len, uint8_t *first_byte,
+                             uint32_t *remaining_len, size_t *header_len)
+{
+    if (len < 2)
+    {
+        return 0;
+    }
+
+    uint32_t value      = 0;
+    uint32_t multiplier = 1;
+    for (size_t i = 1; i < MQTT_MAX_FIXED_HEADER; i++)
+    {
+        if (i >= len)
+        {
+            return 0;
+        }
+        value += (uint32_t)(buf[i] & 0x7F) * multiplier;
+        if ((buf[i] & 0x80) == 0)
+        {
+            *first_byte    = buf[0];
+            *remaining_len = value;
+            *header_len    = i + 1;
+            return 1;
+        }
+        multiplier *= 128;
+    }
+    return -1;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file mqtt_packet.h
+ * @brief MQTT 3.1.1 packet encoding and decoding (publisher subset)
+ *
+ * Only the packets a publishing client needs are supported: CONNECT,
+ * CONNACK, PUBLISH, PUBACK, PINGREQ, PINGRESP and DISCONNECT. The functions
+ * work on caller-provided buffers and have no I/O, so they can be unit tested
+ * without a broker.
+ */
+
+#ifndef MQTT_PACKET_H
+#define MQTT_PACKET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Control packet types (upper nibble of the first byte) */
+#define MQTT_CONNECT    1
+#define MQTT_CONNACK    2
+#define MQTT_PUBLISH    3
+#define MQTT_PUBACK     4
+#define MQTT_PINGREQ    12
+#define MQTT_PINGRESP   13
+#define MQTT_DISCONNECT 14
+
+/* Largest fixed header: type byte plus four remaining-length bytes */
+#define MQTT_MAX_FIXED_HEADER 5
+
+/**
+ * @brief CONNECT parameters (NULL or empty strings are omitted)
+ */
+typedef struct
+{
+    const char *client_id;
+    const char *username;
+    const char *password;
+    uint16_t keepalive_s;
+    const char *will_topic;   /* Last will, published by the broker on connection loss */
+    const char *will_message;
+    bool will_retain;
+    uint8_t will_qos;
+} mqtt_connect_params_t;
+
+/**
+ * @brief Encode a CONNECT packet (clean session)
+ *
+ * @return Packet size, or 0 if the buffer is too small
+ */
+size_t mqtt_encode_connect(uint8_t *buf, size_t cap, const mqtt_connect_params_t *params);
+
+/**
+ * @brief Encode the fixed and variable header of a PUBLISH packet
+ *
+ * The payload is not copied; send it right after the returned header.
+ *
+ * @param buf         Destination
+ * @param cap         Capacity of buf
+ * @param topic       Topic name
+ * @param payload_len Length of the payload that follows
+ * @param qos         0 or 1
+ * @param retain      Retain flag
+ * @param dup         Duplicate delivery flag (QoS 1 retransmission)
+ * @param packet_id   Packet identifier (QoS 1 only)
+ * @return Header size, or 0 if the buffer is too small
+ */
+size_t mqtt_encode_publish_header(uint8_t *buf, size_t cap, const char *topic,
+                                  size_t payload_len, uint8_t qos, bool retain, bool dup,
+                                  uint16_t packet_id);
+
+/**
+ * @brief Encode a packet without variable header (PINGREQ, DISCONNECT)
+ *
+ * @return Packet size (always 2)
+ */
+size_t mqtt_encode_simple(uint8_t *buf, uint8_t type);
+
+/**
+ * @brief Decode a fixed header
+ *
+ * @param buf           Received bytes
+ * @param len           Number of received bytes
+ * @param first_byte    Receives the type and flags byte
+ * @param remaining_len Receives the remaining length
+ * @param header_len    Receives the size of the fixed header
+ * @return 1 if the header is complete, 0 if more bytes are needed, -1 if malformed
+ */
+int mqtt_decode_fixed_header(const uint8_t *buf, size_t len, uint8_t *first_byte,
+                             uint32_t *remaining_len, size_t *header_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_PACKET_H */
@@ -0,0 +1,368 @@
+/**
+ * @file mqtt_payload.c
+ * @brief Batch payload encoding for the MQTT publisher plugin
+ */
+
+#include "mqtt_payload.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Worst case of one JSON value: a 17-digit double with sign and exponent */
+#define JSON_VALUE_MAX 32
+
+/* Value type mappings (IEC names, with the bit-string aliases) */
+static const struct
+{
+    const char *name;
+    mqtt_value_type_t type;
+    int size;
+} type_map[] = {
+    {"BOOL", MQTT_TYPE_BOOL, 1},   {"SINT", MQTT_TYPE_SINT, 1},   {"USINT", MQTT_TYPE_USINT, 1},
+    {"BYTE", MQTT_TYPE_USINT, 1},  {"INT", MQTT_TYPE_INT, 2},     {"UINT", MQTT_TYPE_UINT, 2},
+    {"WORD", MQTT_TYPE_UINT, 2},   {"DINT", MQTT_TYPE_DINT, 4},   {"UDINT", MQTT_TYPE_UDINT, 4},
+    {"DWORD", MQTT_TYPE_UDINT, 4}, {"LINT", MQTT_TYPE_LINT, 8},   {"ULINT", MQTT_TYPE_ULINT, 8},
+    {"LWORD", MQTT_TYPE_ULINT, 8}, {"REAL", MQTT_TYPE_REAL, 4},   {"LREAL", MQTT_TYPE_LREAL, 8},
+    {NULL, MQTT_TYPE_NONE, 0}};
+
+const char *mqtt_type_name(mqtt_value_type_t type)
+{
+    for (int i = 0; type_map[i].name != NULL; i++)
+    {
+        if (type_map[i].type == type)
+        {
+            return type_map[i].name;
+        }
+    }
+    return "NONE";
+}
+
+mqtt_value_type_t mqtt_type_from_name(const char *name)
+{
+    if (name == NULL)
+    {
+        return MQTT_TYPE_NONE;
+    }
+    for (int i = 0; type_map[i].name != NULL; i++)
+    {
+        if (strcmp(name, type_map[i].name) == 0)
+        {
+            return type_map[i].type;
+        }
+    }
+    return MQTT_TYPE_NONE;
+}
+
+int mqtt_type_size(mqtt_value_type_t type)
+{
+    for (int i = 0; type_map[i].name != NULL; i++)
+    {
+        if (type_map[i].type == type)
+        {
+            return type_map[i].size;
+        }
+    }
+    return 0;
+}
+
+static float raw_to_float(uint64_t raw)
+{
+    uint32_t bits = (uint32_t)raw;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static double raw_to_lreal(uint64_t raw)
+{
+    double value;
+    memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+static bool is_signed(mqtt_value_type_t type)
+{
+    return type == MQTT_TYPE_SINT || type == MQTT_TYPE_INT || type == MQTT_TYPE_DINT ||
+           type == MQTT_TYPE_LINT;
+}
+
+double mqtt_raw_to_double(mqtt_value_type_t type, uint64_t raw)
+{
+    switch (type)
+    {
+    case MQTT_TYPE_REAL:
+        return (double)raw_to_float(raw);
+    case MQTT_TYPE_LREAL:
+        return raw_to_lreal(raw);
+    default:
+        return is_signed(type) ? (double)(int64_t)raw : (double)raw;
+    }
+}
+
+size_t mqtt_payload_max_size(size_t max_changes, size_t max_name_len)
+{
+    size_t json   = 64 + max_changes * (2 * max_name_len + 4 + JSON_VALUE_MAX);
+    size_t binary = MQTT_PAYLOAD_HEADER_SIZE + max_changes * (MQTT_PAYLOAD_CHANGE_HEADER + 8);
+    return json > binary ? json : binary;
+}
+
+/*
+ * =============================================================================
+ * JSON
+ * =============================================================================
+ */
+
+typedef struct
+{
+    char *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+} json_writer_t;
+
+static void json_printf(json_writer_t *w, const char *fmt, ...)
+{
+    if (w->overflow)
+    {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(w->buf + w->len, w->cap - w->len, fmt, args);
+    va_end(args);
+
+    if (n < 0 || (size_t)n >= w->cap - w->len)
+    {
+        w->overflow = true;
+        return;
+    }
+    w->len += (size_t)n;
+}
+
+static void json_string(json_writer_t *w, const char *s)
+{
+    json_printf(w, "\"");
+    for (; *s != '\0' && !w->overflow; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            json_printf(w, "\\%c", c);
+        }
+        else if (c < 0x20)
+        {
+            json_printf(w, "\\u%04x", c);
+        }
+        else
+        {
+            json_printf(w, "%c", c);
+        }
+    }
+    json_printf(w, "\"");
+}
+
+/**
+ * @brief Print a float with the fewest digits that read back exactly
+ */
+static void json_float(json_writer_t *w, double value, bool single)
+{
+    if (!isfinite(value))
+    {
+        json_printf(w, "null");
+        return;
+    }
+
+    char text[JSON_VALUE_MAX];
+    int first = single ? 6 : 15;
+    int last  = single ? 9 : 17;
+    for (int digits = first; digits <= last; digits++)
+    {
+        snprintf(text, sizeof(text), "%.*g", digits, value);
+        if (single ? strtof(text, NULL) == (float)value : strtod(text, NULL) == value)
+        {
+            break;
+        }
+    }
+    json_printf(w, "%s", text);
+}
+
+static void json_value(json_writer_t *w, mqtt_value_type_t type, uint64_t raw)
+{
+    switch (type)
+    {
+    case MQTT_TYPE_BOOL:
+        json_printf(w, raw ? "true" : "false");
+        break;
+    case MQTT_TYPE_REAL:
+        json_float(w, (double)raw_to_float(raw), true);
+        break;
+    case MQTT_TYPE_LREAL:
+        json_float(w, raw_to_lreal(raw), false);
+        break;
+    default:
+        if (is_signed(type))
+        {
+            json_printf(w, "%" PRId64, (int64_t)raw);
+        }
+        else
+        {
+            json_printf(w, "%" PRIu64, raw);
+        }
+        break;
+    }
+}
+
+size_t mqtt_payload_encode_json(char *buf, size_t cap, const mqtt_tag_desc_t *tags,
+                                const mqtt_batch_t *batch)
+{
+    json_writer_t w = {.buf = buf, .cap = cap, .len = 0, .overflow = false};
+
+    json_printf(&w, "{\"seq\":%" PRIu32 ",\"ts\":%" PRId64 ",\"values\":{", batch->sequence,
+                batch->timestamp_ms);
+    for (uint16_t i = 0; i < batch->count; i++)
+    {
+        const mqtt_change_t *change = &batch->changes[i];
+        const mqtt_tag_desc_t *tag  = &tags[change->tag];
+        if (i > 0)
+        {
+            json_printf(&w, ",");
+        }
+        json_string(&w, tag->name);
+        json_printf(&w, ":");
+        json_value(&w, tag->type, change->raw);
+    }
+    json_printf(&w, "}}");
+
+    return w.overflow ? 0 : w.len;
+}
+
+size_t mqtt_payload_encode_meta(char *buf, size_t cap, const mqtt_tag_desc_t *tags,
+                                size_t tag_count, const char *format)
+{
+    json_writer_t w = {.buf = buf, .cap = cap, .len = 0, .overflow = false};
+
+    json_printf(&w, "{\"format\":");
+    json_string(&w, format);
+    json_printf(&w, ",\"version\":%d,\"tags\":[", MQTT_PAYLOAD_VERSION);
+    for (size_t i = 0; i < tag_count; i++)
+    {
+        json_printf(&w, "%s{\"id\":%zu,\"name\":", i > 0 ? "," : "", i);
+        json_string(&w, tags[i].name);
+        json_printf(&w, ",\"type\":\"%s\"}", mqtt_type_name(tags[i].type));
+    }
+    json_printf(&w, "]}");
+
+    return w.overflow ? 0 : w.len;
+}
+
+/*
+ * =============================================================================
+ * Binary
+ * =============================================================================
+ */
+
+static uint8_t *put_be(uint8_t *p, uint64_t value, int size)
+{
+    for (int i = size - 1; i >= 0; i--)
+    {
+        *p++ = (uint8_t)(value >> (8 * i));
+    }
+    return p;
+}
+
+static uint64_t get_be(const uint8_t *p, int size)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+size_t mqtt_payload_encode_binary(uint8_t *buf, size_t cap, const mqtt_tag_desc_t *tags,
+                                  const mqtt_batch_t *batch)
+{
+    if (cap < MQTT_PAYLOAD_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    uint8_t *p = put_be(buf, MQTT_PAYLOAD_MAGIC, 4);
+    *p++       = MQTT_PAYLOAD_VERSION;
+    *p++       = 0;
+    p          = put_be(p, batch->count, 2);
+    p          = put_be(p, batch->sequence, 4);
+    p          = put_be(p, (uint64_t)batch->timestamp_ms, 8);
+
+    for (uint16_t i = 0; i < batch->count; i++)
+    {
+        const mqtt_change_t *change = &batch->changes[i];
+        mqtt_value_type_t type      = tags[change->tag].type;
+        int size                    = mqtt_type_size(type);
+        if ((size_t)(p - buf) + MQTT_PAYLOAD_CHANGE_HEADER + (size_t)size > cap)
+        {
+            return 0;
+        }
+
+        p    = put_be(p, change->tag, 2);
+        *p++ = (uint8_t)type;
+        p    = put_be(p, change->offset_ms, 2);
+        p    = put_be(p, change->raw, size);
+    }
+    return (size_t)(p - buf);
+}
+
+int mqtt_payload_decode_binary(const uint8_t *buf, size_t len, mqtt_batch_t *batch,
+                               mqtt_change_t *changes, size_t max_changes)
+{
+    if (len < MQTT_PAYLOAD_HEADER_SIZE || get_be(buf, 4) != MQTT_PAYLOAD_MAGIC ||
+        buf[4] != MQTT_PAYLOAD_VERSION)
+    {
+        return -1;
+    }
+
+    batch->count        = (uint16_t)get_be(buf + 6, 2);
+    batch->sequence     = (uint32_t)get_be(buf + 8, 4);
+    batch->timestamp_ms = (int64_t)get_be(buf + 12, 8);
+    batch->changes      = changes;
+    if (batch->count > max_changes)
+    {
+        return -1;
+    }
+
+    size_t pos = MQTT_PAYLOAD_HEADER_SIZE;
+    for (uint16_t i = 0; i < batch->count; i++)
+    {
+        if (pos + MQTT_PAYLOAD_CHANGE_HEADER > len)
+        {
+            return -1;
+        }
+
+        mqtt_value_type_t type = (mqtt_value_type_t)buf[pos + 2];
+        int size               = mqtt_type_size(type);
+        if (size == 0 || pos + MQTT_PAYLOAD_CHANGE_HEADER + (size_t)size > len)
+        {
+            return -1;
+        }
+
+        changes[i].tag       = (uint16_t)get_be(buf + pos, 2);
+        changes[i].offset_ms = (uint16_t)get_be(buf + pos + 3, 2);
+        changes[i].raw       = get_be(buf + pos + MQTT_PAYLOAD_CHANGE_HEADER, size);
+        if (is_signed(type) && size < 8)
+        {
+            /* Restore the sign extension the encoder dropped */
+            int shift      = 64 - 8 * size;
+            changes[i].raw = (uint64_t)((int64_t)(changes[i].raw << shift) >> shift);
+        }
+        pos += MQTT_PAYLOAD_CHANGE_HEADER + (size_t)size;
+    }
+
+    return pos == len ? 0 : -1;
+}
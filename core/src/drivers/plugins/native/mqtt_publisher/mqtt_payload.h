@@ -0,0 +1,162 @@
+/**
+ * @file mqtt_payload.h
+ * @brief Batch payload encoding for the MQTT publisher plugin
+ *
+ * A batch is the set of tag changes collected during one batching window.
+ * It can be encoded as JSON:
+ *
+ *     {"seq":12,"ts":1718000000123,"values":{"pump":true,"level":42,"flow":12.5}}
+ *
+ * or as a compact binary message (network byte order):
+ *
+ *     offset  size  field
+ *     0       4     magic "OPMQ"
+ *     4       1     version
+ *     5       1     reserved
+ *     6       2     number of changes
+ *     8       4     batch sequence number
+ *     12      8     batch timestamp, ms since the epoch
+ *     20      ...   changes
+ *
+ * Each change is a tag id (u16), the value type (u8), the time of the change
+ * relative to the batch timestamp in ms (u16) and the value (1, 2, 4 or 8
+ * bytes depending on the type). Tag ids are the positions in the tag table,
+ * which is published as JSON by mqtt_payload_encode_meta().
+ */
+
+#ifndef MQTT_PAYLOAD_H
+#define MQTT_PAYLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MQTT_PAYLOAD_MAGIC          0x4F504D51U /* "OPMQ" */
+#define MQTT_PAYLOAD_VERSION        1
+#define MQTT_PAYLOAD_HEADER_SIZE    20
+#define MQTT_PAYLOAD_CHANGE_HEADER  5
+
+/**
+ * @brief IEC value types a tag can have
+ */
+typedef enum
+{
+    MQTT_TYPE_NONE = 0,
+    MQTT_TYPE_BOOL,
+    MQTT_TYPE_SINT,
+    MQTT_TYPE_USINT,
+    MQTT_TYPE_INT,
+    MQTT_TYPE_UINT,
+    MQTT_TYPE_DINT,
+    MQTT_TYPE_UDINT,
+    MQTT_TYPE_LINT,
+    MQTT_TYPE_ULINT,
+    MQTT_TYPE_REAL,
+    MQTT_TYPE_LREAL
+} mqtt_value_type_t;
+
+/**
+ * @brief Name and type of a tag
+ */
+typedef struct
+{
+    const char *name;
+    mqtt_value_type_t type;
+} mqtt_tag_desc_t;
+
+/**
+ * @brief One changed tag
+ *
+ * raw holds the value bits: integers zero- or sign-extended to 64 bits, REAL
+ * as the 32-bit float pattern and LREAL as the 64-bit double pattern.
+ */
+typedef struct
+{
+    uint16_t tag;       /* Index into the tag table */
+    uint16_t offset_ms; /* Time of the change relative to the batch timestamp */
+    uint64_t raw;
+} mqtt_change_t;
+
+typedef struct
+{
+    uint32_t sequence;
+    int64_t timestamp_ms;
+    uint16_t count;
+    const mqtt_change_t *changes;
+} mqtt_batch_t;
+
+/**
+ * @brief Configuration name of a value type (e.g. "REAL")
+ */
+const char *mqtt_type_name(mqtt_value_type_t type);
+
+/**
+ * @brief Look up a value type by name ("BYTE", "WORD", ... are accepted as aliases)
+ *
+ * @return Value type, or MQTT_TYPE_NONE if unknown
+ */
+mqtt_value_type_t mqtt_type_from_name(const char *name);
+
+/**
+ * @brief Size in bytes of a value type
+ */
+int mqtt_type_size(mqtt_value_type_t type);
+
+/**
+ * @brief Convert a raw value to double (for deadband comparisons)
+ */
+double mqtt_raw_to_double(mqtt_value_type_t type, uint64_t raw);
+
+/**
+ * @brief Upper bound of the encoded size of a batch
+ *
+ * @param max_changes   Maximum number of changes in a batch
+ * @param max_name_len  Longest tag name
+ */
+size_t mqtt_payload_max_size(size_t max_changes, size_t max_name_len);
+
+/**
+ * @brief Encode a batch as JSON (not NUL-terminated)
+ *
+ * @return Encoded size, or 0 if the buffer is too small
+ */
+size_t mqtt_payload_encode_json(char *buf, size_t cap, const mqtt_tag_desc_t *tags,
+                                const mqtt_batch_t *batch);
+
+/**
+ * @brief Encode a batch in the binary format
+ *
+ * @return Encoded size, or 0 if the buffer is too small
+ */
+size_t mqtt_payload_encode_binary(uint8_t *buf, size_t cap, const mqtt_tag_desc_t *tags,
+                                  const mqtt_batch_t *batch);
+
+/**
+ * @brief Decode a binary batch
+ *
+ * @param buf         Encoded message
+ * @param len         Message length
+ * @param batch       Receives the header; batch->changes points to changes
+ * @param changes     Receives the changes
+ * @param max_changes Capacity of changes
+ * @return 0 on success, -1 if the message is malformed or too large
+ */
+int mqtt_payload_decode_binary(const uint8_t *buf, size_t len, mqtt_batch_t *batch,
+                               mqtt_change_t *changes, size_t max_changes);
+
+/**
+ * @brief Encode the tag table as JSON for the metadata topic (not NUL-terminated)
+ *
+ * @return Encoded size, or 0 if the buffer is too small
+ */
+size_t mqtt_payload_encode_meta(char *buf, size_t cap, const mqtt_tag_desc_t *tags,
+                                size_t tag_count, const char *format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_PAYLOAD_H */
@@ -0,0 +1,347 @@
+/**
+ * @file mqtt_publisher_config.c
+ * @brief MQTT Publisher Plugin Configuration Parser Implementation
+ *
+ * Parses JSON configuration files using cJSON library.
+ */
+
+#include "mqtt_publisher_config.h"
+#include "cJSON.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Error codes */
+#define MQTT_CONFIG_OK          0
+#define MQTT_CONFIG_ERR_FILE    -1
+#define MQTT_CONFIG_ERR_PARSE   -2
+#define MQTT_CONFIG_ERR_INVALID -4
+
+/* Buffer name mappings */
+static const struct
+{
+    const char *name;
+    mqtt_buffer_t buffer;
+    mqtt_value_type_t default_type;
+} buffer_map[] = {
+    {"bool_input", MQTT_BUFFER_BOOL_INPUT, MQTT_TYPE_BOOL},
+    {"bool_output", MQTT_BUFFER_BOOL_OUTPUT, MQTT_TYPE_BOOL},
+    {"bool_memory", MQTT_BUFFER_BOOL_MEMORY, MQTT_TYPE_BOOL},
+    {"byte_input", MQTT_BUFFER_BYTE_INPUT, MQTT_TYPE_USINT},
+    {"byte_output", MQTT_BUFFER_BYTE_OUTPUT, MQTT_TYPE_USINT},
+    {"int_input", MQTT_BUFFER_INT_INPUT, MQTT_TYPE_UINT},
+    {"int_output", MQTT_BUFFER_INT_OUTPUT, MQTT_TYPE_UINT},
+    {"int_memory", MQTT_BUFFER_INT_MEMORY, MQTT_TYPE_UINT},
+    {"dint_input", MQTT_BUFFER_DINT_INPUT, MQTT_TYPE_UDINT},
+    {"dint_output", MQTT_BUFFER_DINT_OUTPUT, MQTT_TYPE_UDINT},
+    {"dint_memory", MQTT_BUFFER_DINT_MEMORY, MQTT_TYPE_UDINT},
+    {"lint_input", MQTT_BUFFER_LINT_INPUT, MQTT_TYPE_ULINT},
+    {"lint_output", MQTT_BUFFER_LINT_OUTPUT, MQTT_TYPE_ULINT},
+    {"lint_memory", MQTT_BUFFER_LINT_MEMORY, MQTT_TYPE_ULINT},
+    {NULL, MQTT_BUFFER_NONE, MQTT_TYPE_NONE}};
+
+/**
+ * @brief Read entire file into a string
+ */
+static char *read_file(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (size <= 0 || size > 1024 * 1024)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    char *buffer = (char *)malloc(size + 1);
+    if (buffer == NULL)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    size_t read_size = fread(buffer, 1, size, fp);
+    fclose(fp);
+
+    if ((long)read_size != size)
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    buffer[size] = '\0';
+    return buffer;
+}
+
+/**
+ * @brief Element size of an image buffer (0 for BOOL and debug variables)
+ */
+static int buffer_element_size(mqtt_buffer_t buffer)
+{
+    switch (buffer)
+    {
+    case MQTT_BUFFER_BYTE_INPUT:
+    case MQTT_BUFFER_BYTE_OUTPUT:
+        return 1;
+    case MQTT_BUFFER_INT_INPUT:
+    case MQTT_BUFFER_INT_OUTPUT:
+    case MQTT_BUFFER_INT_MEMORY:
+        return 2;
+    case MQTT_BUFFER_DINT_INPUT:
+    case MQTT_BUFFER_DINT_OUTPUT:
+    case MQTT_BUFFER_DINT_MEMORY:
+        return 4;
+    case MQTT_BUFFER_LINT_INPUT:
+    case MQTT_BUFFER_LINT_OUTPUT:
+    case MQTT_BUFFER_LINT_MEMORY:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static void read_string(const cJSON *object, const char *key, char *dst, size_t size)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, key);
+    if (cJSON_IsString(item) && item->valuestring != NULL)
+    {
+        strncpy(dst, item->valuestring, size - 1);
+        dst[size - 1] = '\0';
+    }
+}
+
+static void read_int(const cJSON *object, const char *key, int *value)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, key);
+    if (cJSON_IsNumber(item))
+    {
+        *value = item->valueint;
+    }
+}
+
+static void read_bool(const cJSON *object, const char *key, bool *value)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, key);
+    if (cJSON_IsBool(item))
+    {
+        *value = cJSON_IsTrue(item);
+    }
+}
+
+/**
+ * @brief Parse one entry of the "tags" array
+ */
+static int parse_tag(const cJSON *entry, mqtt_tag_config_t *tag)
+{
+    memset(tag, 0, sizeof(*tag));
+
+    const cJSON *field = cJSON_GetObjectItemCaseSensitive(entry, "name");
+    if (!cJSON_IsString(field) || field->valuestring == NULL || field->valuestring[0] == '\0' ||
+        strlen(field->valuestring) >= MQTT_MAX_NAME_LEN)
+    {
+        return MQTT_CONFIG_ERR_INVALID;
+    }
+    strncpy(tag->name, field->valuestring, MQTT_MAX_NAME_LEN - 1);
+    for (const char *c = tag->name; *c != '\0'; c++)
+    {
+        if ((unsigned char)*c < 0x20)
+        {
+            return MQTT_CONFIG_ERR_INVALID;
+        }
+    }
+
+    mqtt_value_type_t default_type = MQTT_TYPE_NONE;
+    field = cJSON_GetObjectItemCaseSensitive(entry, "debug_index");
+    if (cJSON_IsNumber(field))
+    {
+        tag->buffer = MQTT_BUFFER_DEBUG_VARIABLE;
+        tag->index  = field->valueint;
+    }
+    else
+    {
+        field = cJSON_GetObjectItemCaseSensitive(entry, "buffer");
+        if (!cJSON_IsString(field) || field->valuestring == NULL)
+        {
+            return MQTT_CONFIG_ERR_INVALID;
+        }
+        for (int i = 0; buffer_map[i].name != NULL; i++)
+        {
+            if (strcmp(field->valuestring, buffer_map[i].name) == 0)
+            {
+                tag->buffer  = buffer_map[i].buffer;
+                default_type = buffer_map[i].default_type;
+                break;
+            }
+        }
+        if (tag->buffer == MQTT_BUFFER_NONE)
+        {
+            return MQTT_CONFIG_ERR_INVALID;
+        }
+
+        field      = cJSON_GetObjectItemCaseSensitive(entry, "index");
+        tag->index = cJSON_IsNumber(field) ? field->valueint : 0;
+        field      = cJSON_GetObjectItemCaseSensitive(entry, "bit");
+        tag->bit   = cJSON_IsNumber(field) ? field->valueint : 0;
+    }
+
+    field     = cJSON_GetObjectItemCaseSensitive(entry, "type");
+    tag->type = cJSON_IsString(field) ? mqtt_type_from_name(field->valuestring) : default_type;
+
+    field         = cJSON_GetObjectItemCaseSensitive(entry, "deadband");
+    tag->deadband = cJSON_IsNumber(field) ? field->valuedouble : 0.0;
+
+    if (tag->type == MQTT_TYPE_NONE || tag->index < 0 || tag->bit < 0 || tag->bit > 7 ||
+        tag->deadband < 0.0)
+    {
+        return MQTT_CONFIG_ERR_INVALID;
+    }
+
+    /* A typed view of an image buffer must match its element size */
+    int element_size = buffer_element_size(tag->buffer);
+    if (element_size != 0 && element_size != mqtt_type_size(tag->type))
+    {
+        return MQTT_CONFIG_ERR_INVALID;
+    }
+    if ((default_type == MQTT_TYPE_BOOL) != (tag->type == MQTT_TYPE_BOOL) &&
+        tag->buffer != MQTT_BUFFER_DEBUG_VARIABLE)
+    {
+        return MQTT_CONFIG_ERR_INVALID;
+    }
+    return MQTT_CONFIG_OK;
+}
+
+void mqtt_publisher_config_init_defaults(mqtt_publisher_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    memset(config, 0, sizeof(mqtt_publisher_config_t));
+    config->enabled           = true;
+    config->port              = MQTT_DEFAULT_PORT;
+    config->keepalive_s       = MQTT_DEFAULT_KEEPALIVE_S;
+    config->timeout_ms        = MQTT_DEFAULT_TIMEOUT_MS;
+    config->reconnect_min_ms  = MQTT_DEFAULT_RECONNECT_MIN_MS;
+    config->reconnect_max_ms  = MQTT_DEFAULT_RECONNECT_MAX_MS;
+    config->qos               = MQTT_DEFAULT_QOS;
+    config->format            = MQTT_FORMAT_JSON;
+    config->sample_every      = MQTT_DEFAULT_SAMPLE_EVERY;
+    config->batch_window_ms   = MQTT_DEFAULT_BATCH_WINDOW_MS;
+    config->ring_capacity     = MQTT_DEFAULT_RING_CAPACITY;
+    config->store_capacity_kb = MQTT_DEFAULT_STORE_CAPACITY_KB;
+    strncpy(config->client_id, MQTT_DEFAULT_CLIENT_ID, MQTT_MAX_STRING_LEN - 1);
+}
+
+int mqtt_publisher_config_parse(const char *config_path, mqtt_publisher_config_t *config)
+{
+    if (config_path == NULL || config == NULL)
+    {
+        return MQTT_CONFIG_ERR_INVALID;
+    }
+
+    mqtt_publisher_config_init_defaults(config);
+
+    char *json_str = read_file(config_path);
+    if (json_str == NULL)
+    {
+        return MQTT_CONFIG_ERR_FILE;
+    }
+
+    cJSON *root = cJSON_Parse(json_str);
+    free(json_str);
+    if (root == NULL)
+    {
+        return MQTT_CONFIG_ERR_PARSE;
+    }
+
+    read_bool(root, "enabled", &config->enabled);
+
+    int port            = config->port;
+    const cJSON *broker = cJSON_GetObjectItemCaseSensitive(root, "broker");
+    read_string(broker, "host", config->host, sizeof(config->host));
+    read_int(broker, "port", &port);
+    read_string(broker, "client_id", config->client_id, sizeof(config->client_id));
+    read_string(broker, "username", config->username, sizeof(config->username));
+    read_string(broker, "password", config->password, sizeof(config->password));
+    read_int(broker, "keepalive_s", &config->keepalive_s);
+    read_int(broker, "timeout_ms", &config->timeout_ms);
+    read_int(broker, "reconnect_min_ms", &config->reconnect_min_ms);
+    read_int(broker, "reconnect_max_ms", &config->reconnect_max_ms);
+
+    read_string(root, "topic", config->topic, sizeof(config->topic));
+    read_string(root, "status_topic", config->status_topic, sizeof(config->status_topic));
+    read_int(root, "qos", &config->qos);
+    read_bool(root, "retain", &config->retain);
+    read_int(root, "sample_every_n_cycles", &config->sample_every);
+    read_int(root, "batch_window_ms", &config->batch_window_ms);
+    read_int(root, "max_batch_changes", &config->max_batch_changes);
+    read_int(root, "ring_capacity", &config->ring_capacity);
+
+    int result        = MQTT_CONFIG_OK;
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, "format");
+    if (cJSON_IsString(item) && item->valuestring != NULL)
+    {
+        if (strcmp(item->valuestring, "binary") == 0)
+        {
+            config->format = MQTT_FORMAT_BINARY;
+        }
+        else if (strcmp(item->valuestring, "json") != 0)
+        {
+            result = MQTT_CONFIG_ERR_INVALID;
+        }
+    }
+
+    const cJSON *store = cJSON_GetObjectItemCaseSensitive(root, "store");
+    read_string(store, "path", config->store_path, sizeof(config->store_path));
+    read_int(store, "capacity_kb", &config->store_capacity_kb);
+    read_bool(store, "fsync", &config->store_fsync);
+
+    const cJSON *tags  = cJSON_GetObjectItemCaseSensitive(root, "tags");
+    const cJSON *entry = NULL;
+    cJSON_ArrayForEach(entry, tags)
+    {
+        if (result != MQTT_CONFIG_OK || config->num_tags >= MQTT_MAX_TAGS)
+        {
+            result = MQTT_CONFIG_ERR_INVALID;
+            break;
+        }
+
+        result = parse_tag(entry, &config->tags[config->num_tags]);
+        if (result == MQTT_CONFIG_OK)
+        {
+            config->num_tags++;
+        }
+    }
+
+    cJSON_Delete(root);
+
+    if (config->max_batch_changes <= 0 || config->max_batch_changes > config->num_tags)
+    {
+        config->max_batch_changes = config->num_tags;
+    }
+
+    if (result == MQTT_CONFIG_OK &&
+        (config->host[0] == '\0' || port < 1 || port > 65535 || config->topic[0] == '\0' ||
+         config->qos < 0 || config->qos > 1 || config->keepalive_s < 0 ||
+         config->keepalive_s > 65535 || config->timeout_ms < 100 ||
+         config->reconnect_min_ms < 1 || config->reconnect_max_ms < config->reconnect_min_ms ||
+         config->sample_every < 1 || config->batch_window_ms < 0 ||
+         config->batch_window_ms > 60000 || config->ring_capacity < 2 ||
+         config->store_capacity_kb < 1))
+    {
+        result = MQTT_CONFIG_ERR_INVALID;
+    }
+    config->port = (uint16_t)port;
+
+    return result;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file mqtt_publisher_config.h
+ * @brief MQTT Publisher Plugin Configuration Structures and Parser
+ */
+
+#ifndef MQTT_PUBLISHER_CONFIG_H
+#define MQTT_PUBLISHER_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mqtt_payload.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Configuration limits */
+#define MQTT_MAX_TAGS          512
+#define MQTT_MAX_NAME_LEN      48
+#define MQTT_MAX_STRING_LEN    128
+#define MQTT_MAX_TOPIC_LEN     256
+#define MQTT_MAX_PATH_LEN      256
+
+/* Default values */
+#define MQTT_DEFAULT_PORT               1883
+#define MQTT_DEFAULT_CLIENT_ID          "openplc"
+#define MQTT_DEFAULT_KEEPALIVE_S        60
+#define MQTT_DEFAULT_TIMEOUT_MS         5000
+#define MQTT_DEFAULT_RECONNECT_MIN_MS   1000
+#define MQTT_DEFAULT_RECONNECT_MAX_MS   60000
+#define MQTT_DEFAULT_QOS                1
+#define MQTT_DEFAULT_SAMPLE_EVERY       1
+#define MQTT_DEFAULT_BATCH_WINDOW_MS    1000
+#define MQTT_DEFAULT_RING_CAPACITY      4096
+#define MQTT_DEFAULT_STORE_CAPACITY_KB  4096
+
+/**
+ * @brief Where a tag is read from
+ */
+typedef enum
+{
+    MQTT_BUFFER_NONE = 0,
+    MQTT_BUFFER_BOOL_INPUT,
+    MQTT_BUFFER_BOOL_OUTPUT,
+    MQTT_BUFFER_BOOL_MEMORY,
+    MQTT_BUFFER_BYTE_INPUT,
+    MQTT_BUFFER_BYTE_OUTPUT,
+    MQTT_BUFFER_INT_INPUT,
+    MQTT_BUFFER_INT_OUTPUT,
+    MQTT_BUFFER_INT_MEMORY,
+    MQTT_BUFFER_DINT_INPUT,
+    MQTT_BUFFER_DINT_OUTPUT,
+    MQTT_BUFFER_DINT_MEMORY,
+    MQTT_BUFFER_LINT_INPUT,
+    MQTT_BUFFER_LINT_OUTPUT,
+    MQTT_BUFFER_LINT_MEMORY,
+    MQTT_BUFFER_DEBUG_VARIABLE /* Any program variable, by debug index */
+} mqtt_buffer_t;
+
+typedef enum
+{
+    MQTT_FORMAT_JSON = 0,
+    MQTT_FORMAT_BINARY
+} mqtt_format_t;
+
+/**
+ * @brief One published tag
+ */
+typedef struct
+{
+    char name[MQTT_MAX_NAME_LEN]; /* Name used in JSON payloads and the tag table */
+    mqtt_buffer_t buffer;         /* Source buffer */
+    int index;                    /* Buffer index or debug variable index */
+    int bit;                      /* Bit for BOOL buffers (0-7) */
+    mqtt_value_type_t type;       /* Value interpretation */
+    double deadband;              /* Minimum change of a numeric value to publish */
+} mqtt_tag_config_t;
+
+/**
+ * @brief Complete MQTT publisher configuration
+ */
+typedef struct
+{
+    bool enabled;                               /* Enable/disable publishing */
+
+    /* Broker connection */
+    char host[MQTT_MAX_STRING_LEN];             /* Broker host name or address */
+    uint16_t port;                              /* Broker port */
+    char client_id[MQTT_MAX_STRING_LEN];        /* MQTT client identifier */
+    char username[MQTT_MAX_STRING_LEN];         /* Optional user name */
+    char password[MQTT_MAX_STRING_LEN];         /* Optional password */
+    int keepalive_s;                            /* MQTT keepalive interval */
+    int timeout_ms;                             /* Connect and acknowledgement timeout */
+    int reconnect_min_ms;                       /* First reconnect delay */
+    int reconnect_max_ms;                       /* Reconnect delay cap (exponential backoff) */
+
+    /* Publishing */
+    char topic[MQTT_MAX_TOPIC_LEN];             /* Topic of data batches */
+    char status_topic[MQTT_MAX_TOPIC_LEN];      /* Retained online/offline status (optional) */
+    int qos;                                    /* 0 or 1 */
+    bool retain;                                /* Retain data batches */
+    mqtt_format_t format;                       /* Payload encoding */
+    int sample_every;                           /* Detect changes every N PLC cycles */
+    int batch_window_ms;                        /* Collect changes this long before sending */
+    int max_batch_changes;                      /* Send early once this many tags changed */
+    int ring_capacity;                          /* Changes buffered between scan and sender */
+
+    /* Store-and-forward */
+    char store_path[MQTT_MAX_PATH_LEN];         /* Ring file for offline batches ("" = none) */
+    int store_capacity_kb;                      /* Size of the ring file */
+    bool store_fsync;                           /* fdatasync() after every stored batch */
+
+    int num_tags;
+    mqtt_tag_config_t tags[MQTT_MAX_TAGS];
+} mqtt_publisher_config_t;
+
+/**
+ * @brief Parse configuration from JSON file
+ *
+ * @param config_path Path to the JSON configuration file
+ * @param config Pointer to configuration structure to populate
+ * @return 0 on success, negative error code on failure
+ */
+int mqtt_publisher_config_parse(const char *config_path, mqtt_publisher_config_t *config);
+
+/**
+ * @brief Initialize configuration with default values
+ *
+ * @param config Pointer to configuration structure to initialize
+ */
+void mqtt_publisher_config_init_defaults(mqtt_publisher_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_PUBLISHER_CONFIG_H */
@@ -0,0 +1,883 @@
+/**
+ * @file mqtt_publisher_plugin.c
+ * @brief MQTT Publisher Plugin Implementation
+ *
+ * Data path:
+ *
+ *     scan thread (cycle_end)          sender thread
+ *     -----------------------          -------------
+ *     compare tags with last  --->     change ring   --->  coalesce per tag
+ *     published value (deadband)       (fixed slots)       for batch_window_ms
+ *                                                                 |
+ *                                                                 v
+ *                                                   encode JSON/binary batch
+ *                                                                 |
+ *                                           connected? --yes--> PUBLISH (QoS 0/1)
+ *                                                |
+ *                                                no --> store-and-forward ring file
+ *
+ * The scan thread never blocks or touches the network. If the ring is full,
+ * the remaining tags keep their old reference value and are detected again on
+ * the next sample, so a change is delayed but never lost. A tag that changes
+ * several times within one batching window is sent once with its latest value.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mqtt_client.h"
+#include "mqtt_payload.h"
+#include "mqtt_publisher_config.h"
+#include "mqtt_publisher_plugin.h"
+#include "mqtt_store.h"
+#include "plugin_logger.h"
+#include "plugin_types.h"
+
+#define SENDER_POLL_NS      (10 * 1000 * 1000)
+#define FORWARD_PER_POLL    16
+#define FORWARD_BUFFER_SIZE (256 * 1024)
+#define META_TOPIC_SUFFIX   "/meta"
+
+/**
+ * @brief Runtime state of one published tag (owned by the scan thread)
+ */
+typedef struct
+{
+    mqtt_value_type_t type;
+    const void *ptr; /* Resolved value address (NULL reads as 0) */
+    double deadband;
+    uint64_t last_raw; /* Last value handed to the sender */
+    bool has_last;
+} mqtt_tag_runtime_t;
+
+/**
+ * @brief One detected change
+ */
+typedef struct
+{
+    uint16_t tag;
+    int64_t ts_ms;
+    uint64_t raw;
+} change_slot_t;
+
+/* Plugin state */
+static plugin_logger_t g_logger;
+static plugin_runtime_args_t g_runtime_args;
+static mqtt_publisher_config_t g_config;
+static bool g_initialized = false;
+static bool g_running     = false;
+
+static mqtt_tag_runtime_t g_tags[MQTT_MAX_TAGS];
+static mqtt_tag_desc_t g_tag_descs[MQTT_MAX_TAGS];
+static int g_num_tags            = 0;
+static int g_cycles_since_sample = 0;
+
+/* Change ring between the scan thread and the sender thread */
+static change_slot_t *g_ring     = NULL;
+static uint64_t g_ring_mask      = 0;
+static uint64_t g_ring_head      = 0; /* Written by the scan thread */
+static uint64_t g_ring_tail      = 0; /* Written by the sender thread */
+static uint64_t g_ring_overflows = 0;
+
+/* Sender thread state */
+static pthread_t g_sender;
+static bool g_sender_running = false;
+static mqtt_client_t g_client;
+static mqtt_store_t g_store;
+static bool g_store_open = false;
+
+/* Batch being collected: tags in order of their first change */
+static bool g_dirty[MQTT_MAX_TAGS];
+static uint64_t g_pending_raw[MQTT_MAX_TAGS];
+static int64_t g_pending_ts[MQTT_MAX_TAGS];
+static uint16_t g_batch_order[MQTT_MAX_TAGS];
+static mqtt_change_t g_batch_changes[MQTT_MAX_TAGS];
+static int g_batch_count       = 0;
+static int64_t g_batch_open_ms = 0;
+static int64_t g_batch_ts_ms   = 0;
+static uint32_t g_batch_seq    = 0;
+static uint8_t *g_payload      = NULL;
+static size_t g_payload_cap    = 0;
+static uint8_t *g_forward      = NULL;
+
+/* Connection management */
+static int64_t g_next_connect_ms = 0;
+static int g_backoff_ms          = 0;
+static bool g_unreachable_logged = false;
+
+/* Statistics */
+static uint64_t g_changes_coalesced = 0;
+static uint64_t g_batches_published = 0;
+static uint64_t g_batches_stored    = 0;
+static uint64_t g_batches_forwarded = 0;
+static uint64_t g_batches_dropped   = 0;
+static uint64_t g_bytes_published   = 0;
+
+/*
+ * =============================================================================
+ * Helpers
+ * =============================================================================
+ */
+
+static int64_t realtime_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Read a tag as a raw payload value
+ */
+static inline uint64_t read_tag(const mqtt_tag_runtime_t *tag)
+{
+    const void *p = tag->ptr;
+    if (p == NULL)
+    {
+        return 0;
+    }
+
+    switch (tag->type)
+    {
+    case MQTT_TYPE_BOOL:
+        return *(const IEC_BOOL *)p ? 1 : 0;
+    case MQTT_TYPE_SINT:
+        return (uint64_t)(int64_t)(*(const int8_t *)p);
+    case MQTT_TYPE_USINT:
+        return *(const uint8_t *)p;
+    case MQTT_TYPE_INT:
+        return (uint64_t)(int64_t)(*(const int16_t *)p);
+    case MQTT_TYPE_UINT:
+        return *(const uint16_t *)p;
+    case MQTT_TYPE_DINT:
+        return (uint64_t)(int64_t)(*(const int32_t *)p);
+    case MQTT_TYPE_UDINT:
+    case MQTT_TYPE_REAL:
+        return *(const uint32_t *)p;
+    case MQTT_TYPE_LINT:
+    case MQTT_TYPE_ULINT:
+    case MQTT_TYPE_LREAL:
+        return *(const uint64_t *)p;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Whether a new value differs enough from the last published one
+ */
+static inline bool tag_changed(const mqtt_tag_runtime_t *tag, uint64_t raw)
+{
+    if (!tag->has_last)
+    {
+        return true;
+    }
+    if (raw == tag->last_raw)
+    {
+        return false;
+    }
+    if (tag->deadband <= 0.0)
+    {
+        return true;
+    }
+
+    double delta =
+        mqtt_raw_to_double(tag->type, raw) - mqtt_raw_to_double(tag->type, tag->last_raw);
+    /* NaN compares false; treat a change from or to NaN as significant */
+    return !(fabs(delta) < tag->deadband);
+}
+
+static IEC_BOOL *(*bool_table(mqtt_buffer_t buffer))[8]
+{
+    switch (buffer)
+    {
+    case MQTT_BUFFER_BOOL_INPUT:
+        return g_runtime_args.bool_input;
+    case MQTT_BUFFER_BOOL_OUTPUT:
+        return g_runtime_args.bool_output;
+    case MQTT_BUFFER_BOOL_MEMORY:
+        return g_runtime_args.bool_memory;
+    default:
+        return NULL;
+    }
+}
+
+static void *word_table(mqtt_buffer_t buffer)
+{
+    switch (buffer)
+    {
+    case MQTT_BUFFER_BYTE_INPUT:
+        return g_runtime_args.byte_input;
+    case MQTT_BUFFER_BYTE_OUTPUT:
+        return g_runtime_args.byte_output;
+    case MQTT_BUFFER_INT_INPUT:
+        return g_runtime_args.int_input;
+    case MQTT_BUFFER_INT_OUTPUT:
+        return g_runtime_args.int_output;
+    case MQTT_BUFFER_INT_MEMORY:
+        return g_runtime_args.int_memory;
+    case MQTT_BUFFER_DINT_INPUT:
+        return g_runtime_args.dint_input;
+    case MQTT_BUFFER_DINT_OUTPUT:
+        return g_runtime_args.dint_output;
+    case MQTT_BUFFER_DINT_MEMORY:
+        return g_runtime_args.dint_memory;
+    case MQTT_BUFFER_LINT_INPUT:
+        return g_runtime_args.lint_input;
+    case MQTT_BUFFER_LINT_OUTPUT:
+        return g_runtime_args.lint_output;
+    case MQTT_BUFFER_LINT_MEMORY:
+        return g_runtime_args.lint_memory;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * @brief Resolve the value address of every configured tag
+ *
+ * Debug variable addresses are only valid once the program has been glued,
+ * which is guaranteed by the time start_loop() runs.
+ */
+static int resolve_tags(void)
+{
+    int buffer_size = g_runtime_args.buffer_size;
+    int count       = 0;
+
+    for (int i = 0; i < g_config.num_tags; i++)
+    {
+        const mqtt_tag_config_t *cfg = &g_config.tags[i];
+        mqtt_tag_runtime_t *tag      = &g_tags[count];
+        memset(tag, 0, sizeof(*tag));
+        tag->type     = cfg->type;
+        tag->deadband = cfg->deadband;
+
+        if (cfg->buffer == MQTT_BUFFER_DEBUG_VARIABLE)
+        {
+            if (g_runtime_args.get_var_count == NULL ||
+                cfg->index >= (int)g_runtime_args.get_var_count())
+            {
+                plugin_logger_error(&g_logger, "Tag '%s': debug index %d out of range", cfg->name,
+                                    cfg->index);
+                return -1;
+            }
+
+            size_t idx = (size_t)cfg->index;
+            if (g_runtime_args.get_var_size(idx) != (size_t)mqtt_type_size(cfg->type))
+            {
+                plugin_logger_error(&g_logger, "Tag '%s': variable size %zu does not match %s",
+                                    cfg->name, g_runtime_args.get_var_size(idx),
+                                    mqtt_type_name(cfg->type));
+                return -1;
+            }
+
+            void *addr = NULL;
+            g_runtime_args.get_var_list(1, &idx, &addr);
+            tag->ptr = addr;
+        }
+        else
+        {
+            if (cfg->index >= buffer_size)
+            {
+                plugin_logger_error(&g_logger, "Tag '%s': index %d exceeds buffer size %d",
+                                    cfg->name, cfg->index, buffer_size);
+                return -1;
+            }
+
+            IEC_BOOL *(*bools)[8] = bool_table(cfg->buffer);
+            if (bools != NULL)
+            {
+                tag->ptr = bools[cfg->index][cfg->bit];
+            }
+            else
+            {
+                void **table = (void **)word_table(cfg->buffer);
+                tag->ptr     = table[cfg->index];
+            }
+        }
+
+        if (tag->ptr == NULL)
+        {
+            plugin_logger_warn(&g_logger, "Tag '%s' is not bound to a variable, publishing 0",
+                               cfg->name);
+        }
+
+        g_tag_descs[count].name = cfg->name;
+        g_tag_descs[count].type = cfg->type;
+        count++;
+    }
+    g_num_tags = count;
+    return 0;
+}
+
+/*
+ * =============================================================================
+ * Broker Connection
+ * =============================================================================
+ */
+
+static void connection_lost(void)
+{
+    plugin_logger_warn(&g_logger, "Connection to %s:%u lost: %s; storing batches", g_config.host,
+                       g_config.port, g_client.error);
+    g_backoff_ms         = g_config.reconnect_min_ms;
+    g_next_connect_ms    = monotonic_ms() + g_backoff_ms;
+    g_unreachable_logged = true;
+}
+
+/**
+ * @brief Publish a retained message (status and metadata)
+ */
+static int publish_retained(const char *topic, const void *payload, size_t len)
+{
+    if (mqtt_client_publish(&g_client, topic, payload, len, (uint8_t)g_config.qos, true) != 0)
+    {
+        connection_lost();
+        return -1;
+    }
+    return 0;
+}
+
+static void try_connect(void)
+{
+    mqtt_connect_params_t params = {.client_id    = g_config.client_id,
+                                    .username     = g_config.username,
+                                    .password     = g_config.password,
+                                    .keepalive_s  = (uint16_t)g_config.keepalive_s,
+                                    .will_topic   = g_config.status_topic,
+                                    .will_message = "offline",
+                                    .will_retain  = true,
+                                    .will_qos     = (uint8_t)g_config.qos};
+
+    if (mqtt_client_connect(&g_client, g_config.host, g_config.port, &params) != 0)
+    {
+        if (!g_unreachable_logged)
+        {
+            plugin_logger_warn(&g_logger, "Broker unreachable (%s); storing batches",
+                               g_client.error);
+            g_unreachable_logged = true;
+        }
+        g_next_connect_ms = monotonic_ms() + g_backoff_ms;
+        g_backoff_ms *= 2;
+        if (g_backoff_ms > g_config.reconnect_max_ms)
+        {
+            g_backoff_ms = g_config.reconnect_max_ms;
+        }
+        return;
+    }
+
+    plugin_logger_info(&g_logger, "Connected to %s:%u, %" PRIu64 " stored batch(es) to forward",
+                       g_config.host, g_config.port, mqtt_store_count(&g_store));
+    g_unreachable_logged = false;
+    g_backoff_ms         = g_config.reconnect_min_ms;
+
+    if (g_config.status_topic[0] != '\0' &&
+        publish_retained(g_config.status_topic, "online", 6) != 0)
+    {
+        return;
+    }
+
+    /* Tag table for decoding binary batches and for discovery */
+    char topic[MQTT_MAX_TOPIC_LEN + sizeof(META_TOPIC_SUFFIX)];
+    snprintf(topic, sizeof(topic), "%s%s", g_config.topic, META_TOPIC_SUFFIX);
+    const char *format = g_config.format == MQTT_FORMAT_BINARY ? "binary" : "json";
+    size_t len         = mqtt_payload_encode_meta((char *)g_forward, FORWARD_BUFFER_SIZE,
+                                                  g_tag_descs, (size_t)g_num_tags, format);
+    if (len > 0)
+    {
+        publish_retained(topic, g_forward, len);
+    }
+}
+
+/**
+ * @brief Send stored batches, oldest first
+ */
+static void forward_stored(void)
+{
+    for (int i = 0; i < FORWARD_PER_POLL && mqtt_client_connected(&g_client); i++)
+    {
+        uint32_t len = 0;
+        int result   = mqtt_store_peek(&g_store, g_forward, FORWARD_BUFFER_SIZE, &len);
+        if (result == 0)
+        {
+            return;
+        }
+        if (result < 0)
+        {
+            plugin_logger_error(&g_logger, "Stored batch unreadable (%s), skipping",
+                                strerror(errno));
+            if (errno == EMSGSIZE)
+            {
+                mqtt_store_pop(&g_store);
+            }
+            continue;
+        }
+
+        if (mqtt_client_publish(&g_client, g_config.topic, g_forward, len,
+                                (uint8_t)g_config.qos, g_config.retain) != 0)
+        {
+            connection_lost();
+            return;
+        }
+        mqtt_store_pop(&g_store);
+        g_batches_forwarded++;
+        g_bytes_published += len;
+    }
+}
+
+/*
+ * =============================================================================
+ * Batching
+ * =============================================================================
+ */
+
+static void store_batch(const uint8_t *payload, size_t len)
+{
+    if (!g_store_open)
+    {
+        g_batches_dropped++;
+        return;
+    }
+
+    if (mqtt_store_append(&g_store, payload, (uint32_t)len) != 0)
+    {
+        plugin_logger_error(&g_logger, "Cannot store batch: %s", strerror(errno));
+        g_batches_dropped++;
+        return;
+    }
+    g_batches_stored++;
+}
+
+/**
+ * @brief Publish a batch, or store it while offline or while older batches are pending
+ */
+static void deliver(const uint8_t *payload, size_t len)
+{
+    if (mqtt_client_connected(&g_client) && mqtt_store_count(&g_store) == 0)
+    {
+        if (mqtt_client_publish(&g_client, g_config.topic, payload, len, (uint8_t)g_config.qos,
+                                g_config.retain) == 0)
+        {
+            g_batches_published++;
+            g_bytes_published += len;
+            return;
+        }
+        connection_lost();
+    }
+    store_batch(payload, len);
+}
+
+static void emit_batch(void)
+{
+    if (g_batch_count == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < g_batch_count; i++)
+    {
+        uint16_t tag  = g_batch_order[i];
+        int64_t delta = g_pending_ts[tag] - g_batch_ts_ms;
+
+        g_batch_changes[i].tag       = tag;
+        g_batch_changes[i].offset_ms = (uint16_t)(delta < 0 ? 0 : delta > 65535 ? 65535 : delta);
+        g_batch_changes[i].raw       = g_pending_raw[tag];
+        g_dirty[tag]                 = false;
+    }
+
+    mqtt_batch_t batch = {.sequence     = ++g_batch_seq,
+                          .timestamp_ms = g_batch_ts_ms,
+                          .count        = (uint16_t)g_batch_count,
+                          .changes      = g_batch_changes};
+    g_batch_count      = 0;
+
+    size_t len = g_config.format == MQTT_FORMAT_BINARY
+                     ? mqtt_payload_encode_binary(g_payload, g_payload_cap, g_tag_descs, &batch)
+                     : mqtt_payload_encode_json((char *)g_payload, g_payload_cap, g_tag_descs,
+                                                &batch);
+    if (len == 0)
+    {
+        plugin_logger_error(&g_logger, "Batch %" PRIu32 " does not fit the payload buffer",
+                            batch.sequence);
+        g_batches_dropped++;
+        return;
+    }
+    deliver(g_payload, len);
+}
+
+/**
+ * @brief Move detected changes from the ring into the current batch
+ */
+static void drain_ring(void)
+{
+    uint64_t head = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE);
+    uint64_t tail = g_ring_tail;
+
+    for (; tail != head; tail++)
+    {
+        const change_slot_t *slot = &g_ring[tail & g_ring_mask];
+        uint16_t tag              = slot->tag;
+
+        if (g_dirty[tag])
+        {
+            g_changes_coalesced++;
+        }
+        else
+        {
+            if (g_batch_count == 0)
+            {
+                g_batch_open_ms = monotonic_ms();
+                g_batch_ts_ms   = slot->ts_ms;
+            }
+            g_dirty[tag]                   = true;
+            g_batch_order[g_batch_count++] = tag;
+        }
+        g_pending_raw[tag] = slot->raw;
+        g_pending_ts[tag]  = slot->ts_ms;
+
+        if (g_batch_count >= g_config.max_batch_changes)
+        {
+            __atomic_store_n(&g_ring_tail, tail + 1, __ATOMIC_RELEASE);
+            emit_batch();
+        }
+    }
+
+    __atomic_store_n(&g_ring_tail, tail, __ATOMIC_RELEASE);
+}
+
+static void *sender_thread(void *arg)
+{
+    (void)arg;
+    const struct timespec poll = {.tv_sec = 0, .tv_nsec = SENDER_POLL_NS};
+
+    while (__atomic_load_n(&g_sender_running, __ATOMIC_ACQUIRE))
+    {
+        drain_ring();
+        if (g_batch_count > 0 && monotonic_ms() - g_batch_open_ms >= g_config.batch_window_ms)
+        {
+            emit_batch();
+        }
+
+        if (!mqtt_client_connected(&g_client) && monotonic_ms() >= g_next_connect_ms)
+        {
+            try_connect();
+        }
+        if (mqtt_client_connected(&g_client))
+        {
+            forward_stored();
+            if (mqtt_client_keepalive(&g_client) != 0)
+            {
+                connection_lost();
+            }
+        }
+        nanosleep(&poll, NULL);
+    }
+
+    /* Scan thread has stopped sampling; send or store what is left */
+    drain_ring();
+    emit_batch();
+    if (mqtt_client_connected(&g_client))
+    {
+        if (g_config.status_topic[0] != '\0')
+        {
+            mqtt_client_publish(&g_client, g_config.status_topic, "offline", 7,
+                                (uint8_t)g_config.qos, true);
+        }
+        mqtt_client_disconnect(&g_client);
+    }
+    return NULL;
+}
+
+static void release_buffers(void)
+{
+    free(g_ring);
+    free(g_payload);
+    free(g_forward);
+    g_ring    = NULL;
+    g_payload = NULL;
+    g_forward = NULL;
+    if (g_store_open)
+    {
+        mqtt_store_close(&g_store);
+        g_store_open = false;
+    }
+}
+
+/*
+ * =============================================================================
+ * Plugin Lifecycle Functions
+ * =============================================================================
+ */
+
+int init(void *args)
+{
+    if (!args)
+    {
+        plugin_logger_init(&g_logger, "MQTT_PUBLISHER", NULL);
+        plugin_logger_error(&g_logger, "init args is NULL");
+        return -1;
+    }
+
+    /* Copy runtime args (pointer is freed after init returns) */
+    memcpy(&g_runtime_args, args, sizeof(plugin_runtime_args_t));
+
+    plugin_logger_init(&g_logger, "MQTT_PUBLISHER", args);
+    plugin_logger_info(&g_logger, "Initializing MQTT publisher plugin...");
+
+    g_store.fd    = -1;
+    g_initialized = true;
+    return 0;
+}
+
+int start_loop(void)
+{
+    if (!g_initialized)
+    {
+        plugin_logger_error(&g_logger, "Cannot start - plugin not initialized");
+        return -1;
+    }
+
+    if (g_running)
+    {
+        plugin_logger_warn(&g_logger, "MQTT publisher already running");
+        return 0;
+    }
+
+    const char *config_path = g_runtime_args.plugin_specific_config_file_path;
+    if (config_path == NULL || config_path[0] == '\0')
+    {
+        plugin_logger_warn(&g_logger, "No config file specified, nothing to publish");
+        return 0;
+    }
+
+    int result = mqtt_publisher_config_parse(config_path, &g_config);
+    if (result != 0)
+    {
+        plugin_logger_error(&g_logger, "Failed to parse config file %s (error %d)", config_path,
+                            result);
+        return -1;
+    }
+
+    if (!g_config.enabled || g_config.num_tags == 0)
+    {
+        plugin_logger_info(&g_logger, "MQTT publisher is disabled or has no tags configured");
+        return 0;
+    }
+
+    if (resolve_tags() != 0)
+    {
+        return -1;
+    }
+
+    /* Ring capacity is rounded up to a power of two for cheap index masking */
+    uint64_t capacity = 1;
+    while (capacity < (uint64_t)g_config.ring_capacity)
+    {
+        capacity <<= 1;
+    }
+    g_ring_mask   = capacity - 1;
+    g_ring        = malloc(capacity * sizeof(change_slot_t));
+    g_payload_cap = mqtt_payload_max_size((size_t)g_num_tags, MQTT_MAX_NAME_LEN);
+    g_payload     = malloc(g_payload_cap);
+    g_forward     = malloc(FORWARD_BUFFER_SIZE);
+    if (g_ring == NULL || g_payload == NULL || g_forward == NULL)
+    {
+        plugin_logger_error(&g_logger, "Failed to allocate buffers");
+        release_buffers();
+        return -1;
+    }
+
+    /* Touch every ring page now so change detection never page-faults in the scan cycle */
+    memset(g_ring, 0, capacity * sizeof(change_slot_t));
+
+    if (g_config.store_path[0] != '\0')
+    {
+        if (mqtt_store_open(&g_store, g_config.store_path,
+                            (uint64_t)g_config.store_capacity_kb * 1024, g_config.store_fsync) != 0)
+        {
+            plugin_logger_error(&g_logger, "Cannot open store %s: %s", g_config.store_path,
+                                strerror(errno));
+            release_buffers();
+            return -1;
+        }
+        g_store_open = true;
+        if (mqtt_store_count(&g_store) > 0)
+        {
+            plugin_logger_info(&g_logger, "Store holds %" PRIu64 " batch(es) from a previous run",
+                               mqtt_store_count(&g_store));
+        }
+    }
+
+    memset(g_dirty, 0, sizeof(g_dirty));
+    mqtt_client_init(&g_client, g_config.timeout_ms);
+    g_ring_head           = 0;
+    g_ring_tail           = 0;
+    g_ring_overflows      = 0;
+    g_cycles_since_sample = 0;
+    g_batch_count         = 0;
+    g_next_connect_ms     = 0;
+    g_backoff_ms          = g_config.reconnect_min_ms;
+    g_unreachable_logged  = false;
+    g_changes_coalesced   = 0;
+    g_batches_published   = 0;
+    g_batches_stored      = 0;
+    g_batches_forwarded   = 0;
+    g_batches_dropped     = 0;
+    g_bytes_published     = 0;
+
+    /*
+     * start_loop() runs on the real-time scan thread; without an explicit
+     * policy the sender would inherit SCHED_FIFO and compete with the scan.
+     */
+    pthread_attr_t attr;
+    struct sched_param param = {.sched_priority = 0};
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    g_sender_running  = true;
+    int create_result = pthread_create(&g_sender, &attr, sender_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (create_result != 0)
+    {
+        plugin_logger_error(&g_logger, "Failed to create sender thread");
+        g_sender_running = false;
+        release_buffers();
+        return -1;
+    }
+
+    __atomic_store_n(&g_running, true, __ATOMIC_RELEASE);
+    plugin_logger_info(&g_logger,
+                       "Publishing %d tag(s) to %s on %s:%u (%s, QoS %d, %d ms batches)",
+                       g_num_tags, g_config.topic, g_config.host, g_config.port,
+                       g_config.format == MQTT_FORMAT_BINARY ? "binary" : "JSON", g_config.qos,
+                       g_config.batch_window_ms);
+    return 0;
+}
+
+void stop_loop(void)
+{
+    if (!g_running)
+    {
+        return;
+    }
+
+    __atomic_store_n(&g_running, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_sender_running, false, __ATOMIC_RELEASE);
+    pthread_join(g_sender, NULL);
+
+    plugin_logger_info(&g_logger,
+                       "MQTT publisher stopped: %" PRIu64 " batches published, %" PRIu64
+                       " bytes sent, %" PRIu64 " stored, %" PRIu64 " forwarded, %" PRIu64
+                       " dropped, %" PRIu64 " changes coalesced, %" PRIu64 " ring overflows",
+                       g_batches_published, g_bytes_published, g_batches_stored,
+                       g_batches_forwarded, g_batches_dropped, g_changes_coalesced,
+                       g_ring_overflows);
+    if (g_store_open && (mqtt_store_count(&g_store) > 0 || g_store.overwritten > 0))
+    {
+        plugin_logger_info(&g_logger, "%" PRIu64 " batch(es) left in store, %" PRIu64
+                           " overwritten while offline",
+                           mqtt_store_count(&g_store), g_store.overwritten);
+    }
+    release_buffers();
+}
+
+void cleanup(void)
+{
+    stop_loop();
+    g_initialized = false;
+    plugin_logger_info(&g_logger, "MQTT publisher cleanup complete");
+}
+
+void cycle_start(void)
+{
+    /* Changes are detected at cycle end */
+}
+
+void cycle_end(void)
+{
+    if (!__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    if (++g_cycles_since_sample < g_config.sample_every)
+    {
+        return;
+    }
+    g_cycles_since_sample = 0;
+
+    uint64_t head  = g_ring_head;
+    uint64_t limit = __atomic_load_n(&g_ring_tail, __ATOMIC_ACQUIRE) + g_ring_mask + 1;
+    int64_t now_ms = 0;
+
+    for (int i = 0; i < g_num_tags; i++)
+    {
+        mqtt_tag_runtime_t *tag = &g_tags[i];
+        uint64_t raw            = read_tag(tag);
+        if (!tag_changed(tag, raw))
+        {
+            continue;
+        }
+
+        if (head == limit)
+        {
+            /* Unreported tags keep their reference value and are retried next sample */
+            __atomic_store_n(&g_ring_overflows, g_ring_overflows + 1, __ATOMIC_RELAXED);
+            break;
+        }
+
+        if (now_ms == 0)
+        {
+            now_ms = realtime_ms();
+        }
+
+        change_slot_t *slot = &g_ring[head & g_ring_mask];
+        slot->tag           = (uint16_t)i;
+        slot->ts_ms         = now_ms;
+        slot->raw           = raw;
+        head++;
+
+        tag->last_raw = raw;
+        tag->has_last = true;
+    }
+
+    __atomic_store_n(&g_ring_head, head, __ATOMIC_RELEASE);
+}
+
+void program_changed(void)
+{
+    if (!__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    /* Only the addresses change; tag ids and names stay as published */
+    if (resolve_tags() != 0)
+    {
+        plugin_logger_error(&g_logger, "Tags do not match the new program, publishing 0");
+        for (int i = 0; i < g_num_tags; i++)
+        {
+            g_tags[i].ptr = NULL;
+        }
+        return;
+    }
+    plugin_logger_info(&g_logger, "Tags re-resolved after program change");
+}
@@ -0,0 +1,79 @@
+/**
+ * @file mqtt_publisher_plugin.h
+ * @brief MQTT Publisher Plugin for OpenPLC Runtime v4
+ *
+ * This plugin publishes PLC variables to an MQTT broker. Instead of sending
+ * every value every cycle, the scan cycle compares each configured tag with
+ * the value it last reported (with an optional deadband) and queues only the
+ * changes. A background thread coalesces the changes for a configurable
+ * batching window and publishes one JSON or compact binary message per batch.
+ *
+ * While the broker is unreachable, batches are appended to a ring file on
+ * disk and forwarded oldest-first once the connection is back, so a broker
+ * outage shorter than the ring capacity loses no data.
+ */
+
+#ifndef MQTT_PUBLISHER_PLUGIN_H
+#define MQTT_PUBLISHER_PLUGIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the MQTT publisher plugin
+ *
+ * @param args Pointer to plugin_runtime_args_t containing runtime buffers,
+ *             mutex functions, and logging function pointers
+ * @return 0 on success, -1 on failure
+ */
+int init(void *args);
+
+/**
+ * @brief Start publishing
+ *
+ * Parses the configuration, opens the store-and-forward ring and starts the
+ * sender thread, which connects to the broker in the background.
+ */
+int start_loop(void);
+
+/**
+ * @brief Stop publishing
+ *
+ * Sends or stores the pending batch and disconnects from the broker.
+ */
+void stop_loop(void);
+
+/**
+ * @brief Cleanup plugin resources
+ */
+void cleanup(void);
+
+/**
+ * @brief Called at the start of each PLC scan cycle
+ *
+ * Nothing to do; changes are detected at the end of the cycle.
+ */
+void cycle_start(void);
+
+/**
+ * @brief Called at the end of each PLC scan cycle
+ *
+ * Queues the tags that changed since they were last reported. Called with
+ * buffer mutex already held.
+ */
+void cycle_end(void);
+
+/**
+ * @brief Called after an online change replaced the PLC program
+ *
+ * Re-resolves the tag addresses against the new program; every tag is
+ * reported once more. Called by the scan thread with buffer mutex already held.
+ */
+void program_changed(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_PUBLISHER_PLUGIN_H */
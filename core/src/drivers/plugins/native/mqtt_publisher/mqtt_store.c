@@ -0,0 +1,262 @@
+/**
+ * @file mqtt_store.c
+ * @brief On-disk ring of messages for store-and-forward
+ */
+
+#include "mqtt_store.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint32_t mqtt_store_crc32(const void *data, size_t len)
+{
+    static uint32_t table[256];
+    static int table_ready = 0;
+
+    if (!table_ready)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        table_ready = 1;
+    }
+
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc     = 0xFFFFFFFFU;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+static uint32_t header_crc(const mqtt_store_header_t *header)
+{
+    return mqtt_store_crc32(header, offsetof(mqtt_store_header_t, header_crc));
+}
+
+static int write_header(mqtt_store_t *store)
+{
+    store->header.header_crc = header_crc(&store->header);
+    if (pwrite(store->fd, &store->header, sizeof(store->header), 0) !=
+        (ssize_t)sizeof(store->header))
+    {
+        return -1;
+    }
+    return store->sync ? fdatasync(store->fd) : 0;
+}
+
+/**
+ * @brief Read or write len bytes at a ring position, wrapping at the end of the data area
+ */
+static int ring_io(mqtt_store_t *store, uint64_t pos, void *data, size_t len, bool write)
+{
+    uint64_t capacity = store->header.capacity;
+    uint8_t *p        = (uint8_t *)data;
+
+    while (len > 0)
+    {
+        uint64_t offset = pos % capacity;
+        size_t chunk    = len;
+        if (offset + chunk > capacity)
+        {
+            chunk = (size_t)(capacity - offset);
+        }
+
+        off_t file_offset = (off_t)(MQTT_STORE_HEADER_SIZE + offset);
+        ssize_t done      = write ? pwrite(store->fd, p, chunk, file_offset)
+                                  : pread(store->fd, p, chunk, file_offset);
+        if (done != (ssize_t)chunk)
+        {
+            if (done >= 0)
+            {
+                errno = EIO;
+            }
+            return -1;
+        }
+        p += chunk;
+        pos += chunk;
+        len -= chunk;
+    }
+    return 0;
+}
+
+static int reset(mqtt_store_t *store, uint64_t capacity)
+{
+    memset(&store->header, 0, sizeof(store->header));
+    memcpy(store->header.magic, MQTT_STORE_MAGIC, sizeof(store->header.magic));
+    store->header.version  = MQTT_STORE_VERSION;
+    store->header.capacity = capacity;
+
+    if (ftruncate(store->fd, (off_t)(MQTT_STORE_HEADER_SIZE + capacity)) != 0)
+    {
+        return -1;
+    }
+    return write_header(store);
+}
+
+int mqtt_store_open(mqtt_store_t *store, const char *path, uint64_t capacity, bool sync)
+{
+    memset(store, 0, sizeof(*store));
+    store->fd   = -1;
+    store->sync = sync;
+
+    if (capacity < MQTT_STORE_RECORD_HEAD + 1)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    store->fd = fd;
+
+    mqtt_store_header_t *h = &store->header;
+    bool valid = pread(fd, h, sizeof(*h), 0) == (ssize_t)sizeof(*h) &&
+                 memcmp(h->magic, MQTT_STORE_MAGIC, sizeof(h->magic)) == 0 &&
+                 h->version == MQTT_STORE_VERSION && h->capacity == capacity &&
+                 h->header_crc == header_crc(h) && h->head >= h->tail &&
+                 h->head - h->tail <= capacity;
+
+    if (!valid && reset(store, capacity) != 0)
+    {
+        int saved = errno;
+        mqtt_store_close(store);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+void mqtt_store_close(mqtt_store_t *store)
+{
+    if (store->fd >= 0)
+    {
+        close(store->fd);
+    }
+    store->fd = -1;
+}
+
+/**
+ * @brief Move the tail past the oldest record
+ */
+static int advance_tail(mqtt_store_t *store)
+{
+    uint32_t len = 0;
+    if (ring_io(store, store->header.tail, &len, sizeof(len), false) != 0)
+    {
+        return -1;
+    }
+
+    uint64_t next = store->header.tail + MQTT_STORE_RECORD_HEAD + len;
+    if (next > store->header.head)
+    {
+        /* Corrupt length: nothing before head can be trusted */
+        next = store->header.head;
+    }
+    store->header.tail  = next;
+    store->header.count = next == store->header.head ? 0 : store->header.count - 1;
+    return 0;
+}
+
+int mqtt_store_append(mqtt_store_t *store, const void *data, uint32_t len)
+{
+    uint64_t record = MQTT_STORE_RECORD_HEAD + (uint64_t)len;
+    if (store->fd < 0 || record > store->header.capacity)
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    bool dropped = false;
+    while (store->header.head + record - store->header.tail > store->header.capacity)
+    {
+        if (advance_tail(store) != 0)
+        {
+            return -1;
+        }
+        store->overwritten++;
+        dropped = true;
+    }
+
+    /* Never let the header on disk point at a record that is about to be overwritten */
+    if (dropped && write_header(store) != 0)
+    {
+        return -1;
+    }
+
+    uint32_t head[2] = {len, mqtt_store_crc32(data, len)};
+    if (ring_io(store, store->header.head, head, sizeof(head), true) != 0 ||
+        ring_io(store, store->header.head + sizeof(head), (void *)data, len, true) != 0)
+    {
+        return -1;
+    }
+
+    store->header.head += record;
+    store->header.count++;
+    return write_header(store);
+}
+
+int mqtt_store_peek(mqtt_store_t *store, void *buf, uint32_t cap, uint32_t *len)
+{
+    if (store->fd < 0 || store->header.count == 0)
+    {
+        return 0;
+    }
+
+    uint32_t head[2];
+    if (ring_io(store, store->header.tail, head, sizeof(head), false) != 0)
+    {
+        return -1;
+    }
+
+    if (store->header.tail + MQTT_STORE_RECORD_HEAD + head[0] <= store->header.head &&
+        head[0] > cap)
+    {
+        /* Intact but larger than the caller can take; the caller may pop it */
+        *len  = head[0];
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    if (store->header.tail + MQTT_STORE_RECORD_HEAD + head[0] > store->header.head ||
+        ring_io(store, store->header.tail + MQTT_STORE_RECORD_HEAD, buf, head[0], false) != 0 ||
+        mqtt_store_crc32(buf, head[0]) != head[1])
+    {
+        /* Unreadable record: discard everything that is left */
+        store->header.tail  = store->header.head;
+        store->header.count = 0;
+        write_header(store);
+        errno = EIO;
+        return -1;
+    }
+
+    *len = head[0];
+    return 1;
+}
+
+int mqtt_store_pop(mqtt_store_t *store)
+{
+    if (store->fd < 0 || store->header.count == 0)
+    {
+        return 0;
+    }
+    if (advance_tail(store) != 0)
+    {
+        return -1;
+    }
+    return write_header(store);
+}
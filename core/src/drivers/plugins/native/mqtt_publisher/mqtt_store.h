@@ -0,0 +1,122 @@
+/**
+ * @file mqtt_store.h
+ * @brief On-disk ring of messages for store-and-forward
+ *
+ * Messages that cannot be delivered while the broker is unreachable are
+ * appended to a fixed-size file and forwarded in order once the connection
+ * is back. When the ring is full the oldest messages are overwritten, so the
+ * file never grows and the most recent data survives a long outage.
+ *
+ * File layout:
+ *
+ *     mqtt_store_header_t   (one 4 KiB page)
+ *     data area             (capacity bytes, used as a ring)
+ *
+ * Each record is a 32-bit length, a CRC-32 of the message and the message
+ * itself; records may wrap around the end of the data area. The header holds
+ * monotonically increasing head and tail positions and its own CRC, and is
+ * rewritten after the record data, so a crash loses at most the record being
+ * written. The ring survives restarts of the runtime.
+ */
+
+#ifndef MQTT_STORE_H
+#define MQTT_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MQTT_STORE_MAGIC       "OPMQSTOR"
+#define MQTT_STORE_VERSION     1
+#define MQTT_STORE_HEADER_SIZE 4096
+#define MQTT_STORE_RECORD_HEAD 8
+
+typedef struct
+{
+    char magic[8];     /* MQTT_STORE_MAGIC */
+    uint32_t version;  /* MQTT_STORE_VERSION */
+    uint32_t reserved;
+    uint64_t capacity; /* Size of the data area */
+    uint64_t head;     /* Position where the next record is written */
+    uint64_t tail;     /* Position of the oldest record */
+    uint64_t count;    /* Records between tail and head */
+    uint32_t header_crc;
+} mqtt_store_header_t;
+
+typedef struct
+{
+    int fd;
+    bool sync;                  /* fdatasync() after every change */
+    mqtt_store_header_t header;
+    uint64_t overwritten;       /* Records dropped because the ring was full */
+} mqtt_store_t;
+
+/**
+ * @brief Open or create a store
+ *
+ * An existing file with the same capacity is resumed; a file that is not a
+ * valid store or has a different capacity is reinitialized.
+ *
+ * @param store    Store
+ * @param path     File path
+ * @param capacity Size of the data area in bytes
+ * @param sync     fdatasync() after every change
+ * @return 0 on success, -1 on error (errno is set)
+ */
+int mqtt_store_open(mqtt_store_t *store, const char *path, uint64_t capacity, bool sync);
+
+/**
+ * @brief Close a store
+ */
+void mqtt_store_close(mqtt_store_t *store);
+
+/**
+ * @brief Append a message, overwriting the oldest ones if needed
+ *
+ * @return 0 on success, -1 if the message is larger than the ring or on I/O error
+ */
+int mqtt_store_append(mqtt_store_t *store, const void *data, uint32_t len);
+
+/**
+ * @brief Read the oldest message without removing it
+ *
+ * A record that fails its CRC check discards the rest of the ring. A record
+ * larger than cap is left in place and reported with errno EMSGSIZE.
+ *
+ * @param store Store
+ * @param buf   Receives the message
+ * @param cap   Capacity of buf
+ * @param len   Receives the message length
+ * @return 1 if a message was read, 0 if the store is empty, -1 on error
+ */
+int mqtt_store_peek(mqtt_store_t *store, void *buf, uint32_t cap, uint32_t *len);
+
+/**
+ * @brief Remove the oldest message
+ *
+ * @return 0 on success, -1 on error
+ */
+int mqtt_store_pop(mqtt_store_t *store);
+
+/**
+ * @brief Number of stored messages
+ */
+static inline uint64_t mqtt_store_count(const mqtt_store_t *store)
+{
+    return store->fd >= 0 ? store->header.count : 0;
+}
+
+/**
+ * @brief CRC-32 (IEEE 802.3) of a buffer
+ */
+uint32_t mqtt_store_crc32(const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_STORE_H */
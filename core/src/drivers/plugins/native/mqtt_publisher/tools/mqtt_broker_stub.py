@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Minimal MQTT 3.1.1 broker stand-in for testing the MQTT publisher plugin.
+
+Accepts one client at a time, answers CONNECT, PUBLISH (QoS 0 and 1) and
+PINGREQ, and prints every received message as one JSON line. Binary batches
+are decoded using the tag table from the retained ``<topic>/meta`` message.
+
+It is not a broker: nothing is forwarded to subscribers. Options simulate
+broker trouble so store-and-forward can be exercised:
+
+    --drop-after N      close the connection after N PUBLISH packets
+    --down-for S        after a drop, refuse connections for S seconds
+    --no-puback         never acknowledge QoS 1 messages
+
+Example:
+
+    python3 mqtt_broker_stub.py --port 1883 --drop-after 5 --down-for 10
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import time
+
+CONNECT, CONNACK, PUBLISH, PUBACK = 1, 2, 3, 4
+PINGREQ, PINGRESP, DISCONNECT = 12, 13, 14
+
+BINARY_MAGIC = 0x4F504D51  # "OPMQ"
+VALUE_FORMATS = {
+    "BOOL": ">B", "SINT": ">b", "USINT": ">B", "INT": ">h", "UINT": ">H",
+    "DINT": ">i", "UDINT": ">I", "LINT": ">q", "ULINT": ">Q",
+    "REAL": ">f", "LREAL": ">d",
+}
+TYPE_IDS = ["NONE", "BOOL", "SINT", "USINT", "INT", "UINT", "DINT", "UDINT",
+            "LINT", "ULINT", "REAL", "LREAL"]
+
+
+def read_exact(conn, size):
+    data = b""
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("client closed the connection")
+        data += chunk
+    return data
+
+
+def read_packet(conn):
+    first = read_exact(conn, 1)[0]
+    remaining, shift = 0, 0
+    while True:
+        byte = read_exact(conn, 1)[0]
+        remaining |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            break
+        shift += 7
+    return first, read_exact(conn, remaining)
+
+
+def decode_binary(payload, tags):
+    magic, version, _, count, seq, ts = struct.unpack_from(">IBBHIq", payload)
+    if magic != BINARY_MAGIC or version != 1:
+        return None
+    offset, values = 20, {}
+    for _ in range(count):
+        tag, type_id, delta = struct.unpack_from(">HBH", payload, offset)
+        fmt = VALUE_FORMATS[TYPE_IDS[type_id]]
+        (value,) = struct.unpack_from(fmt, payload, offset + 5)
+        offset += 5 + struct.calcsize(fmt)
+        name = tags[tag]["name"] if tag < len(tags) else str(tag)
+        values[name] = {"value": value, "offset_ms": delta}
+    return {"seq": seq, "ts": ts, "values": values}
+
+
+def serve_client(conn, args, state):
+    meta_tags = state.setdefault("meta_tags", [])
+    while True:
+        first, body = read_packet(conn)
+        kind = first >> 4
+        if kind == CONNECT:
+            conn.sendall(bytes([CONNACK << 4, 2, 0, 0]))
+            client_len = struct.unpack_from(">H", body, 10)[0]
+            log({"event": "connect", "client_id": body[12:12 + client_len].decode()})
+        elif kind == PUBLISH:
+            qos = (first >> 1) & 3
+            topic_len = struct.unpack_from(">H", body)[0]
+            topic = body[2:2 + topic_len].decode()
+            offset = 2 + topic_len
+            packet_id = None
+            if qos:
+                packet_id = struct.unpack_from(">H", body, offset)[0]
+                offset += 2
+            payload = body[offset:]
+            state["published"] += 1
+
+            entry = {"event": "publish", "topic": topic, "qos": qos,
+                     "retain": bool(first & 1), "dup": bool(first & 8), "size": len(payload)}
+            if payload[:4] == b"OPMQ":
+                entry["batch"] = decode_binary(payload, meta_tags)
+            else:
+                try:
+                    entry["payload"] = json.loads(payload)
+                except ValueError:
+                    entry["payload"] = payload.decode(errors="replace")
+            if topic.endswith("/meta") and isinstance(entry.get("payload"), dict):
+                meta_tags[:] = entry["payload"].get("tags", [])
+            log(entry)
+
+            if args.drop_after and state["published"] % args.drop_after == 0:
+                log({"event": "drop"})
+                state["down_until"] = time.monotonic() + args.down_for
+                return
+            if qos and not args.no_puback:
+                conn.sendall(bytes([PUBACK << 4, 2]) + struct.pack(">H", packet_id))
+        elif kind == PINGREQ:
+            conn.sendall(bytes([PINGRESP << 4, 0]))
+            log({"event": "ping"})
+        elif kind == DISCONNECT:
+            log({"event": "disconnect"})
+            return
+
+
+def log(entry):
+    entry["time"] = round(time.time(), 3)
+    print(json.dumps(entry), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--drop-after", type=int, default=0)
+    parser.add_argument("--down-for", type=float, default=0.0)
+    parser.add_argument("--no-puback", action="store_true")
+    args = parser.parse_args()
+
+    state = {"published": 0, "down_until": 0.0}
+    while True:
+        listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        listener.bind((args.host, args.port))
+        listener.listen(1)
+        conn, _ = listener.accept()
+        listener.close()
+        try:
+            serve_client(conn, args, state)
+        except (ConnectionError, OSError) as exc:
+            log({"event": "closed", "reason": str(exc)})
+        finally:
+            conn.close()
+
+        # Simulate an outage: nothing listens on the port
+        pause = state["down_until"] - time.monotonic()
+        if pause > 0:
+            time.sleep(pause)
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        sys.exit(0)
@@ -0,0 +1,377 @@
+/**
+ * @file s7comm_buffers.c
+ * @brief Conversion between S7 buffers and OpenPLC image tables
+ */
+
+#include "s7comm_buffers.h"
+
+#include <stddef.h>
+
+/*
+ * =============================================================================
+ * Endianness Conversion Helpers
+ * S7 protocol uses big-endian (network byte order)
+ * =============================================================================
+ */
+static inline uint16_t swap16(uint16_t val)
+{
+    return ((val & 0xFF00) >> 8) | ((val & 0x00FF) << 8);
+}
+
+static inline uint32_t swap32(uint32_t val)
+{
+    return ((val & 0xFF000000) >> 24) |
+           ((val & 0x00FF0000) >> 8)  |
+           ((val & 0x0000FF00) << 8)  |
+           ((val & 0x000000FF) << 24);
+}
+
+static inline uint64_t swap64(uint64_t val)
+{
+    return ((val & 0xFF00000000000000ULL) >> 56) |
+           ((val & 0x00FF000000000000ULL) >> 40) |
+           ((val & 0x0000FF0000000000ULL) >> 24) |
+           ((val & 0x000000FF00000000ULL) >> 8)  |
+           ((val & 0x00000000FF000000ULL) << 8)  |
+           ((val & 0x0000000000FF0000ULL) << 24) |
+           ((val & 0x000000000000FF00ULL) << 40) |
+           ((val & 0x00000000000000FFULL) << 56);
+}
+
+/**
+ * @brief Map s7comm buffer type to journal buffer type
+ *
+ * Journal buffer types (from plugin_types.h):
+ *   0=BOOL_INPUT, 1=BOOL_OUTPUT, 2=BOOL_MEMORY
+ *   3=BYTE_INPUT, 4=BYTE_OUTPUT
+ *   5=INT_INPUT, 6=INT_OUTPUT, 7=INT_MEMORY
+ *   8=DINT_INPUT, 9=DINT_OUTPUT, 10=DINT_MEMORY
+ *   11=LINT_INPUT, 12=LINT_OUTPUT, 13=LINT_MEMORY
+ */
+static int map_to_journal_type(s7comm_buffer_type_t type)
+{
+    switch (type) {
+        case BUFFER_TYPE_BOOL_INPUT:  return 0;
+        case BUFFER_TYPE_BOOL_OUTPUT: return 1;
+        case BUFFER_TYPE_BOOL_MEMORY: return 2;
+        case BUFFER_TYPE_INT_INPUT:   return 5;
+        case BUFFER_TYPE_INT_OUTPUT:  return 6;
+        case BUFFER_TYPE_INT_MEMORY:  return 7;
+        case BUFFER_TYPE_DINT_INPUT:  return 8;
+        case BUFFER_TYPE_DINT_OUTPUT: return 9;
+        case BUFFER_TYPE_DINT_MEMORY: return 10;
+        case BUFFER_TYPE_LINT_INPUT:  return 11;
+        case BUFFER_TYPE_LINT_OUTPUT: return 12;
+        case BUFFER_TYPE_LINT_MEMORY: return 13;
+        default:                      return -1;
+    }
+}
+
+/*
+ * =============================================================================
+ * Read Functions: OpenPLC -> S7 Buffer (for S7 client READs)
+ * These functions copy data from OpenPLC image tables to the S7 buffer.
+ * Called with OpenPLC mutex held.
+ * =============================================================================
+ */
+
+/**
+ * @brief Read OpenPLC bool buffer to destination (mutex must be held)
+ */
+static void read_openplc_bool_to_buffer(const plugin_runtime_args_t *args, uint8_t *dest, int size, s7comm_buffer_type_t type, int start_buffer)
+{
+    IEC_BOOL *(*buffer)[8] = NULL;
+
+    switch (type) {
+        case BUFFER_TYPE_BOOL_INPUT:
+            buffer = args->bool_input;
+            break;
+        case BUFFER_TYPE_BOOL_OUTPUT:
+            buffer = args->bool_output;
+            break;
+        case BUFFER_TYPE_BOOL_MEMORY:
+            buffer = args->bool_memory;
+            break;
+        default:
+            return;
+    }
+
+    if (buffer == NULL) {
+        return;
+    }
+
+    int max_bytes = args->buffer_size - start_buffer;
+    if (max_bytes > size) max_bytes = size;
+
+    for (int byte_idx = 0; byte_idx < max_bytes; byte_idx++) {
+        uint8_t byte_val = 0;
+        int plc_idx = start_buffer + byte_idx;
+        for (int bit_idx = 0; bit_idx < 8; bit_idx++) {
+            IEC_BOOL *ptr = buffer[plc_idx][bit_idx];
+            if (ptr != NULL && *ptr) {
+                byte_val |= (1 << bit_idx);
+            }
+        }
+        dest[byte_idx] = byte_val;
+    }
+}
+
+/**
+ * @brief Read OpenPLC int buffer to destination with endian conversion (mutex must be held)
+ */
+static void read_openplc_int_to_buffer(const plugin_runtime_args_t *args, uint8_t *dest, int size, s7comm_buffer_type_t type, int start_buffer)
+{
+    IEC_UINT **buffer = NULL;
+
+    switch (type) {
+        case BUFFER_TYPE_INT_INPUT:
+            buffer = args->int_input;
+            break;
+        case BUFFER_TYPE_INT_OUTPUT:
+            buffer = args->int_output;
+            break;
+        case BUFFER_TYPE_INT_MEMORY:
+            buffer = args->int_memory;
+            break;
+        default:
+            return;
+    }
+
+    uint16_t *s7_words = (uint16_t *)dest;
+    int num_words = size / 2;
+    int max_words = args->buffer_size - start_buffer;
+    if (max_words > num_words) max_words = num_words;
+
+    for (int i = 0; i < max_words; i++) {
+        IEC_UINT *ptr = buffer[start_buffer + i];
+        if (ptr != NULL) {
+            s7_words[i] = swap16(*ptr);
+        }
+    }
+}
+
+/**
+ * @brief Read OpenPLC dint buffer to destination with endian conversion (mutex must be held)
+ */
+static void read_openplc_dint_to_buffer(const plugin_runtime_args_t *args, uint8_t *dest, int size, s7comm_buffer_type_t type, int start_buffer)
+{
+    IEC_UDINT **buffer = NULL;
+
+    switch (type) {
+        case BUFFER_TYPE_DINT_INPUT:
+            buffer = args->dint_input;
+            break;
+        case BUFFER_TYPE_DINT_OUTPUT:
+            buffer = args->dint_output;
+            break;
+        case BUFFER_TYPE_DINT_MEMORY:
+            buffer = args->dint_memory;
+            break;
+        default:
+            return;
+    }
+
+    uint32_t *s7_dwords = (uint32_t *)dest;
+    int num_dwords = size / 4;
+    int max_dwords = args->buffer_size - start_buffer;
+    if (max_dwords > num_dwords) max_dwords = num_dwords;
+
+    for (int i = 0; i < max_dwords; i++) {
+        IEC_UDINT *ptr = buffer[start_buffer + i];
+        if (ptr != NULL) {
+            s7_dwords[i] = swap32(*ptr);
+        }
+    }
+}
+
+/**
+ * @brief Read OpenPLC lint buffer to destination with endian conversion (mutex must be held)
+ */
+static void read_openplc_lint_to_buffer(const plugin_runtime_args_t *args, uint8_t *dest, int size, s7comm_buffer_type_t type, int start_buffer)
+{
+    IEC_ULINT **buffer = NULL;
+
+    switch (type) {
+        case BUFFER_TYPE_LINT_INPUT:
+            buffer = args->lint_input;
+            break;
+        case BUFFER_TYPE_LINT_OUTPUT:
+            buffer = args->lint_output;
+            break;
+        case BUFFER_TYPE_LINT_MEMORY:
+            buffer = args->lint_memory;
+            break;
+        default:
+            return;
+    }
+
+    uint64_t *s7_lwords = (uint64_t *)dest;
+    int num_lwords = size / 8;
+    int max_lwords = args->buffer_size - start_buffer;
+    if (max_lwords > num_lwords) max_lwords = num_lwords;
+
+    for (int i = 0; i < max_lwords; i++) {
+        IEC_ULINT *ptr = buffer[start_buffer + i];
+        if (ptr != NULL) {
+            s7_lwords[i] = swap64(*ptr);
+        }
+    }
+}
+
+/**
+ * @brief Dispatch read from OpenPLC to buffer based on buffer type
+ */
+void s7comm_read_to_buffer(const plugin_runtime_args_t *args, uint8_t *dest, int size,
+                           s7comm_buffer_type_t type, int start_buffer)
+{
+    switch (type) {
+        case BUFFER_TYPE_BOOL_INPUT:
+        case BUFFER_TYPE_BOOL_OUTPUT:
+        case BUFFER_TYPE_BOOL_MEMORY:
+            read_openplc_bool_to_buffer(args, dest, size, type, start_buffer);
+            break;
+
+        case BUFFER_TYPE_INT_INPUT:
+        case BUFFER_TYPE_INT_OUTPUT:
+        case BUFFER_TYPE_INT_MEMORY:
+            read_openplc_int_to_buffer(args, dest, size, type, start_buffer);
+            break;
+
+        case BUFFER_TYPE_DINT_INPUT:
+        case BUFFER_TYPE_DINT_OUTPUT:
+        case BUFFER_TYPE_DINT_MEMORY:
+            read_openplc_dint_to_buffer(args, dest, size, type, start_buffer);
+            break;
+
+        case BUFFER_TYPE_LINT_INPUT:
+        case BUFFER_TYPE_LINT_OUTPUT:
+        case BUFFER_TYPE_LINT_MEMORY:
+            read_openplc_lint_to_buffer(args, dest, size, type, start_buffer);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * =============================================================================
+ * Write Functions: S7 Buffer -> OpenPLC via Journal (for S7 client WRITEs)
+ * These functions write data from S7 buffer to OpenPLC via journal.
+ * No mutex needed - journal writes are thread-safe.
+ * =============================================================================
+ */
+
+/**
+ * @brief Write bool buffer to OpenPLC via journal
+ */
+static void write_bool_to_openplc_journal(const plugin_runtime_args_t *args, const uint8_t *src, int size, s7comm_buffer_type_t type, int start_buffer)
+{
+    int journal_type = map_to_journal_type(type);
+    if (journal_type < 0) return;
+
+    int max_bytes = args->buffer_size - start_buffer;
+    if (max_bytes > size) max_bytes = size;
+
+    for (int byte_idx = 0; byte_idx < max_bytes; byte_idx++) {
+        uint8_t byte_val = src[byte_idx];
+        int plc_idx = start_buffer + byte_idx;
+        for (int bit_idx = 0; bit_idx < 8; bit_idx++) {
+            int bit_val = (byte_val >> bit_idx) & 0x01;
+            args->journal_write_bool(journal_type, plc_idx, bit_idx, bit_val);
+        }
+    }
+}
+
+/**
+ * @brief Write int buffer to OpenPLC via journal with endian conversion
+ */
+static void write_int_to_openplc_journal(const plugin_runtime_args_t *args, const uint8_t *src, int size, s7comm_buffer_type_t type, int start_buffer)
+{
+    int journal_type = map_to_journal_type(type);
+    if (journal_type < 0) return;
+
+    const uint16_t *s7_words = (const uint16_t *)src;
+    int num_words = size / 2;
+    int max_words = args->buffer_size - start_buffer;
+    if (max_words > num_words) max_words = num_words;
+
+    for (int i = 0; i < max_words; i++) {
+        uint16_t value = swap16(s7_words[i]);
+        args->journal_write_int(journal_type, start_buffer + i, value);
+    }
+}
+
+/**
+ * @brief Write dint buffer to OpenPLC via journal with endian conversion
+ */
+static void write_dint_to_openplc_journal(const plugin_runtime_args_t *args, const uint8_t *src, int size, s7comm_buffer_type_t type, int start_buffer)
+{
+    int journal_type = map_to_journal_type(type);
+    if (journal_type < 0) return;
+
+    const uint32_t *s7_dwords = (const uint32_t *)src;
+    int num_dwords = size / 4;
+    int max_dwords = args->buffer_size - start_buffer;
+    if (max_dwords > num_dwords) max_dwords = num_dwords;
+
+    for (int i = 0; i < max_dwords; i++) {
+        uint32_t value = swap32(s7_dwords[i]);
+        args->journal_write_dint(journal_type, start_buffer + i, value);
+    }
+}
+
+/**
+ * @brief Write lint buffer to OpenPLC via journal with endian conversion
+ */
+static void write_lint_to_openplc_journal(const plugin_runtime_args_t *args, const uint8_t *src, int size, s7comm_buffer_type_t type, int start_buffer)
+{
+    int journal_type = map_to_journal_type(type);
+    if (journal_type < 0) return;
+
+    const uint64_t *s7_lwords = (const uint64_t *)src;
+    int num_lwords = size / 8;
+    int max_lwords = args->buffer_size - start_buffer;
+    if (max_lwords > num_lwords) max_lwords = num_lwords;
+
+    for (int i = 0; i < max_lwords; i++) {
+        uint64_t value = swap64(s7_lwords[i]);
+        args->journal_write_lint(journal_type, start_buffer + i, value);
+    }
+}
+
+/**
+ * @brief Dispatch write from buffer to OpenPLC journal based on buffer type
+ */
+void s7comm_write_from_buffer(const plugin_runtime_args_t *args, const uint8_t *src, int size,
+                              s7comm_buffer_type_t type, int start_buffer)
+{
+    switch (type) {
+        case BUFFER_TYPE_BOOL_INPUT:
+        case BUFFER_TYPE_BOOL_OUTPUT:
+        case BUFFER_TYPE_BOOL_MEMORY:
+            write_bool_to_openplc_journal(args, src, size, type, start_buffer);
+            break;
+
+        case BUFFER_TYPE_INT_INPUT:
+        case BUFFER_TYPE_INT_OUTPUT:
+        case BUFFER_TYPE_INT_MEMORY:
+            write_int_to_openplc_journal(args, src, size, type, start_buffer);
+            break;
+
+        case BUFFER_TYPE_DINT_INPUT:
+        case BUFFER_TYPE_DINT_OUTPUT:
+        case BUFFER_TYPE_DINT_MEMORY:
+            write_dint_to_openplc_journal(args, src, size, type, start_buffer);
+            break;
+
+        case BUFFER_TYPE_LINT_INPUT:
+        case BUFFER_TYPE_LINT_OUTPUT:
+        case BUFFER_TYPE_LINT_MEMORY:
+            write_lint_to_openplc_journal(args, src, size, type, start_buffer);
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,51 @@
+/**
+ * @file s7comm_buffers.h
+ * @brief Conversion between S7 buffers and OpenPLC image tables
+ *
+ * S7 buffers hold big-endian data as seen by S7 clients. Reads copy the
+ * OpenPLC image tables into an S7 buffer, writes go back to OpenPLC through
+ * the journal. Kept apart from the Snap7 server so the routines can be
+ * built and benchmarked without it.
+ */
+
+#ifndef S7COMM_BUFFERS_H
+#define S7COMM_BUFFERS_H
+
+#include <stdint.h>
+
+#include "plugin_types.h"
+#include "s7comm_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Copy OpenPLC buffers of a type into an S7 buffer (mutex must be held)
+ *
+ * @param args          Runtime arguments with the image table pointers
+ * @param dest          S7 buffer
+ * @param size          Size of the S7 buffer in bytes
+ * @param type          OpenPLC buffer type
+ * @param start_buffer  First OpenPLC buffer index
+ */
+void s7comm_read_to_buffer(const plugin_runtime_args_t *args, uint8_t *dest, int size,
+                           s7comm_buffer_type_t type, int start_buffer);
+
+/**
+ * @brief Journal the contents of an S7 buffer to OpenPLC buffers of a type
+ *
+ * @param args          Runtime arguments with the journal functions
+ * @param src           S7 buffer
+ * @param size          Size of the S7 buffer in bytes
+ * @param type          OpenPLC buffer type
+ * @param start_buffer  First OpenPLC buffer index
+ */
+void s7comm_write_from_buffer(const plugin_runtime_args_t *args, const uint8_t *src, int size,
+                              s7comm_buffer_type_t type, int start_buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S7COMM_BUFFERS_H */
@@ -0,0 +1,139 @@
+/**
+ * @file openplc_shm.h
+ * @brief Shared-memory process image layout for local OpenPLC consumers
+ *
+ * The shm_export plugin publishes the PLC process image into a named POSIX
+ * shared-memory object (default "/openplc_image"). This header is all a
+ * co-located application needs to map the region and read consistent
+ * snapshots:
+ *
+ *     int fd = shm_open("/openplc_image", O_RDONLY, 0);
+ *     fstat(fd, &st);
+ *     const void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+ *     const openplc_shm_header_t *hdr = base;
+ *     const openplc_shm_area_t *areas = openplc_shm_areas(base);
+ *
+ *     uint8_t copy[4096];
+ *     uint64_t cycle;
+ *     openplc_shm_read(base, areas[0].offset, copy, areas[0].size, &cycle);
+ *
+ * Consistency is provided by a sequence lock: the writer makes the sequence
+ * odd before updating the data section and even again afterwards, once per
+ * published PLC cycle. Readers retry while the sequence is odd or changed
+ * during their copy.
+ *
+ * Header and descriptors are written once at startup and never change while
+ * the plugin runs. All values are stored in host byte order.
+ */
+
+#ifndef OPENPLC_SHM_H
+#define OPENPLC_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OPENPLC_SHM_MAGIC   0x434C504FU /* "OPLC" little endian */
+#define OPENPLC_SHM_VERSION 1
+
+#define OPENPLC_SHM_AREA_NAME_LEN 16
+
+/* Element types of an exported area */
+#define OPENPLC_SHM_TYPE_BOOL  1 /* 8 bools packed per byte, bit n = %X<i>.<n> */
+#define OPENPLC_SHM_TYPE_BYTE  2
+#define OPENPLC_SHM_TYPE_WORD  3
+#define OPENPLC_SHM_TYPE_DWORD 4
+#define OPENPLC_SHM_TYPE_LWORD 5
+
+/* Writer states */
+#define OPENPLC_SHM_STATE_STOPPED 0
+#define OPENPLC_SHM_STATE_RUNNING 1
+
+/**
+ * @brief Region header, located at offset 0
+ */
+typedef struct
+{
+    uint32_t magic;          /**< OPENPLC_SHM_MAGIC */
+    uint16_t version;        /**< OPENPLC_SHM_VERSION */
+    uint16_t header_size;    /**< sizeof(openplc_shm_header_t) */
+    uint32_t area_count;     /**< Number of area descriptors following the header */
+    uint32_t total_size;     /**< Total size of the region in bytes */
+    uint32_t data_offset;    /**< Offset of the data section */
+    uint32_t data_size;      /**< Size of the data section */
+    uint32_t writer_pid;     /**< PID of the runtime publishing the image */
+    uint32_t state;          /**< OPENPLC_SHM_STATE_* */
+    uint32_t seq;            /**< Sequence lock, odd while the data is being written */
+    uint32_t publish_every;  /**< Publish interval in PLC cycles */
+    uint64_t cycle_counter;  /**< Number of snapshots published */
+    uint64_t timestamp_ns;   /**< CLOCK_REALTIME of the last published snapshot */
+} openplc_shm_header_t;
+
+/**
+ * @brief Descriptor of one exported process image area
+ */
+typedef struct
+{
+    char name[OPENPLC_SHM_AREA_NAME_LEN]; /**< Buffer name, e.g. "int_output" */
+    uint32_t type;                        /**< OPENPLC_SHM_TYPE_* */
+    uint32_t element_size;                /**< Bytes per element */
+    uint32_t start_index;                 /**< First buffer index exported */
+    uint32_t count;                       /**< Number of elements exported */
+    uint32_t offset;                      /**< Offset of the area from the region start */
+    uint32_t size;                        /**< Size of the area in bytes */
+} openplc_shm_area_t;
+
+/**
+ * @brief Get the area descriptor table of a mapped region
+ */
+static inline const openplc_shm_area_t *openplc_shm_areas(const void *base)
+{
+    const openplc_shm_header_t *hdr = (const openplc_shm_header_t *)base;
+    return (const openplc_shm_area_t *)((const uint8_t *)base + hdr->header_size);
+}
+
+/**
+ * @brief Copy a consistent range of the region
+ *
+ * @param base   Start of the mapped region
+ * @param offset Offset of the range to copy (e.g. an area offset)
+ * @param dst    Destination buffer
+ * @param len    Number of bytes to copy
+ * @param cycle  Optional, receives the cycle counter of the snapshot
+ * @return Number of retries needed, or -1 if no consistent copy was obtained
+ */
+static inline int openplc_shm_read(const void *base, size_t offset, void *dst, size_t len,
+                                   uint64_t *cycle)
+{
+    const openplc_shm_header_t *hdr = (const openplc_shm_header_t *)base;
+    for (int attempt = 0; attempt < 1000; attempt++)
+    {
+        uint32_t s1 = __atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1U)
+        {
+            continue;
+        }
+        memcpy(dst, (const uint8_t *)base + offset, len);
+        uint64_t c = hdr->cycle_counter;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&hdr->seq, __ATOMIC_RELAXED) == s1)
+        {
+            if (cycle != NULL)
+            {
+                *cycle = c;
+            }
+            return attempt;
+        }
+    }
+    return -1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENPLC_SHM_H */
@@ -0,0 +1,169 @@
+"""
+Reader for the OpenPLC shared-memory process image.
+
+Python counterpart of openplc_shm.h. Maps the region published by the
+shm_export plugin read-only and returns consistent snapshots using the
+header sequence lock.
+
+Usage:
+    from openplc_shm import SharedImage
+
+    with SharedImage("/openplc_image") as image:
+        cycle, areas = image.snapshot()
+        print(cycle, areas["int_output"][:4], areas["bool_output"][0])
+
+Run directly to print one snapshot:
+    python3 openplc_shm.py [/openplc_image]
+"""
+
+import mmap
+import os
+import struct
+import sys
+from dataclasses import dataclass
+from typing import Dict, List, Tuple
+
+OPENPLC_SHM_MAGIC = 0x434C504F
+OPENPLC_SHM_VERSION = 1
+
+STATE_STOPPED = 0
+STATE_RUNNING = 1
+
+TYPE_BOOL = 1
+TYPE_BYTE = 2
+TYPE_WORD = 3
+TYPE_DWORD = 4
+TYPE_LWORD = 5
+
+# Must match openplc_shm_header_t / openplc_shm_area_t
+_HEADER = struct.Struct("=IHHIIIIIIIIQQ")
+_AREA = struct.Struct("=16sIIIIII")
+_SEQ_OFFSET = struct.calcsize("=IHHIIIIII")  # offsetof(openplc_shm_header_t, seq)
+
+_ELEMENT_FORMAT = {
+    TYPE_BYTE: "B",
+    TYPE_WORD: "H",
+    TYPE_DWORD: "I",
+    TYPE_LWORD: "Q",
+}
+
+
+@dataclass
+class AreaDescriptor:
+    """Descriptor of one exported image area."""
+    name: str
+    type: int
+    element_size: int
+    start_index: int
+    count: int
+    offset: int
+    size: int
+
+
+class SharedImage:
+    """Read-only view of the shared-memory process image."""
+
+    def __init__(self, name: str = "/openplc_image"):
+        path = "/dev/shm/" + name.lstrip("/")
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            size = os.fstat(fd).st_size
+            self._mm = mmap.mmap(fd, size, mmap.MAP_SHARED, mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+        (magic, version, header_size, area_count, total_size, data_offset,
+         data_size, writer_pid, _state, _seq, publish_every, _cycle,
+         _ts) = _HEADER.unpack_from(self._mm, 0)
+
+        if magic != OPENPLC_SHM_MAGIC:
+            self.close()
+            raise ValueError(f"{path} is not an OpenPLC image (magic 0x{magic:08X})")
+        if version != OPENPLC_SHM_VERSION:
+            self.close()
+            raise ValueError(f"Unsupported image version {version}")
+
+        self.data_offset = data_offset
+        self.data_size = data_size
+        self.writer_pid = writer_pid
+        self.publish_every = publish_every
+        self.areas: Dict[str, AreaDescriptor] = {}
+        for i in range(area_count):
+            raw = _AREA.unpack_from(self._mm, header_size + i * _AREA.size)
+            area = AreaDescriptor(raw[0].split(b"\0", 1)[0].decode(), *raw[1:])
+            self.areas[area.name] = area
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def close(self) -> None:
+        if self._mm is not None:
+            self._mm.close()
+            self._mm = None
+
+    @property
+    def running(self) -> bool:
+        """True while the runtime is publishing new snapshots."""
+        return _HEADER.unpack_from(self._mm, 0)[8] == STATE_RUNNING
+
+    def read_raw(self, retries: int = 1000) -> Tuple[int, int, bytes]:
+        """
+        Copy the data section consistently.
+
+        Returns:
+            Tuple of (cycle_counter, timestamp_ns, data bytes)
+
+        Raises:
+            TimeoutError: If no consistent copy was obtained
+        """
+        mm = self._mm
+        for _ in range(retries):
+            seq1 = struct.unpack_from("=I", mm, _SEQ_OFFSET)[0]
+            if seq1 & 1:
+                continue
+            data = mm[self.data_offset:self.data_offset + self.data_size]
+            header = _HEADER.unpack_from(mm, 0)
+            if struct.unpack_from("=I", mm, _SEQ_OFFSET)[0] == seq1:
+                return header[11], header[12], data
+        raise TimeoutError("Could not obtain a consistent snapshot")
+
+    def snapshot(self) -> Tuple[int, Dict[str, List]]:
+        """
+        Read a consistent snapshot of every area.
+
+        BOOL areas decode to lists of 8-element bool lists (one per %X index),
+        all other areas to lists of unsigned integers.
+
+        Returns:
+            Tuple of (cycle_counter, {area name: values})
+        """
+        cycle, _, data = self.read_raw()
+        result: Dict[str, List] = {}
+        for area in self.areas.values():
+            start = area.offset - self.data_offset
+            raw = data[start:start + area.size]
+            if area.type == TYPE_BOOL:
+                result[area.name] = [[bool(b >> bit & 1) for bit in range(8)] for b in raw]
+            else:
+                fmt = "=%d%s" % (area.count, _ELEMENT_FORMAT[area.type])
+                result[area.name] = list(struct.unpack(fmt, raw))
+        return cycle, result
+
+
+def main() -> int:
+    name = sys.argv[1] if len(sys.argv) > 1 else "/openplc_image"
+    with SharedImage(name) as image:
+        cycle, areas = image.snapshot()
+        print(f"cycle={cycle} running={image.running} pid={image.writer_pid}")
+        for area_name, values in areas.items():
+            area = image.areas[area_name]
+            print(f"{area_name}[{area.start_index}..{area.start_index + area.count - 1}]: "
+                  f"{values[:8]}{' ...' if len(values) > 8 else ''}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
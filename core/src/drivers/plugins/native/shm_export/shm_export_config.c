@@ -0,0 +1,195 @@
+/**
+ * @file shm_export_config.c
+ * @brief Shared-Memory Export Plugin Configuration Parser Implementation
+ *
+ * Parses JSON configuration files using cJSON library.
+ */
+
+#include "shm_export_config.h"
+#include "cJSON.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Error codes */
+#define SHM_EXPORT_CONFIG_OK          0
+#define SHM_EXPORT_CONFIG_ERR_FILE    -1
+#define SHM_EXPORT_CONFIG_ERR_PARSE   -2
+#define SHM_EXPORT_CONFIG_ERR_INVALID -4
+
+/* Buffer name mappings */
+static const struct
+{
+    const char *name;
+    shm_export_buffer_t buffer;
+} buffer_map[] = {
+    {"bool_input", SHM_BUFFER_BOOL_INPUT},   {"bool_output", SHM_BUFFER_BOOL_OUTPUT},
+    {"bool_memory", SHM_BUFFER_BOOL_MEMORY}, {"byte_input", SHM_BUFFER_BYTE_INPUT},
+    {"byte_output", SHM_BUFFER_BYTE_OUTPUT}, {"int_input", SHM_BUFFER_INT_INPUT},
+    {"int_output", SHM_BUFFER_INT_OUTPUT},   {"int_memory", SHM_BUFFER_INT_MEMORY},
+    {"dint_input", SHM_BUFFER_DINT_INPUT},   {"dint_output", SHM_BUFFER_DINT_OUTPUT},
+    {"dint_memory", SHM_BUFFER_DINT_MEMORY}, {"lint_input", SHM_BUFFER_LINT_INPUT},
+    {"lint_output", SHM_BUFFER_LINT_OUTPUT}, {"lint_memory", SHM_BUFFER_LINT_MEMORY},
+    {NULL, SHM_BUFFER_NONE}};
+
+/**
+ * @brief Read entire file into a string
+ */
+static char *read_file(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (size <= 0 || size > 1024 * 1024)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    char *buffer = (char *)malloc(size + 1);
+    if (buffer == NULL)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    size_t read_size = fread(buffer, 1, size, fp);
+    fclose(fp);
+
+    if ((long)read_size != size)
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    buffer[size] = '\0';
+    return buffer;
+}
+
+static shm_export_buffer_t parse_buffer(const char *name)
+{
+    if (name == NULL)
+    {
+        return SHM_BUFFER_NONE;
+    }
+    for (int i = 0; buffer_map[i].name != NULL; i++)
+    {
+        if (strcmp(name, buffer_map[i].name) == 0)
+        {
+            return buffer_map[i].buffer;
+        }
+    }
+    return SHM_BUFFER_NONE;
+}
+
+const char *shm_export_buffer_name(shm_export_buffer_t buffer)
+{
+    for (int i = 0; buffer_map[i].name != NULL; i++)
+    {
+        if (buffer_map[i].buffer == buffer)
+        {
+            return buffer_map[i].name;
+        }
+    }
+    return "none";
+}
+
+void shm_export_config_init_defaults(shm_export_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    memset(config, 0, sizeof(shm_export_config_t));
+    config->enabled       = true;
+    config->publish_every = SHM_EXPORT_DEFAULT_PUBLISH_EVERY;
+    strncpy(config->shm_name, SHM_EXPORT_DEFAULT_NAME, SHM_EXPORT_MAX_NAME_LEN - 1);
+}
+
+int shm_export_config_parse(const char *config_path, shm_export_config_t *config)
+{
+    if (config_path == NULL || config == NULL)
+    {
+        return SHM_EXPORT_CONFIG_ERR_INVALID;
+    }
+
+    shm_export_config_init_defaults(config);
+
+    char *json_str = read_file(config_path);
+    if (json_str == NULL)
+    {
+        return SHM_EXPORT_CONFIG_ERR_FILE;
+    }
+
+    cJSON *root = cJSON_Parse(json_str);
+    free(json_str);
+    if (root == NULL)
+    {
+        return SHM_EXPORT_CONFIG_ERR_PARSE;
+    }
+
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, "enabled");
+    if (cJSON_IsBool(item))
+    {
+        config->enabled = cJSON_IsTrue(item);
+    }
+
+    item = cJSON_GetObjectItemCaseSensitive(root, "shm_name");
+    if (cJSON_IsString(item) && item->valuestring != NULL)
+    {
+        strncpy(config->shm_name, item->valuestring, SHM_EXPORT_MAX_NAME_LEN - 1);
+        config->shm_name[SHM_EXPORT_MAX_NAME_LEN - 1] = '\0';
+    }
+
+    item = cJSON_GetObjectItemCaseSensitive(root, "publish_every_n_cycles");
+    if (cJSON_IsNumber(item))
+    {
+        config->publish_every = item->valueint;
+    }
+
+    int result         = SHM_EXPORT_CONFIG_OK;
+    const cJSON *areas = cJSON_GetObjectItemCaseSensitive(root, "areas");
+    const cJSON *area  = NULL;
+    cJSON_ArrayForEach(area, areas)
+    {
+        if (config->num_areas >= SHM_EXPORT_MAX_AREAS)
+        {
+            break;
+        }
+
+        shm_export_area_config_t *a = &config->areas[config->num_areas];
+        const cJSON *field          = cJSON_GetObjectItemCaseSensitive(area, "buffer");
+        a->buffer = parse_buffer(cJSON_IsString(field) ? field->valuestring : NULL);
+        field     = cJSON_GetObjectItemCaseSensitive(area, "start");
+        a->start  = cJSON_IsNumber(field) ? field->valueint : 0;
+        field     = cJSON_GetObjectItemCaseSensitive(area, "count");
+        a->count  = cJSON_IsNumber(field) ? field->valueint : 0;
+
+        if (a->buffer == SHM_BUFFER_NONE || a->start < 0 || a->count < 0)
+        {
+            result = SHM_EXPORT_CONFIG_ERR_INVALID;
+            break;
+        }
+        config->num_areas++;
+    }
+
+    cJSON_Delete(root);
+
+    if (result == SHM_EXPORT_CONFIG_OK &&
+        (config->publish_every < 1 || config->shm_name[0] != '/' ||
+         strchr(config->shm_name + 1, '/') != NULL))
+    {
+        result = SHM_EXPORT_CONFIG_ERR_INVALID;
+    }
+
+    return result;
+}
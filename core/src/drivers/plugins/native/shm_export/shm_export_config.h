@@ -0,0 +1,96 @@
+/**
+ * @file shm_export_config.h
+ * @brief Shared-Memory Export Plugin Configuration Structures and Parser
+ */
+
+#ifndef SHM_EXPORT_CONFIG_H
+#define SHM_EXPORT_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Configuration limits */
+#define SHM_EXPORT_MAX_AREAS    32
+#define SHM_EXPORT_MAX_NAME_LEN 64
+
+/* Default values */
+#define SHM_EXPORT_DEFAULT_NAME          "/openplc_image"
+#define SHM_EXPORT_DEFAULT_PUBLISH_EVERY 1
+
+/**
+ * @brief OpenPLC image buffers that can be exported
+ */
+typedef enum
+{
+    SHM_BUFFER_NONE = 0,
+    SHM_BUFFER_BOOL_INPUT,
+    SHM_BUFFER_BOOL_OUTPUT,
+    SHM_BUFFER_BOOL_MEMORY,
+    SHM_BUFFER_BYTE_INPUT,
+    SHM_BUFFER_BYTE_OUTPUT,
+    SHM_BUFFER_INT_INPUT,
+    SHM_BUFFER_INT_OUTPUT,
+    SHM_BUFFER_INT_MEMORY,
+    SHM_BUFFER_DINT_INPUT,
+    SHM_BUFFER_DINT_OUTPUT,
+    SHM_BUFFER_DINT_MEMORY,
+    SHM_BUFFER_LINT_INPUT,
+    SHM_BUFFER_LINT_OUTPUT,
+    SHM_BUFFER_LINT_MEMORY
+} shm_export_buffer_t;
+
+/**
+ * @brief One exported range of an image buffer
+ */
+typedef struct
+{
+    shm_export_buffer_t buffer; /* Source buffer */
+    int start;                  /* First buffer index */
+    int count;                  /* Number of indices (0 = up to the end of the buffer) */
+} shm_export_area_config_t;
+
+/**
+ * @brief Complete shared-memory export configuration
+ */
+typedef struct
+{
+    bool enabled;                              /* Enable/disable the export */
+    char shm_name[SHM_EXPORT_MAX_NAME_LEN];    /* POSIX shared-memory object name */
+    int publish_every;                         /* Publish every N PLC cycles */
+    int num_areas;                             /* 0 = export every buffer */
+    shm_export_area_config_t areas[SHM_EXPORT_MAX_AREAS];
+} shm_export_config_t;
+
+/**
+ * @brief Parse configuration from JSON file
+ *
+ * @param config_path Path to the JSON configuration file
+ * @param config Pointer to configuration structure to populate
+ * @return 0 on success, negative error code on failure
+ */
+int shm_export_config_parse(const char *config_path, shm_export_config_t *config);
+
+/**
+ * @brief Initialize configuration with default values
+ *
+ * @param config Pointer to configuration structure to initialize
+ */
+void shm_export_config_init_defaults(shm_export_config_t *config);
+
+/**
+ * @brief Get the configuration name of a buffer
+ *
+ * @param buffer Buffer enumeration value
+ * @return Name as used in the configuration file, e.g. "int_output"
+ */
+const char *shm_export_buffer_name(shm_export_buffer_t buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHM_EXPORT_CONFIG_H */
@@ -0,0 +1,498 @@
+/**
+ * @file shm_export_plugin.c
+ * @brief Shared-Memory Process Image Export Plugin Implementation
+ *
+ * Region layout (see openplc_shm.h):
+ *
+ *     +--------------------------+  offset 0
+ *     | openplc_shm_header_t     |
+ *     +--------------------------+  header_size
+ *     | openplc_shm_area_t [n]   |
+ *     +--------------------------+  data_offset (8-byte aligned)
+ *     | area 0 data              |
+ *     | area 1 data (8-aligned)  |
+ *     | ...                      |
+ *     +--------------------------+  total_size
+ *
+ * Publishing happens in cycle_end(), where the runtime already holds the
+ * buffer mutex, so the copy sees a coherent image without additional locking.
+ * The copy is bracketed by the header sequence lock so readers in other
+ * processes can detect and retry torn reads without ever blocking the scan.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "openplc_shm.h"
+#include "plugin_logger.h"
+#include "plugin_types.h"
+#include "shm_export_config.h"
+#include "shm_export_plugin.h"
+
+#define AREA_ALIGN 8
+
+/**
+ * @brief Runtime state of one exported area
+ */
+typedef struct
+{
+    shm_export_buffer_t buffer;
+    int start;
+    int count;
+    uint8_t *dst; /* Location of the area data inside the region */
+} shm_export_area_runtime_t;
+
+/* Plugin state */
+static plugin_logger_t g_logger;
+static plugin_runtime_args_t g_runtime_args;
+static shm_export_config_t g_config;
+static bool g_initialized = false;
+static bool g_running     = false;
+
+/* Shared-memory region */
+static openplc_shm_header_t *g_region = NULL;
+static size_t g_region_size           = 0;
+
+static shm_export_area_runtime_t g_areas[SHM_EXPORT_MAX_AREAS];
+static int g_num_areas            = 0;
+static int g_cycles_since_publish = 0;
+
+/*
+ * =============================================================================
+ * Buffer Helpers
+ * =============================================================================
+ */
+
+static uint32_t buffer_shm_type(shm_export_buffer_t buffer)
+{
+    switch (buffer)
+    {
+    case SHM_BUFFER_BOOL_INPUT:
+    case SHM_BUFFER_BOOL_OUTPUT:
+    case SHM_BUFFER_BOOL_MEMORY:
+        return OPENPLC_SHM_TYPE_BOOL;
+    case SHM_BUFFER_BYTE_INPUT:
+    case SHM_BUFFER_BYTE_OUTPUT:
+        return OPENPLC_SHM_TYPE_BYTE;
+    case SHM_BUFFER_INT_INPUT:
+    case SHM_BUFFER_INT_OUTPUT:
+    case SHM_BUFFER_INT_MEMORY:
+        return OPENPLC_SHM_TYPE_WORD;
+    case SHM_BUFFER_DINT_INPUT:
+    case SHM_BUFFER_DINT_OUTPUT:
+    case SHM_BUFFER_DINT_MEMORY:
+        return OPENPLC_SHM_TYPE_DWORD;
+    case SHM_BUFFER_LINT_INPUT:
+    case SHM_BUFFER_LINT_OUTPUT:
+    case SHM_BUFFER_LINT_MEMORY:
+        return OPENPLC_SHM_TYPE_LWORD;
+    default:
+        return 0;
+    }
+}
+
+static uint32_t shm_type_size(uint32_t type)
+{
+    switch (type)
+    {
+    case OPENPLC_SHM_TYPE_BOOL:
+    case OPENPLC_SHM_TYPE_BYTE:
+        return 1;
+    case OPENPLC_SHM_TYPE_WORD:
+        return 2;
+    case OPENPLC_SHM_TYPE_DWORD:
+        return 4;
+    case OPENPLC_SHM_TYPE_LWORD:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static IEC_BOOL *(*bool_table(shm_export_buffer_t buffer))[8]
+{
+    switch (buffer)
+    {
+    case SHM_BUFFER_BOOL_INPUT:
+        return g_runtime_args.bool_input;
+    case SHM_BUFFER_BOOL_OUTPUT:
+        return g_runtime_args.bool_output;
+    case SHM_BUFFER_BOOL_MEMORY:
+        return g_runtime_args.bool_memory;
+    default:
+        return NULL;
+    }
+}
+
+static void *word_table(shm_export_buffer_t buffer)
+{
+    switch (buffer)
+    {
+    case SHM_BUFFER_BYTE_INPUT:
+        return g_runtime_args.byte_input;
+    case SHM_BUFFER_BYTE_OUTPUT:
+        return g_runtime_args.byte_output;
+    case SHM_BUFFER_INT_INPUT:
+        return g_runtime_args.int_input;
+    case SHM_BUFFER_INT_OUTPUT:
+        return g_runtime_args.int_output;
+    case SHM_BUFFER_INT_MEMORY:
+        return g_runtime_args.int_memory;
+    case SHM_BUFFER_DINT_INPUT:
+        return g_runtime_args.dint_input;
+    case SHM_BUFFER_DINT_OUTPUT:
+        return g_runtime_args.dint_output;
+    case SHM_BUFFER_DINT_MEMORY:
+        return g_runtime_args.dint_memory;
+    case SHM_BUFFER_LINT_INPUT:
+        return g_runtime_args.lint_input;
+    case SHM_BUFFER_LINT_OUTPUT:
+        return g_runtime_args.lint_output;
+    case SHM_BUFFER_LINT_MEMORY:
+        return g_runtime_args.lint_memory;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * @brief Copy one area from the image tables into the region
+ */
+static void copy_area(const shm_export_area_runtime_t *area)
+{
+    uint32_t type = buffer_shm_type(area->buffer);
+
+    if (type == OPENPLC_SHM_TYPE_BOOL)
+    {
+        IEC_BOOL *(*table)[8] = bool_table(area->buffer);
+        for (int i = 0; i < area->count; i++)
+        {
+            uint8_t packed = 0;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                IEC_BOOL *ptr = table[area->start + i][bit];
+                if (ptr != NULL && *ptr)
+                {
+                    packed |= (uint8_t)(1U << bit);
+                }
+            }
+            area->dst[i] = packed;
+        }
+        return;
+    }
+
+    /* Word tables are arrays of pointers to 1, 2, 4 or 8 byte values */
+    uint32_t size = shm_type_size(type);
+    void **table  = (void **)word_table(area->buffer);
+    uint8_t *dst  = area->dst;
+    for (int i = 0; i < area->count; i++, dst += size)
+    {
+        const void *ptr = table[area->start + i];
+        if (ptr != NULL)
+        {
+            memcpy(dst, ptr, size);
+        }
+        else
+        {
+            memset(dst, 0, size);
+        }
+    }
+}
+
+/*
+ * =============================================================================
+ * Region Management
+ * =============================================================================
+ */
+
+/**
+ * @brief Resolve configured areas into runtime areas (no region pointers yet)
+ */
+static int resolve_areas(void)
+{
+    int buffer_size = g_runtime_args.buffer_size;
+    g_num_areas     = 0;
+
+    if (g_config.num_areas == 0)
+    {
+        /* Export every image buffer in full */
+        for (int b = SHM_BUFFER_BOOL_INPUT; b <= SHM_BUFFER_LINT_MEMORY; b++)
+        {
+            g_areas[g_num_areas].buffer = (shm_export_buffer_t)b;
+            g_areas[g_num_areas].start  = 0;
+            g_areas[g_num_areas].count  = buffer_size;
+            g_num_areas++;
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < g_config.num_areas; i++)
+    {
+        const shm_export_area_config_t *cfg = &g_config.areas[i];
+        int count = cfg->count > 0 ? cfg->count : buffer_size - cfg->start;
+
+        if (cfg->start >= buffer_size || count <= 0 || cfg->start + count > buffer_size)
+        {
+            plugin_logger_error(&g_logger, "Area %s[%d..%d] exceeds buffer size %d",
+                                shm_export_buffer_name(cfg->buffer), cfg->start,
+                                cfg->start + count - 1, buffer_size);
+            return -1;
+        }
+
+        g_areas[g_num_areas].buffer = cfg->buffer;
+        g_areas[g_num_areas].start  = cfg->start;
+        g_areas[g_num_areas].count  = count;
+        g_num_areas++;
+    }
+    return 0;
+}
+
+static size_t align_up(size_t value)
+{
+    return (value + AREA_ALIGN - 1) & ~(size_t)(AREA_ALIGN - 1);
+}
+
+/**
+ * @brief Create the shared-memory object and write the header and descriptors
+ */
+static int create_region(void)
+{
+    size_t descriptors_end = sizeof(openplc_shm_header_t) + g_num_areas * sizeof(openplc_shm_area_t);
+    size_t data_offset     = align_up(descriptors_end);
+    size_t offset          = data_offset;
+
+    for (int i = 0; i < g_num_areas; i++)
+    {
+        uint32_t size = shm_type_size(buffer_shm_type(g_areas[i].buffer)) * g_areas[i].count;
+        offset        = align_up(offset + size);
+    }
+    /* stop_loop() keeps the region of the previous start mapped for readers */
+    if (g_region != NULL)
+    {
+        munmap(g_region, g_region_size);
+        g_region = NULL;
+    }
+    g_region_size = offset;
+
+    /* Start from a fresh object so readers still mapping an old layout keep it */
+    shm_unlink(g_config.shm_name);
+    int fd = shm_open(g_config.shm_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        plugin_logger_error(&g_logger, "shm_open(%s) failed: %s", g_config.shm_name,
+                            strerror(errno));
+        return -1;
+    }
+
+    if (ftruncate(fd, (off_t)g_region_size) != 0)
+    {
+        plugin_logger_error(&g_logger, "ftruncate(%zu) failed: %s", g_region_size,
+                            strerror(errno));
+        close(fd);
+        shm_unlink(g_config.shm_name);
+        return -1;
+    }
+
+    void *base = mmap(NULL, g_region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        plugin_logger_error(&g_logger, "mmap failed: %s", strerror(errno));
+        shm_unlink(g_config.shm_name);
+        return -1;
+    }
+
+    /* Touch every page now so publishing never page-faults in the scan cycle */
+    memset(base, 0, g_region_size);
+    g_region = (openplc_shm_header_t *)base;
+
+    openplc_shm_area_t *desc = (openplc_shm_area_t *)((uint8_t *)base + sizeof(openplc_shm_header_t));
+    offset                   = data_offset;
+    for (int i = 0; i < g_num_areas; i++)
+    {
+        uint32_t type = buffer_shm_type(g_areas[i].buffer);
+        uint32_t size = shm_type_size(type) * g_areas[i].count;
+
+        strncpy(desc[i].name, shm_export_buffer_name(g_areas[i].buffer),
+                OPENPLC_SHM_AREA_NAME_LEN - 1);
+        desc[i].type         = type;
+        desc[i].element_size = shm_type_size(type);
+        desc[i].start_index  = (uint32_t)g_areas[i].start;
+        desc[i].count        = (uint32_t)g_areas[i].count;
+        desc[i].offset       = (uint32_t)offset;
+        desc[i].size         = size;
+
+        g_areas[i].dst = (uint8_t *)base + offset;
+        offset         = align_up(offset + size);
+    }
+
+    g_region->header_size   = sizeof(openplc_shm_header_t);
+    g_region->version       = OPENPLC_SHM_VERSION;
+    g_region->area_count    = (uint32_t)g_num_areas;
+    g_region->total_size    = (uint32_t)g_region_size;
+    g_region->data_offset   = (uint32_t)data_offset;
+    g_region->data_size     = (uint32_t)(g_region_size - data_offset);
+    g_region->writer_pid    = (uint32_t)getpid();
+    g_region->publish_every = (uint32_t)g_config.publish_every;
+    g_region->state         = OPENPLC_SHM_STATE_STOPPED;
+
+    /* Publish the magic last so readers never accept a half-written header */
+    __atomic_store_n(&g_region->magic, OPENPLC_SHM_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void destroy_region(void)
+{
+    if (g_region != NULL)
+    {
+        munmap(g_region, g_region_size);
+        g_region = NULL;
+        shm_unlink(g_config.shm_name);
+    }
+    g_region_size = 0;
+}
+
+/*
+ * =============================================================================
+ * Plugin Lifecycle Functions
+ * =============================================================================
+ */
+
+int init(void *args)
+{
+    if (!args)
+    {
+        plugin_logger_init(&g_logger, "SHM_EXPORT", NULL);
+        plugin_logger_error(&g_logger, "init args is NULL");
+        return -1;
+    }
+
+    /* Copy runtime args (pointer is freed after init returns) */
+    memcpy(&g_runtime_args, args, sizeof(plugin_runtime_args_t));
+
+    plugin_logger_init(&g_logger, "SHM_EXPORT", args);
+    plugin_logger_info(&g_logger, "Initializing shared-memory export plugin...");
+
+    g_initialized = true;
+    return 0;
+}
+
+int start_loop(void)
+{
+    if (!g_initialized)
+    {
+        plugin_logger_error(&g_logger, "Cannot start - plugin not initialized");
+        return -1;
+    }
+
+    if (g_running)
+    {
+        plugin_logger_warn(&g_logger, "Export already running");
+        return 0;
+    }
+
+    const char *config_path = g_runtime_args.plugin_specific_config_file_path;
+    if (config_path == NULL || config_path[0] == '\0')
+    {
+        plugin_logger_warn(&g_logger, "No config file specified, using defaults");
+        shm_export_config_init_defaults(&g_config);
+    }
+    else
+    {
+        int result = shm_export_config_parse(config_path, &g_config);
+        if (result != 0)
+        {
+            plugin_logger_error(&g_logger, "Failed to parse config file %s (error %d)",
+                                config_path, result);
+            plugin_logger_warn(&g_logger, "Using default configuration");
+            shm_export_config_init_defaults(&g_config);
+        }
+    }
+
+    if (!g_config.enabled)
+    {
+        plugin_logger_info(&g_logger, "Shared-memory export is disabled in configuration");
+        return 0;
+    }
+
+    if (resolve_areas() != 0 || create_region() != 0)
+    {
+        destroy_region();
+        return -1;
+    }
+
+    g_cycles_since_publish = 0;
+    __atomic_store_n(&g_region->state, OPENPLC_SHM_STATE_RUNNING, __ATOMIC_RELEASE);
+    g_running = true;
+
+    plugin_logger_info(&g_logger, "Publishing %d areas (%zu bytes) to %s every %d cycle(s)",
+                       g_num_areas, g_region_size, g_config.shm_name, g_config.publish_every);
+    return 0;
+}
+
+void stop_loop(void)
+{
+    if (!g_running)
+    {
+        return;
+    }
+
+    g_running = false;
+    if (g_region != NULL)
+    {
+        __atomic_store_n(&g_region->state, OPENPLC_SHM_STATE_STOPPED, __ATOMIC_RELEASE);
+    }
+    plugin_logger_info(&g_logger, "Shared-memory export stopped");
+}
+
+void cleanup(void)
+{
+    stop_loop();
+    destroy_region();
+    g_initialized = false;
+    plugin_logger_info(&g_logger, "Shared-memory export cleanup complete");
+}
+
+void cycle_start(void)
+{
+    /* Image is published at cycle end */
+}
+
+void cycle_end(void)
+{
+    if (!g_running)
+    {
+        return;
+    }
+
+    if (++g_cycles_since_publish < g_config.publish_every)
+    {
+        return;
+    }
+    g_cycles_since_publish = 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    /* Sequence lock: odd while the data section is inconsistent */
+    uint32_t seq = g_region->seq;
+    __atomic_store_n(&g_region->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (int i = 0; i < g_num_areas; i++)
+    {
+        copy_area(&g_areas[i]);
+    }
+    g_region->cycle_counter++;
+    g_region->timestamp_ns = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+
+    __atomic_store_n(&g_region->seq, seq + 2, __ATOMIC_RELEASE);
+}
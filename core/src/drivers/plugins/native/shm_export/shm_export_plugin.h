@@ -0,0 +1,71 @@
+/**
+ * @file shm_export_plugin.h
+ * @brief Shared-Memory Process Image Export Plugin for OpenPLC Runtime v4
+ *
+ * This plugin publishes the PLC process image into a named POSIX shared-memory
+ * object once per scan cycle (or every N cycles), so HMIs, historians and
+ * analytics running on the same machine can read consistent snapshots at
+ * memory speed instead of going through Modbus, S7 or OPC UA over loopback.
+ *
+ * The region layout is described in openplc_shm.h, which is the only header
+ * a consumer needs.
+ */
+
+#ifndef SHM_EXPORT_PLUGIN_H
+#define SHM_EXPORT_PLUGIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the shared-memory export plugin
+ *
+ * @param args Pointer to plugin_runtime_args_t containing runtime buffers,
+ *             mutex functions, and logging function pointers
+ * @return 0 on success, -1 on failure
+ */
+int init(void *args);
+
+/**
+ * @brief Create the shared-memory region and start publishing
+ *
+ * Parses the configuration, creates and sizes the shared-memory object and
+ * writes the header and area descriptors.
+ */
+int start_loop(void);
+
+/**
+ * @brief Stop publishing
+ *
+ * Marks the region as stopped so readers can detect a stale image.
+ */
+void stop_loop(void);
+
+/**
+ * @brief Cleanup plugin resources
+ *
+ * Unmaps and unlinks the shared-memory object.
+ */
+void cleanup(void);
+
+/**
+ * @brief Called at the start of each PLC scan cycle
+ *
+ * Nothing to do; the image is published at cycle end.
+ */
+void cycle_start(void);
+
+/**
+ * @brief Called at the end of each PLC scan cycle
+ *
+ * Copies the configured areas into the region under the sequence lock.
+ * Called with buffer mutex already held.
+ */
+void cycle_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHM_EXPORT_PLUGIN_H */
@@ -0,0 +1,388 @@
+/**
+ * @file udp_pubsub_config.c
+ * @brief UDP Pub/Sub Plugin Configuration Parser Implementation
+ *
+ * Parses JSON configuration files using cJSON library.
+ */
+
+#include "udp_pubsub_config.h"
+#include "cJSON.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Error codes */
+#define UDP_PUBSUB_CONFIG_OK          0
+#define UDP_PUBSUB_CONFIG_ERR_FILE    -1
+#define UDP_PUBSUB_CONFIG_ERR_PARSE   -2
+#define UDP_PUBSUB_CONFIG_ERR_INVALID -4
+
+/* Buffer name mappings */
+static const struct
+{
+    const char *name;
+    udp_pubsub_buffer_t buffer;
+} buffer_map[] = {{"bool_input", UDP_BUFFER_BOOL_INPUT},   {"bool_output", UDP_BUFFER_BOOL_OUTPUT},
+                  {"bool_memory", UDP_BUFFER_BOOL_MEMORY}, {"byte_input", UDP_BUFFER_BYTE_INPUT},
+                  {"byte_output", UDP_BUFFER_BYTE_OUTPUT}, {"int_input", UDP_BUFFER_INT_INPUT},
+                  {"int_output", UDP_BUFFER_INT_OUTPUT},   {"int_memory", UDP_BUFFER_INT_MEMORY},
+                  {"dint_input", UDP_BUFFER_DINT_INPUT},   {"dint_output", UDP_BUFFER_DINT_OUTPUT},
+                  {"dint_memory", UDP_BUFFER_DINT_MEMORY}, {"lint_input", UDP_BUFFER_LINT_INPUT},
+                  {"lint_output", UDP_BUFFER_LINT_OUTPUT}, {"lint_memory", UDP_BUFFER_LINT_MEMORY},
+                  {NULL, UDP_BUFFER_NONE}};
+
+/**
+ * @brief Read entire file into a string
+ */
+static char *read_file(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (size <= 0 || size > 1024 * 1024)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    char *buffer = (char *)malloc(size + 1);
+    if (buffer == NULL)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    size_t read_size = fread(buffer, 1, size, fp);
+    fclose(fp);
+
+    if ((long)read_size != size)
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    buffer[size] = '\0';
+    return buffer;
+}
+
+udp_area_type_t udp_pubsub_buffer_area_type(udp_pubsub_buffer_t buffer)
+{
+    switch (buffer)
+    {
+    case UDP_BUFFER_BOOL_INPUT:
+    case UDP_BUFFER_BOOL_OUTPUT:
+    case UDP_BUFFER_BOOL_MEMORY:
+        return UDP_AREA_BOOL;
+    case UDP_BUFFER_BYTE_INPUT:
+    case UDP_BUFFER_BYTE_OUTPUT:
+        return UDP_AREA_BYTE;
+    case UDP_BUFFER_INT_INPUT:
+    case UDP_BUFFER_INT_OUTPUT:
+    case UDP_BUFFER_INT_MEMORY:
+        return UDP_AREA_WORD;
+    case UDP_BUFFER_DINT_INPUT:
+    case UDP_BUFFER_DINT_OUTPUT:
+    case UDP_BUFFER_DINT_MEMORY:
+        return UDP_AREA_DWORD;
+    case UDP_BUFFER_LINT_INPUT:
+    case UDP_BUFFER_LINT_OUTPUT:
+    case UDP_BUFFER_LINT_MEMORY:
+        return UDP_AREA_LWORD;
+    default:
+        return (udp_area_type_t)0;
+    }
+}
+
+int udp_pubsub_area_entries(const udp_pubsub_area_config_t *area)
+{
+    return udp_pubsub_buffer_area_type(area->buffer) == UDP_AREA_BOOL ? area->count * 8
+                                                                      : area->count;
+}
+
+static udp_pubsub_buffer_t parse_buffer(const cJSON *item)
+{
+    if (!cJSON_IsString(item) || item->valuestring == NULL)
+    {
+        return UDP_BUFFER_NONE;
+    }
+    for (int i = 0; buffer_map[i].name != NULL; i++)
+    {
+        if (strcmp(item->valuestring, buffer_map[i].name) == 0)
+        {
+            return buffer_map[i].buffer;
+        }
+    }
+    return UDP_BUFFER_NONE;
+}
+
+static int read_int(const cJSON *object, const char *key, int default_value)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, key);
+    return cJSON_IsNumber(item) ? item->valueint : default_value;
+}
+
+static int read_address(const cJSON *object, char *address)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, "address");
+    if (!cJSON_IsString(item) || item->valuestring == NULL || item->valuestring[0] == '\0')
+    {
+        return UDP_PUBSUB_CONFIG_ERR_INVALID;
+    }
+    strncpy(address, item->valuestring, UDP_PUBSUB_MAX_ADDRESS_LEN - 1);
+    address[UDP_PUBSUB_MAX_ADDRESS_LEN - 1] = '\0';
+    return UDP_PUBSUB_CONFIG_OK;
+}
+
+static int read_port(const cJSON *object, uint16_t *port)
+{
+    int value = read_int(object, "port", 0);
+    if (value < 1 || value > 65535)
+    {
+        return UDP_PUBSUB_CONFIG_ERR_INVALID;
+    }
+    *port = (uint16_t)value;
+    return UDP_PUBSUB_CONFIG_OK;
+}
+
+/**
+ * @brief Parse an "areas" array
+ */
+static int parse_areas(const cJSON *object, udp_pubsub_area_config_t *areas, int *num_areas)
+{
+    const cJSON *list  = cJSON_GetObjectItemCaseSensitive(object, "areas");
+    const cJSON *entry = NULL;
+    *num_areas         = 0;
+
+    cJSON_ArrayForEach(entry, list)
+    {
+        if (*num_areas >= UDP_PUBSUB_MAX_AREAS)
+        {
+            return UDP_PUBSUB_CONFIG_ERR_INVALID;
+        }
+
+        udp_pubsub_area_config_t *area = &areas[*num_areas];
+        area->buffer = parse_buffer(cJSON_GetObjectItemCaseSensitive(entry, "buffer"));
+        area->start  = read_int(entry, "start", 0);
+        area->count  = read_int(entry, "count", 1);
+        if (area->buffer == UDP_BUFFER_NONE || area->start < 0 || area->count < 1 ||
+            area->start + area->count > 65535)
+        {
+            return UDP_PUBSUB_CONFIG_ERR_INVALID;
+        }
+        (*num_areas)++;
+    }
+
+    return *num_areas > 0 ? UDP_PUBSUB_CONFIG_OK : UDP_PUBSUB_CONFIG_ERR_INVALID;
+}
+
+/**
+ * @brief Parse one entry of the "publications" array
+ */
+static int parse_publication(const cJSON *entry, udp_pubsub_publication_config_t *pub)
+{
+    memset(pub, 0, sizeof(*pub));
+
+    int id              = read_int(entry, "id", -1);
+    pub->every_n_cycles = read_int(entry, "every_n_cycles", UDP_PUBSUB_DEFAULT_EVERY_N_CYCLES);
+    if (id < 0 || id > 65535 || pub->every_n_cycles < 1 ||
+        read_address(entry, pub->address) != UDP_PUBSUB_CONFIG_OK ||
+        read_port(entry, &pub->port) != UDP_PUBSUB_CONFIG_OK ||
+        parse_areas(entry, pub->areas, &pub->num_areas) != UDP_PUBSUB_CONFIG_OK)
+    {
+        return UDP_PUBSUB_CONFIG_ERR_INVALID;
+    }
+    pub->id = (uint16_t)id;
+
+    /* The whole frame must fit into one unfragmented datagram */
+    size_t frame_size = UDP_PUBSUB_HEADER_SIZE;
+    for (int i = 0; i < pub->num_areas; i++)
+    {
+        frame_size += udp_area_encoded_size(udp_pubsub_buffer_area_type(pub->areas[i].buffer),
+                                            (uint16_t)pub->areas[i].count);
+    }
+    return frame_size <= UDP_PUBSUB_MAX_FRAME ? UDP_PUBSUB_CONFIG_OK
+                                              : UDP_PUBSUB_CONFIG_ERR_INVALID;
+}
+
+/**
+ * @brief Parse one entry of the "subscriptions" array
+ */
+static int parse_subscription(const cJSON *entry, udp_pubsub_subscription_config_t *sub)
+{
+    memset(sub, 0, sizeof(*sub));
+
+    int id          = read_int(entry, "publication_id", -1);
+    sub->timeout_ms = read_int(entry, "timeout_ms", UDP_PUBSUB_DEFAULT_TIMEOUT_MS);
+    if (id < 0 || id > 65535 || sub->timeout_ms < 1 ||
+        read_address(entry, sub->address) != UDP_PUBSUB_CONFIG_OK ||
+        read_port(entry, &sub->port) != UDP_PUBSUB_CONFIG_OK ||
+        parse_areas(entry, sub->areas, &sub->num_areas) != UDP_PUBSUB_CONFIG_OK)
+    {
+        return UDP_PUBSUB_CONFIG_ERR_INVALID;
+    }
+    sub->publication_id = (uint16_t)id;
+
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(entry, "on_timeout");
+    if (cJSON_IsString(item) && item->valuestring != NULL)
+    {
+        if (strcmp(item->valuestring, "zero") == 0)
+        {
+            sub->on_timeout = UDP_ON_TIMEOUT_ZERO;
+        }
+        else if (strcmp(item->valuestring, "hold") != 0)
+        {
+            return UDP_PUBSUB_CONFIG_ERR_INVALID;
+        }
+    }
+
+    item = cJSON_GetObjectItemCaseSensitive(entry, "status");
+    if (cJSON_IsObject(item))
+    {
+        sub->has_status    = true;
+        sub->status_buffer = parse_buffer(cJSON_GetObjectItemCaseSensitive(item, "buffer"));
+        sub->status_index  = read_int(item, "index", 0);
+        sub->status_bit    = read_int(item, "bit", 0);
+        if (udp_pubsub_buffer_area_type(sub->status_buffer) != UDP_AREA_BOOL ||
+            sub->status_index < 0 || sub->status_index > 65535 || sub->status_bit < 0 ||
+            sub->status_bit > 7)
+        {
+            return UDP_PUBSUB_CONFIG_ERR_INVALID;
+        }
+    }
+
+    /* A received frame is applied as one journal batch */
+    int entries = 0;
+    for (int i = 0; i < sub->num_areas; i++)
+    {
+        entries += udp_pubsub_area_entries(&sub->areas[i]);
+    }
+    return entries <= UDP_PUBSUB_MAX_ENTRIES ? UDP_PUBSUB_CONFIG_OK
+                                             : UDP_PUBSUB_CONFIG_ERR_INVALID;
+}
+
+void udp_pubsub_config_init_defaults(udp_pubsub_config_t *config)
+{
+    if (config == NULL)
+    {
+        return;
+    }
+
+    memset(config, 0, sizeof(udp_pubsub_config_t));
+    config->enabled            = true;
+    config->multicast_ttl      = UDP_PUBSUB_DEFAULT_TTL;
+    config->multicast_loopback = true;
+}
+
+int udp_pubsub_config_parse(const char *config_path, udp_pubsub_config_t *config)
+{
+    if (config_path == NULL || config == NULL)
+    {
+        return UDP_PUBSUB_CONFIG_ERR_INVALID;
+    }
+
+    udp_pubsub_config_init_defaults(config);
+
+    char *json_str = read_file(config_path);
+    if (json_str == NULL)
+    {
+        return UDP_PUBSUB_CONFIG_ERR_FILE;
+    }
+
+    cJSON *root = cJSON_Parse(json_str);
+    free(json_str);
+    if (root == NULL)
+    {
+        return UDP_PUBSUB_CONFIG_ERR_PARSE;
+    }
+
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, "enabled");
+    if (cJSON_IsBool(item))
+    {
+        config->enabled = cJSON_IsTrue(item);
+    }
+
+    item = cJSON_GetObjectItemCaseSensitive(root, "multicast_loopback");
+    if (cJSON_IsBool(item))
+    {
+        config->multicast_loopback = cJSON_IsTrue(item);
+    }
+
+    item = cJSON_GetObjectItemCaseSensitive(root, "interface");
+    if (cJSON_IsString(item) && item->valuestring != NULL)
+    {
+        strncpy(config->interface, item->valuestring, UDP_PUBSUB_MAX_ADDRESS_LEN - 1);
+        config->interface[UDP_PUBSUB_MAX_ADDRESS_LEN - 1] = '\0';
+    }
+
+    config->multicast_ttl = read_int(root, "multicast_ttl", config->multicast_ttl);
+
+    int result         = UDP_PUBSUB_CONFIG_OK;
+    const cJSON *list  = cJSON_GetObjectItemCaseSensitive(root, "publications");
+    const cJSON *entry = NULL;
+    cJSON_ArrayForEach(entry, list)
+    {
+        if (config->num_publications >= UDP_PUBSUB_MAX_PUBLICATIONS)
+        {
+            result = UDP_PUBSUB_CONFIG_ERR_INVALID;
+            break;
+        }
+
+        result = parse_publication(entry, &config->publications[config->num_publications]);
+        if (result != UDP_PUBSUB_CONFIG_OK)
+        {
+            break;
+        }
+        config->num_publications++;
+    }
+
+    list = cJSON_GetObjectItemCaseSensitive(root, "subscriptions");
+    cJSON_ArrayForEach(entry, list)
+    {
+        if (result != UDP_PUBSUB_CONFIG_OK)
+        {
+            break;
+        }
+        if (config->num_subscriptions >= UDP_PUBSUB_MAX_SUBSCRIPTIONS)
+        {
+            result = UDP_PUBSUB_CONFIG_ERR_INVALID;
+            break;
+        }
+
+        udp_pubsub_subscription_config_t *sub = &config->subscriptions[config->num_subscriptions];
+        result                                = parse_subscription(entry, sub);
+
+        /* Frames are dispatched by endpoint and publication id, which must be unique */
+        for (int i = 0; result == UDP_PUBSUB_CONFIG_OK && i < config->num_subscriptions; i++)
+        {
+            const udp_pubsub_subscription_config_t *other = &config->subscriptions[i];
+            if (other->publication_id == sub->publication_id && other->port == sub->port &&
+                strcmp(other->address, sub->address) == 0)
+            {
+                result = UDP_PUBSUB_CONFIG_ERR_INVALID;
+            }
+        }
+        if (result != UDP_PUBSUB_CONFIG_OK)
+        {
+            break;
+        }
+        config->num_subscriptions++;
+    }
+
+    cJSON_Delete(root);
+
+    if (result == UDP_PUBSUB_CONFIG_OK &&
+        (config->multicast_ttl < 0 || config->multicast_ttl > 255))
+    {
+        result = UDP_PUBSUB_CONFIG_ERR_INVALID;
+    }
+
+    return result;
+}
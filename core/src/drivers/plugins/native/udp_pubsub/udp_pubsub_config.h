@@ -0,0 +1,146 @@
+/**
+ * @file udp_pubsub_config.h
+ * @brief UDP Pub/Sub Plugin Configuration Structures and Parser
+ */
+
+#ifndef UDP_PUBSUB_CONFIG_H
+#define UDP_PUBSUB_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "udp_pubsub_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Configuration limits */
+#define UDP_PUBSUB_MAX_PUBLICATIONS  16
+#define UDP_PUBSUB_MAX_SUBSCRIPTIONS 16
+#define UDP_PUBSUB_MAX_ADDRESS_LEN   64
+#define UDP_PUBSUB_MAX_ENTRIES       1024 /* Journal entries one frame may expand to */
+
+/* Default values */
+#define UDP_PUBSUB_DEFAULT_EVERY_N_CYCLES 1
+#define UDP_PUBSUB_DEFAULT_TIMEOUT_MS     100
+#define UDP_PUBSUB_DEFAULT_TTL            1
+
+/**
+ * @brief Image table buffers (values match the journal buffer types)
+ */
+typedef enum
+{
+    UDP_BUFFER_BOOL_INPUT = 0,
+    UDP_BUFFER_BOOL_OUTPUT,
+    UDP_BUFFER_BOOL_MEMORY,
+    UDP_BUFFER_BYTE_INPUT,
+    UDP_BUFFER_BYTE_OUTPUT,
+    UDP_BUFFER_INT_INPUT,
+    UDP_BUFFER_INT_OUTPUT,
+    UDP_BUFFER_INT_MEMORY,
+    UDP_BUFFER_DINT_INPUT,
+    UDP_BUFFER_DINT_OUTPUT,
+    UDP_BUFFER_DINT_MEMORY,
+    UDP_BUFFER_LINT_INPUT,
+    UDP_BUFFER_LINT_OUTPUT,
+    UDP_BUFFER_LINT_MEMORY,
+    UDP_BUFFER_NONE
+} udp_pubsub_buffer_t;
+
+/**
+ * @brief Behaviour of a subscription whose publisher went silent
+ */
+typedef enum
+{
+    UDP_ON_TIMEOUT_HOLD = 0, /* Keep the last received values */
+    UDP_ON_TIMEOUT_ZERO      /* Write zeros to every subscribed area */
+} udp_pubsub_on_timeout_t;
+
+/**
+ * @brief Contiguous range of one image table buffer
+ */
+typedef struct
+{
+    udp_pubsub_buffer_t buffer; /* Image table buffer */
+    int start;                  /* First buffer index */
+    int count;                  /* Number of indices (BOOL: 8 bits per index) */
+} udp_pubsub_area_config_t;
+
+/**
+ * @brief One published frame
+ */
+typedef struct
+{
+    uint16_t id;                                  /* Publication id carried in every frame */
+    char address[UDP_PUBSUB_MAX_ADDRESS_LEN];     /* Destination (multicast group or unicast) */
+    uint16_t port;                                /* Destination UDP port */
+    int every_n_cycles;                           /* Publish every N scan cycles */
+    int num_areas;
+    udp_pubsub_area_config_t areas[UDP_PUBSUB_MAX_AREAS];
+} udp_pubsub_publication_config_t;
+
+/**
+ * @brief One subscribed frame
+ */
+typedef struct
+{
+    uint16_t publication_id;                      /* Publication id to accept */
+    char address[UDP_PUBSUB_MAX_ADDRESS_LEN];     /* Group to join, or local address */
+    uint16_t port;                                /* UDP port to listen on */
+    int timeout_ms;                               /* Stale after this long without a frame */
+    udp_pubsub_on_timeout_t on_timeout;           /* What to do when stale */
+    bool has_status;                              /* Write a "fresh" status bit */
+    udp_pubsub_buffer_t status_buffer;            /* BOOL buffer of the status bit */
+    int status_index;
+    int status_bit;
+    int num_areas;                                /* Local destination of each frame area */
+    udp_pubsub_area_config_t areas[UDP_PUBSUB_MAX_AREAS];
+} udp_pubsub_subscription_config_t;
+
+/**
+ * @brief Complete UDP pub/sub configuration
+ */
+typedef struct
+{
+    bool enabled;                                /* Enable/disable the plugin */
+    char interface[UDP_PUBSUB_MAX_ADDRESS_LEN];  /* IPv4 address of the multicast interface */
+    int multicast_ttl;                           /* Hop limit of published frames */
+    bool multicast_loopback;                     /* Deliver own frames to local subscribers */
+    int num_publications;
+    udp_pubsub_publication_config_t publications[UDP_PUBSUB_MAX_PUBLICATIONS];
+    int num_subscriptions;
+    udp_pubsub_subscription_config_t subscriptions[UDP_PUBSUB_MAX_SUBSCRIPTIONS];
+} udp_pubsub_config_t;
+
+/**
+ * @brief Parse configuration from JSON file
+ *
+ * @param config_path Path to the JSON configuration file
+ * @param config Pointer to configuration structure to populate
+ * @return 0 on success, negative error code on failure
+ */
+int udp_pubsub_config_parse(const char *config_path, udp_pubsub_config_t *config);
+
+/**
+ * @brief Initialize configuration with default values
+ *
+ * @param config Pointer to configuration structure to initialize
+ */
+void udp_pubsub_config_init_defaults(udp_pubsub_config_t *config);
+
+/**
+ * @brief Frame area type carrying a buffer
+ */
+udp_area_type_t udp_pubsub_buffer_area_type(udp_pubsub_buffer_t buffer);
+
+/**
+ * @brief Number of journal entries an area expands to
+ */
+int udp_pubsub_area_entries(const udp_pubsub_area_config_t *area);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDP_PUBSUB_CONFIG_H */
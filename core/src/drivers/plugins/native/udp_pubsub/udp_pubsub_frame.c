@@ -0,0 +1,224 @@
+/**
+ * @file udp_pubsub_frame.c
+ * @brief Frame codec and sequence tracking for the UDP pub/sub plugin
+ */
+
+#include "udp_pubsub_frame.h"
+
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, (uint32_t)(v >> 32));
+    put_u32(p + 4, (uint32_t)v);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    return ((uint64_t)get_u32(p) << 32) | get_u32(p + 4);
+}
+
+size_t udp_area_element_size(udp_area_type_t type)
+{
+    switch (type)
+    {
+    case UDP_AREA_BOOL:
+    case UDP_AREA_BYTE:
+        return 1;
+    case UDP_AREA_WORD:
+        return 2;
+    case UDP_AREA_DWORD:
+        return 4;
+    case UDP_AREA_LWORD:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+size_t udp_area_encoded_size(udp_area_type_t type, uint16_t count)
+{
+    return UDP_PUBSUB_AREA_HEADER_SIZE + udp_area_element_size(type) * count;
+}
+
+size_t udp_frame_encode_header(uint8_t *buf, size_t cap, const udp_frame_header_t *header)
+{
+    if (cap < UDP_PUBSUB_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    put_u32(buf, UDP_PUBSUB_MAGIC);
+    buf[4] = UDP_PUBSUB_VERSION;
+    buf[5] = header->area_count;
+    put_u16(buf + 6, header->publication_id);
+    put_u32(buf + 8, header->session);
+    put_u32(buf + 12, header->sequence);
+    put_u64(buf + 16, header->timestamp_ns);
+    return UDP_PUBSUB_HEADER_SIZE;
+}
+
+size_t udp_frame_encode_area(uint8_t *buf, size_t cap, udp_area_type_t type, uint16_t count,
+                             const void *values)
+{
+    size_t size = udp_area_encoded_size(type, count);
+    if (udp_area_element_size(type) == 0 || size > cap)
+    {
+        return 0;
+    }
+
+    buf[0] = (uint8_t)type;
+    buf[1] = 0;
+    put_u16(buf + 2, count);
+
+    uint8_t *dst = buf + UDP_PUBSUB_AREA_HEADER_SIZE;
+    switch (type)
+    {
+    case UDP_AREA_BOOL:
+    case UDP_AREA_BYTE:
+        memcpy(dst, values, count);
+        break;
+    case UDP_AREA_WORD:
+        for (uint16_t i = 0; i < count; i++)
+        {
+            put_u16(dst + 2 * i, ((const uint16_t *)values)[i]);
+        }
+        break;
+    case UDP_AREA_DWORD:
+        for (uint16_t i = 0; i < count; i++)
+        {
+            put_u32(dst + 4 * i, ((const uint32_t *)values)[i]);
+        }
+        break;
+    case UDP_AREA_LWORD:
+        for (uint16_t i = 0; i < count; i++)
+        {
+            put_u64(dst + 8 * i, ((const uint64_t *)values)[i]);
+        }
+        break;
+    }
+    return size;
+}
+
+int udp_frame_parse(const uint8_t *buf, size_t len, udp_frame_header_t *header,
+                    udp_frame_area_t *areas, int max_areas)
+{
+    if (len < UDP_PUBSUB_HEADER_SIZE || get_u32(buf) != UDP_PUBSUB_MAGIC ||
+        buf[4] != UDP_PUBSUB_VERSION)
+    {
+        return -1;
+    }
+
+    header->area_count     = buf[5];
+    header->publication_id = get_u16(buf + 6);
+    header->session        = get_u32(buf + 8);
+    header->sequence       = get_u32(buf + 12);
+    header->timestamp_ns   = get_u64(buf + 16);
+
+    if (header->area_count > max_areas)
+    {
+        return -1;
+    }
+
+    size_t pos = UDP_PUBSUB_HEADER_SIZE;
+    for (int i = 0; i < header->area_count; i++)
+    {
+        if (pos + UDP_PUBSUB_AREA_HEADER_SIZE > len)
+        {
+            return -1;
+        }
+
+        udp_area_type_t type = (udp_area_type_t)buf[pos];
+        uint16_t count       = get_u16(buf + pos + 2);
+        size_t size          = udp_area_encoded_size(type, count);
+        if (udp_area_element_size(type) == 0 || pos + size > len)
+        {
+            return -1;
+        }
+
+        areas[i].type  = type;
+        areas[i].count = count;
+        areas[i].data  = buf + pos + UDP_PUBSUB_AREA_HEADER_SIZE;
+        pos += size;
+    }
+
+    return pos == len ? 0 : -1;
+}
+
+void udp_frame_area_to_native(const udp_frame_area_t *area, void *out)
+{
+    const uint8_t *src = area->data;
+    switch (area->type)
+    {
+    case UDP_AREA_BOOL:
+    case UDP_AREA_BYTE:
+        memcpy(out, src, area->count);
+        break;
+    case UDP_AREA_WORD:
+        for (uint16_t i = 0; i < area->count; i++)
+        {
+            ((uint16_t *)out)[i] = get_u16(src + 2 * i);
+        }
+        break;
+    case UDP_AREA_DWORD:
+        for (uint16_t i = 0; i < area->count; i++)
+        {
+            ((uint32_t *)out)[i] = get_u32(src + 4 * i);
+        }
+        break;
+    case UDP_AREA_LWORD:
+        for (uint16_t i = 0; i < area->count; i++)
+        {
+            ((uint64_t *)out)[i] = get_u64(src + 8 * i);
+        }
+        break;
+    }
+}
+
+udp_seq_result_t udp_seq_update(udp_seq_state_t *state, uint32_t session, uint32_t sequence,
+                                uint32_t *lost)
+{
+    *lost = 0;
+
+    if (!state->valid || state->session != session)
+    {
+        state->valid         = 1;
+        state->session       = session;
+        state->last_sequence = sequence;
+        return UDP_SEQ_FIRST;
+    }
+
+    int32_t distance = (int32_t)(sequence - state->last_sequence);
+    if (distance <= 0)
+    {
+        return UDP_SEQ_OLD;
+    }
+
+    *lost                = (uint32_t)distance - 1;
+    state->last_sequence = sequence;
+    return UDP_SEQ_NEXT;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file udp_pubsub_frame.h
+ * @brief Frame codec and sequence tracking for the UDP pub/sub plugin
+ *
+ * Frame layout (all fields in network byte order):
+ *
+ *     offset  size  field
+ *     0       4     magic "OPUB"
+ *     4       1     version
+ *     5       1     area count
+ *     6       2     publication id
+ *     8       4     session (random per publisher start)
+ *     12      4     sequence number (incremented per frame)
+ *     16      8     publisher timestamp, ns since the epoch
+ *     24      ...   areas
+ *
+ * Each area is a 4-byte header (type, reserved, element count) followed by
+ * the elements. BOOL areas carry one byte per image index (bit n = %X index.n).
+ *
+ * The codec has no dependencies on the runtime so it can be reused by tests
+ * and by non-PLC peers.
+ */
+
+#ifndef UDP_PUBSUB_FRAME_H
+#define UDP_PUBSUB_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UDP_PUBSUB_MAGIC            0x4F505542U /* "OPUB" */
+#define UDP_PUBSUB_VERSION          1
+#define UDP_PUBSUB_HEADER_SIZE      24
+#define UDP_PUBSUB_AREA_HEADER_SIZE 4
+#define UDP_PUBSUB_MAX_AREAS        16
+#define UDP_PUBSUB_MAX_FRAME        1472 /* Fits an Ethernet MTU without fragmentation */
+
+typedef enum
+{
+    UDP_AREA_BOOL  = 1,
+    UDP_AREA_BYTE  = 2,
+    UDP_AREA_WORD  = 3,
+    UDP_AREA_DWORD = 4,
+    UDP_AREA_LWORD = 5
+} udp_area_type_t;
+
+typedef struct
+{
+    uint16_t publication_id;
+    uint8_t area_count;
+    uint32_t session;
+    uint32_t sequence;
+    uint64_t timestamp_ns;
+} udp_frame_header_t;
+
+/**
+ * @brief One area of a parsed frame (data still in network byte order)
+ */
+typedef struct
+{
+    udp_area_type_t type;
+    uint16_t count;
+    const uint8_t *data;
+} udp_frame_area_t;
+
+/**
+ * @brief Size of one element of an area type (0 if unknown)
+ */
+size_t udp_area_element_size(udp_area_type_t type);
+
+/**
+ * @brief Encoded size of an area including its header
+ */
+size_t udp_area_encoded_size(udp_area_type_t type, uint16_t count);
+
+/**
+ * @brief Write a frame header
+ *
+ * @return UDP_PUBSUB_HEADER_SIZE, or 0 if the buffer is too small
+ */
+size_t udp_frame_encode_header(uint8_t *buf, size_t cap, const udp_frame_header_t *header);
+
+/**
+ * @brief Append an area
+ *
+ * @param buf    Destination (after the header and previous areas)
+ * @param cap    Remaining capacity
+ * @param type   Area type
+ * @param count  Number of elements
+ * @param values Elements in native layout (uint8_t, uint16_t, uint32_t or uint64_t)
+ * @return Bytes written, or 0 if the buffer is too small
+ */
+size_t udp_frame_encode_area(uint8_t *buf, size_t cap, udp_area_type_t type, uint16_t count,
+                             const void *values);
+
+/**
+ * @brief Validate and parse a received frame
+ *
+ * @param buf       Received datagram
+ * @param len       Datagram length
+ * @param header    Receives the header
+ * @param areas     Receives up to max_areas areas
+ * @param max_areas Capacity of areas
+ * @return 0 on success, -1 if the frame is malformed or from another protocol
+ */
+int udp_frame_parse(const uint8_t *buf, size_t len, udp_frame_header_t *header,
+                    udp_frame_area_t *areas, int max_areas);
+
+/**
+ * @brief Convert a parsed area to native layout
+ *
+ * @param area Parsed area
+ * @param out  Receives area->count elements in native layout
+ */
+void udp_frame_area_to_native(const udp_frame_area_t *area, void *out);
+
+/*
+ * =============================================================================
+ * Sequence tracking
+ * =============================================================================
+ */
+
+typedef enum
+{
+    UDP_SEQ_FIRST = 0, /* First frame, or the publisher restarted */
+    UDP_SEQ_NEXT,      /* Newer frame; lost frames are reported */
+    UDP_SEQ_OLD        /* Duplicate or reordered frame, to be dropped */
+} udp_seq_result_t;
+
+typedef struct
+{
+    int valid;
+    uint32_t session;
+    uint32_t last_sequence;
+} udp_seq_state_t;
+
+/**
+ * @brief Classify a received sequence number and update the state
+ *
+ * Sequence numbers are compared with serial-number arithmetic so the 32-bit
+ * counter may wrap.
+ *
+ * @param state    Tracking state (zero-initialized before the first frame)
+ * @param session  Session of the received frame
+ * @param sequence Sequence number of the received frame
+ * @param lost     Receives the number of frames missing before this one
+ * @return Classification of the frame
+ */
+udp_seq_result_t udp_seq_update(udp_seq_state_t *state, uint32_t session, uint32_t sequence,
+                                uint32_t *lost);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDP_PUBSUB_FRAME_H */
@@ -0,0 +1,846 @@
+/**
+ * @file udp_pubsub_plugin.c
+ * @brief UDP Multicast Publish/Subscribe Plugin Implementation
+ *
+ * Data path:
+ *
+ *     publisher runtime                          subscriber runtime
+ *     -----------------                          ------------------
+ *     cycle_end: gather areas,                   receiver thread: poll() wakes,
+ *     encode frame, sendto()   --- UDP --->      check sequence, decode areas,
+ *     (non-blocking)                             journal_write_ranges()
+ *                                                        |
+ *                                                        v
+ *                                                next cycle start applies the
+ *                                                whole frame to the inputs
+ *
+ * Nothing polls: the receiver sleeps in poll() until a frame arrives or the
+ * nearest subscription timeout expires, and the scan thread only pays for
+ * encoding and one non-blocking send per due publication.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "plugin_logger.h"
+#include "plugin_types.h"
+#include "udp_pubsub_config.h"
+#include "udp_pubsub_frame.h"
+#include "udp_pubsub_plugin.h"
+#include "udp_pubsub_socket.h"
+
+/* Native copy of a frame: areas start on 8-byte boundaries */
+#define STAGING_WORDS ((UDP_PUBSUB_MAX_FRAME + 8 * UDP_PUBSUB_MAX_AREAS) / 8)
+
+/**
+ * @brief Runtime state of one publication
+ */
+typedef struct
+{
+    const udp_pubsub_publication_config_t *cfg;
+    struct sockaddr_in dest;
+    uint32_t sequence;
+    int cycles_since_send;
+    uint64_t sent;
+    uint64_t send_errors;
+    uint8_t frame[UDP_PUBSUB_MAX_FRAME];
+} publication_runtime_t;
+
+/**
+ * @brief A socket shared by all subscriptions on the same address and port
+ */
+typedef struct
+{
+    struct sockaddr_in addr;
+    int fd;
+} endpoint_runtime_t;
+
+/**
+ * @brief Runtime state of one subscription (owned by the receiver thread)
+ */
+typedef struct
+{
+    const udp_pubsub_subscription_config_t *cfg;
+    int endpoint;
+    udp_seq_state_t seq;
+    bool fresh;
+    int64_t last_frame_ms;
+    bool mismatch_logged;
+    uint64_t frames;
+    uint64_t lost;
+    uint64_t out_of_order;
+    uint64_t mismatched;
+    uint64_t stale_events;
+    uint64_t apply_errors;
+    plugin_journal_range_t ranges[UDP_PUBSUB_MAX_AREAS];
+    uint64_t staging[STAGING_WORDS];
+} subscription_runtime_t;
+
+/* Plugin state */
+static plugin_logger_t g_logger;
+static plugin_runtime_args_t g_runtime_args;
+static udp_pubsub_config_t g_config;
+static bool g_initialized = false;
+static bool g_running     = false;
+
+/* Publisher side (scan thread) */
+static publication_runtime_t g_publications[UDP_PUBSUB_MAX_PUBLICATIONS];
+static int g_num_publications = 0;
+static int g_publish_fd       = -1;
+static uint32_t g_session     = 0;
+static uint64_t g_gather[STAGING_WORDS];
+
+/* Subscriber side (receiver thread) */
+static subscription_runtime_t g_subscriptions[UDP_PUBSUB_MAX_SUBSCRIPTIONS];
+static int g_num_subscriptions = 0;
+static endpoint_runtime_t g_endpoints[UDP_PUBSUB_MAX_SUBSCRIPTIONS];
+static int g_num_endpoints        = 0;
+static uint64_t g_zeros[STAGING_WORDS];
+static uint64_t g_malformed       = 0;
+static uint64_t g_unmatched       = 0;
+static pthread_t g_receiver;
+static bool g_receiver_started    = false;
+static int g_wakeup_fd            = -1;
+
+/*
+ * =============================================================================
+ * Helpers
+ * =============================================================================
+ */
+
+static int64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static uint64_t realtime_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t new_session_id(void)
+{
+    uint32_t session = 0;
+    if (getrandom(&session, sizeof(session), GRND_NONBLOCK) != (ssize_t)sizeof(session))
+    {
+        session = (uint32_t)realtime_ns() ^ ((uint32_t)getpid() << 16);
+    }
+    return session;
+}
+
+static IEC_BOOL *(*bool_table(udp_pubsub_buffer_t buffer))[8]
+{
+    switch (buffer)
+    {
+    case UDP_BUFFER_BOOL_INPUT:
+        return g_runtime_args.bool_input;
+    case UDP_BUFFER_BOOL_OUTPUT:
+        return g_runtime_args.bool_output;
+    case UDP_BUFFER_BOOL_MEMORY:
+        return g_runtime_args.bool_memory;
+    default:
+        return NULL;
+    }
+}
+
+static void *word_table(udp_pubsub_buffer_t buffer)
+{
+    switch (buffer)
+    {
+    case UDP_BUFFER_BYTE_INPUT:
+        return g_runtime_args.byte_input;
+    case UDP_BUFFER_BYTE_OUTPUT:
+        return g_runtime_args.byte_output;
+    case UDP_BUFFER_INT_INPUT:
+        return g_runtime_args.int_input;
+    case UDP_BUFFER_INT_OUTPUT:
+        return g_runtime_args.int_output;
+    case UDP_BUFFER_INT_MEMORY:
+        return g_runtime_args.int_memory;
+    case UDP_BUFFER_DINT_INPUT:
+        return g_runtime_args.dint_input;
+    case UDP_BUFFER_DINT_OUTPUT:
+        return g_runtime_args.dint_output;
+    case UDP_BUFFER_DINT_MEMORY:
+        return g_runtime_args.dint_memory;
+    case UDP_BUFFER_LINT_INPUT:
+        return g_runtime_args.lint_input;
+    case UDP_BUFFER_LINT_OUTPUT:
+        return g_runtime_args.lint_output;
+    case UDP_BUFFER_LINT_MEMORY:
+        return g_runtime_args.lint_memory;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * @brief Copy an image table range into native layout (unbound locations read as 0)
+ */
+static void gather_area(const udp_pubsub_area_config_t *area, void *out)
+{
+    IEC_BOOL *(*bools)[8] = bool_table(area->buffer);
+    if (bools != NULL)
+    {
+        uint8_t *dst = (uint8_t *)out;
+        for (int i = 0; i < area->count; i++)
+        {
+            uint8_t packed = 0;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                IEC_BOOL *p = bools[area->start + i][bit];
+                if (p != NULL && *p)
+                {
+                    packed |= (uint8_t)(1U << bit);
+                }
+            }
+            dst[i] = packed;
+        }
+        return;
+    }
+
+    switch (udp_pubsub_buffer_area_type(area->buffer))
+    {
+    case UDP_AREA_BYTE:
+    {
+        IEC_BYTE **table = (IEC_BYTE **)word_table(area->buffer) + area->start;
+        for (int i = 0; i < area->count; i++)
+        {
+            ((uint8_t *)out)[i] = table[i] != NULL ? *table[i] : 0;
+        }
+        break;
+    }
+    case UDP_AREA_WORD:
+    {
+        IEC_UINT **table = (IEC_UINT **)word_table(area->buffer) + area->start;
+        for (int i = 0; i < area->count; i++)
+        {
+            ((uint16_t *)out)[i] = table[i] != NULL ? *table[i] : 0;
+        }
+        break;
+    }
+    case UDP_AREA_DWORD:
+    {
+        IEC_UDINT **table = (IEC_UDINT **)word_table(area->buffer) + area->start;
+        for (int i = 0; i < area->count; i++)
+        {
+            ((uint32_t *)out)[i] = table[i] != NULL ? *table[i] : 0;
+        }
+        break;
+    }
+    case UDP_AREA_LWORD:
+    {
+        IEC_ULINT **table = (IEC_ULINT **)word_table(area->buffer) + area->start;
+        for (int i = 0; i < area->count; i++)
+        {
+            ((uint64_t *)out)[i] = table[i] != NULL ? *table[i] : 0;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static int check_area_bounds(const udp_pubsub_area_config_t *areas, int num_areas,
+                             const char *what, unsigned id)
+{
+    for (int i = 0; i < num_areas; i++)
+    {
+        if (areas[i].start + areas[i].count > g_runtime_args.buffer_size)
+        {
+            plugin_logger_error(&g_logger, "%s %u: area %d exceeds buffer size %d", what, id, i,
+                                g_runtime_args.buffer_size);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * =============================================================================
+ * Receiver Thread
+ * =============================================================================
+ */
+
+static void write_status(const subscription_runtime_t *sub, bool fresh)
+{
+    const udp_pubsub_subscription_config_t *cfg = sub->cfg;
+    if (cfg->has_status)
+    {
+        g_runtime_args.journal_write_bool((int)cfg->status_buffer, cfg->status_index,
+                                          cfg->status_bit, fresh ? 1 : 0);
+    }
+}
+
+static void mark_stale(subscription_runtime_t *sub)
+{
+    const udp_pubsub_subscription_config_t *cfg = sub->cfg;
+
+    sub->fresh = false;
+    sub->stale_events++;
+    plugin_logger_warn(&g_logger, "Publication %u on %s:%u is stale (no frame for %d ms)",
+                       cfg->publication_id, cfg->address, cfg->port, cfg->timeout_ms);
+
+    if (cfg->on_timeout == UDP_ON_TIMEOUT_ZERO)
+    {
+        plugin_journal_range_t zeros[UDP_PUBSUB_MAX_AREAS];
+        for (int i = 0; i < cfg->num_areas; i++)
+        {
+            zeros[i]        = sub->ranges[i];
+            zeros[i].values = g_zeros;
+        }
+        g_runtime_args.journal_write_ranges(zeros, cfg->num_areas);
+    }
+    write_status(sub, false);
+}
+
+/**
+ * @brief Validate a frame against a subscription and apply it as one journal batch
+ */
+static void apply_frame(subscription_runtime_t *sub, const udp_frame_header_t *header,
+                        const udp_frame_area_t *areas)
+{
+    const udp_pubsub_subscription_config_t *cfg = sub->cfg;
+
+    bool layout_ok = header->area_count == cfg->num_areas;
+    for (int i = 0; layout_ok && i < cfg->num_areas; i++)
+    {
+        layout_ok = areas[i].type == udp_pubsub_buffer_area_type(cfg->areas[i].buffer) &&
+                    areas[i].count == cfg->areas[i].count;
+    }
+    if (!layout_ok)
+    {
+        sub->mismatched++;
+        if (!sub->mismatch_logged)
+        {
+            plugin_logger_error(&g_logger,
+                                "Frame layout of publication %u does not match the subscription",
+                                cfg->publication_id);
+            sub->mismatch_logged = true;
+        }
+        return;
+    }
+
+    uint32_t lost           = 0;
+    udp_seq_result_t result = udp_seq_update(&sub->seq, header->session, header->sequence, &lost);
+    if (result == UDP_SEQ_OLD)
+    {
+        sub->out_of_order++;
+        return;
+    }
+    if (result == UDP_SEQ_FIRST)
+    {
+        plugin_logger_info(&g_logger, "Receiving publication %u (session %08" PRIx32 ")",
+                           cfg->publication_id, header->session);
+    }
+    sub->lost += lost;
+
+    for (int i = 0; i < cfg->num_areas; i++)
+    {
+        udp_frame_area_to_native(&areas[i], (void *)sub->ranges[i].values);
+    }
+    if (g_runtime_args.journal_write_ranges(sub->ranges, cfg->num_areas) != 0)
+    {
+        sub->apply_errors++;
+        return;
+    }
+
+    sub->frames++;
+    sub->last_frame_ms = monotonic_ms();
+    if (!sub->fresh)
+    {
+        sub->fresh = true;
+        write_status(sub, true);
+        if (sub->stale_events > 0)
+        {
+            plugin_logger_info(&g_logger, "Publication %u is fresh again", cfg->publication_id);
+        }
+    }
+}
+
+static void drain_endpoint(int endpoint)
+{
+    static uint8_t buf[UDP_PUBSUB_MAX_FRAME + 1];
+    udp_frame_area_t areas[UDP_PUBSUB_MAX_AREAS];
+    udp_frame_header_t header;
+
+    for (;;)
+    {
+        ssize_t len = recv(g_endpoints[endpoint].fd, buf, sizeof(buf), 0);
+        if (len < 0)
+        {
+            return; /* EAGAIN: drained */
+        }
+
+        if (udp_frame_parse(buf, (size_t)len, &header, areas, UDP_PUBSUB_MAX_AREAS) != 0)
+        {
+            g_malformed++;
+            continue;
+        }
+
+        subscription_runtime_t *sub = NULL;
+        for (int i = 0; i < g_num_subscriptions; i++)
+        {
+            if (g_subscriptions[i].endpoint == endpoint &&
+                g_subscriptions[i].cfg->publication_id == header.publication_id)
+            {
+                sub = &g_subscriptions[i];
+                break;
+            }
+        }
+
+        if (sub == NULL)
+        {
+            g_unmatched++;
+            continue;
+        }
+        apply_frame(sub, &header, areas);
+    }
+}
+
+/**
+ * @brief Milliseconds until the nearest fresh subscription times out (-1 if none)
+ */
+static int next_timeout_ms(int64_t now)
+{
+    int timeout = -1;
+    for (int i = 0; i < g_num_subscriptions; i++)
+    {
+        const subscription_runtime_t *sub = &g_subscriptions[i];
+        if (!sub->fresh)
+        {
+            continue;
+        }
+
+        int64_t remaining = sub->last_frame_ms + sub->cfg->timeout_ms - now;
+        int value         = remaining > 0 ? (int)remaining : 0;
+        if (timeout < 0 || value < timeout)
+        {
+            timeout = value;
+        }
+    }
+    return timeout;
+}
+
+static void *receiver_thread(void *arg)
+{
+    (void)arg;
+    struct pollfd fds[UDP_PUBSUB_MAX_SUBSCRIPTIONS + 1];
+
+    fds[0].fd     = g_wakeup_fd;
+    fds[0].events = POLLIN;
+    for (int i = 0; i < g_num_endpoints; i++)
+    {
+        fds[i + 1].fd     = g_endpoints[i].fd;
+        fds[i + 1].events = POLLIN;
+    }
+
+    while (__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+    {
+        int ready = poll(fds, (nfds_t)g_num_endpoints + 1, next_timeout_ms(monotonic_ms()));
+        if (ready < 0 && errno != EINTR)
+        {
+            plugin_logger_error(&g_logger, "poll failed: %s", strerror(errno));
+            break;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            break; /* stop_loop() */
+        }
+
+        for (int i = 0; ready > 0 && i < g_num_endpoints; i++)
+        {
+            if (fds[i + 1].revents & POLLIN)
+            {
+                drain_endpoint(i);
+            }
+        }
+
+        int64_t now = monotonic_ms();
+        for (int i = 0; i < g_num_subscriptions; i++)
+        {
+            subscription_runtime_t *sub = &g_subscriptions[i];
+            if (sub->fresh && now - sub->last_frame_ms >= sub->cfg->timeout_ms)
+            {
+                mark_stale(sub);
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * =============================================================================
+ * Setup
+ * =============================================================================
+ */
+
+static void close_sockets(void)
+{
+    if (g_publish_fd >= 0)
+    {
+        close(g_publish_fd);
+        g_publish_fd = -1;
+    }
+    for (int i = 0; i < g_num_endpoints; i++)
+    {
+        close(g_endpoints[i].fd);
+    }
+    g_num_endpoints = 0;
+    if (g_wakeup_fd >= 0)
+    {
+        close(g_wakeup_fd);
+        g_wakeup_fd = -1;
+    }
+}
+
+static int setup_publications(void)
+{
+    g_num_publications = 0;
+    if (g_config.num_publications == 0)
+    {
+        return 0;
+    }
+
+    g_publish_fd = udp_pubsub_open_publisher(g_config.interface, g_config.multicast_ttl,
+                                             g_config.multicast_loopback);
+    if (g_publish_fd < 0)
+    {
+        plugin_logger_error(&g_logger, "Cannot open publisher socket: %s", strerror(errno));
+        return -1;
+    }
+
+    for (int i = 0; i < g_config.num_publications; i++)
+    {
+        const udp_pubsub_publication_config_t *cfg = &g_config.publications[i];
+        publication_runtime_t *pub                 = &g_publications[i];
+
+        memset(pub, 0, sizeof(*pub));
+        pub->cfg = cfg;
+        if (udp_pubsub_resolve(cfg->address, cfg->port, &pub->dest) != 0)
+        {
+            plugin_logger_error(&g_logger, "Publication %u: invalid address %s", cfg->id,
+                                cfg->address);
+            return -1;
+        }
+        if (check_area_bounds(cfg->areas, cfg->num_areas, "Publication", cfg->id) != 0)
+        {
+            return -1;
+        }
+        /* Send on the first cycle after start */
+        pub->cycles_since_send = cfg->every_n_cycles - 1;
+        g_num_publications++;
+    }
+    return 0;
+}
+
+static int setup_subscriptions(void)
+{
+    g_num_subscriptions = 0;
+    for (int i = 0; i < g_config.num_subscriptions; i++)
+    {
+        const udp_pubsub_subscription_config_t *cfg = &g_config.subscriptions[i];
+        subscription_runtime_t *sub                 = &g_subscriptions[i];
+
+        memset(sub, 0, sizeof(*sub));
+        sub->cfg = cfg;
+        if (check_area_bounds(cfg->areas, cfg->num_areas, "Subscription", cfg->publication_id) !=
+                0 ||
+            (cfg->has_status && cfg->status_index >= g_runtime_args.buffer_size))
+        {
+            plugin_logger_error(&g_logger, "Subscription %u: invalid image table range",
+                                cfg->publication_id);
+            return -1;
+        }
+
+        struct sockaddr_in addr;
+        if (udp_pubsub_resolve(cfg->address, cfg->port, &addr) != 0)
+        {
+            plugin_logger_error(&g_logger, "Subscription %u: invalid address %s",
+                                cfg->publication_id, cfg->address);
+            return -1;
+        }
+
+        /* Share one socket between subscriptions on the same address and port */
+        sub->endpoint = -1;
+        for (int e = 0; e < g_num_endpoints; e++)
+        {
+            if (g_endpoints[e].addr.sin_addr.s_addr == addr.sin_addr.s_addr &&
+                g_endpoints[e].addr.sin_port == addr.sin_port)
+            {
+                sub->endpoint = e;
+                break;
+            }
+        }
+        if (sub->endpoint < 0)
+        {
+            int fd = udp_pubsub_open_subscriber(&addr, g_config.interface);
+            if (fd < 0)
+            {
+                plugin_logger_error(&g_logger, "Cannot listen on %s:%u: %s", cfg->address,
+                                    cfg->port, strerror(errno));
+                return -1;
+            }
+            g_endpoints[g_num_endpoints].addr = addr;
+            g_endpoints[g_num_endpoints].fd   = fd;
+            sub->endpoint                     = g_num_endpoints++;
+        }
+
+        /* Journal ranges point into the staging copy the receiver decodes into */
+        size_t offset = 0;
+        for (int a = 0; a < cfg->num_areas; a++)
+        {
+            const udp_pubsub_area_config_t *area = &cfg->areas[a];
+            size_t size = udp_area_element_size(udp_pubsub_buffer_area_type(area->buffer)) *
+                          (size_t)area->count;
+            sub->ranges[a].type        = (int)area->buffer;
+            sub->ranges[a].start_index = area->start;
+            sub->ranges[a].count       = area->count;
+            sub->ranges[a].values      = (uint8_t *)sub->staging + offset;
+            offset += (size + 7) & ~(size_t)7;
+        }
+
+        write_status(sub, false);
+        g_num_subscriptions++;
+    }
+    return 0;
+}
+
+/*
+ * =============================================================================
+ * Plugin Lifecycle Functions
+ * =============================================================================
+ */
+
+int init(void *args)
+{
+    if (!args)
+    {
+        plugin_logger_init(&g_logger, "UDP_PUBSUB", NULL);
+        plugin_logger_error(&g_logger, "init args is NULL");
+        return -1;
+    }
+
+    /* Copy runtime args (pointer is freed after init returns) */
+    memcpy(&g_runtime_args, args, sizeof(plugin_runtime_args_t));
+
+    plugin_logger_init(&g_logger, "UDP_PUBSUB", args);
+    plugin_logger_info(&g_logger, "Initializing UDP pub/sub plugin...");
+
+    g_initialized = true;
+    return 0;
+}
+
+int start_loop(void)
+{
+    if (!g_initialized)
+    {
+        plugin_logger_error(&g_logger, "Cannot start - plugin not initialized");
+        return -1;
+    }
+
+    if (g_running)
+    {
+        plugin_logger_warn(&g_logger, "UDP pub/sub already running");
+        return 0;
+    }
+
+    const char *config_path = g_runtime_args.plugin_specific_config_file_path;
+    if (config_path == NULL || config_path[0] == '\0')
+    {
+        plugin_logger_warn(&g_logger, "No config file specified, nothing to exchange");
+        return 0;
+    }
+
+    int result = udp_pubsub_config_parse(config_path, &g_config);
+    if (result != 0)
+    {
+        plugin_logger_error(&g_logger, "Failed to parse config file %s (error %d)", config_path,
+                            result);
+        return -1;
+    }
+
+    if (!g_config.enabled || (g_config.num_publications == 0 && g_config.num_subscriptions == 0))
+    {
+        plugin_logger_info(&g_logger, "UDP pub/sub is disabled or has nothing configured");
+        return 0;
+    }
+
+    if (g_config.num_subscriptions > 0 && g_runtime_args.journal_write_ranges == NULL)
+    {
+        plugin_logger_error(&g_logger, "Runtime does not provide journal range writes");
+        return -1;
+    }
+
+    g_session   = new_session_id();
+    g_malformed = 0;
+    g_unmatched = 0;
+
+    if (setup_publications() != 0 || setup_subscriptions() != 0)
+    {
+        close_sockets();
+        return -1;
+    }
+
+    if (g_num_subscriptions > 0)
+    {
+        g_wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (g_wakeup_fd < 0)
+        {
+            plugin_logger_error(&g_logger, "Cannot create eventfd: %s", strerror(errno));
+            close_sockets();
+            return -1;
+        }
+
+        /*
+         * start_loop() runs on the real-time scan thread; without an explicit
+         * policy the receiver would inherit SCHED_FIFO and compete with the scan.
+         */
+        pthread_attr_t attr;
+        struct sched_param param = {.sched_priority = 0};
+        pthread_attr_init(&attr);
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+        pthread_attr_setschedparam(&attr, &param);
+
+        __atomic_store_n(&g_running, true, __ATOMIC_RELEASE);
+        int create_result = pthread_create(&g_receiver, &attr, receiver_thread, NULL);
+        pthread_attr_destroy(&attr);
+        if (create_result != 0)
+        {
+            plugin_logger_error(&g_logger, "Failed to create receiver thread");
+            __atomic_store_n(&g_running, false, __ATOMIC_RELEASE);
+            close_sockets();
+            return -1;
+        }
+        g_receiver_started = true;
+    }
+    else
+    {
+        __atomic_store_n(&g_running, true, __ATOMIC_RELEASE);
+    }
+
+    plugin_logger_info(&g_logger,
+                       "Started %d publication(s) and %d subscription(s), session %08" PRIx32,
+                       g_num_publications, g_num_subscriptions, g_session);
+    return 0;
+}
+
+void stop_loop(void)
+{
+    if (!g_running)
+    {
+        return;
+    }
+
+    __atomic_store_n(&g_running, false, __ATOMIC_RELEASE);
+    if (g_receiver_started)
+    {
+        uint64_t one = 1;
+        if (write(g_wakeup_fd, &one, sizeof(one)) != (ssize_t)sizeof(one))
+        {
+            plugin_logger_warn(&g_logger, "Failed to wake receiver thread");
+        }
+        pthread_join(g_receiver, NULL);
+        g_receiver_started = false;
+    }
+    close_sockets();
+
+    for (int i = 0; i < g_num_publications; i++)
+    {
+        const publication_runtime_t *pub = &g_publications[i];
+        plugin_logger_info(&g_logger,
+                           "Publication %u: %" PRIu64 " frames sent, %" PRIu64 " send errors",
+                           pub->cfg->id, pub->sent, pub->send_errors);
+    }
+    for (int i = 0; i < g_num_subscriptions; i++)
+    {
+        const subscription_runtime_t *sub = &g_subscriptions[i];
+        plugin_logger_info(&g_logger,
+                           "Subscription %u: %" PRIu64 " frames, %" PRIu64 " lost, %" PRIu64
+                           " out of order, %" PRIu64 " mismatched, %" PRIu64
+                           " stale events, %" PRIu64 " journal errors",
+                           sub->cfg->publication_id, sub->frames, sub->lost, sub->out_of_order,
+                           sub->mismatched, sub->stale_events, sub->apply_errors);
+    }
+    if (g_malformed > 0 || g_unmatched > 0)
+    {
+        plugin_logger_info(&g_logger, "%" PRIu64 " malformed and %" PRIu64 " unsubscribed frames",
+                           g_malformed, g_unmatched);
+    }
+}
+
+void cleanup(void)
+{
+    stop_loop();
+    g_initialized = false;
+    plugin_logger_info(&g_logger, "UDP pub/sub cleanup complete");
+}
+
+void cycle_start(void)
+{
+    /* Received frames are applied by the journal before the program runs */
+}
+
+void cycle_end(void)
+{
+    if (!__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    for (int p = 0; p < g_num_publications; p++)
+    {
+        publication_runtime_t *pub                 = &g_publications[p];
+        const udp_pubsub_publication_config_t *cfg = pub->cfg;
+
+        if (++pub->cycles_since_send < cfg->every_n_cycles)
+        {
+            continue;
+        }
+        pub->cycles_since_send = 0;
+
+        udp_frame_header_t header = {.publication_id = cfg->id,
+                                     .area_count     = (uint8_t)cfg->num_areas,
+                                     .session        = g_session,
+                                     .sequence       = ++pub->sequence,
+                                     .timestamp_ns   = realtime_ns()};
+        size_t len = udp_frame_encode_header(pub->frame, sizeof(pub->frame), &header);
+        for (int a = 0; a < cfg->num_areas; a++)
+        {
+            const udp_pubsub_area_config_t *area = &cfg->areas[a];
+            gather_area(area, g_gather);
+            len += udp_frame_encode_area(pub->frame + len, sizeof(pub->frame) - len,
+                                         udp_pubsub_buffer_area_type(area->buffer),
+                                         (uint16_t)area->count, g_gather);
+        }
+
+        if (sendto(g_publish_fd, pub->frame, len, MSG_DONTWAIT, (const struct sockaddr *)&pub->dest,
+                   sizeof(pub->dest)) < 0)
+        {
+            pub->send_errors++;
+        }
+        else
+        {
+            pub->sent++;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file udp_pubsub_plugin.h
+ * @brief UDP Multicast Publish/Subscribe Plugin for OpenPLC Runtime v4
+ *
+ * This plugin exchanges image table ranges between runtimes as compact binary
+ * frames over UDP (typically multicast). Publications are sent directly from
+ * the scan cycle every N cycles. Subscriptions are received by a background
+ * thread that blocks until a frame arrives and writes the whole frame to the
+ * image tables through one journal batch, so the values appear together at
+ * the start of the next scan cycle.
+ *
+ * Every frame carries a session id and a sequence number so subscribers can
+ * count lost frames, drop duplicates and reordered frames, and detect a
+ * publisher restart. A subscription that receives nothing for its timeout is
+ * marked stale through an optional status bit.
+ */
+
+#ifndef UDP_PUBSUB_PLUGIN_H
+#define UDP_PUBSUB_PLUGIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the UDP pub/sub plugin
+ *
+ * @param args Pointer to plugin_runtime_args_t containing runtime buffers,
+ *             mutex functions, and logging function pointers
+ * @return 0 on success, -1 on failure
+ */
+int init(void *args);
+
+/**
+ * @brief Start publishing and subscribing
+ *
+ * Parses the configuration, opens the sockets and starts the receiver thread.
+ */
+int start_loop(void);
+
+/**
+ * @brief Stop publishing and subscribing
+ */
+void stop_loop(void);
+
+/**
+ * @brief Cleanup plugin resources
+ */
+void cleanup(void);
+
+/**
+ * @brief Called at the start of each PLC scan cycle
+ *
+ * Nothing to do; received frames reach the image tables through the journal.
+ */
+void cycle_start(void);
+
+/**
+ * @brief Called at the end of each PLC scan cycle
+ *
+ * Sends every publication that is due. Called with buffer mutex already held.
+ */
+void cycle_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDP_PUBSUB_PLUGIN_H */
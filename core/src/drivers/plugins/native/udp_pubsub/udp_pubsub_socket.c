@@ -0,0 +1,112 @@
+/**
+ * @file udp_pubsub_socket.c
+ * @brief Socket helpers for the UDP pub/sub plugin
+ */
+
+#include "udp_pubsub_socket.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int parse_interface(const char *interface, struct in_addr *out)
+{
+    if (interface == NULL || interface[0] == '\0')
+    {
+        out->s_addr = htonl(INADDR_ANY);
+        return 0;
+    }
+    return inet_pton(AF_INET, interface, out) == 1 ? 0 : -1;
+}
+
+static int fail(int fd)
+{
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return -1;
+}
+
+int udp_pubsub_resolve(const char *address, uint16_t port, struct sockaddr_in *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->sin_family = AF_INET;
+    out->sin_port   = htons(port);
+    if (inet_pton(AF_INET, address, &out->sin_addr) != 1)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int udp_pubsub_open_publisher(const char *interface, int ttl, bool loopback)
+{
+    struct in_addr iface;
+    if (parse_interface(interface, &iface) != 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    unsigned char ttl_value  = (unsigned char)ttl;
+    unsigned char loop_value = loopback ? 1 : 0;
+    if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl_value, sizeof(ttl_value)) != 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop_value, sizeof(loop_value)) != 0)
+    {
+        return fail(fd);
+    }
+
+    if (iface.s_addr != htonl(INADDR_ANY) &&
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0)
+    {
+        return fail(fd);
+    }
+
+    return fd;
+}
+
+int udp_pubsub_open_subscriber(const struct sockaddr_in *addr, const char *interface)
+{
+    struct in_addr iface;
+    if (parse_interface(interface, &iface) != 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    int reuse = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(fd, (const struct sockaddr *)addr, sizeof(*addr)) != 0)
+    {
+        return fail(fd);
+    }
+
+    if (IN_MULTICAST(ntohl(addr->sin_addr.s_addr)))
+    {
+        struct ip_mreq mreq;
+        mreq.imr_multiaddr = addr->sin_addr;
+        mreq.imr_interface = iface;
+        if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0)
+        {
+            return fail(fd);
+        }
+    }
+
+    return fd;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file udp_pubsub_socket.h
+ * @brief Socket helpers for the UDP pub/sub plugin (IPv4 only)
+ */
+
+#ifndef UDP_PUBSUB_SOCKET_H
+#define UDP_PUBSUB_SOCKET_H
+
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fill a socket address from a dotted-quad address and port
+ *
+ * @return 0 on success, -1 if the address is not a valid IPv4 address
+ */
+int udp_pubsub_resolve(const char *address, uint16_t port, struct sockaddr_in *out);
+
+/**
+ * @brief Open a socket for publishing
+ *
+ * @param interface IPv4 address of the interface for multicast frames, or
+ *                  NULL/"" for the routing default
+ * @param ttl       Multicast hop limit
+ * @param loopback  Deliver multicast frames to subscribers on this host
+ * @return Socket descriptor, or -1 on error (errno is set)
+ */
+int udp_pubsub_open_publisher(const char *interface, int ttl, bool loopback);
+
+/**
+ * @brief Open a non-blocking socket receiving frames sent to an address
+ *
+ * For a multicast group the socket binds to the group and joins it on the
+ * given interface; for any other address it binds to that local address.
+ * SO_REUSEADDR lets several runtimes on one host subscribe to the same group.
+ *
+ * @param addr      Group or local address and port
+ * @param interface IPv4 address of the interface to join on, or NULL/""
+ * @return Socket descriptor, or -1 on error (errno is set)
+ */
+int udp_pubsub_open_subscriber(const struct sockaddr_in *addr, const char *interface);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDP_PUBSUB_SOCKET_H */
@@ -0,0 +1,264 @@
+"""
+OPC-UA variable access plans.
+
+Compiles the mapped variables into a struct-of-arrays plan once, after the
+address space has been built and the variable metadata cache is populated.
+Variables are grouped by datatype; each group holds parallel lists of
+addresses, sizes, typed ctypes views, converters, node ids and the OPC-UA
+variant type, so the per-cycle Runtime -> OPC-UA path becomes a tight loop
+per group instead of a dictionary lookup, size dispatch and datatype string
+comparison per variable.
+
+Variables whose cached size does not match their configured datatype fall
+back to a generic group that uses read_memory_direct() and
+convert_value_for_opcua(), preserving the behaviour of the unplanned path.
+"""
+
+import ctypes
+import os
+import sys
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, List, Optional
+
+# Add directories to path for module access
+_current_dir = os.path.dirname(os.path.abspath(__file__))
+if _current_dir not in sys.path:
+    sys.path.insert(0, _current_dir)
+
+# Import local modules (handle both package and direct loading)
+try:
+    from .opcua_logging import log_debug, log_warn
+    from .opcua_types import VariableNode, VariableMetadata
+    from .opcua_utils import map_plc_to_opcua_type, convert_value_for_opcua
+    from .opcua_memory import (
+        IEC_STRING,
+        IEC_TIMESPEC,
+        STR_MAX_LEN,
+        STRING_TOTAL_SIZE,
+        TIMESPEC_SIZE,
+        TIME_DATATYPES,
+        read_memory_direct,
+    )
+except ImportError:
+    from opcua_logging import log_debug, log_warn
+    from opcua_types import VariableNode, VariableMetadata
+    from opcua_utils import map_plc_to_opcua_type, convert_value_for_opcua
+    from opcua_memory import (
+        IEC_STRING,
+        IEC_TIMESPEC,
+        STR_MAX_LEN,
+        STRING_TOTAL_SIZE,
+        TIMESPEC_SIZE,
+        TIME_DATATYPES,
+        read_memory_direct,
+    )
+
+
+# Name of the group used for variables that cannot be read through a typed view
+GENERIC_GROUP = "GENERIC"
+
+
+def _convert_bool(raw: int) -> bool:
+    return raw != 0
+
+
+def _convert_string(raw: IEC_STRING) -> str:
+    str_len = max(0, min(raw.len, STR_MAX_LEN))
+    if str_len == 0:
+        return ""
+    return bytes(raw.body[:str_len]).decode('utf-8', errors='replace')
+
+
+def _make_timespec_converter(datatype: str) -> Callable[[IEC_TIMESPEC], Any]:
+    def _convert(raw: IEC_TIMESPEC) -> Any:
+        return convert_value_for_opcua(datatype, (raw.tv_sec, raw.tv_nsec))
+    return _convert
+
+
+# datatype -> (ctypes view type, expected size, converter or None for identity).
+# Signed and floating point views already yield the value OPC-UA expects, so
+# most numeric types need no per-value conversion at all.
+_TYPED_VIEWS = {
+    "BOOL": (ctypes.c_uint8, 1, _convert_bool),
+    "SINT": (ctypes.c_int8, 1, None),
+    "USINT": (ctypes.c_uint8, 1, None),
+    "BYTE": (ctypes.c_uint8, 1, None),
+    "INT": (ctypes.c_int16, 2, None),
+    "UINT": (ctypes.c_uint16, 2, None),
+    "WORD": (ctypes.c_uint16, 2, None),
+    "DINT": (ctypes.c_int32, 4, None),
+    "INT32": (ctypes.c_int32, 4, None),
+    "UDINT": (ctypes.c_uint32, 4, None),
+    "DWORD": (ctypes.c_uint32, 4, None),
+    "LINT": (ctypes.c_int64, 8, None),
+    "ULINT": (ctypes.c_uint64, 8, None),
+    "LWORD": (ctypes.c_uint64, 8, None),
+    "FLOAT": (ctypes.c_float, 4, None),
+    "REAL": (ctypes.c_float, 4, None),
+    "LREAL": (ctypes.c_double, 8, None),
+    "STRING": (IEC_STRING, STRING_TOTAL_SIZE, _convert_string),
+}
+
+
+@dataclass
+class AccessGroup:
+    """
+    Struct-of-arrays access plan for all scalar variables of one datatype.
+
+    All lists are parallel: entry i of each list describes the same variable.
+    """
+    datatype: str
+    variant_type: Any
+    converter: Optional[Callable[[Any], Any]] = None
+    # Converter takes the ctypes structure itself (STRING, TIME types)
+    structured: bool = False
+    indices: List[int] = field(default_factory=list)
+    addresses: List[int] = field(default_factory=list)
+    sizes: List[int] = field(default_factory=list)
+    views: List[Any] = field(default_factory=list)
+    node_ids: List[Any] = field(default_factory=list)
+    nodes: List[VariableNode] = field(default_factory=list)
+
+    def __len__(self) -> int:
+        return len(self.indices)
+
+    def read_values(self) -> List[Any]:
+        """Read and convert the current value of every variable in the group."""
+        convert = self.converter
+        if self.datatype == GENERIC_GROUP:
+            return [
+                convert_value_for_opcua(node.datatype, read_memory_direct(addr, size, datatype=node.datatype))
+                for node, addr, size in zip(self.nodes, self.addresses, self.sizes)
+            ]
+        if convert is None:
+            return [view.value for view in self.views]
+        if self.structured:
+            return [convert(view) for view in self.views]
+        return [convert(view.value) for view in self.views]
+
+
+@dataclass
+class ArrayAccess:
+    """Access plan for one array node (all elements read in a single pass)."""
+    node: VariableNode
+    node_id: Any
+    variant_type: Any
+    group: AccessGroup
+
+    def read_values(self) -> List[Any]:
+        return self.group.read_values()
+
+
+@dataclass
+class AccessPlan:
+    """Compiled access plan for the Runtime -> OPC-UA direction."""
+    groups: Dict[str, AccessGroup] = field(default_factory=dict)
+    arrays: List[ArrayAccess] = field(default_factory=list)
+    # Variables that had no metadata and must use the buffer accessor path
+    unplanned: Dict[int, VariableNode] = field(default_factory=dict)
+
+    @property
+    def planned_count(self) -> int:
+        return sum(len(g) for g in self.groups.values()) + len(self.arrays)
+
+
+def _view_spec(datatype: str, size: int):
+    """Return (view type, converter) for a datatype, or None if not viewable."""
+    dtype = datatype.upper()
+    if dtype in TIME_DATATYPES:
+        if size != TIMESPEC_SIZE:
+            return None
+        return IEC_TIMESPEC, _make_timespec_converter(dtype)
+    spec = _TYPED_VIEWS.get(dtype)
+    if spec is None or spec[1] != size:
+        return None
+    return spec[0], spec[2]
+
+
+def _new_group(datatype: str, spec=None) -> AccessGroup:
+    if spec is None:
+        # Generic entries keep their own datatype; variant type is resolved per node
+        return AccessGroup(datatype=GENERIC_GROUP, variant_type=None)
+    view_type, converter = spec
+    return AccessGroup(
+        datatype=datatype,
+        variant_type=map_plc_to_opcua_type(datatype),
+        converter=converter,
+        structured=view_type in (IEC_STRING, IEC_TIMESPEC),
+    )
+
+
+def _append(group: AccessGroup, var_node: VariableNode, metadata: VariableMetadata, view_type) -> None:
+    group.indices.append(metadata.index)
+    group.addresses.append(metadata.address)
+    group.sizes.append(metadata.size)
+    group.views.append(view_type.from_address(metadata.address) if view_type else None)
+    group.node_ids.append(var_node.node.nodeid)
+    group.nodes.append(var_node)
+
+
+def _valid_address(address: Any) -> bool:
+    return isinstance(address, int) and address >= 4096
+
+
+def compile_access_plan(
+    variable_nodes: Dict[int, VariableNode],
+    variable_metadata: Dict[int, VariableMetadata]
+) -> AccessPlan:
+    """
+    Compile the access plan for the given nodes and metadata cache.
+
+    Args:
+        variable_nodes: Dict mapping variable index to VariableNode
+        variable_metadata: Metadata cache from initialize_variable_cache()
+
+    Returns:
+        AccessPlan grouping scalar variables by datatype plus one entry per array
+    """
+    plan = AccessPlan()
+
+    for var_index, var_node in variable_nodes.items():
+        dtype = var_node.datatype.upper()
+
+        if var_node.array_length and var_node.array_length > 0:
+            elements = [variable_metadata.get(var_index + i) for i in range(var_node.array_length)]
+            if any(m is None or not _valid_address(m.address) for m in elements):
+                plan.unplanned[var_index] = var_node
+                continue
+
+            spec = _view_spec(dtype, elements[0].size)
+            if spec is None or any(m.size != elements[0].size for m in elements):
+                spec = None
+            group = _new_group(dtype, spec)
+            view_type = spec[0] if spec else None
+            for metadata in elements:
+                _append(group, var_node, metadata, view_type)
+
+            plan.arrays.append(ArrayAccess(
+                node=var_node,
+                node_id=var_node.node.nodeid,
+                variant_type=map_plc_to_opcua_type(var_node.datatype),
+                group=group,
+            ))
+            continue
+
+        metadata = variable_metadata.get(var_index)
+        if metadata is None or not _valid_address(metadata.address):
+            plan.unplanned[var_index] = var_node
+            continue
+
+        spec = _view_spec(dtype, metadata.size)
+        key = dtype if spec is not None else GENERIC_GROUP
+        group = plan.groups.get(key)
+        if group is None:
+            group = _new_group(dtype, spec)
+            plan.groups[key] = group
+        _append(group, var_node, metadata, spec[0] if spec else None)
+
+    if plan.groups.get(GENERIC_GROUP):
+        log_warn(f"Access plan: {len(plan.groups[GENERIC_GROUP])} variables use the generic path "
+                 "(size does not match datatype)")
+
+    log_debug(f"Access plan compiled: {len(plan.groups)} datatype groups, "
+              f"{len(plan.arrays)} arrays, {len(plan.unplanned)} unplanned variables")
+    return plan
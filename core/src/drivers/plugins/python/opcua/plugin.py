@@ -187,6 +187,42 @@ def stop_loop() -> bool:
         return False
 
 
+def program_changing() -> bool:
+    """
+    Pause the sync before an online program change.
+
+    Called by the runtime right before the PLC cycle switches programs; the
+    cached memory addresses are not used again until program_changed().
+
+    Returns:
+        True if the sync is paused, False otherwise
+    """
+    if not _server_manager:
+        return False
+
+    _server_manager.notify_program_changing()
+    return True
+
+
+def program_changed() -> bool:
+    """
+    Refresh cached variable metadata after an online program change.
+
+    Called by the runtime once the new PLC program is active, or after a
+    failed change with the old one. The address space stays as configured;
+    only the cached memory addresses are rebuilt before the sync resumes.
+
+    Returns:
+        True if the refresh was scheduled, False otherwise
+    """
+    if not _server_manager:
+        return False
+
+    log_info("PLC program changed, scheduling metadata refresh")
+    _server_manager.notify_program_changed()
+    return True
+
+
 def cleanup() -> bool:
     """
     Clean up plugin resources.
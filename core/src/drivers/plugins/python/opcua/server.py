@@ -167,6 +167,20 @@ class OpcuaServerManager:
         log_debug("Stop requested...")
         self.running = False
 
+    def notify_program_changing(self) -> None:
+        """
+        Forward the start of an online program change to the synchronization manager.
+        """
+        if self.sync_manager:
+            self.sync_manager.notify_program_changing()
+
+    def notify_program_changed(self) -> None:
+        """
+        Forward an online program change to the synchronization manager.
+        """
+        if self.sync_manager:
+            self.sync_manager.notify_program_changed()
+
     async def _setup_server(self) -> bool:
         """
         Configure and initialize the asyncua Server.
@@ -17,6 +17,7 @@ Subscription Support:
 import asyncio
 import os
 import sys
+import threading
 from datetime import datetime, timezone
 from typing import Dict, Any, Optional, Callable
 
@@ -46,6 +47,7 @@ try:
         write_timespec_direct,
         TIME_DATATYPES as MEM_TIME_DATATYPES,
     )
+    from .access_plan import AccessPlan, compile_access_plan
 except ImportError:
     from opcua_logging import log_info, log_warn, log_error, log_debug
     from opcua_types import VariableNode, VariableMetadata
@@ -61,9 +63,13 @@ except ImportError:
         write_timespec_direct,
         TIME_DATATYPES as MEM_TIME_DATATYPES,
     )
+    from access_plan import AccessPlan, compile_access_plan
 
 from shared import SafeBufferAccess
 
+# Longest wait for a sync cycle in progress when an online change starts
+PROGRAM_CHANGE_WAIT_SECONDS = 2.0
+
 
 class SynchronizationManager:
     """
@@ -73,6 +79,7 @@ class SynchronizationManager:
     - Unified sync loop (both directions in single cycle)
     - Change detection to minimize writes
     - Direct memory access optimization when available
+    - Precompiled per-datatype access plan for the Runtime -> OPC-UA path
     - Batch operations for efficiency
     - Subscription support with proper timestamps
 
@@ -104,6 +111,9 @@ class SynchronizationManager:
         self.variable_metadata: Dict[int, VariableMetadata] = {}
         self._direct_memory_access_enabled = False
 
+        # Struct-of-arrays plan compiled from variable_metadata
+        self._access_plan: Optional[AccessPlan] = None
+
         # Change detection cache (var_index -> last_value)
         self.opcua_value_cache: Dict[int, Any] = {}
 
@@ -116,6 +126,14 @@ class SynchronizationManager:
         # Track if we've logged the "no PLC" warning to avoid log spam
         self._logged_no_plc_warning: bool = False
 
+        # Set by the runtime thread after an online program change
+        self._program_changed: bool = False
+
+        # Set by the runtime thread while an online change switches programs;
+        # the sync loop holds _cycle_lock while it touches PLC memory
+        self._paused: bool = False
+        self._cycle_lock = threading.Lock()
+
     async def initialize(self) -> bool:
         """
         Initialize the synchronization manager.
@@ -161,12 +179,30 @@ class SynchronizationManager:
                 else:
                     log_debug("Using batch operations for sync")
 
+                self._compile_access_plan()
+
             return True
 
         except Exception as e:
             log_error(f"Failed to initialize sync manager: {e}")
             return False
 
+    def _compile_access_plan(self) -> None:
+        """
+        Compile the Runtime -> OPC-UA access plan from the metadata cache.
+
+        Runs once per (re)initialization so the sync cycle only iterates
+        precomputed per-datatype arrays of views and node ids.
+        """
+        self._access_plan = None
+        if not self._direct_memory_access_enabled:
+            return
+        try:
+            self._access_plan = compile_access_plan(self.variable_nodes, self.variable_metadata)
+        except Exception as e:
+            log_warn(f"Failed to compile access plan, using per-variable access: {e}")
+            self._access_plan = None
+
     async def _reinitialize_metadata(self) -> None:
         """
         Reinitialize metadata cache when PLC program becomes available.
@@ -197,12 +233,39 @@ class SynchronizationManager:
             else:
                 log_debug("Using batch operations for sync")
 
+            self._compile_access_plan()
+
             # Clear value cache to force full sync on next cycle
             self.opcua_value_cache.clear()
 
         except Exception as e:
             log_error(f"Failed to reinitialize metadata: {e}")
 
+    def notify_program_changing(self) -> None:
+        """
+        Pause the sync before an online change switches programs.
+
+        Called from the runtime thread. Returns once no sync cycle reads the
+        cached addresses anymore, so no value of the replaced program is
+        published after the switch.
+        """
+        self._paused = True
+        if self._cycle_lock.acquire(timeout=PROGRAM_CHANGE_WAIT_SECONDS):
+            self._cycle_lock.release()
+        else:
+            log_warn("Sync cycle still running, online change proceeds anyway")
+
+    def notify_program_changed(self) -> None:
+        """
+        Request a metadata refresh after an online program change.
+
+        Called from the runtime thread; the sync loop picks it up before its
+        next cycle, since variable addresses belong to the new program, and
+        only then resumes syncing.
+        """
+        self._program_changed = True
+        self._paused = False
+
     async def run(
         self,
         is_running: Callable[[], bool],
@@ -241,14 +304,9 @@ class SynchronizationManager:
                     # Re-initialize metadata cache now that PLC is loaded
                     await self._reinitialize_metadata()
 
-                # Capture cycle timestamp for subscription notifications
-                self._cycle_timestamp = datetime.now(timezone.utc)
-
-                # Direction 1: OPC-UA → Runtime
-                await self.sync_opcua_to_runtime()
-
-                # Direction 2: Runtime → OPC-UA
-                await self.sync_runtime_to_opcua()
+                with self._cycle_lock:
+                    if not self._paused:
+                        await self._sync_cycle()
 
                 # Wait for next cycle
                 await asyncio.sleep(cycle_time_seconds)
@@ -262,6 +320,26 @@ class SynchronizationManager:
 
         log_info("Sync loop stopped")
 
+    async def _sync_cycle(self) -> None:
+        """
+        Run one sync cycle in both directions.
+
+        Called with _cycle_lock held and the sync not paused.
+        """
+        if self._program_changed:
+            self._program_changed = False
+            log_info("PLC program changed online, refreshing variable metadata")
+            await self._reinitialize_metadata()
+
+        # Capture cycle timestamp for subscription notifications
+        self._cycle_timestamp = datetime.now(timezone.utc)
+
+        # Direction 1: OPC-UA → Runtime
+        await self.sync_opcua_to_runtime()
+
+        # Direction 2: Runtime → OPC-UA
+        await self.sync_runtime_to_opcua()
+
     async def sync_opcua_to_runtime(self) -> None:
         """
         Synchronize values from OPC-UA readwrite nodes to PLC runtime.
@@ -359,7 +437,9 @@ class SynchronizationManager:
             if not self.variable_nodes:
                 return
 
-            if self._direct_memory_access_enabled and self.variable_metadata:
+            if self._access_plan is not None:
+                await self._update_via_access_plan()
+            elif self._direct_memory_access_enabled and self.variable_metadata:
                 await self._update_via_direct_memory_access()
             else:
                 await self._update_via_batch_operations()
@@ -367,6 +447,61 @@ class SynchronizationManager:
         except Exception as e:
             log_error(f"Error in runtime to OPC-UA sync: {e}")
 
+    async def _update_via_access_plan(self) -> None:
+        """
+        Update OPC-UA nodes by executing the precompiled access plan.
+
+        Each datatype group is read in one pass through its typed views and
+        written with its precomputed variant type.
+        """
+        plan = self._access_plan
+
+        for group in plan.groups.values():
+            try:
+                values = group.read_values()
+            except Exception as e:
+                log_error(f"Access plan read failed for {group.datatype} group: {e}")
+                continue
+
+            variant_type = group.variant_type
+            for node_id, var_node, value in zip(group.node_ids, group.nodes, values):
+                await self._write_node_value(
+                    var_node,
+                    node_id,
+                    ua.Variant(value, variant_type or map_plc_to_opcua_type(var_node.datatype))
+                )
+
+        for array in plan.arrays:
+            try:
+                values = array.read_values()
+            except Exception as e:
+                log_error(f"Access plan read failed for array {array.node.debug_var_index}: {e}")
+                continue
+            await self._write_node_value(array.node, array.node_id, ua.Variant(values, array.variant_type))
+
+        for var_index, var_node in plan.unplanned.items():
+            val, msg = self.buffer_accessor.get_var_value(var_index)
+            if msg == "Success" and val is not None:
+                await self._update_opcua_node(var_node, val)
+
+    async def _write_node_value(self, var_node: VariableNode, node_id: Any, variant: ua.Variant) -> None:
+        """Write a prepared Variant to a node with cycle timestamps."""
+        try:
+            data_value = ua.DataValue(
+                Value=variant,
+                StatusCode_=ua.StatusCode(ua.StatusCodes.Good),
+                SourceTimestamp=self._cycle_timestamp,
+                ServerTimestamp=datetime.now(timezone.utc)
+            )
+
+            if self.server:
+                await self.server.write_attribute_value(node_id, data_value)
+            else:
+                await var_node.node.write_value(variant)
+
+        except Exception as e:
+            log_error(f"Failed to update OPC-UA node {var_node.debug_var_index}: {e}")
+
     async def _update_via_direct_memory_access(self) -> None:
         """
         Update OPC-UA nodes using direct memory access.
@@ -61,6 +61,12 @@ class PluginRuntimeArgs(ctypes.Structure):
         ("journal_write_int", ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int)),
         ("journal_write_dint", ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_uint)),
         ("journal_write_lint", ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_ulonglong)),
+        # int (*func)(const plugin_journal_range_t *ranges, int range_count)
+        ("journal_write_ranges", ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_int)),
+        # Runtime clock, virtual in free-run mode
+        ("get_time_ns", ctypes.CFUNCTYPE(ctypes.c_uint64)),
+        # int (*func)(const char *name): run an event task of the program
+        ("raise_event", ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_char_p)),
     ]
 
     def validate_pointers(self):
@@ -27,6 +27,8 @@ typedef struct
     PyObject *pFuncStart;
     PyObject *pFuncStop;
     PyObject *pFuncCleanup;
+    PyObject *pFuncProgramChanging;
+    PyObject *pFuncProgramChanged;
     PyObject *args_capsule; // Capsule containing plugin_runtime_args_t for lifetime management
 } python_binds_t;
 
@@ -19,76 +19,58 @@
 // This is the file for the network routines of the OpenPLC. It has procedures
 // to create a socket and connect to a server. These functions are called by
 // the TCP communication function blocks (TCP_CONNECT, TCP_SEND, TCP_RECEIVE,
-// TCP_CLOSE) defined in communication.h.
+// TCP_CLOSE) defined in communication.h. Connections are established by the
+// connection manager in tcp_connection_manager.c, and data is moved between
+// the socket and per-socket ring buffers by the I/O thread in tcp_socket_io.c.
 // Thiago Alves, Nov 2022
 //-----------------------------------------------------------------------------
 
-#include <arpa/inet.h>
 #include <errno.h>
-#include <fcntl.h>
-#include <netdb.h>
 #include <stdint.h>
 #include <string.h>
-#include <sys/socket.h>
 #include <unistd.h>
 
+#include "tcp_connection_manager.h"
+#include "tcp_socket_io.h"
 #include "utils/log.h"
 
-#define METHOD_UDP 1
-#define METHOD_TCP 0
-
 int connect_to_tcp_server(uint8_t *ip_address, uint16_t port, int method)
 {
-    int sockfd;
-    struct sockaddr_in servaddr;
-
-    if (method == METHOD_TCP)
-        sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    else if (method == METHOD_UDP)
-        sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-    else
+    if (method != TCP_CONNECT_METHOD_TCP && method != TCP_CONNECT_METHOD_UDP)
         return -1;
 
-    if (sockfd == -1)
+    // TCP_CONNECT runs on the PLC cycle thread, so never wait for the network
+    // here: the first call hands the connect to the connection manager, later
+    // calls for the same server return the socket once it is connected.
+    const char *ip = (const char *)ip_address;
+    int handle     = tcp_connect_find(ip, port, method);
+    if (handle < 0)
     {
-        log_error("TCP Client: error creating socket => %s", strerror(errno));
-        return -1;
+        handle = tcp_connect_submit(ip, port, method);
+        if (handle < 0)
+        {
+            return -1;
+        }
     }
-    memset(&servaddr, 0, sizeof(servaddr));
-
-    // Configure socket
-    servaddr.sin_family = AF_INET;
-    servaddr.sin_addr.s_addr = inet_addr((const char *)ip_address);
-    servaddr.sin_port = htons(port);
 
-    // Connect to server
-    if (connect(sockfd, (struct sockaddr *)&servaddr, sizeof(servaddr)) != 0)
-    {
-        log_error("TCP Client: error connecting to server => %s", strerror(errno));
-        close(sockfd);
-        return -1;
-    }
-
-    // Set non-blocking socket
-    int flags = fcntl(sockfd, F_GETFL, 0);
-    if (flags == -1)
-    {
-        log_error("TCP Client: error reading flags from socket => %s", strerror(errno));
-        return -1;
-    }
-    flags = (flags | O_NONBLOCK);
-    if (fcntl(sockfd, F_SETFL, flags) != 0)
+    int sockfd;
+    if (tcp_connect_poll(handle, &sockfd) == TCP_CONNECT_CONNECTED)
     {
-        log_error("TCP Client: error setting flags for socket => %s", strerror(errno));
-        return -1;
+        return sockfd;
     }
-
-    return sockfd;
+    return -1;
 }
 
 int send_tcp_message(uint8_t *msg, size_t msg_size, int socket_id)
 {
-    int bytes_sent = write(socket_id, msg, msg_size);
+    // Managed sockets only queue the message, the I/O thread sends it
+    int bytes_sent = tcp_socket_io_send(socket_id, msg, msg_size);
+    if (bytes_sent != TCP_SOCKET_IO_UNMANAGED)
+    {
+        return bytes_sent;
+    }
+
+    bytes_sent = write(socket_id, msg, msg_size);
     if (bytes_sent < 0)
     {
         log_error("TCP Client: error sending msg to server => %s", strerror(errno));
@@ -100,7 +82,11 @@ int send_tcp_message(uint8_t *msg, size_t msg_size, int socket_id)
 
 int receive_tcp_message(uint8_t *msg_buffer, size_t buffer_size, int socket_id)
 {
-    int bytes_received = read(socket_id, msg_buffer, buffer_size);
+    int bytes_received = tcp_socket_io_receive(socket_id, msg_buffer, buffer_size);
+    if (bytes_received == TCP_SOCKET_IO_UNMANAGED)
+    {
+        bytes_received = read(socket_id, msg_buffer, buffer_size);
+    }
 
     if (bytes_received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
     {
@@ -116,5 +102,9 @@ int receive_tcp_message(uint8_t *msg_buffer, size_t buffer_size, int socket_id)
 
 int close_tcp_connection(int socket_id)
 {
+    if (tcp_socket_io_close(socket_id) == 0)
+    {
+        return 0;
+    }
     return close(socket_id);
 }
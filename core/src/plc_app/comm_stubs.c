@@ -0,0 +1,39 @@
+// TCP/UDP communication blocks for the offline runner
+//
+// Same symbols as client_tcp_udp.c, but every operation fails. Profiled
+// programs run against these, so a training run never opens connections to
+// real field devices and never waits for a connection manager that is not
+// running. The blocks see the same errors as with an unreachable peer.
+
+#include <stddef.h>
+#include <stdint.h>
+
+int connect_to_tcp_server(uint8_t *ip_address, uint16_t port, int method)
+{
+    (void)ip_address;
+    (void)port;
+    (void)method;
+    return -1;
+}
+
+int send_tcp_message(uint8_t *msg, size_t msg_size, int socket_id)
+{
+    (void)msg;
+    (void)msg_size;
+    (void)socket_id;
+    return -1;
+}
+
+int receive_tcp_message(uint8_t *msg_buffer, size_t buffer_size, int socket_id)
+{
+    (void)msg_buffer;
+    (void)buffer_size;
+    (void)socket_id;
+    return -1;
+}
+
+int close_tcp_connection(int socket_id)
+{
+    (void)socket_id;
+    return -1;
+}
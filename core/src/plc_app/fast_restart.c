@@ -0,0 +1,155 @@
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <link.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fast_restart.h"
+#include "utils/log.h"
+
+typedef struct
+{
+    uintptr_t start;
+    size_t size;
+    void *copy;
+} data_segment_t;
+
+static data_segment_t segments[FAST_RESTART_MAX_SEGMENTS];
+static int segment_count = 0;
+
+// dl_iterate_phdr() state: find the object holding the address, then its writable ranges
+typedef struct
+{
+    uintptr_t address;
+    data_segment_t found[FAST_RESTART_MAX_SEGMENTS];
+    int count;
+    bool matched;
+} segment_search_t;
+
+static int find_segments(struct dl_phdr_info *info, size_t size, void *data)
+{
+    (void)size;
+    segment_search_t *search = data;
+
+    bool contains       = false;
+    uintptr_t relro_end = 0;
+    for (int i = 0; i < info->dlpi_phnum; i++)
+    {
+        const ElfW(Phdr) *ph = &info->dlpi_phdr[i];
+        uintptr_t start      = info->dlpi_addr + ph->p_vaddr;
+        if (ph->p_type == PT_LOAD && search->address >= start &&
+            search->address < start + ph->p_memsz)
+        {
+            contains = true;
+        }
+        if (ph->p_type == PT_GNU_RELRO)
+        {
+            // The loader protects whole pages only
+            uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+            relro_end      = (start + ph->p_memsz) & ~(page - 1);
+        }
+    }
+    if (!contains)
+    {
+        return 0;
+    }
+
+    search->matched = true;
+    for (int i = 0; i < info->dlpi_phnum; i++)
+    {
+        const ElfW(Phdr) *ph = &info->dlpi_phdr[i];
+        if (ph->p_type != PT_LOAD || !(ph->p_flags & PF_W))
+        {
+            continue;
+        }
+
+        uintptr_t start = info->dlpi_addr + ph->p_vaddr;
+        uintptr_t end   = start + ph->p_memsz;
+        if (start < relro_end)
+        {
+            start = relro_end < end ? relro_end : end;
+        }
+        if (start == end)
+        {
+            continue;
+        }
+        if (search->count == FAST_RESTART_MAX_SEGMENTS)
+        {
+            search->matched = false;
+            break;
+        }
+        search->found[search->count].start = start;
+        search->found[search->count].size  = end - start;
+        search->count++;
+    }
+    return 1;
+}
+
+int fast_restart_snapshot(PluginManager *pm)
+{
+    fast_restart_release();
+
+    void *symbol = plugin_manager_get_symbol(pm, "config_init__");
+    if (symbol == NULL)
+    {
+        return -1;
+    }
+
+    segment_search_t search;
+    memset(&search, 0, sizeof(search));
+    search.address = (uintptr_t)symbol;
+    dl_iterate_phdr(find_segments, &search);
+    if (!search.matched || search.count == 0)
+    {
+        log_error("Fast restart: writable segments of the PLC program not found");
+        return -1;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < search.count; i++)
+    {
+        search.found[i].copy = malloc(search.found[i].size);
+        if (search.found[i].copy == NULL)
+        {
+            for (int j = 0; j < i; j++)
+            {
+                free(search.found[j].copy);
+            }
+            log_error("Fast restart: no memory for a %zu byte snapshot", search.found[i].size);
+            return -1;
+        }
+        memcpy(search.found[i].copy, (const void *)search.found[i].start, search.found[i].size);
+        total += search.found[i].size;
+    }
+
+    memcpy(segments, search.found, sizeof(segments));
+    segment_count = search.count;
+    log_info("Fast restart: %zu bytes of program data saved in %d segments", total,
+             segment_count);
+    return 0;
+}
+
+bool fast_restart_available(void)
+{
+    return segment_count > 0;
+}
+
+void fast_restart_restore(void)
+{
+    for (int i = 0; i < segment_count; i++)
+    {
+        memcpy((void *)segments[i].start, segments[i].copy, segments[i].size);
+    }
+}
+
+void fast_restart_release(void)
+{
+    for (int i = 0; i < segment_count; i++)
+    {
+        free(segments[i].copy);
+    }
+    memset(segments, 0, sizeof(segments));
+    segment_count = 0;
+}
@@ -0,0 +1,47 @@
+#ifndef FAST_RESTART_H
+#define FAST_RESTART_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "plcapp_manager.h"
+
+// Writable PT_LOAD segments of a program; more are not expected from the linker
+#define FAST_RESTART_MAX_SEGMENTS 4
+
+/**
+ * @brief Snapshot the writable data of the loaded program
+ *
+ * Copies the writable PT_LOAD segments of the program library (.data,
+ * .bss and the writable part of the GOT) right after config_init__() and
+ * glueVars(), so a crashed program can later restart from its initial state
+ * without dlclose()/dlopen(). The RELRO part is skipped; the dynamic loader
+ * made it read-only after relocation.
+ *
+ * @param pm  The loaded program
+ * @return 0 on success, -1 if the program's segments cannot be found
+ *
+ * @note Called by the PLC cycle thread when it initializes the program.
+ */
+int fast_restart_snapshot(PluginManager *pm);
+
+/**
+ * @brief Whether a snapshot of the current program exists
+ */
+bool fast_restart_available(void);
+
+/**
+ * @brief Write the snapshot back over the program's writable data
+ *
+ * @note Only call while no thread runs program code.
+ */
+void fast_restart_restore(void);
+
+/**
+ * @brief Drop the snapshot
+ *
+ * @note Called when the program is unloaded or an online change replaced it.
+ */
+void fast_restart_release(void);
+
+#endif // FAST_RESTART_H
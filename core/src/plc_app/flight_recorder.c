@@ -0,0 +1,487 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "flight_recorder.h"
+#include "image_tables.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+
+// Tag, index, bit and the widest value
+#define MAX_RECORD_SIZE 12
+
+typedef struct
+{
+    bool enabled;
+    char path[256];
+    unsigned int size_mb;
+
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    flight_record_header_t *header;
+    uint8_t *records;
+    size_t capacity;
+    size_t used;
+
+    bool active;
+    uint32_t pending_scans; // Scans executed but not yet covered by a RUN record
+
+    flight_record_output_t *outputs;
+    uint64_t *last_values; // Output values as of the last recorded scan
+    int num_outputs;
+} flight_recorder_t;
+
+static flight_recorder_t recorder = {
+    .size_mb = FLIGHT_RECORDER_DEFAULT_SIZE_MB,
+    .fd      = -1,
+};
+
+void flight_recorder_configure(const char *path, unsigned int size_mb)
+{
+    if (path != NULL)
+    {
+        recorder.enabled = true;
+        snprintf(recorder.path, sizeof(recorder.path), "%s", path);
+    }
+    if (size_mb > 0)
+    {
+        recorder.size_mb = size_mb;
+    }
+}
+
+bool flight_recorder_enabled(void)
+{
+    return recorder.enabled;
+}
+
+size_t flight_record_value_size(journal_buffer_type_t type)
+{
+    switch (type)
+    {
+    case JOURNAL_INT_INPUT:
+    case JOURNAL_INT_OUTPUT:
+    case JOURNAL_INT_MEMORY:
+        return sizeof(IEC_UINT);
+    case JOURNAL_DINT_INPUT:
+    case JOURNAL_DINT_OUTPUT:
+    case JOURNAL_DINT_MEMORY:
+        return sizeof(IEC_UDINT);
+    case JOURNAL_LINT_INPUT:
+    case JOURNAL_LINT_OUTPUT:
+    case JOURNAL_LINT_MEMORY:
+        return sizeof(IEC_ULINT);
+    default:
+        return 1;
+    }
+}
+
+bool flight_record_has_bit(journal_buffer_type_t type)
+{
+    return type == JOURNAL_BOOL_INPUT || type == JOURNAL_BOOL_OUTPUT ||
+           type == JOURNAL_BOOL_MEMORY;
+}
+
+size_t flight_record_decode_run(const uint8_t *p, const uint8_t *end, uint32_t *scans)
+{
+    if (end - p < FLIGHT_RECORD_RUN_SIZE || p[0] != FLIGHT_RECORD_RUN)
+    {
+        return 0;
+    }
+
+    *scans = (uint32_t)p[1] | ((uint32_t)p[2] << 8) | ((uint32_t)p[3] << 16) |
+             ((uint32_t)p[4] << 24);
+    return FLIGHT_RECORD_RUN_SIZE;
+}
+
+size_t flight_record_value_record_size(const uint8_t *p, const uint8_t *end)
+{
+    journal_buffer_type_t type = (journal_buffer_type_t)(p[0] & ~FLIGHT_RECORD_KIND_MASK);
+    if (type >= JOURNAL_TYPE_COUNT)
+    {
+        return 0;
+    }
+
+    size_t size = 3 + (flight_record_has_bit(type) ? 1 : 0) + flight_record_value_size(type);
+    return (size_t)(end - p) >= size ? size : 0;
+}
+
+void flight_record_decode_value(const uint8_t *p, journal_buffer_type_t *type, uint16_t *index,
+                                uint8_t *bit, uint64_t *value)
+{
+    *type  = (journal_buffer_type_t)(p[0] & ~FLIGHT_RECORD_KIND_MASK);
+    *index = (uint16_t)(p[1] | (p[2] << 8));
+    p += 3;
+
+    *bit = 0;
+    if (flight_record_has_bit(*type))
+    {
+        *bit = *p++;
+    }
+
+    *value = 0;
+    for (size_t i = 0; i < flight_record_value_size(*type); i++)
+    {
+        *value |= (uint64_t)p[i] << (8 * i);
+    }
+}
+
+void *flight_record_location(journal_buffer_type_t type, uint16_t index, uint8_t bit)
+{
+    if (index >= BUFFER_SIZE || bit > 7)
+    {
+        return NULL;
+    }
+
+    switch (type)
+    {
+    case JOURNAL_BOOL_INPUT:
+        return bool_input[index][bit];
+    case JOURNAL_BOOL_OUTPUT:
+        return bool_output[index][bit];
+    case JOURNAL_BOOL_MEMORY:
+        return bool_memory[index][bit];
+    case JOURNAL_BYTE_INPUT:
+        return byte_input[index];
+    case JOURNAL_BYTE_OUTPUT:
+        return byte_output[index];
+    case JOURNAL_INT_INPUT:
+        return int_input[index];
+    case JOURNAL_INT_OUTPUT:
+        return int_output[index];
+    case JOURNAL_INT_MEMORY:
+        return int_memory[index];
+    case JOURNAL_DINT_INPUT:
+        return dint_input[index];
+    case JOURNAL_DINT_OUTPUT:
+        return dint_output[index];
+    case JOURNAL_DINT_MEMORY:
+        return dint_memory[index];
+    case JOURNAL_LINT_INPUT:
+        return lint_input[index];
+    case JOURNAL_LINT_OUTPUT:
+        return lint_output[index];
+    case JOURNAL_LINT_MEMORY:
+        return lint_memory[index];
+    default:
+        return NULL;
+    }
+}
+
+uint64_t flight_record_load(const void *addr, journal_buffer_type_t type)
+{
+    switch (flight_record_value_size(type))
+    {
+    case sizeof(IEC_UINT):
+        return *(const IEC_UINT *)addr;
+    case sizeof(IEC_UDINT):
+        return *(const IEC_UDINT *)addr;
+    case sizeof(IEC_ULINT):
+        return *(const IEC_ULINT *)addr;
+    default:
+        return *(const uint8_t *)addr;
+    }
+}
+
+void flight_record_store(void *addr, journal_buffer_type_t type, uint64_t value)
+{
+    switch (flight_record_value_size(type))
+    {
+    case sizeof(IEC_UINT):
+        *(IEC_UINT *)addr = (IEC_UINT)value;
+        break;
+    case sizeof(IEC_UDINT):
+        *(IEC_UDINT *)addr = (IEC_UDINT)value;
+        break;
+    case sizeof(IEC_ULINT):
+        *(IEC_ULINT *)addr = (IEC_ULINT)value;
+        break;
+    default:
+        // Same masking as the journal
+        *(uint8_t *)addr = flight_record_has_bit(type) ? (uint8_t)(value & 1) : (uint8_t)value;
+        break;
+    }
+}
+
+int flight_record_bind_outputs(flight_record_output_t **outputs)
+{
+    static const struct
+    {
+        int view;
+        journal_buffer_type_t type;
+    } output_tables[] = {
+        {1, JOURNAL_BOOL_OUTPUT}, {3, JOURNAL_BYTE_OUTPUT}, {5, JOURNAL_INT_OUTPUT},
+        {7, JOURNAL_DINT_OUTPUT}, {9, JOURNAL_LINT_OUTPUT},
+    };
+
+    image_table_view_t views[IMAGE_TABLE_COUNT];
+    image_tables_get_views(NULL, views);
+
+    // Located outputs are the slots that do not point into the temporary backing storage
+    size_t capacity = 0;
+    for (size_t t = 0; t < sizeof(output_tables) / sizeof(output_tables[0]); t++)
+    {
+        capacity += views[output_tables[t].view].count;
+    }
+    flight_record_output_t *list = malloc(capacity * sizeof(*list));
+    if (list == NULL)
+    {
+        return -1;
+    }
+
+    int count = 0;
+    for (size_t t = 0; t < sizeof(output_tables) / sizeof(output_tables[0]); t++)
+    {
+        image_table_view_t *view = &views[output_tables[t].view];
+        bool has_bit             = flight_record_has_bit(output_tables[t].type);
+        uint8_t *backing_end     = view->backing + view->count * view->elem_size;
+        for (size_t i = 0; i < view->count; i++)
+        {
+            uint8_t *ptr = view->slots[i];
+            if (ptr == NULL || (ptr >= view->backing && ptr < backing_end))
+            {
+                continue;
+            }
+            list[count].type  = output_tables[t].type;
+            list[count].index = (uint16_t)(has_bit ? i / 8 : i);
+            list[count].bit   = (uint8_t)(has_bit ? i % 8 : 0);
+            list[count].addr  = ptr;
+            count++;
+        }
+    }
+
+    *outputs = list;
+    return count;
+}
+
+static void append(const uint8_t *record, size_t size)
+{
+    if (recorder.used + size > recorder.capacity)
+    {
+        // Keep what was recorded so far. The apply hook may be running with the
+        // journal mutex held, so it stays installed and checks active instead.
+        recorder.active            = false;
+        recorder.header->truncated = 1;
+        log_warn("Flight recorder: %s is full, recording stopped", recorder.path);
+        return;
+    }
+
+    memcpy(recorder.records + recorder.used, record, size);
+    recorder.used += size;
+    recorder.header->used = recorder.used;
+}
+
+static void append_run(uint32_t scans)
+{
+    uint8_t record[FLIGHT_RECORD_RUN_SIZE] = {FLIGHT_RECORD_RUN, (uint8_t)scans,
+                                              (uint8_t)(scans >> 8), (uint8_t)(scans >> 16),
+                                              (uint8_t)(scans >> 24)};
+    append(record, sizeof(record));
+    if (recorder.active)
+    {
+        recorder.header->scans += scans;
+    }
+}
+
+static void append_value(uint8_t kind, journal_buffer_type_t type, uint16_t index, uint8_t bit,
+                         uint64_t value)
+{
+    uint8_t record[MAX_RECORD_SIZE];
+    size_t size = 0;
+
+    record[size++] = kind | (uint8_t)type;
+    record[size++] = (uint8_t)index;
+    record[size++] = (uint8_t)(index >> 8);
+    if (flight_record_has_bit(type))
+    {
+        record[size++] = bit;
+    }
+    for (size_t i = 0; i < flight_record_value_size(type); i++)
+    {
+        record[size++] = (uint8_t)(value >> (8 * i));
+    }
+    append(record, size);
+}
+
+static void flush_pending_scans(void)
+{
+    if (recorder.pending_scans > 0)
+    {
+        append_run(recorder.pending_scans);
+        recorder.pending_scans = 0;
+    }
+}
+
+/**
+ * @brief Journal apply hook, called with buffer_mutex held
+ */
+static void record_entry(const journal_entry_t *entry)
+{
+    if (!recorder.active)
+    {
+        return;
+    }
+
+    // The write belongs to the scan after all scans executed so far
+    flush_pending_scans();
+    if (recorder.active)
+    {
+        append_value(FLIGHT_RECORD_WRITE, (journal_buffer_type_t)entry->buffer_type, entry->index,
+                     entry->bit_index, entry->value);
+    }
+}
+
+void flight_recorder_scan_end(void)
+{
+    if (!recorder.active)
+    {
+        return;
+    }
+
+    bool changed = false;
+    for (int i = 0; i < recorder.num_outputs && recorder.active; i++)
+    {
+        flight_record_output_t *output = &recorder.outputs[i];
+        uint64_t value                 = flight_record_load(output->addr, output->type);
+        if (value == recorder.last_values[i])
+        {
+            continue;
+        }
+        if (!changed)
+        {
+            append_run(recorder.pending_scans + 1);
+            recorder.pending_scans = 0;
+            changed                = true;
+        }
+        append_value(FLIGHT_RECORD_OUTPUT, output->type, output->index, output->bit, value);
+        recorder.last_values[i] = value;
+    }
+
+    if (!changed && ++recorder.pending_scans == FLIGHT_RECORD_MAX_RUN)
+    {
+        flush_pending_scans();
+    }
+}
+
+static void release_recorder(void)
+{
+    if (recorder.map != NULL)
+    {
+        munmap(recorder.map, recorder.map_size);
+        recorder.map = NULL;
+    }
+    if (recorder.fd >= 0)
+    {
+        close(recorder.fd);
+        recorder.fd = -1;
+    }
+    free(recorder.outputs);
+    free(recorder.last_values);
+    recorder.outputs     = NULL;
+    recorder.last_values = NULL;
+    recorder.num_outputs = 0;
+}
+
+int flight_recorder_open(void)
+{
+    if (!recorder.enabled)
+    {
+        return 0;
+    }
+
+    recorder.num_outputs = flight_record_bind_outputs(&recorder.outputs);
+    if (recorder.num_outputs < 0)
+    {
+        recorder.num_outputs = 0;
+        return -1;
+    }
+    recorder.last_values = calloc((size_t)recorder.num_outputs + 1, sizeof(uint64_t));
+    if (recorder.last_values == NULL)
+    {
+        release_recorder();
+        return -1;
+    }
+    for (int i = 0; i < recorder.num_outputs; i++)
+    {
+        recorder.last_values[i] =
+            flight_record_load(recorder.outputs[i].addr, recorder.outputs[i].type);
+    }
+
+    recorder.map_size = (size_t)recorder.size_mb * 1024 * 1024;
+    recorder.fd       = open(recorder.path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (recorder.fd < 0 || ftruncate(recorder.fd, (off_t)recorder.map_size) != 0)
+    {
+        log_error("Flight recorder: failed to create %s: %s", recorder.path, strerror(errno));
+        release_recorder();
+        return -1;
+    }
+
+    // Populate the pages now, so the cycle thread does not fault them in
+    recorder.map = mmap(NULL, recorder.map_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, recorder.fd, 0);
+    if (recorder.map == MAP_FAILED)
+    {
+        log_error("Flight recorder: failed to map %s: %s", recorder.path, strerror(errno));
+        recorder.map = NULL;
+        release_recorder();
+        return -1;
+    }
+
+    recorder.header = (flight_record_header_t *)recorder.map;
+    memset(recorder.header, 0, sizeof(*recorder.header));
+    recorder.header->magic   = FLIGHT_RECORD_MAGIC;
+    recorder.header->version = FLIGHT_RECORD_VERSION;
+    snprintf(recorder.header->program_md5, sizeof(recorder.header->program_md5), "%s",
+             ext_plc_program_md5 ? ext_plc_program_md5 : "");
+    recorder.header->ticktime_ns = ext_common_ticktime__ ? *ext_common_ticktime__ : 0;
+    recorder.records             = recorder.map + sizeof(*recorder.header);
+    recorder.capacity            = recorder.map_size - sizeof(*recorder.header);
+    recorder.header->capacity    = recorder.capacity;
+    recorder.used                = 0;
+    recorder.pending_scans       = 0;
+    recorder.active              = true;
+
+    journal_set_apply_hook(record_entry);
+    log_info("Flight recorder: recording to %s (%u MiB, %d located outputs)", recorder.path,
+             recorder.size_mb, recorder.num_outputs);
+    return 0;
+}
+
+void flight_recorder_stop(void)
+{
+    journal_set_apply_hook(NULL);
+    if (recorder.active)
+    {
+        flush_pending_scans();
+        recorder.active = false;
+    }
+}
+
+void flight_recorder_close(void)
+{
+    if (recorder.map == NULL)
+    {
+        return;
+    }
+
+    flight_recorder_stop();
+
+    // Shrink the file to the records actually written
+    size_t size = sizeof(flight_record_header_t) + recorder.used;
+    unsigned long long scans = recorder.header->scans;
+    msync(recorder.map, recorder.map_size, MS_SYNC);
+    munmap(recorder.map, recorder.map_size);
+    recorder.map = NULL;
+    if (ftruncate(recorder.fd, (off_t)size) != 0)
+    {
+        log_error("Flight recorder: failed to truncate %s: %s", recorder.path, strerror(errno));
+    }
+    release_recorder();
+
+    log_info("Flight recorder: %llu scans in %zu bytes written to %s", scans, size,
+             recorder.path);
+}
@@ -0,0 +1,172 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "journal_buffer.h"
+
+#define FLIGHT_RECORDER_DEFAULT_SIZE_MB 64
+
+#define FLIGHT_RECORD_MAGIC 0x43455246U // "FREC"
+#define FLIGHT_RECORD_VERSION 1U
+
+/*
+ * File layout:
+ *   flight_record_header_t
+ *   records, packed, in the order they happened
+ *
+ * Records start with a tag byte:
+ *   FLIGHT_RECORD_RUN                 uint32 n: n scans were executed
+ *   FLIGHT_RECORD_WRITE | type        journal entry applied before the next scan
+ *   FLIGHT_RECORD_OUTPUT | type       output value after the last scan
+ *
+ * WRITE and OUTPUT records continue with a uint16 index, a uint8 bit for BOOL
+ * types and the value in the width of the type (1, 1, 2, 4 or 8 bytes), all
+ * little endian and unaligned. A scan only gets a RUN record of its own when
+ * it changed an output or writes arrived after it; other scans are folded
+ * into the next RUN count, up to FLIGHT_RECORD_MAX_RUN scans. OUTPUT records
+ * follow the RUN of the scan that produced them.
+ */
+#define FLIGHT_RECORD_RUN 0x00
+#define FLIGHT_RECORD_WRITE 0x10
+#define FLIGHT_RECORD_OUTPUT 0x20
+#define FLIGHT_RECORD_KIND_MASK 0xF0
+
+#define FLIGHT_RECORD_RUN_SIZE 5
+
+// Scans folded into one RUN record before it is written out
+#ifndef FLIGHT_RECORD_MAX_RUN
+#define FLIGHT_RECORD_MAX_RUN (UINT32_MAX - 1)
+#endif
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    char program_md5[40]; // Program build that was recorded
+    uint64_t ticktime_ns; // Task period of the program
+    uint64_t capacity;    // Bytes available for records
+    uint64_t used;        // Bytes of records written
+    uint64_t scans;       // Scans covered by the records
+    uint32_t truncated;   // Recording stopped because the file was full
+    uint32_t reserved;
+} flight_record_header_t;
+
+/**
+ * @brief Located output of the loaded program, compared by the replay tool
+ */
+typedef struct
+{
+    journal_buffer_type_t type;
+    uint16_t index;
+    uint8_t bit;
+    void *addr;
+} flight_record_output_t;
+
+/**
+ * @brief Enable the flight recorder
+ *
+ * @param path     Recording file, overwritten on every program start
+ * @param size_mb  File size in MiB, or 0 to keep the current one
+ */
+void flight_recorder_configure(const char *path, unsigned int size_mb);
+
+/**
+ * @brief Whether a recording file was configured
+ */
+bool flight_recorder_enabled(void);
+
+/**
+ * @brief Start recording the loaded program
+ *
+ * Every journal entry applied to the image tables and every change of a
+ * located output is appended to the memory-mapped recording, until it is
+ * full or the program stops.
+ *
+ * @note Call after the image tables are filled and before plugins start.
+ * @return 0 on success or if the recorder is disabled, -1 on failure
+ */
+int flight_recorder_open(void);
+
+/**
+ * @brief Record the outputs of the scan that just executed
+ *
+ * @note Called by the PLC cycle thread after ext_config_run__() with buffer_mutex held.
+ */
+void flight_recorder_scan_end(void);
+
+/**
+ * @brief Stop recording, e.g. when an online change replaces the program
+ *
+ * @note Called by the PLC cycle thread with buffer_mutex held.
+ */
+void flight_recorder_stop(void);
+
+/**
+ * @brief Finish the recording and unmap it
+ *
+ * @note Call once the PLC cycle thread has exited.
+ */
+void flight_recorder_close(void);
+
+/**
+ * @brief Size of the value of a WRITE or OUTPUT record
+ */
+size_t flight_record_value_size(journal_buffer_type_t type);
+
+/**
+ * @brief Whether records of a type carry a bit number
+ */
+bool flight_record_has_bit(journal_buffer_type_t type);
+
+/**
+ * @brief Decode the RUN record at p
+ *
+ * @param[out] scans  Scans covered by the record
+ * @return Size of the record, or 0 if it is not a RUN record or truncated
+ */
+size_t flight_record_decode_run(const uint8_t *p, const uint8_t *end, uint32_t *scans);
+
+/**
+ * @brief Size of the WRITE or OUTPUT record at p
+ *
+ * @return The size, or 0 if the record is invalid or truncated
+ */
+size_t flight_record_value_record_size(const uint8_t *p, const uint8_t *end);
+
+/**
+ * @brief Decode a WRITE or OUTPUT record checked with flight_record_value_record_size()
+ */
+void flight_record_decode_value(const uint8_t *p, journal_buffer_type_t *type, uint16_t *index,
+                                uint8_t *bit, uint64_t *value);
+
+/**
+ * @brief Address a location of the global image tables points to
+ *
+ * @return The address, or NULL if the location is out of range
+ */
+void *flight_record_location(journal_buffer_type_t type, uint16_t index, uint8_t bit);
+
+/**
+ * @brief Read the value at a location, zero-extended
+ */
+uint64_t flight_record_load(const void *addr, journal_buffer_type_t type);
+
+/**
+ * @brief Write a value to a location, masked like a journal write
+ */
+void flight_record_store(void *addr, journal_buffer_type_t type, uint64_t value);
+
+/**
+ * @brief List the outputs the loaded program located
+ *
+ * @param[out] outputs  Array allocated with malloc, to be freed by the caller
+ * @return Number of outputs, or -1 if out of memory
+ *
+ * @note Call after ext_glueVars() and image_tables_fill_null_pointers().
+ */
+int flight_record_bind_outputs(flight_record_output_t **outputs);
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,128 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "free_run.h"
+#include "input_script.h"
+#include "journal_buffer.h"
+#include "utils/log.h"
+
+static bool enabled              = false;
+static unsigned long scan_limit  = 0;
+static const char *input_script  = NULL;
+static uint64_t virtual_start_ns = 0;
+static uint64_t real_start_ns    = 0;
+
+// Read by the statistics and plugin threads while the cycle thread advances them
+static atomic_uint_least64_t virtual_ns;
+static atomic_ulong scans;
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void free_run_configure(bool enable, unsigned long scan_count, const char *script)
+{
+    enabled      = enable;
+    scan_limit   = scan_count;
+    input_script = script;
+}
+
+bool free_run_enabled(void)
+{
+    return enabled;
+}
+
+int free_run_start(void)
+{
+    atomic_store(&scans, 0);
+    real_start_ns    = monotonic_ns();
+    virtual_start_ns = real_start_ns;
+    atomic_store(&virtual_ns, virtual_start_ns);
+
+    if (input_script != NULL && input_script_load(input_script) != 0)
+    {
+        return -1;
+    }
+
+    log_info("Free-run mode: scans run back to back on virtual time");
+    return 0;
+}
+
+/**
+ * @brief Write a scripted input through the journal, like a plugin would
+ */
+static void journal_input(char area, int index, int bit, uint64_t value)
+{
+    switch (area)
+    {
+    case 'X':
+        journal_write_bool(JOURNAL_BOOL_INPUT, (uint16_t)index, (uint8_t)bit, value != 0);
+        break;
+    case 'B':
+        journal_write_byte(JOURNAL_BYTE_INPUT, (uint16_t)index, (uint8_t)value);
+        break;
+    case 'W':
+        journal_write_int(JOURNAL_INT_INPUT, (uint16_t)index, (uint16_t)value);
+        break;
+    case 'D':
+        journal_write_dint(JOURNAL_DINT_INPUT, (uint16_t)index, (uint32_t)value);
+        break;
+    default:
+        journal_write_lint(JOURNAL_LINT_INPUT, (uint16_t)index, value);
+        break;
+    }
+}
+
+void free_run_apply_inputs(void)
+{
+    if (input_script_loaded())
+    {
+        input_script_apply(atomic_load(&scans), journal_input);
+    }
+}
+
+bool free_run_advance(uint64_t ticktime_ns)
+{
+    atomic_fetch_add(&virtual_ns, ticktime_ns);
+    unsigned long done = atomic_fetch_add(&scans, 1) + 1;
+
+    return scan_limit == 0 || done < scan_limit;
+}
+
+void free_run_stop(void)
+{
+    input_script_free();
+
+    uint64_t virtual_elapsed = atomic_load(&virtual_ns) - virtual_start_ns;
+    uint64_t real_elapsed    = monotonic_ns() - real_start_ns;
+    log_info("Free-run mode: %lu scans, %.3f s of PLC time in %.3f s (%.0f scans/s)",
+             atomic_load(&scans), virtual_elapsed / 1e9, real_elapsed / 1e9, free_run_scan_rate());
+}
+
+uint64_t free_run_clock_ns(void)
+{
+    if (enabled)
+    {
+        return atomic_load(&virtual_ns);
+    }
+    return monotonic_ns();
+}
+
+double free_run_scan_rate(void)
+{
+    if (!enabled)
+    {
+        return 0.0;
+    }
+
+    uint64_t real_elapsed = monotonic_ns() - real_start_ns;
+    if (real_elapsed == 0)
+    {
+        return 0.0;
+    }
+    return atomic_load(&scans) * 1e9 / real_elapsed;
+}
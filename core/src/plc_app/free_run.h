@@ -0,0 +1,74 @@
+#ifndef FREE_RUN_H
+#define FREE_RUN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Configure free-run mode
+ *
+ * In free-run mode the PLC cycle thread does not sleep between scans. A
+ * virtual clock advances by one task period per scan instead, and program
+ * time, the tick counter and the timing statistics follow it, so hours of
+ * plant behaviour execute as fast as the machine allows.
+ *
+ * @param enable      Run scans back to back on virtual time
+ * @param scan_count  Stop the runtime after this many scans, 0 to run until stopped
+ * @param script      Inputs to apply by scan number (see input_script.h), or NULL
+ */
+void free_run_configure(bool enable, unsigned long scan_count, const char *script);
+
+/**
+ * @brief Whether the runtime runs on virtual time
+ */
+bool free_run_enabled(void);
+
+/**
+ * @brief Start virtual time at the current monotonic time and load the input script
+ *
+ * @note Called by the PLC cycle thread before the first scan.
+ * @return 0 on success, -1 if the input script cannot be loaded
+ */
+int free_run_start(void);
+
+/**
+ * @brief Write the scripted inputs due for the next scan to the journal
+ *
+ * They reach the image tables like plugin writes, so a flight recording
+ * includes them.
+ *
+ * @note Called by the PLC cycle thread before it takes buffer_mutex.
+ */
+void free_run_apply_inputs(void);
+
+/**
+ * @brief Advance virtual time by one task period after a scan
+ *
+ * @param ticktime_ns Task period
+ * @return false once the configured number of scans was executed
+ */
+bool free_run_advance(uint64_t ticktime_ns);
+
+/**
+ * @brief Release the input script and log the achieved speed
+ *
+ * @note Called by the PLC cycle thread when it leaves the scan loop.
+ */
+void free_run_stop(void);
+
+/**
+ * @brief Current monotonic time of the runtime in nanoseconds
+ *
+ * Virtual time in free-run mode, CLOCK_MONOTONIC otherwise. Safe to call
+ * from any thread; plugins get it as get_time_ns.
+ */
+uint64_t free_run_clock_ns(void);
+
+/**
+ * @brief Scans per second of real time since free_run_start()
+ *
+ * @return The scan rate, or 0 when not in free-run mode
+ */
+double free_run_scan_rate(void);
+
+#endif // FREE_RUN_H
@@ -1,5 +1,6 @@
 #include <dlfcn.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "image_tables.h"
 #include "include/iec_python.h"
@@ -63,73 +64,60 @@ size_t (*ext_get_var_size)(size_t idx);
 void *(*ext_get_var_addr)(size_t idx);
 void (*ext_set_trace)(size_t idx, bool forced, void *val);
 
-int symbols_init(PluginManager *pm)
+int symbols_load(PluginManager *pm, plc_program_symbols_t *symbols)
 {
+    memset(symbols, 0, sizeof(*symbols));
+
     // Get pointer to external functions
-    *(void **)(&ext_config_run__) =
+    *(void **)(&symbols->config_run__) =
         plugin_manager_get_func(pm, void (*)(unsigned long), "config_run__");
 
-    *(void **)(&ext_config_init__) =
+    *(void **)(&symbols->config_init__) =
         plugin_manager_get_func(pm, void (*)(unsigned long), "config_init__");
 
-    *(void **)(&ext_glueVars) = plugin_manager_get_func(pm, void (*)(unsigned long), "glueVars");
+    *(void **)(&symbols->glueVars) =
+        plugin_manager_get_func(pm, void (*)(unsigned long), "glueVars");
 
-    *(void **)(&ext_updateTime) =
+    *(void **)(&symbols->updateTime) =
         plugin_manager_get_func(pm, void (*)(unsigned long), "updateTime");
 
-    *(void **)(&ext_setBufferPointers) =
+    *(void **)(&symbols->setBufferPointers) =
         plugin_manager_get_func(pm, void (*)(unsigned long), "setBufferPointers");
 
     // Try to load v4 version with bool_memory support (optional - only present in v4 programs)
-    *(void **)(&ext_setBufferPointers_v4) =
+    *(void **)(&symbols->setBufferPointers_v4) =
         plugin_manager_get_func(pm, void (*)(unsigned long), "setBufferPointers_v4");
 
-    *(void **)(&ext_common_ticktime__) =
-        plugin_manager_get_func(pm, void (*)(unsigned long), "common_ticktime__");
+    symbols->common_ticktime__ =
+        plugin_manager_get_func(pm, unsigned long long *, "common_ticktime__");
 
-    *(void **)(&ext_plc_program_md5) =
-        plugin_manager_get_func(pm, char *(*)(unsigned long), "plc_program_md5");
+    symbols->plc_program_md5 = plugin_manager_get_func(pm, char *, "plc_program_md5");
 
-    *(void **)(&ext_set_endianness) =
+    *(void **)(&symbols->set_endianness) =
         plugin_manager_get_func(pm, void (*)(unsigned long), "set_endianness");
 
-    *(void **)(&ext_get_var_count) =
+    *(void **)(&symbols->get_var_count) =
         plugin_manager_get_func(pm, uint16_t (*)(uint16_t), "get_var_count");
 
-    *(void **)(&ext_get_var_size) = plugin_manager_get_func(pm, size_t (*)(size_t), "get_var_size");
+    *(void **)(&symbols->get_var_size) =
+        plugin_manager_get_func(pm, size_t (*)(size_t), "get_var_size");
 
-    *(void **)(&ext_get_var_addr) =
+    *(void **)(&symbols->get_var_addr) =
         plugin_manager_get_func(pm, void *(*)(unsigned long), "get_var_addr");
 
-    *(void **)(&ext_set_trace) = plugin_manager_get_func(pm, void (*)(unsigned long), "set_trace");
+    *(void **)(&symbols->set_trace) =
+        plugin_manager_get_func(pm, void (*)(unsigned long), "set_trace");
 
     // Check if all symbols were loaded successfully
-    if (!ext_config_run__ || !ext_config_init__ || !ext_glueVars || !ext_updateTime ||
-        !ext_setBufferPointers || !ext_common_ticktime__ || !ext_plc_program_md5 ||
-        !ext_set_endianness || !ext_get_var_count || !ext_get_var_size || !ext_get_var_addr ||
-        !ext_set_trace)
+    if (!symbols->config_run__ || !symbols->config_init__ || !symbols->glueVars ||
+        !symbols->updateTime || !symbols->setBufferPointers || !symbols->common_ticktime__ ||
+        !symbols->plc_program_md5 || !symbols->set_endianness || !symbols->get_var_count ||
+        !symbols->get_var_size || !symbols->get_var_addr || !symbols->set_trace)
     {
         log_error("Failed to load all symbols");
         return -1;
     }
 
-    // Send buffer pointers to .so
-    // Try v4 version first (with bool_memory support for %MX), fall back to v1 for older programs
-    if (ext_setBufferPointers_v4)
-    {
-        log_info("Using setBufferPointers_v4 with bool_memory support");
-        ext_setBufferPointers_v4(bool_input, bool_output, byte_input, byte_output, int_input,
-                                 int_output, dint_input, dint_output, lint_input, lint_output,
-                                 int_memory, dint_memory, lint_memory, bool_memory);
-    }
-    else
-    {
-        log_info("Using setBufferPointers (legacy, no bool_memory support)");
-        ext_setBufferPointers(bool_input, bool_output, byte_input, byte_output, int_input,
-                              int_output, dint_input, dint_output, lint_input, lint_output,
-                              int_memory, dint_memory, lint_memory);
-    }
-
     // Initialize Python loader logging callbacks (optional - only present if Python FBs are used)
     void (*ext_python_loader_set_loggers)(void (*)(const char *, ...), void (*)(const char *, ...));
     *(void **)(&ext_python_loader_set_loggers) =
@@ -143,6 +131,79 @@ int symbols_init(PluginManager *pm)
     return 0;
 }
 
+void symbols_install(const plc_program_symbols_t *symbols)
+{
+    ext_config_run__         = symbols->config_run__;
+    ext_config_init__        = symbols->config_init__;
+    ext_glueVars             = symbols->glueVars;
+    ext_updateTime           = symbols->updateTime;
+    ext_setBufferPointers    = symbols->setBufferPointers;
+    ext_setBufferPointers_v4 = symbols->setBufferPointers_v4;
+    ext_common_ticktime__    = symbols->common_ticktime__;
+    ext_plc_program_md5      = symbols->plc_program_md5;
+    ext_set_endianness       = symbols->set_endianness;
+    ext_get_var_count        = symbols->get_var_count;
+    ext_get_var_size         = symbols->get_var_size;
+    ext_get_var_addr         = symbols->get_var_addr;
+    ext_set_trace            = symbols->set_trace;
+}
+
+void symbols_set_buffer_pointers(const plc_program_symbols_t *symbols, image_tables_t *tables)
+{
+    if (tables == NULL && symbols->setBufferPointers_v4)
+    {
+        symbols->setBufferPointers_v4(bool_input, bool_output, byte_input, byte_output, int_input,
+                                      int_output, dint_input, dint_output, lint_input, lint_output,
+                                      int_memory, dint_memory, lint_memory, bool_memory);
+    }
+    else if (tables == NULL)
+    {
+        symbols->setBufferPointers(bool_input, bool_output, byte_input, byte_output, int_input,
+                                   int_output, dint_input, dint_output, lint_input, lint_output,
+                                   int_memory, dint_memory, lint_memory);
+    }
+    else if (symbols->setBufferPointers_v4)
+    {
+        symbols->setBufferPointers_v4(
+            tables->bool_input, tables->bool_output, tables->byte_input, tables->byte_output,
+            tables->int_input, tables->int_output, tables->dint_input, tables->dint_output,
+            tables->lint_input, tables->lint_output, tables->int_memory, tables->dint_memory,
+            tables->lint_memory, tables->bool_memory);
+    }
+    else
+    {
+        symbols->setBufferPointers(tables->bool_input, tables->bool_output, tables->byte_input,
+                                   tables->byte_output, tables->int_input, tables->int_output,
+                                   tables->dint_input, tables->dint_output, tables->lint_input,
+                                   tables->lint_output, tables->int_memory, tables->dint_memory,
+                                   tables->lint_memory);
+    }
+}
+
+int symbols_init(PluginManager *pm)
+{
+    plc_program_symbols_t symbols;
+    if (symbols_load(pm, &symbols) != 0)
+    {
+        return -1;
+    }
+    symbols_install(&symbols);
+
+    // Send buffer pointers to .so
+    // Try v4 version first (with bool_memory support for %MX), fall back to v1 for older programs
+    if (symbols.setBufferPointers_v4)
+    {
+        log_info("Using setBufferPointers_v4 with bool_memory support");
+    }
+    else
+    {
+        log_info("Using setBufferPointers (legacy, no bool_memory support)");
+    }
+    symbols_set_buffer_pointers(&symbols, NULL);
+
+    return 0;
+}
+
 // Static backing arrays for NULL pointer fill
 // These provide temporary storage for image table entries not used by the PLC program
 static IEC_BOOL temp_bool_input[BUFFER_SIZE][8];
@@ -160,6 +221,32 @@ static IEC_UDINT temp_dint_memory[BUFFER_SIZE];
 static IEC_ULINT temp_lint_memory[BUFFER_SIZE];
 static IEC_BOOL temp_bool_memory[BUFFER_SIZE][8];
 
+void image_tables_get_views(image_tables_t *tables, image_table_view_t views[IMAGE_TABLE_COUNT])
+{
+#define IMAGE_TABLE_VIEW(n, name)                                                                  \
+    views[n].slots     = tables ? (void **)tables->name : (void **)name;                           \
+    views[n].backing   = (uint8_t *)temp_##name;                                                   \
+    views[n].count     = sizeof(name) / sizeof(void *);                                            \
+    views[n].elem_size = sizeof(temp_##name) / views[n].count;
+
+    IMAGE_TABLE_VIEW(0, bool_input);
+    IMAGE_TABLE_VIEW(1, bool_output);
+    IMAGE_TABLE_VIEW(2, byte_input);
+    IMAGE_TABLE_VIEW(3, byte_output);
+    IMAGE_TABLE_VIEW(4, int_input);
+    IMAGE_TABLE_VIEW(5, int_output);
+    IMAGE_TABLE_VIEW(6, dint_input);
+    IMAGE_TABLE_VIEW(7, dint_output);
+    IMAGE_TABLE_VIEW(8, lint_input);
+    IMAGE_TABLE_VIEW(9, lint_output);
+    IMAGE_TABLE_VIEW(10, int_memory);
+    IMAGE_TABLE_VIEW(11, dint_memory);
+    IMAGE_TABLE_VIEW(12, lint_memory);
+    IMAGE_TABLE_VIEW(13, bool_memory);
+
+#undef IMAGE_TABLE_VIEW
+}
+
 void image_tables_fill_null_pointers(void)
 {
     int filled_count = 0;
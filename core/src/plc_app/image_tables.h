@@ -1,6 +1,9 @@
 #ifndef IMAGE_TABLES_H
 #define IMAGE_TABLES_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "../lib/iec_types.h"
 #include "plcapp_manager.h"
 
@@ -90,6 +93,81 @@ extern size_t (*ext_get_var_size)(size_t idx);
 extern void *(*ext_get_var_addr)(size_t idx);
 extern void (*ext_set_trace)(size_t idx, bool forced, void *val);
 
+/**
+ * @brief Entry points and data symbols of one loaded PLC program
+ *
+ * symbols_init() resolves them straight into the ext_* globals. Online program
+ * change resolves a second program into its own instance first and installs it
+ * with symbols_install() once the switch happens.
+ */
+typedef struct
+{
+    void (*config_run__)(unsigned long tick);
+    void (*config_init__)(void);
+    void (*glueVars)(void);
+    void (*updateTime)(void);
+    void (*setBufferPointers)(
+        IEC_BOOL *input_bool[BUFFER_SIZE][8], IEC_BOOL *output_bool[BUFFER_SIZE][8],
+        IEC_BYTE *input_byte[BUFFER_SIZE], IEC_BYTE *output_byte[BUFFER_SIZE],
+        IEC_UINT *input_int[BUFFER_SIZE], IEC_UINT *output_int[BUFFER_SIZE],
+        IEC_UDINT *input_dint[BUFFER_SIZE], IEC_UDINT *output_dint[BUFFER_SIZE],
+        IEC_ULINT *input_lint[BUFFER_SIZE], IEC_ULINT *output_lint[BUFFER_SIZE],
+        IEC_UINT *int_memory[BUFFER_SIZE], IEC_UDINT *dint_memory[BUFFER_SIZE],
+        IEC_ULINT *lint_memory[BUFFER_SIZE]);
+    void (*setBufferPointers_v4)(
+        IEC_BOOL *input_bool[BUFFER_SIZE][8], IEC_BOOL *output_bool[BUFFER_SIZE][8],
+        IEC_BYTE *input_byte[BUFFER_SIZE], IEC_BYTE *output_byte[BUFFER_SIZE],
+        IEC_UINT *input_int[BUFFER_SIZE], IEC_UINT *output_int[BUFFER_SIZE],
+        IEC_UDINT *input_dint[BUFFER_SIZE], IEC_UDINT *output_dint[BUFFER_SIZE],
+        IEC_ULINT *input_lint[BUFFER_SIZE], IEC_ULINT *output_lint[BUFFER_SIZE],
+        IEC_UINT *int_memory[BUFFER_SIZE], IEC_UDINT *dint_memory[BUFFER_SIZE],
+        IEC_ULINT *lint_memory[BUFFER_SIZE], IEC_BOOL *memory_bool[BUFFER_SIZE][8]);
+    unsigned long long *common_ticktime__;
+    char *plc_program_md5;
+    void (*set_endianness)(uint8_t value);
+    uint16_t (*get_var_count)(void);
+    size_t (*get_var_size)(size_t idx);
+    void *(*get_var_addr)(size_t idx);
+    void (*set_trace)(size_t idx, bool forced, void *val);
+} plc_program_symbols_t;
+
+/**
+ * @brief Image table pointer set of a program that is not active yet
+ *
+ * Same layout as the global image tables. Online program change glues the new
+ * program into one of these while the active program keeps using the globals.
+ */
+typedef struct
+{
+    IEC_BOOL *bool_input[BUFFER_SIZE][8];
+    IEC_BOOL *bool_output[BUFFER_SIZE][8];
+    IEC_BYTE *byte_input[BUFFER_SIZE];
+    IEC_BYTE *byte_output[BUFFER_SIZE];
+    IEC_UINT *int_input[BUFFER_SIZE];
+    IEC_UINT *int_output[BUFFER_SIZE];
+    IEC_UDINT *dint_input[BUFFER_SIZE];
+    IEC_UDINT *dint_output[BUFFER_SIZE];
+    IEC_ULINT *lint_input[BUFFER_SIZE];
+    IEC_ULINT *lint_output[BUFFER_SIZE];
+    IEC_UINT *int_memory[BUFFER_SIZE];
+    IEC_UDINT *dint_memory[BUFFER_SIZE];
+    IEC_ULINT *lint_memory[BUFFER_SIZE];
+    IEC_BOOL *bool_memory[BUFFER_SIZE][8];
+} image_tables_t;
+
+#define IMAGE_TABLE_COUNT 14
+
+/**
+ * @brief Flat view of one image table, used to walk all tables uniformly
+ */
+typedef struct
+{
+    void **slots;     // Pointer slots of the table (BOOL tables are flattened)
+    uint8_t *backing; // Temporary backing storage for slots the program leaves NULL
+    size_t count;     // Number of slots
+    size_t elem_size; // Size of the value a slot points to
+} image_table_view_t;
+
 /**
  * @brief Initialize symbols for the plugin manager
  *
@@ -98,6 +176,38 @@ extern void (*ext_set_trace)(size_t idx, bool forced, void *val);
  */
 int symbols_init(PluginManager *pm);
 
+/**
+ * @brief Resolve the symbols of a loaded program without activating them
+ *
+ * @param[in]   pm       The plugin manager of the loaded program
+ * @param[out]  symbols  Resolved symbols
+ * @return 0 on success, -1 if a required symbol is missing
+ */
+int symbols_load(PluginManager *pm, plc_program_symbols_t *symbols);
+
+/**
+ * @brief Make the given program symbols the active ext_* symbols
+ *
+ * @note Call from the PLC cycle thread (or before it starts) with buffer_mutex held.
+ */
+void symbols_install(const plc_program_symbols_t *symbols);
+
+/**
+ * @brief Hand image table pointers to a program
+ *
+ * @param[in]  symbols  The program to configure
+ * @param[in]  tables   Staging tables, or NULL for the global image tables
+ */
+void symbols_set_buffer_pointers(const plc_program_symbols_t *symbols, image_tables_t *tables);
+
+/**
+ * @brief Describe every image table of a table set
+ *
+ * @param[in]   tables  Staging tables, or NULL for the global image tables
+ * @param[out]  views   One view per table; the backing storage is the same for both
+ */
+void image_tables_get_views(image_tables_t *tables, image_table_view_t views[IMAGE_TABLE_COUNT]);
+
 /**
  * @brief Fill NULL pointers in image tables with temporary backing buffers
  *
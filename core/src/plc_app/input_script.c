@@ -0,0 +1,151 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "image_tables.h"
+#include "input_script.h"
+#include "utils/log.h"
+
+#define MAX_SCRIPTED_INPUTS 65536
+
+/**
+ * @brief One scripted input value, applied before the given scan
+ */
+typedef struct
+{
+    unsigned long scan;
+    char area; // X, B, W, D or L
+    int index;
+    int bit;
+    uint64_t value;
+} scripted_input_t;
+
+static scripted_input_t *inputs = NULL;
+static size_t input_count       = 0;
+static size_t next_input        = 0;
+
+/**
+ * @brief Parse an input location such as %IX0.3, %IW2 or %IL1
+ *
+ * @return 0 on success, -1 if it is not a valid input location
+ */
+static int parse_input_location(const char *text, scripted_input_t *input)
+{
+    char area;
+    int index;
+    int bit = 0;
+    int consumed;
+
+    if (sscanf(text, "%%I%c%d%n", &area, &index, &consumed) != 2 || index < 0 ||
+        index >= BUFFER_SIZE)
+    {
+        return -1;
+    }
+    if (area == 'X')
+    {
+        if (sscanf(text + consumed, ".%d", &bit) != 1 || bit < 0 || bit > 7)
+        {
+            return -1;
+        }
+    }
+    else if (area != 'B' && area != 'W' && area != 'D' && area != 'L')
+    {
+        return -1;
+    }
+
+    input->area  = area;
+    input->index = index;
+    input->bit   = bit;
+    return 0;
+}
+
+int input_script_load(const char *path)
+{
+    input_script_free();
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        log_error("Failed to open input script %s", path);
+        return -1;
+    }
+
+    inputs = calloc(MAX_SCRIPTED_INPUTS, sizeof(scripted_input_t));
+    if (inputs == NULL)
+    {
+        fclose(file);
+        return -1;
+    }
+
+    char line[256];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) && input_count < MAX_SCRIPTED_INPUTS)
+    {
+        line_number++;
+        char location[32];
+        unsigned long long value;
+        scripted_input_t *input = &inputs[input_count];
+
+        if (line[0] == '#' || line[0] == '\n')
+        {
+            continue;
+        }
+        if (sscanf(line, "%lu %31s %llu", &input->scan, location, &value) != 3 ||
+            parse_input_location(location, input) != 0)
+        {
+            log_error("%s:%d: invalid input line", path, line_number);
+            fclose(file);
+            input_script_free();
+            return -1;
+        }
+        input->value = value;
+        input_count++;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+bool input_script_loaded(void)
+{
+    return inputs != NULL;
+}
+
+void input_script_apply(unsigned long scan, input_script_sink_t sink)
+{
+    while (next_input < input_count && inputs[next_input].scan <= scan)
+    {
+        scripted_input_t *input = &inputs[next_input++];
+        if (sink != NULL)
+        {
+            sink(input->area, input->index, input->bit, input->value);
+            continue;
+        }
+        switch (input->area)
+        {
+        case 'X':
+            *bool_input[input->index][input->bit] = (IEC_BOOL)(input->value != 0);
+            break;
+        case 'B':
+            *byte_input[input->index] = (IEC_BYTE)input->value;
+            break;
+        case 'W':
+            *int_input[input->index] = (IEC_UINT)input->value;
+            break;
+        case 'D':
+            *dint_input[input->index] = (IEC_UDINT)input->value;
+            break;
+        default:
+            *lint_input[input->index] = (IEC_ULINT)input->value;
+            break;
+        }
+    }
+}
+
+void input_script_free(void)
+{
+    free(inputs);
+    inputs      = NULL;
+    input_count = 0;
+    next_input  = 0;
+}
@@ -0,0 +1,52 @@
+#ifndef INPUT_SCRIPT_H
+#define INPUT_SCRIPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Load recorded or scripted inputs
+ *
+ * One '<scan> <location> <value>' per line, e.g. '120 %IX0.3 1' or
+ * '500 %IW2 1200', in ascending scan order. Empty lines and lines starting
+ * with '#' are skipped. Replaces a previously loaded script.
+ *
+ * @param path Input file
+ * @return 0 on success, -1 if the file cannot be read or has an invalid line
+ */
+int input_script_load(const char *path);
+
+/**
+ * @brief Whether a script is loaded
+ */
+bool input_script_loaded(void);
+
+/**
+ * @brief Receives a scripted input instead of the image tables
+ *
+ * @param area   X, B, W, D or L
+ * @param index  Input index
+ * @param bit    Bit number for X, 0 otherwise
+ * @param value  Value to write
+ */
+typedef void (*input_script_sink_t)(char area, int index, int bit, uint64_t value);
+
+/**
+ * @brief Write all inputs due up to the given scan
+ *
+ * Inputs are applied once each, in file order; call it with increasing scan
+ * numbers before executing the scan.
+ *
+ * @param scan  Scan about to execute
+ * @param sink  Where to write the inputs, or NULL for the image tables
+ *
+ * @note Without a sink, call with buffer_mutex held when other threads use the image tables.
+ */
+void input_script_apply(unsigned long scan, input_script_sink_t sink);
+
+/**
+ * @brief Release the loaded script
+ */
+void input_script_free(void);
+
+#endif // INPUT_SCRIPT_H
@@ -39,6 +39,9 @@ static journal_buffer_ptrs_t g_buffer_ptrs;
 /* Initialization flag */
 static bool g_initialized = false;
 
+/* Observer of applied entries (flight recorder), called with the image mutex held */
+static journal_apply_hook_t g_apply_hook = NULL;
+
 /*
  * =============================================================================
  * Forward Declarations
@@ -291,6 +294,118 @@ int journal_write_lint(journal_buffer_type_t type, uint16_t index,
     return 0;
 }
 
+/**
+ * @brief Number of journal entries a range expands to (0 if invalid)
+ */
+static size_t range_entry_count(const journal_range_t *range)
+{
+    if (range->values == NULL || range->count == 0 ||
+        (int)range->start_index + (int)range->count > g_buffer_ptrs.buffer_size) {
+        return 0;
+    }
+
+    switch (range->type) {
+        case JOURNAL_BOOL_INPUT:
+        case JOURNAL_BOOL_OUTPUT:
+        case JOURNAL_BOOL_MEMORY:
+            return (size_t)range->count * 8;
+        case JOURNAL_BYTE_INPUT:
+        case JOURNAL_BYTE_OUTPUT:
+        case JOURNAL_INT_INPUT:
+        case JOURNAL_INT_OUTPUT:
+        case JOURNAL_INT_MEMORY:
+        case JOURNAL_DINT_INPUT:
+        case JOURNAL_DINT_OUTPUT:
+        case JOURNAL_DINT_MEMORY:
+        case JOURNAL_LINT_INPUT:
+        case JOURNAL_LINT_OUTPUT:
+        case JOURNAL_LINT_MEMORY:
+            return range->count;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Read element i of a range as a 64-bit value
+ */
+static uint64_t range_value(const journal_range_t *range, size_t i)
+{
+    switch (range->type) {
+        case JOURNAL_BYTE_INPUT:
+        case JOURNAL_BYTE_OUTPUT:
+            return ((const uint8_t *)range->values)[i];
+        case JOURNAL_INT_INPUT:
+        case JOURNAL_INT_OUTPUT:
+        case JOURNAL_INT_MEMORY:
+            return ((const uint16_t *)range->values)[i];
+        case JOURNAL_DINT_INPUT:
+        case JOURNAL_DINT_OUTPUT:
+        case JOURNAL_DINT_MEMORY:
+            return ((const uint32_t *)range->values)[i];
+        default:
+            return ((const uint64_t *)range->values)[i];
+    }
+}
+
+int journal_write_ranges(const journal_range_t *ranges, size_t range_count)
+{
+    if (!g_initialized || ranges == NULL) {
+        return -1;
+    }
+
+    /* Validate everything up front so a batch is written completely or not at all */
+    size_t needed = 0;
+    for (size_t r = 0; r < range_count; r++) {
+        size_t entries = range_entry_count(&ranges[r]);
+        if (entries == 0) {
+            return -1;
+        }
+        needed += entries;
+    }
+    if (needed > JOURNAL_MAX_ENTRIES) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_journal_mutex);
+
+    /* Keep the batch in one cycle: flush older entries instead of splitting it */
+    if (g_count + needed > JOURNAL_MAX_ENTRIES) {
+        emergency_flush_locked();
+    }
+
+    for (size_t r = 0; r < range_count; r++) {
+        const journal_range_t *range = &ranges[r];
+        bool is_bool = range->type == JOURNAL_BOOL_INPUT ||
+                       range->type == JOURNAL_BOOL_OUTPUT ||
+                       range->type == JOURNAL_BOOL_MEMORY;
+
+        for (size_t i = 0; i < range->count; i++) {
+            if (is_bool) {
+                uint8_t packed = ((const uint8_t *)range->values)[i];
+                for (uint8_t bit = 0; bit < 8; bit++) {
+                    journal_entry_t *entry = &g_entries[g_count++];
+                    entry->sequence = g_next_sequence++;
+                    entry->buffer_type = (uint8_t)range->type;
+                    entry->index = (uint16_t)(range->start_index + i);
+                    entry->bit_index = bit;
+                    entry->value = (packed >> bit) & 1;
+                }
+            } else {
+                journal_entry_t *entry = &g_entries[g_count++];
+                entry->sequence = g_next_sequence++;
+                entry->buffer_type = (uint8_t)range->type;
+                entry->index = (uint16_t)(range->start_index + i);
+                entry->bit_index = 0xFF;
+                entry->value = range_value(range, i);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&g_journal_mutex);
+    return 0;
+}
+
 /*
  * =============================================================================
  * Apply and Clear
@@ -311,6 +426,10 @@ static void apply_entry(const journal_entry_t *entry)
         return;
     }
 
+    if (g_apply_hook != NULL) {
+        g_apply_hook(entry);
+    }
+
     switch ((journal_buffer_type_t)entry->buffer_type) {
         case JOURNAL_BOOL_INPUT: {
             IEC_BOOL *ptr = g_buffer_ptrs.bool_input[idx][entry->bit_index];
@@ -416,15 +535,16 @@ static void apply_entry(const journal_entry_t *entry)
     }
 }
 
-void journal_apply_and_clear(void)
+size_t journal_apply_and_clear(void)
 {
     if (!g_initialized) {
-        return;
+        return 0;
     }
 
     pthread_mutex_lock(&g_journal_mutex);
 
     /* Apply all entries in sequence order (they're already in order) */
+    size_t applied = g_count;
     for (size_t i = 0; i < g_count; i++) {
         apply_entry(&g_entries[i]);
     }
@@ -434,6 +554,14 @@ void journal_apply_and_clear(void)
     g_next_sequence = 0;
 
     pthread_mutex_unlock(&g_journal_mutex);
+    return applied;
+}
+
+void journal_set_apply_hook(journal_apply_hook_t hook)
+{
+    pthread_mutex_lock(&g_journal_mutex);
+    g_apply_hook = hook;
+    pthread_mutex_unlock(&g_journal_mutex);
 }
 
 /*
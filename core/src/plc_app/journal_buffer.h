@@ -80,6 +80,20 @@ typedef struct {
     uint64_t value;             /**< Value to write (sized for largest type) */
 } journal_entry_t;
 
+/**
+ * @brief One contiguous range of values for journal_write_ranges()
+ *
+ * Values use the native element layout of the buffer type: one byte per index
+ * for BOOL buffers (bit n = value of %X index.n), and uint8_t, uint16_t,
+ * uint32_t or uint64_t arrays for BYTE, INT, DINT and LINT buffers.
+ */
+typedef struct {
+    journal_buffer_type_t type; /**< Buffer type */
+    uint16_t start_index;       /**< First buffer index */
+    uint16_t count;             /**< Number of indices */
+    const void *values;         /**< count values in native layout */
+} journal_range_t;
+
 /**
  * @brief Buffer pointers structure for journal initialization
  *
@@ -197,6 +211,21 @@ int journal_write_dint(journal_buffer_type_t type, uint16_t index,
 int journal_write_lint(journal_buffer_type_t type, uint16_t index,
                        uint64_t value);
 
+/**
+ * @brief Write one or more contiguous ranges to the journal
+ *
+ * All entries of all ranges are added under a single journal lock and are
+ * guaranteed to be applied in the same scan cycle, so a consumer never sees
+ * half of a batch. If the batch does not fit into the remaining journal
+ * space, pending entries are flushed first.
+ *
+ * @param ranges Ranges to write
+ * @param range_count Number of ranges
+ * @return 0 on success, -1 if a range is invalid or the batch exceeds
+ *         JOURNAL_MAX_ENTRIES (nothing is written in that case)
+ */
+int journal_write_ranges(const journal_range_t *ranges, size_t range_count);
+
 /**
  * @brief Apply all pending journal entries to image tables and clear the journal
  *
@@ -205,8 +234,26 @@ int journal_write_lint(journal_buffer_type_t type, uint16_t index,
  *
  * @note The image table mutex (image_mutex) MUST be held by the caller.
  *       This function acquires the journal mutex internally.
+ * @return Number of entries applied
+ */
+size_t journal_apply_and_clear(void);
+
+/**
+ * @brief Callback invoked for every entry written to the image tables
+ *
+ * Called from journal_apply_and_clear() and from an emergency flush, in
+ * apply order, with the image table mutex held.
+ */
+typedef void (*journal_apply_hook_t)(const journal_entry_t *entry);
+
+/**
+ * @brief Install or remove (NULL) the apply hook
+ *
+ * Used by the flight recorder to log the writes each scan starts from.
+ *
+ * @param hook Hook to call, or NULL
  */
-void journal_apply_and_clear(void);
+void journal_set_apply_hook(journal_apply_hook_t hook);
 
 /**
  * @brief Get the number of pending journal entries
@@ -0,0 +1,806 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "image_tables.h"
+#include "multi_task.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+
+// Task threads rank below the PLC cycle thread, which releases them
+#define TASK_TOP_PRIORITY (PLC_CYCLE_PRIORITY - 1)
+
+typedef struct
+{
+    const plc_task_t *task;
+    pthread_t thread;
+    sem_t release;
+    sigjmp_buf crash_jmp;
+
+    // Set by the releasing thread before sem_post, read by the task after sem_wait
+    unsigned long release_tick;
+    uint64_t release_ns;
+
+    atomic_bool busy; // Released and not finished yet
+
+    volatile sig_atomic_t in_run;       // Task holds a read lock of run_lock
+    atomic_uint_least64_t run_start_ns; // Start of the running body, 0 between runs
+
+    // Event tasks: raises not yet served, and when the oldest of them arrived
+    atomic_int requests;
+    atomic_uint_least64_t raised_ns;
+    atomic_uint_least64_t raised_while_running_ns;
+    atomic_ulong raised_tick; // Common tick of the latest raise, passed to the body
+
+    bool condition_was_true; // Last value of the task condition, PLC cycle thread only
+
+    // Guarded by stats_mutex
+    plc_task_stats_t stats;
+    int64_t exec_time_total;
+    int64_t release_latency_total;
+} task_thread_t;
+
+// Value of a located variable, in the width of its image table
+typedef union
+{
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+} image_value_t;
+
+/**
+ * @brief Located variable of the program, mirrored for the PLC cycle thread
+ *
+ * While tasks run on their own threads the image table slot points to the
+ * mirror, so the journal and the plugins never touch the variable a task
+ * may be writing. Values move between the two at task boundaries.
+ */
+typedef struct
+{
+    void **slot;          // Image table slot, pointed back by multi_task_stop()
+    void *program;        // Located variable the task bodies use
+    image_value_t mirror; // What the slot points to
+    uint64_t synced;      // Value both sides had at the last task boundary
+    size_t size;
+} located_mirror_t;
+
+static bool enabled = false;
+static task_thread_t tasks[MULTI_TASK_MAX];
+static int task_count = 0;
+static atomic_bool active;
+static atomic_int raising; // Plugin threads inside multi_task_raise_event()
+static atomic_int crash_signal;
+static atomic_ulong current_tick; // Last common tick released, for raises from plugins
+static bool has_conditions = false;
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t *image_mutex = NULL;
+
+// Task runs hold it for reading; the PLC cycle thread takes it for writing to
+// copy program variables between runs, without ever waiting for a task
+static pthread_rwlock_t run_lock = PTHREAD_RWLOCK_INITIALIZER;
+static bool paused = false;
+
+static located_mirror_t *mirrors = NULL;
+static size_t mirror_count       = 0;
+
+// Lets the crash handler find the recovery point of the faulting task
+static __thread task_thread_t *current_task = NULL;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void record_run(task_thread_t *t, int64_t latency_us, int64_t exec_us)
+{
+    plc_task_stats_t *s = &t->stats;
+
+    pthread_mutex_lock(&stats_mutex);
+    s->runs++;
+    t->exec_time_total += exec_us;
+    t->release_latency_total += latency_us;
+    if (exec_us < s->exec_time_min)
+    {
+        s->exec_time_min = exec_us;
+    }
+    if (exec_us > s->exec_time_max)
+    {
+        s->exec_time_max = exec_us;
+    }
+    if (latency_us < s->release_latency_min)
+    {
+        s->release_latency_min = latency_us;
+    }
+    if (latency_us > s->release_latency_max)
+    {
+        s->release_latency_max = latency_us;
+    }
+    s->exec_time_avg       = t->exec_time_total / s->runs;
+    s->release_latency_avg = t->release_latency_total / s->runs;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+static bool is_event(const plc_task_t *task)
+{
+    return task->tick_divisor == 0;
+}
+
+static uint64_t load_value(const void *addr, size_t size)
+{
+    switch (size)
+    {
+    case sizeof(uint16_t):
+        return *(const uint16_t *)addr;
+    case sizeof(uint32_t):
+        return *(const uint32_t *)addr;
+    case sizeof(uint64_t):
+        return *(const uint64_t *)addr;
+    default:
+        return *(const uint8_t *)addr;
+    }
+}
+
+static void store_value(void *addr, size_t size, uint64_t value)
+{
+    switch (size)
+    {
+    case sizeof(uint16_t):
+        *(uint16_t *)addr = (uint16_t)value;
+        break;
+    case sizeof(uint32_t):
+        *(uint32_t *)addr = (uint32_t)value;
+        break;
+    case sizeof(uint64_t):
+        *(uint64_t *)addr = value;
+        break;
+    default:
+        *(uint8_t *)addr = (uint8_t)value;
+        break;
+    }
+}
+
+/**
+ * @brief Hand journal and plugin writes since the last task boundary to the program
+ *
+ * @note Called with image_mutex held.
+ */
+static void sync_to_program(void)
+{
+    for (size_t i = 0; i < mirror_count; i++)
+    {
+        located_mirror_t *m = &mirrors[i];
+        uint64_t value      = load_value(&m->mirror, m->size);
+        if (value != m->synced)
+        {
+            store_value(m->program, m->size, value);
+            m->synced = value;
+        }
+    }
+}
+
+/**
+ * @brief Publish the values the program changed to the image tables
+ *
+ * @note Called with image_mutex held.
+ */
+static void sync_from_program(void)
+{
+    for (size_t i = 0; i < mirror_count; i++)
+    {
+        located_mirror_t *m = &mirrors[i];
+        uint64_t value      = load_value(m->program, m->size);
+        if (value != m->synced)
+        {
+            store_value(&m->mirror, m->size, value);
+            m->synced = value;
+        }
+    }
+}
+
+/**
+ * @brief Point the image table slots that hold located variables to mirrors
+ *
+ * @return 0 on success, -1 if out of memory
+ */
+static int mirror_located_variables(void)
+{
+    image_table_view_t views[IMAGE_TABLE_COUNT];
+    image_tables_get_views(NULL, views);
+
+    // Located variables are the slots that do not point into the temporary backing storage
+    size_t count = 0;
+    for (int t = 0; t < IMAGE_TABLE_COUNT; t++)
+    {
+        uint8_t *backing_end = views[t].backing + views[t].count * views[t].elem_size;
+        for (size_t i = 0; i < views[t].count; i++)
+        {
+            uint8_t *ptr = views[t].slots[i];
+            if (ptr != NULL && (ptr < views[t].backing || ptr >= backing_end))
+            {
+                count++;
+            }
+        }
+    }
+
+    mirrors = calloc(count + 1, sizeof(*mirrors));
+    if (mirrors == NULL)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(image_mutex);
+    for (int t = 0; t < IMAGE_TABLE_COUNT; t++)
+    {
+        uint8_t *backing_end = views[t].backing + views[t].count * views[t].elem_size;
+        for (size_t i = 0; i < views[t].count; i++)
+        {
+            uint8_t *ptr = views[t].slots[i];
+            if (ptr == NULL || (ptr >= views[t].backing && ptr < backing_end))
+            {
+                continue;
+            }
+            located_mirror_t *m = &mirrors[mirror_count++];
+            m->slot             = &views[t].slots[i];
+            m->program          = ptr;
+            m->size             = views[t].elem_size;
+            m->synced           = load_value(ptr, m->size);
+            store_value(&m->mirror, m->size, m->synced);
+            *m->slot = &m->mirror;
+        }
+    }
+    pthread_mutex_unlock(image_mutex);
+    return 0;
+}
+
+/**
+ * @brief Hand the last writes to the program and point the slots back to it
+ */
+static void restore_located_variables(void)
+{
+    pthread_mutex_lock(image_mutex);
+    sync_to_program();
+    for (size_t i = 0; i < mirror_count; i++)
+    {
+        *mirrors[i].slot = mirrors[i].program;
+    }
+    pthread_mutex_unlock(image_mutex);
+
+    free(mirrors);
+    mirrors      = NULL;
+    mirror_count = 0;
+}
+
+/**
+ * @brief Run a task body between two task boundaries
+ *
+ * The body runs on program memory without image_mutex, so tasks only wait
+ * for the PLC cycle thread while their located variables are copied in and
+ * out, never for each other.
+ *
+ * @return Execution time in nanoseconds, without the copies
+ */
+static uint64_t run_body(task_thread_t *t, unsigned long tick, uint64_t *start_ns)
+{
+    pthread_rwlock_rdlock(&run_lock);
+    t->in_run = 1;
+
+    pthread_mutex_lock(image_mutex);
+    sync_to_program();
+    pthread_mutex_unlock(image_mutex);
+
+    *start_ns = now_ns();
+    atomic_store(&t->run_start_ns, *start_ns);
+    t->task->run(tick);
+    uint64_t end_ns = now_ns();
+    atomic_store(&t->run_start_ns, 0);
+
+    pthread_mutex_lock(image_mutex);
+    sync_from_program();
+    pthread_mutex_unlock(image_mutex);
+
+    t->in_run = 0;
+    pthread_rwlock_unlock(&run_lock);
+    return end_ns - *start_ns;
+}
+
+static void run_cyclic(task_thread_t *t)
+{
+    uint64_t start_ns;
+    uint64_t exec_ns = run_body(t, t->release_tick, &start_ns);
+
+    record_run(t, (int64_t)(start_ns - t->release_ns) / 1000, (int64_t)exec_ns / 1000);
+    atomic_store(&t->busy, false);
+}
+
+/**
+ * @brief Serve the raises of an event task
+ *
+ * Raises that arrive while the task runs are coalesced into one more run
+ * right after it, whose latency counts from the first of them.
+ */
+static void run_event(task_thread_t *t)
+{
+    atomic_store(&t->raised_while_running_ns, 0);
+    uint64_t release_ns = atomic_load(&t->raised_ns);
+
+    while (atomic_load(&active))
+    {
+        int served = atomic_load(&t->requests);
+
+        uint64_t start_ns;
+        uint64_t exec_ns = run_body(t, atomic_load(&t->raised_tick), &start_ns);
+        uint64_t end_ns  = start_ns + exec_ns;
+
+        record_run(t, (int64_t)(start_ns - release_ns) / 1000, (int64_t)exec_ns / 1000);
+        if (served > 1)
+        {
+            pthread_mutex_lock(&stats_mutex);
+            t->stats.coalesced += served - 1;
+            pthread_mutex_unlock(&stats_mutex);
+        }
+
+        if (atomic_fetch_sub(&t->requests, served) == served)
+        {
+            break;
+        }
+        release_ns = atomic_exchange(&t->raised_while_running_ns, 0);
+        if (release_ns == 0)
+        {
+            release_ns = end_ns;
+        }
+    }
+}
+
+static void *task_thread(void *arg)
+{
+    task_thread_t *t = (task_thread_t *)arg;
+    current_task     = t;
+
+    set_thread_realtime_priority(t->stats.thread_priority);
+
+    // A crash in the task body lands here; the PLC cycle thread reports it
+    if (sigsetjmp(t->crash_jmp, 1) != 0)
+    {
+        if (t->in_run)
+        {
+            t->in_run = 0;
+            pthread_rwlock_unlock(&run_lock);
+        }
+        current_task = NULL;
+        return NULL;
+    }
+
+    while (true)
+    {
+        while (sem_wait(&t->release) != 0 && errno == EINTR)
+        {
+        }
+        if (!atomic_load(&active))
+        {
+            break;
+        }
+
+        if (is_event(t->task))
+        {
+            run_event(t);
+        }
+        else
+        {
+            run_cyclic(t);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Order tasks by IEC priority, then event tasks before cyclic ones by
+ *        period (rate monotonic)
+ */
+static bool runs_before(const plc_task_t *a, const plc_task_t *b)
+{
+    int pa = a->priority < 0 ? INT_MAX : a->priority;
+    int pb = b->priority < 0 ? INT_MAX : b->priority;
+    if (pa != pb)
+    {
+        return pa < pb;
+    }
+    if (is_event(a) != is_event(b))
+    {
+        return is_event(a);
+    }
+    return a->tick_divisor < b->tick_divisor;
+}
+
+/**
+ * @brief SCHED_FIFO priority of a task: one level below every task that runs before it
+ */
+static int thread_priority(const plc_task_t *table, unsigned int count, unsigned int index)
+{
+    int rank = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (runs_before(&table[i], &table[index]))
+        {
+            rank++;
+        }
+    }
+    return rank < TASK_TOP_PRIORITY ? TASK_TOP_PRIORITY - rank : 1;
+}
+
+void multi_task_configure(bool enable)
+{
+    enabled = enable;
+}
+
+bool multi_task_start(PluginManager *pm, pthread_mutex_t *buffer_mutex)
+{
+    task_count     = 0;
+    image_mutex    = buffer_mutex;
+    has_conditions = false;
+    atomic_store(&crash_signal, 0);
+    atomic_store(&current_tick, 0);
+    if (!enabled)
+    {
+        return false;
+    }
+
+    const unsigned int *count =
+        plugin_manager_get_func(pm, const unsigned int *, "plc_task_count__");
+    const plc_task_t *table = plugin_manager_get_func(pm, const plc_task_t *, "plc_tasks__");
+    if (count == NULL || table == NULL)
+    {
+        log_warn("Multi-task mode: program has no task table, running all tasks on the common "
+                 "tick");
+        return false;
+    }
+    if (*count == 0 || *count > MULTI_TASK_MAX)
+    {
+        log_warn("Multi-task mode: %u tasks not supported (1 to %d), running all tasks on the "
+                 "common tick",
+                 *count, MULTI_TASK_MAX);
+        return false;
+    }
+    for (unsigned int i = 0; i < *count; i++)
+    {
+        if (table[i].run == NULL || table[i].name == NULL ||
+            (table[i].condition != NULL && !is_event(&table[i])))
+        {
+            log_error("Multi-task mode: task %u of the task table is invalid", i);
+            return false;
+        }
+    }
+
+    if (mirror_located_variables() != 0)
+    {
+        log_error("Multi-task mode: not enough memory to mirror the located variables");
+        return false;
+    }
+
+    atomic_store(&active, true);
+    for (unsigned int i = 0; i < *count; i++)
+    {
+        task_thread_t *t = &tasks[i];
+        memset(&t->stats, 0, sizeof(t->stats));
+        t->task                      = &table[i];
+        t->exec_time_total           = 0;
+        t->release_latency_total     = 0;
+        t->stats.exec_time_min       = INT64_MAX;
+        t->stats.release_latency_min = INT64_MAX;
+        t->stats.priority            = table[i].priority;
+        t->stats.thread_priority     = thread_priority(table, *count, i);
+        t->stats.period_us           = table[i].tick_divisor * *ext_common_ticktime__ / 1000;
+        t->stats.event               = is_event(&table[i]);
+        snprintf(t->stats.name, sizeof(t->stats.name), "%s", table[i].name);
+        atomic_store(&t->busy, false);
+        atomic_store(&t->requests, 0);
+        atomic_store(&t->raised_tick, 0);
+        atomic_store(&t->run_start_ns, 0);
+        t->condition_was_true = false;
+        t->in_run             = 0;
+        sem_init(&t->release, 0, 0);
+
+        if (pthread_create(&t->thread, NULL, task_thread, t) != 0)
+        {
+            log_error("Multi-task mode: failed to create the thread of task %s", t->stats.name);
+            sem_destroy(&t->release);
+            multi_task_stop();
+            return false;
+        }
+        task_count++;
+
+        if (t->stats.event)
+        {
+            has_conditions |= table[i].condition != NULL;
+            log_info("Multi-task mode: event task %s%s, thread priority %d", t->stats.name,
+                     table[i].condition != NULL ? " on its condition" : "",
+                     t->stats.thread_priority);
+        }
+        else
+        {
+            log_info("Multi-task mode: task %s every %" PRIu64 " us, thread priority %d",
+                     t->stats.name, t->stats.period_us, t->stats.thread_priority);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Schedule a run of an event task for a raise at the given common tick
+ */
+static void raise_task(task_thread_t *t, unsigned long tick)
+{
+    uint64_t raised_ns = now_ns();
+    atomic_store(&t->raised_tick, tick);
+    if (atomic_fetch_add(&t->requests, 1) == 0)
+    {
+        atomic_store(&t->raised_ns, raised_ns);
+        sem_post(&t->release);
+    }
+    else
+    {
+        // Coalesced into the run after the current one
+        uint64_t none = 0;
+        atomic_compare_exchange_strong(&t->raised_while_running_ns, &none, raised_ns);
+    }
+}
+
+/**
+ * @brief Raise the event tasks whose condition became true at this tick
+ *
+ * A task runs on the rising edge of its condition, as IEC 61131-3 starts
+ * SINGLE tasks. Journal and plugin writes go to the program first, so the
+ * condition sees the same inputs as a task body released now.
+ */
+static void raise_on_conditions(unsigned long tick)
+{
+    pthread_mutex_lock(image_mutex);
+    sync_to_program();
+    for (int i = 0; i < task_count; i++)
+    {
+        task_thread_t *t = &tasks[i];
+        if (t->task->condition == NULL)
+        {
+            continue;
+        }
+
+        bool is_true = t->task->condition(tick) != 0;
+        if (is_true && !t->condition_was_true)
+        {
+            raise_task(t, tick);
+        }
+        t->condition_was_true = is_true;
+    }
+    pthread_mutex_unlock(image_mutex);
+}
+
+void multi_task_release(unsigned long tick)
+{
+    uint64_t release_ns = now_ns();
+    atomic_store(&current_tick, tick);
+
+    if (has_conditions)
+    {
+        raise_on_conditions(tick);
+    }
+
+    for (int i = 0; i < task_count; i++)
+    {
+        task_thread_t *t = &tasks[i];
+        if (is_event(t->task) || tick % t->task->tick_divisor != 0)
+        {
+            continue;
+        }
+
+        // Never queue a second run behind one that missed its deadline
+        if (atomic_exchange(&t->busy, true))
+        {
+            pthread_mutex_lock(&stats_mutex);
+            t->stats.overruns++;
+            pthread_mutex_unlock(&stats_mutex);
+            continue;
+        }
+
+        t->release_tick = tick;
+        t->release_ns   = release_ns;
+        sem_post(&t->release);
+    }
+}
+
+int multi_task_raise_event(const char *name)
+{
+    if (name == NULL)
+    {
+        return -1;
+    }
+
+    // Keeps the task threads and their semaphores alive until this returns
+    atomic_fetch_add(&raising, 1);
+
+    int result = -1;
+    if (atomic_load(&active))
+    {
+        for (int i = 0; i < task_count; i++)
+        {
+            task_thread_t *t = &tasks[i];
+            if (!is_event(t->task) || strcasecmp(t->stats.name, name) != 0)
+            {
+                continue;
+            }
+
+            raise_task(t, atomic_load(&current_tick));
+            result = 0;
+            break;
+        }
+    }
+
+    atomic_fetch_sub(&raising, 1);
+    return result;
+}
+
+int multi_task_crash_signal(void)
+{
+    return atomic_load(&crash_signal);
+}
+
+void multi_task_recover(int sig)
+{
+    task_thread_t *t = current_task;
+    if (t == NULL)
+    {
+        return;
+    }
+
+    int expected = 0;
+    atomic_compare_exchange_strong(&crash_signal, &expected, sig);
+    siglongjmp(t->crash_jmp, sig);
+}
+
+void multi_task_stop(void)
+{
+    // The PLC cycle thread may have crashed between pause and resume
+    multi_task_resume();
+
+    if (!atomic_exchange(&active, false))
+    {
+        return;
+    }
+
+    // Wait for plugins that are raising an event right now
+    while (atomic_load(&raising) > 0)
+    {
+        sched_yield();
+    }
+
+    // Tasks finish their current run, then wake up to find the runtime stopping
+    for (int i = 0; i < task_count; i++)
+    {
+        sem_post(&tasks[i].release);
+    }
+    for (int i = 0; i < task_count; i++)
+    {
+        pthread_join(tasks[i].thread, NULL);
+        sem_destroy(&tasks[i].release);
+    }
+    restore_located_variables();
+    log_info("Multi-task mode: %d task threads stopped", task_count);
+}
+
+bool multi_task_active(void)
+{
+    return atomic_load(&active);
+}
+
+bool multi_task_try_pause(void)
+{
+    if (!atomic_load(&active))
+    {
+        return true;
+    }
+    paused = pthread_rwlock_trywrlock(&run_lock) == 0;
+    return paused;
+}
+
+void multi_task_resume(void)
+{
+    if (paused)
+    {
+        paused = false;
+        pthread_rwlock_unlock(&run_lock);
+    }
+}
+
+const char *multi_task_longest_running(uint64_t *start_ns, uint64_t *period_ns)
+{
+    const char *name = NULL;
+    double longest   = 0.0;
+    uint64_t now     = now_ns();
+
+    if (!atomic_load(&active))
+    {
+        return NULL;
+    }
+    for (int i = 0; i < task_count; i++)
+    {
+        uint64_t started = atomic_load(&tasks[i].run_start_ns);
+        if (started == 0 || started > now)
+        {
+            continue;
+        }
+
+        // Event tasks have no period of their own, count in common ticks
+        uint64_t divisor = is_event(tasks[i].task) ? 1 : tasks[i].task->tick_divisor;
+        uint64_t period  = divisor * *ext_common_ticktime__;
+        double periods   = (double)(now - started) / (double)period;
+        if (name == NULL || periods > longest)
+        {
+            name       = tasks[i].stats.name;
+            longest    = periods;
+            *start_ns  = started;
+            *period_ns = period;
+        }
+    }
+    return name;
+}
+
+int multi_task_stats_snapshot(plc_task_stats_t *stats, int max_tasks)
+{
+    int n = task_count < max_tasks ? task_count : max_tasks;
+
+    pthread_mutex_lock(&stats_mutex);
+    for (int i = 0; i < n; i++)
+    {
+        stats[i] = tasks[i].stats;
+    }
+    pthread_mutex_unlock(&stats_mutex);
+
+    return n;
+}
+
+int format_task_stats_response(char *buffer, size_t buffer_size)
+{
+    plc_task_stats_t stats[MULTI_TASK_MAX];
+    int n = multi_task_stats_snapshot(stats, MULTI_TASK_MAX);
+
+    int written = snprintf(buffer, buffer_size, "TASKS:{\"multi_task\":%s,\"tasks\":[",
+                           multi_task_active() ? "true" : "false");
+    for (int i = 0; i < n && written >= 0 && (size_t)written < buffer_size; i++)
+    {
+        const plc_task_stats_t *s = &stats[i];
+        bool ran                  = s->runs > 0;
+        written += snprintf(buffer + written, buffer_size - written,
+                            "%s{\"name\":\"%s\",\"event\":%s,\"period_us\":%" PRIu64
+                            ",\"priority\":%d,\"thread_priority\":%d,\"runs\":%" PRId64
+                            ",\"overruns\":%" PRId64 ",\"coalesced\":%" PRId64
+                            ",\"exec_time_min\":%" PRId64 ",\"exec_time_max\":%" PRId64
+                            ",\"exec_time_avg\":%" PRId64 ",\"release_latency_min\":%" PRId64
+                            ",\"release_latency_max\":%" PRId64
+                            ",\"release_latency_avg\":%" PRId64 "}",
+                            i > 0 ? "," : "", s->name, s->event ? "true" : "false",
+                            s->period_us, s->priority, s->thread_priority, s->runs, s->overruns,
+                            s->coalesced,
+                            ran ? s->exec_time_min : 0, s->exec_time_max, s->exec_time_avg,
+                            ran ? s->release_latency_min : 0, s->release_latency_max,
+                            s->release_latency_avg);
+    }
+    if (written < 0 || (size_t)written >= buffer_size)
+    {
+        return written;
+    }
+
+    written += snprintf(buffer + written, buffer_size - written, "]}\n");
+    return written;
+}
@@ -0,0 +1,180 @@
+#ifndef MULTI_TASK_H
+#define MULTI_TASK_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "plcapp_manager.h"
+
+// Programs with more tasks run single-rate
+#define MULTI_TASK_MAX 16
+
+/**
+ * @brief Task table entry exported by programs built with a task table
+ *
+ * scripts/generate-task-table.py emits plc_task_count__ and plc_tasks__[]
+ * next to the resource code. The layout must match the generated one.
+ */
+typedef struct
+{
+    const char *name;
+    unsigned long tick_divisor;           // Task runs every tick_divisor common ticks, 0 for events
+    int priority;                         // IEC priority, 0 is the highest, -1 if unknown
+    void (*run)(unsigned long tick);      // Body of this task only
+    int (*condition)(unsigned long tick); // Event tasks: runs on its rising edge, or NULL
+} plc_task_t;
+
+typedef struct
+{
+    char name[32];
+    uint64_t period_us;
+    int priority;        // IEC priority from the task table, -1 if unknown
+    int thread_priority; // SCHED_FIFO priority of the task thread
+    bool event;          // Runs when a plugin raises it instead of periodically
+
+    int64_t runs;
+    int64_t overruns;  // Releases skipped because the previous run had not finished
+    int64_t coalesced; // Event raises served by the run of an earlier raise
+
+    int64_t exec_time_min;
+    int64_t exec_time_max;
+    int64_t exec_time_avg;
+
+    int64_t release_latency_min;
+    int64_t release_latency_max;
+    int64_t release_latency_avg;
+} plc_task_stats_t;
+
+/**
+ * @brief Configure multi-rate execution
+ *
+ * When enabled and the loaded program exports a task table, every IEC task
+ * runs on its own SCHED_FIFO thread, released by the PLC cycle thread at
+ * its own interval. Otherwise all tasks run in ext_config_run__() on the
+ * common tick, as before.
+ */
+void multi_task_configure(bool enable);
+
+/**
+ * @brief Start one thread per task of the loaded program
+ *
+ * Task bodies run on program memory without buffer_mutex. The image table
+ * slots of located variables point to mirrors instead, which take journal
+ * and plugin writes at the start of a task run and the task's results at
+ * its end, both with buffer_mutex held. Plugin hooks therefore only see
+ * complete task runs, and tasks wait for the PLC cycle thread only during
+ * these copies, never for each other.
+ *
+ * @param pm            The loaded program
+ * @param buffer_mutex  Mutex guarding the image tables
+ * @return true if tasks run on their own threads, false to run the program
+ *         single-rate (disabled, no task table or threads not available)
+ *
+ * @note Called by the PLC cycle thread after ext_config_init__() and
+ *       image_tables_fill_null_pointers().
+ */
+bool multi_task_start(PluginManager *pm, pthread_mutex_t *buffer_mutex);
+
+/**
+ * @brief Release the tasks due at a common tick
+ *
+ * A task that is still running from its previous release is not released
+ * again; the miss counts as an overrun of that task. Event tasks with a
+ * condition are raised when it turns true, like on a SINGLE input.
+ *
+ * @note Called by the PLC cycle thread once per common tick.
+ */
+void multi_task_release(unsigned long tick);
+
+/**
+ * @brief Run an event task as soon as possible
+ *
+ * Event tasks (tick_divisor 0) run on their own thread whenever a plugin
+ * raises them, e.g. on an input edge or a received frame. Raises that arrive
+ * while the task runs are coalesced into a single further run. The body gets
+ * the common tick released last before the raise.
+ *
+ * @param name  Task name, compared without case like IEC identifiers
+ * @return 0 if the task was scheduled, -1 if no event task has this name or
+ *         tasks do not run on their own threads
+ *
+ * @note Safe to call from any thread; never blocks.
+ */
+int multi_task_raise_event(const char *name);
+
+/**
+ * @brief Signal a task thread crashed in the PLC program, or 0
+ */
+int multi_task_crash_signal(void);
+
+/**
+ * @brief Recover from a crash signal raised on a task thread
+ *
+ * Jumps back to the task thread's recovery point, which stops the thread
+ * and reports the signal through multi_task_crash_signal(). Returns only if
+ * the calling thread is not a task thread.
+ *
+ * @note Called from the crash signal handler.
+ */
+void multi_task_recover(int sig);
+
+/**
+ * @brief Stop and join the task threads
+ *
+ * Points the image table slots back to the located variables of the program.
+ *
+ * @note Called by the PLC cycle thread when it leaves the scan loop.
+ */
+void multi_task_stop(void);
+
+/**
+ * @brief Keep task runs from starting, if none is running
+ *
+ * Lets the PLC cycle thread copy program variables outside the image
+ * tables, such as RETAIN variables, between task runs without waiting.
+ *
+ * @return true if no task runs until multi_task_resume(), false if one is
+ *         running; always true when tasks do not run on their own threads
+ *
+ * @note Called by the PLC cycle thread.
+ */
+bool multi_task_try_pause(void);
+
+/**
+ * @brief Let task runs start again after multi_task_try_pause()
+ */
+void multi_task_resume(void);
+
+/**
+ * @brief Whether task threads are running
+ */
+bool multi_task_active(void);
+
+/**
+ * @brief Name of the task whose body has run for the most of its periods, or NULL
+ *
+ * A task stuck in a loop does not hold up the PLC cycle thread, so the scan
+ * watchdog checks running task bodies against their own periods.
+ *
+ * @param[out] start_ns   Start of that body, on CLOCK_MONOTONIC
+ * @param[out] period_ns  Period of the task, the common tick for event tasks
+ */
+const char *multi_task_longest_running(uint64_t *start_ns, uint64_t *period_ns);
+
+/**
+ * @brief Copy the statistics of every task
+ *
+ * @return Number of tasks copied
+ */
+int multi_task_stats_snapshot(plc_task_stats_t *stats, int max_tasks);
+
+/**
+ * @brief Format the per-task statistics for the TASKS command
+ *
+ * @return Number of characters written (excluding null terminator)
+ */
+int format_task_stats_response(char *buffer, size_t buffer_size);
+
+#endif // MULTI_TASK_H
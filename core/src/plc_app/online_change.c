@@ -0,0 +1,444 @@
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../drivers/plugin_driver.h"
+#include "fast_restart.h"
+#include "flight_recorder.h"
+#include "image_tables.h"
+#include "multi_task.h"
+#include "online_change.h"
+#include "plc_state_manager.h"
+#include "plcapp_manager.h"
+#include "retain_store.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+#include "variable_table.h"
+#include "warm_restart.h"
+
+// Minimum time the scan thread gets to pick up a prepared program
+#define SWITCH_TIMEOUT_MIN_NS (1000LL * 1000 * 1000)
+
+extern PluginManager *plc_program;
+extern plugin_driver_t *plugin_driver;
+
+/**
+ * @brief Value carried over from the running program into the new one
+ */
+typedef struct
+{
+    void *dst;
+    const void *src;
+    size_t size;
+} state_copy_t;
+
+/**
+ * @brief Image table slot that points somewhere else in the new program
+ */
+typedef struct
+{
+    void **slot; // Slot in the global image tables
+    void *ptr;   // Storage of the new program (or temporary backing)
+    size_t size;
+} slot_swap_t;
+
+/**
+ * @brief Everything the scan thread needs to switch programs
+ *
+ * Built completely by the requesting thread, so that the switch itself is a
+ * handful of memcpy() calls and pointer stores.
+ */
+typedef struct
+{
+    plc_program_symbols_t symbols;
+    state_copy_t *copies;
+    size_t num_copies;
+    slot_swap_t *swaps;
+    size_t num_swaps;
+    atomic_bool applied;
+    long long switch_ns;
+} online_change_plan_t;
+
+static _Atomic(online_change_plan_t *) pending_plan = NULL;
+static variable_table_t active_vars                 = {NULL, 0};
+static PluginManager **retired_programs             = NULL;
+static size_t num_retired_programs                  = 0;
+
+static long long monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void online_change_program_loaded(void)
+{
+    variable_table_free(&active_vars);
+    if (variable_table_load(VARIABLES_CSV_PATH, &active_vars) != 0)
+    {
+        log_warn("Variable table not available, online change will be refused");
+    }
+}
+
+/*
+ * =============================================================================
+ * Switch Plan
+ * =============================================================================
+ */
+
+static void free_plan(online_change_plan_t *plan)
+{
+    if (plan != NULL)
+    {
+        free(plan->copies);
+        free(plan->swaps);
+        free(plan);
+    }
+}
+
+/**
+ * @brief Collect the debug variables whose values carry over
+ */
+static int plan_state_copies(online_change_plan_t *plan, PluginManager *new_pm,
+                             const variable_table_t *new_vars)
+{
+    const plc_program_symbols_t *sym = &plan->symbols;
+
+    if (active_vars.count == 0 || active_vars.count != ext_get_var_count())
+    {
+        log_error("Variable table of the running program does not match it (%zu entries, "
+                  "program has %u); restart the PLC instead",
+                  active_vars.count, (unsigned)ext_get_var_count());
+        return -1;
+    }
+    if (new_vars->count != sym->get_var_count())
+    {
+        log_error("%s does not match the new program (%zu entries, program has %u)",
+                  VARIABLES_CSV_PATH, new_vars->count, (unsigned)sym->get_var_count());
+        return -1;
+    }
+
+    long *old_index = malloc((new_vars->count + 1) * sizeof(*old_index));
+    plan->copies    = malloc((new_vars->count + 1) * sizeof(*plan->copies));
+    if (old_index == NULL || plan->copies == NULL ||
+        variable_table_match(&active_vars, new_vars, old_index) < 0)
+    {
+        log_error("Out of memory while matching program variables");
+        free(old_index);
+        return -1;
+    }
+
+    for (size_t i = 0; i < new_vars->count; i++)
+    {
+        if (old_index[i] < 0)
+        {
+            continue;
+        }
+        size_t old_idx = (size_t)old_index[i];
+        size_t size    = sym->get_var_size(i);
+        void *dst      = sym->get_var_addr(i);
+        void *src      = ext_get_var_addr(old_idx);
+        if (size == 0 || size != ext_get_var_size(old_idx) || dst == NULL || src == NULL)
+        {
+            continue;
+        }
+        plan->copies[plan->num_copies++] = (state_copy_t){dst, src, size};
+    }
+    free(old_index);
+    log_info("Online change: %zu of %zu variables carry over", plan->num_copies,
+             new_vars->count);
+
+    // Keep the program clock running where the old program left it
+    void *new_time = plugin_manager_get_symbol(new_pm, "__CURRENT_TIME");
+    void *old_time = plugin_manager_get_symbol(plc_program, "__CURRENT_TIME");
+    if (new_time != NULL && old_time != NULL)
+    {
+        plan->copies[plan->num_copies++] = (state_copy_t){new_time, old_time, sizeof(IEC_TIME)};
+    }
+    return 0;
+}
+
+/**
+ * @brief Collect the image table slots the new program binds differently
+ *
+ * Slots the new program leaves unbound point to the same temporary backing
+ * storage the running program uses, so only located variables cause swaps.
+ */
+static int plan_slot_swaps(online_change_plan_t *plan, image_tables_t *staging)
+{
+    image_table_view_t current[IMAGE_TABLE_COUNT];
+    image_table_view_t next[IMAGE_TABLE_COUNT];
+    image_tables_get_views(NULL, current);
+    image_tables_get_views(staging, next);
+
+    size_t capacity = 0;
+    for (int t = 0; t < IMAGE_TABLE_COUNT; t++)
+    {
+        for (size_t i = 0; i < next[t].count; i++)
+        {
+            void *ptr = next[t].slots[i];
+            if (ptr == NULL)
+            {
+                ptr = next[t].backing + i * next[t].elem_size;
+            }
+            if (ptr == current[t].slots[i])
+            {
+                continue;
+            }
+
+            if (plan->num_swaps == capacity)
+            {
+                capacity          = capacity ? capacity * 2 : 64;
+                slot_swap_t *swap = realloc(plan->swaps, capacity * sizeof(*swap));
+                if (swap == NULL)
+                {
+                    log_error("Out of memory while planning image table changes");
+                    return -1;
+                }
+                plan->swaps = swap;
+            }
+            plan->swaps[plan->num_swaps++] =
+                (slot_swap_t){&current[t].slots[i], ptr, next[t].elem_size};
+        }
+    }
+
+    log_info("Online change: %zu image table entries are rebound", plan->num_swaps);
+    return 0;
+}
+
+/**
+ * @brief Load, initialize and glue the new program and plan the switch
+ */
+static online_change_plan_t *prepare_plan(PluginManager *new_pm, variable_table_t *new_vars)
+{
+    online_change_plan_t *plan = calloc(1, sizeof(*plan));
+    image_tables_t *staging    = calloc(1, sizeof(*staging));
+    if (plan == NULL || staging == NULL)
+    {
+        log_error("Out of memory while preparing online change");
+        goto error;
+    }
+
+    if (!plugin_manager_load(new_pm) || symbols_load(new_pm, &plan->symbols) != 0)
+    {
+        goto error;
+    }
+
+    // dlopen() hands out the running library again if the file is the same one
+    if (plan->symbols.config_run__ == ext_config_run__)
+    {
+        log_error("Online change: %s is the running library", plugin_manager_get_path(new_pm));
+        goto error;
+    }
+
+    // The new program is glued into staging tables; the running one is not touched
+    symbols_set_buffer_pointers(&plan->symbols, staging);
+    plan->symbols.config_init__();
+    plan->symbols.glueVars();
+
+    if (variable_table_load(VARIABLES_CSV_PATH, new_vars) != 0 ||
+        plan_state_copies(plan, new_pm, new_vars) != 0 || plan_slot_swaps(plan, staging) != 0)
+    {
+        goto error;
+    }
+
+    free(staging);
+    return plan;
+
+error:
+    free(staging);
+    free_plan(plan);
+    return NULL;
+}
+
+void online_change_apply_pending(void)
+{
+    if (atomic_load_explicit(&pending_plan, memory_order_acquire) == NULL)
+    {
+        return;
+    }
+
+    // Claim the plan; the requester may have withdrawn it in the meantime
+    online_change_plan_t *plan = atomic_exchange(&pending_plan, NULL);
+    if (plan == NULL)
+    {
+        return;
+    }
+
+    long long start = monotonic_ns();
+
+    // A recording only replays against the program that made it
+    flight_recorder_stop();
+
+    for (size_t i = 0; i < plan->num_copies; i++)
+    {
+        memcpy(plan->copies[i].dst, plan->copies[i].src, plan->copies[i].size);
+    }
+
+    // Image values move along with their slots, so outputs do not glitch
+    for (size_t i = 0; i < plan->num_swaps; i++)
+    {
+        slot_swap_t *swap = &plan->swaps[i];
+        memcpy(swap->ptr, *swap->slot, swap->size);
+        *swap->slot = swap->ptr;
+    }
+
+    symbols_install(&plan->symbols);
+    symbols_set_buffer_pointers(&plan->symbols, NULL);
+
+    // The FAST_RESTART snapshot belongs to the replaced program
+    fast_restart_release();
+
+    // Native plugins re-resolve cached addresses before the next cycle hook
+    plugin_driver_program_changed(plugin_driver, PLUGIN_TYPE_NATIVE);
+
+    plan->switch_ns = monotonic_ns() - start;
+    atomic_store_explicit(&plan->applied, true, memory_order_release);
+}
+
+/**
+ * @brief Wait for the scan thread to switch, or withdraw the plan
+ *
+ * @return true if the new program is active
+ */
+static bool wait_for_switch(online_change_plan_t *plan)
+{
+    long long timeout_ns = 2 * (long long)*ext_common_ticktime__;
+    if (timeout_ns < SWITCH_TIMEOUT_MIN_NS)
+    {
+        timeout_ns = SWITCH_TIMEOUT_MIN_NS;
+    }
+    long long deadline            = monotonic_ns() + timeout_ns;
+    const struct timespec poll_ts = {0, 1000 * 1000};
+
+    while (!atomic_load_explicit(&plan->applied, memory_order_acquire))
+    {
+        if (monotonic_ns() > deadline || plc_get_state() != PLC_STATE_RUNNING)
+        {
+            if (atomic_exchange(&pending_plan, NULL) == plan)
+            {
+                return false;
+            }
+            // The scan thread already claimed it; the switch completes shortly
+            deadline = INT64_MAX;
+        }
+        nanosleep(&poll_ts, NULL);
+    }
+    return true;
+}
+
+int online_change_execute(void)
+{
+    if (plc_get_state() != PLC_STATE_RUNNING || plc_program == NULL)
+    {
+        log_error("Online change requires a running PLC program");
+        return -1;
+    }
+    if (multi_task_active())
+    {
+        // Task threads call into the running library and its task table
+        log_error("Online change is not available in multi-task mode");
+        return -1;
+    }
+
+    char *libplc_path = find_libplc_file(libplc_build_dir);
+    if (libplc_path == NULL)
+    {
+        return -1;
+    }
+    if (strcmp(libplc_path, plugin_manager_get_path(plc_program)) == 0)
+    {
+        log_error("Online change: %s is already running", libplc_path);
+        free(libplc_path);
+        return -1;
+    }
+
+    log_info("Online change: preparing %s", libplc_path);
+    PluginManager *new_pm = plugin_manager_create(libplc_path);
+    free(libplc_path);
+
+    // Reserve the retired slot now so nothing can fail after the switch
+    PluginManager **retired =
+        realloc(retired_programs, (num_retired_programs + 1) * sizeof(*retired));
+    if (retired != NULL)
+    {
+        retired_programs = retired;
+    }
+
+    variable_table_t new_vars = {NULL, 0};
+    online_change_plan_t *plan = new_pm && retired ? prepare_plan(new_pm, &new_vars) : NULL;
+    if (plan == NULL)
+    {
+        log_error("Online change failed, the running program is unchanged");
+        variable_table_free(&new_vars);
+        plugin_manager_destroy(new_pm);
+        return -1;
+    }
+
+    // Python plugins read program memory on their own threads, keep them off it
+    // until they re-resolved their addresses against the new program
+    plugin_driver_program_changing(plugin_driver);
+
+    atomic_store_explicit(&pending_plan, plan, memory_order_release);
+    if (!wait_for_switch(plan))
+    {
+        log_error("Online change: the PLC cycle did not pick up the new program, "
+                  "the running program is unchanged");
+        plugin_driver_program_changed(plugin_driver, PLUGIN_TYPE_PYTHON);
+        free_plan(plan);
+        variable_table_free(&new_vars);
+        plugin_manager_destroy(new_pm);
+        return -1;
+    }
+
+    PluginManager *old_pm = plc_program;
+    plc_program           = new_pm;
+    variable_table_free(&active_vars);
+    active_vars = new_vars;
+
+    // Python function blocks of the old program are not called anymore
+    void (*python_cleanup)(void);
+    *(void **)(&python_cleanup) = plugin_manager_get_symbol(old_pm, "python_blocks_cleanup");
+    if (python_cleanup)
+    {
+        python_cleanup();
+    }
+    retired_programs[num_retired_programs++] = old_pm;
+
+    // RETAIN variables moved with the program, the values carried over already
+    retain_store_close();
+    if (retain_store_open(false) != 0)
+    {
+        log_error("Retain store not available, RETAIN variables will not persist");
+    }
+    warm_restart_close(false);
+    if (warm_restart_open(false) != 0)
+    {
+        log_error("Warm restart checkpoints not available");
+    }
+
+    plugin_driver_program_changed(plugin_driver, PLUGIN_TYPE_PYTHON);
+
+    log_info("Online change complete: switched at the cycle boundary in %lld us",
+             plan->switch_ns / 1000);
+    free_plan(plan);
+    return 0;
+}
+
+void online_change_release_retired(void)
+{
+    for (size_t i = 0; i < num_retired_programs; i++)
+    {
+        plugin_manager_destroy(retired_programs[i]);
+    }
+    if (num_retired_programs > 0)
+    {
+        log_info("Unloaded %zu program(s) replaced by online change", num_retired_programs);
+    }
+    free(retired_programs);
+    retired_programs     = NULL;
+    num_retired_programs = 0;
+}
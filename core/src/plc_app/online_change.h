@@ -0,0 +1,45 @@
+#ifndef ONLINE_CHANGE_H
+#define ONLINE_CHANGE_H
+
+/**
+ * @brief Remember the variable table of the program that is being loaded
+ *
+ * Called by the state manager whenever a program is loaded from scratch. The
+ * table is kept in memory because an upload replaces VARIABLES.csv before the
+ * online change request arrives.
+ */
+void online_change_program_loaded(void);
+
+/**
+ * @brief Replace the running program by the newly built one without stopping
+ *
+ * Loads the new libplc_*.so next to the running one, initializes and glues it
+ * into staging image tables, and hands a prepared switch plan to the PLC cycle
+ * thread. The switch happens at the start of the next scan cycle; variables with
+ * the same name and type keep their values and image table values carry over.
+ * On any failure before the switch the running program is left untouched.
+ *
+ * @note Must be called from the thread that also handles START/STOP commands.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int online_change_execute(void);
+
+/**
+ * @brief Switch to a pending program, if any
+ *
+ * @note Called by the PLC cycle thread at the top of every cycle with buffer_mutex held.
+ */
+void online_change_apply_pending(void);
+
+/**
+ * @brief Unload the programs replaced by online changes
+ *
+ * Replaced programs stay mapped until the PLC stops, so that threads still
+ * holding a pointer into them never touch unmapped memory.
+ *
+ * @note Call after the PLC cycle thread has exited and plugins are stopped.
+ */
+void online_change_release_retired(void);
+
+#endif // ONLINE_CHANGE_H
@@ -0,0 +1,175 @@
+#define _GNU_SOURCE
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "../drivers/plugin_driver.h"
+#include "overrun_forensics.h"
+
+static const char *const phase_names[OVERRUN_PHASE_COUNT] = {
+    "mutex_wait", "journal",      "cycle_start", "input_latch",
+    "program",    "output_flush", "cycle_end",   "capture",
+};
+
+// State of the current scan, only used by the PLC cycle thread
+static struct timespec phase_start;
+static int64_t phase_ns[OVERRUN_PHASE_COUNT];
+static size_t scan_journal_entries;
+static struct rusage scan_start_usage;
+
+// Ring of the last overruns, read by the unix socket thread
+static overrun_record_t records[OVERRUN_FORENSICS_RECORDS];
+static uint64_t record_count        = 0;
+static pthread_mutex_t record_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int64_t elapsed_ns(const struct timespec *from, const struct timespec *to)
+{
+    return (int64_t)(to->tv_sec - from->tv_sec) * 1000000000LL + (to->tv_nsec - from->tv_nsec);
+}
+
+static void thread_usage(struct rusage *usage)
+{
+#ifdef RUSAGE_THREAD
+    getrusage(RUSAGE_THREAD, usage);
+#else
+    getrusage(RUSAGE_SELF, usage);
+#endif
+}
+
+void overrun_forensics_scan_start(void)
+{
+    memset(phase_ns, 0, sizeof(phase_ns));
+    scan_journal_entries = 0;
+    plugin_driver_reset_hook_timing();
+
+    // One system call per scan; the end of the scan is only read after an overrun
+    thread_usage(&scan_start_usage);
+    clock_gettime(CLOCK_MONOTONIC, &phase_start);
+}
+
+void overrun_forensics_phase_end(overrun_phase_t phase)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    phase_ns[phase] += elapsed_ns(&phase_start, &now);
+    phase_start = now;
+}
+
+void overrun_forensics_journal_applied(size_t entries)
+{
+    scan_journal_entries = entries;
+}
+
+void overrun_forensics_scan_end(bool overrun, unsigned long tick, int64_t start_latency_us,
+                                int64_t scan_time_us)
+{
+    if (!overrun)
+    {
+        return;
+    }
+
+    overrun_record_t record;
+    memset(&record, 0, sizeof(record));
+
+    struct rusage usage;
+    thread_usage(&usage);
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+
+    record.tick             = tick;
+    record.wall_time_ns     = (int64_t)wall.tv_sec * 1000000000LL + wall.tv_nsec;
+    record.start_latency_us = start_latency_us;
+    record.scan_time_us     = scan_time_us;
+    record.journal_entries  = scan_journal_entries;
+    for (int i = 0; i < OVERRUN_PHASE_COUNT; i++)
+    {
+        record.phase_us[i] = phase_ns[i] / 1000;
+    }
+
+    const plugin_hook_timing_t *hook = plugin_driver_longest_hook();
+    record.hook_us                   = -1;
+    if (hook != NULL)
+    {
+        snprintf(record.hook_plugin, sizeof(record.hook_plugin), "%s", hook->plugin);
+        record.hook_name = hook->hook;
+        record.hook_us   = hook->duration_ns / 1000;
+    }
+
+    record.involuntary_switches = usage.ru_nivcsw - scan_start_usage.ru_nivcsw;
+    record.minor_faults         = usage.ru_minflt - scan_start_usage.ru_minflt;
+    record.major_faults         = usage.ru_majflt - scan_start_usage.ru_majflt;
+
+    pthread_mutex_lock(&record_mutex);
+    records[record_count % OVERRUN_FORENSICS_RECORDS] = record;
+    record_count++;
+    pthread_mutex_unlock(&record_mutex);
+}
+
+int format_overrun_forensics_response(char *buffer, size_t buffer_size)
+{
+    static overrun_record_t snapshot[OVERRUN_FORENSICS_RECORDS];
+
+    // Only the unix socket thread formats responses, so the snapshot can be static
+    pthread_mutex_lock(&record_mutex);
+    uint64_t count = record_count;
+    memcpy(snapshot, records, sizeof(snapshot));
+    pthread_mutex_unlock(&record_mutex);
+
+    uint64_t kept  = count < OVERRUN_FORENSICS_RECORDS ? count : OVERRUN_FORENSICS_RECORDS;
+    uint64_t first = count - kept;
+
+    int written = snprintf(buffer, buffer_size, "FORENSICS:{\"overruns\":%" PRIu64 ",\"records\":[",
+                           count);
+    for (uint64_t n = 0; n < kept && written >= 0 && (size_t)written < buffer_size; n++)
+    {
+        const overrun_record_t *r = &snapshot[(first + n) % OVERRUN_FORENSICS_RECORDS];
+
+        written += snprintf(buffer + written, buffer_size - written,
+                            "%s{\"tick\":%" PRIu64 ",\"wall_time_ns\":%" PRId64
+                            ",\"start_latency_us\":%" PRId64 ",\"scan_time_us\":%" PRId64
+                            ",\"phases_us\":{",
+                            n > 0 ? "," : "", r->tick, r->wall_time_ns, r->start_latency_us,
+                            r->scan_time_us);
+        for (int i = 0; i < OVERRUN_PHASE_COUNT && (size_t)written < buffer_size; i++)
+        {
+            written += snprintf(buffer + written, buffer_size - written, "%s\"%s\":%" PRId64,
+                                i > 0 ? "," : "", phase_names[i], r->phase_us[i]);
+        }
+        if ((size_t)written >= buffer_size)
+        {
+            break;
+        }
+
+        if (r->hook_us >= 0)
+        {
+            written += snprintf(buffer + written, buffer_size - written,
+                                "},\"longest_hook\":{\"plugin\":\"%s\",\"hook\":\"%s\","
+                                "\"duration_us\":%" PRId64 "}",
+                                r->hook_plugin, r->hook_name, r->hook_us);
+        }
+        else
+        {
+            written += snprintf(buffer + written, buffer_size - written, "},\"longest_hook\":null");
+        }
+        if ((size_t)written >= buffer_size)
+        {
+            break;
+        }
+
+        written += snprintf(buffer + written, buffer_size - written,
+                            ",\"journal_entries\":%" PRIu64 ",\"involuntary_switches\":%" PRId64
+                            ",\"minor_faults\":%" PRId64 ",\"major_faults\":%" PRId64 "}",
+                            r->journal_entries, r->involuntary_switches, r->minor_faults,
+                            r->major_faults);
+    }
+    if (written < 0 || (size_t)written >= buffer_size)
+    {
+        return written;
+    }
+
+    written += snprintf(buffer + written, buffer_size - written, "]}\n");
+    return written;
+}
@@ -0,0 +1,86 @@
+#ifndef OVERRUN_FORENSICS_H
+#define OVERRUN_FORENSICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Overruns kept for the FORENSICS command, older ones are overwritten
+#define OVERRUN_FORENSICS_RECORDS 16
+
+// Phases of a scan of the PLC cycle thread, in execution order
+typedef enum
+{
+    OVERRUN_PHASE_MUTEX_WAIT,   // Waiting for buffer_mutex
+    OVERRUN_PHASE_JOURNAL,      // Pending online change and journal entries
+    OVERRUN_PHASE_CYCLE_START,  // cycle_start hooks
+    OVERRUN_PHASE_INPUT_LATCH,  // input_latch hooks
+    OVERRUN_PHASE_PROGRAM,      // PLC program, or the task release in multi-task mode
+    OVERRUN_PHASE_OUTPUT_FLUSH, // output_flush hooks
+    OVERRUN_PHASE_CYCLE_END,    // Time update, flight recorder and cycle_end hooks
+    OVERRUN_PHASE_CAPTURE,      // RETAIN and warm restart capture, releasing the tables
+    OVERRUN_PHASE_COUNT
+} overrun_phase_t;
+
+/**
+ * @brief What a scan that overran its period was doing
+ */
+typedef struct
+{
+    uint64_t tick;
+    int64_t wall_time_ns; // CLOCK_REALTIME at the end of the scan
+    int64_t start_latency_us; // A late start can overrun a short scan
+    int64_t scan_time_us;
+    int64_t phase_us[OVERRUN_PHASE_COUNT];
+    uint64_t journal_entries; // Entries applied by this scan
+
+    // Longest native hook of the scan, hook_us is -1 if no hook ran
+    char hook_plugin[32];
+    const char *hook_name;
+    int64_t hook_us;
+
+    // Of the PLC cycle thread, during the scan
+    int64_t involuntary_switches;
+    int64_t minor_faults;
+    int64_t major_faults;
+} overrun_record_t;
+
+/**
+ * @brief Start timing a scan
+ *
+ * Reads the context switch and page fault counters of the calling thread,
+ * and starts the first phase.
+ *
+ * @note Called by the PLC cycle thread before it takes buffer_mutex.
+ */
+void overrun_forensics_scan_start(void);
+
+/**
+ * @brief End a phase of the scan; the next phase starts now
+ */
+void overrun_forensics_phase_end(overrun_phase_t phase);
+
+/**
+ * @brief Note the number of journal entries the scan applied
+ */
+void overrun_forensics_journal_applied(size_t entries);
+
+/**
+ * @brief Finish the scan and keep its record if it overran
+ *
+ * @param overrun           Result of scan_cycle_time_end()
+ * @param tick              Common tick of the scan
+ * @param start_latency_us  Start of the scan after its scheduled start
+ * @param scan_time_us      Duration of the scan
+ */
+void overrun_forensics_scan_end(bool overrun, unsigned long tick, int64_t start_latency_us,
+                                int64_t scan_time_us);
+
+/**
+ * @brief Format the kept records, oldest first, for the FORENSICS command
+ *
+ * @return Number of characters written (excluding null terminator)
+ */
+int format_overrun_forensics_response(char *buffer, size_t buffer_size);
+
+#endif // OVERRUN_FORENSICS_H
@@ -0,0 +1,135 @@
+#include <inttypes.h>
+#include <stdatomic.h>
+
+#include "phase_align.h"
+#include "utils/log.h"
+
+#define NS_PER_SEC 1000000000ll
+
+static bool enabled         = false;
+static clockid_t ref_clock  = CLOCK_REALTIME;
+static int64_t phase_offset = 0;
+
+// Read by the statistics thread while the cycle thread updates them
+static atomic_int_least64_t last_error;
+static atomic_int_least64_t max_error;
+static atomic_uint_least64_t slewed_cycles;
+
+static int64_t timespec_ns(const struct timespec *ts)
+{
+    return (int64_t)ts->tv_sec * NS_PER_SEC + ts->tv_nsec;
+}
+
+static void ns_timespec(int64_t ns, struct timespec *ts)
+{
+    ts->tv_sec  = ns / NS_PER_SEC;
+    ts->tv_nsec = ns % NS_PER_SEC;
+}
+
+/**
+ * @brief Reference clock minus CLOCK_MONOTONIC, read between two monotonic reads
+ *
+ * Follows steps and frequency corrections of the reference clock, so it is
+ * read again for every cycle.
+ */
+static int64_t reference_offset_ns(void)
+{
+    struct timespec before, reference, after;
+    clock_gettime(CLOCK_MONOTONIC, &before);
+    clock_gettime(ref_clock, &reference);
+    clock_gettime(CLOCK_MONOTONIC, &after);
+
+    return timespec_ns(&reference) - (timespec_ns(&before) + timespec_ns(&after)) / 2;
+}
+
+/**
+ * @brief Distance of a monotonic time from the nearest scan start of the grid
+ *
+ * @return Phase error in [-period/2, period/2), positive when late
+ */
+static int64_t grid_error_ns(int64_t monotonic_ns, int64_t period)
+{
+    int64_t error = (monotonic_ns + reference_offset_ns() - phase_offset) % period;
+    if (error < 0)
+    {
+        error += period;
+    }
+    if (error >= period / 2)
+    {
+        error -= period;
+    }
+    return error;
+}
+
+void phase_align_configure(clockid_t clock, int64_t offset_ns)
+{
+    enabled      = true;
+    ref_clock    = clock;
+    phase_offset = offset_ns;
+}
+
+bool phase_align_enabled(void)
+{
+    return enabled;
+}
+
+void phase_align_start(struct timespec *start, uint64_t period_ns)
+{
+    int64_t period = (int64_t)period_ns;
+    int64_t now    = timespec_ns(start);
+    int64_t error  = grid_error_ns(now, period);
+
+    // The next grid point, never one in the past
+    ns_timespec(now + (error <= 0 ? -error : period - error), start);
+
+    atomic_store(&last_error, 0);
+    atomic_store(&max_error, 0);
+    atomic_store(&slewed_cycles, 0);
+
+    const char *clock_name = ref_clock == CLOCK_REALTIME ? "CLOCK_REALTIME" : "CLOCK_TAI";
+    log_info("Phase alignment: scans start %" PRId64 " ns after multiples of %" PRIu64 " ns on %s",
+             phase_offset % period, period_ns, clock_name);
+}
+
+void phase_align_adjust(struct timespec *next_start, uint64_t period_ns)
+{
+    int64_t period = (int64_t)period_ns;
+    int64_t next   = timespec_ns(next_start);
+    int64_t error  = grid_error_ns(next, period);
+
+    // Clock drift is corrected at once, a step of the reference clock over many cycles
+    int64_t max_slew = period * PHASE_ALIGN_MAX_SLEW_PPM / 1000000;
+    if (max_slew < 1)
+    {
+        max_slew = 1;
+    }
+    int64_t correction = error;
+    if (correction > max_slew || correction < -max_slew)
+    {
+        correction = correction > 0 ? max_slew : -max_slew;
+        atomic_fetch_add(&slewed_cycles, 1);
+    }
+    ns_timespec(next - correction, next_start);
+
+    int64_t magnitude = error < 0 ? -error : error;
+    atomic_store(&last_error, error);
+    if (magnitude > atomic_load(&max_error))
+    {
+        atomic_store(&max_error, magnitude);
+    }
+}
+
+int64_t phase_align_error_ns(void)
+{
+    return atomic_load(&last_error);
+}
+
+int64_t phase_align_error_max_ns(void)
+{
+    return atomic_load(&max_error);
+}
+
+uint64_t phase_align_slewed_cycles(void)
+{
+    return atomic_load(&slewed_cycles);
+}
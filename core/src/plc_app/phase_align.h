@@ -0,0 +1,67 @@
+#ifndef PHASE_ALIGN_H
+#define PHASE_ALIGN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// Largest correction of one cycle start, in parts per million of the task period
+#define PHASE_ALIGN_MAX_SLEW_PPM 1000
+
+/**
+ * @brief Configure scan start phase alignment
+ *
+ * When enabled, scans start on multiples of the task period on a
+ * synchronized clock (PTP or NTP disciplined) plus a phase offset, so the
+ * scans of several controllers, and their fieldbus cycles, start together.
+ * The cycle thread still sleeps on CLOCK_MONOTONIC; every cycle start is
+ * moved towards the grid of the reference clock by at most
+ * PHASE_ALIGN_MAX_SLEW_PPM of the period, so a step of the reference clock
+ * is absorbed gradually instead of shortening or stretching one scan.
+ *
+ * @param clock      CLOCK_REALTIME or CLOCK_TAI
+ * @param offset_ns  Phase of the scan starts within the period
+ */
+void phase_align_configure(clockid_t clock, int64_t offset_ns);
+
+/**
+ * @brief Whether scan starts are aligned to a reference clock
+ */
+bool phase_align_enabled(void);
+
+/**
+ * @brief Move the first scan start to the next multiple of the period
+ *
+ * @param start      Monotonic start time of the first scan, updated in place
+ * @param period_ns  Task period
+ *
+ * @note Called by the PLC cycle thread before the first scan.
+ */
+void phase_align_start(struct timespec *start, uint64_t period_ns);
+
+/**
+ * @brief Measure the phase error of the next scan start and slew it
+ *
+ * @param next_start  Monotonic start time of the next scan, updated in place
+ * @param period_ns   Task period
+ *
+ * @note Called by the PLC cycle thread after computing the next start time.
+ */
+void phase_align_adjust(struct timespec *next_start, uint64_t period_ns);
+
+/**
+ * @brief Phase error of the last scheduled scan start, before its correction
+ */
+int64_t phase_align_error_ns(void);
+
+/**
+ * @brief Largest absolute phase error since the first scan
+ */
+int64_t phase_align_error_max_ns(void);
+
+/**
+ * @brief Number of cycle starts whose correction was limited by the slew rate
+ */
+uint64_t phase_align_slewed_cycles(void);
+
+#endif // PHASE_ALIGN_H
@@ -13,14 +13,23 @@
 #include <unistd.h>
 
 #include "../drivers/plugin_driver.h"
+#include "flight_recorder.h"
+#include "free_run.h"
 #include "image_tables.h"
+#include "multi_task.h"
+#include "phase_align.h"
 #include "plc_state_manager.h"
 #include "plcapp_manager.h"
+#include "retain_store.h"
 #include "scan_cycle_manager.h"
+#include "sched_deadline.h"
+#include "tcp_connection_manager.h"
+#include "tcp_socket_io.h"
 #include "unix_socket.h"
 #include "utils/log.h"
 #include "utils/utils.h"
 #include "utils/watchdog.h"
+#include "warm_restart.h"
 
 extern PLCState plc_state;
 volatile sig_atomic_t keep_running = 1;
@@ -35,8 +44,16 @@ void handle_sigint(int sig)
 
 int main(int argc, char *argv[])
 {
-    bool print_debug = false;
-    bool safe_mode   = false;
+    bool print_debug             = false;
+    bool safe_mode               = false;
+    bool warm_start              = false;
+    const char *checkpoint_file  = NULL;
+    unsigned int checkpoint_ms   = 0;
+    bool free_run                = false;
+    unsigned long free_run_scans = 0;
+    const char *input_script     = NULL;
+    const char *phase_clock      = NULL;
+    long long phase_offset_us    = 0;
 
     // Check for command line arguments
     for (int i = 1; i < argc; i++)
@@ -53,6 +70,93 @@ int main(int argc, char *argv[])
         {
             safe_mode = true;
         }
+        else if (strcmp(argv[i], "--retain-file") == 0 && i + 1 < argc)
+        {
+            retain_store_configure(argv[++i], 0);
+        }
+        else if (strcmp(argv[i], "--retain-interval") == 0 && i + 1 < argc)
+        {
+            retain_store_configure(NULL, (unsigned int)strtoul(argv[++i], NULL, 10));
+        }
+        else if (strcmp(argv[i], "--tcp-connect-timeout") == 0 && i + 1 < argc)
+        {
+            tcp_connection_manager_configure((unsigned int)strtoul(argv[++i], NULL, 10), 0, 0, 0);
+        }
+        else if (strcmp(argv[i], "--warm-start") == 0)
+        {
+            warm_start = true;
+        }
+        else if (strcmp(argv[i], "--checkpoint-file") == 0 && i + 1 < argc)
+        {
+            checkpoint_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc)
+        {
+            checkpoint_ms = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            flight_recorder_configure(argv[++i], 0);
+        }
+        else if (strcmp(argv[i], "--record-size") == 0 && i + 1 < argc)
+        {
+            flight_recorder_configure(NULL, (unsigned int)strtoul(argv[++i], NULL, 10));
+        }
+        else if (strcmp(argv[i], "--free-run") == 0)
+        {
+            free_run = true;
+        }
+        else if (strcmp(argv[i], "--free-run-scans") == 0 && i + 1 < argc)
+        {
+            free_run_scans = strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--inputs") == 0 && i + 1 < argc)
+        {
+            input_script = argv[++i];
+        }
+        else if (strcmp(argv[i], "--multi-task") == 0)
+        {
+            multi_task_configure(true);
+        }
+        else if (strcmp(argv[i], "--scan-watchdog") == 0 && i + 1 < argc)
+        {
+            // Warning, safe outputs and ERROR limits in task periods, e.g. 3,10,50
+            unsigned int limits[3] = {0, 0, 0};
+            sscanf(argv[++i], "%u,%u,%u", &limits[0], &limits[1], &limits[2]);
+            scan_watchdog_configure(limits[0], limits[1], limits[2]);
+        }
+        else if (strcmp(argv[i], "--sched-deadline") == 0)
+        {
+            sched_deadline_configure(true);
+        }
+        else if (strcmp(argv[i], "--phase-align") == 0 && i + 1 < argc)
+        {
+            phase_clock = argv[++i];
+        }
+        else if (strcmp(argv[i], "--phase-offset-us") == 0 && i + 1 < argc)
+        {
+            phase_offset_us = strtoll(argv[++i], NULL, 10);
+        }
+    }
+    warm_restart_configure(warm_start, checkpoint_file, checkpoint_ms);
+    free_run_configure(free_run, free_run_scans, input_script);
+
+    if (phase_clock != NULL)
+    {
+        if (strcmp(phase_clock, "realtime") == 0)
+        {
+            phase_align_configure(CLOCK_REALTIME, phase_offset_us * 1000);
+        }
+        else if (strcmp(phase_clock, "tai") == 0)
+        {
+            phase_align_configure(CLOCK_TAI, phase_offset_us * 1000);
+        }
+        else
+        {
+            fprintf(stderr, "Unknown --phase-align clock '%s', expected realtime or tai\n",
+                    phase_clock);
+            return 1;
+        }
     }
 
     // Initialize logging system
@@ -89,6 +193,22 @@ int main(int argc, char *argv[])
         log_error("Failed to initialize watchdog");
         return -1;
     }
+    if (scan_watchdog_init() != 0)
+    {
+        log_error("Failed to initialize scan watchdog");
+    }
+
+    // Start the connection manager used by the TCP_CONNECT function block
+    if (tcp_connection_manager_init() != 0)
+    {
+        log_error("Failed to start TCP connection manager");
+    }
+
+    // Start the I/O thread behind TCP_SEND and TCP_RECEIVE
+    if (tcp_socket_io_init() != 0)
+    {
+        log_error("Failed to start TCP socket I/O thread");
+    }
 
     // Start UNIX socket server
     if (setup_unix_socket() != 0)
@@ -153,5 +273,7 @@ int main(int argc, char *argv[])
     // Cleanup
     log_info("Shutting down...");
     plc_state_manager_cleanup();
+    tcp_connection_manager_cleanup();
+    tcp_socket_io_cleanup();
     return 0;
 }
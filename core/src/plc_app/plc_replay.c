@@ -0,0 +1,392 @@
+// Deterministic replay of a flight recording
+//
+// Loads a libplc_*.so and a recording made with plc_main --record, applies
+// the recorded writes in the same order and executes the same number of scans
+// back to back, with no plugins, sockets or real-time scheduling. After every
+// scan the located outputs are compared with the recorded ones. Used to
+// reproduce field incidents offline and to compare scan times of a new program
+// build against production traffic.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "flight_recorder.h"
+#include "image_tables.h"
+#include "plcapp_manager.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+
+// log.c stops its socket thread through this flag
+volatile sig_atomic_t keep_running = 1;
+extern bool print_logs;
+
+#define DEFAULT_MAX_MISMATCHES 10
+#define MAX_DIFFERENCES_PER_SCAN 4
+
+// Index into the located outputs, by type, index and bit
+#define OUTPUT_KEY(type, index, bit) ((((size_t)(type)*BUFFER_SIZE) + (index)) * 8 + (bit))
+#define OUTPUT_KEY_COUNT OUTPUT_KEY(JOURNAL_TYPE_COUNT, 0, 0)
+
+typedef struct
+{
+    flight_record_output_t *outputs;
+    int num_outputs;
+    uint64_t *expected; // Recorded value of every located output
+    int *lookup;        // OUTPUT_KEY -> index into outputs, or -1
+
+    bool compare;
+    unsigned long max_mismatches;
+    unsigned long mismatched_scans;
+} replay_state_t;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s <libplc.so> <recording> [--no-compare] [--max-mismatches N]\n"
+            "\n"
+            "  --no-compare        Only time the scans, e.g. for a changed program\n"
+            "  --max-mismatches N  Scans with output differences to print (default %d)\n",
+            prog, DEFAULT_MAX_MISMATCHES);
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void format_location(const flight_record_output_t *output, char *buf, size_t size)
+{
+    switch (output->type)
+    {
+    case JOURNAL_BOOL_OUTPUT:
+        snprintf(buf, size, "%%QX%u.%u", output->index, output->bit);
+        break;
+    case JOURNAL_BYTE_OUTPUT:
+        snprintf(buf, size, "%%QB%u", output->index);
+        break;
+    case JOURNAL_INT_OUTPUT:
+        snprintf(buf, size, "%%QW%u", output->index);
+        break;
+    case JOURNAL_DINT_OUTPUT:
+        snprintf(buf, size, "%%QD%u", output->index);
+        break;
+    default:
+        snprintf(buf, size, "%%QL%u", output->index);
+        break;
+    }
+}
+
+/**
+ * @brief Take the recorded output values between p and end as expected values
+ */
+static void apply_expected(replay_state_t *state, const uint8_t *p, const uint8_t *end)
+{
+    while (p < end)
+    {
+        journal_buffer_type_t type;
+        uint16_t index;
+        uint8_t bit;
+        uint64_t value;
+        size_t size = flight_record_value_record_size(p, end);
+
+        flight_record_decode_value(p, &type, &index, &bit, &value);
+        if (index < BUFFER_SIZE && bit < 8)
+        {
+            int i = state->lookup[OUTPUT_KEY(type, index, bit)];
+            if (i >= 0)
+            {
+                state->expected[i] = value;
+            }
+        }
+        p += size;
+    }
+}
+
+static void compare_outputs(replay_state_t *state, unsigned long scan)
+{
+    bool print      = state->mismatched_scans < state->max_mismatches;
+    int differences = 0;
+    for (int i = 0; i < state->num_outputs; i++)
+    {
+        flight_record_output_t *output = &state->outputs[i];
+        uint64_t actual                = flight_record_load(output->addr, output->type);
+        if (actual == state->expected[i])
+        {
+            continue;
+        }
+        if (print && differences == 0)
+        {
+            printf("scan %lu:", scan);
+        }
+        if (print && differences < MAX_DIFFERENCES_PER_SCAN)
+        {
+            char location[32];
+            format_location(output, location, sizeof(location));
+            printf(" %s expected %llu got %llu", location,
+                   (unsigned long long)state->expected[i], (unsigned long long)actual);
+        }
+        differences++;
+    }
+
+    if (differences == 0)
+    {
+        return;
+    }
+    if (print)
+    {
+        if (differences > MAX_DIFFERENCES_PER_SCAN)
+        {
+            printf(" (%d more)", differences - MAX_DIFFERENCES_PER_SCAN);
+        }
+        printf("\n");
+    }
+    state->mismatched_scans++;
+}
+
+static int bind_outputs(replay_state_t *state)
+{
+    state->num_outputs = flight_record_bind_outputs(&state->outputs);
+    state->expected    = calloc((size_t)state->num_outputs + 1, sizeof(uint64_t));
+    state->lookup      = malloc(OUTPUT_KEY_COUNT * sizeof(int));
+    if (state->num_outputs < 0 || state->expected == NULL || state->lookup == NULL)
+    {
+        return -1;
+    }
+
+    memset(state->lookup, 0xFF, OUTPUT_KEY_COUNT * sizeof(int));
+    for (int i = 0; i < state->num_outputs; i++)
+    {
+        flight_record_output_t *output = &state->outputs[i];
+        state->lookup[OUTPUT_KEY(output->type, output->index, output->bit)] = i;
+        state->expected[i] = flight_record_load(output->addr, output->type);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *so_path        = NULL;
+    const char *recording_path = NULL;
+    replay_state_t state       = {.compare = true, .max_mismatches = DEFAULT_MAX_MISMATCHES};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--no-compare") == 0)
+        {
+            state.compare = false;
+        }
+        else if (strcmp(argv[i], "--max-mismatches") == 0 && i + 1 < argc)
+        {
+            state.max_mismatches = strtoul(argv[++i], NULL, 10);
+        }
+        else if (argv[i][0] != '-' && so_path == NULL)
+        {
+            so_path = argv[i];
+        }
+        else if (argv[i][0] != '-' && recording_path == NULL)
+        {
+            recording_path = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (so_path == NULL || recording_path == NULL)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Only errors, on stdout: the loader logs every step at info level
+    log_set_level(LOG_LEVEL_ERROR);
+    print_logs = true;
+
+    int fd = open(recording_path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(flight_record_header_t))
+    {
+        fprintf(stderr, "Failed to read recording %s\n", recording_path);
+        return 1;
+    }
+    uint8_t *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to map recording %s\n", recording_path);
+        return 1;
+    }
+
+    const flight_record_header_t *header = (const flight_record_header_t *)map;
+    if (header->magic != FLIGHT_RECORD_MAGIC || header->version != FLIGHT_RECORD_VERSION)
+    {
+        fprintf(stderr, "%s is not a flight recording\n", recording_path);
+        return 1;
+    }
+    size_t used = (size_t)st.st_size - sizeof(*header);
+    if (header->used < used)
+    {
+        used = header->used;
+    }
+    if (header->truncated)
+    {
+        printf("Recording stopped early because the file was full\n");
+    }
+
+    PluginManager *pm = plugin_manager_create(so_path);
+    if (pm == NULL || !plugin_manager_load(pm) || symbols_init(pm) != 0)
+    {
+        fprintf(stderr, "Failed to load PLC program %s\n", so_path);
+        return 1;
+    }
+    ext_config_init__();
+    ext_glueVars();
+    image_tables_fill_null_pointers();
+
+    if (ext_plc_program_md5 && strncmp(header->program_md5, ext_plc_program_md5,
+                                       sizeof(header->program_md5)) != 0)
+    {
+        printf("Recorded with program build %.*s, replaying %s\n",
+               (int)sizeof(header->program_md5), header->program_md5, ext_plc_program_md5);
+    }
+
+    if (bind_outputs(&state) != 0)
+    {
+        fprintf(stderr, "Not enough memory to bind the outputs\n");
+        return 1;
+    }
+
+    size_t capacity   = header->scans > 0 ? header->scans : 1024;
+    uint64_t *scan_ns = malloc(capacity * sizeof(uint64_t));
+    if (scan_ns == NULL)
+    {
+        fprintf(stderr, "Not enough memory for %zu scans\n", capacity);
+        return 1;
+    }
+
+    const uint8_t *p   = map + sizeof(*header);
+    const uint8_t *end = p + used;
+    unsigned long scan = 0;
+    uint64_t total_ns  = 0;
+    while (p < end)
+    {
+        if (p[0] == FLIGHT_RECORD_RUN)
+        {
+            uint32_t count;
+            size_t size = flight_record_decode_run(p, end, &count);
+            if (size == 0)
+            {
+                break;
+            }
+            p += size;
+
+            // The outputs recorded after the last scan of this run
+            const uint8_t *outputs = p;
+            while (p < end && (p[0] & FLIGHT_RECORD_KIND_MASK) == FLIGHT_RECORD_OUTPUT &&
+                   (size = flight_record_value_record_size(p, end)) > 0)
+            {
+                p += size;
+            }
+
+            for (uint32_t k = 0; k < count; k++, scan++)
+            {
+                if (scan == capacity)
+                {
+                    capacity *= 2;
+                    uint64_t *grown = realloc(scan_ns, capacity * sizeof(uint64_t));
+                    if (grown == NULL)
+                    {
+                        fprintf(stderr, "Not enough memory for %zu scans\n", capacity);
+                        return 1;
+                    }
+                    scan_ns = grown;
+                }
+
+                uint64_t start = now_ns();
+                ext_config_run__(tick__++);
+                ext_updateTime();
+                scan_ns[scan] = now_ns() - start;
+                total_ns += scan_ns[scan];
+
+                if (k == count - 1)
+                {
+                    apply_expected(&state, outputs, p);
+                }
+                if (state.compare)
+                {
+                    compare_outputs(&state, scan);
+                }
+            }
+        }
+        else if ((p[0] & FLIGHT_RECORD_KIND_MASK) == FLIGHT_RECORD_WRITE)
+        {
+            size_t size = flight_record_value_record_size(p, end);
+            if (size == 0)
+            {
+                break;
+            }
+
+            journal_buffer_type_t type;
+            uint16_t index;
+            uint8_t bit;
+            uint64_t value;
+            flight_record_decode_value(p, &type, &index, &bit, &value);
+            void *addr = flight_record_location(type, index, bit);
+            if (addr != NULL)
+            {
+                flight_record_store(addr, type, value);
+            }
+            p += size;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (p < end)
+    {
+        printf("Invalid record at offset %zu, replay stopped\n",
+               (size_t)(p - (map + sizeof(*header))));
+    }
+
+    if (scan > 0)
+    {
+        qsort(scan_ns, scan, sizeof(uint64_t), compare_u64);
+        printf("scans=%lu mean_ns=%llu min_ns=%llu p50_ns=%llu p99_ns=%llu max_ns=%llu", scan,
+               (unsigned long long)(total_ns / scan), (unsigned long long)scan_ns[0],
+               (unsigned long long)scan_ns[scan / 2], (unsigned long long)scan_ns[scan * 99 / 100],
+               (unsigned long long)scan_ns[scan - 1]);
+        if (state.compare)
+        {
+            printf(" mismatched_scans=%lu", state.mismatched_scans);
+        }
+        printf("\n");
+    }
+
+    free(scan_ns);
+    free(state.outputs);
+    free(state.expected);
+    free(state.lookup);
+    munmap(map, (size_t)st.st_size);
+    plugin_manager_destroy(pm);
+    return state.mismatched_scans > 0 ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+// Offline runner for compiled PLC programs
+//
+// Loads a libplc_*.so and executes a fixed number of scans back to back, with
+// no plugins, sockets or real-time scheduling. Virtual time advances by one
+// task period per scan, so timers behave as in the runtime without waiting.
+// Inputs are either driven from a recorded input file or changed pseudo-
+// randomly. TCP/UDP communication blocks fail as if the peer were unreachable
+// (see comm_stubs.c). Used by scripts/compile-optimized.sh to collect a
+// profile of the instrumented program and to compare scan times of two builds.
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "image_tables.h"
+#include "input_script.h"
+#include "plcapp_manager.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+
+// log.c stops its socket thread through this flag
+volatile sig_atomic_t keep_running = 1;
+extern bool print_logs;
+
+#define DEFAULT_SCANS 10000
+#define DEFAULT_INPUT_PERIOD 10
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(void)
+{
+    // xorshift64*, reproducible across runs and builds
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s <libplc.so> [--scans N] [--inputs FILE] [--input-period N] [--seed N]\n"
+            "\n"
+            "  --scans N         Number of scans to execute (default %d)\n"
+            "  --inputs FILE     Apply recorded inputs: one '<scan> <location> <value>' per\n"
+            "                    line, e.g. '120 %%IX0.3 1' or '500 %%IW2 1200'\n"
+            "  --input-period N  Without --inputs, change all inputs randomly every N scans\n"
+            "                    (default %d)\n"
+            "  --seed N          Seed for random inputs\n",
+            prog, DEFAULT_SCANS, DEFAULT_INPUT_PERIOD);
+}
+
+static void randomize_inputs(void)
+{
+    for (int i = 0; i < BUFFER_SIZE; i++)
+    {
+        uint64_t bits = next_random();
+        for (int b = 0; b < 8; b++)
+        {
+            *bool_input[i][b] = (IEC_BOOL)((bits >> b) & 1);
+        }
+        *byte_input[i] = (IEC_BYTE)(bits >> 8);
+        *int_input[i]  = (IEC_UINT)(bits >> 16);
+        *dint_input[i] = (IEC_UDINT)(bits >> 32);
+        *lint_input[i] = (IEC_ULINT)next_random();
+    }
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *so_path        = NULL;
+    const char *inputs_path    = NULL;
+    unsigned long scans        = DEFAULT_SCANS;
+    unsigned long input_period = DEFAULT_INPUT_PERIOD;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--scans") == 0 && i + 1 < argc)
+        {
+            scans = strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--inputs") == 0 && i + 1 < argc)
+        {
+            inputs_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--input-period") == 0 && i + 1 < argc)
+        {
+            input_period = strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            rng_state ^= strtoull(argv[++i], NULL, 10);
+        }
+        else if (argv[i][0] != '-' && so_path == NULL)
+        {
+            so_path = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (so_path == NULL || scans == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Only errors, on stdout: the loader logs every step at info level
+    log_set_level(LOG_LEVEL_ERROR);
+    print_logs = true;
+
+    if (inputs_path && input_script_load(inputs_path) != 0)
+    {
+        return 1;
+    }
+
+    PluginManager *pm = plugin_manager_create(so_path);
+    if (pm == NULL || !plugin_manager_load(pm) || symbols_init(pm) != 0)
+    {
+        fprintf(stderr, "Failed to load PLC program %s\n", so_path);
+        return 1;
+    }
+    ext_config_init__();
+    ext_glueVars();
+    image_tables_fill_null_pointers();
+
+    uint64_t *scan_ns = malloc(scans * sizeof(uint64_t));
+    if (scan_ns == NULL)
+    {
+        fprintf(stderr, "Not enough memory for %lu scans\n", scans);
+        return 1;
+    }
+
+    uint64_t total_ns = 0;
+    for (unsigned long scan = 0; scan < scans; scan++)
+    {
+        if (inputs_path)
+        {
+            input_script_apply(scan, NULL);
+        }
+        else if (input_period > 0 && scan % input_period == 0)
+        {
+            randomize_inputs();
+        }
+
+        uint64_t start = now_ns();
+        ext_config_run__(tick__++);
+        ext_updateTime();
+        scan_ns[scan] = now_ns() - start;
+        total_ns += scan_ns[scan];
+    }
+
+    qsort(scan_ns, scans, sizeof(uint64_t), compare_u64);
+    printf("scans=%lu mean_ns=%llu min_ns=%llu p50_ns=%llu p99_ns=%llu max_ns=%llu\n", scans,
+           (unsigned long long)(total_ns / scans), (unsigned long long)scan_ns[0],
+           (unsigned long long)scan_ns[scans / 2], (unsigned long long)scan_ns[scans * 99 / 100],
+           (unsigned long long)scan_ns[scans - 1]);
+
+    free(scan_ns);
+    input_script_free();
+
+    // Unloading runs the library destructors, which write the profile of an instrumented build
+    plugin_manager_destroy(pm);
+    return 0;
+}
@@ -5,13 +5,24 @@
 #include <string.h>
 
 #include "../drivers/plugin_driver.h"
+#include "fast_restart.h"
+#include "flight_recorder.h"
+#include "free_run.h"
 #include "image_tables.h"
 #include "journal_buffer.h"
+#include "multi_task.h"
+#include "online_change.h"
+#include "overrun_forensics.h"
+#include "phase_align.h"
 #include "plc_state_manager.h"
 #include "plcapp_manager.h"
+#include "retain_store.h"
 #include "scan_cycle_manager.h"
+#include "sched_deadline.h"
 #include "utils/log.h"
 #include "utils/utils.h"
+#include "utils/watchdog.h"
+#include "warm_restart.h"
 
 static PLCState plc_state          = PLC_STATE_STOPPED;
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -23,6 +34,7 @@ PluginManager *plc_program = NULL;
 extern plc_timing_stats_t plc_timing_stats;
 extern atomic_long plc_heartbeat;
 extern plugin_driver_t *plugin_driver;
+extern volatile sig_atomic_t keep_running;
 
 // Signal recovery for PLC cycle thread crashes (SIGFPE, SIGSEGV)
 static sigjmp_buf plc_crash_jmp;
@@ -30,6 +42,10 @@ static pthread_t plc_thread_id;
 static volatile sig_atomic_t plc_crash_signal = 0;
 static volatile sig_atomic_t holding_buffer_mutex = 0;
 
+// Set when the cycle thread returned from its crash recovery point, for FAST_RESTART
+static atomic_bool cycle_thread_crashed;
+static atomic_bool restart_from_snapshot;
+
 // NOTE on siglongjmp safety: siglongjmp from a hardware-raised signal is
 // well-defined when process state (heap/stack) is intact at the time of the
 // signal. For generated PLC code this is the expected case because:
@@ -46,6 +62,9 @@ static volatile sig_atomic_t holding_buffer_mutex = 0;
 // pattern and restart without loading the faulty program.
 static void plc_crash_handler(int sig)
 {
+    // Task threads of multi-task mode stop themselves and report to the cycle thread
+    multi_task_recover(sig);
+
     // Only handle if the crash came from the PLC cycle thread
     if (!pthread_equal(pthread_self(), plc_thread_id))
     {
@@ -59,27 +78,45 @@ static void plc_crash_handler(int sig)
     siglongjmp(plc_crash_jmp, sig);
 }
 
-void *plc_cycle_thread(void *arg)
+/**
+ * @brief Initialize the program, its stores and the plugins before the first scan
+ */
+static void plc_program_init(PluginManager *pm)
 {
-    PluginManager *pm = (PluginManager *)arg;
-
-    // Record this thread's ID for the crash handler
-    plc_thread_id = pthread_self();
-    plc_crash_signal = 0;
-
-    // Initialize PLC with real-time optimizations
-    set_realtime_priority();
-    lock_memory();
     symbols_init(pm);
     ext_config_init__();
     ext_glueVars();
 
+    // Keep the initial program data for FAST_RESTART after a crash
+    if (fast_restart_snapshot(pm) != 0)
+    {
+        log_warn("Fast restart not available for this program");
+    }
+
+    // Bring RETAIN variables back to their last checkpointed values before the first scan
+    if (retain_store_open(true) != 0)
+    {
+        log_error("Retain store not available, RETAIN variables will not persist");
+    }
+
     // Fill NULL pointers in image tables with temporary buffers
     // This ensures plugins can access addresses not used by the PLC program
     plugin_mutex_take(&plugin_driver->buffer_mutex);
     image_tables_fill_null_pointers();
     plugin_mutex_give(&plugin_driver->buffer_mutex);
 
+    // With --warm-start, continue from the last process image checkpoint
+    if (warm_restart_open(true) != 0)
+    {
+        log_error("Warm restart checkpoints not available");
+    }
+
+    // With --record, log every scan's writes and output changes for plc_replay
+    if (flight_recorder_open() != 0)
+    {
+        log_error("Flight recorder not available");
+    }
+
     // Initialize journal buffer for race-condition-free plugin writes
     journal_buffer_ptrs_t journal_ptrs = {
         .bool_input = bool_input,
@@ -113,6 +150,88 @@ void *plc_cycle_thread(void *arg)
         plugin_driver_start(plugin_driver);
         log_info("[PLUGIN]: Enabled plugins started");
     }
+}
+
+/**
+ * @brief Stop the Python function blocks started by the program
+ *
+ * Terminates Python subprocesses and joins runner threads, which must not
+ * outlive the program data they were started from.
+ */
+static void python_blocks_stop(PluginManager *pm)
+{
+    void (*python_cleanup)(void);
+    *(void **)(&python_cleanup) = plugin_manager_get_symbol(pm, "python_blocks_cleanup");
+    if (python_cleanup)
+    {
+        python_cleanup();
+    }
+}
+
+/**
+ * @brief Bring a crashed program back to its initial state for FAST_RESTART
+ *
+ * The program library, the image table pointers, the journal and the plugins
+ * stay as they are; only the program data is restored from the snapshot
+ * taken by plc_program_init(), then RETAIN variables and warm restart
+ * checkpoints are applied as on a program start.
+ */
+static void plc_program_restart(PluginManager *pm)
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // The snapshot holds the Python loader's table as of before any block started;
+    // restoring it over running blocks would orphan their processes and threads
+    python_blocks_stop(pm);
+
+    // Persist RETAIN variables as of the last completed cycle, like an unload after a crash
+    retain_store_close();
+    warm_restart_close(false);
+
+    plugin_mutex_take(&plugin_driver->buffer_mutex);
+
+    fast_restart_restore();
+
+    if (retain_store_open(true) != 0)
+    {
+        log_error("Retain store not available, RETAIN variables will not persist");
+    }
+    if (warm_restart_open(true) != 0)
+    {
+        log_error("Warm restart checkpoints not available");
+    }
+
+    // A recording only replays from a program start
+    flight_recorder_stop();
+
+    plugin_mutex_give(&plugin_driver->buffer_mutex);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    log_info("Fast restart: program data restored in %ld us",
+             (long)((end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000));
+}
+
+void *plc_cycle_thread(void *arg)
+{
+    PluginManager *pm = (PluginManager *)arg;
+
+    // Record this thread's ID for the crash handler
+    plc_thread_id = pthread_self();
+    plc_crash_signal = 0;
+    atomic_store(&cycle_thread_crashed, false);
+
+    // Initialize PLC with real-time optimizations
+    set_realtime_priority();
+    lock_memory();
+    if (atomic_exchange(&restart_from_snapshot, false))
+    {
+        plc_program_restart(pm);
+    }
+    else
+    {
+        plc_program_init(pm);
+    }
 
     // Install signal handlers for crash recovery BEFORE entering the main loop.
     // This allows SIGFPE (e.g. division by zero) and SIGSEGV (e.g. bad array
@@ -137,9 +256,44 @@ void *plc_cycle_thread(void *arg)
 
     plc_timing_stats.scan_count = 0;
 
+    // In free-run mode scans follow a virtual clock instead of the wall clock
+    bool free_run = free_run_enabled();
+    if (free_run && free_run_start() != 0)
+    {
+        log_error("Failed to start free-run mode");
+        free_run = false;
+    }
+
+    // With --multi-task, every IEC task runs on its own thread and the cycle
+    // thread only releases them. Free-run scans do not wait for slow tasks.
+    bool multi_task = !free_run && multi_task_start(pm, &plugin_driver->buffer_mutex);
+    if (multi_task && flight_recorder_enabled())
+    {
+        // Replays execute one scan per tick, which tasks on their own threads do not follow
+        log_warn("Flight recorder not available in multi-task mode");
+        plugin_mutex_take(&plugin_driver->buffer_mutex);
+        flight_recorder_stop();
+        plugin_mutex_give(&plugin_driver->buffer_mutex);
+    }
+
+    // With --sched-deadline, the first scans measure the runtime budget
+    bool sched_deadline = !free_run && sched_deadline_enabled();
+    if (sched_deadline)
+    {
+        sched_deadline_start();
+    }
+
     // Get the start time for the running program
     clock_gettime(CLOCK_MONOTONIC, &timer_start);
 
+    // With --phase-align, the first scan waits for the next start of the reference clock grid
+    bool phase_align = !free_run && phase_align_enabled();
+    if (phase_align)
+    {
+        phase_align_start(&timer_start, *ext_common_ticktime__);
+        sleep_until(&timer_start);
+    }
+
     // Set up the crash recovery point. sigsetjmp returns 0 on initial call,
     // and returns the signal number when siglongjmp jumps back here after
     // a crash in the PLC program.
@@ -159,55 +313,152 @@ void *plc_cycle_thread(void *arg)
         log_error("PLC program crashed with signal %d: %s", crash_sig, sig_name);
         log_error("The loaded PLC program contains a fatal error. "
                   "Upload a corrected program to recover.");
+        if (fast_restart_available())
+        {
+            log_info("FAST_RESTART restarts the program from its initial state");
+        }
 
         // Restore default handlers so crashes outside the PLC thread
         // still terminate the process as expected
         signal(SIGFPE, SIG_DFL);
         signal(SIGSEGV, SIG_DFL);
 
+        multi_task_stop();
+
         pthread_mutex_lock(&state_mutex);
         plc_state = PLC_STATE_ERROR;
         pthread_mutex_unlock(&state_mutex);
         log_info("PLC State: ERROR");
 
+        atomic_store(&cycle_thread_crashed, true);
         return NULL;
     }
 
     while (plc_state == PLC_STATE_RUNNING)
     {
+        // A task thread crashed: recover like a crash of this thread
+        if (multi_task && multi_task_crash_signal() != 0)
+        {
+            siglongjmp(plc_crash_jmp, multi_task_crash_signal());
+        }
+
         scan_cycle_time_start();
+
+        // Scripted inputs are journaled before the mutex is taken: a full
+        // journal flushes under the mutex
+        if (free_run)
+        {
+            free_run_apply_inputs();
+        }
+
+        // Phase timings are kept if this scan overruns
+        overrun_forensics_scan_start();
+
         holding_buffer_mutex = 1;
         plugin_mutex_take(&plugin_driver->buffer_mutex);
+        overrun_forensics_phase_end(OVERRUN_PHASE_MUTEX_WAIT);
+
+        // Switch to a program prepared by an online change, between two cycles
+        online_change_apply_pending();
 
         // Apply pending journal entries before plugin hooks run
         // This ensures all plugin writes from the previous cycle are visible
-        journal_apply_and_clear();
+        overrun_forensics_journal_applied(journal_apply_and_clear());
+        overrun_forensics_phase_end(OVERRUN_PHASE_JOURNAL);
 
         // Call cycle_start for all active native plugins that registered the hook
         plugin_driver_cycle_start(plugin_driver);
+        overrun_forensics_phase_end(OVERRUN_PHASE_CYCLE_START);
+
+        // Last point for fieldbus plugins to deliver this scan's inputs
+        plugin_driver_input_latch(plugin_driver);
+        scan_cycle_inputs_latched();
+        overrun_forensics_phase_end(OVERRUN_PHASE_INPUT_LATCH);
+
+        // Execute the PLC cycle. In multi-task mode the task threads run the
+        // tasks due at this tick, on program memory next to the image tables.
+        unsigned long tick = tick__++;
+        if (!multi_task)
+        {
+            ext_config_run__(tick);
+        }
+        overrun_forensics_phase_end(OVERRUN_PHASE_PROGRAM);
+
+        // First point the scan's outputs are final. Task threads finish later,
+        // so there is no single input-to-output latency in multi-task mode.
+        plugin_driver_output_flush(plugin_driver);
+        if (!multi_task)
+        {
+            scan_cycle_outputs_flushed();
+        }
+        overrun_forensics_phase_end(OVERRUN_PHASE_OUTPUT_FLUSH);
 
-        // Execute the PLC cycle
-        ext_config_run__(tick__++);
         ext_updateTime();
+        flight_recorder_scan_end();
 
         // Call cycle_end for all active native plugins that registered the hook
         plugin_driver_cycle_end(plugin_driver);
+        overrun_forensics_phase_end(OVERRUN_PHASE_CYCLE_END);
+
+        // Copy RETAIN variables into the next checkpoint (no I/O on this thread).
+        // In multi-task mode only between task runs; a skipped copy is made next scan.
+        if (multi_task_try_pause())
+        {
+            retain_store_capture();
+            warm_restart_capture();
+            multi_task_resume();
+        }
 
         // Update Watchdog Heartbeat
         atomic_store(&plc_heartbeat, time(NULL));
+        scan_watchdog_scan_done();
 
         plugin_mutex_give(&plugin_driver->buffer_mutex);
         holding_buffer_mutex = 0;
-        scan_cycle_time_end();
+
+        if (multi_task)
+        {
+            multi_task_release(tick);
+        }
+        overrun_forensics_phase_end(OVERRUN_PHASE_CAPTURE);
+
+        bool overrun = scan_cycle_time_end();
+        overrun_forensics_scan_end(overrun, tick, scan_cycle_last_latency(),
+                                   scan_cycle_last_scan_time());
+        if (sched_deadline)
+        {
+            sched_deadline_scan_end(scan_cycle_last_scan_time(), *ext_common_ticktime__);
+        }
+
+        // Skip the sleep and move virtual time on by one period
+        if (free_run)
+        {
+            if (!free_run_advance(*ext_common_ticktime__))
+            {
+                keep_running = 0;
+                break;
+            }
+            continue;
+        }
 
         // Calculate next start time
         timer_start.tv_nsec += *ext_common_ticktime__;
         normalize_timespec(&timer_start);
+        if (phase_align)
+        {
+            phase_align_adjust(&timer_start, *ext_common_ticktime__);
+        }
 
         // Sleep until the next cycle should start
         sleep_until(&timer_start);
     }
 
+    if (free_run)
+    {
+        free_run_stop();
+    }
+    multi_task_stop();
+
     // Restore default signal handlers when exiting normally
     signal(SIGFPE, SIG_DFL);
     signal(SIGSEGV, SIG_DFL);
@@ -238,6 +489,9 @@ int load_plc_program(PluginManager *pm)
         pthread_mutex_unlock(&state_mutex);
         log_info("PLC State: INIT");
 
+        // Keep the variable table of this program for later online changes
+        online_change_program_loaded();
+
         // Re-initialize plugins with updated config (e.g. after program re-upload).
         // Do NOT start plugins here -- they are started later in plc_cycle_thread()
         // after image tables are populated, ensuring plugins never see NULL buffers.
@@ -301,6 +555,12 @@ int unload_plc_program(PluginManager *pm)
         // Wait for the PLC thread to finish
         pthread_join(plc_thread, NULL);
 
+        // Persist RETAIN variables as of the last completed cycle. After a crash
+        // the process image may be inconsistent, so keep the last checkpoint.
+        retain_store_close();
+        warm_restart_close(prev_state != PLC_STATE_ERROR);
+        flight_recorder_close();
+
         // Cleanup journal buffer before clearing image tables
         journal_cleanup();
         log_info("Journal buffer cleaned up");
@@ -318,19 +578,15 @@ int unload_plc_program(PluginManager *pm)
         plugin_mutex_give(&plugin_driver->buffer_mutex);
 
         // Cleanup Python function blocks BEFORE unloading the shared library
-        // This terminates Python subprocesses and joins runner threads to prevent
-        // crash when dlclose() unmaps the code while threads are still running
-        void (*python_cleanup)(void);
-        *(void **)(&python_cleanup) =
-            plugin_manager_get_symbol(pm, "python_blocks_cleanup");
-        if (python_cleanup)
-        {
-            python_cleanup();
-        }
+        // This prevents a crash when dlclose() unmaps the code while threads are still running
+        python_blocks_stop(pm);
 
-        // Destroy the plugin manager
+        // Destroy the plugin manager and the programs it replaced by online change
+        atomic_store(&cycle_thread_crashed, false);
+        fast_restart_release();
         plugin_manager_destroy(pm);
         plc_program = NULL;
+        online_change_release_retired();
 
         log_info("PLC program unloaded successfully");
 
@@ -423,6 +679,36 @@ void plc_state_manager_cleanup(void)
     }
 }
 
+int plc_fast_restart(void)
+{
+    // Only a crash leaves the cycle thread finished with the program still loaded.
+    // After a watchdog ERROR the thread may still run program code.
+    if (plc_program == NULL || plc_get_state() != PLC_STATE_ERROR ||
+        !atomic_load(&cycle_thread_crashed))
+    {
+        log_error("Fast restart needs a PLC program stopped by a crash");
+        return -1;
+    }
+    if (!fast_restart_available())
+    {
+        log_error("Fast restart: no snapshot of the PLC program");
+        return -1;
+    }
+
+    pthread_join(plc_thread, NULL);
+    atomic_store(&cycle_thread_crashed, false);
+    atomic_store(&restart_from_snapshot, true);
+
+    log_info("Fast restart of the PLC program");
+    if (pthread_create(&plc_thread, NULL, plc_cycle_thread, plc_program) != 0)
+    {
+        log_error("Failed to create PLC cycle thread");
+        atomic_store(&restart_from_snapshot, false);
+        return -1;
+    }
+    return 0;
+}
+
 void plc_force_error_state(void)
 {
     pthread_mutex_lock(&state_mutex);
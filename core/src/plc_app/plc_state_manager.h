@@ -40,6 +40,18 @@ void plc_state_manager_cleanup(void);
  */
 void plc_force_error_state(void);
 
+/**
+ * @brief Restart a crashed PLC program without reloading it
+ *
+ * Restores the program data saved right after the program was initialized
+ * and starts a new PLC cycle thread. The library stays loaded and plugins
+ * keep running, so scanning resumes within a cycle.
+ *
+ * @return 0 on success, -1 if the PLC is not in ERROR state after a crash or
+ *         no snapshot of the program exists
+ */
+int plc_fast_restart(void);
+
 /**
  * @brief Get the signal number that caused the last PLC crash.
  * @return The signal number (e.g. SIGFPE, SIGSEGV), or 0 if no crash occurred
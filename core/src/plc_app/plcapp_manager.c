@@ -95,6 +95,11 @@ bool plugin_manager_load(PluginManager *pm)
     return true;
 }
 
+const char *plugin_manager_get_path(const PluginManager *pm)
+{
+    return pm ? pm->so_path : NULL;
+}
+
 void *plugin_manager_get_symbol(PluginManager *pm, const char *symbol_name)
 {
     if (!pm || !pm->handle)
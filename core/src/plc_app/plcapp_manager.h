@@ -36,6 +36,14 @@ void plugin_manager_destroy(PluginManager *pm);
  */
 bool plugin_manager_load(PluginManager *pm);
 
+/**
+ * @brief Get the path of the library managed by the plugin manager
+ *
+ * @param[in]  pm  The plugin manager
+ * @return The .so path, or NULL if pm is NULL
+ */
+const char *plugin_manager_get_path(const PluginManager *pm);
+
 /**
  * @brief Get a raw symbol (void*), you normally won’t call this directly
  *
@@ -0,0 +1,659 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "image_tables.h"
+#include "retain_store.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+#include "variable_table.h"
+
+#define RETAIN_FILE_MAGIC 0x4E544552U // "RETN"
+#define RETAIN_FILE_VERSION 1U
+
+/*
+ * File layout:
+ *   retain_file_header_t
+ *   layout text, one "name;type;size\n" line per retained variable
+ *   slot 0 and slot 1, each page aligned: retain_slot_header_t + data
+ *
+ * The data of a slot is the retained variables packed in layout order. Only
+ * one slot is written between two checkpoints; the other one always holds
+ * the last checkpoint that reached the disk.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t layout_size; // Bytes of layout text after the header
+    uint32_t data_size;   // Bytes of data per slot
+    uint32_t slot_stride; // Distance between the two slots
+    uint32_t header_crc;  // CRC-32 of the fields above and the layout text
+} retain_file_header_t;
+
+typedef struct
+{
+    uint64_t sequence; // Checkpoint number, 0 if never written
+    uint32_t data_size;
+    uint32_t crc; // CRC-32 of the fields above and the data
+} retain_slot_header_t;
+
+/**
+ * @brief Retained variable of the running program
+ */
+typedef struct
+{
+    void *addr;
+    size_t size;
+    size_t offset; // Position in the slot data
+} retain_binding_t;
+
+typedef struct
+{
+    char path[256];
+    unsigned int interval_ms;
+
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    size_t slot_offset;
+    size_t slot_stride;
+    size_t data_size;
+
+    retain_binding_t *vars;
+    size_t num_vars;
+
+    int write_slot;    // Slot filled by the PLC cycle thread
+    uint64_t sequence; // Number of the last checkpoint
+    size_t captures;   // Captures into write_slot since the last checkpoint
+
+    // Handshake between the cycle thread and the checkpointing side: the
+    // counter is odd while a capture runs, and no capture starts while
+    // sealing is set.
+    atomic_uint capture_seq;
+    atomic_bool sealing;
+
+    pthread_t thread;
+    bool thread_running;
+    bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} retain_store_t;
+
+static retain_store_t store = {
+    .path        = RETAIN_STORE_DEFAULT_PATH,
+    .interval_ms = RETAIN_STORE_DEFAULT_INTERVAL_MS,
+    .fd          = -1,
+    .sealing     = true,
+    .lock        = PTHREAD_MUTEX_INITIALIZER,
+    .wake        = PTHREAD_COND_INITIALIZER,
+};
+
+void retain_store_configure(const char *path, unsigned int interval_ms)
+{
+    if (path != NULL)
+    {
+        snprintf(store.path, sizeof(store.path), "%s", path);
+    }
+    if (interval_ms > 0)
+    {
+        store.interval_ms = interval_ms;
+    }
+}
+
+static uint8_t *slot_base(int slot)
+{
+    return store.map + store.slot_offset + (size_t)slot * store.slot_stride;
+}
+
+static uint32_t slot_crc(const retain_slot_header_t *header, const uint8_t *data)
+{
+    uint32_t crc = crc32_update(0, header, offsetof(retain_slot_header_t, crc));
+    return crc32_update(crc, data, header->data_size);
+}
+
+static uint32_t file_header_crc(const retain_file_header_t *header, const char *layout)
+{
+    uint32_t crc = crc32_update(0, header, offsetof(retain_file_header_t, header_crc));
+    return crc32_update(crc, layout, header->layout_size);
+}
+
+/**
+ * @brief Stop captures and wait for a running one to finish
+ */
+static void begin_seal(void)
+{
+    atomic_store(&store.sealing, true);
+    while (atomic_load(&store.capture_seq) & 1)
+    {
+        struct timespec pause = {0, 50 * 1000};
+        nanosleep(&pause, NULL);
+    }
+}
+
+static void end_seal(void)
+{
+    atomic_store(&store.sealing, false);
+}
+
+/**
+ * @brief Make the write slot durable and switch captures to the other slot
+ *
+ * @note Captures must be stopped with begin_seal().
+ */
+static void checkpoint(void)
+{
+    if (store.map == NULL || store.captures == 0)
+    {
+        return;
+    }
+
+    uint8_t *base                 = slot_base(store.write_slot);
+    retain_slot_header_t *header = (retain_slot_header_t *)base;
+    header->sequence             = store.sequence + 1;
+    header->data_size            = (uint32_t)store.data_size;
+    header->crc                  = slot_crc(header, base + sizeof(*header));
+
+    if (msync(base, sizeof(*header) + store.data_size, MS_SYNC) != 0)
+    {
+        log_error("Retain store: msync failed: %s", strerror(errno));
+        return;
+    }
+
+    store.sequence++;
+    store.write_slot = 1 - store.write_slot;
+    store.captures   = 0;
+}
+
+static void *checkpoint_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&store.lock);
+    while (!store.stop)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += store.interval_ms / 1000;
+        deadline.tv_nsec += (long)(store.interval_ms % 1000) * 1000000L;
+        normalize_timespec(&deadline);
+
+        pthread_cond_timedwait(&store.wake, &store.lock, &deadline);
+        if (store.stop)
+        {
+            break;
+        }
+
+        pthread_mutex_unlock(&store.lock);
+        begin_seal();
+        checkpoint();
+        end_seal();
+        pthread_mutex_lock(&store.lock);
+    }
+    pthread_mutex_unlock(&store.lock);
+
+    return NULL;
+}
+
+static int start_checkpoint_thread(void)
+{
+    // Created from the PLC cycle thread, so do not inherit its real-time priority
+    pthread_attr_t attr;
+    struct sched_param param = {.sched_priority = 0};
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    store.stop = false;
+    int result = pthread_create(&store.thread, &attr, checkpoint_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (result != 0)
+    {
+        log_error("Retain store: failed to create checkpoint thread");
+        return -1;
+    }
+    store.thread_running = true;
+    return 0;
+}
+
+/**
+ * @brief Collect the retained variables of the running program
+ *
+ * @param[out] layout  "name;type;size\n" lines, to be freed
+ * @return Number of retained variables, or -1 on failure
+ */
+static long bind_variables(char **layout, size_t *layout_size)
+{
+    *layout      = NULL;
+    *layout_size = 0;
+
+    if (ext_get_var_count == NULL || ext_get_var_size == NULL || ext_get_var_addr == NULL)
+    {
+        log_warn("Retain store: program has no debug variable table");
+        return 0;
+    }
+
+    variable_table_t table;
+    if (variable_table_load(VARIABLES_CSV_PATH, &table) != 0)
+    {
+        return -1;
+    }
+    if (table.count != ext_get_var_count())
+    {
+        log_error("Retain store: %s does not match the loaded program", VARIABLES_CSV_PATH);
+        variable_table_free(&table);
+        return -1;
+    }
+
+    long result  = -1;
+    size_t count = 0;
+    size_t text  = 0;
+    for (size_t i = 0; i < table.count; i++)
+    {
+        if (table.vars[i].retain)
+        {
+            count++;
+            text += strlen(table.vars[i].name) + strlen(table.vars[i].type) + 24;
+        }
+    }
+
+    store.vars      = calloc(count + 1, sizeof(*store.vars));
+    *layout         = malloc(text + 1);
+    store.num_vars  = 0;
+    store.data_size = 0;
+    if (store.vars != NULL && *layout != NULL)
+    {
+        for (size_t i = 0; i < table.count; i++)
+        {
+            size_t size = ext_get_var_size(i);
+            if (!table.vars[i].retain || size == 0)
+            {
+                continue;
+            }
+            retain_binding_t *var = &store.vars[store.num_vars++];
+            var->addr             = ext_get_var_addr(i);
+            var->size             = size;
+            var->offset           = store.data_size;
+            store.data_size += size;
+            *layout_size += (size_t)sprintf(*layout + *layout_size, "%s;%s;%zu\n",
+                                            table.vars[i].name, table.vars[i].type, size);
+        }
+        result = (long)store.num_vars;
+    }
+
+    variable_table_free(&table);
+    return result;
+}
+
+/**
+ * @brief Parse the layout text of a store file into a variable table plus sizes
+ */
+static int parse_layout(char *text, size_t text_size, variable_table_t *table, size_t **sizes)
+{
+    size_t lines = 0;
+    for (size_t i = 0; i < text_size; i++)
+    {
+        lines += text[i] == '\n';
+    }
+
+    table->vars  = calloc(lines + 1, sizeof(*table->vars));
+    table->count = 0;
+    *sizes       = calloc(lines + 1, sizeof(**sizes));
+    if (table->vars == NULL || *sizes == NULL)
+    {
+        return -1;
+    }
+
+    char *saveptr = NULL;
+    char *line    = strtok_r(text, "\n", &saveptr);
+    while (line != NULL)
+    {
+        char *type = strchr(line, ';');
+        char *size = type ? strchr(type + 1, ';') : NULL;
+        if (size == NULL)
+        {
+            return -1;
+        }
+        *type++ = '\0';
+        *size++ = '\0';
+
+        table->vars[table->count].name = line;
+        table->vars[table->count].type = type;
+        (*sizes)[table->count++]       = strtoul(size, NULL, 10);
+
+        line = strtok_r(NULL, "\n", &saveptr);
+    }
+    return 0;
+}
+
+/**
+ * @brief Write the newest valid checkpoint of an existing file back to the variables
+ *
+ * @return Sequence number of the restored checkpoint, 0 if there was none
+ */
+static uint64_t restore_checkpoint(const retain_file_header_t *header, char *layout,
+                                   const char *new_layout, size_t new_layout_size)
+{
+    size_t slot_offset = (sizeof(*header) + header->layout_size + (size_t)getpagesize() - 1) &
+                         ~((size_t)getpagesize() - 1);
+    uint8_t *data      = malloc(header->data_size + 1);
+    uint8_t *best      = malloc(header->data_size + 1);
+    if (data == NULL || best == NULL)
+    {
+        free(data);
+        free(best);
+        return 0;
+    }
+
+    uint64_t sequence = 0;
+    for (int slot = 0; slot < 2; slot++)
+    {
+        off_t offset = (off_t)(slot_offset + (size_t)slot * header->slot_stride);
+        retain_slot_header_t slot_header;
+        if (pread(store.fd, &slot_header, sizeof(slot_header), offset) !=
+                (ssize_t)sizeof(slot_header) ||
+            slot_header.sequence <= sequence || slot_header.data_size != header->data_size ||
+            pread(store.fd, data, header->data_size, offset + (off_t)sizeof(slot_header)) !=
+                (ssize_t)header->data_size ||
+            slot_crc(&slot_header, data) != slot_header.crc)
+        {
+            continue;
+        }
+        sequence = slot_header.sequence;
+        memcpy(best, data, header->data_size);
+    }
+    free(data);
+
+    if (sequence == 0)
+    {
+        log_warn("Retain store: no valid checkpoint in %s, starting from initial values",
+                 store.path);
+        free(best);
+        return 0;
+    }
+
+    size_t restored = 0;
+    if (new_layout_size == header->layout_size &&
+        memcmp(new_layout, layout, new_layout_size) == 0)
+    {
+        // Same variables as last time: the data is already in binding order
+        for (size_t i = 0; i < store.num_vars; i++)
+        {
+            memcpy(store.vars[i].addr, best + store.vars[i].offset, store.vars[i].size);
+        }
+        restored = store.num_vars;
+    }
+    else
+    {
+        // The program changed: restore the variables that kept their name and type
+        char *new_copy            = strndup(new_layout, new_layout_size);
+        variable_table_t old_vars = {NULL, 0};
+        variable_table_t new_vars = {NULL, 0};
+        size_t *old_sizes         = NULL;
+        size_t *new_sizes         = NULL;
+        long *old_index           = calloc(store.num_vars + 1, sizeof(*old_index));
+        if (new_copy != NULL && old_index != NULL &&
+            parse_layout(layout, header->layout_size, &old_vars, &old_sizes) == 0 &&
+            parse_layout(new_copy, new_layout_size, &new_vars, &new_sizes) == 0 &&
+            variable_table_match(&old_vars, &new_vars, old_index) >= 0)
+        {
+            size_t *old_offsets = calloc(old_vars.count + 1, sizeof(*old_offsets));
+            for (size_t i = 1; old_offsets != NULL && i < old_vars.count; i++)
+            {
+                old_offsets[i] = old_offsets[i - 1] + old_sizes[i - 1];
+            }
+            for (size_t i = 0; old_offsets != NULL && i < new_vars.count; i++)
+            {
+                long old = old_index[i];
+                if (old >= 0 && old_sizes[old] == store.vars[i].size &&
+                    old_offsets[old] + old_sizes[old] <= header->data_size)
+                {
+                    memcpy(store.vars[i].addr, best + old_offsets[old], store.vars[i].size);
+                    restored++;
+                }
+            }
+            free(old_offsets);
+        }
+        // Entries point into the layout buffers, which are freed separately
+        free(old_vars.vars);
+        free(new_vars.vars);
+        free(old_sizes);
+        free(new_sizes);
+        free(old_index);
+        free(new_copy);
+    }
+
+    log_info("Retain store: restored %zu of %zu retained variables from checkpoint %llu",
+             restored, store.num_vars, (unsigned long long)sequence);
+    free(best);
+    return sequence;
+}
+
+/**
+ * @brief Read the header and layout of an existing store file
+ *
+ * @return Layout text (to be freed) if the file has a valid header, NULL otherwise
+ */
+static char *read_file_header(retain_file_header_t *header)
+{
+    if (pread(store.fd, header, sizeof(*header), 0) != (ssize_t)sizeof(*header) ||
+        header->magic != RETAIN_FILE_MAGIC || header->version != RETAIN_FILE_VERSION)
+    {
+        return NULL;
+    }
+
+    char *layout = malloc((size_t)header->layout_size + 1);
+    if (layout == NULL ||
+        pread(store.fd, layout, header->layout_size, sizeof(*header)) !=
+            (ssize_t)header->layout_size ||
+        file_header_crc(header, layout) != header->header_crc)
+    {
+        free(layout);
+        return NULL;
+    }
+    layout[header->layout_size] = '\0';
+    return layout;
+}
+
+/**
+ * @brief Map the store file, rewriting it for the current layout if needed
+ */
+static int map_store(const char *layout, size_t layout_size, bool keep_slots)
+{
+    size_t page        = (size_t)getpagesize();
+    store.slot_offset  = (sizeof(retain_file_header_t) + layout_size + page - 1) & ~(page - 1);
+    store.slot_stride  = (sizeof(retain_slot_header_t) + store.data_size + page - 1) & ~(page - 1);
+    store.map_size     = store.slot_offset + 2 * store.slot_stride;
+
+    if (!keep_slots)
+    {
+        retain_file_header_t header = {
+            .magic       = RETAIN_FILE_MAGIC,
+            .version     = RETAIN_FILE_VERSION,
+            .layout_size = (uint32_t)layout_size,
+            .data_size   = (uint32_t)store.data_size,
+            .slot_stride = (uint32_t)store.slot_stride,
+        };
+        header.header_crc = file_header_crc(&header, layout);
+
+        if (ftruncate(store.fd, 0) != 0 || ftruncate(store.fd, (off_t)store.map_size) != 0 ||
+            pwrite(store.fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+            pwrite(store.fd, layout, layout_size, sizeof(header)) != (ssize_t)layout_size)
+        {
+            log_error("Retain store: failed to initialize %s: %s", store.path, strerror(errno));
+            return -1;
+        }
+    }
+
+    store.map = mmap(NULL, store.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, store.fd, 0);
+    if (store.map == MAP_FAILED)
+    {
+        log_error("Retain store: failed to map %s: %s", store.path, strerror(errno));
+        store.map = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static void release_store(void)
+{
+    if (store.map != NULL)
+    {
+        munmap(store.map, store.map_size);
+        store.map = NULL;
+    }
+    if (store.fd >= 0)
+    {
+        close(store.fd);
+        store.fd = -1;
+    }
+    free(store.vars);
+    store.vars     = NULL;
+    store.num_vars = 0;
+}
+
+int retain_store_open(bool restore)
+{
+    if (store.map != NULL)
+    {
+        retain_store_close();
+    }
+
+    char *layout       = NULL;
+    size_t layout_size = 0;
+    long count         = bind_variables(&layout, &layout_size);
+    if (count <= 0)
+    {
+        if (count == 0)
+        {
+            log_info("Retain store: program has no RETAIN variables");
+        }
+        free(layout);
+        release_store();
+        return count == 0 ? 0 : -1;
+    }
+
+    store.fd = open(store.path, O_RDWR | O_CREAT, 0644);
+    if (store.fd < 0)
+    {
+        log_error("Retain store: failed to open %s: %s", store.path, strerror(errno));
+        free(layout);
+        release_store();
+        return -1;
+    }
+
+    // Reuse the file as is if it was written for the same variables
+    retain_file_header_t header;
+    char *old_layout  = read_file_header(&header);
+    bool same_layout  = old_layout != NULL && header.layout_size == layout_size &&
+                       header.data_size == store.data_size &&
+                       memcmp(old_layout, layout, layout_size) == 0;
+    uint64_t sequence = 0;
+    if (old_layout != NULL && restore)
+    {
+        sequence = restore_checkpoint(&header, old_layout, layout, layout_size);
+    }
+    else if (old_layout == NULL)
+    {
+        log_info("Retain store: creating %s", store.path);
+    }
+    free(old_layout);
+
+    int result = map_store(layout, layout_size, same_layout);
+    free(layout);
+    if (result != 0)
+    {
+        release_store();
+        return -1;
+    }
+
+    // Keep filling the slot that does not hold the newest checkpoint
+    store.sequence   = 0;
+    store.write_slot = 0;
+    store.captures   = 0;
+    if (same_layout)
+    {
+        for (int slot = 0; slot < 2; slot++)
+        {
+            const retain_slot_header_t *slot_header = (const retain_slot_header_t *)slot_base(slot);
+            if (slot_header->sequence > store.sequence &&
+                slot_crc(slot_header, slot_base(slot) + sizeof(*slot_header)) == slot_header->crc)
+            {
+                store.sequence   = slot_header->sequence;
+                store.write_slot = 1 - slot;
+            }
+        }
+    }
+    else
+    {
+        // A new layout starts out empty, so persist the current values right away
+        store.sequence = sequence;
+        for (size_t i = 0; i < store.num_vars; i++)
+        {
+            memcpy(slot_base(0) + sizeof(retain_slot_header_t) + store.vars[i].offset,
+                   store.vars[i].addr, store.vars[i].size);
+        }
+        store.captures = 1;
+        checkpoint();
+    }
+
+    if (start_checkpoint_thread() != 0)
+    {
+        release_store();
+        return -1;
+    }
+
+    log_info("Retain store: %zu retained variables (%zu bytes) in %s, checkpoint every %u ms",
+             store.num_vars, store.data_size, store.path, store.interval_ms);
+    end_seal();
+    return 0;
+}
+
+void retain_store_capture(void)
+{
+    atomic_fetch_add(&store.capture_seq, 1);
+    if (!atomic_load(&store.sealing))
+    {
+        uint8_t *data = slot_base(store.write_slot) + sizeof(retain_slot_header_t);
+        for (size_t i = 0; i < store.num_vars; i++)
+        {
+            memcpy(data + store.vars[i].offset, store.vars[i].addr, store.vars[i].size);
+        }
+        store.captures++;
+    }
+    atomic_fetch_add(&store.capture_seq, 1);
+}
+
+void retain_store_close(void)
+{
+    if (store.thread_running)
+    {
+        pthread_mutex_lock(&store.lock);
+        store.stop = true;
+        pthread_cond_signal(&store.wake);
+        pthread_mutex_unlock(&store.lock);
+        pthread_join(store.thread, NULL);
+        store.thread_running = false;
+    }
+
+    // Captures stay stopped until the store is opened again
+    begin_seal();
+    if (store.map != NULL)
+    {
+        checkpoint();
+        log_info("Retain store: closed at checkpoint %llu", (unsigned long long)store.sequence);
+    }
+    release_store();
+}
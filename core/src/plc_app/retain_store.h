@@ -0,0 +1,45 @@
+#ifndef RETAIN_STORE_H
+#define RETAIN_STORE_H
+
+#include <stdbool.h>
+
+#define RETAIN_STORE_DEFAULT_PATH "./retain.bin"
+#define RETAIN_STORE_DEFAULT_INTERVAL_MS 1000
+
+/**
+ * @brief Set where and how often retained variables are persisted
+ *
+ * @param path         Store file, or NULL to keep the current one
+ * @param interval_ms  Checkpoint interval in milliseconds, or 0 to keep the current one
+ */
+void retain_store_configure(const char *path, unsigned int interval_ms);
+
+/**
+ * @brief Bind the retain store to the loaded program
+ *
+ * Reads the RETAIN flags from VARIABLES.csv and maps the store file. With
+ * restore set, the values of the newest valid checkpoint are written back to
+ * the variables with the same name and type; everything else keeps its
+ * initial value. Starts the checkpoint thread.
+ *
+ * @param restore Restore the checkpointed values (program start)
+ * @return 0 on success or if the program has no RETAIN variables, -1 on failure
+ */
+int retain_store_open(bool restore);
+
+/**
+ * @brief Copy the retained variables into the checkpoint being filled
+ *
+ * @note Called by the PLC cycle thread at the end of every cycle with buffer_mutex held.
+ */
+void retain_store_capture(void);
+
+/**
+ * @brief Persist the last capture and release the store
+ *
+ * @note Call when the captured variables are about to go away, i.e. after the
+ *       PLC cycle thread exited or after an online change switched programs.
+ */
+void retain_store_close(void);
+
+#endif // RETAIN_STORE_H
@@ -5,8 +5,12 @@
 #include <string.h>
 #include <time.h>
 
+#include "free_run.h"
+#include "phase_align.h"
 #include "scan_cycle_manager.h"
+#include "sched_deadline.h"
 #include "utils/utils.h"
+#include "utils/watchdog.h"
 
 // CLOCK_MONOTONIC_RAW is Linux-specific, use CLOCK_MONOTONIC on other platforms
 #if defined(__CYGWIN__) || defined(__MSYS__) || !defined(CLOCK_MONOTONIC_RAW)
@@ -17,15 +21,23 @@
 
 static uint64_t expected_start_us  = 0;
 static uint64_t last_start_us      = 0;
+static uint64_t scan_start_us      = 0;
+static uint64_t inputs_latched_us  = 0;
+static int64_t last_scan_time_us   = 0;
+static int64_t last_latency_us     = 0;
 static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+static uint64_t latency_histogram[LATENCY_HISTOGRAM_BUCKETS];
+static uint64_t latency_histogram_overflow = 0;
+
 plc_timing_stats_t plc_timing_stats = {.scan_time_min     = INT64_MAX,
                                        .cycle_latency_min = INT64_MAX,
                                        .cycle_time_avg    = 0,
                                        .cycle_time_min    = INT64_MAX,
                                        .cycle_latency_avg = 0,
                                        .scan_count        = 0,
-                                       .overruns          = 0};
+                                       .overruns          = 0,
+                                       .io_latency_min    = INT64_MAX};
 
 static uint64_t ts_now_us(void)
 {
@@ -34,12 +46,25 @@ static uint64_t ts_now_us(void)
     return (uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
 }
 
+// Time the scan schedule follows, virtual in free-run mode
+static uint64_t cycle_now_us(void)
+{
+    if (free_run_enabled())
+    {
+        return free_run_clock_ns() / 1000;
+    }
+    return ts_now_us();
+}
+
 void scan_cycle_time_start(void)
 {
-    uint64_t now_us = ts_now_us();
+    uint64_t now_us = cycle_now_us();
 
     pthread_mutex_lock(&stats_mutex);
 
+    // Scan time is always measured in real time
+    scan_start_us = free_run_enabled() ? ts_now_us() : now_us;
+
     if (plc_timing_stats.scan_count == 0)
     {
         // Ignore full calculations for the first cycle
@@ -66,6 +91,7 @@ void scan_cycle_time_start(void)
 
     // Calculate cycle latency
     int64_t latency_us = (int64_t)(now_us - expected_start_us);
+    last_latency_us    = latency_us;
     if (latency_us < plc_timing_stats.cycle_latency_min)
     {
         plc_timing_stats.cycle_latency_min = latency_us;
@@ -77,6 +103,16 @@ void scan_cycle_time_start(void)
     plc_timing_stats.cycle_latency_avg +=
         (latency_us - plc_timing_stats.cycle_latency_avg) / plc_timing_stats.scan_count;
 
+    // Early starts are counted as no latency
+    if (latency_us < LATENCY_HISTOGRAM_BUCKETS)
+    {
+        latency_histogram[latency_us > 0 ? latency_us : 0]++;
+    }
+    else
+    {
+        latency_histogram_overflow++;
+    }
+
     last_start_us = now_us;
     expected_start_us += *ext_common_ticktime__ / 1000; // Convert ns to us
 
@@ -85,14 +121,15 @@ void scan_cycle_time_start(void)
     pthread_mutex_unlock(&stats_mutex);
 }
 
-void scan_cycle_time_end(void)
+bool scan_cycle_time_end(void)
 {
     uint64_t now_us = ts_now_us();
 
     pthread_mutex_lock(&stats_mutex);
 
     // Calculate scan time
-    int64_t scan_time_us = now_us - last_start_us;
+    int64_t scan_time_us = now_us - scan_start_us;
+    last_scan_time_us    = scan_time_us;
     if (scan_time_us < plc_timing_stats.scan_time_min)
     {
         plc_timing_stats.scan_time_min = scan_time_us;
@@ -105,11 +142,51 @@ void scan_cycle_time_end(void)
         (scan_time_us - plc_timing_stats.scan_time_avg) / plc_timing_stats.scan_count;
 
     // Check for overrun
-    if (now_us > expected_start_us)
+    bool overrun = cycle_now_us() > expected_start_us;
+    if (overrun)
     {
         plc_timing_stats.overruns++;
     }
 
+    pthread_mutex_unlock(&stats_mutex);
+    return overrun;
+}
+
+int64_t scan_cycle_last_scan_time(void)
+{
+    // Only the PLC cycle thread writes it
+    return last_scan_time_us;
+}
+
+int64_t scan_cycle_last_latency(void)
+{
+    return last_latency_us;
+}
+
+void scan_cycle_inputs_latched(void)
+{
+    // Only the PLC cycle thread reads it back
+    inputs_latched_us = ts_now_us();
+}
+
+void scan_cycle_outputs_flushed(void)
+{
+    int64_t io_latency_us = ts_now_us() - inputs_latched_us;
+
+    pthread_mutex_lock(&stats_mutex);
+
+    plc_timing_stats.io_latency_count++;
+    if (io_latency_us < plc_timing_stats.io_latency_min)
+    {
+        plc_timing_stats.io_latency_min = io_latency_us;
+    }
+    if (io_latency_us > plc_timing_stats.io_latency_max)
+    {
+        plc_timing_stats.io_latency_max = io_latency_us;
+    }
+    plc_timing_stats.io_latency_avg +=
+        (io_latency_us - plc_timing_stats.io_latency_avg) / plc_timing_stats.io_latency_count;
+
     pthread_mutex_unlock(&stats_mutex);
 }
 
@@ -146,25 +223,170 @@ int format_timing_stats_response(char *buffer, size_t buffer_size)
                         "\"cycle_latency_min\":null,"
                         "\"cycle_latency_max\":null,"
                         "\"cycle_latency_avg\":null,"
-                        "\"overruns\":0"
+                        "\"overruns\":0,"
+                        "\"io_latency_min\":null,"
+                        "\"io_latency_max\":null,"
+                        "\"io_latency_avg\":null"
                         "}\n");
     }
 
-    return snprintf(buffer, buffer_size,
-                    "STATS:{"
-                    "\"scan_count\":%" PRId64 ","
-                    "\"scan_time_min\":%" PRId64 ","
-                    "\"scan_time_max\":%" PRId64 ","
-                    "\"scan_time_avg\":%" PRId64 ","
-                    "\"cycle_time_min\":%" PRId64 ","
-                    "\"cycle_time_max\":%" PRId64 ","
-                    "\"cycle_time_avg\":%" PRId64 ","
-                    "\"cycle_latency_min\":%" PRId64 ","
-                    "\"cycle_latency_max\":%" PRId64 ","
-                    "\"cycle_latency_avg\":%" PRId64 ","
-                    "\"overruns\":%" PRId64 "}\n",
-                    snapshot.scan_count, snapshot.scan_time_min, snapshot.scan_time_max,
-                    snapshot.scan_time_avg, snapshot.cycle_time_min, snapshot.cycle_time_max,
-                    snapshot.cycle_time_avg, snapshot.cycle_latency_min, snapshot.cycle_latency_max,
-                    snapshot.cycle_latency_avg, snapshot.overruns);
+    int written = snprintf(buffer, buffer_size,
+                           "STATS:{"
+                           "\"scan_count\":%" PRId64 ","
+                           "\"scan_time_min\":%" PRId64 ","
+                           "\"scan_time_max\":%" PRId64 ","
+                           "\"scan_time_avg\":%" PRId64 ","
+                           "\"cycle_time_min\":%" PRId64 ","
+                           "\"cycle_time_max\":%" PRId64 ","
+                           "\"cycle_time_avg\":%" PRId64 ","
+                           "\"cycle_latency_min\":%" PRId64 ","
+                           "\"cycle_latency_max\":%" PRId64 ","
+                           "\"cycle_latency_avg\":%" PRId64 ","
+                           "\"overruns\":%" PRId64,
+                           snapshot.scan_count, snapshot.scan_time_min, snapshot.scan_time_max,
+                           snapshot.scan_time_avg, snapshot.cycle_time_min,
+                           snapshot.cycle_time_max, snapshot.cycle_time_avg,
+                           snapshot.cycle_latency_min, snapshot.cycle_latency_max,
+                           snapshot.cycle_latency_avg, snapshot.overruns);
+    if (written < 0 || (size_t)written >= buffer_size)
+    {
+        return written;
+    }
+
+    // Input-to-output latency, once a scan went through both I/O phases
+    if (snapshot.io_latency_count > 0)
+    {
+        written += snprintf(buffer + written, buffer_size - written,
+                            ",\"io_latency_min\":%" PRId64 ",\"io_latency_max\":%" PRId64
+                            ",\"io_latency_avg\":%" PRId64,
+                            snapshot.io_latency_min, snapshot.io_latency_max,
+                            snapshot.io_latency_avg);
+    }
+    else
+    {
+        written += snprintf(buffer + written, buffer_size - written,
+                            ",\"io_latency_min\":null,\"io_latency_max\":null,"
+                            "\"io_latency_avg\":null");
+    }
+    if ((size_t)written >= buffer_size)
+    {
+        return written;
+    }
+
+    // In free-run mode, report how far virtual time got and how fast it runs
+    if (free_run_enabled())
+    {
+        written += snprintf(buffer + written, buffer_size - written,
+                            ",\"virtual_time_ns\":%" PRIu64 ",\"scans_per_second\":%.0f",
+                            free_run_clock_ns(), free_run_scan_rate());
+        if ((size_t)written >= buffer_size)
+        {
+            return written;
+        }
+    }
+
+    // Offset of the scan starts from the reference clock grid, in nanoseconds
+    if (phase_align_enabled() && !free_run_enabled())
+    {
+        written += snprintf(buffer + written, buffer_size - written,
+                            ",\"phase_error_ns\":%" PRId64 ",\"phase_error_max_ns\":%" PRId64
+                            ",\"phase_slewed_cycles\":%" PRIu64,
+                            phase_align_error_ns(), phase_align_error_max_ns(),
+                            phase_align_slewed_cycles());
+        if ((size_t)written >= buffer_size)
+        {
+            return written;
+        }
+    }
+
+    // Scheduling class of the PLC cycle thread and the SCHED_DEADLINE budget
+    if (sched_deadline_enabled() && !free_run_enabled())
+    {
+        if (sched_deadline_active())
+        {
+            written += snprintf(buffer + written, buffer_size - written,
+                                ",\"scheduler\":\"deadline\",\"deadline_runtime_us\":%" PRIu64
+                                ",\"deadline_overruns\":%" PRIu64,
+                                sched_deadline_runtime_ns() / 1000, sched_deadline_overruns());
+        }
+        else
+        {
+            written += snprintf(buffer + written, buffer_size - written,
+                                ",\"scheduler\":\"fifo\",\"deadline_runtime_us\":null,"
+                                "\"deadline_overruns\":0");
+        }
+        if ((size_t)written >= buffer_size)
+        {
+            return written;
+        }
+    }
+
+    // Stalls caught by the scan watchdog and how long after their limit
+    if (scan_watchdog_enabled())
+    {
+        scan_watchdog_stats_t wd;
+        scan_watchdog_stats(&wd);
+        if (wd.stalls > 0)
+        {
+            written += snprintf(buffer + written, buffer_size - written,
+                                ",\"watchdog_stalls\":%" PRIu64
+                                ",\"watchdog_detection_latency_last_us\":%" PRId64
+                                ",\"watchdog_detection_latency_max_us\":%" PRId64,
+                                wd.stalls, wd.detection_latency_last_us,
+                                wd.detection_latency_max_us);
+        }
+        else
+        {
+            written += snprintf(buffer + written, buffer_size - written,
+                                ",\"watchdog_stalls\":0,"
+                                "\"watchdog_detection_latency_last_us\":null,"
+                                "\"watchdog_detection_latency_max_us\":null");
+        }
+        if ((size_t)written >= buffer_size)
+        {
+            return written;
+        }
+    }
+
+    written += snprintf(buffer + written, buffer_size - written, "}\n");
+    return written;
+}
+
+int format_latency_histogram_response(char *buffer, size_t buffer_size)
+{
+    static uint64_t snapshot[LATENCY_HISTOGRAM_BUCKETS];
+    uint64_t overflow;
+
+    // Only the unix socket thread formats responses, so the snapshot can be static
+    pthread_mutex_lock(&stats_mutex);
+    memcpy(snapshot, latency_histogram, sizeof(snapshot));
+    overflow = latency_histogram_overflow;
+    pthread_mutex_unlock(&stats_mutex);
+
+    int written = snprintf(buffer, buffer_size,
+                           "HISTOGRAM:{\"bucket_us\":1,\"overflow\":%" PRIu64 ",\"buckets\":[",
+                           overflow);
+    bool first     = true;
+    bool truncated = false;
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+    {
+        if (snapshot[i] == 0)
+        {
+            continue;
+        }
+
+        // Leave room for the closing brackets and the truncated flag
+        int n = snprintf(buffer + written, buffer_size - written, "%s[%d,%" PRIu64 "]",
+                         first ? "" : ",", i, snapshot[i]);
+        if (n < 0 || (size_t)(written + n) >= buffer_size - 24)
+        {
+            truncated = true;
+            break;
+        }
+        written += n;
+        first = false;
+    }
+    written += snprintf(buffer + written, buffer_size - written, "],\"truncated\":%s}\n",
+                        truncated ? "true" : "false");
+    return written;
 }
@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// Cycle latency histogram: one bucket per microsecond, later starts count as overflow
+#define LATENCY_HISTOGRAM_BUCKETS 1000
+
 typedef struct
 {
     int64_t scan_time_min;
@@ -20,10 +23,27 @@ typedef struct
 
     int64_t scan_count;
     int64_t overruns;
+
+    // From the end of the input latch phase to the end of the output flush phase
+    int64_t io_latency_min;
+    int64_t io_latency_max;
+    int64_t io_latency_avg;
+    int64_t io_latency_count;
 } plc_timing_stats_t;
 
 void scan_cycle_time_start(void);
-void scan_cycle_time_end(void);
+
+// Returns true if the scan overran its period
+bool scan_cycle_time_end(void);
+
+// Duration and start latency of the last scan in microseconds, for the PLC cycle thread
+int64_t scan_cycle_last_scan_time(void);
+int64_t scan_cycle_last_latency(void);
+
+// Input-to-output latency of a scan: call after the input_latch hooks returned and
+// after the output_flush hooks returned, on the PLC cycle thread
+void scan_cycle_inputs_latched(void);
+void scan_cycle_outputs_flushed(void);
 
 // Thread-safe function to get a snapshot of timing stats
 // Returns true if stats are valid (scan_count > 0), false otherwise
@@ -33,4 +53,9 @@ bool get_timing_stats_snapshot(plc_timing_stats_t *snapshot);
 // Returns the number of characters written (excluding null terminator)
 int format_timing_stats_response(char *buffer, size_t buffer_size);
 
+// Format the cycle latency histogram as a response string for the HISTOGRAM command.
+// Counts accumulate from runtime start; compare two responses to measure a time window.
+// Returns the number of characters written (excluding null terminator)
+int format_latency_histogram_response(char *buffer, size_t buffer_size);
+
 #endif // SCAN_CYCLE_MANAGER_H
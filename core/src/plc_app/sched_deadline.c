@@ -0,0 +1,168 @@
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched_deadline.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+
+static bool enabled = false;
+
+// Only the PLC cycle thread uses the calibration and the budget policy
+static int64_t samples[SCHED_DEADLINE_CALIBRATION_SCANS];
+static int sample_count          = 0;
+static bool calibrated           = false;
+static bool growth_refused       = false;
+static uint64_t handled_overruns = 0;
+
+// Read by the statistics thread
+static atomic_bool active;
+static atomic_uint_least64_t runtime_budget_ns;
+
+// Incremented by the SIGXCPU handler, on any thread
+static atomic_uint_least64_t overruns;
+
+static void overrun_handler(int sig)
+{
+    (void)sig;
+    atomic_fetch_add(&overruns, 1);
+}
+
+static int compare_scan_times(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int apply_runtime(uint64_t runtime_ns, uint64_t period_ns)
+{
+    // Implicit deadline: a scan has to finish within its own period
+    if (set_thread_deadline_scheduling(runtime_ns, period_ns, period_ns) != 0)
+    {
+        return -1;
+    }
+    atomic_store(&runtime_budget_ns, runtime_ns);
+    atomic_store(&active, true);
+    return 0;
+}
+
+static void switch_to_deadline(uint64_t period_ns)
+{
+    qsort(samples, sample_count, sizeof(samples[0]), compare_scan_times);
+    int64_t p999_us = samples[sample_count * 999 / 1000];
+
+    uint64_t runtime_ns = (uint64_t)p999_us * 1000 * SCHED_DEADLINE_RUNTIME_FACTOR;
+    if (runtime_ns < SCHED_DEADLINE_MIN_RUNTIME_NS)
+    {
+        runtime_ns = SCHED_DEADLINE_MIN_RUNTIME_NS;
+    }
+    if (runtime_ns > period_ns)
+    {
+        runtime_ns = period_ns;
+    }
+
+    if (apply_runtime(runtime_ns, period_ns) != 0)
+    {
+        log_error("SCHED_DEADLINE refused for runtime %llu us in %llu us: %s, keeping SCHED_FIFO",
+                  (unsigned long long)(runtime_ns / 1000),
+                  (unsigned long long)(period_ns / 1000), strerror(errno));
+        return;
+    }
+
+    log_info("Scheduler set to SCHED_DEADLINE, runtime %llu us, deadline and period %llu us "
+             "(99.9%% of scans within %lld us)",
+             (unsigned long long)(runtime_ns / 1000), (unsigned long long)(period_ns / 1000),
+             (long long)p999_us);
+}
+
+void sched_deadline_configure(bool enable)
+{
+    enabled = enable;
+}
+
+bool sched_deadline_enabled(void)
+{
+    return enabled;
+}
+
+void sched_deadline_start(void)
+{
+    sample_count     = 0;
+    calibrated       = false;
+    growth_refused   = false;
+    handled_overruns = 0;
+    atomic_store(&active, false);
+    atomic_store(&runtime_budget_ns, 0);
+    atomic_store(&overruns, 0);
+
+    // The default action of SIGXCPU terminates the process
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = overrun_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGXCPU, &sa, NULL);
+
+    log_info("SCHED_DEADLINE: timing %d scans under SCHED_FIFO", SCHED_DEADLINE_CALIBRATION_SCANS);
+}
+
+void sched_deadline_scan_end(int64_t scan_time_us, uint64_t period_ns)
+{
+    if (!calibrated)
+    {
+        samples[sample_count++] = scan_time_us;
+        if (sample_count == SCHED_DEADLINE_CALIBRATION_SCANS)
+        {
+            calibrated = true;
+            switch_to_deadline(period_ns);
+        }
+        return;
+    }
+
+    uint64_t seen = atomic_load(&overruns);
+    if (!atomic_load(&active) || seen == handled_overruns)
+    {
+        return;
+    }
+    handled_overruns = seen;
+
+    // The kernel throttled a scan until its next period: give it more runtime
+    uint64_t runtime_ns = atomic_load(&runtime_budget_ns);
+    if (growth_refused || runtime_ns >= period_ns)
+    {
+        return;
+    }
+    uint64_t grown_ns = runtime_ns + runtime_ns * SCHED_DEADLINE_GROWTH_PERCENT / 100;
+    if (grown_ns > period_ns)
+    {
+        grown_ns = period_ns;
+    }
+
+    if (apply_runtime(grown_ns, period_ns) != 0)
+    {
+        growth_refused = true;
+        log_warn("SCHED_DEADLINE runtime of %llu us used up, kernel refused %llu us: %s",
+                 (unsigned long long)(runtime_ns / 1000), (unsigned long long)(grown_ns / 1000),
+                 strerror(errno));
+        return;
+    }
+    log_warn("SCHED_DEADLINE runtime used up, raised from %llu us to %llu us",
+             (unsigned long long)(runtime_ns / 1000), (unsigned long long)(grown_ns / 1000));
+}
+
+bool sched_deadline_active(void)
+{
+    return atomic_load(&active);
+}
+
+uint64_t sched_deadline_runtime_ns(void)
+{
+    return atomic_load(&runtime_budget_ns);
+}
+
+uint64_t sched_deadline_overruns(void)
+{
+    return atomic_load(&overruns);
+}
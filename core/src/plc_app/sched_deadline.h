@@ -0,0 +1,72 @@
+#ifndef SCHED_DEADLINE_H
+#define SCHED_DEADLINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Scans timed under SCHED_FIFO before the runtime budget is derived
+#define SCHED_DEADLINE_CALIBRATION_SCANS 2000
+
+// Runtime budget: twice the 99.9th percentile scan time, at least this much
+#define SCHED_DEADLINE_RUNTIME_FACTOR 2
+#define SCHED_DEADLINE_MIN_RUNTIME_NS 100000
+
+// Budget increase after periods that used up their runtime
+#define SCHED_DEADLINE_GROWTH_PERCENT 25
+
+/**
+ * @brief Configure SCHED_DEADLINE scheduling of the PLC cycle thread
+ *
+ * When enabled, the PLC cycle thread starts under SCHED_FIFO, times its
+ * first SCHED_DEADLINE_CALIBRATION_SCANS scans and then switches to
+ * SCHED_DEADLINE with the task period as period and deadline, and a runtime
+ * derived from the 99.9th percentile scan time. The kernel then admits the
+ * scan only if the CPU bandwidth is available and keeps other threads,
+ * real-time or not, from taking it. If the kernel refuses the parameters,
+ * the thread stays on SCHED_FIFO.
+ */
+void sched_deadline_configure(bool enable);
+
+/**
+ * @brief Whether SCHED_DEADLINE scheduling was requested
+ */
+bool sched_deadline_enabled(void);
+
+/**
+ * @brief Install the SIGXCPU handler and start the calibration
+ *
+ * @note Called by the PLC cycle thread before the first scan.
+ */
+void sched_deadline_start(void);
+
+/**
+ * @brief Account for a finished scan
+ *
+ * Collects calibration samples and switches to SCHED_DEADLINE once there are
+ * enough. Afterwards, periods that used up their runtime (reported by the
+ * kernel with SIGXCPU) grow the runtime by SCHED_DEADLINE_GROWTH_PERCENT, up
+ * to the deadline.
+ *
+ * @param scan_time_us  Duration of the scan
+ * @param period_ns     Task period
+ *
+ * @note Called by the PLC cycle thread after every scan.
+ */
+void sched_deadline_scan_end(int64_t scan_time_us, uint64_t period_ns);
+
+/**
+ * @brief Whether the PLC cycle thread runs under SCHED_DEADLINE
+ */
+bool sched_deadline_active(void);
+
+/**
+ * @brief Current runtime budget per period, 0 when not under SCHED_DEADLINE
+ */
+uint64_t sched_deadline_runtime_ns(void);
+
+/**
+ * @brief Periods that used up their runtime since the switch
+ */
+uint64_t sched_deadline_overruns(void);
+
+#endif // SCHED_DEADLINE_H
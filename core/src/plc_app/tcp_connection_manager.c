@@ -0,0 +1,544 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tcp_connection_manager.h"
+#include "tcp_socket_io.h"
+#include "utils/log.h"
+
+// Longest the manager thread sleeps without a wake-up or socket event
+#define MANAGER_MAX_SLEEP_MS 100
+
+/*
+ * Request life cycle. The submitting side owns a slot in FREE, CLAIMED,
+ * CONNECTED and FAILED, the manager thread in SUBMITTED and CONNECTING.
+ * Every hand-over is a single atomic store or compare-and-swap, so neither
+ * side ever waits for the other.
+ */
+typedef enum
+{
+    SLOT_FREE,
+    SLOT_CLAIMED,    // Being filled by tcp_connect_submit()
+    SLOT_SUBMITTED,  // Waiting for the manager thread
+    SLOT_CONNECTING, // Connect attempt running or waiting for a retry
+    SLOT_CONNECTED,  // Socket ready to be picked up
+    SLOT_FAILED,     // Gave up, to be picked up
+    SLOT_CANCELLED   // Withdrawn while connecting, the manager releases it
+} slot_state_t;
+
+typedef struct
+{
+    atomic_int state;
+    atomic_llong last_poll_ns;
+
+    // Written by the submitter before SLOT_SUBMITTED
+    char ip_address[INET_ADDRSTRLEN];
+    uint16_t port;
+    int method;
+
+    // Manager thread only, except fd which is handed over with SLOT_CONNECTED
+    struct sockaddr_in servaddr;
+    int fd;
+    bool in_progress;
+    unsigned int attempts;
+    unsigned int retry_ms;
+    long long next_attempt_ns;
+    long long attempt_deadline_ns;
+} connect_request_t;
+
+static connect_request_t requests[TCP_CONNECT_MAX_REQUESTS];
+
+static unsigned int timeout_ms   = TCP_CONNECT_DEFAULT_TIMEOUT_MS;
+static unsigned int retry_min_ms = TCP_CONNECT_DEFAULT_RETRY_MIN_MS;
+static unsigned int retry_max_ms = TCP_CONNECT_DEFAULT_RETRY_MAX_MS;
+static unsigned int max_attempts = 0;
+
+static pthread_t manager_thread;
+static bool manager_running = false;
+static atomic_bool manager_stop;
+static int wake_pipe[2] = {-1, -1};
+
+static long long monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void wake_manager(void)
+{
+    if (wake_pipe[1] >= 0)
+    {
+        // A full pipe already means a pending wake-up
+        char byte       = 1;
+        ssize_t written = write(wake_pipe[1], &byte, 1);
+        (void)written;
+    }
+}
+
+void tcp_connection_manager_configure(unsigned int timeout, unsigned int retry_min,
+                                      unsigned int retry_max, unsigned int attempts)
+{
+    if (timeout > 0)
+    {
+        timeout_ms = timeout;
+    }
+    if (retry_min > 0)
+    {
+        retry_min_ms = retry_min;
+    }
+    if (retry_max > 0)
+    {
+        retry_max_ms = retry_max;
+    }
+    if (attempts > 0)
+    {
+        max_attempts = attempts;
+    }
+}
+
+static void close_socket(int fd)
+{
+    if (tcp_socket_io_close(fd) == TCP_SOCKET_IO_UNMANAGED)
+    {
+        close(fd);
+    }
+}
+
+static void close_request_socket(connect_request_t *request)
+{
+    if (request->fd >= 0)
+    {
+        close_socket(request->fd);
+        request->fd = -1;
+    }
+    request->in_progress = false;
+}
+
+/**
+ * @brief Start one connect attempt with a non-blocking socket
+ *
+ * @return 1 if connected, 0 if the attempt is in progress, -1 if it failed
+ */
+static int start_attempt(connect_request_t *request, long long now)
+{
+    int type    = request->method == TCP_CONNECT_METHOD_UDP ? SOCK_DGRAM : SOCK_STREAM;
+    request->fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (request->fd < 0)
+    {
+        log_error("TCP Client: error creating socket => %s", strerror(errno));
+        return -1;
+    }
+
+    request->attempts++;
+    const struct sockaddr *addr = (const struct sockaddr *)&request->servaddr;
+    if (connect(request->fd, addr, sizeof(request->servaddr)) == 0)
+    {
+        return 1;
+    }
+    if (errno == EINPROGRESS)
+    {
+        request->in_progress         = true;
+        request->attempt_deadline_ns = now + (long long)timeout_ms * 1000000LL;
+        return 0;
+    }
+
+    if (request->attempts == 1)
+    {
+        log_error("TCP Client: error connecting to %s:%u => %s", request->ip_address,
+                  request->port, strerror(errno));
+    }
+    close_request_socket(request);
+    return -1;
+}
+
+static void attempt_failed(connect_request_t *request, long long now)
+{
+    close_request_socket(request);
+
+    if (max_attempts > 0 && request->attempts >= max_attempts)
+    {
+        int expected = SLOT_CONNECTING;
+        if (!atomic_compare_exchange_strong(&request->state, &expected, SLOT_FAILED))
+        {
+            atomic_store(&request->state, SLOT_FREE);
+        }
+        return;
+    }
+
+    // Exponential backoff between attempts
+    request->next_attempt_ns = now + (long long)request->retry_ms * 1000000LL;
+    request->retry_ms *= 2;
+    if (request->retry_ms > retry_max_ms)
+    {
+        request->retry_ms = retry_max_ms;
+    }
+}
+
+static void attempt_succeeded(connect_request_t *request)
+{
+    request->in_progress = false;
+    if (request->attempts > 1)
+    {
+        log_info("TCP Client: connected to %s:%u after %u attempts", request->ip_address,
+                 request->port, request->attempts);
+    }
+
+    // Without the I/O thread the socket is still usable with direct system calls
+    tcp_socket_io_register(request->fd, request->method == TCP_CONNECT_METHOD_UDP);
+
+    int expected = SLOT_CONNECTING;
+    if (!atomic_compare_exchange_strong(&request->state, &expected, SLOT_CONNECTED))
+    {
+        // Cancelled meanwhile
+        close_request_socket(request);
+        atomic_store(&request->state, SLOT_FREE);
+    }
+}
+
+/**
+ * @brief Advance the state of every request that does not wait for a socket event
+ *
+ * @return Time until the next retry is due, in milliseconds
+ */
+static int service_requests(long long now)
+{
+    long long next_event = now + (long long)MANAGER_MAX_SLEEP_MS * 1000000LL;
+
+    for (int i = 0; i < TCP_CONNECT_MAX_REQUESTS; i++)
+    {
+        connect_request_t *request = &requests[i];
+        int state                  = atomic_load(&request->state);
+
+        if (state == SLOT_SUBMITTED)
+        {
+            // An invalid address will not get better with retries
+            memset(&request->servaddr, 0, sizeof(request->servaddr));
+            request->servaddr.sin_family = AF_INET;
+            request->servaddr.sin_port   = htons(request->port);
+            if (inet_pton(AF_INET, request->ip_address, &request->servaddr.sin_addr) != 1)
+            {
+                log_error("TCP Client: invalid server address %s", request->ip_address);
+                int expected = SLOT_SUBMITTED;
+                atomic_compare_exchange_strong(&request->state, &expected, SLOT_FAILED);
+                continue;
+            }
+
+            request->fd              = -1;
+            request->in_progress     = false;
+            request->attempts        = 0;
+            request->retry_ms        = retry_min_ms;
+            request->next_attempt_ns = now;
+            int expected             = SLOT_SUBMITTED;
+            if (!atomic_compare_exchange_strong(&request->state, &expected, SLOT_CONNECTING))
+            {
+                continue;
+            }
+            state = SLOT_CONNECTING;
+        }
+
+        if (state == SLOT_CANCELLED)
+        {
+            close_request_socket(request);
+            atomic_store(&request->state, SLOT_FREE);
+            continue;
+        }
+
+        // Nobody asks for these anymore (e.g. the function block stopped calling)
+        bool abandoned =
+            now - atomic_load(&request->last_poll_ns) > TCP_CONNECT_ABANDON_MS * 1000000LL;
+        if (abandoned && (state == SLOT_CONNECTING || state == SLOT_CONNECTED))
+        {
+            int expected = state;
+            if (atomic_compare_exchange_strong(&request->state, &expected, SLOT_FREE))
+            {
+                close_request_socket(request);
+            }
+            continue;
+        }
+
+        if (state != SLOT_CONNECTING)
+        {
+            continue;
+        }
+
+        if (request->in_progress && now >= request->attempt_deadline_ns)
+        {
+            if (request->attempts == 1)
+            {
+                log_error("TCP Client: connecting to %s:%u timed out after %u ms",
+                          request->ip_address, request->port, timeout_ms);
+            }
+            attempt_failed(request, now);
+        }
+        else if (!request->in_progress && now >= request->next_attempt_ns)
+        {
+            int result = start_attempt(request, now);
+            if (result > 0)
+            {
+                attempt_succeeded(request);
+                continue;
+            }
+            if (result < 0)
+            {
+                attempt_failed(request, now);
+            }
+        }
+
+        if (atomic_load(&request->state) == SLOT_CONNECTING)
+        {
+            long long due = request->in_progress ? request->attempt_deadline_ns
+                                                 : request->next_attempt_ns;
+            if (due < next_event)
+            {
+                next_event = due;
+            }
+        }
+    }
+
+    long long wait_ns = next_event - now;
+    return wait_ns > 0 ? (int)((wait_ns + 999999) / 1000000) : 0;
+}
+
+static void *manager_thread_main(void *arg)
+{
+    (void)arg;
+    struct pollfd fds[TCP_CONNECT_MAX_REQUESTS + 1];
+    int owners[TCP_CONNECT_MAX_REQUESTS + 1];
+
+    while (!atomic_load(&manager_stop))
+    {
+        int wait_ms = service_requests(monotonic_ns());
+
+        nfds_t count      = 0;
+        fds[count].fd     = wake_pipe[0];
+        fds[count].events = POLLIN;
+        owners[count++]   = -1;
+        for (int i = 0; i < TCP_CONNECT_MAX_REQUESTS; i++)
+        {
+            if (atomic_load(&requests[i].state) == SLOT_CONNECTING && requests[i].in_progress)
+            {
+                fds[count].fd     = requests[i].fd;
+                fds[count].events = POLLOUT;
+                owners[count++]   = i;
+            }
+        }
+
+        if (poll(fds, count, wait_ms) <= 0)
+        {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            char drain[64];
+            while (read(wake_pipe[0], drain, sizeof(drain)) > 0)
+            {
+            }
+        }
+
+        long long now = monotonic_ns();
+        for (nfds_t n = 1; n < count; n++)
+        {
+            if (fds[n].revents == 0)
+            {
+                continue;
+            }
+            connect_request_t *request = &requests[owners[n]];
+            int error                  = 0;
+            socklen_t len              = sizeof(error);
+            if (getsockopt(request->fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0)
+            {
+                error = errno;
+            }
+            if (error == 0)
+            {
+                attempt_succeeded(request);
+            }
+            else
+            {
+                if (request->attempts == 1)
+                {
+                    log_error("TCP Client: error connecting to %s:%u => %s", request->ip_address,
+                              request->port, strerror(error));
+                }
+                attempt_failed(request, now);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+int tcp_connection_manager_init(void)
+{
+    if (manager_running)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < TCP_CONNECT_MAX_REQUESTS; i++)
+    {
+        atomic_store(&requests[i].state, SLOT_FREE);
+        requests[i].fd = -1;
+    }
+
+    if (pipe(wake_pipe) != 0)
+    {
+        log_error("TCP Client: failed to create wake-up pipe => %s", strerror(errno));
+        return -1;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        fcntl(wake_pipe[i], F_SETFL, fcntl(wake_pipe[i], F_GETFL, 0) | O_NONBLOCK);
+        fcntl(wake_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    atomic_store(&manager_stop, false);
+    if (pthread_create(&manager_thread, NULL, manager_thread_main, NULL) != 0)
+    {
+        log_error("TCP Client: failed to create connection manager thread");
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+        wake_pipe[0] = wake_pipe[1] = -1;
+        return -1;
+    }
+    manager_running = true;
+    return 0;
+}
+
+void tcp_connection_manager_cleanup(void)
+{
+    if (!manager_running)
+    {
+        return;
+    }
+
+    atomic_store(&manager_stop, true);
+    wake_manager();
+    pthread_join(manager_thread, NULL);
+    manager_running = false;
+
+    for (int i = 0; i < TCP_CONNECT_MAX_REQUESTS; i++)
+    {
+        int state = atomic_load(&requests[i].state);
+        if (state == SLOT_CONNECTING || state == SLOT_CONNECTED || state == SLOT_CANCELLED)
+        {
+            close_request_socket(&requests[i]);
+        }
+        atomic_store(&requests[i].state, SLOT_FREE);
+    }
+
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    wake_pipe[0] = wake_pipe[1] = -1;
+}
+
+int tcp_connect_submit(const char *ip_address, uint16_t port, int method)
+{
+    for (int i = 0; i < TCP_CONNECT_MAX_REQUESTS; i++)
+    {
+        connect_request_t *request = &requests[i];
+        int expected               = SLOT_FREE;
+        if (!atomic_compare_exchange_strong(&request->state, &expected, SLOT_CLAIMED))
+        {
+            continue;
+        }
+
+        snprintf(request->ip_address, sizeof(request->ip_address), "%s", ip_address);
+        request->port   = port;
+        request->method = method;
+        atomic_store(&request->last_poll_ns, monotonic_ns());
+        atomic_store(&request->state, SLOT_SUBMITTED);
+        wake_manager();
+        return i;
+    }
+
+    log_error("TCP Client: too many pending connections (%d)", TCP_CONNECT_MAX_REQUESTS);
+    return -1;
+}
+
+tcp_connect_status_t tcp_connect_poll(int handle, int *sockfd)
+{
+    if (handle < 0 || handle >= TCP_CONNECT_MAX_REQUESTS)
+    {
+        return TCP_CONNECT_FAILED;
+    }
+
+    // Claim finished requests first, the manager may abandon them concurrently
+    connect_request_t *request = &requests[handle];
+    int state                  = SLOT_CONNECTED;
+    if (atomic_compare_exchange_strong(&request->state, &state, SLOT_CLAIMED))
+    {
+        *sockfd = request->fd;
+        atomic_store(&request->state, SLOT_FREE);
+        return TCP_CONNECT_CONNECTED;
+    }
+
+    switch (state)
+    {
+    case SLOT_FAILED:
+        atomic_store(&request->state, SLOT_FREE);
+        return TCP_CONNECT_FAILED;
+
+    case SLOT_SUBMITTED:
+    case SLOT_CONNECTING:
+        atomic_store(&request->last_poll_ns, monotonic_ns());
+        return TCP_CONNECT_PENDING;
+
+    default:
+        return TCP_CONNECT_FAILED;
+    }
+}
+
+void tcp_connect_cancel(int handle)
+{
+    if (handle < 0 || handle >= TCP_CONNECT_MAX_REQUESTS)
+    {
+        return;
+    }
+
+    connect_request_t *request = &requests[handle];
+    int state                  = atomic_load(&request->state);
+    while (state == SLOT_SUBMITTED || state == SLOT_CONNECTING)
+    {
+        // The manager thread has not touched a submitted request yet
+        int next = state == SLOT_SUBMITTED ? SLOT_FREE : SLOT_CANCELLED;
+        if (atomic_compare_exchange_strong(&request->state, &state, next))
+        {
+            wake_manager();
+            return;
+        }
+    }
+
+    int sockfd;
+    if (tcp_connect_poll(handle, &sockfd) == TCP_CONNECT_CONNECTED)
+    {
+        close_socket(sockfd);
+    }
+}
+
+int tcp_connect_find(const char *ip_address, uint16_t port, int method)
+{
+    for (int i = 0; i < TCP_CONNECT_MAX_REQUESTS; i++)
+    {
+        int state = atomic_load(&requests[i].state);
+        if ((state == SLOT_SUBMITTED || state == SLOT_CONNECTING || state == SLOT_CONNECTED ||
+             state == SLOT_FAILED) &&
+            requests[i].port == port && requests[i].method == method &&
+            strcmp(requests[i].ip_address, ip_address) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,83 @@
+#ifndef TCP_CONNECTION_MANAGER_H
+#define TCP_CONNECTION_MANAGER_H
+
+#include <stdint.h>
+
+#define TCP_CONNECT_MAX_REQUESTS 64
+#define TCP_CONNECT_DEFAULT_TIMEOUT_MS 3000
+#define TCP_CONNECT_DEFAULT_RETRY_MIN_MS 100
+#define TCP_CONNECT_DEFAULT_RETRY_MAX_MS 5000
+
+// A request nobody polled for this long is abandoned and its socket closed
+#define TCP_CONNECT_ABANDON_MS 10000
+
+#define TCP_CONNECT_METHOD_TCP 0
+#define TCP_CONNECT_METHOD_UDP 1
+
+/**
+ * @brief Status of a connect request
+ */
+typedef enum
+{
+    TCP_CONNECT_PENDING   = 0, // Still connecting or waiting to retry
+    TCP_CONNECT_CONNECTED = 1, // Socket handed over to the caller, request released
+    TCP_CONNECT_FAILED    = -1 // Gave up or invalid request, request released
+} tcp_connect_status_t;
+
+/**
+ * @brief Configure connection attempts
+ *
+ * Every attempt is aborted after timeout_ms. Failed attempts are retried
+ * after retry_min_ms, doubling up to retry_max_ms, until max_attempts is
+ * reached (0 retries for as long as the request is polled). Zero keeps the
+ * current value.
+ */
+void tcp_connection_manager_configure(unsigned int timeout_ms, unsigned int retry_min_ms,
+                                      unsigned int retry_max_ms, unsigned int max_attempts);
+
+/**
+ * @brief Start the connection manager thread
+ *
+ * @return 0 on success, -1 on failure
+ */
+int tcp_connection_manager_init(void);
+
+/**
+ * @brief Stop the connection manager thread and close all pending sockets
+ */
+void tcp_connection_manager_cleanup(void);
+
+/**
+ * @brief Ask the connection manager to connect to a server
+ *
+ * Never blocks: the socket is created and connected by the manager thread.
+ *
+ * @param ip_address  Server IPv4 address in dotted notation
+ * @param port        Server port
+ * @param method      TCP_CONNECT_METHOD_TCP or TCP_CONNECT_METHOD_UDP
+ * @return Request handle (>= 0), or -1 if the request table is full
+ */
+int tcp_connect_submit(const char *ip_address, uint16_t port, int method);
+
+/**
+ * @brief Check on a connect request
+ *
+ * @param handle  Handle returned by tcp_connect_submit()
+ * @param sockfd  Receives the connected, non-blocking socket with TCP_CONNECT_CONNECTED
+ * @return Status of the request; the handle is invalid unless TCP_CONNECT_PENDING
+ */
+tcp_connect_status_t tcp_connect_poll(int handle, int *sockfd);
+
+/**
+ * @brief Withdraw a pending request
+ */
+void tcp_connect_cancel(int handle);
+
+/**
+ * @brief Find the pending request for an endpoint
+ *
+ * @return Request handle, or -1 if there is none
+ */
+int tcp_connect_find(const char *ip_address, uint16_t port, int method);
+
+#endif // TCP_CONNECTION_MANAGER_H
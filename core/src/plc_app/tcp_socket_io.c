@@ -0,0 +1,563 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "tcp_socket_io.h"
+#include "utils/log.h"
+
+#define MAX_MANAGED_SOCKETS 64
+#define RING_MASK (TCP_SOCKET_IO_RING_SIZE - 1)
+
+// Longest the I/O thread sleeps without a wake-up or socket event
+#define IO_MAX_SLEEP_MS 100
+
+/**
+ * @brief Single-producer single-consumer byte ring
+ *
+ * head and tail run freely and are masked on access, so head - tail is
+ * always the number of bytes in the ring.
+ */
+typedef struct
+{
+    atomic_size_t head; // Written by the producer
+    atomic_size_t tail; // Written by the consumer
+    uint8_t data[TCP_SOCKET_IO_RING_SIZE];
+} byte_ring_t;
+
+/**
+ * @brief Socket owned by the I/O thread
+ *
+ * The PLC program produces into send and consumes from receive; the I/O
+ * thread does the opposite and is the only one making system calls on fd.
+ * Tasks of a multi-task program may use the same socket at once, so the
+ * program side of each ring takes a lock to stay a single producer or
+ * consumer. The I/O thread never takes them.
+ */
+typedef struct
+{
+    int fd;
+    bool datagram; // Rings hold [uint16_t length][payload] records
+    atomic_bool closing;
+    atomic_bool eof;
+    atomic_bool failed;
+    pthread_mutex_t send_mutex;    // Producers of send
+    pthread_mutex_t receive_mutex; // Consumers of receive
+    byte_ring_t send;
+    byte_ring_t receive;
+} managed_socket_t;
+
+static _Atomic(managed_socket_t *) sockets_by_fd[TCP_SOCKET_IO_MAX_FD];
+
+// Only touched by the I/O thread
+static managed_socket_t *owned[MAX_MANAGED_SOCKETS];
+static size_t num_owned = 0;
+
+// Registrations waiting to be picked up by the I/O thread
+static pthread_mutex_t pending_mutex = PTHREAD_MUTEX_INITIALIZER;
+static managed_socket_t *pending[MAX_MANAGED_SOCKETS];
+static size_t num_pending = 0;
+
+static pthread_t io_thread;
+static bool io_running = false;
+static atomic_bool io_stop;
+static atomic_bool doorbell_rung;
+static int wake_pipe[2] = {-1, -1};
+
+static size_t ring_used(byte_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire) -
+           atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+/**
+ * @brief Number of the len bytes at pos that come before the ring wraps
+ */
+static size_t contiguous(size_t pos, size_t len)
+{
+    size_t to_end = TCP_SOCKET_IO_RING_SIZE - (pos & RING_MASK);
+    return len < to_end ? len : to_end;
+}
+
+static void ring_copy_in(byte_ring_t *ring, size_t pos, const uint8_t *src, size_t len)
+{
+    size_t offset = pos & RING_MASK;
+    size_t first  = contiguous(pos, len);
+    memcpy(&ring->data[offset], src, first);
+    memcpy(ring->data, src + first, len - first);
+}
+
+static void ring_copy_out(const byte_ring_t *ring, size_t pos, uint8_t *dst, size_t len)
+{
+    size_t offset = pos & RING_MASK;
+    size_t first  = contiguous(pos, len);
+    memcpy(dst, &ring->data[offset], first);
+    memcpy(dst + first, ring->data, len - first);
+}
+
+/**
+ * @brief Append len bytes, optionally preceded by a record length
+ *
+ * @return false if they do not fit
+ */
+static bool ring_push(byte_ring_t *ring, const uint8_t *src, size_t len, bool record)
+{
+    size_t head  = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail  = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t total = len + (record ? sizeof(uint16_t) : 0);
+    if (TCP_SOCKET_IO_RING_SIZE - (head - tail) < total || (record && len > UINT16_MAX))
+    {
+        return false;
+    }
+
+    if (record)
+    {
+        uint16_t length = (uint16_t)len;
+        ring_copy_in(ring, head, (const uint8_t *)&length, sizeof(length));
+        head += sizeof(length);
+    }
+    ring_copy_in(ring, head, src, len);
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Take up to len bytes, or the next record (truncated to len)
+ *
+ * @return Number of bytes copied
+ */
+static size_t ring_pop(byte_ring_t *ring, uint8_t *dst, size_t len, bool record)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t used = head - tail;
+    size_t take = used < len ? used : len;
+
+    if (record && used > 0)
+    {
+        uint16_t length;
+        ring_copy_out(ring, tail, (uint8_t *)&length, sizeof(length));
+        tail += sizeof(length);
+        take = length < len ? length : len;
+        ring_copy_out(ring, tail, dst, take);
+        atomic_store_explicit(&ring->tail, tail + length, memory_order_release);
+        return take;
+    }
+
+    ring_copy_out(ring, tail, dst, take);
+    atomic_store_explicit(&ring->tail, tail + take, memory_order_release);
+    return take;
+}
+
+static void ring_doorbell(void)
+{
+    // One wake-up is enough until the I/O thread has looked at the rings again
+    if (wake_pipe[1] >= 0 && !atomic_exchange(&doorbell_rung, true))
+    {
+        char byte       = 1;
+        ssize_t written = write(wake_pipe[1], &byte, 1);
+        (void)written;
+    }
+}
+
+static managed_socket_t *lookup(int fd)
+{
+    if (fd < 0 || fd >= TCP_SOCKET_IO_MAX_FD)
+    {
+        return NULL;
+    }
+    return atomic_load_explicit(&sockets_by_fd[fd], memory_order_acquire);
+}
+
+int tcp_socket_io_register(int fd, bool datagram)
+{
+    if (!io_running || fd < 0 || fd >= TCP_SOCKET_IO_MAX_FD)
+    {
+        return -1;
+    }
+
+    managed_socket_t *sock = calloc(1, sizeof(*sock));
+    if (sock == NULL)
+    {
+        return -1;
+    }
+    sock->fd       = fd;
+    sock->datagram = datagram;
+    pthread_mutex_init(&sock->send_mutex, NULL);
+    pthread_mutex_init(&sock->receive_mutex, NULL);
+
+    pthread_mutex_lock(&pending_mutex);
+    if (num_owned + num_pending >= MAX_MANAGED_SOCKETS)
+    {
+        pthread_mutex_unlock(&pending_mutex);
+        pthread_mutex_destroy(&sock->send_mutex);
+        pthread_mutex_destroy(&sock->receive_mutex);
+        free(sock);
+        log_warn("TCP Client: more than %d open sockets, socket %d uses direct I/O",
+                 MAX_MANAGED_SOCKETS, fd);
+        return -1;
+    }
+    pending[num_pending++] = sock;
+    pthread_mutex_unlock(&pending_mutex);
+
+    atomic_store_explicit(&sockets_by_fd[fd], sock, memory_order_release);
+    ring_doorbell();
+    return 0;
+}
+
+int tcp_socket_io_send(int fd, const uint8_t *msg, size_t msg_size)
+{
+    managed_socket_t *sock = lookup(fd);
+    if (sock == NULL)
+    {
+        return TCP_SOCKET_IO_UNMANAGED;
+    }
+
+    pthread_mutex_lock(&sock->send_mutex);
+    bool queued =
+        !atomic_load(&sock->failed) && ring_push(&sock->send, msg, msg_size, sock->datagram);
+    pthread_mutex_unlock(&sock->send_mutex);
+    if (!queued)
+    {
+        return -1;
+    }
+    ring_doorbell();
+    return (int)msg_size;
+}
+
+int tcp_socket_io_receive(int fd, uint8_t *buffer, size_t buffer_size)
+{
+    managed_socket_t *sock = lookup(fd);
+    if (sock == NULL)
+    {
+        return TCP_SOCKET_IO_UNMANAGED;
+    }
+
+    pthread_mutex_lock(&sock->receive_mutex);
+    size_t used = ring_used(&sock->receive);
+    if (used == 0)
+    {
+        // Read end-of-file only after the data, the I/O thread sets it after the last push
+        bool eof = atomic_load(&sock->eof) && ring_used(&sock->receive) == 0;
+        pthread_mutex_unlock(&sock->receive_mutex);
+        return eof ? 0 : -1;
+    }
+
+    size_t received = ring_pop(&sock->receive, buffer, buffer_size, sock->datagram);
+    pthread_mutex_unlock(&sock->receive_mutex);
+
+    // A full ring stopped the I/O thread from reading, let it continue
+    if (used == TCP_SOCKET_IO_RING_SIZE || sock->datagram)
+    {
+        ring_doorbell();
+    }
+    return (int)received;
+}
+
+int tcp_socket_io_close(int fd)
+{
+    managed_socket_t *sock = lookup(fd);
+    if (sock == NULL)
+    {
+        return TCP_SOCKET_IO_UNMANAGED;
+    }
+
+    atomic_store_explicit(&sockets_by_fd[fd], NULL, memory_order_release);
+    atomic_store(&sock->closing, true);
+    ring_doorbell();
+    return 0;
+}
+
+/**
+ * @brief Describe len ring bytes starting at pos, split where the ring wraps
+ *
+ * @return Number of iovec entries used
+ */
+static int ring_iov(byte_ring_t *ring, size_t pos, size_t len, struct iovec iov[2])
+{
+    size_t offset   = pos & RING_MASK;
+    size_t first    = contiguous(pos, len);
+    iov[0].iov_base = &ring->data[offset];
+    iov[0].iov_len  = first;
+    iov[1].iov_base = ring->data;
+    iov[1].iov_len  = len - first;
+    return len > first ? 2 : 1;
+}
+
+/**
+ * @brief Send queued data until the ring is empty or the socket is full
+ */
+static void flush_send(managed_socket_t *sock)
+{
+    byte_ring_t *ring = &sock->send;
+    while (!atomic_load(&sock->failed))
+    {
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (head == tail)
+        {
+            return;
+        }
+
+        size_t header = 0;
+        size_t len    = head - tail;
+        if (sock->datagram)
+        {
+            uint16_t length;
+            ring_copy_out(ring, tail, (uint8_t *)&length, sizeof(length));
+            header = sizeof(length);
+            len    = length;
+        }
+
+        // Send straight from the ring, no copy
+        struct iovec iov[2];
+        struct msghdr msg = {0};
+        msg.msg_iov       = iov;
+        msg.msg_iovlen    = ring_iov(ring, tail + header, len, iov);
+
+        ssize_t sent = sendmsg(sock->fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                log_error("TCP Client: error sending msg to server => %s", strerror(errno));
+                atomic_store(&sock->failed, true);
+            }
+            return;
+        }
+
+        // A datagram is sent as a whole or not at all
+        size_t consumed = sock->datagram ? header + len : (size_t)sent;
+        atomic_store_explicit(&ring->tail, tail + consumed, memory_order_release);
+    }
+}
+
+/**
+ * @brief Read from the socket until the ring is full or no data is left
+ */
+static void fill_receive(managed_socket_t *sock)
+{
+    static uint8_t datagram[65536];
+    byte_ring_t *ring = &sock->receive;
+
+    while (!atomic_load(&sock->eof) && !atomic_load(&sock->failed))
+    {
+        size_t head  = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        size_t space = TCP_SOCKET_IO_RING_SIZE - ring_used(ring);
+        if (space <= (sock->datagram ? sizeof(uint16_t) : 0))
+        {
+            return;
+        }
+
+        ssize_t received;
+        if (sock->datagram)
+        {
+            // Read whole, a datagram that does not fit the ring is dropped
+            received = recv(sock->fd, datagram, sizeof(datagram), 0);
+        }
+        else
+        {
+            struct iovec iov[2];
+            struct msghdr msg = {0};
+            msg.msg_iov       = iov;
+            msg.msg_iovlen    = ring_iov(ring, head, space, iov);
+            received          = recvmsg(sock->fd, &msg, 0);
+        }
+
+        if (received < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                atomic_store(&sock->failed, true);
+            }
+            return;
+        }
+        if (received == 0 && !sock->datagram)
+        {
+            atomic_store(&sock->eof, true);
+            return;
+        }
+
+        if (sock->datagram)
+        {
+            ring_push(ring, datagram, (size_t)received, true);
+        }
+        else
+        {
+            atomic_store_explicit(&ring->head, head + (size_t)received, memory_order_release);
+        }
+    }
+}
+
+static void release_socket(size_t index)
+{
+    managed_socket_t *sock = owned[index];
+
+    // Best effort: whatever the kernel takes right now is still delivered
+    flush_send(sock);
+    close(sock->fd);
+    pthread_mutex_destroy(&sock->send_mutex);
+    pthread_mutex_destroy(&sock->receive_mutex);
+    free(sock);
+    owned[index] = owned[--num_owned];
+}
+
+static void *io_thread_main(void *arg)
+{
+    (void)arg;
+    struct pollfd fds[MAX_MANAGED_SOCKETS + 1];
+    managed_socket_t *polled[MAX_MANAGED_SOCKETS + 1];
+
+    while (!atomic_load(&io_stop))
+    {
+        pthread_mutex_lock(&pending_mutex);
+        for (size_t i = 0; i < num_pending; i++)
+        {
+            owned[num_owned++] = pending[i];
+        }
+        num_pending = 0;
+        pthread_mutex_unlock(&pending_mutex);
+
+        // Rings checked from here on are covered, later changes ring again
+        atomic_store(&doorbell_rung, false);
+
+        nfds_t count      = 0;
+        fds[count].fd     = wake_pipe[0];
+        fds[count].events = POLLIN;
+        polled[count++]   = NULL;
+        for (size_t i = 0; i < num_owned;)
+        {
+            managed_socket_t *sock = owned[i];
+            if (atomic_load(&sock->closing))
+            {
+                release_socket(i);
+                continue;
+            }
+            i++;
+
+            if (atomic_load(&sock->failed))
+            {
+                continue;
+            }
+            flush_send(sock);
+
+            short events = 0;
+            if (ring_used(&sock->send) > 0)
+            {
+                events |= POLLOUT;
+            }
+            if (!atomic_load(&sock->eof) && ring_used(&sock->receive) < TCP_SOCKET_IO_RING_SIZE)
+            {
+                events |= POLLIN;
+            }
+            if (events != 0)
+            {
+                fds[count].fd     = sock->fd;
+                fds[count].events = events;
+                polled[count++]   = sock;
+            }
+        }
+
+        if (poll(fds, count, IO_MAX_SLEEP_MS) <= 0)
+        {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            char drain[64];
+            while (read(wake_pipe[0], drain, sizeof(drain)) > 0)
+            {
+            }
+        }
+
+        for (nfds_t n = 1; n < count; n++)
+        {
+            managed_socket_t *sock = polled[n];
+            if (fds[n].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                fill_receive(sock);
+            }
+            if (fds[n].revents & POLLOUT)
+            {
+                flush_send(sock);
+            }
+            if ((fds[n].revents & POLLERR) && !atomic_load(&sock->eof))
+            {
+                atomic_store(&sock->failed, true);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+int tcp_socket_io_init(void)
+{
+    if (io_running)
+    {
+        return 0;
+    }
+
+    if (pipe(wake_pipe) != 0)
+    {
+        log_error("TCP Client: failed to create wake-up pipe => %s", strerror(errno));
+        return -1;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        fcntl(wake_pipe[i], F_SETFL, fcntl(wake_pipe[i], F_GETFL, 0) | O_NONBLOCK);
+        fcntl(wake_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    atomic_store(&io_stop, false);
+    atomic_store(&doorbell_rung, false);
+    if (pthread_create(&io_thread, NULL, io_thread_main, NULL) != 0)
+    {
+        log_error("TCP Client: failed to create socket I/O thread");
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+        wake_pipe[0] = wake_pipe[1] = -1;
+        return -1;
+    }
+    io_running = true;
+    return 0;
+}
+
+void tcp_socket_io_cleanup(void)
+{
+    if (!io_running)
+    {
+        return;
+    }
+
+    atomic_store(&io_stop, true);
+    atomic_store(&doorbell_rung, false);
+    ring_doorbell();
+    pthread_join(io_thread, NULL);
+    io_running = false;
+
+    for (int fd = 0; fd < TCP_SOCKET_IO_MAX_FD; fd++)
+    {
+        atomic_store(&sockets_by_fd[fd], NULL);
+    }
+    for (size_t i = 0; i < num_pending; i++)
+    {
+        owned[num_owned++] = pending[i];
+    }
+    num_pending = 0;
+    while (num_owned > 0)
+    {
+        release_socket(num_owned - 1);
+    }
+
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    wake_pipe[0] = wake_pipe[1] = -1;
+}
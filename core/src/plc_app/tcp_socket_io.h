@@ -0,0 +1,72 @@
+#ifndef TCP_SOCKET_IO_H
+#define TCP_SOCKET_IO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes buffered per direction and socket (power of two)
+#define TCP_SOCKET_IO_RING_SIZE 16384
+
+// Sockets with a descriptor at or above this are not managed
+#define TCP_SOCKET_IO_MAX_FD 1024
+
+// Returned for a descriptor that is not managed by the I/O thread
+#define TCP_SOCKET_IO_UNMANAGED (-2)
+
+/**
+ * @brief Start the socket I/O thread
+ *
+ * @return 0 on success, -1 on failure
+ */
+int tcp_socket_io_init(void);
+
+/**
+ * @brief Stop the socket I/O thread and close all managed sockets
+ */
+void tcp_socket_io_cleanup(void);
+
+/**
+ * @brief Hand a connected, non-blocking socket to the I/O thread
+ *
+ * Allocates the send and receive rings, so call it before the socket is
+ * given to the PLC program, not from the PLC cycle thread.
+ *
+ * @param fd        Connected socket
+ * @param datagram  UDP socket: keep message boundaries
+ * @return 0 on success, -1 if the socket stays unmanaged
+ */
+int tcp_socket_io_register(int fd, bool datagram);
+
+/**
+ * @brief Queue a message for sending
+ *
+ * Makes no system call except an occasional wake-up of the I/O thread and
+ * waits only for other tasks sending on the same socket. The message is
+ * queued as a whole or not at all.
+ *
+ * @return Number of bytes queued, -1 if the ring is full or the socket
+ *         failed, TCP_SOCKET_IO_UNMANAGED for an unmanaged descriptor
+ */
+int tcp_socket_io_send(int fd, const uint8_t *msg, size_t msg_size);
+
+/**
+ * @brief Take received data
+ *
+ * For UDP sockets one datagram is returned per call. Safe to call from
+ * several tasks at once.
+ *
+ * @return Number of bytes copied, -1 if nothing is available or the socket
+ *         failed, 0 once the peer closed the connection and all data was
+ *         taken, TCP_SOCKET_IO_UNMANAGED for an unmanaged descriptor
+ */
+int tcp_socket_io_receive(int fd, uint8_t *buffer, size_t buffer_size);
+
+/**
+ * @brief Close a socket; queued data is still sent by the I/O thread
+ *
+ * @return 0 on success, TCP_SOCKET_IO_UNMANAGED for an unmanaged descriptor
+ */
+int tcp_socket_io_close(int fd);
+
+#endif // TCP_SOCKET_IO_H
@@ -10,6 +10,9 @@
 #include <unistd.h>
 
 #include "debug_handler.h"
+#include "multi_task.h"
+#include "online_change.h"
+#include "overrun_forensics.h"
 #include "plc_state_manager.h"
 #include "scan_cycle_manager.h"
 #include "unix_socket.h"
@@ -91,10 +94,36 @@ void handle_unix_socket_commands(const char *command, char *response, size_t res
             log_error("Received START command but PLC is already RUNNING");
         }
     }
+    else if (strcmp(command, "FAST_RESTART") == 0)
+    {
+        if (plc_fast_restart() == 0)
+            strncpy(response, "FAST_RESTART:OK\n", response_size);
+        else
+            strncpy(response, "FAST_RESTART:ERROR\n", response_size);
+    }
+    else if (strcmp(command, "ONLINE_CHANGE") == 0)
+    {
+        if (online_change_execute() == 0)
+            strncpy(response, "ONLINE_CHANGE:OK\n", response_size);
+        else
+            strncpy(response, "ONLINE_CHANGE:ERROR\n", response_size);
+    }
     else if (strcmp(command, "STATS") == 0)
     {
         format_timing_stats_response(response, response_size);
     }
+    else if (strcmp(command, "HISTOGRAM") == 0)
+    {
+        format_latency_histogram_response(response, response_size);
+    }
+    else if (strcmp(command, "TASKS") == 0)
+    {
+        format_task_stats_response(response, response_size);
+    }
+    else if (strcmp(command, "FORENSICS") == 0)
+    {
+        format_overrun_forensics_response(response, response_size);
+    }
     else if (strncmp(command, "DEBUG:", 6) == 0)
     {
         uint8_t debug_data[4096] = {0};
@@ -1,7 +1,9 @@
 #include "utils.h"
 #include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 // MSYS2/Cygwin does not support mlockall or real-time scheduling
@@ -70,7 +72,7 @@ void set_realtime_priority(void)
 {
 #if HAS_REALTIME_FEATURES
     struct sched_param param;
-    param.sched_priority = 20; // Priority between 1 and 99
+    param.sched_priority = PLC_CYCLE_PRIORITY; // Priority between 1 and 99
 
     if (sched_setscheduler(0, SCHED_FIFO, &param) != 0)
     {
@@ -86,6 +88,69 @@ void set_realtime_priority(void)
 #endif
 }
 
+int set_thread_realtime_priority(int priority)
+{
+#if HAS_REALTIME_FEATURES
+    struct sched_param param;
+    param.sched_priority = priority;
+
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0)
+    {
+        log_error("pthread_setschedparam failed: %s", strerror(err));
+        return -1;
+    }
+    return 0;
+#else
+    (void)priority;
+    return -1;
+#endif
+}
+
+#if HAS_REALTIME_FEATURES && defined(SYS_sched_setattr)
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+#define PLC_SCHED_FLAG_RESET_ON_FORK 0x01
+#define PLC_SCHED_FLAG_DL_OVERRUN    0x04
+
+// Same layout as struct sched_attr of the kernel, not declared by every libc
+struct plc_sched_attr
+{
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+#endif
+
+int set_thread_deadline_scheduling(uint64_t runtime_ns, uint64_t deadline_ns,
+                                   uint64_t period_ns)
+{
+#if HAS_REALTIME_FEATURES && defined(SYS_sched_setattr)
+    struct plc_sched_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.sched_policy   = SCHED_DEADLINE;
+    attr.sched_flags    = PLC_SCHED_FLAG_RESET_ON_FORK | PLC_SCHED_FLAG_DL_OVERRUN;
+    attr.sched_runtime  = runtime_ns;
+    attr.sched_deadline = deadline_ns;
+    attr.sched_period   = period_ns;
+
+    return syscall(SYS_sched_setattr, 0, &attr, 0) == 0 ? 0 : -1;
+#else
+    (void)runtime_ns;
+    (void)deadline_ns;
+    (void)period_ns;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
 // Lock all memory pages to prevent page faults during PLC execution
 void lock_memory(void)
 {
@@ -197,3 +262,32 @@ void bytes_to_hex_string(const uint8_t *bytes, size_t len, char *out_str, size_t
         out_str[out_size - 1] = '\0';
     }
 }
+
+static uint32_t crc32_table[256];
+static pthread_once_t crc32_table_once = PTHREAD_ONCE_INIT;
+
+static void crc32_build_table(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+        {
+            c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        }
+        crc32_table[i] = c;
+    }
+}
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len)
+{
+    pthread_once(&crc32_table_once, crc32_build_table);
+
+    const uint8_t *p = (const uint8_t *)data;
+    crc              = ~crc;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = crc32_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
@@ -38,11 +38,39 @@ void sleep_until(struct timespec *ts);
 void timespec_diff(struct timespec *a, struct timespec *b,
                    struct timespec *result);
 
+// SCHED_FIFO priority of the PLC cycle thread
+#define PLC_CYCLE_PRIORITY 20
+
+// SCHED_FIFO priority of the scan watchdog thread, which must preempt a spinning scan
+#define PLC_WATCHDOG_PRIORITY 30
+
 /**
  * @brief Set the realtime priority object
  */
 void set_realtime_priority(void);
 
+/**
+ * @brief Run the calling thread with SCHED_FIFO at a given priority
+ *
+ * @param priority The priority, between 1 and 99
+ * @return 0 on success, -1 if real-time scheduling is not available
+ */
+int set_thread_realtime_priority(int priority);
+
+/**
+ * @brief Run the calling thread with SCHED_DEADLINE
+ *
+ * The thread gets runtime_ns of CPU time in every period_ns, to be used
+ * within deadline_ns of the period start. The kernel sends SIGXCPU when a
+ * period used up its runtime; threads created later start with the default
+ * policy.
+ *
+ * @return 0 on success, -1 with errno set if the kernel refuses the
+ *         parameters (admission control, permissions) or lacks the policy
+ */
+int set_thread_deadline_scheduling(uint64_t runtime_ns, uint64_t deadline_ns,
+                                   uint64_t period_ns);
+
 /**
  * @brief Lock all current and future memory pages to prevent page faults
  * 
@@ -71,4 +99,17 @@ size_t parse_hex_string(const char *hex_string, uint8_t *data);
  */
 void bytes_to_hex_string(const uint8_t *bytes, size_t len, char *out_str, size_t out_size, const char *prepend);
 
+/**
+ * @brief Update a CRC-32 (IEEE 802.3) checksum with more data
+ *
+ * Start with crc = 0; the result of one call can be passed to the next to
+ * checksum data that is not contiguous.
+ *
+ * @param crc The checksum of the preceding data, or 0
+ * @param data The data to add
+ * @param len The length of the data
+ * @return The updated checksum
+ */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
 #endif // UTILS_H
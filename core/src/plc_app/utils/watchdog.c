@@ -1,17 +1,45 @@
+#include <errno.h>
 #include <pthread.h>
 #include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#endif
+
+#include "../../drivers/plugin_driver.h"
+#include "../multi_task.h"
 #include "../plc_state_manager.h"
 #include "log.h"
 #include "utils.h"
 #include "watchdog.h"
 
+extern plugin_driver_t *plugin_driver;
+
 atomic_long plc_heartbeat;
 
+// Escalation stages of the scan watchdog, in order
+enum
+{
+    SCAN_WATCHDOG_WARN,
+    SCAN_WATCHDOG_SAFE,
+    SCAN_WATCHDOG_ERROR,
+    SCAN_WATCHDOG_STAGES
+};
+
+static unsigned int stage_ticks[SCAN_WATCHDOG_STAGES] = {0, 0, 0};
+
+// Written by the PLC cycle thread at the end of every scan
+static atomic_ulong scan_sequence;
+static atomic_int_least64_t scan_end_ns;
+
+static pthread_mutex_t stats_mutex        = PTHREAD_MUTEX_INITIALIZER;
+static scan_watchdog_stats_t scan_wd_stats = {0};
+
 void *watchdog_thread(void *arg)
 {
     (void)arg;
@@ -65,3 +93,239 @@ int watchdog_init(void)
     pthread_detach(wd_thread); // Detach the thread to avoid memory leaks
     return 0;
 }
+
+static int64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void scan_watchdog_configure(unsigned int warn_ticks, unsigned int safe_ticks,
+                             unsigned int error_ticks)
+{
+    stage_ticks[SCAN_WATCHDOG_WARN]  = warn_ticks;
+    stage_ticks[SCAN_WATCHDOG_SAFE]  = safe_ticks;
+    stage_ticks[SCAN_WATCHDOG_ERROR] = error_ticks;
+}
+
+bool scan_watchdog_enabled(void)
+{
+    for (int i = 0; i < SCAN_WATCHDOG_STAGES; i++)
+    {
+        if (stage_ticks[i] > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void scan_watchdog_scan_done(void)
+{
+    // The end time first: the watchdog thread reads the sequence first
+    atomic_store(&scan_end_ns, monotonic_ns());
+    atomic_fetch_add(&scan_sequence, 1);
+}
+
+void scan_watchdog_stats(scan_watchdog_stats_t *stats)
+{
+    pthread_mutex_lock(&stats_mutex);
+    *stats = scan_wd_stats;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+static void escalate(int stage, int64_t stalled_ns, const char *task)
+{
+    double stalled_ms = stalled_ns / 1e6;
+
+    char stall[64];
+    if (task != NULL)
+    {
+        snprintf(stall, sizeof(stall), "task %s has been running", task);
+    }
+    else
+    {
+        snprintf(stall, sizeof(stall), "no scan finished");
+    }
+
+    switch (stage)
+    {
+    case SCAN_WATCHDOG_WARN:
+        log_warn("Scan watchdog: %s for %.1f ms (%u task periods)", stall, stalled_ms,
+                 stage_ticks[stage]);
+        break;
+    case SCAN_WATCHDOG_SAFE:
+        log_error("Scan watchdog: %s for %.1f ms, forcing outputs safe", stall, stalled_ms);
+        plugin_driver_outputs_safe(plugin_driver);
+        break;
+    default:
+        log_error("Scan watchdog: %s for %.1f ms - PLC program is unresponsive", stall,
+                  stalled_ms);
+        plc_force_error_state();
+        break;
+    }
+}
+
+/**
+ * @brief Block until the next check, on the timerfd when there is one
+ */
+static void wait_next_check(int timer_fd)
+{
+    if (timer_fd >= 0)
+    {
+        uint64_t expirations;
+        while (read(timer_fd, &expirations, sizeof(expirations)) < 0 && errno == EINTR)
+        {
+        }
+        return;
+    }
+
+    struct timespec period = {0, SCAN_WATCHDOG_CHECK_US * 1000L};
+    nanosleep(&period, NULL);
+}
+
+static void *scan_watchdog_thread(void *arg)
+{
+    int timer_fd = (int)(intptr_t)arg;
+    set_thread_realtime_priority(PLC_WATCHDOG_PRIORITY);
+
+    unsigned long seen_sequence = atomic_load(&scan_sequence);
+    bool armed                  = false;
+    int64_t stall_start_ns      = 0; // Start of the stall being escalated
+    bool stall_in_task          = false;
+    int stage                   = 0; // Next stage of the current stall
+    bool counted                = false;
+
+    while (1)
+    {
+        wait_next_check(timer_fd);
+
+        unsigned long sequence = atomic_load(&scan_sequence);
+        if (plc_get_state() != PLC_STATE_RUNNING || ext_common_ticktime__ == NULL)
+        {
+            // Watch again once a scan of the next run finished
+            seen_sequence = sequence;
+            armed         = false;
+            continue;
+        }
+        if (sequence != seen_sequence)
+        {
+            seen_sequence = sequence;
+            armed         = true;
+        }
+        if (!armed)
+        {
+            continue;
+        }
+
+        // The scan, or in multi-task mode the task body, that is the most periods late
+        int64_t now_ns    = monotonic_ns();
+        int64_t start_ns  = atomic_load(&scan_end_ns);
+        int64_t period_ns = (int64_t)*ext_common_ticktime__;
+        uint64_t task_start_ns;
+        uint64_t task_period_ns;
+        const char *task = multi_task_longest_running(&task_start_ns, &task_period_ns);
+        if (task != NULL && (double)(now_ns - (int64_t)task_start_ns) / task_period_ns >
+                                (double)(now_ns - start_ns) / period_ns)
+        {
+            start_ns  = (int64_t)task_start_ns;
+            period_ns = (int64_t)task_period_ns;
+        }
+        else
+        {
+            task = NULL;
+        }
+
+        if (start_ns != stall_start_ns)
+        {
+            if (counted)
+            {
+                log_info("Scan watchdog: %s", stall_in_task ? "task finished" : "scans resumed");
+            }
+            stall_start_ns = start_ns;
+            stall_in_task  = task != NULL;
+            stage          = 0;
+            counted        = false;
+        }
+
+        int64_t stalled_ns = now_ns - start_ns;
+        for (; stage < SCAN_WATCHDOG_STAGES; stage++)
+        {
+            if (stage_ticks[stage] == 0)
+            {
+                continue;
+            }
+            int64_t limit_ns = stage_ticks[stage] * period_ns;
+            if (stalled_ns < limit_ns)
+            {
+                break;
+            }
+
+            int64_t latency_us = (stalled_ns - limit_ns) / 1000;
+            pthread_mutex_lock(&stats_mutex);
+            if (!counted)
+            {
+                scan_wd_stats.stalls++;
+            }
+            scan_wd_stats.detection_latency_last_us = latency_us;
+            if (latency_us > scan_wd_stats.detection_latency_max_us)
+            {
+                scan_wd_stats.detection_latency_max_us = latency_us;
+            }
+            pthread_mutex_unlock(&stats_mutex);
+            counted = true;
+
+            escalate(stage, stalled_ns, task);
+        }
+    }
+
+    return NULL;
+}
+
+int scan_watchdog_init(void)
+{
+    if (!scan_watchdog_enabled())
+    {
+        return 0;
+    }
+
+    int timer_fd = -1;
+#if defined(__linux__)
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timer_fd >= 0)
+    {
+        struct itimerspec period;
+        period.it_interval.tv_sec  = 0;
+        period.it_interval.tv_nsec = SCAN_WATCHDOG_CHECK_US * 1000L;
+        period.it_value            = period.it_interval;
+        if (timerfd_settime(timer_fd, 0, &period, NULL) != 0)
+        {
+            close(timer_fd);
+            timer_fd = -1;
+        }
+    }
+    if (timer_fd < 0)
+    {
+        log_warn("Scan watchdog: timerfd not available, using nanosleep");
+    }
+#endif
+
+    pthread_t wd_thread;
+    if (pthread_create(&wd_thread, NULL, scan_watchdog_thread, (void *)(intptr_t)timer_fd) != 0)
+    {
+        log_error("Failed to create scan watchdog thread");
+        if (timer_fd >= 0)
+        {
+            close(timer_fd);
+        }
+        return -1;
+    }
+    pthread_detach(wd_thread);
+
+    log_info("Scan watchdog: warn after %u, outputs safe after %u, ERROR after %u task periods "
+             "(0 = off)",
+             stage_ticks[SCAN_WATCHDOG_WARN], stage_ticks[SCAN_WATCHDOG_SAFE],
+             stage_ticks[SCAN_WATCHDOG_ERROR]);
+    return 0;
+}
@@ -1,10 +1,63 @@
 #ifndef WATCHDOG_H
 #define WATCHDOG_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+// How often the scan watchdog thread checks for a stalled scan
+#define SCAN_WATCHDOG_CHECK_US 1000
+
 /**
  * @brief Initialize the watchdog
  * @return int 0 on success, -1 on failure
  */
 int watchdog_init(void);
 
+/**
+ * @brief Configure the escalation stages of the scan watchdog
+ *
+ * Limits are multiples of the task period since the end of the last scan,
+ * and in multi-task mode of a task's own period since its body started;
+ * 0 disables a stage, and all stages are off until configured. Stages
+ * escalate in order: log a warning, call the outputs_safe() hook of native
+ * plugins, then put the PLC in ERROR state.
+ */
+void scan_watchdog_configure(unsigned int warn_ticks, unsigned int safe_ticks,
+                             unsigned int error_ticks);
+
+/**
+ * @brief Start the scan watchdog thread
+ *
+ * The thread wakes every SCAN_WATCHDOG_CHECK_US on a timerfd, at a
+ * SCHED_FIFO priority above the PLC cycle thread, so a stalled scan is
+ * detected within milliseconds of its limit even if it spins.
+ *
+ * @return 0 on success or when all stages are disabled, -1 on failure
+ */
+int scan_watchdog_init(void);
+
+/**
+ * @brief Count a finished scan
+ *
+ * @note Called by the PLC cycle thread at the end of every scan.
+ */
+void scan_watchdog_scan_done(void);
+
+/**
+ * @brief Whether any scan watchdog stage is enabled
+ */
+bool scan_watchdog_enabled(void);
+
+/**
+ * @brief Stalls and detection latency of the scan watchdog
+ */
+typedef struct
+{
+    uint64_t stalls;                  // Stalls that reached the first enabled stage
+    int64_t detection_latency_last_us; // From reaching the limit to detecting it
+    int64_t detection_latency_max_us;
+} scan_watchdog_stats_t;
+
+void scan_watchdog_stats(scan_watchdog_stats_t *stats);
+
 #endif // WATCHDOG_H
@@ -0,0 +1,146 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/log.h"
+#include "variable_table.h"
+
+int variable_table_load(const char *path, variable_table_t *table)
+{
+    table->vars  = NULL;
+    table->count = 0;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        log_error("Failed to open %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    char line[4096];
+    bool in_variables = false;
+    size_t capacity   = 0;
+    int result        = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        // Sections start with a comment line: "// Programs", "// Variables", ...
+        if (strncmp(line, "//", 2) == 0)
+        {
+            in_variables = strstr(line, "Variables") != NULL;
+            continue;
+        }
+        if (!in_variables || line[0] == '\0')
+        {
+            continue;
+        }
+
+        // index;kind;name;name;type;derived type;retain;
+        char *fields[7];
+        char *cursor = line;
+        int count    = 0;
+        while (count < 7 && cursor != NULL)
+        {
+            fields[count++] = cursor;
+            cursor          = strchr(cursor, ';');
+            if (cursor != NULL)
+            {
+                *cursor++ = '\0';
+            }
+        }
+        if (count < 5 || strcmp(fields[1], "FB") == 0)
+        {
+            continue;
+        }
+
+        if (table->count == capacity)
+        {
+            size_t new_capacity    = capacity ? capacity * 2 : 64;
+            variable_entry_t *vars = realloc(table->vars, new_capacity * sizeof(*vars));
+            if (vars == NULL)
+            {
+                result = -1;
+                break;
+            }
+            table->vars = vars;
+            capacity    = new_capacity;
+        }
+
+        variable_entry_t *var = &table->vars[table->count];
+        var->name             = strdup(fields[2]);
+        var->type             = strdup(fields[4]);
+        var->retain           = count > 6 && strcmp(fields[6], "1") == 0;
+        if (var->name == NULL || var->type == NULL)
+        {
+            free(var->name);
+            free(var->type);
+            result = -1;
+            break;
+        }
+        table->count++;
+    }
+
+    fclose(file);
+    if (result != 0)
+    {
+        log_error("Out of memory while reading %s", path);
+        variable_table_free(table);
+    }
+    return result;
+}
+
+void variable_table_free(variable_table_t *table)
+{
+    for (size_t i = 0; i < table->count; i++)
+    {
+        free(table->vars[i].name);
+        free(table->vars[i].type);
+    }
+    free(table->vars);
+    table->vars  = NULL;
+    table->count = 0;
+}
+
+static int compare_var_names(const void *a, const void *b)
+{
+    const variable_entry_t *const *va = a;
+    const variable_entry_t *const *vb = b;
+    return strcmp((*va)->name, (*vb)->name);
+}
+
+long variable_table_match(const variable_table_t *old_table, const variable_table_t *new_table,
+                          long *old_index)
+{
+    // Sort the old variables by name once, then look every new variable up
+    const variable_entry_t **sorted = malloc((old_table->count + 1) * sizeof(*sorted));
+    if (sorted == NULL)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < old_table->count; i++)
+    {
+        sorted[i] = &old_table->vars[i];
+    }
+    qsort(sorted, old_table->count, sizeof(*sorted), compare_var_names);
+
+    long matched = 0;
+    for (size_t i = 0; i < new_table->count; i++)
+    {
+        const variable_entry_t *key    = &new_table->vars[i];
+        const variable_entry_t **found =
+            bsearch(&key, sorted, old_table->count, sizeof(*sorted), compare_var_names);
+        old_index[i] = -1;
+        if (found != NULL && strcmp((*found)->type, key->type) == 0)
+        {
+            old_index[i] = (long)(*found - old_table->vars);
+            matched++;
+        }
+    }
+
+    free(sorted);
+    return matched;
+}
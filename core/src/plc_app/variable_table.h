@@ -0,0 +1,57 @@
+#ifndef VARIABLE_TABLE_H
+#define VARIABLE_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define VARIABLES_CSV_PATH "./core/generated/VARIABLES.csv"
+
+/**
+ * @brief One entry of a program's debug variable table
+ */
+typedef struct
+{
+    char *name; // Fully qualified name, e.g. CONFIG0.RES0.INSTANCE0.COUNTER
+    char *type;  // IEC type name, e.g. INT
+    bool retain; // Declared RETAIN
+} variable_entry_t;
+
+/**
+ * @brief Debug variable table of a program, indexed like get_var_addr()
+ */
+typedef struct
+{
+    variable_entry_t *vars;
+    size_t count;
+} variable_table_t;
+
+/**
+ * @brief Read the debug variable table from a VARIABLES.csv file
+ *
+ * Function block rows are skipped so that entry i corresponds to debug
+ * variable index i of the program that was built from the same file.
+ *
+ * @param[in]   path   Path of the VARIABLES.csv file
+ * @param[out]  table  Parsed table, free with variable_table_free()
+ * @return 0 on success, -1 on failure
+ */
+int variable_table_load(const char *path, variable_table_t *table);
+
+/**
+ * @brief Free a table filled by variable_table_load()
+ */
+void variable_table_free(variable_table_t *table);
+
+/**
+ * @brief Match the variables of one program against another one
+ *
+ * @param[in]   old_table  Variables of the running program
+ * @param[in]   new_table  Variables of the new program
+ * @param[out]  old_index  For every new variable, the index of the variable with the same
+ *                         name and type in old_table, or -1 (new_table->count entries)
+ * @return Number of matched variables, or -1 on allocation failure
+ */
+long variable_table_match(const variable_table_t *old_table, const variable_table_t *new_table,
+                          long *old_index);
+
+#endif // VARIABLE_TABLE_H
@@ -0,0 +1,565 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "image_tables.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+#include "warm_restart.h"
+
+#define CHECKPOINT_FILE_MAGIC 0x4D524157U // "WARM"
+#define CHECKPOINT_FILE_VERSION 1U
+
+/*
+ * File layout:
+ *   checkpoint_file_header_t
+ *   slot 0 and slot 1, each page aligned: checkpoint_slot_header_t + data
+ *
+ * The data is the process image packed in range order. A checkpoint is
+ * written into the older slot, page by page, and only pages whose content
+ * changed are touched, so msync() writes back no more than what changed
+ * since that slot was last written.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    char program_md5[40]; // Program build the checkpoints belong to
+    uint32_t data_size;   // Bytes of data per slot
+    uint32_t slot_stride; // Distance between the two slots
+    uint32_t header_crc;  // CRC-32 of the fields above
+} checkpoint_file_header_t;
+
+typedef struct
+{
+    uint64_t sequence; // Checkpoint number, 0 if never written
+    uint64_t time_ms;  // Wall clock time of the capture
+    uint32_t data_size;
+    uint32_t crc; // CRC-32 of the fields above and the data
+} checkpoint_slot_header_t;
+
+typedef enum
+{
+    CAPTURE_IDLE,
+    CAPTURE_REQUESTED, // Set by the checkpoint thread
+    CAPTURE_RUNNING    // Cycle thread is copying the image into staging
+} capture_state_t;
+
+/**
+ * @brief Contiguous piece of the process image
+ */
+typedef struct
+{
+    uint8_t *addr;
+    size_t size;
+    size_t offset; // Position in the checkpoint data
+} image_range_t;
+
+typedef struct
+{
+    bool enabled;
+    char path[256];
+    unsigned int interval_ms;
+
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    size_t slot_offset;
+    size_t slot_stride;
+    size_t data_size;
+
+    image_range_t *ranges;
+    size_t num_ranges;
+    size_t ranges_capacity;
+
+    uint8_t *staging; // Process image captured by the cycle thread
+    uint64_t staging_time_ms;
+    int write_slot;
+    uint64_t sequence;
+
+    atomic_int capture_state; // capture_state_t, hands staging to the cycle thread and back
+
+    unsigned long long checkpoints;
+    unsigned long long pages_written;
+    unsigned long long pages_total;
+
+    pthread_t thread;
+    bool thread_running;
+    atomic_bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} checkpoint_store_t;
+
+static checkpoint_store_t store = {
+    .path        = WARM_RESTART_DEFAULT_PATH,
+    .interval_ms = WARM_RESTART_DEFAULT_INTERVAL_MS,
+    .fd          = -1,
+    .lock        = PTHREAD_MUTEX_INITIALIZER,
+    .wake        = PTHREAD_COND_INITIALIZER,
+};
+
+void warm_restart_configure(bool enabled, const char *path, unsigned int interval_ms)
+{
+    store.enabled = enabled;
+    if (path != NULL)
+    {
+        snprintf(store.path, sizeof(store.path), "%s", path);
+    }
+    if (interval_ms > 0)
+    {
+        store.interval_ms = interval_ms;
+    }
+}
+
+static uint64_t wall_clock_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static uint8_t *slot_base(int slot)
+{
+    return store.map + store.slot_offset + (size_t)slot * store.slot_stride;
+}
+
+static uint32_t slot_crc(const checkpoint_slot_header_t *header, const uint8_t *data)
+{
+    uint32_t crc = crc32_update(0, header, offsetof(checkpoint_slot_header_t, crc));
+    return crc32_update(crc, data, header->data_size);
+}
+
+static int add_range(void *addr, size_t size)
+{
+    // Merge with the previous range when the memory is contiguous
+    if (store.num_ranges > 0)
+    {
+        image_range_t *last = &store.ranges[store.num_ranges - 1];
+        if (last->addr + last->size == (uint8_t *)addr)
+        {
+            last->size += size;
+            store.data_size += size;
+            return 0;
+        }
+    }
+
+    if (store.num_ranges == store.ranges_capacity)
+    {
+        size_t capacity       = store.ranges_capacity ? store.ranges_capacity * 2 : 256;
+        image_range_t *ranges = realloc(store.ranges, capacity * sizeof(*ranges));
+        if (ranges == NULL)
+        {
+            return -1;
+        }
+        store.ranges          = ranges;
+        store.ranges_capacity = capacity;
+    }
+
+    image_range_t *range = &store.ranges[store.num_ranges++];
+    range->addr          = addr;
+    range->size          = size;
+    range->offset        = store.data_size;
+    store.data_size += size;
+    return 0;
+}
+
+/**
+ * @brief Collect the memory that makes up the process image of the loaded program
+ */
+static int bind_process_image(void)
+{
+    store.num_ranges = 0;
+    store.data_size  = 0;
+
+    // Image table values: the temporary backing arrays as a whole, plus every
+    // located variable of the program the tables point to
+    image_table_view_t views[IMAGE_TABLE_COUNT];
+    image_tables_get_views(NULL, views);
+    for (int t = 0; t < IMAGE_TABLE_COUNT; t++)
+    {
+        size_t backing_size = views[t].count * views[t].elem_size;
+        if (add_range(views[t].backing, backing_size) != 0)
+        {
+            return -1;
+        }
+        for (size_t i = 0; i < views[t].count; i++)
+        {
+            uint8_t *ptr = views[t].slots[i];
+            if (ptr != NULL && (ptr < views[t].backing || ptr >= views[t].backing + backing_size) &&
+                add_range(ptr, views[t].elem_size) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    // Program variables
+    if (ext_get_var_count != NULL && ext_get_var_size != NULL && ext_get_var_addr != NULL)
+    {
+        size_t count = ext_get_var_count();
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t size = ext_get_var_size(i);
+            void *addr  = ext_get_var_addr(i);
+            if (size > 0 && addr != NULL && add_range(addr, size) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void gather(uint8_t *data)
+{
+    for (size_t i = 0; i < store.num_ranges; i++)
+    {
+        memcpy(data + store.ranges[i].offset, store.ranges[i].addr, store.ranges[i].size);
+    }
+}
+
+static void scatter(const uint8_t *data)
+{
+    for (size_t i = 0; i < store.num_ranges; i++)
+    {
+        memcpy(store.ranges[i].addr, data + store.ranges[i].offset, store.ranges[i].size);
+    }
+}
+
+/**
+ * @brief Write the staged process image into the older slot and make it durable
+ */
+static void checkpoint(void)
+{
+    uint8_t *base                    = slot_base(store.write_slot);
+    checkpoint_slot_header_t *header = (checkpoint_slot_header_t *)base;
+    uint8_t *data                    = base + sizeof(*header);
+
+    // Touch only the pages whose content changed, so that unchanged pages
+    // stay clean and msync() has nothing to write for them
+    size_t page  = (size_t)getpagesize();
+    size_t first = page - sizeof(*header);
+    for (size_t offset = 0; offset < store.data_size;)
+    {
+        size_t len = offset == 0 ? first : page;
+        if (len > store.data_size - offset)
+        {
+            len = store.data_size - offset;
+        }
+        if (memcmp(data + offset, store.staging + offset, len) != 0)
+        {
+            memcpy(data + offset, store.staging + offset, len);
+            store.pages_written++;
+        }
+        store.pages_total++;
+        offset += len;
+    }
+
+    header->sequence  = store.sequence + 1;
+    header->time_ms   = store.staging_time_ms;
+    header->data_size = (uint32_t)store.data_size;
+    header->crc       = slot_crc(header, data);
+
+    if (msync(base, sizeof(*header) + store.data_size, MS_SYNC) != 0)
+    {
+        log_error("Warm restart: msync failed: %s", strerror(errno));
+        return;
+    }
+
+    store.sequence++;
+    store.checkpoints++;
+    store.write_slot = 1 - store.write_slot;
+}
+
+static void *checkpoint_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&store.lock);
+    while (!store.stop)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += store.interval_ms / 1000;
+        deadline.tv_nsec += (long)(store.interval_ms % 1000) * 1000000L;
+        normalize_timespec(&deadline);
+
+        pthread_cond_timedwait(&store.wake, &store.lock, &deadline);
+        if (store.stop)
+        {
+            break;
+        }
+        pthread_mutex_unlock(&store.lock);
+
+        // Let the cycle thread copy the image at the end of its next cycle
+        atomic_store(&store.capture_state, CAPTURE_REQUESTED);
+        while (atomic_load(&store.capture_state) != CAPTURE_IDLE && !store.stop)
+        {
+            struct timespec pause = {0, 1000 * 1000};
+            nanosleep(&pause, NULL);
+        }
+        if (atomic_load(&store.capture_state) == CAPTURE_IDLE)
+        {
+            checkpoint();
+        }
+
+        pthread_mutex_lock(&store.lock);
+    }
+    pthread_mutex_unlock(&store.lock);
+
+    return NULL;
+}
+
+static int start_checkpoint_thread(void)
+{
+    // Created from the PLC cycle thread, so do not inherit its real-time priority
+    pthread_attr_t attr;
+    struct sched_param param = {.sched_priority = 0};
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+
+    store.stop = false;
+    int result = pthread_create(&store.thread, &attr, checkpoint_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (result != 0)
+    {
+        log_error("Warm restart: failed to create checkpoint thread");
+        return -1;
+    }
+    store.thread_running = true;
+    return 0;
+}
+
+/**
+ * @brief Find the newest slot with a valid checksum
+ *
+ * @return Slot index, or -1 if there is none
+ */
+static int newest_valid_slot(void)
+{
+    int newest        = -1;
+    uint64_t sequence = 0;
+    for (int slot = 0; slot < 2; slot++)
+    {
+        const checkpoint_slot_header_t *header = (const checkpoint_slot_header_t *)slot_base(slot);
+        if (header->sequence > sequence && header->data_size == store.data_size &&
+            slot_crc(header, slot_base(slot) + sizeof(*header)) == header->crc)
+        {
+            sequence = header->sequence;
+            newest   = slot;
+        }
+    }
+    return newest;
+}
+
+/**
+ * @brief Map the checkpoint file, rewriting it if it belongs to another program
+ *
+ * @return 1 if the existing checkpoints can be used, 0 if the file was reset, -1 on failure
+ */
+static int map_file(void)
+{
+    size_t page       = (size_t)getpagesize();
+    store.slot_offset = (sizeof(checkpoint_file_header_t) + page - 1) & ~(page - 1);
+    store.slot_stride =
+        (sizeof(checkpoint_slot_header_t) + store.data_size + page - 1) & ~(page - 1);
+    store.map_size = store.slot_offset + 2 * store.slot_stride;
+
+    checkpoint_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic   = CHECKPOINT_FILE_MAGIC;
+    header.version = CHECKPOINT_FILE_VERSION;
+    snprintf(header.program_md5, sizeof(header.program_md5), "%s",
+             ext_plc_program_md5 ? ext_plc_program_md5 : "");
+    header.data_size   = (uint32_t)store.data_size;
+    header.slot_stride = (uint32_t)store.slot_stride;
+    header.header_crc  = crc32_update(0, &header, offsetof(checkpoint_file_header_t, header_crc));
+
+    checkpoint_file_header_t existing;
+    struct stat st;
+    int usable = pread(store.fd, &existing, sizeof(existing), 0) == (ssize_t)sizeof(existing) &&
+                 memcmp(&existing, &header, sizeof(header)) == 0 && fstat(store.fd, &st) == 0 &&
+                 (size_t)st.st_size == store.map_size;
+
+    if (!usable)
+    {
+        if (ftruncate(store.fd, 0) != 0 || ftruncate(store.fd, (off_t)store.map_size) != 0 ||
+            pwrite(store.fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+        {
+            log_error("Warm restart: failed to initialize %s: %s", store.path, strerror(errno));
+            return -1;
+        }
+    }
+
+    store.map = mmap(NULL, store.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, store.fd, 0);
+    if (store.map == MAP_FAILED)
+    {
+        log_error("Warm restart: failed to map %s: %s", store.path, strerror(errno));
+        store.map = NULL;
+        return -1;
+    }
+    return usable;
+}
+
+static void release_store(void)
+{
+    if (store.map != NULL)
+    {
+        munmap(store.map, store.map_size);
+        store.map = NULL;
+    }
+    if (store.fd >= 0)
+    {
+        close(store.fd);
+        store.fd = -1;
+    }
+    free(store.ranges);
+    free(store.staging);
+    store.ranges          = NULL;
+    store.ranges_capacity = 0;
+    store.num_ranges      = 0;
+    store.staging         = NULL;
+}
+
+int warm_restart_open(bool restore)
+{
+    if (!store.enabled)
+    {
+        return 0;
+    }
+    if (store.map != NULL)
+    {
+        warm_restart_close(false);
+    }
+    atomic_store(&store.capture_state, CAPTURE_IDLE);
+
+    if (bind_process_image() != 0 || (store.staging = malloc(store.data_size)) == NULL)
+    {
+        log_error("Warm restart: out of memory");
+        release_store();
+        return -1;
+    }
+
+    store.fd = open(store.path, O_RDWR | O_CREAT, 0644);
+    if (store.fd < 0)
+    {
+        log_error("Warm restart: failed to open %s: %s", store.path, strerror(errno));
+        release_store();
+        return -1;
+    }
+
+    int usable = map_file();
+    if (usable < 0)
+    {
+        release_store();
+        return -1;
+    }
+
+    // Continue the sequence of the newest checkpoint and overwrite the older slot
+    int newest       = usable ? newest_valid_slot() : -1;
+    store.sequence   = 0;
+    store.write_slot = 0;
+    if (newest >= 0)
+    {
+        const checkpoint_slot_header_t *header =
+            (const checkpoint_slot_header_t *)slot_base(newest);
+        store.sequence   = header->sequence;
+        store.write_slot = 1 - newest;
+
+        if (restore)
+        {
+            scatter(slot_base(newest) + sizeof(*header));
+
+            time_t seconds = (time_t)(header->time_ms / 1000);
+            struct tm t;
+            char time_buf[20];
+            localtime_r(&seconds, &t);
+            strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", &t);
+            log_info("Warm restart: restored the process image of checkpoint %llu from %s",
+                     (unsigned long long)header->sequence, time_buf);
+        }
+    }
+    else if (restore)
+    {
+        log_warn("Warm restart: no valid checkpoint of this program in %s, cold start",
+                 store.path);
+    }
+
+    store.checkpoints   = 0;
+    store.pages_written = 0;
+    store.pages_total   = 0;
+    if (start_checkpoint_thread() != 0)
+    {
+        release_store();
+        return -1;
+    }
+
+    log_info("Warm restart: %zu bytes of process image in %zu ranges, checkpoint every %u ms",
+             store.data_size, store.num_ranges, store.interval_ms);
+    return 0;
+}
+
+void warm_restart_capture(void)
+{
+    int expected = CAPTURE_REQUESTED;
+    if (atomic_load_explicit(&store.capture_state, memory_order_relaxed) == CAPTURE_REQUESTED &&
+        atomic_compare_exchange_strong(&store.capture_state, &expected, CAPTURE_RUNNING))
+    {
+        gather(store.staging);
+        store.staging_time_ms = wall_clock_ms();
+        atomic_store_explicit(&store.capture_state, CAPTURE_IDLE, memory_order_release);
+    }
+}
+
+void warm_restart_close(bool final_checkpoint)
+{
+    if (store.thread_running)
+    {
+        pthread_mutex_lock(&store.lock);
+        store.stop = true;
+        pthread_cond_signal(&store.wake);
+        pthread_mutex_unlock(&store.lock);
+        pthread_join(store.thread, NULL);
+        store.thread_running = false;
+    }
+
+    // Withdraw a pending request and wait for a capture that already started
+    int expected = CAPTURE_REQUESTED;
+    atomic_compare_exchange_strong(&store.capture_state, &expected, CAPTURE_IDLE);
+    while (atomic_load(&store.capture_state) == CAPTURE_RUNNING)
+    {
+        struct timespec pause = {0, 50 * 1000};
+        nanosleep(&pause, NULL);
+    }
+
+    if (store.map == NULL)
+    {
+        return;
+    }
+
+    if (final_checkpoint)
+    {
+        gather(store.staging);
+        store.staging_time_ms = wall_clock_ms();
+        checkpoint();
+    }
+
+    log_info("Warm restart: %llu checkpoints, %llu of %llu pages written, last checkpoint %llu",
+             store.checkpoints, store.pages_written, store.pages_total,
+             (unsigned long long)store.sequence);
+    release_store();
+}
@@ -0,0 +1,48 @@
+#ifndef WARM_RESTART_H
+#define WARM_RESTART_H
+
+#include <stdbool.h>
+
+#define WARM_RESTART_DEFAULT_PATH "./checkpoint.bin"
+#define WARM_RESTART_DEFAULT_INTERVAL_MS 1000
+
+/**
+ * @brief Enable process image checkpoints and warm starts
+ *
+ * @param enabled      Write checkpoints and restore them when the program starts
+ * @param path         Checkpoint file, or NULL to keep the current one
+ * @param interval_ms  Checkpoint interval in milliseconds, or 0 to keep the current one
+ */
+void warm_restart_configure(bool enabled, const char *path, unsigned int interval_ms);
+
+/**
+ * @brief Bind the checkpoints to the loaded program
+ *
+ * The checkpoint covers the located image tables and all debug variables of
+ * the program. With restore set, the newest valid checkpoint written by the
+ * same program build is copied back, so the first scan continues where the
+ * last checkpoint left off. Starts the checkpoint thread.
+ *
+ * @note Call after the image tables are filled and before plugins start.
+ *
+ * @param restore Restore the last checkpoint (program start)
+ * @return 0 on success or if checkpoints are disabled, -1 on failure
+ */
+int warm_restart_open(bool restore);
+
+/**
+ * @brief Copy the process image for a checkpoint, if one was requested
+ *
+ * @note Called by the PLC cycle thread at the end of every cycle with buffer_mutex held.
+ */
+void warm_restart_capture(void);
+
+/**
+ * @brief Stop writing checkpoints
+ *
+ * @param final_checkpoint  Write a last checkpoint from the current values; only
+ *                          valid once the PLC cycle thread has exited normally
+ */
+void warm_restart_close(bool final_checkpoint);
+
+#endif // WARM_RESTART_H
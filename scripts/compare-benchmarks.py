@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""Compare two runtime_bench JSON results.
+
+Prints the change of the median time per operation of every benchmark and
+exits with status 1 if any benchmark got slower by more than the threshold.
+
+    ./build/runtime_bench --out before.json
+    # ... apply the change and rebuild ...
+    ./build/runtime_bench --out after.json
+    python3 scripts/compare-benchmarks.py before.json after.json
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_results(path):
+    with open(path, encoding="utf-8") as f:
+        data = json.load(f)
+    return {bench["name"]: bench for bench in data["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("before", help="results of the baseline run")
+    parser.add_argument("after", help="results of the run to check")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=10.0,
+        help="slowdown in percent reported as a regression (default: 10)",
+    )
+    args = parser.parse_args()
+
+    before = load_results(args.before)
+    after = load_results(args.after)
+
+    regressions = []
+    name_width = max((len(name) for name in before.keys() | after.keys()), default=4)
+    print(f"{'Benchmark':<{name_width}} {'Before ns':>12} {'After ns':>12} {'Change':>9}")
+    for name in sorted(before.keys() | after.keys()):
+        if name not in before or name not in after:
+            side = "after" if name not in after else "before"
+            print(f"{name:<{name_width}} {'missing in ' + side:>35}")
+            continue
+
+        old = before[name]["ns_per_op"]
+        new = after[name]["ns_per_op"]
+        change = (new - old) * 100.0 / old if old > 0 else 0.0
+
+        # A slowdown within the spread of the baseline runs is noise
+        noise = before[name]["max_ns_per_op"] - before[name]["min_ns_per_op"]
+        marker = ""
+        if change > args.threshold and new - old > noise:
+            marker = "  REGRESSION"
+            regressions.append(name)
+        elif change < -args.threshold:
+            marker = "  improved"
+        print(f"{name:<{name_width}} {old:>12.1f} {new:>12.1f} {change:>+8.1f}%{marker}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower by more than {args.threshold}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
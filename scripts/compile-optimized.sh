@@ -0,0 +1,78 @@
+#!/bin/bash
+set -euo pipefail
+
+# Profile-guided and link-time optimized build of the uploaded PLC program.
+#
+# 1. Builds the program as usual (baseline) and with instrumentation
+# 2. Runs the instrumented program offline with plc_runner to collect a profile
+# 3. Rebuilds with the profile and LTO
+# 4. Benchmarks baseline and optimized build with the same inputs and keeps the
+#    faster one as build/new_libplc.so
+#
+# Run it instead of compile.sh; compile-clean.sh is used afterwards as usual.
+
+BUILD_PATH="build"
+PGO_PATH="$BUILD_PATH/pgo"
+RUNNER="${OPENPLC_RUNNER:-$BUILD_PATH/plc_runner}"
+
+# Scans executed while profiling and benchmarking
+SCANS="${OPENPLC_PGO_SCANS:-20000}"
+
+# Recorded inputs for plc_runner (see plc_runner --help); random inputs if unset
+INPUTS="${OPENPLC_PGO_INPUTS:-}"
+
+if [ ! -x "$RUNNER" ]; then
+    echo "[ERROR] PLC runner not found: $RUNNER" >&2
+    exit 1
+fi
+
+RUNNER_ARGS=(--scans "$SCANS")
+if [ -n "$INPUTS" ]; then
+    RUNNER_ARGS+=(--inputs "$INPUTS")
+fi
+
+# Print the mean scan time in nanoseconds of a build
+mean_scan_ns() {
+    "$RUNNER" "$1" "${RUNNER_ARGS[@]}" | sed -n 's/.*mean_ns=\([0-9]*\).*/\1/p'
+}
+
+rm -rf "$PGO_PATH"
+mkdir -p "$PGO_PATH/profile"
+PROFILE_DIR="$(cd "$PGO_PATH/profile" && pwd)"
+
+echo "[INFO] Building baseline..."
+bash ./scripts/compile.sh
+cp "$BUILD_PATH/new_libplc.so" "$PGO_PATH/baseline.so"
+
+echo "[INFO] Building instrumented program..."
+OPENPLC_COMPILE_CACHE=0 OPENPLC_COMPILE_EXTRA_FLAGS="-fprofile-generate=$PROFILE_DIR" \
+    bash ./scripts/compile.sh
+
+echo "[INFO] Collecting profile over $SCANS scans..."
+"$RUNNER" "$BUILD_PATH/new_libplc.so" "${RUNNER_ARGS[@]}" > /dev/null
+
+echo "[INFO] Building with profile and LTO..."
+OPENPLC_COMPILE_CACHE=0 \
+    OPENPLC_COMPILE_EXTRA_FLAGS="-fprofile-use=$PROFILE_DIR -fprofile-correction -flto" \
+    bash ./scripts/compile.sh
+cp "$BUILD_PATH/new_libplc.so" "$PGO_PATH/optimized.so"
+
+echo "[INFO] Comparing scan times..."
+BASELINE_NS=$(mean_scan_ns "$PGO_PATH/baseline.so")
+OPTIMIZED_NS=$(mean_scan_ns "$PGO_PATH/optimized.so")
+if [ -z "$BASELINE_NS" ] || [ -z "$OPTIMIZED_NS" ] || [ "$BASELINE_NS" -eq 0 ]; then
+    echo "[ERROR] Benchmark failed, keeping baseline build" >&2
+    cp "$PGO_PATH/baseline.so" "$BUILD_PATH/new_libplc.so"
+    exit 0
+fi
+
+IMPROVEMENT=$(( (BASELINE_NS - OPTIMIZED_NS) * 100 / BASELINE_NS ))
+echo "[INFO] Mean scan time: baseline $BASELINE_NS ns, optimized $OPTIMIZED_NS ns" \
+     "($IMPROVEMENT% faster)"
+
+if [ "$OPTIMIZED_NS" -lt "$BASELINE_NS" ]; then
+    echo "[INFO] Using optimized build"
+else
+    echo "[INFO] Optimized build is not faster, using baseline build"
+    cp "$PGO_PATH/baseline.so" "$BUILD_PATH/new_libplc.so"
+fi
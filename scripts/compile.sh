@@ -9,7 +9,69 @@ BUILD_PATH="build"
 PYTHON_INCLUDE_PATH="core/src/plc_app/include"
 PYTHON_LOADER_SRC="core/src/plc_app/python_loader.c"
 
-FLAGS="-w -O3 -fPIC"
+CACHE_PATH="$BUILD_PATH/cache"
+
+# Extra flags are used by compile-optimized.sh for profile-guided builds
+FLAGS="-w -O3 -fPIC ${OPENPLC_COMPILE_EXTRA_FLAGS:-}"
+
+# Translation units compiled at the same time, and cache entries kept
+JOBS="${OPENPLC_COMPILE_JOBS:-$(nproc 2>/dev/null || echo 2)}"
+CACHE_ENTRIES="${OPENPLC_COMPILE_CACHE_ENTRIES:-64}"
+
+# Builds that read a profile must bypass the cache: the profile is not part
+# of the cache key, and profile files are named after the object file
+USE_CACHE="${OPENPLC_COMPILE_CACHE:-1}"
+
+now_ms() {
+    echo $(( $(date +%s%N) / 1000000 ))
+}
+
+# Hash the contents of every file listed in a dependency manifest
+# Usage: dependency_key <unit key> <manifest>
+dependency_key() {
+    { echo "$1"; xargs cat < "$2"; } 2>/dev/null | sha256sum | cut -d' ' -f1
+}
+
+# Compile one translation unit, reusing the cached object when neither the
+# source nor any header it included changed. As the manifest lists the
+# headers from the previous compile, a new #include changes the source and
+# so always misses.
+# Usage: compile_unit <name> <compiler> <source> [compiler args...]
+compile_unit() {
+    local name="$1" compiler="$2" src="$3"
+    shift 3
+    local start unit_key manifest key
+    start=$(now_ms)
+
+    if [ "$USE_CACHE" != "1" ]; then
+        "$compiler" $FLAGS "$@" -c "$src" -o "$BUILD_PATH/$name.o" || return 1
+        echo "[INFO] Compiled $src ($(( $(now_ms) - start )) ms)"
+        return 0
+    fi
+
+    unit_key=$(echo "$COMPILER_ID $FLAGS $* $src" | sha256sum | cut -d' ' -f1)
+    manifest="$CACHE_PATH/$unit_key.deps"
+
+    if [ -f "$manifest" ] && key=$(dependency_key "$unit_key" "$manifest") &&
+        [ -f "$CACHE_PATH/$key.o" ]; then
+        touch "$manifest" "$CACHE_PATH/$key.o"
+        cp "$CACHE_PATH/$key.o" "$BUILD_PATH/$name.o"
+        echo "[INFO] $src unchanged, using cached object ($(( $(now_ms) - start )) ms)"
+        return 0
+    fi
+
+    # Write under temporary names so an aborted build never leaves a bad entry
+    local tmp="$CACHE_PATH/$unit_key.$$"
+    "$compiler" $FLAGS "$@" -MMD -MF "$tmp.d" -c "$src" -o "$tmp.o" ||
+        { rm -f "$tmp.d" "$tmp.o"; return 1; }
+    sed -e 's/^[^:]*://' -e 's/\\$//' "$tmp.d" | tr -s ' ' '\n' | sed '/^$/d' > "$tmp.deps"
+    rm -f "$tmp.d"
+    key=$(dependency_key "$unit_key" "$tmp.deps")
+    mv "$tmp.o" "$CACHE_PATH/$key.o"
+    mv "$tmp.deps" "$manifest"
+    cp "$CACHE_PATH/$key.o" "$BUILD_PATH/$name.o"
+    echo "[INFO] Compiled $src ($(( $(now_ms) - start )) ms)"
+}
 
 check_required_files() {
     local missing_files=()
@@ -39,18 +101,37 @@ check_required_files() {
 
 check_required_files
 
-# Ensure build directory exists
-mkdir -p "$BUILD_PATH"
+BUILD_START=$(now_ms)
+
+# Ensure build and cache directories exist
+mkdir -p "$BUILD_PATH" "$CACHE_PATH"
 if [ ! -d "$BUILD_PATH" ]; then
     echo "[ERROR] Failed to create build directory: $BUILD_PATH" >&2
     exit 1
 fi
 
+# A different compiler must not reuse objects from the old one
+COMPILER_ID="$(gcc --version | head -n 1) / $(g++ --version | head -n 1)"
+
+OBJECTS=()
+PIDS=()
+FAILED=0
+
+# Start compile_unit in the background, at most $JOBS at a time
+queue_unit() {
+    if [ ${#PIDS[@]} -ge "$JOBS" ]; then
+        wait "${PIDS[0]}" || FAILED=1
+        PIDS=("${PIDS[@]:1}")
+    fi
+    compile_unit "$@" &
+    PIDS+=($!)
+    OBJECTS+=("$BUILD_PATH/$1.o")
+}
+
 # On Cygwin/MSYS2, TCP/UDP communication blocks are not supported (the PE
 # loader cannot resolve symbols from the host executable at dlopen time).
 # Provide no-op stubs so programs using these blocks still compile and run
 # — the blocks simply return -1 (failure) for every operation.
-EXTRA_OBJS=""
 case "$(uname -s)" in
     CYGWIN*|MSYS*|MINGW*)
         cat > "$BUILD_PATH/comm_stubs.c" << 'STUB'
@@ -61,27 +142,60 @@ int send_tcp_message(uint8_t *a, size_t b, int c) { (void)a; (void)b; (void)c; r
 int receive_tcp_message(uint8_t *a, size_t b, int c) { (void)a; (void)b; (void)c; return -1; }
 int close_tcp_connection(int a) { (void)a; return -1; }
 STUB
-        gcc $FLAGS -c "$BUILD_PATH/comm_stubs.c" -o "$BUILD_PATH/comm_stubs.o"
-        EXTRA_OBJS="$BUILD_PATH/comm_stubs.o"
+        queue_unit comm_stubs gcc "$BUILD_PATH/comm_stubs.c"
         ;;
 esac
 
+# Build the resource with a task table for plc_main --multi-task. Resources
+# the generator does not understand are built as generated, without one.
+RES0_SRC="$SRC_PATH/Res0.c"
+ST_FILE=$(find "$SRC_PATH" -maxdepth 1 -name '*.st' | head -n 1)
+if command -v python3 > /dev/null &&
+    python3 scripts/generate-task-table.py "$SRC_PATH/Res0.c" "$BUILD_PATH/Res0_tasks.c" \
+        ${ST_FILE:+--st "$ST_FILE"}; then
+    RES0_SRC="$BUILD_PATH/Res0_tasks.c"
+fi
+
 # Compile objects into build/
-echo "[INFO] Compiling Config0.c..."
-gcc $FLAGS -I "$LIB_PATH" -I "$PYTHON_INCLUDE_PATH" -include iec_python.h -c "$SRC_PATH/Config0.c" -o "$BUILD_PATH/Config0.o"
-echo "[INFO] Compiling Res0.c..."
-gcc $FLAGS -I "$LIB_PATH" -I "$PYTHON_INCLUDE_PATH" -include iec_python.h -c "$SRC_PATH/Res0.c" -o "$BUILD_PATH/Res0.o"
-echo "[INFO] Compiling debug.c..."
-gcc $FLAGS -I "$LIB_PATH" -c "$SRC_PATH/debug.c" -o "$BUILD_PATH/debug.o"
-echo "[INFO] Compiling glueVars.c..."
-gcc $FLAGS -I "$LIB_PATH" -DOPENPLC_V4 -c "$SRC_PATH/glueVars.c" -o "$BUILD_PATH/glueVars.o"
-echo "[INFO] Compiling c_blocks_code.cpp..."
-g++ $FLAGS -I "$LIB_PATH" -c "$SRC_PATH/c_blocks_code.cpp" -o "$BUILD_PATH/c_blocks_code.o"
-echo "[INFO] Compiling python_loader.c..."
-gcc $FLAGS -I "core/src/plc_app" -c "$PYTHON_LOADER_SRC" -o "$BUILD_PATH/python_loader.o"
-
-# Link shared library into build/
-echo "[INFO] Linking shared library..."
-g++ $FLAGS -shared -o "$BUILD_PATH/new_libplc.so" "$BUILD_PATH/Config0.o" \
-    "$BUILD_PATH/Res0.o" "$BUILD_PATH/debug.o" "$BUILD_PATH/glueVars.o" \
-    "$BUILD_PATH/c_blocks_code.o" "$BUILD_PATH/python_loader.o" $EXTRA_OBJS -lpthread -lrt
+echo "[INFO] Compiling with $JOBS parallel jobs..."
+queue_unit Config0 gcc "$SRC_PATH/Config0.c" -I "$LIB_PATH" -I "$PYTHON_INCLUDE_PATH" -include iec_python.h
+queue_unit Res0 gcc "$RES0_SRC" -I "$LIB_PATH" -I "$PYTHON_INCLUDE_PATH" -I "$SRC_PATH" -include iec_python.h
+queue_unit debug gcc "$SRC_PATH/debug.c" -I "$LIB_PATH"
+queue_unit glueVars gcc "$SRC_PATH/glueVars.c" -I "$LIB_PATH" -DOPENPLC_V4
+queue_unit c_blocks_code g++ "$SRC_PATH/c_blocks_code.cpp" -I "$LIB_PATH"
+queue_unit python_loader gcc "$PYTHON_LOADER_SRC" -I "core/src/plc_app"
+
+for pid in "${PIDS[@]}"; do
+    wait "$pid" || FAILED=1
+done
+if [ "$FAILED" -ne 0 ]; then
+    echo "[ERROR] Compilation failed" >&2
+    exit 1
+fi
+COMPILE_END=$(now_ms)
+
+# Link shared library into build/, or reuse the library linked from the same objects
+LINK_CMD=(g++ $FLAGS -shared -o "$BUILD_PATH/new_libplc.so" "${OBJECTS[@]}" -lpthread -lrt)
+LIB_KEY=$( { echo "${LINK_CMD[*]}"; cat "${OBJECTS[@]}"; } | sha256sum | cut -d' ' -f1 )
+CACHED_LIB="$CACHE_PATH/$LIB_KEY.so"
+if [ "$USE_CACHE" = "1" ] && [ -f "$CACHED_LIB" ]; then
+    echo "[INFO] Objects unchanged, using cached shared library"
+    touch "$CACHED_LIB"
+    cp "$CACHED_LIB" "$BUILD_PATH/new_libplc.so"
+else
+    echo "[INFO] Linking shared library..."
+    "${LINK_CMD[@]}"
+    if [ "$USE_CACHE" = "1" ]; then
+        cp "$BUILD_PATH/new_libplc.so" "$CACHED_LIB.$$"
+        mv "$CACHED_LIB.$$" "$CACHED_LIB"
+    fi
+fi
+LINK_END=$(now_ms)
+
+# Keep only the most recently used cache entries
+ls -1t "$CACHE_PATH" | tail -n +$((CACHE_ENTRIES + 1)) | while read -r entry; do
+    rm -f "$CACHE_PATH/$entry"
+done
+
+echo "[INFO] Build times: compile $((COMPILE_END - BUILD_START)) ms," \
+     "link $((LINK_END - COMPILE_END)) ms, total $(( $(now_ms) - BUILD_START )) ms"
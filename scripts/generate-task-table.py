@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""Generate the task table of a MatIEC resource for plc_main --multi-task.
+
+Reads the resource code generated by iec2c, where every task of the resource
+runs from one function on the common tick:
+
+    void RES0_run__(unsigned long tick) {
+      TASK0 = !(tick % 1);
+      if (TASK0) {
+        PROGRAM0_body__(&INSTANCE0);
+      }
+      ...
+    }
+
+and writes a C file that includes the resource code unchanged and adds one
+function per task plus the plc_task_count__ and plc_tasks__[] symbols the
+runtime looks up (see core/src/plc_app/multi_task.h). Task priorities come
+from the TASK declarations of the ST program when it is given.
+
+Tasks started by any other condition, such as SINGLE tasks, become event
+tasks (tick divisor 0) with that condition in a function of its own. In
+multi-task mode the PLC cycle thread evaluates it on every common tick and
+runs the task on its rising edge; plugins may also raise the task by name.
+
+Exits with status 1, without writing the output, when the run function holds
+anything but tasks; the resource is then built without a task table.
+
+    python3 scripts/generate-task-table.py core/generated/Res0.c build/Res0_tasks.c
+"""
+
+import argparse
+import os
+import re
+import sys
+
+RUN_FUNCTION = re.compile(r"void\s+(\w+)_run__\s*\(\s*unsigned\s+long\s+tick\s*\)\s*\{")
+TASK_FLAG = re.compile(r"(\w+)\s*=\s*!\s*\(\s*tick\s*%\s*(\d+)\s*\)\s*;")
+EVENT_FLAG = re.compile(r"(\w+)\s*=\s*([^;{}]+);")
+TASK_BLOCK = r"if\s*\(\s*{}\s*\)\s*\{{"
+ST_TASK = re.compile(r"\bTASK\s+(\w+)\s*\(([^)]*)\)", re.IGNORECASE)
+ST_PRIORITY = re.compile(r"\bPRIORITY\s*:=\s*(\d+)", re.IGNORECASE)
+
+
+class UnsupportedResource(Exception):
+    pass
+
+
+def matching_brace(code, open_index):
+    """Index of the brace closing the one at open_index, skipping strings and comments"""
+    depth = 0
+    i = open_index
+    while i < len(code):
+        c = code[i]
+        if code.startswith("/*", i):
+            i = code.index("*/", i + 2) + 2
+            continue
+        if code.startswith("//", i):
+            i = code.find("\n", i)
+            if i < 0:
+                break
+            continue
+        if c in "\"'":
+            i += 1
+            while code[i] != c:
+                i += 2 if code[i] == "\\" else 1
+        elif c == "{":
+            depth += 1
+        elif c == "}":
+            depth -= 1
+            if depth == 0:
+                return i
+        i += 1
+    raise UnsupportedResource("unbalanced braces")
+
+
+def parse_tasks(code):
+    """List (name, tick divisor, condition, body) of every task of the resource
+
+    Event tasks have divisor 0 and the expression that starts them, cyclic
+    tasks no condition.
+    """
+    functions = list(RUN_FUNCTION.finditer(code))
+    if len(functions) != 1:
+        raise UnsupportedResource(f"{len(functions)} run functions, expected 1")
+
+    start = functions[0].end()
+    end = matching_brace(code, start - 1)
+    body = code[start:end]
+
+    tasks = []
+    pos = 0
+    while True:
+        while pos < len(body) and body[pos].isspace():
+            pos += 1
+        if pos == len(body):
+            break
+
+        flag = TASK_FLAG.match(body, pos)
+        if flag is not None:
+            name, divisor, condition = flag.group(1), int(flag.group(2)), None
+            if divisor == 0:
+                raise UnsupportedResource(f"task {name} has no interval")
+        else:
+            flag = EVENT_FLAG.match(body, pos)
+            if flag is None:
+                raise UnsupportedResource(f"unexpected statement: {body[pos:pos + 40].strip()!r}")
+            name, divisor, condition = flag.group(1), 0, flag.group(2).strip()
+            if re.search(rf"\b{re.escape(name)}\b", condition):
+                raise UnsupportedResource(f"condition of task {name} reads the task flag")
+
+        pos = flag.end()
+        while pos < len(body) and body[pos].isspace():
+            pos += 1
+        block = re.compile(TASK_BLOCK.format(re.escape(name))).match(body, pos)
+        if block is None:
+            raise UnsupportedResource(f"task {name} is not followed by its block")
+        block_end = matching_brace(body, block.end() - 1)
+        tasks.append((name, divisor, condition, body[block.end():block_end]))
+        pos = block_end + 1
+
+    if not tasks:
+        raise UnsupportedResource("no tasks")
+    return tasks
+
+
+def parse_priorities(path):
+    """IEC priority of every task declared in an ST program, by upper case name"""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        program = f.read()
+
+    priorities = {}
+    for task in ST_TASK.finditer(program):
+        priority = ST_PRIORITY.search(task.group(2))
+        if priority is not None:
+            priorities[task.group(1).upper()] = int(priority.group(1))
+    return priorities
+
+
+def generate(resource_name, tasks, priorities):
+    lines = [
+        "// Generated by scripts/generate-task-table.py, do not edit",
+        f'#include "{resource_name}"',
+        "",
+        "#include <stddef.h>",
+        "",
+        "// Same layout as plc_task_t in core/src/plc_app/multi_task.h",
+        "struct plc_task_entry__",
+        "{",
+        "    const char *name;",
+        "    unsigned long tick_divisor;",
+        "    int priority;",
+        "    void (*run)(unsigned long tick);",
+        "    int (*condition)(unsigned long tick);",
+        "};",
+    ]
+    for i, (_, _, condition, body) in enumerate(tasks):
+        lines += [
+            "",
+            f"static void plc_task_{i}__(unsigned long tick)",
+            "{",
+            "    (void)tick;",
+            body.strip("\n").rstrip(),
+            "}",
+        ]
+        if condition is not None:
+            lines += [
+                "",
+                f"static int plc_task_condition_{i}__(unsigned long tick)",
+                "{",
+                "    (void)tick;",
+                f"    return ({condition}) != 0;",
+                "}",
+            ]
+
+    lines += ["", f"const unsigned int plc_task_count__ = {len(tasks)};", ""]
+    lines.append("const struct plc_task_entry__ plc_tasks__[] = {")
+    for i, (name, divisor, condition, _) in enumerate(tasks):
+        priority = priorities.get(name.upper(), -1)
+        condition_function = "NULL" if condition is None else f"plc_task_condition_{i}__"
+        lines.append(
+            f'    {{"{name}", {divisor}, {priority}, plc_task_{i}__, {condition_function}}},'
+        )
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("resource", help="resource code generated by iec2c, e.g. Res0.c")
+    parser.add_argument("output", help="C file to write")
+    parser.add_argument("--st", help="ST program with the TASK declarations")
+    args = parser.parse_args()
+
+    with open(args.resource, encoding="utf-8", errors="replace") as f:
+        code = f.read()
+
+    try:
+        tasks = parse_tasks(code)
+    except UnsupportedResource as e:
+        print(f"[INFO] {args.resource}: no task table ({e})", file=sys.stderr)
+        return 1
+
+    priorities = parse_priorities(args.st) if args.st else {}
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write(generate(os.path.basename(args.resource), tasks, priorities))
+
+    events = sum(1 for _, divisor, _, _ in tasks if divisor == 0)
+    print(f"[INFO] Task table of {args.resource}: {len(tasks)} tasks, {events} event tasks")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
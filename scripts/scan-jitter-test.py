@@ -0,0 +1,435 @@
+#!/usr/bin/env python3
+"""Measure the scan latency of the runtime under background load.
+
+Starts plc_main with a PLC program (typically a synthetic one from
+build/benchmarks) at a given task period, applies stress profiles while the
+program runs and reports the cycle latency histogram collected by the runtime
+over a fixed duration, in the spirit of cyclictest.
+
+Cycle latency is how late a scan starts compared with its schedule.
+
+Stress profiles (--stress, comma separated):
+  cpu     busy loops, one per CPU by default
+  memory  processes copying large buffers (memory bandwidth)
+  s7      S7 clients reading continuously (needs the S7 plugin enabled)
+  modbus  Modbus TCP clients reading holding registers (needs a Modbus server plugin)
+  log     commands that make the runtime log an error each, as fast as possible
+  debug   debugger polling variable values, as the editor does while monitoring
+
+Example:
+    sudo python3 scripts/scan-jitter-test.py \\
+        --program build/benchmarks/libplc_synthetic_medium.so --tick-us 1000 \\
+        --duration 300 --stress cpu,memory,debug --json report.json
+"""
+
+import argparse
+import json
+import os
+import shutil
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+SOCKET_PATH = "/run/runtime/plc_runtime.socket"
+
+CPU_HOG = "while True: pass"
+
+MEMORY_HOG = """
+import sys
+size = int(sys.argv[1]) * 1024 * 1024
+src = bytearray(size)
+dst = bytearray(size)
+while True:
+    dst[:] = src
+"""
+
+
+class RuntimeSocket:
+    """Command socket of the runtime, shared by all threads of the harness.
+
+    The runtime serves one client at a time, so every request takes the lock.
+    """
+
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.settimeout(10)
+        self.sock.connect(path)
+        self.lock = threading.Lock()
+        self.pending = b""
+
+    def request(self, command):
+        with self.lock:
+            self.sock.sendall(command.encode() + b"\n")
+            while b"\n" not in self.pending:
+                data = self.sock.recv(65536)
+                if not data:
+                    raise ConnectionError("runtime closed the command socket")
+                self.pending += data
+            line, self.pending = self.pending.split(b"\n", 1)
+            return line.decode()
+
+    def close(self):
+        self.sock.close()
+
+
+def parse_target(text, default_port):
+    host, _, port = text.partition(":")
+    return host or "127.0.0.1", int(port) if port else default_port
+
+
+def recv_exact(sock, size):
+    data = b""
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("connection closed")
+        data += chunk
+    return data
+
+
+def s7_exchange(sock, payload):
+    """Send a COTP data packet and return the S7 part of the answer."""
+    sock.sendall(struct.pack(">BBH", 3, 0, len(payload) + 7) + bytes([2, 0xF0, 0x80]) + payload)
+    header = recv_exact(sock, 4)
+    return recv_exact(sock, struct.unpack(">H", header[2:4])[0] - 4)
+
+
+def s7_client(target, stop, counters):
+    """Minimal S7 client: connect, negotiate and read the PA area in a loop."""
+    sock = socket.create_connection(target, timeout=5)
+    # COTP connection request to rack 0, slot 1
+    cotp = bytes([0x11, 0xE0, 0, 0, 0, 1, 0, 0xC0, 1, 0x0A, 0xC1, 2, 1, 0, 0xC2, 2, 1, 1])
+    sock.sendall(struct.pack(">BBH", 3, 0, len(cotp) + 4) + cotp)
+    header = recv_exact(sock, 4)
+    recv_exact(sock, struct.unpack(">H", header[2:4])[0] - 4)
+    # Setup communication, PDU size 480
+    s7_exchange(sock, bytes.fromhex("32010000000000080000f0000001000101e0"))
+    # Read 64 bytes from PA at offset 0
+    read = bytes.fromhex("320100000001000e00000401120a10020040000082000000")
+    while not stop.is_set():
+        s7_exchange(sock, read)
+        counters["s7"] += 1
+    sock.close()
+
+
+def modbus_client(target, stop, counters):
+    """Read 100 holding registers in a loop."""
+    sock = socket.create_connection(target, timeout=5)
+    transaction = 0
+    while not stop.is_set():
+        transaction = (transaction + 1) & 0xFFFF
+        sock.sendall(struct.pack(">HHHBBHH", transaction, 0, 6, 1, 3, 0, 100))
+        header = recv_exact(sock, 6)
+        recv_exact(sock, struct.unpack(">H", header[4:6])[0])
+        counters["modbus"] += 1
+    sock.close()
+
+
+def log_flooder(runtime, stop, counters):
+    while not stop.is_set():
+        runtime.request("JITTER_TEST_LOG_FLOOD")
+        counters["log"] += 1
+
+
+def debug_poller(runtime, rate, stop, counters):
+    response = runtime.request("DEBUG:41")
+    if not response.startswith("DEBUG:41"):
+        print(f"[WARN] Debugger not available: {response}", file=sys.stderr)
+        return
+    data = bytes.fromhex(response[6:])
+    count = min((data[1] << 8) | data[2], 128)
+    if count == 0:
+        return
+    command = f"DEBUG:43 00 00 {(count - 1) >> 8:02x} {(count - 1) & 0xFF:02x}"
+    while not stop.wait(1.0 / rate):
+        runtime.request(command)
+        counters["debug"] += 1
+
+
+def run_stressor(name, function, *args):
+    """Run a stress thread; a failing client ends its load with a warning."""
+    try:
+        function(*args)
+    except (OSError, ConnectionError) as e:
+        print(f"[WARN] {name} stress stopped: {e}", file=sys.stderr)
+
+
+def histogram_counts(runtime):
+    response = runtime.request("HISTOGRAM")
+    data = json.loads(response[len("HISTOGRAM:") :])
+    if data.get("truncated"):
+        raise RuntimeError("latency histogram did not fit in one response")
+    counts = {bucket: count for bucket, count in data["buckets"]}
+    return counts, data["overflow"]
+
+
+def runtime_stats(runtime):
+    return json.loads(runtime.request("STATS")[len("STATS:") :])
+
+
+def percentile(buckets, total, fraction):
+    """Upper bound in microseconds below which the given fraction of scans started."""
+    threshold = total * fraction
+    seen = 0
+    for bucket, count in buckets:
+        seen += count
+        if seen >= threshold:
+            return bucket
+    return None
+
+
+def build_report(args, before, after, stats_before, stats_after, counters):
+    counts = {
+        bucket: after[0].get(bucket, 0) - before[0].get(bucket, 0)
+        for bucket in after[0]
+        if after[0].get(bucket, 0) > before[0].get(bucket, 0)
+    }
+    buckets = sorted(counts.items())
+    overflow = after[1] - before[1]
+    total = sum(counts.values()) + overflow
+
+    return {
+        "program": os.path.basename(args.program),
+        "tick_us": args.tick_us,
+        "duration_s": args.duration,
+        "stress": args.stress,
+        "samples": total,
+        "overruns": stats_after["overruns"] - stats_before["overruns"],
+        "latency_us": {
+            "min": buckets[0][0] if buckets else None,
+            "avg": (sum(b * c for b, c in buckets) / total) if total and not overflow else None,
+            "p50": percentile(buckets, total, 0.50),
+            "p99": percentile(buckets, total, 0.99),
+            "p99.9": percentile(buckets, total, 0.999),
+            "p99.99": percentile(buckets, total, 0.9999),
+            "max": None if overflow else (buckets[-1][0] if buckets else None),
+        },
+        "overflow": overflow,
+        "histogram": buckets,
+        "stress_operations": dict(counters),
+    }
+
+
+def print_report(report):
+    latency = report["latency_us"]
+    print()
+    print(f"Program:   {report['program']}, tick {report['tick_us']} us")
+    print(f"Stress:    {report['stress'] or 'none'}")
+    print(f"Duration:  {report['duration_s']} s, {report['samples']} scans")
+    for name, count in sorted(report["stress_operations"].items()):
+        print(f"           {name}: {count} operations")
+    print(f"Overruns:  {report['overruns']}")
+    print()
+    print("Cycle latency (us)")
+    for key in ("min", "avg", "p50", "p99", "p99.9", "p99.99", "max"):
+        value = latency[key]
+        if value is None:
+            text = "n/a" if not report["overflow"] else ">= 1000"
+        elif key == "avg":
+            text = f"{value:.1f}"
+        else:
+            text = str(value)
+        print(f"  {key:<7} {text:>8}")
+    if report["overflow"]:
+        print(f"  {report['overflow']} scans started 1000 us or more late")
+
+    # Histogram in power of two ranges
+    print()
+    print("Histogram")
+    ranges = {}
+    for bucket, count in report["histogram"]:
+        low = 0 if bucket == 0 else 1 << (bucket.bit_length() - 1)
+        ranges[low] = ranges.get(low, 0) + count
+    if report["overflow"]:
+        ranges[1000] = report["overflow"]
+    total = max(report["samples"], 1)
+    for low in sorted(ranges):
+        high = "+" if low == 1000 else f"-{min(max(low * 2 - 1, 0), 999)}"
+        bar = "#" * max(1, round(50 * ranges[low] / total)) if ranges[low] else ""
+        print(f"  {low:>5}{high:<6} {ranges[low]:>10}  {bar}")
+
+
+def start_stressors(args, runtime, stop, counters):
+    processes = []
+    threads = []
+    profiles = [p for p in args.stress.split(",") if p]
+
+    for profile in profiles:
+        if profile == "cpu":
+            for _ in range(args.cpu_workers):
+                processes.append(subprocess.Popen([sys.executable, "-c", CPU_HOG]))
+        elif profile == "memory":
+            for _ in range(args.memory_workers):
+                processes.append(
+                    subprocess.Popen([sys.executable, "-c", MEMORY_HOG, str(args.memory_mb)])
+                )
+        elif profile == "s7":
+            target = parse_target(args.s7_target, 102)
+            for _ in range(args.clients):
+                threads.append(
+                    threading.Thread(
+                        target=run_stressor, args=("s7", s7_client, target, stop, counters)
+                    )
+                )
+        elif profile == "modbus":
+            target = parse_target(args.modbus_target, 502)
+            for _ in range(args.clients):
+                threads.append(
+                    threading.Thread(
+                        target=run_stressor,
+                        args=("modbus", modbus_client, target, stop, counters),
+                    )
+                )
+        elif profile == "log":
+            threads.append(
+                threading.Thread(
+                    target=run_stressor, args=("log", log_flooder, runtime, stop, counters)
+                )
+            )
+        elif profile == "debug":
+            threads.append(
+                threading.Thread(
+                    target=run_stressor,
+                    args=("debug", debug_poller, runtime, args.debug_rate, stop, counters),
+                )
+            )
+        else:
+            raise ValueError(f"unknown stress profile: {profile}")
+
+    for thread in threads:
+        thread.daemon = True
+        thread.start()
+    return processes, threads
+
+
+def wait_until_running(runtime_process, timeout):
+    deadline = time.monotonic() + timeout
+    runtime = None
+    while time.monotonic() < deadline:
+        if runtime_process.poll() is not None:
+            raise RuntimeError("plc_main exited during startup")
+        try:
+            runtime = runtime or RuntimeSocket(SOCKET_PATH)
+            if runtime.request("STATUS") == "STATUS:RUNNING":
+                return runtime
+        except OSError:
+            runtime = None
+        time.sleep(0.2)
+    raise RuntimeError("PLC program did not reach RUNNING")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.splitlines()[0],
+        epilog=__doc__[__doc__.index("Stress profiles") :],
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+    )
+    parser.add_argument("--runtime", default="build/plc_main", help="plc_main executable")
+    parser.add_argument(
+        "--program",
+        default="build/benchmarks/libplc_synthetic_medium.so",
+        help="PLC program to run",
+    )
+    parser.add_argument(
+        "--tick-us",
+        type=int,
+        default=1000,
+        help="task period of synthetic programs in microseconds (default: 1000)",
+    )
+    parser.add_argument("--duration", type=float, default=60, help="seconds measured")
+    parser.add_argument("--warmup", type=float, default=5, help="seconds before measuring")
+    parser.add_argument("--stress", default="", help="comma separated stress profiles")
+    parser.add_argument("--cpu-workers", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--memory-workers", type=int, default=max((os.cpu_count() or 2) // 2, 1))
+    parser.add_argument("--memory-mb", type=int, default=64, help="buffer size per memory worker")
+    parser.add_argument("--clients", type=int, default=4, help="S7 and Modbus clients each")
+    parser.add_argument("--s7-target", default="127.0.0.1:102")
+    parser.add_argument("--modbus-target", default="127.0.0.1:502")
+    parser.add_argument("--debug-rate", type=float, default=50, help="debugger polls per second")
+    parser.add_argument(
+        "--plugins-conf", help="plugins.conf for the runtime, e.g. to enable S7 or Modbus"
+    )
+    parser.add_argument("--runtime-args", default="", help="extra plc_main arguments")
+    parser.add_argument("--json", help="also write the report to this JSON file")
+    args = parser.parse_args()
+
+    if os.path.exists(SOCKET_PATH):
+        try:
+            RuntimeSocket(SOCKET_PATH).close()
+            print("[ERROR] A runtime is already running", file=sys.stderr)
+            return 1
+        except OSError:
+            pass
+
+    # plc_main loads the program from ./build and reads ./plugins.conf
+    workdir = tempfile.mkdtemp(prefix="openplc-jitter-")
+    os.makedirs(os.path.join(workdir, "build"))
+    shutil.copy(args.program, os.path.join(workdir, "build", "libplc_jitter.so"))
+    if args.plugins_conf:
+        shutil.copy(args.plugins_conf, os.path.join(workdir, "plugins.conf"))
+    else:
+        open(os.path.join(workdir, "plugins.conf"), "w", encoding="utf-8").close()
+
+    env = dict(os.environ, OPENPLC_SYNTHETIC_TICKTIME_NS=str(args.tick_us * 1000))
+    log_path = os.path.join(workdir, "runtime.log")
+    with open(log_path, "w", encoding="utf-8") as log_file:
+        runtime_process = subprocess.Popen(
+            [os.path.abspath(args.runtime), "--print-logs"] + args.runtime_args.split(),
+            cwd=workdir,
+            env=env,
+            stdout=log_file,
+            stderr=subprocess.STDOUT,
+        )
+
+    stop = threading.Event()
+    counters = {}
+    processes = []
+    try:
+        runtime = wait_until_running(runtime_process, 30)
+        for profile in args.stress.split(","):
+            if profile in ("s7", "modbus", "log", "debug"):
+                counters[profile] = 0
+        processes, _ = start_stressors(args, runtime, stop, counters)
+
+        print(f"[INFO] Warming up for {args.warmup} s...")
+        time.sleep(args.warmup)
+        before = histogram_counts(runtime)
+        stats_before = runtime_stats(runtime)
+        print(f"[INFO] Measuring for {args.duration} s...")
+        time.sleep(args.duration)
+        after = histogram_counts(runtime)
+        stats_after = runtime_stats(runtime)
+        if runtime_process.poll() is not None:
+            raise RuntimeError("plc_main exited during the test")
+    except (RuntimeError, OSError, ValueError) as e:
+        print(f"[ERROR] {e}; runtime log: {log_path}", file=sys.stderr)
+        return 1
+    finally:
+        stop.set()
+        for process in processes:
+            process.kill()
+            process.wait()
+        if runtime_process.poll() is None:
+            runtime_process.send_signal(signal.SIGINT)
+            try:
+                runtime_process.wait(timeout=10)
+            except subprocess.TimeoutExpired:
+                runtime_process.kill()
+                runtime_process.wait()
+
+    report = build_report(args, before, after, stats_before, stats_after, counters)
+    print_report(report)
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump(report, f, indent=2)
+    shutil.rmtree(workdir, ignore_errors=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
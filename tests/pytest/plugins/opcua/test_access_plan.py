@@ -0,0 +1,240 @@
+"""
+Unit tests for OPC-UA access plans.
+
+Tests the functions in access_plan.py:
+- compile_access_plan() grouping by datatype
+- Typed views reading live PLC memory
+- Generic fallback for size/datatype mismatches
+- Array and unplanned variable handling
+- SynchronizationManager using the compiled plan
+"""
+
+import asyncio
+import ctypes
+import sys
+from pathlib import Path
+from unittest.mock import AsyncMock, MagicMock
+
+import pytest
+
+# Add plugin path for imports
+_plugin_dir = Path(__file__).parent.parent.parent.parent.parent / "core" / "src" / "drivers" / "plugins" / "python"
+sys.path.insert(0, str(_plugin_dir))
+sys.path.insert(0, str(_plugin_dir / "opcua"))
+
+from access_plan import GENERIC_GROUP, compile_access_plan
+from opcua_memory import IEC_STRING, IEC_TIMESPEC
+from opcua_types import VariableMetadata, VariableNode
+
+
+def _make_node(index: int, datatype: str, array_length: int = None) -> VariableNode:
+    node = MagicMock()
+    node.nodeid = f"ns=2;i={index}"
+    return VariableNode(
+        node=node,
+        debug_var_index=index,
+        datatype=datatype,
+        access_mode="readonly",
+        array_length=array_length,
+    )
+
+
+def _metadata(index: int, obj) -> VariableMetadata:
+    return VariableMetadata(
+        index=index,
+        address=ctypes.addressof(obj),
+        size=ctypes.sizeof(obj),
+        inferred_type="",
+    )
+
+
+class SimulatedMemory:
+    """Holds ctypes objects so their addresses stay valid for the test."""
+
+    def __init__(self):
+        self.nodes = {}
+        self.metadata = {}
+        self._objects = []
+
+    def add(self, index: int, datatype: str, obj):
+        self._objects.append(obj)
+        self.nodes[index] = _make_node(index, datatype)
+        self.metadata[index] = _metadata(index, obj)
+        return obj
+
+    def add_array(self, index: int, datatype: str, elements):
+        self._objects.extend(elements)
+        self.nodes[index] = _make_node(index, datatype, array_length=len(elements))
+        for i, obj in enumerate(elements):
+            self.metadata[index + i] = _metadata(index + i, obj)
+        return elements
+
+
+class TestCompileAccessPlan:
+    """Tests for plan compilation."""
+
+    def test_groups_by_datatype(self):
+        mem = SimulatedMemory()
+        mem.add(0, "BOOL", ctypes.c_uint8(1))
+        mem.add(1, "BOOL", ctypes.c_uint8(0))
+        mem.add(2, "INT", ctypes.c_int16(-5))
+        mem.add(3, "REAL", ctypes.c_float(1.5))
+
+        plan = compile_access_plan(mem.nodes, mem.metadata)
+
+        assert set(plan.groups) == {"BOOL", "INT", "REAL"}
+        assert plan.groups["BOOL"].indices == [0, 1]
+        assert plan.groups["INT"].indices == [2]
+        assert plan.planned_count == 4
+        assert not plan.unplanned
+
+    def test_parallel_arrays(self):
+        mem = SimulatedMemory()
+        a = mem.add(4, "DINT", ctypes.c_int32(7))
+        b = mem.add(5, "DINT", ctypes.c_int32(8))
+
+        group = compile_access_plan(mem.nodes, mem.metadata).groups["DINT"]
+
+        assert group.addresses == [ctypes.addressof(a), ctypes.addressof(b)]
+        assert group.sizes == [4, 4]
+        assert group.node_ids == ["ns=2;i=4", "ns=2;i=5"]
+        assert len(group.views) == len(group.nodes) == 2
+
+    def test_missing_metadata_is_unplanned(self):
+        mem = SimulatedMemory()
+        mem.add(0, "INT", ctypes.c_int16(1))
+        mem.nodes[9] = _make_node(9, "INT")
+
+        plan = compile_access_plan(mem.nodes, mem.metadata)
+
+        assert list(plan.unplanned) == [9]
+        assert plan.groups["INT"].indices == [0]
+
+    def test_size_mismatch_uses_generic_group(self):
+        mem = SimulatedMemory()
+        mem.add(0, "INT", ctypes.c_uint32(42))
+
+        plan = compile_access_plan(mem.nodes, mem.metadata)
+
+        assert list(plan.groups) == [GENERIC_GROUP]
+        assert plan.groups[GENERIC_GROUP].read_values() == [42]
+
+
+class TestTypedReads:
+    """Tests for reading values through the compiled views."""
+
+    def test_signed_and_unsigned_integers(self):
+        mem = SimulatedMemory()
+        mem.add(0, "SINT", ctypes.c_int8(-100))
+        mem.add(1, "INT", ctypes.c_int16(-32768))
+        mem.add(2, "UDINT", ctypes.c_uint32(4294967295))
+        mem.add(3, "LINT", ctypes.c_int64(-9223372036854775808))
+
+        plan = compile_access_plan(mem.nodes, mem.metadata)
+
+        assert plan.groups["SINT"].read_values() == [-100]
+        assert plan.groups["INT"].read_values() == [-32768]
+        assert plan.groups["UDINT"].read_values() == [4294967295]
+        assert plan.groups["LINT"].read_values() == [-9223372036854775808]
+
+    def test_bool_values_are_python_bools(self):
+        mem = SimulatedMemory()
+        mem.add(0, "BOOL", ctypes.c_uint8(1))
+        mem.add(1, "BOOL", ctypes.c_uint8(0))
+
+        values = compile_access_plan(mem.nodes, mem.metadata).groups["BOOL"].read_values()
+
+        assert values == [True, False]
+        assert all(isinstance(v, bool) for v in values)
+
+    def test_float_types(self):
+        mem = SimulatedMemory()
+        mem.add(0, "REAL", ctypes.c_float(3.5))
+        mem.add(1, "LREAL", ctypes.c_double(-273.15))
+
+        plan = compile_access_plan(mem.nodes, mem.metadata)
+
+        assert plan.groups["REAL"].read_values() == [3.5]
+        assert plan.groups["LREAL"].read_values() == [-273.15]
+
+    def test_string(self):
+        mem = SimulatedMemory()
+        s = IEC_STRING()
+        encoded = b"Hello"
+        s.len = len(encoded)
+        for i, c in enumerate(encoded):
+            s.body[i] = c
+        mem.add(0, "STRING", s)
+
+        assert compile_access_plan(mem.nodes, mem.metadata).groups["STRING"].read_values() == ["Hello"]
+
+    def test_time_converts_to_milliseconds(self):
+        mem = SimulatedMemory()
+        mem.add(0, "TIME", IEC_TIMESPEC(2, 500_000_000))
+
+        assert compile_access_plan(mem.nodes, mem.metadata).groups["TIME"].read_values() == [2500]
+
+    def test_views_follow_live_memory(self):
+        mem = SimulatedMemory()
+        value = mem.add(0, "INT", ctypes.c_int16(1))
+        group = compile_access_plan(mem.nodes, mem.metadata).groups["INT"]
+
+        value.value = 1234
+
+        assert group.read_values() == [1234]
+
+
+class TestArrayPlans:
+    """Tests for array nodes."""
+
+    def test_array_read_in_one_pass(self):
+        mem = SimulatedMemory()
+        mem.add_array(10, "INT", [ctypes.c_int16(v) for v in (1, -2, 3)])
+
+        plan = compile_access_plan(mem.nodes, mem.metadata)
+
+        assert not plan.groups
+        assert len(plan.arrays) == 1
+        assert plan.arrays[0].node_id == "ns=2;i=10"
+        assert plan.arrays[0].read_values() == [1, -2, 3]
+
+    def test_array_with_missing_element_is_unplanned(self):
+        mem = SimulatedMemory()
+        mem.add_array(10, "INT", [ctypes.c_int16(v) for v in (1, 2)])
+        del mem.metadata[11]
+
+        plan = compile_access_plan(mem.nodes, mem.metadata)
+
+        assert not plan.arrays
+        assert list(plan.unplanned) == [10]
+
+
+class TestSynchronizationWithPlan:
+    """Tests for SynchronizationManager executing the access plan."""
+
+    def test_sync_writes_every_planned_node(self):
+        from synchronization import SynchronizationManager
+
+        mem = SimulatedMemory()
+        mem.add(0, "BOOL", ctypes.c_uint8(1))
+        mem.add(1, "INT", ctypes.c_int16(-7))
+        mem.add_array(2, "REAL", [ctypes.c_float(0.5), ctypes.c_float(1.5)])
+
+        server = MagicMock()
+        server.write_attribute_value = AsyncMock()
+        sync_mgr = SynchronizationManager(MagicMock(), mem.nodes, server)
+        sync_mgr.variable_metadata = mem.metadata
+        sync_mgr._direct_memory_access_enabled = True
+        sync_mgr._compile_access_plan()
+
+        asyncio.run(sync_mgr.sync_runtime_to_opcua())
+
+        written = {
+            call.args[0]: call.args[1].Value.Value
+            for call in server.write_attribute_value.await_args_list
+        }
+        assert written == {
+            "ns=2;i=0": True,
+            "ns=2;i=1": -7,
+            "ns=2;i=2": [0.5, 1.5],
+        }
@@ -98,6 +98,9 @@ class MockBufferAccess:
     def set_value(self, index, value):
         self._values[index] = value
 
+    def get_var_count(self):
+        return (len(self._values), "Success")
+
 
 # ============================================================================
 # Unit Tests for Subscription Support
@@ -380,3 +383,41 @@ class TestDataTypeSupport:
         # Verify DataValue structure
         assert call["datavalue"].Value is not None
         assert call["datavalue"].SourceTimestamp is not None
+
+
+class TestOnlineProgramChange:
+    """Test that the sync loop pauses while an online change switches programs."""
+
+    @pytest.mark.asyncio
+    async def test_no_publish_between_program_changing_and_changed(self):
+        """Verify no values are published until addresses are re-resolved."""
+        from synchronization import SynchronizationManager
+
+        mock_server = MockServer()
+        mock_buffer = MockBufferAccess()
+        mock_buffer.set_value(0, 1)
+
+        var_nodes = {
+            0: MockVariableNode(0, "INT", "readonly")
+        }
+
+        sync_mgr = SynchronizationManager(mock_buffer, var_nodes, mock_server)
+        await sync_mgr.initialize()
+
+        running = True
+        loop_task = asyncio.create_task(sync_mgr.run(lambda: running, 0.005))
+        await asyncio.sleep(0.05)
+        assert len(mock_server.write_attribute_calls) > 0
+
+        # The runtime calls the hooks from its own thread
+        await asyncio.to_thread(sync_mgr.notify_program_changing)
+        published = len(mock_server.write_attribute_calls)
+        await asyncio.sleep(0.05)
+        assert len(mock_server.write_attribute_calls) == published
+
+        await asyncio.to_thread(sync_mgr.notify_program_changed)
+        await asyncio.sleep(0.05)
+        running = False
+        await loop_task
+
+        assert len(mock_server.write_attribute_calls) > published
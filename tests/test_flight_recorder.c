@@ -0,0 +1,307 @@
+#include "flight_recorder.h"
+#include "image_tables.h"
+#include "journal_buffer.h"
+#include "unity.h"
+#include "utils/utils.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Logging stubs (log.c depends on the runtime main loop)
+void log_info(const char *fmt, ...) { (void)fmt; }
+void log_debug(const char *fmt, ...) { (void)fmt; }
+void log_warn(const char *fmt, ...) { (void)fmt; }
+void log_error(const char *fmt, ...) { (void)fmt; }
+
+// Symbols are never resolved from a real program here
+void *plugin_manager_get_symbol(PluginManager *pm, const char *name)
+{
+    (void)pm;
+    (void)name;
+    return NULL;
+}
+
+#define TEST_RECORDING_FILE "/tmp/flight_recorder_test.rec"
+#define MAX_DECODED_RECORDS 64
+
+typedef struct
+{
+    uint8_t kind;
+    uint32_t scans; // RUN records
+    journal_buffer_type_t type;
+    uint16_t index;
+    uint8_t bit;
+    uint64_t value;
+} decoded_record_t;
+
+// Located outputs and inputs of the test program
+static IEC_BOOL alarm_lamp;
+static IEC_BYTE mode;
+static IEC_UINT speed;
+static IEC_UDINT batch_count;
+static IEC_ULINT energy;
+static IEC_BOOL start_button;
+static IEC_UINT setpoint;
+
+static pthread_mutex_t image_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static flight_record_header_t header;
+static uint8_t *records;
+static size_t records_size;
+static decoded_record_t decoded[MAX_DECODED_RECORDS];
+static size_t decoded_count;
+
+/**
+ * @brief Read the finished recording and decode it like plc_replay
+ *
+ * Records beyond MAX_DECODED_RECORDS are validated but not kept.
+ */
+static void decode_recording(void)
+{
+    FILE *file = fopen(TEST_RECORDING_FILE, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL_INT(1, fread(&header, sizeof(header), 1, file));
+    TEST_ASSERT_EQUAL_HEX32(FLIGHT_RECORD_MAGIC, header.magic);
+    TEST_ASSERT_EQUAL_UINT32(FLIGHT_RECORD_VERSION, header.version);
+
+    free(records);
+    records_size = (size_t)header.used;
+    records      = malloc(records_size + 1);
+    TEST_ASSERT_NOT_NULL(records);
+    TEST_ASSERT_EQUAL_UINT(records_size, fread(records, 1, records_size, file));
+    // The file was shrunk to the records actually written
+    TEST_ASSERT_EQUAL_UINT(0, fread(records + records_size, 1, 1, file));
+    fclose(file);
+
+    const uint8_t *p   = records;
+    const uint8_t *end = records + records_size;
+    uint64_t scans     = 0;
+    decoded_count      = 0;
+    while (p < end)
+    {
+        decoded_record_t record = {.kind = p[0] & FLIGHT_RECORD_KIND_MASK};
+        size_t size;
+        if (p[0] == FLIGHT_RECORD_RUN)
+        {
+            size = flight_record_decode_run(p, end, &record.scans);
+            scans += record.scans;
+        }
+        else
+        {
+            size = flight_record_value_record_size(p, end);
+            if (size > 0)
+            {
+                flight_record_decode_value(p, &record.type, &record.index, &record.bit,
+                                           &record.value);
+            }
+        }
+        TEST_ASSERT_TRUE_MESSAGE(size > 0, "Recording ends in a partial record");
+
+        if (decoded_count < MAX_DECODED_RECORDS)
+        {
+            decoded[decoded_count] = record;
+        }
+        decoded_count++;
+        p += size;
+    }
+    TEST_ASSERT_EQUAL_UINT64(header.scans, scans);
+}
+
+static void assert_run(size_t i, uint32_t scans)
+{
+    TEST_ASSERT_TRUE(i < decoded_count);
+    TEST_ASSERT_EQUAL_HEX8(FLIGHT_RECORD_RUN, decoded[i].kind);
+    TEST_ASSERT_EQUAL_UINT32(scans, decoded[i].scans);
+}
+
+static void assert_value(size_t i, uint8_t kind, journal_buffer_type_t type, uint16_t index,
+                         uint8_t bit, uint64_t value)
+{
+    TEST_ASSERT_TRUE(i < decoded_count);
+    TEST_ASSERT_EQUAL_HEX8(kind, decoded[i].kind);
+    TEST_ASSERT_EQUAL_INT(type, decoded[i].type);
+    TEST_ASSERT_EQUAL_UINT16(index, decoded[i].index);
+    TEST_ASSERT_EQUAL_UINT8(bit, decoded[i].bit);
+    TEST_ASSERT_EQUAL_HEX64(value, decoded[i].value);
+}
+
+static void scans(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        flight_recorder_scan_end();
+    }
+}
+
+void setUp(void)
+{
+    alarm_lamp   = 0;
+    mode         = 0;
+    speed        = 0;
+    batch_count  = 0;
+    energy       = 0;
+    start_button = 0;
+    setpoint     = 0;
+
+    bool_output[0][3] = &alarm_lamp;
+    byte_output[2]    = &mode;
+    int_output[1]     = &speed;
+    dint_output[4]    = &batch_count;
+    lint_output[0]    = &energy;
+    bool_input[1][5]  = &start_button;
+    int_input[7]      = &setpoint;
+
+    journal_buffer_ptrs_t ptrs;
+    memset(&ptrs, 0, sizeof(ptrs));
+    ptrs.bool_input  = bool_input;
+    ptrs.bool_output = bool_output;
+    ptrs.byte_output = byte_output;
+    ptrs.int_input   = int_input;
+    ptrs.int_output  = int_output;
+    ptrs.dint_output = dint_output;
+    ptrs.lint_output = lint_output;
+    ptrs.buffer_size = BUFFER_SIZE;
+    ptrs.image_mutex = &image_mutex;
+    TEST_ASSERT_EQUAL_INT(0, journal_init(&ptrs));
+
+    remove(TEST_RECORDING_FILE);
+    flight_recorder_configure(TEST_RECORDING_FILE, 1);
+    TEST_ASSERT_EQUAL_INT(0, flight_recorder_open());
+}
+
+void tearDown(void)
+{
+    flight_recorder_close();
+    journal_cleanup();
+    bool_output[0][3] = NULL;
+    byte_output[2]    = NULL;
+    int_output[1]     = NULL;
+    dint_output[4]    = NULL;
+    lint_output[0]    = NULL;
+    bool_input[1][5]  = NULL;
+    int_input[7]      = NULL;
+    free(records);
+    records = NULL;
+    remove(TEST_RECORDING_FILE);
+}
+
+// Test Case 1: Scans without output changes fold into the RUN of the next changing scan
+void test_scan_end_UnchangedScans_ShouldFoldIntoRun(void)
+{
+    scans(3);
+    speed = 1500;
+    scans(1);
+    scans(2);
+    flight_recorder_close();
+
+    decode_recording();
+    TEST_ASSERT_EQUAL_UINT(3, decoded_count);
+    assert_run(0, 4);
+    assert_value(1, FLIGHT_RECORD_OUTPUT, JOURNAL_INT_OUTPUT, 1, 0, 1500);
+    // The trailing scans are flushed when the recording stops
+    assert_run(2, 2);
+    TEST_ASSERT_EQUAL_UINT64(6, header.scans);
+    TEST_ASSERT_FALSE(header.truncated);
+}
+
+// Test Case 2: Applied journal entries are recorded after the scans that preceded them
+void test_journal_apply_ShouldRecordWritesAfterPendingScans(void)
+{
+    scans(2);
+    TEST_ASSERT_EQUAL_INT(0, journal_write_bool(JOURNAL_BOOL_INPUT, 1, 5, true));
+    TEST_ASSERT_EQUAL_INT(0, journal_write_int(JOURNAL_INT_INPUT, 7, 0xBEEF));
+    TEST_ASSERT_EQUAL_UINT(2, journal_apply_and_clear());
+    TEST_ASSERT_EQUAL_UINT8(1, start_button);
+    TEST_ASSERT_EQUAL_HEX16(0xBEEF, setpoint);
+
+    // A write to an output is recorded as a write and as the changed output of the next scan
+    TEST_ASSERT_EQUAL_INT(0, journal_write_dint(JOURNAL_DINT_OUTPUT, 4, 77));
+    TEST_ASSERT_EQUAL_UINT(1, journal_apply_and_clear());
+    scans(1);
+    flight_recorder_close();
+
+    decode_recording();
+    TEST_ASSERT_EQUAL_UINT(6, decoded_count);
+    assert_run(0, 2);
+    assert_value(1, FLIGHT_RECORD_WRITE, JOURNAL_BOOL_INPUT, 1, 5, 1);
+    assert_value(2, FLIGHT_RECORD_WRITE, JOURNAL_INT_INPUT, 7, 0, 0xBEEF);
+    assert_value(3, FLIGHT_RECORD_WRITE, JOURNAL_DINT_OUTPUT, 4, 0, 77);
+    assert_run(4, 1);
+    assert_value(5, FLIGHT_RECORD_OUTPUT, JOURNAL_DINT_OUTPUT, 4, 0, 77);
+}
+
+// Test Case 3: Values are written in the width of their type, BOOL records carry the bit
+void test_scan_end_AllOutputTypes_ShouldEncodeBitAndWidth(void)
+{
+    alarm_lamp  = 1;
+    mode        = 0xA5;
+    speed       = 0xBEEF;
+    batch_count = 0xDEADBEEF;
+    energy      = 0x0123456789ABCDEFULL;
+    scans(1);
+    flight_recorder_close();
+
+    decode_recording();
+    TEST_ASSERT_EQUAL_UINT(6, decoded_count);
+    assert_run(0, 1);
+    assert_value(1, FLIGHT_RECORD_OUTPUT, JOURNAL_BOOL_OUTPUT, 0, 3, 1);
+    assert_value(2, FLIGHT_RECORD_OUTPUT, JOURNAL_BYTE_OUTPUT, 2, 0, 0xA5);
+    assert_value(3, FLIGHT_RECORD_OUTPUT, JOURNAL_INT_OUTPUT, 1, 0, 0xBEEF);
+    assert_value(4, FLIGHT_RECORD_OUTPUT, JOURNAL_DINT_OUTPUT, 4, 0, 0xDEADBEEF);
+    assert_value(5, FLIGHT_RECORD_OUTPUT, JOURNAL_LINT_OUTPUT, 0, 0, 0x0123456789ABCDEFULL);
+
+    // Tag, index, bit and 1, 1, 2, 4 and 8 value bytes, packed
+    TEST_ASSERT_EQUAL_UINT(FLIGHT_RECORD_RUN_SIZE + 5 + 4 + 5 + 7 + 11, records_size);
+    TEST_ASSERT_EQUAL_HEX8(FLIGHT_RECORD_OUTPUT | JOURNAL_LINT_OUTPUT, records[records_size - 11]);
+    TEST_ASSERT_EQUAL_HEX8(0xEF, records[records_size - 8]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, records[records_size - 1]);
+}
+
+// Test Case 4: A RUN is written out once it covers FLIGHT_RECORD_MAX_RUN scans
+void test_scan_end_MaxRun_ShouldFlushRun(void)
+{
+    if (FLIGHT_RECORD_MAX_RUN > 1000000)
+    {
+        TEST_IGNORE_MESSAGE("Build the tests with a small FLIGHT_RECORD_MAX_RUN");
+    }
+
+    scans(FLIGHT_RECORD_MAX_RUN);
+    mode = 3;
+    scans(1);
+    flight_recorder_close();
+
+    decode_recording();
+    TEST_ASSERT_EQUAL_UINT(3, decoded_count);
+    assert_run(0, FLIGHT_RECORD_MAX_RUN);
+    assert_run(1, 1);
+    assert_value(2, FLIGHT_RECORD_OUTPUT, JOURNAL_BYTE_OUTPUT, 2, 0, 3);
+}
+
+// Test Case 5: A full file keeps the complete records written so far and is marked truncated
+void test_scan_end_FileFull_ShouldStopAtRecordBoundary(void)
+{
+    // Every scan changes a LINT output: a RUN and an OUTPUT record of 11 bytes
+    size_t scans_to_fill = (1024 * 1024) / (FLIGHT_RECORD_RUN_SIZE + 11) + 1;
+    for (size_t i = 0; i < scans_to_fill; i++)
+    {
+        energy = i + 1;
+        scans(1);
+    }
+
+    // Nothing is recorded once the file is full
+    TEST_ASSERT_EQUAL_INT(0, journal_write_int(JOURNAL_INT_INPUT, 7, 1));
+    TEST_ASSERT_EQUAL_UINT(1, journal_apply_and_clear());
+    energy = 0;
+    scans(10);
+    flight_recorder_close();
+
+    decode_recording();
+    TEST_ASSERT_TRUE(header.truncated);
+    TEST_ASSERT_TRUE(header.used <= header.capacity);
+    TEST_ASSERT_TRUE(header.capacity - header.used < FLIGHT_RECORD_RUN_SIZE + 11);
+    TEST_ASSERT_TRUE(header.scans < scans_to_fill);
+    TEST_ASSERT_EQUAL_HEX8(FLIGHT_RECORD_RUN, decoded[0].kind);
+}
@@ -0,0 +1,253 @@
+#include "historian_codec.h"
+#include "historian_segment.h"
+#include "unity.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_SEGMENT_FILE "test_historian_segment.seg"
+
+static uint8_t encoded[65536];
+static uint64_t decoded[2048];
+
+void setUp(void)
+{
+    memset(decoded, 0xAA, sizeof(decoded));
+}
+
+void tearDown(void)
+{
+    remove(TEST_SEGMENT_FILE);
+}
+
+// Helper: encode values, decode them again and return the encoded size
+static size_t round_trip(hist_column_type_t type, const uint64_t *values, uint32_t count)
+{
+    hist_column_encoder_t enc;
+    TEST_ASSERT_TRUE(hist_column_max_bytes(type, count) <= sizeof(encoded));
+    hist_column_init(&enc, type, encoded, hist_column_max_bytes(type, count));
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(0, hist_column_append(&enc, values[i]));
+    }
+    size_t size = hist_column_finish(&enc);
+    TEST_ASSERT_TRUE(size > 0);
+
+    TEST_ASSERT_EQUAL_INT(0, hist_column_decode(type, encoded, size, count, decoded));
+    return size;
+}
+
+// Test Case 1: A steady scan period costs about one bit per timestamp
+void test_timestamps_SteadyPeriod_ShouldRoundTripCompactly(void)
+{
+    uint64_t ts[1000];
+    for (int i = 0; i < 1000; i++)
+    {
+        ts[i] = 1718000000000000ULL + (uint64_t)i * 1000;
+    }
+
+    size_t size = round_trip(HIST_COL_TIMESTAMP, ts, 1000);
+
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(ts, decoded, 1000);
+    TEST_ASSERT_TRUE(size < 8 + 2 + 1000 / 8 + 2);
+}
+
+// Test Case 2: Jitter, clock steps and huge jumps use every prefix width
+void test_timestamps_IrregularDeltas_ShouldRoundTrip(void)
+{
+    const int64_t deltas[] = {1000, 1003, 997, 1200, 800, 3000, 0, 100000, -5000000, 1000,
+                              (int64_t)1 << 40, -((int64_t)1 << 40), 1000, 1000};
+    uint64_t ts[sizeof(deltas) / sizeof(deltas[0]) + 1];
+    uint32_t count = 1;
+    ts[0]          = 1718000000000000ULL;
+    for (size_t i = 0; i < sizeof(deltas) / sizeof(deltas[0]); i++, count++)
+    {
+        ts[count] = ts[count - 1] + (uint64_t)deltas[i];
+    }
+
+    round_trip(HIST_COL_TIMESTAMP, ts, count);
+
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(ts, decoded, count);
+}
+
+// Test Case 3: Floats are reproduced bit-exactly, including special values
+void test_floats_MixedValues_ShouldRoundTripBitExact(void)
+{
+    const double inputs[] = {0.0,   0.0,  -0.0,      1.5,      1.5,   1.25, 3.14159265358979,
+                             1e300, -1e-300, INFINITY, -INFINITY, NAN,  12.5,  12.75,
+                             12.5,  42.0};
+    uint32_t count        = sizeof(inputs) / sizeof(inputs[0]);
+    uint64_t raw[sizeof(inputs) / sizeof(inputs[0])];
+    for (uint32_t i = 0; i < count; i++)
+    {
+        raw[i] = hist_double_to_raw(inputs[i]);
+    }
+
+    round_trip(HIST_COL_FLOAT, raw, count);
+
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(raw, decoded, count);
+}
+
+// Test Case 4: A slowly changing analog value compresses well
+void test_floats_SlowSignal_ShouldCompress(void)
+{
+    uint64_t raw[1000];
+    for (int i = 0; i < 1000; i++)
+    {
+        raw[i] = hist_double_to_raw((double)(float)(20.0 + (i / 50) * 0.125));
+    }
+
+    size_t size = round_trip(HIST_COL_FLOAT, raw, 1000);
+
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(raw, decoded, 1000);
+    TEST_ASSERT_TRUE(size < 1000 * 8 / 20);
+}
+
+// Test Case 5: Integer deltas survive the extremes of the 64-bit range
+void test_ints_ExtremeValues_ShouldRoundTrip(void)
+{
+    const uint64_t values[] = {0,
+                               1,
+                               (uint64_t)-1,
+                               (uint64_t)INT64_MAX,
+                               (uint64_t)INT64_MIN,
+                               12345,
+                               12346,
+                               12346,
+                               65535,
+                               0};
+    uint32_t count          = sizeof(values) / sizeof(values[0]);
+
+    round_trip(HIST_COL_INT, values, count);
+
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(values, decoded, count);
+}
+
+// Test Case 6: Booleans are run-length encoded
+void test_bools_Runs_ShouldRoundTripCompactly(void)
+{
+    uint64_t values[1000];
+    for (int i = 0; i < 1000; i++)
+    {
+        values[i] = (i / 100) % 2;
+    }
+
+    size_t size = round_trip(HIST_COL_BOOL, values, 1000);
+
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(values, decoded, 1000);
+    TEST_ASSERT_TRUE(size <= 11);
+}
+
+// Test Case 7: A truncated column is rejected instead of returning garbage
+void test_decode_TruncatedColumn_ShouldFail(void)
+{
+    uint64_t ts[100];
+    for (int i = 0; i < 100; i++)
+    {
+        ts[i] = (uint64_t)i * i * 1000;
+    }
+    size_t size = round_trip(HIST_COL_TIMESTAMP, ts, 100);
+
+    TEST_ASSERT_EQUAL_INT(-1, hist_column_decode(HIST_COL_TIMESTAMP, encoded, size / 2, 100,
+                                                 decoded));
+}
+
+// Helper: write a segment with two blocks and return the file size
+static size_t write_test_segment(void)
+{
+    const hist_column_type_t types[] = {HIST_COL_BOOL, HIST_COL_INT, HIST_COL_FLOAT};
+    hist_signal_desc_t signals[3];
+    memset(signals, 0, sizeof(signals));
+    strcpy(signals[0].name, "pump_running");
+    strcpy(signals[1].name, "tank_level");
+    strcpy(signals[2].name, "flow");
+    for (int i = 0; i < 3; i++)
+    {
+        signals[i].column_type = (uint32_t)types[i];
+    }
+
+    int fd = open(TEST_SEGMENT_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    TEST_ASSERT_TRUE(fd >= 0);
+    long total = hist_segment_write_header(fd, signals, 3, 1718000000000000LL);
+    TEST_ASSERT_TRUE(total > 0);
+
+    hist_block_builder_t builder;
+    TEST_ASSERT_EQUAL_INT(0, hist_block_builder_init(&builder, types, 3, 100));
+    for (int block = 0; block < 2; block++)
+    {
+        for (int i = 0; i < 100; i++)
+        {
+            int n             = block * 100 + i;
+            uint64_t values[] = {(uint64_t)(n % 7 == 0), (uint64_t)(1000 - n),
+                                 hist_double_to_raw(n * 0.5)};
+            TEST_ASSERT_EQUAL_INT(0, hist_block_builder_append(&builder,
+                                                               1718000000000000LL + n * 1000,
+                                                               values));
+        }
+        TEST_ASSERT_EQUAL_INT(-1, hist_block_builder_append(&builder, 0, (uint64_t[3]){0}));
+
+        const uint8_t *data;
+        size_t size = hist_block_builder_finish(&builder, &data);
+        TEST_ASSERT_EQUAL_UINT(0, size % 8);
+        TEST_ASSERT_EQUAL_INT((int)size, (int)write(fd, data, size));
+        total += (long)size;
+    }
+    hist_block_builder_free(&builder);
+    close(fd);
+    return (size_t)total;
+}
+
+// Test Case 8: Blocks written by the builder are read back through the mapped reader
+void test_segment_WriteAndMap_ShouldReturnAllSamples(void)
+{
+    write_test_segment();
+
+    hist_segment_t seg;
+    TEST_ASSERT_EQUAL_INT(0, hist_segment_open(TEST_SEGMENT_FILE, &seg));
+    TEST_ASSERT_EQUAL_UINT32(3, seg.header->signal_count);
+    TEST_ASSERT_EQUAL_STRING("tank_level", seg.signals[1].name);
+
+    size_t offset = 0;
+    int blocks    = 0;
+    hist_block_view_t block;
+    while (hist_segment_next_block(&seg, &offset, &block))
+    {
+        TEST_ASSERT_EQUAL_UINT32(100, block.header->sample_count);
+        TEST_ASSERT_EQUAL_INT(0, hist_block_decode_column(&seg, &block, 0, decoded));
+        TEST_ASSERT_EQUAL_INT64(1718000000000000LL + blocks * 100000, (int64_t)decoded[0]);
+        TEST_ASSERT_EQUAL_INT64(block.header->last_ts_us, (int64_t)decoded[99]);
+
+        TEST_ASSERT_EQUAL_INT(0, hist_block_decode_column(&seg, &block, 2, decoded));
+        TEST_ASSERT_EQUAL_UINT64(1000 - blocks * 100, decoded[0]);
+
+        TEST_ASSERT_EQUAL_INT(0, hist_block_decode_column(&seg, &block, 3, decoded));
+        TEST_ASSERT_EQUAL_DOUBLE(blocks * 50.0 + 49.5, hist_raw_to_double(decoded[99]));
+        blocks++;
+    }
+    TEST_ASSERT_EQUAL_INT(2, blocks);
+    hist_segment_close(&seg);
+}
+
+// Test Case 9: A partially written last block is ignored, earlier blocks stay readable
+void test_segment_TornTailBlock_ShouldBeIgnored(void)
+{
+    size_t size = write_test_segment();
+    TEST_ASSERT_EQUAL_INT(0, truncate(TEST_SEGMENT_FILE, (off_t)(size - 16)));
+
+    hist_segment_t seg;
+    TEST_ASSERT_EQUAL_INT(0, hist_segment_open(TEST_SEGMENT_FILE, &seg));
+
+    size_t offset = 0;
+    int blocks    = 0;
+    hist_block_view_t block;
+    while (hist_segment_next_block(&seg, &offset, &block))
+    {
+        blocks++;
+    }
+    TEST_ASSERT_EQUAL_INT(1, blocks);
+    hist_segment_close(&seg);
+}
@@ -0,0 +1,109 @@
+#include "journal_buffer.h"
+#include "unity.h"
+
+#include <pthread.h>
+#include <string.h>
+
+// Logging stubs (log.c depends on the runtime main loop)
+void log_info(const char *fmt, ...) { (void)fmt; }
+void log_debug(const char *fmt, ...) { (void)fmt; }
+void log_warn(const char *fmt, ...) { (void)fmt; }
+void log_error(const char *fmt, ...) { (void)fmt; }
+
+#define TEST_BUFFER_SIZE 16
+
+static IEC_BOOL bool_values[TEST_BUFFER_SIZE][8];
+static IEC_BOOL *bool_input[TEST_BUFFER_SIZE][8];
+static IEC_UINT int_values[TEST_BUFFER_SIZE];
+static IEC_UINT *int_input[TEST_BUFFER_SIZE];
+static IEC_ULINT lint_values[TEST_BUFFER_SIZE];
+static IEC_ULINT *lint_input[TEST_BUFFER_SIZE];
+static pthread_mutex_t image_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void setUp(void)
+{
+    memset(bool_values, 0, sizeof(bool_values));
+    memset(int_values, 0, sizeof(int_values));
+    memset(lint_values, 0, sizeof(lint_values));
+    for (int i = 0; i < TEST_BUFFER_SIZE; i++)
+    {
+        for (int bit = 0; bit < 8; bit++)
+        {
+            bool_input[i][bit] = &bool_values[i][bit];
+        }
+        int_input[i]  = &int_values[i];
+        lint_input[i] = &lint_values[i];
+    }
+
+    journal_buffer_ptrs_t ptrs;
+    memset(&ptrs, 0, sizeof(ptrs));
+    ptrs.bool_input  = bool_input;
+    ptrs.int_input   = int_input;
+    ptrs.lint_input  = lint_input;
+    ptrs.buffer_size = TEST_BUFFER_SIZE;
+    ptrs.image_mutex = &image_mutex;
+    TEST_ASSERT_EQUAL_INT(0, journal_init(&ptrs));
+}
+
+void tearDown(void)
+{
+    journal_cleanup();
+}
+
+// Test Case 1: Ranges of different buffers are applied together
+void test_write_ranges_MixedTypes_ShouldApplyAllValues(void)
+{
+    const uint8_t bools[]   = {0x81, 0x02};
+    const uint16_t ints[]   = {100, 200, 300};
+    const uint64_t lints[]  = {0x0123456789ABCDEFULL};
+    const journal_range_t ranges[] = {{JOURNAL_BOOL_INPUT, 4, 2, bools},
+                                      {JOURNAL_INT_INPUT, 1, 3, ints},
+                                      {JOURNAL_LINT_INPUT, 15, 1, lints}};
+
+    TEST_ASSERT_EQUAL_INT(0, journal_write_ranges(ranges, 3));
+    TEST_ASSERT_EQUAL_UINT(8 * 2 + 3 + 1, journal_pending_count());
+    TEST_ASSERT_EQUAL_UINT16(0, int_values[1]);
+
+    TEST_ASSERT_EQUAL_UINT(8 * 2 + 3 + 1, journal_apply_and_clear());
+
+    TEST_ASSERT_EQUAL_UINT8(1, bool_values[4][0]);
+    TEST_ASSERT_EQUAL_UINT8(0, bool_values[4][1]);
+    TEST_ASSERT_EQUAL_UINT8(1, bool_values[4][7]);
+    TEST_ASSERT_EQUAL_UINT8(1, bool_values[5][1]);
+    TEST_ASSERT_EQUAL_UINT16(100, int_values[1]);
+    TEST_ASSERT_EQUAL_UINT16(300, int_values[3]);
+    TEST_ASSERT_EQUAL_UINT64(0x0123456789ABCDEFULL, lint_values[15]);
+    TEST_ASSERT_EQUAL_UINT(0, journal_pending_count());
+}
+
+// Test Case 2: An invalid range rejects the whole batch
+void test_write_ranges_OutOfBounds_ShouldWriteNothing(void)
+{
+    const uint16_t ints[]          = {1, 2};
+    const journal_range_t ranges[] = {{JOURNAL_INT_INPUT, 0, 2, ints},
+                                      {JOURNAL_INT_INPUT, TEST_BUFFER_SIZE - 1, 2, ints}};
+
+    TEST_ASSERT_EQUAL_INT(-1, journal_write_ranges(ranges, 2));
+    TEST_ASSERT_EQUAL_UINT(0, journal_pending_count());
+}
+
+// Test Case 3: A batch that does not fit flushes older entries instead of splitting
+void test_write_ranges_NearlyFullJournal_ShouldKeepBatchTogether(void)
+{
+    for (int i = 0; i < JOURNAL_MAX_ENTRIES - 4; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(0, journal_write_int(JOURNAL_INT_INPUT, 0, (uint16_t)i));
+    }
+
+    const uint8_t bools[]          = {0xFF};
+    const journal_range_t ranges[] = {{JOURNAL_BOOL_INPUT, 2, 1, bools}};
+    TEST_ASSERT_EQUAL_INT(0, journal_write_ranges(ranges, 1));
+
+    /* Older entries were applied, the batch is still pending as a whole */
+    TEST_ASSERT_EQUAL_UINT16(JOURNAL_MAX_ENTRIES - 5, int_values[0]);
+    TEST_ASSERT_EQUAL_UINT(8, journal_pending_count());
+    TEST_ASSERT_EQUAL_UINT8(0, bool_values[2][0]);
+
+    journal_apply_and_clear();
+    TEST_ASSERT_EQUAL_UINT8(1, bool_values[2][7]);
+}
@@ -0,0 +1,230 @@
+#include "mqtt_packet.h"
+#include "mqtt_payload.h"
+#include "mqtt_store.h"
+#include "unity.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_STORE_FILE "test_mqtt_store.bin"
+
+static const mqtt_tag_desc_t tags[] = {{"running", MQTT_TYPE_BOOL},
+                                       {"level", MQTT_TYPE_INT},
+                                       {"flow", MQTT_TYPE_REAL},
+                                       {"total", MQTT_TYPE_LREAL},
+                                       {"count", MQTT_TYPE_ULINT}};
+
+void setUp(void)
+{
+    remove(TEST_STORE_FILE);
+}
+
+void tearDown(void)
+{
+    remove(TEST_STORE_FILE);
+}
+
+static uint64_t real_raw(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static uint64_t lreal_raw(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Test Case 1: CONNECT carries the protocol level, clean session and will
+void test_packet_Connect_ShouldEncodeVariableHeader(void)
+{
+    const uint8_t expected[] = {0x10, 25,  0x00, 0x04, 'M', 'Q',  'T', 'T', 0x04, 0x2E,
+                                0x00, 60,  0x00, 0x01, 'c', 0x00, 0x01, 's', 0x00, 0x07,
+                                'o',  'f', 'f',  'l',  'i', 'n',  'e'};
+    mqtt_connect_params_t params = {.client_id    = "c",
+                                    .keepalive_s  = 60,
+                                    .will_topic   = "s",
+                                    .will_message = "offline",
+                                    .will_retain  = true,
+                                    .will_qos     = 1};
+    uint8_t buf[64];
+
+    size_t len = mqtt_encode_connect(buf, sizeof(buf), &params);
+
+    TEST_ASSERT_EQUAL_UINT(sizeof(expected), len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf, sizeof(expected));
+    TEST_ASSERT_EQUAL_UINT(0, mqtt_encode_connect(buf, 10, &params));
+}
+
+// Test Case 2: PUBLISH header uses a multi-byte remaining length and round-trips
+void test_packet_PublishHeader_ShouldRoundTripRemainingLength(void)
+{
+    uint8_t buf[32];
+    size_t len = mqtt_encode_publish_header(buf, sizeof(buf), "a/b", 300, 1, true, false, 0x1234);
+
+    /* Fixed header (3 bytes), topic length, topic, packet id */
+    TEST_ASSERT_EQUAL_UINT(3 + 2 + 3 + 2, len);
+    TEST_ASSERT_EQUAL_HEX8(0x33, buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, buf[len - 2]);
+    TEST_ASSERT_EQUAL_HEX8(0x34, buf[len - 1]);
+
+    uint8_t first;
+    uint32_t remaining;
+    size_t header_len;
+    TEST_ASSERT_EQUAL_INT(1, mqtt_decode_fixed_header(buf, len, &first, &remaining, &header_len));
+    TEST_ASSERT_EQUAL_UINT32(2 + 3 + 2 + 300, remaining);
+    TEST_ASSERT_EQUAL_UINT(3, header_len);
+
+    TEST_ASSERT_EQUAL_INT(0, mqtt_decode_fixed_header(buf, 2, &first, &remaining, &header_len));
+    const uint8_t too_long[] = {0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+    TEST_ASSERT_EQUAL_INT(-1, mqtt_decode_fixed_header(too_long, sizeof(too_long), &first,
+                                                       &remaining, &header_len));
+}
+
+// Test Case 3: JSON batches use tag names, shortest float digits and null for NaN
+void test_payload_Json_ShouldEncodeNamedValues(void)
+{
+    const mqtt_change_t changes[] = {{0, 0, 1},
+                                     {1, 5, (uint64_t)(int64_t)-42},
+                                     {2, 7, real_raw(0.1f)},
+                                     {3, 9, lreal_raw(NAN)},
+                                     {4, 9, UINT64_MAX}};
+    mqtt_batch_t batch            = {7, 1718000000123LL, 5, changes};
+    char buf[256];
+
+    size_t len = mqtt_payload_encode_json(buf, sizeof(buf), tags, &batch);
+    buf[len]   = '\0';
+
+    TEST_ASSERT_EQUAL_STRING("{\"seq\":7,\"ts\":1718000000123,\"values\":{\"running\":true,"
+                             "\"level\":-42,\"flow\":0.1,\"total\":null,"
+                             "\"count\":18446744073709551615}}",
+                             buf);
+    TEST_ASSERT_TRUE(len <= mqtt_payload_max_size(5, 8));
+    TEST_ASSERT_EQUAL_UINT(0, mqtt_payload_encode_json(buf, len - 1, tags, &batch));
+}
+
+// Test Case 4: Binary batches decode to the same changes, signed values sign-extended
+void test_payload_Binary_ShouldRoundTrip(void)
+{
+    const mqtt_change_t changes[] = {{1, 0, (uint64_t)(int64_t)-1000},
+                                     {2, 250, real_raw(-2.5f)},
+                                     {3, 65535, lreal_raw(1e300)},
+                                     {0, 1, 0}};
+    mqtt_batch_t batch            = {0xDEADBEEF, 1718000000000LL, 4, changes};
+    uint8_t buf[128];
+
+    size_t len = mqtt_payload_encode_binary(buf, sizeof(buf), tags, &batch);
+    size_t values = 2 + 4 + 8 + 1;
+    TEST_ASSERT_EQUAL_UINT(MQTT_PAYLOAD_HEADER_SIZE + 4 * MQTT_PAYLOAD_CHANGE_HEADER + values, len);
+    TEST_ASSERT_EQUAL_HEX8('O', buf[0]);
+
+    mqtt_batch_t decoded;
+    mqtt_change_t out[4];
+    TEST_ASSERT_EQUAL_INT(0, mqtt_payload_decode_binary(buf, len, &decoded, out, 4));
+    TEST_ASSERT_EQUAL_HEX32(0xDEADBEEF, decoded.sequence);
+    TEST_ASSERT_EQUAL_INT64(1718000000000LL, decoded.timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT16(4, decoded.count);
+    for (int i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT16(changes[i].tag, out[i].tag);
+        TEST_ASSERT_EQUAL_UINT16(changes[i].offset_ms, out[i].offset_ms);
+        TEST_ASSERT_EQUAL_HEX64(changes[i].raw, out[i].raw);
+    }
+
+    TEST_ASSERT_EQUAL_INT(-1, mqtt_payload_decode_binary(buf, len - 1, &decoded, out, 4));
+    TEST_ASSERT_EQUAL_INT(-1, mqtt_payload_decode_binary(buf, len, &decoded, out, 3));
+}
+
+// Test Case 5: Stored messages come back in order, also after reopening the file
+void test_store_AppendAndReopen_ShouldKeepOrder(void)
+{
+    mqtt_store_t store;
+    char msg[32];
+    char out[32];
+    uint32_t len;
+
+    TEST_ASSERT_EQUAL_INT(0, mqtt_store_open(&store, TEST_STORE_FILE, 4096, false));
+    for (int i = 0; i < 3; i++)
+    {
+        int n = snprintf(msg, sizeof(msg), "batch %d", i);
+        TEST_ASSERT_EQUAL_INT(0, mqtt_store_append(&store, msg, (uint32_t)n));
+    }
+    TEST_ASSERT_EQUAL_INT(1, mqtt_store_peek(&store, out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_INT(0, mqtt_store_pop(&store));
+    mqtt_store_close(&store);
+
+    TEST_ASSERT_EQUAL_INT(0, mqtt_store_open(&store, TEST_STORE_FILE, 4096, false));
+    TEST_ASSERT_EQUAL_UINT64(2, mqtt_store_count(&store));
+    for (int i = 1; i < 3; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(1, mqtt_store_peek(&store, out, sizeof(out), &len));
+        snprintf(msg, sizeof(msg), "batch %d", i);
+        TEST_ASSERT_EQUAL_UINT32(strlen(msg), len);
+        TEST_ASSERT_EQUAL_MEMORY(msg, out, len);
+        TEST_ASSERT_EQUAL_INT(0, mqtt_store_pop(&store));
+    }
+    TEST_ASSERT_EQUAL_INT(0, mqtt_store_peek(&store, out, sizeof(out), &len));
+    mqtt_store_close(&store);
+}
+
+// Test Case 6: A full ring overwrites the oldest messages and wraps records around the end
+void test_store_Full_ShouldOverwriteOldest(void)
+{
+    mqtt_store_t store;
+    uint8_t msg[100];
+    uint8_t out[100];
+    uint32_t len;
+
+    TEST_ASSERT_EQUAL_INT(0, mqtt_store_open(&store, TEST_STORE_FILE, 1000, false));
+    for (int i = 0; i < 25; i++)
+    {
+        memset(msg, i, sizeof(msg));
+        TEST_ASSERT_EQUAL_INT(0, mqtt_store_append(&store, msg, sizeof(msg)));
+    }
+
+    /* 108 bytes per record: 9 fit in 1000 bytes */
+    TEST_ASSERT_EQUAL_UINT64(9, mqtt_store_count(&store));
+    TEST_ASSERT_EQUAL_UINT64(16, store.overwritten);
+    for (int i = 16; i < 25; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(1, mqtt_store_peek(&store, out, sizeof(out), &len));
+        memset(msg, i, sizeof(msg));
+        TEST_ASSERT_EQUAL_MEMORY(msg, out, sizeof(msg));
+        mqtt_store_pop(&store);
+    }
+
+    uint8_t huge[1001] = {0};
+    TEST_ASSERT_EQUAL_INT(-1, mqtt_store_append(&store, huge, sizeof(huge)));
+    mqtt_store_close(&store);
+}
+
+// Test Case 7: A corrupted record is detected and the unreadable backlog discarded
+void test_store_CorruptRecord_ShouldBeDiscarded(void)
+{
+    mqtt_store_t store;
+    uint8_t out[16];
+    uint32_t len;
+
+    TEST_ASSERT_EQUAL_INT(0, mqtt_store_open(&store, TEST_STORE_FILE, 4096, false));
+    TEST_ASSERT_EQUAL_INT(0, mqtt_store_append(&store, "first", 5));
+    TEST_ASSERT_EQUAL_INT(0, mqtt_store_append(&store, "second", 6));
+
+    TEST_ASSERT_EQUAL_INT(-1, mqtt_store_peek(&store, out, 4, &len));
+    TEST_ASSERT_EQUAL_UINT32(5, len);
+    TEST_ASSERT_EQUAL_UINT64(2, mqtt_store_count(&store));
+
+    int fd = open(TEST_STORE_FILE, O_WRONLY);
+    TEST_ASSERT_TRUE(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(1, (int)pwrite(fd, "X", 1, MQTT_STORE_HEADER_SIZE + 8));
+    close(fd);
+
+    TEST_ASSERT_EQUAL_INT(-1, mqtt_store_peek(&store, out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_UINT64(0, mqtt_store_count(&store));
+    mqtt_store_close(&store);
+}
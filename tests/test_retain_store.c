@@ -0,0 +1,316 @@
+#include "image_tables.h"
+#include "retain_store.h"
+#include "unity.h"
+#include "utils/utils.h"
+#include "variable_table.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Logging stubs (log.c depends on the runtime main loop)
+void log_info(const char *fmt, ...) { (void)fmt; }
+void log_debug(const char *fmt, ...) { (void)fmt; }
+void log_warn(const char *fmt, ...) { (void)fmt; }
+void log_error(const char *fmt, ...) { (void)fmt; }
+
+// Symbols are never resolved from a real program here
+void *plugin_manager_get_symbol(PluginManager *pm, const char *name)
+{
+    (void)pm;
+    (void)name;
+    return NULL;
+}
+
+#define TEST_STORE_FILE "retain_test.bin"
+
+// Offsets in the store file, see the layout in retain_store.c
+#define FILE_LAYOUT_SIZE_OFFSET 8
+#define FILE_SLOT_STRIDE_OFFSET 16
+#define FILE_HEADER_SIZE 24
+#define SLOT_HEADER_SIZE 16
+
+typedef struct
+{
+    const char *name;
+    const char *type;
+    void *addr;
+    size_t size;
+    int retain;
+} test_var_t;
+
+static int16_t counter;
+static int32_t total;
+static int16_t setpoint;
+static uint8_t running;
+
+static const test_var_t *program_vars;
+static size_t program_var_count;
+static char test_dir[64];
+static char previous_dir[512];
+
+static uint16_t test_get_var_count(void)
+{
+    return (uint16_t)program_var_count;
+}
+
+static size_t test_get_var_size(size_t idx)
+{
+    return program_vars[idx].size;
+}
+
+static void *test_get_var_addr(size_t idx)
+{
+    return program_vars[idx].addr;
+}
+
+/**
+ * @brief Make a variable list the loaded program, with its VARIABLES.csv
+ */
+static void load_program(const test_var_t *vars, size_t count)
+{
+    FILE *file = fopen(VARIABLES_CSV_PATH, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs("// Variables\n", file);
+    for (size_t i = 0; i < count; i++)
+    {
+        fprintf(file, "%zu;VAR;%s;%s;%s;%s;%d;\n", i, vars[i].name, vars[i].name, vars[i].type,
+                vars[i].type, vars[i].retain);
+    }
+    fclose(file);
+
+    program_vars      = vars;
+    program_var_count = count;
+    ext_get_var_count = test_get_var_count;
+    ext_get_var_size  = test_get_var_size;
+    ext_get_var_addr  = test_get_var_addr;
+}
+
+static const test_var_t base_program[] = {
+    {"CONFIG0.RES0.INSTANCE0.COUNTER", "INT", &counter, sizeof(counter), 1},
+    {"CONFIG0.RES0.INSTANCE0.RUNNING", "BOOL", &running, sizeof(running), 0},
+    {"CONFIG0.RES0.INSTANCE0.TOTAL", "DINT", &total, sizeof(total), 1},
+    {"CONFIG0.RES0.INSTANCE0.SETPOINT", "INT", &setpoint, sizeof(setpoint), 1},
+};
+
+static void set_values(int16_t c, int32_t t, int16_t s, uint8_t r)
+{
+    counter  = c;
+    total    = t;
+    setpoint = s;
+    running  = r;
+}
+
+/**
+ * @brief Write a checkpoint of the current values like a program run that stops
+ */
+static void run_and_stop(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, retain_store_open(false));
+    retain_store_capture();
+    retain_store_close();
+}
+
+/**
+ * @brief File offsets of the two slots
+ */
+static void slot_offsets(int fd, off_t slots[2])
+{
+    uint32_t layout_size;
+    TEST_ASSERT_EQUAL_INT(sizeof(layout_size),
+                          pread(fd, &layout_size, sizeof(layout_size), FILE_LAYOUT_SIZE_OFFSET));
+    uint32_t slot_stride;
+    TEST_ASSERT_EQUAL_INT(sizeof(slot_stride),
+                          pread(fd, &slot_stride, sizeof(slot_stride), FILE_SLOT_STRIDE_OFFSET));
+
+    size_t page = (size_t)getpagesize();
+    slots[0]    = (off_t)((FILE_HEADER_SIZE + layout_size + page - 1) & ~(page - 1));
+    slots[1]    = slots[0] + (off_t)slot_stride;
+}
+
+/**
+ * @brief File offset of the slot that holds the highest sequence number
+ */
+static off_t newest_slot_offset(int fd)
+{
+    off_t slots[2];
+    slot_offsets(fd, slots);
+
+    off_t slot0   = slots[0];
+    off_t slot1   = slots[1];
+    uint64_t seq0 = 0;
+    uint64_t seq1 = 0;
+    TEST_ASSERT_EQUAL_INT(sizeof(seq0), pread(fd, &seq0, sizeof(seq0), slot0));
+    TEST_ASSERT_EQUAL_INT(sizeof(seq1), pread(fd, &seq1, sizeof(seq1), slot1));
+    TEST_ASSERT_TRUE(seq0 != seq1);
+    return seq0 > seq1 ? slot0 : slot1;
+}
+
+/**
+ * @brief Flip the first data byte of a slot, as a write torn by a power loss
+ */
+static void corrupt_slot_at(int fd, off_t slot)
+{
+    uint8_t byte;
+    TEST_ASSERT_EQUAL_INT(1, pread(fd, &byte, 1, slot + SLOT_HEADER_SIZE));
+    byte ^= 0xFF;
+    TEST_ASSERT_EQUAL_INT(1, pwrite(fd, &byte, 1, slot + SLOT_HEADER_SIZE));
+}
+
+static void corrupt_newest_slot(void)
+{
+    int fd = open(TEST_STORE_FILE, O_RDWR);
+    TEST_ASSERT_TRUE(fd >= 0);
+    corrupt_slot_at(fd, newest_slot_offset(fd));
+    close(fd);
+}
+
+void setUp(void)
+{
+    TEST_ASSERT_NOT_NULL(getcwd(previous_dir, sizeof(previous_dir)));
+    snprintf(test_dir, sizeof(test_dir), "/tmp/retain_test_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(test_dir));
+    TEST_ASSERT_EQUAL_INT(0, chdir(test_dir));
+    mkdir("core", 0755);
+    mkdir("core/generated", 0755);
+
+    retain_store_configure(TEST_STORE_FILE, 60000);
+    load_program(base_program, sizeof(base_program) / sizeof(base_program[0]));
+    set_values(0, 0, 0, 0);
+}
+
+void tearDown(void)
+{
+    retain_store_close();
+    remove(TEST_STORE_FILE);
+    remove(VARIABLES_CSV_PATH);
+    rmdir("core/generated");
+    rmdir("core");
+    TEST_ASSERT_EQUAL_INT(0, chdir(previous_dir));
+    rmdir(test_dir);
+}
+
+// Test Case 1: Retained variables come back from the last checkpoint, others do not
+void test_open_ShouldRestoreRetainedVariables(void)
+{
+    set_values(7, 70000, 42, 1);
+    run_and_stop();
+
+    set_values(0, 0, 0, 0);
+    TEST_ASSERT_EQUAL_INT(0, retain_store_open(true));
+    TEST_ASSERT_EQUAL_INT(7, counter);
+    TEST_ASSERT_EQUAL_INT(70000, total);
+    TEST_ASSERT_EQUAL_INT(42, setpoint);
+    TEST_ASSERT_EQUAL_INT(0, running);
+}
+
+// Test Case 2: Without restore the variables keep their initial values
+void test_open_WithoutRestore_ShouldKeepInitialValues(void)
+{
+    set_values(7, 70000, 42, 1);
+    run_and_stop();
+
+    set_values(1, 2, 3, 0);
+    TEST_ASSERT_EQUAL_INT(0, retain_store_open(false));
+    TEST_ASSERT_EQUAL_INT(1, counter);
+    TEST_ASSERT_EQUAL_INT(2, total);
+    TEST_ASSERT_EQUAL_INT(3, setpoint);
+}
+
+// Test Case 3: Consecutive checkpoints alternate slots, the newest sequence wins
+void test_checkpoints_ShouldAlternateSlotsAndRestoreNewest(void)
+{
+    set_values(1, 100, 10, 0);
+    run_and_stop();
+    set_values(2, 200, 20, 0);
+    run_and_stop();
+    set_values(3, 300, 30, 0);
+    run_and_stop();
+
+    int fd = open(TEST_STORE_FILE, O_RDONLY);
+    TEST_ASSERT_TRUE(fd >= 0);
+    off_t first = newest_slot_offset(fd);
+    close(fd);
+
+    set_values(4, 400, 40, 0);
+    run_and_stop();
+
+    fd = open(TEST_STORE_FILE, O_RDONLY);
+    TEST_ASSERT_TRUE(fd >= 0);
+    TEST_ASSERT_TRUE(newest_slot_offset(fd) != first);
+    close(fd);
+
+    set_values(0, 0, 0, 0);
+    TEST_ASSERT_EQUAL_INT(0, retain_store_open(true));
+    TEST_ASSERT_EQUAL_INT(4, counter);
+    TEST_ASSERT_EQUAL_INT(400, total);
+    TEST_ASSERT_EQUAL_INT(40, setpoint);
+}
+
+// Test Case 4: A torn newest slot fails its CRC and the older slot is restored
+void test_restore_CorruptNewestSlot_ShouldFallBackToOlderSlot(void)
+{
+    set_values(1, 100, 10, 0);
+    run_and_stop();
+    set_values(2, 200, 20, 0);
+    run_and_stop();
+
+    corrupt_newest_slot();
+
+    set_values(0, 0, 0, 0);
+    TEST_ASSERT_EQUAL_INT(0, retain_store_open(true));
+    TEST_ASSERT_EQUAL_INT(1, counter);
+    TEST_ASSERT_EQUAL_INT(100, total);
+    TEST_ASSERT_EQUAL_INT(10, setpoint);
+}
+
+// Test Case 5: Without any valid slot the program starts from its initial values
+void test_restore_BothSlotsCorrupt_ShouldKeepInitialValues(void)
+{
+    set_values(1, 100, 10, 0);
+    run_and_stop();
+    set_values(2, 200, 20, 0);
+    run_and_stop();
+
+    int fd = open(TEST_STORE_FILE, O_RDWR);
+    TEST_ASSERT_TRUE(fd >= 0);
+    off_t slots[2];
+    slot_offsets(fd, slots);
+    corrupt_slot_at(fd, slots[0]);
+    corrupt_slot_at(fd, slots[1]);
+    close(fd);
+
+    set_values(5, 6, 7, 0);
+    TEST_ASSERT_EQUAL_INT(0, retain_store_open(true));
+    TEST_ASSERT_EQUAL_INT(5, counter);
+    TEST_ASSERT_EQUAL_INT(6, total);
+    TEST_ASSERT_EQUAL_INT(7, setpoint);
+}
+
+// Test Case 6: After a program change only variables with the same name and type are restored
+void test_restore_ChangedProgram_ShouldSkipRenamedAndRetypedVariables(void)
+{
+    set_values(7, 70000, 42, 0);
+    run_and_stop();
+
+    static int16_t renamed;
+    static uint16_t retyped;
+    static const test_var_t changed_program[] = {
+        {"CONFIG0.RES0.INSTANCE0.SETPOINT2", "INT", &renamed, sizeof(renamed), 1},
+        {"CONFIG0.RES0.INSTANCE0.TOTAL", "DINT", &total, sizeof(total), 1},
+        {"CONFIG0.RES0.INSTANCE0.COUNTER", "UINT", &retyped, sizeof(retyped), 1},
+    };
+    load_program(changed_program, sizeof(changed_program) / sizeof(changed_program[0]));
+
+    renamed = -1;
+    retyped = 9;
+    total   = 0;
+    TEST_ASSERT_EQUAL_INT(0, retain_store_open(true));
+    TEST_ASSERT_EQUAL_INT(70000, total);
+    TEST_ASSERT_EQUAL_INT(-1, renamed);
+    TEST_ASSERT_EQUAL_INT(9, retyped);
+}
@@ -0,0 +1,136 @@
+#include "tcp_connection_manager.h"
+#include "tcp_socket_io.h"
+#include "unity.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Logging stubs (log.c depends on the runtime main loop)
+void log_info(const char *fmt, ...) { (void)fmt; }
+void log_debug(const char *fmt, ...) { (void)fmt; }
+void log_warn(const char *fmt, ...) { (void)fmt; }
+void log_error(const char *fmt, ...) { (void)fmt; }
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Poll a request like a function block does every scan, until it is done
+ */
+static tcp_connect_status_t poll_until_done(int handle, int *sockfd, long long timeout_ms)
+{
+    long long deadline = now_ms() + timeout_ms;
+    tcp_connect_status_t status;
+    while ((status = tcp_connect_poll(handle, sockfd)) == TCP_CONNECT_PENDING &&
+           now_ms() < deadline)
+    {
+        usleep(1000);
+    }
+    return status;
+}
+
+/**
+ * @brief Open a listening socket on a free local port
+ */
+static int listen_on_free_port(uint16_t *port)
+{
+    int fd                  = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {0};
+    socklen_t len           = sizeof(addr);
+    addr.sin_family         = AF_INET;
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, bind(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL_INT(0, listen(fd, 4));
+    TEST_ASSERT_EQUAL_INT(0, getsockname(fd, (struct sockaddr *)&addr, &len));
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+void setUp(void)
+{
+    tcp_connection_manager_configure(100, 10, 20, 2);
+    TEST_ASSERT_EQUAL_INT(0, tcp_connection_manager_init());
+}
+
+void tearDown(void)
+{
+    tcp_connection_manager_cleanup();
+}
+
+// Test Case 1: Connecting to an unreachable address never blocks the caller
+void test_submit_UnreachableAddress_ShouldFailWithoutBlocking(void)
+{
+    long long start = now_ms();
+    int handle      = tcp_connect_submit("192.0.2.1", 502, TCP_CONNECT_METHOD_TCP);
+    int sockfd      = -1;
+    TEST_ASSERT_TRUE(handle >= 0);
+    TEST_ASSERT_EQUAL_INT(TCP_CONNECT_PENDING, tcp_connect_poll(handle, &sockfd));
+    TEST_ASSERT_TRUE(now_ms() - start < 20);
+
+    // Two attempts with a 100 ms timeout each
+    TEST_ASSERT_EQUAL_INT(TCP_CONNECT_FAILED, poll_until_done(handle, &sockfd, 2000));
+    TEST_ASSERT_EQUAL_INT(-1, tcp_connect_find("192.0.2.1", 502, TCP_CONNECT_METHOD_TCP));
+}
+
+// Test Case 2: A refused connection is retried and then reported as failed
+void test_submit_RefusedConnection_ShouldRetryAndFail(void)
+{
+    uint16_t port;
+    int listener = listen_on_free_port(&port);
+    close(listener);
+
+    int handle = tcp_connect_submit("127.0.0.1", port, TCP_CONNECT_METHOD_TCP);
+    int sockfd = -1;
+    TEST_ASSERT_TRUE(handle >= 0);
+    TEST_ASSERT_EQUAL_INT(TCP_CONNECT_FAILED, poll_until_done(handle, &sockfd, 2000));
+}
+
+// Test Case 3: A reachable server yields a connected, non-blocking socket
+void test_submit_ListeningServer_ShouldConnect(void)
+{
+    uint16_t port;
+    int listener = listen_on_free_port(&port);
+
+    int handle = tcp_connect_submit("127.0.0.1", port, TCP_CONNECT_METHOD_TCP);
+    int sockfd = -1;
+    TEST_ASSERT_TRUE(handle >= 0);
+    TEST_ASSERT_EQUAL_INT(handle, tcp_connect_find("127.0.0.1", port, TCP_CONNECT_METHOD_TCP));
+    TEST_ASSERT_EQUAL_INT(TCP_CONNECT_CONNECTED, poll_until_done(handle, &sockfd, 2000));
+    TEST_ASSERT_TRUE(sockfd >= 0);
+    TEST_ASSERT_TRUE(fcntl(sockfd, F_GETFL, 0) & O_NONBLOCK);
+
+    if (tcp_socket_io_close(sockfd) == TCP_SOCKET_IO_UNMANAGED)
+    {
+        close(sockfd);
+    }
+    close(listener);
+}
+
+// Test Case 4: Invalid addresses fail instead of staying pending
+void test_submit_InvalidAddress_ShouldFail(void)
+{
+    int handle = tcp_connect_submit("not-an-address", 80, TCP_CONNECT_METHOD_TCP);
+    int sockfd = -1;
+    TEST_ASSERT_TRUE(handle >= 0);
+    TEST_ASSERT_EQUAL_INT(TCP_CONNECT_FAILED, poll_until_done(handle, &sockfd, 2000));
+}
+
+// Test Case 5: A cancelled request releases its slot
+void test_cancel_PendingRequest_ShouldReleaseSlot(void)
+{
+    int handle = tcp_connect_submit("192.0.2.1", 503, TCP_CONNECT_METHOD_TCP);
+    TEST_ASSERT_TRUE(handle >= 0);
+
+    tcp_connect_cancel(handle);
+    usleep(50000);
+    TEST_ASSERT_EQUAL_INT(-1, tcp_connect_find("192.0.2.1", 503, TCP_CONNECT_METHOD_TCP));
+}
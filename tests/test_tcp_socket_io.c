@@ -0,0 +1,232 @@
+#include "tcp_socket_io.h"
+#include "unity.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Logging stubs (log.c depends on the runtime main loop)
+void log_info(const char *fmt, ...) { (void)fmt; }
+void log_debug(const char *fmt, ...) { (void)fmt; }
+void log_warn(const char *fmt, ...) { (void)fmt; }
+void log_error(const char *fmt, ...) { (void)fmt; }
+
+static int plc_side;
+static int peer_side;
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Call tcp_socket_io_receive() every millisecond until it returns data or EOF
+ */
+static int receive_until_ready(int fd, uint8_t *buffer, size_t size)
+{
+    long long deadline = now_ms() + 2000;
+    int received;
+    while ((received = tcp_socket_io_receive(fd, buffer, size)) < 0 && now_ms() < deadline)
+    {
+        usleep(1000);
+    }
+    return received;
+}
+
+/**
+ * @brief Read exactly size bytes from a blocking socket
+ */
+static void read_all(int fd, uint8_t *buffer, size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, buffer + done, size - done);
+        TEST_ASSERT_TRUE(n > 0);
+        done += (size_t)n;
+    }
+}
+
+static void open_pair(int type)
+{
+    int fds[2];
+    TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, type, 0, fds));
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+    plc_side  = fds[0];
+    peer_side = fds[1];
+    TEST_ASSERT_EQUAL_INT(0, tcp_socket_io_register(plc_side, type == SOCK_DGRAM));
+}
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, tcp_socket_io_init());
+    plc_side  = -1;
+    peer_side = -1;
+}
+
+void tearDown(void)
+{
+    // Closes plc_side if it is still managed
+    tcp_socket_io_cleanup();
+    if (peer_side >= 0)
+    {
+        close(peer_side);
+    }
+}
+
+// Test Case 1: Unregistered descriptors are left to the caller
+void test_send_UnregisteredSocket_ShouldReturnUnmanaged(void)
+{
+    uint8_t byte = 0;
+    TEST_ASSERT_EQUAL_INT(TCP_SOCKET_IO_UNMANAGED, tcp_socket_io_send(0, &byte, 1));
+    TEST_ASSERT_EQUAL_INT(TCP_SOCKET_IO_UNMANAGED, tcp_socket_io_receive(0, &byte, 1));
+    TEST_ASSERT_EQUAL_INT(TCP_SOCKET_IO_UNMANAGED, tcp_socket_io_close(0));
+}
+
+// Test Case 2: Queued data reaches the peer and the reply comes back through the ring
+void test_sendReceive_StreamSocket_ShouldMoveDataBothWays(void)
+{
+    open_pair(SOCK_STREAM);
+
+    const uint8_t request[] = "read holding registers";
+    TEST_ASSERT_EQUAL_INT(sizeof(request), tcp_socket_io_send(plc_side, request, sizeof(request)));
+
+    uint8_t buffer[64];
+    read_all(peer_side, buffer, sizeof(request));
+    TEST_ASSERT_EQUAL_MEMORY(request, buffer, sizeof(request));
+
+    const uint8_t reply[] = "0042";
+    TEST_ASSERT_EQUAL_INT(sizeof(reply), write(peer_side, reply, sizeof(reply)));
+    TEST_ASSERT_EQUAL_INT(sizeof(reply), receive_until_ready(plc_side, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_MEMORY(reply, buffer, sizeof(reply));
+    TEST_ASSERT_EQUAL_INT(-1, tcp_socket_io_receive(plc_side, buffer, sizeof(buffer)));
+}
+
+// Test Case 3: A peer that stops reading fills the ring and sends fail instead of blocking
+void test_send_PeerNotReading_ShouldFailWhenRingIsFull(void)
+{
+    open_pair(SOCK_STREAM);
+
+    static uint8_t block[1024];
+    int result = 0;
+    for (int i = 0; i < 10000 && result >= 0; i++)
+    {
+        long long start = now_ms();
+        result          = tcp_socket_io_send(plc_side, block, sizeof(block));
+        TEST_ASSERT_TRUE(now_ms() - start < 20);
+    }
+    TEST_ASSERT_EQUAL_INT(-1, result);
+}
+
+// Test Case 4: End of file is reported only after all received data was taken
+void test_receive_PeerClosed_ShouldReturnDataThenEof(void)
+{
+    open_pair(SOCK_STREAM);
+
+    const uint8_t last[] = "bye";
+    TEST_ASSERT_EQUAL_INT(sizeof(last), write(peer_side, last, sizeof(last)));
+    close(peer_side);
+    peer_side = -1;
+    usleep(50000);
+
+    uint8_t buffer[16];
+    TEST_ASSERT_EQUAL_INT(sizeof(last), receive_until_ready(plc_side, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_INT(0, receive_until_ready(plc_side, buffer, sizeof(buffer)));
+}
+
+// Test Case 5: Datagram sockets keep message boundaries in both directions
+void test_sendReceive_DatagramSocket_ShouldKeepBoundaries(void)
+{
+    open_pair(SOCK_DGRAM);
+
+    const uint8_t first[]  = "one";
+    const uint8_t second[] = "second";
+    TEST_ASSERT_EQUAL_INT(sizeof(first), tcp_socket_io_send(plc_side, first, sizeof(first)));
+    TEST_ASSERT_EQUAL_INT(sizeof(second), tcp_socket_io_send(plc_side, second, sizeof(second)));
+
+    uint8_t buffer[64];
+    TEST_ASSERT_EQUAL_INT(sizeof(first), read(peer_side, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_INT(sizeof(second), read(peer_side, buffer, sizeof(buffer)));
+
+    TEST_ASSERT_EQUAL_INT(sizeof(first), write(peer_side, first, sizeof(first)));
+    TEST_ASSERT_EQUAL_INT(sizeof(second), write(peer_side, second, sizeof(second)));
+    TEST_ASSERT_EQUAL_INT(sizeof(first), receive_until_ready(plc_side, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_MEMORY(first, buffer, sizeof(first));
+    TEST_ASSERT_EQUAL_INT(sizeof(second), receive_until_ready(plc_side, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_MEMORY(second, buffer, sizeof(second));
+}
+
+// Test Case 6: Closing still delivers queued data, then the peer sees end of file
+void test_close_QueuedData_ShouldBeFlushedBeforeClose(void)
+{
+    open_pair(SOCK_STREAM);
+
+    const uint8_t msg[] = "final write";
+    TEST_ASSERT_EQUAL_INT(sizeof(msg), tcp_socket_io_send(plc_side, msg, sizeof(msg)));
+    TEST_ASSERT_EQUAL_INT(0, tcp_socket_io_close(plc_side));
+    TEST_ASSERT_EQUAL_INT(TCP_SOCKET_IO_UNMANAGED, tcp_socket_io_send(plc_side, msg, 1));
+
+    uint8_t buffer[32];
+    read_all(peer_side, buffer, sizeof(msg));
+    TEST_ASSERT_EQUAL_MEMORY(msg, buffer, sizeof(msg));
+    TEST_ASSERT_EQUAL_INT(0, read(peer_side, buffer, sizeof(buffer)));
+}
+
+#define SENDER_MESSAGES 2000
+#define SENDER_MESSAGE_SIZE 64
+
+/**
+ * @brief Queue messages filled with the sender's id, retrying while the ring is full
+ */
+static void *send_messages(void *arg)
+{
+    uint8_t msg[SENDER_MESSAGE_SIZE];
+    memset(msg, (int)(intptr_t)arg, sizeof(msg));
+    for (int i = 0; i < SENDER_MESSAGES; i++)
+    {
+        while (tcp_socket_io_send(plc_side, msg, sizeof(msg)) < 0)
+        {
+            usleep(100);
+        }
+    }
+    return NULL;
+}
+
+// Test Case 7: Two tasks sending on the same socket never interleave their messages
+void test_send_TwoSenders_ShouldQueueWholeMessages(void)
+{
+    open_pair(SOCK_STREAM);
+
+    pthread_t senders[2];
+    for (intptr_t id = 0; id < 2; id++)
+    {
+        void *sender_id = (void *)(id + 1);
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&senders[id], NULL, send_messages, sender_id));
+    }
+
+    int counts[3] = {0};
+    for (int i = 0; i < 2 * SENDER_MESSAGES; i++)
+    {
+        uint8_t buffer[SENDER_MESSAGE_SIZE];
+        read_all(peer_side, buffer, sizeof(buffer));
+        TEST_ASSERT_TRUE(buffer[0] == 1 || buffer[0] == 2);
+        for (size_t b = 1; b < sizeof(buffer); b++)
+        {
+            TEST_ASSERT_EQUAL_UINT8(buffer[0], buffer[b]);
+        }
+        counts[buffer[0]]++;
+    }
+
+    for (int id = 0; id < 2; id++)
+    {
+        pthread_join(senders[id], NULL);
+    }
+    TEST_ASSERT_EQUAL_INT(SENDER_MESSAGES, counts[1]);
+    TEST_ASSERT_EQUAL_INT(SENDER_MESSAGES, counts[2]);
+}
@@ -0,0 +1,161 @@
+#include "udp_pubsub_frame.h"
+#include "udp_pubsub_socket.h"
+#include "unity.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TEST_GROUP "239.192.0.99"
+#define TEST_PORT  47899
+
+static uint8_t frame[UDP_PUBSUB_MAX_FRAME];
+
+void setUp(void)
+{
+    memset(frame, 0, sizeof(frame));
+}
+
+void tearDown(void)
+{
+}
+
+// Helper: build a frame with one area of every type and return its size
+static size_t build_test_frame(uint32_t sequence)
+{
+    const uint8_t bools[]   = {0xA5, 0x01};
+    const uint8_t bytes[]   = {1, 2, 3};
+    const uint16_t words[]  = {0x1234, 0xFFFF};
+    const uint32_t dwords[] = {0xDEADBEEF};
+    const uint64_t lwords[] = {0x0102030405060708ULL, 0};
+
+    udp_frame_header_t header = {.publication_id = 7,
+                                 .area_count     = 5,
+                                 .session        = 0xCAFEF00D,
+                                 .sequence       = sequence,
+                                 .timestamp_ns   = 1718000000123456789ULL};
+    size_t len = udp_frame_encode_header(frame, sizeof(frame), &header);
+    len += udp_frame_encode_area(frame + len, sizeof(frame) - len, UDP_AREA_BOOL, 2, bools);
+    len += udp_frame_encode_area(frame + len, sizeof(frame) - len, UDP_AREA_BYTE, 3, bytes);
+    len += udp_frame_encode_area(frame + len, sizeof(frame) - len, UDP_AREA_WORD, 2, words);
+    len += udp_frame_encode_area(frame + len, sizeof(frame) - len, UDP_AREA_DWORD, 1, dwords);
+    len += udp_frame_encode_area(frame + len, sizeof(frame) - len, UDP_AREA_LWORD, 2, lwords);
+    return len;
+}
+
+// Test Case 1: Every area type survives encoding in network byte order
+void test_frame_AllAreaTypes_ShouldRoundTrip(void)
+{
+    size_t len = build_test_frame(42);
+    TEST_ASSERT_EQUAL_UINT(24 + (4 + 2) + (4 + 3) + (4 + 4) + (4 + 4) + (4 + 16), len);
+    TEST_ASSERT_EQUAL_HEX8(0x12, frame[24 + 6 + 7 + 4]); /* Big-endian word */
+
+    udp_frame_header_t header;
+    udp_frame_area_t areas[UDP_PUBSUB_MAX_AREAS];
+    TEST_ASSERT_EQUAL_INT(0, udp_frame_parse(frame, len, &header, areas, UDP_PUBSUB_MAX_AREAS));
+    TEST_ASSERT_EQUAL_UINT16(7, header.publication_id);
+    TEST_ASSERT_EQUAL_UINT32(0xCAFEF00D, header.session);
+    TEST_ASSERT_EQUAL_UINT32(42, header.sequence);
+    TEST_ASSERT_EQUAL_UINT64(1718000000123456789ULL, header.timestamp_ns);
+    TEST_ASSERT_EQUAL_INT(5, header.area_count);
+
+    uint8_t bools[2];
+    uint16_t words[2];
+    uint32_t dwords[1];
+    uint64_t lwords[2];
+    udp_frame_area_to_native(&areas[0], bools);
+    udp_frame_area_to_native(&areas[2], words);
+    udp_frame_area_to_native(&areas[3], dwords);
+    udp_frame_area_to_native(&areas[4], lwords);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, bools[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, areas[1].data[2]);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, words[0]);
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, words[1]);
+    TEST_ASSERT_EQUAL_HEX32(0xDEADBEEF, dwords[0]);
+    TEST_ASSERT_EQUAL_HEX64(0x0102030405060708ULL, lwords[0]);
+}
+
+// Test Case 2: Truncated, padded and foreign datagrams are rejected
+void test_frame_Malformed_ShouldBeRejected(void)
+{
+    size_t len = build_test_frame(1);
+    udp_frame_header_t header;
+    udp_frame_area_t areas[UDP_PUBSUB_MAX_AREAS];
+
+    TEST_ASSERT_EQUAL_INT(-1, udp_frame_parse(frame, len - 1, &header, areas, 16));
+    TEST_ASSERT_EQUAL_INT(-1, udp_frame_parse(frame, len + 1, &header, areas, 16));
+    TEST_ASSERT_EQUAL_INT(-1, udp_frame_parse(frame, len, &header, areas, 4));
+
+    frame[0] = 'X';
+    TEST_ASSERT_EQUAL_INT(-1, udp_frame_parse(frame, len, &header, areas, 16));
+}
+
+// Test Case 3: An area that does not fit is not written
+void test_frame_EncodeOverflow_ShouldFail(void)
+{
+    const uint64_t values[4] = {0};
+    TEST_ASSERT_EQUAL_UINT(0, udp_frame_encode_area(frame, 35, UDP_AREA_LWORD, 4, values));
+    TEST_ASSERT_EQUAL_UINT(36, udp_frame_encode_area(frame, 36, UDP_AREA_LWORD, 4, values));
+}
+
+// Test Case 4: Gaps, duplicates, reordering and wrap-around are classified
+void test_sequence_Tracking_ShouldDetectLossAndReordering(void)
+{
+    udp_seq_state_t state = {0};
+    uint32_t lost;
+
+    TEST_ASSERT_EQUAL_INT(UDP_SEQ_FIRST, udp_seq_update(&state, 1, 100, &lost));
+    TEST_ASSERT_EQUAL_INT(UDP_SEQ_NEXT, udp_seq_update(&state, 1, 101, &lost));
+    TEST_ASSERT_EQUAL_UINT32(0, lost);
+    TEST_ASSERT_EQUAL_INT(UDP_SEQ_NEXT, udp_seq_update(&state, 1, 105, &lost));
+    TEST_ASSERT_EQUAL_UINT32(3, lost);
+    TEST_ASSERT_EQUAL_INT(UDP_SEQ_OLD, udp_seq_update(&state, 1, 105, &lost));
+    TEST_ASSERT_EQUAL_INT(UDP_SEQ_OLD, udp_seq_update(&state, 1, 103, &lost));
+
+    /* Publisher restart: new session, sequence starts over */
+    TEST_ASSERT_EQUAL_INT(UDP_SEQ_FIRST, udp_seq_update(&state, 2, 1, &lost));
+
+    state.last_sequence = 0xFFFFFFFF;
+    TEST_ASSERT_EQUAL_INT(UDP_SEQ_NEXT, udp_seq_update(&state, 2, 1, &lost));
+    TEST_ASSERT_EQUAL_UINT32(1, lost);
+}
+
+// Test Case 5: A frame published to a multicast group arrives on loopback
+void test_socket_MulticastLoopback_ShouldDeliverFrame(void)
+{
+    struct sockaddr_in group;
+    TEST_ASSERT_EQUAL_INT(0, udp_pubsub_resolve(TEST_GROUP, TEST_PORT, &group));
+
+    int rx = udp_pubsub_open_subscriber(&group, "127.0.0.1");
+    if (rx < 0)
+    {
+        TEST_IGNORE_MESSAGE("Multicast is not available on the loopback interface");
+    }
+    int tx = udp_pubsub_open_publisher("127.0.0.1", 1, true);
+    TEST_ASSERT_TRUE(tx >= 0);
+
+    size_t len = build_test_frame(9);
+    TEST_ASSERT_EQUAL_INT((int)len, (int)sendto(tx, frame, len, 0, (struct sockaddr *)&group,
+                                                sizeof(group)));
+
+    struct pollfd pfd = {.fd = rx, .events = POLLIN};
+    TEST_ASSERT_EQUAL_INT(1, poll(&pfd, 1, 1000));
+
+    uint8_t received[UDP_PUBSUB_MAX_FRAME];
+    ssize_t got = recv(rx, received, sizeof(received), 0);
+    TEST_ASSERT_EQUAL_INT((int)len, (int)got);
+
+    udp_frame_header_t header;
+    udp_frame_area_t areas[UDP_PUBSUB_MAX_AREAS];
+    TEST_ASSERT_EQUAL_INT(0, udp_frame_parse(received, (size_t)got, &header, areas, 16));
+    TEST_ASSERT_EQUAL_UINT32(9, header.sequence);
+
+    /* Non-blocking: nothing else queued */
+    TEST_ASSERT_EQUAL_INT(-1, (int)recv(rx, received, sizeof(received), 0));
+    TEST_ASSERT_EQUAL_INT(EAGAIN, errno);
+
+    close(tx);
+    close(rx);
+}
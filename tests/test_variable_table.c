@@ -0,0 +1,86 @@
+#include "unity.h"
+#include "variable_table.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Logging stubs (log.c depends on the runtime main loop)
+void log_info(const char *fmt, ...) { (void)fmt; }
+void log_debug(const char *fmt, ...) { (void)fmt; }
+void log_warn(const char *fmt, ...) { (void)fmt; }
+void log_error(const char *fmt, ...) { (void)fmt; }
+
+#define TEST_CSV_FILE "test_variables.csv"
+
+static variable_table_t table;
+
+static void write_csv(const char *content)
+{
+    FILE *file = fopen(TEST_CSV_FILE, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs(content, file);
+    fclose(file);
+}
+
+void setUp(void)
+{
+    memset(&table, 0, sizeof(table));
+}
+
+void tearDown(void)
+{
+    variable_table_free(&table);
+    remove(TEST_CSV_FILE);
+}
+
+// Test Case 1: Function block rows and other sections are skipped
+void test_load_ShouldIndexLikeDebugTable(void)
+{
+    write_csv("// Programs\n"
+              "0;CONFIG0.RES0.INSTANCE0;MAIN;\n"
+              "\n"
+              "// Variables\n"
+              "0;FB;CONFIG0.RES0.INSTANCE0;CONFIG0.RES0.INSTANCE0;MAIN;;0;\n"
+              "1;VAR;CONFIG0.RES0.INSTANCE0.START;CONFIG0.RES0.INSTANCE0.START;BOOL;BOOL;0;\n"
+              "2;FB;CONFIG0.RES0.INSTANCE0.TON0;CONFIG0.RES0.INSTANCE0.TON0;TON;;0;\n"
+              "3;VAR;CONFIG0.RES0.INSTANCE0.TON0.PT;CONFIG0.RES0.INSTANCE0.TON0.PT;TIME;TIME;1;\r\n"
+              "\n"
+              "// Ticktime\n"
+              "20000000\n");
+
+    TEST_ASSERT_EQUAL_INT(0, variable_table_load(TEST_CSV_FILE, &table));
+    TEST_ASSERT_EQUAL_UINT(2, table.count);
+    TEST_ASSERT_EQUAL_STRING("CONFIG0.RES0.INSTANCE0.START", table.vars[0].name);
+    TEST_ASSERT_EQUAL_STRING("BOOL", table.vars[0].type);
+    TEST_ASSERT_EQUAL_STRING("CONFIG0.RES0.INSTANCE0.TON0.PT", table.vars[1].name);
+    TEST_ASSERT_EQUAL_STRING("TIME", table.vars[1].type);
+    TEST_ASSERT_FALSE(table.vars[0].retain);
+    TEST_ASSERT_TRUE(table.vars[1].retain);
+}
+
+// Test Case 2: A missing file is reported and leaves an empty table
+void test_load_MissingFile_ShouldFail(void)
+{
+    TEST_ASSERT_EQUAL_INT(-1, variable_table_load("does_not_exist.csv", &table));
+    TEST_ASSERT_EQUAL_UINT(0, table.count);
+    TEST_ASSERT_NULL(table.vars);
+}
+
+// Test Case 3: Variables match by name and type, regardless of their position
+void test_match_ShouldRequireSameNameAndType(void)
+{
+    variable_entry_t old_vars[] = {{"MAIN.A", "INT"}, {"MAIN.B", "BOOL"}, {"MAIN.C", "REAL"}};
+    variable_entry_t new_vars[] = {{"MAIN.C", "REAL"},  // moved
+                                   {"MAIN.NEW", "INT"}, // added
+                                   {"MAIN.B", "INT"},   // type changed
+                                   {"MAIN.A", "INT"}};
+    variable_table_t old_table  = {old_vars, 3};
+    variable_table_t new_table  = {new_vars, 4};
+    long old_index[4];
+
+    TEST_ASSERT_EQUAL_INT(2, variable_table_match(&old_table, &new_table, old_index));
+    TEST_ASSERT_EQUAL_INT(2, old_index[0]);
+    TEST_ASSERT_EQUAL_INT(-1, old_index[1]);
+    TEST_ASSERT_EQUAL_INT(-1, old_index[2]);
+    TEST_ASSERT_EQUAL_INT(0, old_index[3]);
+}
@@ -0,0 +1,183 @@
+#include "image_tables.h"
+#include "unity.h"
+#include "utils/utils.h"
+#include "warm_restart.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// Logging stubs (log.c depends on the runtime main loop)
+void log_info(const char *fmt, ...) { (void)fmt; }
+void log_debug(const char *fmt, ...) { (void)fmt; }
+void log_warn(const char *fmt, ...) { (void)fmt; }
+void log_error(const char *fmt, ...) { (void)fmt; }
+
+// Symbols are never resolved from a real program here
+void *plugin_manager_get_symbol(PluginManager *pm, const char *name)
+{
+    (void)pm;
+    (void)name;
+    return NULL;
+}
+
+#define TEST_CHECKPOINT_FILE "/tmp/warm_restart_test.bin"
+
+// Offsets in the checkpoint file, see the layout in warm_restart.c
+#define FILE_SLOT_STRIDE_OFFSET 52
+#define SLOT_HEADER_SIZE 24
+
+// Located variables the image tables point to, and program variables
+static IEC_UINT motor_speed;
+static IEC_BOOL valve_open;
+static int32_t batch_count;
+static double flow_total;
+
+static void *program_vars[] = {&batch_count, &flow_total};
+static size_t program_var_sizes[] = {sizeof(batch_count), sizeof(flow_total)};
+
+static uint16_t test_get_var_count(void)
+{
+    return 2;
+}
+
+static size_t test_get_var_size(size_t idx)
+{
+    return program_var_sizes[idx];
+}
+
+static void *test_get_var_addr(size_t idx)
+{
+    return program_vars[idx];
+}
+
+static void set_values(IEC_UINT speed, IEC_BOOL valve, int32_t batches, double flow)
+{
+    motor_speed = speed;
+    valve_open  = valve;
+    batch_count = batches;
+    flow_total  = flow;
+}
+
+/**
+ * @brief Run the program once and stop it, leaving a checkpoint of the current values
+ */
+static void run_and_stop(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, warm_restart_open(false));
+    warm_restart_close(true);
+}
+
+/**
+ * @brief Flip the first data byte of the slot with the highest sequence number
+ */
+static void corrupt_newest_slot(void)
+{
+    int fd = open(TEST_CHECKPOINT_FILE, O_RDWR);
+    TEST_ASSERT_TRUE(fd >= 0);
+
+    uint32_t slot_stride;
+    TEST_ASSERT_EQUAL_INT(sizeof(slot_stride),
+                          pread(fd, &slot_stride, sizeof(slot_stride), FILE_SLOT_STRIDE_OFFSET));
+    off_t slot0   = (off_t)getpagesize();
+    off_t slot1   = slot0 + (off_t)slot_stride;
+    uint64_t seq0 = 0;
+    uint64_t seq1 = 0;
+    TEST_ASSERT_EQUAL_INT(sizeof(seq0), pread(fd, &seq0, sizeof(seq0), slot0));
+    TEST_ASSERT_EQUAL_INT(sizeof(seq1), pread(fd, &seq1, sizeof(seq1), slot1));
+    TEST_ASSERT_TRUE(seq0 != seq1);
+
+    off_t offset = (seq0 > seq1 ? slot0 : slot1) + SLOT_HEADER_SIZE;
+    uint8_t byte;
+    TEST_ASSERT_EQUAL_INT(1, pread(fd, &byte, 1, offset));
+    byte ^= 0xFF;
+    TEST_ASSERT_EQUAL_INT(1, pwrite(fd, &byte, 1, offset));
+    close(fd);
+}
+
+void setUp(void)
+{
+    remove(TEST_CHECKPOINT_FILE);
+    warm_restart_configure(true, TEST_CHECKPOINT_FILE, 60000);
+
+    int_output[3]     = &motor_speed;
+    bool_output[0][2] = &valve_open;
+    ext_get_var_count = test_get_var_count;
+    ext_get_var_size  = test_get_var_size;
+    ext_get_var_addr  = test_get_var_addr;
+
+    static char md5[] = "0123456789abcdef0123456789abcdef";
+    ext_plc_program_md5 = md5;
+    set_values(0, 0, 0, 0.0);
+}
+
+void tearDown(void)
+{
+    warm_restart_close(false);
+    warm_restart_configure(false, NULL, 0);
+    int_output[3]     = NULL;
+    bool_output[0][2] = NULL;
+    remove(TEST_CHECKPOINT_FILE);
+}
+
+// Test Case 1: Located and program variables come back from the last checkpoint
+void test_open_ShouldRestoreProcessImage(void)
+{
+    set_values(1500, 1, 12, 345.5);
+    run_and_stop();
+
+    set_values(0, 0, 0, 0.0);
+    TEST_ASSERT_EQUAL_INT(0, warm_restart_open(true));
+    TEST_ASSERT_EQUAL_UINT(1500, motor_speed);
+    TEST_ASSERT_EQUAL_UINT(1, valve_open);
+    TEST_ASSERT_EQUAL_INT(12, batch_count);
+    TEST_ASSERT_EQUAL_DOUBLE(345.5, flow_total);
+}
+
+// Test Case 2: Without restore the program keeps its initial values
+void test_open_WithoutRestore_ShouldKeepInitialValues(void)
+{
+    set_values(1500, 1, 12, 345.5);
+    run_and_stop();
+
+    set_values(7, 0, 8, 9.0);
+    TEST_ASSERT_EQUAL_INT(0, warm_restart_open(false));
+    TEST_ASSERT_EQUAL_UINT(7, motor_speed);
+    TEST_ASSERT_EQUAL_INT(8, batch_count);
+}
+
+// Test Case 3: A torn newest slot fails its CRC and the older slot is restored
+void test_restore_CorruptNewestSlot_ShouldFallBackToOlderSlot(void)
+{
+    set_values(100, 0, 1, 10.0);
+    run_and_stop();
+    set_values(200, 1, 2, 20.0);
+    run_and_stop();
+
+    corrupt_newest_slot();
+
+    set_values(0, 0, 0, 0.0);
+    TEST_ASSERT_EQUAL_INT(0, warm_restart_open(true));
+    TEST_ASSERT_EQUAL_UINT(100, motor_speed);
+    TEST_ASSERT_EQUAL_UINT(0, valve_open);
+    TEST_ASSERT_EQUAL_INT(1, batch_count);
+    TEST_ASSERT_EQUAL_DOUBLE(10.0, flow_total);
+}
+
+// Test Case 4: Checkpoints of another program build are discarded, the program starts cold
+void test_restore_OtherProgramBuild_ShouldColdStart(void)
+{
+    set_values(1500, 1, 12, 345.5);
+    run_and_stop();
+
+    static char other_md5[] = "fedcba9876543210fedcba9876543210";
+    ext_plc_program_md5     = other_md5;
+    set_values(3, 0, 4, 5.0);
+    TEST_ASSERT_EQUAL_INT(0, warm_restart_open(true));
+    TEST_ASSERT_EQUAL_UINT(3, motor_speed);
+    TEST_ASSERT_EQUAL_UINT(0, valve_open);
+    TEST_ASSERT_EQUAL_INT(4, batch_count);
+    TEST_ASSERT_EQUAL_DOUBLE(5.0, flow_total);
+}
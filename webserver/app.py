@@ -244,7 +244,11 @@ def handle_upload_file(data: dict) -> dict:
         task_compile = threading.Thread(
             target=run_compile,
             args=(runtime_manager,),
-            kwargs={"cwd": extract_dir},
+            kwargs={
+                "cwd": extract_dir,
+                "online_change": flask.request.form.get("online_change", "").lower()
+                in ("1", "true", "yes"),
+            },
             daemon=True,
         )
 
@@ -235,9 +235,17 @@ def update_plugin_configurations(generated_dir: str = "core/generated"):
         build_state.log("[ERROR] Failed to save updated plugin configuration\n")
 
 
-def run_compile(runtime_manager: RuntimeManager, cwd: str = "core/generated"):
-    """Run compile script synchronously (wait for completion) and update status/logs."""
+def run_compile(runtime_manager: RuntimeManager, cwd: str = "core/generated",
+                online_change: bool = False):
+    """Run compile script synchronously (wait for completion) and update status/logs.
+
+    With online_change, a running PLC keeps running and switches to the new program
+    at a scan cycle boundary; if the runtime refuses the change, it is restarted.
+    """
     script_path: str = "./scripts/compile.sh"
+    # Profile-guided, link-time optimized build (slower to build, faster scans)
+    if os.environ.get("OPENPLC_OPTIMIZED_BUILD") == "1":
+        script_path = "./scripts/compile-optimized.sh"
 
     build_state.status = BuildStatus.COMPILING
     build_state.log(f"[INFO] Starting compilation\n")
@@ -273,8 +281,13 @@ def run_compile(runtime_manager: RuntimeManager, cwd: str = "core/generated"):
     # Block until compile finishes
     wait_and_finish(compile_proc, "Build")
 
+    # An online change keeps the current program running through the cleanup
+    online = (online_change and build_state.status == BuildStatus.SUCCESS
+              and "RUNNING" in (runtime_manager.status_plc() or ""))
+
     # Stop PLC before cleanup
-    runtime_manager.stop_plc()
+    if not online:
+        runtime_manager.stop_plc()
 
     # --- Cleanup step ---
     cleanup_proc = subprocess.Popen(
@@ -293,6 +306,13 @@ def run_compile(runtime_manager: RuntimeManager, cwd: str = "core/generated"):
 
     # Restart PLC only if everything succeeded
     if build_state.status == BuildStatus.SUCCESS:
+        if online:
+            response = runtime_manager.online_change_plc() or ""
+            if response.startswith("ONLINE_CHANGE:OK"):
+                build_state.log("[INFO] PLC program changed online without stopping\n")
+                return
+            build_state.log("[WARNING] Online change failed, restarting the PLC instead\n")
+            runtime_manager.stop_plc()
         runtime_manager.reset_crash_tracking()
         runtime_manager.start_plc()
     else:
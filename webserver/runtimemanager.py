@@ -315,6 +315,20 @@ class RuntimeManager:
             logger.error("Failed to stop PLC runtime (unexpected): %s", e)
             return "STOP:ERROR\n"
 
+    def online_change_plc(self):
+        """
+        Send ONLINE_CHANGE command to switch to the newly built program
+        without stopping the PLC
+        """
+        try:
+            return self.runtime_socket.send_and_receive("ONLINE_CHANGE\n", timeout=10.0)
+        except (OSError, socket.error) as e:
+            logger.error("Failed to change PLC program online: %s", e)
+            return "ONLINE_CHANGE:ERROR\n"
+        except Exception as e:
+            logger.error("Failed to change PLC program online (unexpected): %s", e)
+            return "ONLINE_CHANGE:ERROR\n"
+
     def status_plc(self):
         """
         Send STATUS command